@@ -32,6 +32,13 @@ class BLEConstants {
   static const String cmdDeleteSchedule = 'DEL_SCHEDULE';
   static const String cmdSOS = 'SOS';
 
+  // Binary protocol (firmware CommandParser.h). Slider drags use the
+  // sequenced lossy stream; everything else still goes over JSON.
+  static const int cmdMagic = 0xC5;
+  static const int opSetFan = 0x01;
+  static const int opSetLed = 0x02;
+  static const int opStream = 0x2B;
+
   // Response codes
   static const String respOK = 'OK';
   static const String respError = 'ERROR';
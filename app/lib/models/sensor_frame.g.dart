@@ -0,0 +1,70 @@
+// GENERATED CODE - DO NOT MODIFY BY HAND
+//
+// Generated by scripts/codegen/gen_protocol.py from the
+// SENSOR_FRAME_SCHEMA rows in
+// firmware/SmartSync_ESP32/src/ble/SensorFrame.h. Edit the
+// schema there and rerun the script; never edit this file.
+
+import 'dart:typed_data';
+
+/// Full sensor snapshot notified on the TX characteristic,
+/// 19 bytes, all multi-byte fields little-endian.
+class SensorFrame {
+  static const int frameMagic = 0xA5;
+  static const int frameVersion = 3;
+  static const int frameTypeSensor = 0x01;
+  static const int frameLength = 19;
+
+  static const int flagMotion = 0x01;
+  static const int flagFault = 0x02;
+  static const int flagCoredump = 0x04;
+  static const int flagStale = 0x08;
+
+  final int flags;
+  final double temperature;
+  final double humidity;
+  final int fanSpeed;
+  final int ledBrightness;
+  final double distance;
+  final int occupancy;
+  final int fanRpm;
+  final int timestampMs;
+
+  bool get motion => flags & flagMotion != 0;
+  bool get fault => flags & flagFault != 0;
+  bool get coredump => flags & flagCoredump != 0;
+  bool get stale => flags & flagStale != 0;
+
+  SensorFrame._({
+    required this.flags,
+    required this.temperature,
+    required this.humidity,
+    required this.fanSpeed,
+    required this.ledBrightness,
+    required this.distance,
+    required this.occupancy,
+    required this.fanRpm,
+    required this.timestampMs,
+  });
+
+  /// Returns null unless [data] is a full sensor snapshot
+  /// (other frame types share the characteristic).
+  static SensorFrame? parse(List<int> data) {
+    if (data.length < frameLength) return null;
+    final bytes = ByteData.sublistView(
+        data is Uint8List ? data : Uint8List.fromList(data));
+    if (bytes.getUint8(0) != frameMagic) return null;
+    if (bytes.getUint8(2) != frameTypeSensor) return null;
+    return SensorFrame._(
+      flags: bytes.getUint8(3),
+      temperature: bytes.getInt16(4, Endian.little) * 0.01,
+      humidity: bytes.getUint16(6, Endian.little) * 0.01,
+      fanSpeed: bytes.getUint8(8),
+      ledBrightness: bytes.getUint8(9),
+      distance: bytes.getUint16(10, Endian.little) * 0.1,
+      occupancy: bytes.getUint8(12),
+      fanRpm: bytes.getUint16(13, Endian.little),
+      timestampMs: bytes.getUint32(15, Endian.little),
+    );
+  }
+}
@@ -2,6 +2,7 @@ import 'dart:async';
 import 'dart:convert';
 import 'package:flutter_blue_plus/flutter_blue_plus.dart' as flutter_blue;
 import '../models/sensor_data.dart';
+import '../models/sensor_frame.g.dart';
 import '../core/constants/ble_constants.dart';
 import '../core/utils/logger.dart';
 
@@ -141,8 +142,31 @@ class BluetoothService {
     }
   }
 
-  // Handle incoming data
+  // Handle incoming data. Binary frames first: the parser is generated
+  // from the firmware schema (scripts/codegen/gen_protocol.py), so the
+  // fixed offsets here cannot drift from what the device packs. JSON
+  // remains as the fallback for firmware still in legacy mode.
   void _handleIncomingData(List<int> data) {
+    if (data.isNotEmpty && data[0] == SensorFrame.frameMagic) {
+      SensorFrame? frame = SensorFrame.parse(data);
+      if (frame != null) {
+        _sensorDataController.add(SensorData(
+          deviceId: _connectedDevice?.remoteId.toString() ?? '',
+          userId: '', // Will be set from auth
+          temperature: frame.temperature,
+          humidity: frame.humidity,
+          fanSpeed: frame.fanSpeed,
+          ledBrightness: frame.ledBrightness,
+          motionDetected: frame.motion,
+          distance: frame.distance,
+          timestamp: DateTime.now(),
+        ));
+      }
+      // Other binary frame types (diagnostics, alerts) share the
+      // characteristic; they are handled by their own listeners.
+      return;
+    }
+
     try {
       String jsonString = utf8.decode(data);
       Logger.debug('Received: $jsonString');
@@ -195,6 +219,44 @@ class BluetoothService {
     }
   }
 
+  // Sequenced lossy stream for slider drags: each update goes out as
+  // one write-without-response — no round-trip ack to queue behind —
+  // carrying a sequence number so the firmware applies only the
+  // newest and drops anything stale. Lossy by design: call the
+  // acknowledged setter (setFanSpeed/setLEDBrightness) with the final
+  // value on drag release as the commit.
+  int _streamSeq = 0;
+
+  Future<void> _sendStreamUpdate(int opcode, int value) async {
+    if (_rxCharacteristic == null) return;
+
+    _streamSeq = (_streamSeq + 1) & 0xFF;
+    List<int> bytes = [
+      BLEConstants.cmdMagic,
+      BLEConstants.opStream,
+      _streamSeq,
+      opcode,
+      value,
+    ];
+
+    try {
+      await _rxCharacteristic!.write(bytes, withoutResponse: true);
+    } catch (e) {
+      // A dropped drag update is fine; the next one supersedes it.
+      Logger.debug('Stream update dropped: $e');
+    }
+  }
+
+  Future<void> streamFanSpeed(int speed) async {
+    int value = ((speed / 100) * 255).round().clamp(0, 255);
+    await _sendStreamUpdate(BLEConstants.opSetFan, value);
+  }
+
+  Future<void> streamLEDBrightness(int brightness) async {
+    int value = ((brightness / 100) * 255).round().clamp(0, 255);
+    await _sendStreamUpdate(BLEConstants.opSetLed, value);
+  }
+
   // Control methods
   Future<bool> setFanSpeed(int speed) async {
     int value = ((speed / 100) * 255).round().clamp(0, 255);
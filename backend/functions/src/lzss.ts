@@ -0,0 +1,53 @@
+/**
+ * SmartSync LZSS decoder
+ * Reference decoder for the firmware's upload compression
+ * (firmware/SmartSync_ESP32/src/network/LzssCodec.cpp). Bodies
+ * arrive with Content-Encoding: x-lzss and the original length
+ * carried by the transport.
+ *
+ * Format: a control byte precedes each group of 8 tokens, MSB first;
+ * bit 1 = literal byte, bit 0 = match pair {offset byte (1-255 back),
+ * length byte (length = byte + MIN_MATCH - 1, so 4-258)}. Matches may
+ * overlap their own output, hence the byte-at-a-time copy. The final
+ * control group is left-aligned and may be partial; decoding stops at
+ * the expected output length, never on the bit stream.
+ *
+ * File: backend/functions/src/lzss.ts
+ */
+
+const LZSS_MIN_MATCH = 4;
+
+export function lzssDecode(body: Buffer, originalLength: number): Buffer {
+  const out = Buffer.alloc(originalLength);
+  let inPos = 0;
+  let outPos = 0;
+
+  while (outPos < originalLength) {
+    if (inPos >= body.length) {
+      throw new Error('truncated x-lzss body');
+    }
+    let ctrl = body[inPos++];
+    for (let bit = 0; bit < 8 && outPos < originalLength; bit++) {
+      if (ctrl & 0x80) {
+        if (inPos >= body.length) {
+          throw new Error('truncated x-lzss body');
+        }
+        out[outPos++] = body[inPos++];
+      } else {
+        if (inPos + 2 > body.length) {
+          throw new Error('truncated x-lzss body');
+        }
+        const offset = body[inPos++];
+        const length = body[inPos++] + LZSS_MIN_MATCH - 1;
+        if (offset === 0 || offset > outPos || outPos + length > originalLength) {
+          throw new Error('corrupt x-lzss match');
+        }
+        for (let i = 0; i < length; i++, outPos++) {
+          out[outPos] = out[outPos - offset];
+        }
+      }
+      ctrl = (ctrl << 1) & 0xff;
+    }
+  }
+  return out;
+}
@@ -10,6 +10,24 @@
 #define FIRMWARE_VERSION "1.0.0"
 #define HARDWARE_VERSION "1.0"
 
+// Build info for field verification of what a unit actually runs —
+// the optimization level comes from compiler macros, so it cannot go
+// stale, and BUILD_RELEASE is set by the esp32dev-release environment
+// in platformio.ini. (The compiler only distinguishes -Os / -O0 /
+// "optimized"; the release env's -O2 reports as "O2".)
+#if defined(__OPTIMIZE_SIZE__)
+#define BUILD_OPT_LEVEL "Os"
+#elif defined(__OPTIMIZE__)
+#define BUILD_OPT_LEVEL "O2"
+#else
+#define BUILD_OPT_LEVEL "O0"
+#endif
+#ifdef BUILD_RELEASE
+#define BUILD_INFO "release-" BUILD_OPT_LEVEL "-lto"
+#else
+#define BUILD_INFO "dev-" BUILD_OPT_LEVEL
+#endif
+
 // ============================================================================
 // PIN DEFINITIONS
 // ============================================================================
@@ -17,6 +35,8 @@
 // DHT22 Temperature & Humidity Sensor
 #define DHT_PIN 27
 #define DHT_TYPE DHT22
+#define DHT_START_PULSE_US 2000   // host start signal (spec: 1-10 ms)
+#define DHT_MIN_INTERVAL_MS 2000  // minimum sensor sampling interval
 
 // PIR Motion Sensor
 #define PIR_PIN 25
@@ -25,28 +45,196 @@
 #define ULTRASONIC_TRIG_PIN 32
 #define ULTRASONIC_ECHO_PIN 33
 
+// Multi-sensor deployments (room+window DHT22s, bed+door ultrasonics):
+// SensorBank builds one driver per table entry; channel 0 is the
+// primary that drives auto mode and proximity. Adding a sensor is a
+// count bump and a pin appended to the table.
+#define DHT_SENSOR_COUNT 1
+#define DHT_SENSOR_PINS { DHT_PIN }
+#define ULTRASONIC_SENSOR_COUNT 1
+#define ULTRASONIC_TRIG_PINS { ULTRASONIC_TRIG_PIN }
+#define ULTRASONIC_ECHO_PINS { ULTRASONIC_ECHO_PIN }
+
 // Fan Control (PWM)
 #define FAN_PIN 26
 #define FAN_PWM_CHANNEL 0
 #define FAN_PWM_FREQ 25000
 #define FAN_PWM_RESOLUTION 8
 
+// Inrush limiting: fan duty changes ramp in the LEDC peripheral at
+// this slope (ms per duty count; 4 ≈ 1 s for a full-scale step). A
+// 0-to-full slam browns out the 5 V rail enough to glitch the
+// ultrasonic sensor and corrupt DHT22 frames mid-read.
+#define FAN_RAMP_MS_PER_COUNT 4
+
+// Fan tachometer (FanTach): the PCNT peripheral counts tach pulses in
+// hardware; software reads and clears the counter once per sensor
+// cycle. GPIO 34 is input-only (the open-collector tach line needs an
+// external pull-up). The glitch filter is in APB clock ticks of
+// 12.5 ns; 1023 rejects anything under ~12.8 µs — PWM coupling, not
+// rotation.
+#define FAN_TACH_PIN 34
+#define FAN_TACH_PCNT_UNIT 0
+#define FAN_TACH_PULSES_PER_REV 2
+#define FAN_TACH_FILTER_APB_TICKS 1023
+
+// Stall detection: a duty at or above the floor with RPM below the
+// minimum for this many consecutive sensor cycles gets one recovery
+// re-ramp (off for a cycle, then back up — the restart torque is what
+// unsticks a fan, not more duty); a second strike latches the fault
+// flag into the sensor frame.
+#define FAN_STALL_MIN_DUTY 64
+#define FAN_STALL_MIN_RPM 300
+#define FAN_STALL_CYCLES 3
+
 // LED Control (PWM)
 #define LED_PIN 14
 #define LED_PWM_CHANNEL 1
 #define LED_PWM_FREQ 5000
-#define LED_PWM_RESOLUTION 8
+// 13-bit duty so the gamma table (actuators/GammaLut.h) has headroom
+// at the dim end; 5 kHz × 8192 steps still fits the 80 MHz LEDC clock.
+// Brightness everywhere else (commands, persistence, frames) stays the
+// 0-255 command value — only the final duty write is 13-bit.
+#define LED_PWM_RESOLUTION 13
+#define LED_PWM_MAX ((1 << LED_PWM_RESOLUTION) - 1)
+#define LED_FADE_DEFAULT_MS 1000  // ramp length when a fade gives no duration
+
+// Actuator change quantization: duty micro-adjustments (the long tail
+// auto mode produces every cycle) land on the PWM immediately but are
+// not persisted, notified, or logged until the value has moved at
+// least the deadband AND crossed into another report bucket. The
+// endpoints (off / full) always report. Applies to fan and LED alike.
+#define ACTUATOR_DEADBAND 4
+#define ACTUATOR_REPORT_BUCKET 8
 
 // Buzzer
 #define BUZZER_PIN 13
 
+// Buzzer melody engine (BuzzerEngine): notes compile into RMT symbol
+// buffers the peripheral clocks out on its own. clk_div 80 gives 1 µs
+// ticks off the 80 MHz APB clock; the item budget caps one note's
+// waveform (512 cycles ≈ 500 ms at 1 kHz) and sizes the static
+// buffer. The gap articulates repeated notes at the same pitch.
+#define BUZZER_RMT_CHANNEL 0
+#define BUZZER_RMT_CLK_DIV 80
+#define BUZZER_RMT_MAX_ITEMS 512
+#define BUZZER_NOTE_GAP_MS 15
+
 // RTC I2C (DS3231)
 #define RTC_SDA_PIN 21
 #define RTC_SCL_PIN 22
+#define RTC_I2C_ADDR 0x68
+
+// RtcClock: battery-backed time is read once at boot, maintained from
+// esp_timer, and drift-corrected by a low-priority task on this period
+#define RTC_RESYNC_INTERVAL_MS 3600000
+#define RTC_TASK_STACK 2048
+#define RTC_TASK_PRIORITY 1
+
+// SNTP disciplining: whenever a WiFi feature has the radio up, lwIP's
+// SNTP client syncs asynchronously and the result is written back to
+// the DS3231, so the battery clock stops accumulating drift between
+// phone syncs. No network round trip ever blocks a caller — the sync
+// lands in a callback and the I2C write-back rides the rtc_sync task.
+#define SNTP_SYNC_ENABLED (WIFI_UPLINK_ENABLED || MQTT_TELEMETRY_ENABLED)
+#define NTP_SERVER "pool.ntp.org"
+#define NTP_SYNC_INTERVAL_MS 3600000
 
 // Status LED (built-in)
 #define STATUS_LED_PIN 2
 
+// User button (input/ButtonEngine): momentary switch to ground. GPIO 0
+// already carries the devkit's pull-up and BOOT switch, so bare boards
+// get a working button for free; it is only sampled after boot, so the
+// strap role is untouched. Short press steps the fan through the duty
+// notches, double press toggles the light, long press silences the
+// siren — all local, no radio. The debounce window must clear tact
+// switch chatter (~10 ms) while staying far under the double gap.
+#define BUTTON_PIN 0
+#define BUTTON_DEBOUNCE_US 15000
+#define BUTTON_LONG_PRESS_MS 600
+#define BUTTON_DOUBLE_GAP_MS 300
+#define BUTTON_FAN_STEP 85   // duty notch: 0 / 85 / 170 / 255, then wrap
+
+// Hot-path profiler (system/Profiler): PROFILE_SCOPE brackets cost
+// tens of cycles each, so they stay on in production; field units are
+// profiled through CMD_GET_PROFILE without a reflash. Set to 0 to
+// compile every bracket out.
+#define PROFILER_ENABLED 1
+
+// Heap monitor (system/HeapMonitor): free size, minimum-ever
+// watermark, and largest free block sampled into a ring in RTC slow
+// memory, which survives crashes and resets — after a field death the
+// boot log replays the final hour of allocation behavior. One hour of
+// minute samples costs under 1 KB of the 8 KB RTC region.
+#define HEAP_SAMPLE_INTERVAL_MS 60000
+#define HEAP_RING_ENTRIES 60
+#define HEAP_RING_MAGIC 0x4D485353   // "SSHM"
+
+// Task accounting (system/TaskStats): per-task CPU share and stack
+// high-water marks over the window since the last CMD_GET_TASKS.
+// Must exceed the live task count or uxTaskGetSystemState reports
+// nothing; the stock tree runs ~16 tasks with the radio up.
+#define TASK_STATS_MAX_TASKS 24
+
+// Boot-stage budget: setup() records a timestamp at each stage
+// boundary; the previous boot's breakdown is shadowed in RTC memory
+// and reported through CMD_GET_BOOT, so slow boots are debuggable
+// from the field after the fact.
+#define BOOT_STAGE_MAX 10
+
+// Command-to-actuation latency (system/CmdLatency): per-opcode
+// aggregates plus a slowest-recent trace. Slots cover the opcode
+// space with headroom for new commands.
+#define CMD_LATENCY_SLOTS 32
+
+// Event trace (system/EventTrace): 8-byte state-transition records in
+// a PSRAM ring. 16k records is 128 KB of PSRAM — many hours at the
+// rates these events fire; the internal-RAM fallback keeps minutes.
+#define TRACE_ENABLED 1
+#define TRACE_RING_ENTRIES 16384
+#define TRACE_RING_ENTRIES_FALLBACK 512
+
+// Heap-guard build mode (system/HeapGuard, esp32dev-heapguard env):
+// once setup() completes, malloc/calloc/realloc calls from any task
+// outside the radio/IP-stack allow-list are counted as steady-state
+// violations and their backtraces collected, turning "the hot path is
+// allocation-free" into an enforced invariant for soak runs. Needs
+// the linker --wrap flags, so it is off unless that env sets it.
+#ifndef HEAP_GUARD_ENABLED
+#define HEAP_GUARD_ENABLED 0
+#endif
+#define HEAP_GUARD_TRAP 0           // 1: abort() on the first violation
+#define HEAP_GUARD_OFFENDER_SLOTS 16
+#define HEAP_GUARD_BACKTRACE_DEPTH 4
+#define HEAP_GUARD_REPORT_MS 60000
+
+// Hardware-in-the-loop test rig (system/TestRig, esp32dev-testrig
+// env): designated GPIOs pulse at instrumented points so an external
+// logic analyzer (tests/performance/hil_latency.py) measures true
+// event-to-actuation latency — PIR edge to PWM write — with
+// microsecond precision, including everything software timestamps
+// can't see. Pins 4/18/19 are free on this board (16/17 belong to
+// PSRAM); off by default so production pins stay untouched.
+#ifndef TEST_RIG_ENABLED
+#define TEST_RIG_ENABLED 0
+#endif
+#define TEST_RIG_PIN_SENSOR 4    // pulses at PIR ISR entry
+#define TEST_RIG_PIN_COMMAND 18  // pulses when a validated command dispatches
+#define TEST_RIG_PIN_ACTUATE 19  // pulses at each fan/LED PWM write
+
+// Power benchmark mode (system/PowerBench, esp32dev-power env): steps
+// the firmware through POWER_STATE_* on a fixed schedule with marker
+// pulses on a GPIO, so an external power analyzer
+// (tests/performance/power_profile.py) maps each subsystem to its
+// current draw per firmware build. Shares pin 4 with the latency rig —
+// the two bench envs are mutually exclusive. Off by default.
+#ifndef POWER_BENCH_ENABLED
+#define POWER_BENCH_ENABLED 0
+#endif
+#define POWER_BENCH_PIN_MARKER 4
+#define POWER_BENCH_STATE_MS 15000  // hold per state; analyzer trims settle
+
 // ============================================================================
 // BLE CONFIGURATION
 // ============================================================================
@@ -54,6 +242,100 @@
 #define BLE_SERVICE_UUID "4fafc201-1fb5-459e-8fcc-c5c9c331914b"
 #define BLE_CHARACTERISTIC_UUID_RX "beb5483e-36e1-4688-b7f5-ea07361b26a8"
 #define BLE_CHARACTERISTIC_UUID_TX "beb5483f-36e1-4688-b7f5-ea07361b26a8"
+// Dedicated firmware-transfer characteristic: raw OTA chunks bypass
+// the command parser entirely (see system/FirmwareUpdater)
+#define BLE_CHARACTERISTIC_UUID_OTA "beb54840-36e1-4688-b7f5-ea07361b26a8"
+// Read-only settings characteristic: the whole packed PersistedSettings
+// blob (schema version leads) in one GATT read, so app launch syncs
+// configuration without a round-trip per field. PIN redacted on read.
+#define BLE_CHARACTERISTIC_UUID_SETTINGS "beb54841-36e1-4688-b7f5-ea07361b26a8"
+// Guaranteed-delivery alert characteristic: indications (link-layer
+// acknowledged) with firmware-side redelivery, so a congested or
+// sleeping phone cannot silently miss a fall alarm. Routine telemetry
+// stays on the fire-and-forget TX notifications.
+#define BLE_CHARACTERISTIC_UUID_ALERT "beb54842-36e1-4688-b7f5-ea07361b26a8"
+
+// Simultaneous GATT clients (e.g. caregiver phone plus wall tablet)
+#define BLE_MAX_CLIENTS 4
+
+// High-duty directed advertising burst toward the last bonded peer
+// before falling back to generic advertising (spec caps it at 1.28 s)
+#define BLE_DIRECTED_ADV_MS 1280
+
+// Broadcast the current sensor snapshot in advertising manufacturer
+// data so passive scanners get live values with no connection. 0xFFFF
+// is the SIG test company ID — swap in a real one if we ever register.
+#define BLE_ADV_BROADCAST_ENABLE true
+#define BLE_ADV_COMPANY_ID 0xFFFF
+
+// Adaptive advertising cadence (applyAdvCadence): fast while a
+// connection is likely — the first window after boot, a disconnect,
+// or a PIR edge (someone walked in who may open the app) — decaying
+// to a slow beacon that still serves passive scanners. Intervals in
+// 0.625 ms units.
+#define BLE_ADV_FAST_ITVL_MIN 32    // 20 ms
+#define BLE_ADV_FAST_ITVL_MAX 48    // 30 ms
+#define BLE_ADV_SLOW_ITVL_MIN 1600  // 1.0 s
+#define BLE_ADV_SLOW_ITVL_MAX 1744  // 1.09 s (prime-ish against scanners)
+#define BLE_ADV_FAST_WINDOW_MS 30000
+
+// Preferred ATT MTU; actual value is negotiated per connection. 247
+// keeps one full history chunk in a single link-layer packet with DLE.
+#define BLE_PREFERRED_MTU 247
+
+// Connection-parameter profiles (intervals in 1.25 ms units, timeout
+// in 10 ms units). Interactive pins the interval at 7.5-15 ms so a
+// slider drag actuates inside one frame; monitor relaxes to 100-200 ms
+// with slave latency so both radios sleep between the periodic sensor
+// notifies. BLEService switches to interactive when a command arrives
+// and back to monitor after the quiet window; CMD_SET_CONN_PROFILE
+// lets the app pin either one.
+#define BLE_CONN_INTERACTIVE_ITVL_MIN 6    // 7.5 ms
+#define BLE_CONN_INTERACTIVE_ITVL_MAX 12   // 15 ms
+#define BLE_CONN_INTERACTIVE_LATENCY 0
+#define BLE_CONN_MONITOR_ITVL_MIN 80       // 100 ms
+#define BLE_CONN_MONITOR_ITVL_MAX 160      // 200 ms
+#define BLE_CONN_MONITOR_LATENCY 4         // skippable events at idle
+#define BLE_CONN_SUPERVISION_TIMEOUT 500   // 5 s
+#define BLE_CONN_IDLE_RELAX_MS 30000
+
+// Notify legacy JSON instead of packed binary frames (see SensorFrame.h)
+#define BLE_JSON_COMPAT_DEFAULT false
+
+// Full keyframe every N updates; deltas (changed fields only) between
+#define BLE_KEYFRAME_EVERY 12
+
+// Notification send queue: congestion retries before a frame is dropped
+#define BLE_NOTIFY_RETRY_MAX 3
+#define BLE_NOTIFY_RETRY_DELAY_MS 20
+#define BLE_NOTIFY_TASK_STACK 3072
+
+// Bulk streams yield each chunk slot to a queued alert; past this
+// bound the chunk sequence aborts and the client resumes from its
+// cursor. Generous against one congested connection event, tight
+// against a genuinely saturated link.
+#define BLE_BULK_ALERT_YIELD_MS 250
+
+// Throughput benchmark (CMD_BENCHMARK): default run length and the
+// backoff when the stack reports congestion mid-run
+#define BLE_BENCH_DEFAULT_SECONDS 5
+#define BLE_BENCH_MAX_SECONDS 30
+#define BLE_BENCH_BACKOFF_MS 2
+#define BLE_BENCH_TASK_STACK 3072
+
+// Soak mode (CMD_SOAK): periodic SoakMetricsFrames for long stress
+// runs (tests/performance/soak_monitor.py). The task-entry cap keeps
+// the frame inside one preferred-MTU notification.
+#define SOAK_TASK_ENTRIES 8
+
+// Session authentication (ble/SessionAuth): with a device PIN set,
+// mutating commands need a per-command MAC under a key negotiated by
+// the CMD_AUTH_START/CMD_AUTH challenge-response. The iteration count
+// is the PIN-stretch cost: ~20 ms of chained HMAC per guess caps
+// online grinding of a short PIN, paid once per boot for the
+// legitimate app because the stretched key is cached. Per-command
+// verification is two HMAC blocks — microseconds.
+#define AUTH_KDF_ITERATIONS 2048
 
 // ============================================================================
 // SENSOR THRESHOLDS
@@ -66,48 +348,667 @@
 // Motion detection timeout (milliseconds)
 #define MOTION_TIMEOUT 300000  // 5 minutes
 
+// PIR glitch rejection. The fan PWM (FAN_PWM_FREQ, 25 kHz) couples
+// microsecond bursts onto the PIR line; a real PIR transition is
+// seconds from its neighbor. Stage 1 drops edges closer than this to
+// the previous one inside the ISR (cycle-counter interval, no queue
+// wake); stage 2 requires the level to still hold when the sensor
+// task dequeues the edge, so a glitch pair that beat the interval
+// gate never commits. The classic ESP32 has no per-pin hardware
+// glitch filter, so both stages are software.
+#define PIR_GLITCH_REJECT_US 150
+
+// Alert escalation ladder. A standing motion timeout climbs: the
+// local chime fires with the timeout itself (MOTION_TIMEOUT or the
+// learned per-hour threshold), then the app is re-notified over BLE,
+// then the caregiver path (the MQTT mirror) gets an urgency event —
+// each delay measured from the initial raise, all cancelled the
+// moment motion resumes. Stages ride the hashed timer wheel
+// (system/TimerWheel.h) ticked from the periodic schedule check, so
+// the delays are quantized to SCHEDULE_CHECK_INTERVAL — irrelevant at
+// minute scale.
+#define ESCALATION_TICK_MS 1000
+#define ESCALATION_APP_DELAY_MS 300000    // +5 min: re-notify the app
+#define ESCALATION_CLOUD_DELAY_MS 600000  // +10 min: caregiver urgency
+#define ESCALATION_TIMER_CAPACITY 16      // wheel pool (stages x zones)
+
 // Distance threshold for proximity alert (cm)
 #define PROXIMITY_THRESHOLD 50
 
+// Hysteresis band above the threshold (cm): the ISR comparator
+// breaches below PROXIMITY_THRESHOLD but only clears beyond threshold
+// plus band, so a resident hovering at the edge doesn't chatter
+// breach/clear events every echo
+#define PROXIMITY_HYSTERESIS 5
+
+// Maximum wait for an HC-SR04 echo (~4 m round trip is ~24 ms)
+#define ULTRASONIC_TIMEOUT_MS 35
+
+// EWMA smoothing (Q0.16 alpha, 65536 = 1.0) between raw DHT22 reads
+// and sensorData; 16384 = 0.25 settles in ~4 samples
+#define EWMA_ALPHA_TEMP_Q16 16384
+#define EWMA_ALPHA_HUMIDITY_Q16 16384
+
+// Ultrasonic median-of-5: a sample further than this from the running
+// median is gated as a single-echo outlier (cm)
+#define DISTANCE_OUTLIER_CM 40.0f
+
+// Per-unit calibration defaults, one entry per channel (floats here,
+// converted to fixed point at compile time — see
+// sensors/Calibration.h). Seeded into the settings blob on first
+// boot; after that the persisted copy is authoritative, so units can
+// be trimmed in the field without a rebuild.
+#define CAL_TEMP_OFFSETS { 0.0f }   // °C added to each DHT channel
+#define CAL_HUM_OFFSETS { 0.0f }    // %RH added to each DHT channel
+#define CAL_DIST_SCALES { 1.0f }    // scale on each ultrasonic channel
+
+// Sensor fault quarantine: consecutive failed cycles before a channel
+// stops being polled, and the recovery-probe backoff in acquisition
+// cycles (doubling per failed probe; 64 ≈ 10 min at the 10 s cadence)
+#define SENSOR_FAULT_THRESHOLD 5
+#define SENSOR_FAULT_BACKOFF_START 4
+#define SENSOR_FAULT_BACKOFF_MAX 64
+
+// Temperature trend (TrendEstimator.h, double EWMA): level and slope
+// smoothing, and the projection horizon predictive auto mode acts on
+#define TREND_ALPHA 0.3f
+#define TREND_BETA 0.1f
+#define TREND_HORIZON_MS 900000  // 15 minutes
+
+// Occupancy estimator (OccupancyEstimator.h): auto mode actuates only
+// at or above the confidence floor; PIR evidence decays over the same
+// window as the motion timeout; distance must close on the empty-room
+// baseline by this much to count; the time-of-day prior is active
+// between these hours
+#define OCCUPANCY_CONFIDENCE_MIN 96
+#define OCCUPANCY_PIR_DECAY_MS MOTION_TIMEOUT
+#define OCCUPANCY_DISTANCE_DELTA_CM 30.0f
+#define OCCUPANCY_ACTIVE_HOUR_START 7
+#define OCCUPANCY_ACTIVE_HOUR_END 23
+
+// Zone classifier (ZoneClassifier.h): distance bands in millimetres,
+// measured from the unit at its bedside mount. Inside the bed band is
+// "in bed", the next band is standing beside it, the last reaches the
+// doorway; past everything the room reads empty. Edges lean toward
+// the current zone by the hysteresis margin, and a new zone must hold
+// for the dwell before its transition event publishes.
+#define ZONE_BED_MAX_MM 900
+#define ZONE_BESIDE_MAX_MM 1800
+#define ZONE_DOOR_MAX_MM 3000
+#define ZONE_HYSTERESIS_MM 120
+#define ZONE_MIN_DWELL_MS 3000
+
+// Closed-loop fan PID (FanController): setpoint and gains in duty
+// counts per °C / °C·s / (°C/s), converted to Q8.8 at compile time.
+// The setpoint here is the compile-time default; a user-customized
+// target persists in the settings blob (CMD_SET_SETPOINT) and
+// overrides it at boot. The deadband is the smallest duty change
+// worth actuating — below it a change is inaudible but still costs
+// an NVS write and a BLE delta.
+#define FAN_PID_SETPOINT_C 26.0f
+#define FAN_PID_KP 40.0f
+#define FAN_PID_KI 0.05f
+#define FAN_PID_KD 60.0f
+#define FAN_PID_DEADBAND 6
+
+// Auto-mode anti-flap: the over-temperature override and the
+// occupancy gate are the remaining hard boundaries, so each gets a
+// hysteresis band, and auto-driven speed changes hold a minimum dwell
+// so a hovering reading can't flip states every sensor cycle (each
+// flip is an NVS commit and a BLE delta). Transitions are counted so
+// field logs can verify the flapping actually stopped.
+#define TEMP_MAX_HYSTERESIS_C 1.0f
+#define OCCUPANCY_HYSTERESIS 32
+#define FAN_MIN_DWELL_MS 60000
+
+// ============================================================================
+// SCHEDULES
+// ============================================================================
+// Persisted schedule entries (ScheduleManager), packed because they
+// live inside the settings blob. daysMask bit 0 is Sunday; an enabled
+// entry with an empty mask never fires.
+struct __attribute__((packed)) ScheduleEntry {
+    uint8_t enabled;  // 0 = empty slot
+    uint8_t action;   // ScheduleManager::Action
+    uint8_t value;    // duty, brightness, or on/off
+    uint8_t hour;     // 0-23
+    uint8_t minute;   // 0-59
+    uint8_t daysMask; // bit 0 = Sunday ... bit 6 = Saturday
+};
+#define SCHEDULE_MAX_ENTRIES 8
+
 // ============================================================================
-// AUTO MODE SETTINGS
+// SCENES
 // ============================================================================
-struct AutoModeSettings {
-    float tempLow = 24.0f;
-    float tempHigh = 28.0f;
-    uint8_t fanSpeedLow = 77;   // 30%
-    uint8_t fanSpeedMed = 128;  // 50%
-    uint8_t fanSpeedHigh = 191; // 75%
+// Named actuator presets (CMD_SET_SCENE): fan, LED and auto mode land
+// in one command dispatch — both LEDC writes back to back, every dirty
+// mark coalescing into the same deferred NVS commit — instead of a
+// BLE round trip per actuator. Packed: lives in the settings blob.
+struct __attribute__((packed)) ScenePreset {
+    uint8_t inUse;         // 0 = empty slot
+    uint8_t fanSpeed;      // raw PWM duty
+    uint8_t ledBrightness; // raw PWM duty
+    uint8_t autoMode;      // bool
+    char name[8];          // not NUL-terminated when full
 };
+#define SCENE_MAX_COUNT 4
+
+// ============================================================================
+// FREERTOS TASK SETTINGS
+// ============================================================================
+// Sensor acquisition is pinned to core 0, BLE/command handling to core 1.
+#define SENSOR_TASK_STACK 4096
+#define SENSOR_TASK_PRIORITY 1
+#define SENSOR_TASK_CORE 0
+
+#define BLE_TASK_STACK 4096
+#define BLE_TASK_PRIORITY 2
+#define BLE_TASK_CORE 1
+
+#define WATCHDOG_TASK_STACK 2048
+#define WATCHDOG_TASK_PRIORITY 3
+
+// Alarm drain task (AlarmSystem): outranks everything else so an
+// emergency raise reaches the buzzer in one notify-wake. The ring is
+// sized for bursts, not backlog — alarms are rare and latch.
+#define ALARM_TASK_STACK 2560
+#define ALARM_TASK_PRIORITY 4
+#define ALARM_TASK_CORE 1
+
+// ML inference task: shares the idle priority on the sensor core —
+// opposite the BLE core in the dual-core split — so scoring never
+// preempts sampling, and a BLE command arriving mid-inference is
+// served on the other core without waiting on the model at all.
+// Event-driven: blocked on its queue between samples, which keeps the
+// idle task (and the task watchdog it feeds) running.
+#define ML_TASK_STACK 3072
+#define ML_TASK_PRIORITY 0
+#define ML_TASK_CORE 0
+#define ML_QUEUE_LENGTH 8
+#define ALARM_QUEUE_LENGTH 8
+
+#define COMMAND_QUEUE_LENGTH 8
+#define SENSOR_EVENT_QUEUE_LENGTH 16
+
+// Load shedding: when the command queue backs up past the high mark the
+// dispatcher sheds logging first, then notifications, then degrades the
+// sensor rate; everything restores below the low mark.
+#define LOAD_SHED_QUEUE_HIGH 4
+#define LOAD_SHED_QUEUE_LOW 1
+
+// Memory reserve gates (test/test_margins): the margin test drives the
+// worst-case concurrent path at the production stack sizes above and
+// fails when a high-water mark eats into these reserves, so stack
+// sizing stays measured instead of guessed-and-padded.
+#define STACK_MARGIN_MIN_BYTES 512   // free stack left at high water
+#define HEAP_MARGIN_MIN_BYTES 32768  // min-free-heap floor under burst
+
+// Stack placement (system/StackPlacer): flash-free tasks (log drain,
+// mqtt, rtc sync) take PSRAM stacks on -DBOARD_HAS_PSRAM builds,
+// returning their internal DRAM to NimBLE buffers and the history
+// index. Runtime-safe to leave on: boards without PSRAM fall back to
+// internal stacks when the SPIRAM allocation fails.
+#define STACK_PSRAM_ENABLED 1
 
 // ============================================================================
 // TIMING CONSTANTS
 // ============================================================================
 #define SENSOR_READ_INTERVAL 10000   // 10 seconds
+#define SENSOR_READ_INTERVAL_DEGRADED 30000 // fallback rate under load
+
+// History index: one sparse entry per N records (~every 10-11 min of
+// data); 960 KB of log costs under 8 KB of RAM
+#define HISTORY_INDEX_STRIDE 64
+
+// Rollup region carved from the tail of the history partition
+// (storage/RollupStore): sealed minute/hour min/max/mean buckets so
+// chart queries read tens of records, not thousands of raw samples.
+// One stream per granularity — a day of minute buckets can't evict
+// weeks of hour buckets. 32-byte records: 12 sectors ≈ 25 h of
+// minutes, 4 sectors ≈ 21 days of hours; the raw log keeps the rest
+// of the partition (~9.5 days at SENSOR_READ_INTERVAL).
+#define HISTORY_ROLLUP_MINUTE_SECTORS 12
+#define HISTORY_ROLLUP_HOUR_SECTORS 4
+
+// Ceiling on CMD_GET_CHART point counts — wider than any phone chart,
+// and the LTTB pass costs O(range) flash reads regardless of it
+#define CHART_MAX_POINTS 512
+
+// High-rate sampling into the PSRAM ring (distance pings plus PIR
+// edges) for the fall-detection analysis. The cadence is adaptive:
+// 1 Hz while motion is active, then after a quiet period of stillness
+// the interval doubles each sample until the idle ceiling.
+#define HIGHRATE_SAMPLE_INTERVAL_MS 1000
+#define HIGHRATE_IDLE_MAX_INTERVAL_MS 30000
+#define HIGHRATE_DECAY_QUIET_MS 60000
+#define HIGHRATE_RING_BYTES (256 * 1024)
 #define BLE_UPDATE_INTERVAL 5000     // 5 seconds
+// Floor for CMD_SUBSCRIBE per-client periods: a misbehaving app can
+// speed its own stream up, but not to per-connection-event rates.
+#define BLE_SUBSCRIBE_MIN_PERIOD_MS 250
+// Reconnect catch-up ring: recent sealed frames kept in RAM (recorded
+// with or without a client connected) and burst to a newly subscribed
+// client so its chart backfills without touching the flash history
+// path. 120 frames × 19 bytes ≈ 2.3 KB.
+#define BLE_CATCHUP_RING_FRAMES 120  // ~10 min at the 5 s cadence
+#define BLE_CATCHUP_INTERVAL_MS 5000 // ring record cadence
+// Guaranteed alert delivery: unacked alert indications retransmit
+// with doubling backoff until the phone's link layer confirms; the
+// newest unacked alert also rides RTC memory across resets.
+#define ALERT_PENDING_MAX 4          // redelivery slots
+#define ALERT_RETRY_BASE_MS 2000     // first retransmit delay
+#define ALERT_RETRY_MAX_MS 60000     // backoff ceiling
+#define ALERT_RETRY_TICK_MS 500      // pump granularity while pending
+#define ALERT_INDICATE_GUARD_MS 5000 // in-flight watchdog past NimBLE's own
 #define SCHEDULE_CHECK_INTERVAL 60000 // 1 minute
-#define WATCHDOG_TIMEOUT 30000       // 30 seconds
+#define WATCHDOG_TIMEOUT 30000       // 30 seconds (hardware backstop)
+#define WATCHDOG_CHECK_INTERVAL 1000 // supervisor deadline sweep
+
+// Idle-slice self-test (system/SelfTest): one bounded check per quiet
+// sensor slice, cycling coherence / fan tach / RTC drift / NVS
+// read-back. Any queued event skips the slice entirely.
+#define SELFTEST_STEP_INTERVAL_MS 15000    // one check; full cycle ~1 min
+#define SELFTEST_COHERENCE_MIN_SAMPLES 8   // motion samples per verdict
+#define SELFTEST_COHERENCE_DIST_DELTA_CM 2.0f // echo must move this much
+#define SELFTEST_RTC_DRIFT_MAX_S 5         // SNTP-measured drift bound
+
+// Daily wellness summary (system/WellnessSummary): the night window
+// and the hour its rollups seal into the one-frame morning answer.
+// Comfort band is the temperature range counted as comfortable sleep.
+#define WELLNESS_NIGHT_START_HOUR 21
+#define WELLNESS_SUMMARY_HOUR 7
+#define WELLNESS_COMFORT_MIN_C 18.0f
+#define WELLNESS_COMFORT_MAX_C 24.0f
 
 // ============================================================================
 // STORAGE KEYS
 // ============================================================================
 #define PREF_NAMESPACE "smartsync"
+
+// All settings live in one versioned, CRC-guarded blob (SettingsStore),
+// journaled across two slots so a brownout mid-commit can only tear
+// the inactive copy
+#define PREF_SETTINGS_SLOT_A "settings_a"
+#define PREF_SETTINGS_SLOT_B "settings_b"
+
+// Pre-journal single-key blob, kept only for the one-time migration
+#define PREF_SETTINGS_BLOB "settings"
+
+// Legacy per-key names, kept only for the one-time blob migration
 #define PREF_DEVICE_ID "device_id"
 #define PREF_DEVICE_PIN "device_pin"
 #define PREF_AUTO_MODE "auto_mode"
 #define PREF_FAN_SPEED "fan_speed"
 #define PREF_LED_BRIGHTNESS "led_bright"
+#define PREF_LAST_PEER "last_peer"
+#define PREF_OCC_BASELINE "occbase"
+#define PREF_UPLINK_SEQ "uplink_seq"
+
+// Deferred NVS writes: setters update RAM immediately and mark keys
+// dirty; one commit runs after a quiet period, or at the latest after
+// the cap — a slider drag costs one flash op instead of dozens
+#define PREFS_FLUSH_QUIET_MS 2000
+#define PREFS_FLUSH_MAX_MS 10000
+
+// ============================================================================
+// FLASH PARTITIONS
+// ============================================================================
+// Labels and data subtypes from partitions_smartsync.csv. History and
+// model are raw partitions accessed through PartitionMap; read-mostly
+// ones are memory-mapped so reads are pointer dereferences
+#define PARTITION_LABEL_HISTORY "history"
+#define PARTITION_LABEL_MODEL "model"
+#define PARTITION_LABEL_CAPTURE "capture"
+#define PARTITION_SUBTYPE_HISTORY 0x40
+#define PARTITION_SUBTYPE_MODEL 0x41
+#define PARTITION_SUBTYPE_CAPTURE 0x42
+
+// ============================================================================
+// TRAINING CAPTURE
+// ============================================================================
+// Labeled training windows (storage/CaptureStore): an alarm-path
+// trigger freezes the most recent slice of the high-rate ring into a
+// compressed flash record, exported in bulk over the history-sync
+// channel. The window covers the minutes leading into the event at
+// whatever rate the ring was sampling.
+#define CAPTURE_MAGIC 0x45435353       // "SSCE", little-endian
+#define CAPTURE_WINDOW_SAMPLES 600     // ~10 min at the 1 Hz active rate
+#define CAPTURE_MIN_GAP_MS 60000       // flapping alarms don't chew flash
+
+// ============================================================================
+// MODEL STORE
+// ============================================================================
+// Directory of quantized model blobs at the head of the model
+// partition (ml/ModelStore). The partition is memory-mapped once at
+// boot and consumers reference weights straight from mapped flash —
+// zero copy, no RAM beyond activations. Each entry is identified by a
+// four-char magic and CRC-guarded individually.
+#define MODEL_DIR_MAGIC 0x444D5353  // "SSMD", little-endian
+#define MODEL_DIR_VERSION 2         // v2: generation counter (banking)
+#define MODEL_DIR_MAX_ENTRIES 8
+
+// Model updates (ml/ModelUpdater): the partition is split into two
+// banks; a transfer lands blockwise in the inactive bank and the
+// generation counter in its directory makes the switch — the active
+// bank is never touched, so a torn or bad transfer can't take models
+// offline, let alone brick the unit.
+#define MODEL_BANK_COUNT 2
+#define FALL_MODEL_MAGIC 0x574C4146 // "FALW", little-endian
+#define FALL_MODEL_VERSION 1
+
+// Inference arena (ml/InferenceArena): every ML working buffer is
+// carved from this one block at init (PSRAM when fitted) and the
+// arena is then sealed — steady-state inference performs zero heap
+// operations. Sized with headroom for model growth; the seal log line
+// shows actual use.
+#define ML_ARENA_BYTES 4096
+
+// ============================================================================
+// WIFI UPLINK
+// ============================================================================
+// Optional direct-to-backend uplink (network/CloudUplink): history
+// records batch into one compressed TLS POST on a slow cadence, with
+// store-and-forward from the history partition across outages. Off by
+// default — most installs relay through the phone app — and compiled
+// out entirely when disabled so the BLE-only build pays nothing.
+#define WIFI_UPLINK_ENABLED 0
+#define WIFI_UPLINK_SSID ""
+#define WIFI_UPLINK_PASSWORD ""
+// The history-chunk ingest endpoint (backend/functions); the body is
+// the same delta-varint chunk stream the BLE history sync notifies.
+#define UPLINK_URL "https://us-central1-smartsync.cloudfunctions.net/ingestHistory"
+#define UPLINK_INTERVAL_MS 900000       // one batch per 15 min
+#define UPLINK_BATCH_RECORDS 512        // ≈ 85 min of 10 s samples
+#define UPLINK_BODY_BYTES 8192          // encoded batch buffer (PSRAM)
+#define UPLINK_CONNECT_TIMEOUT_MS 15000
+// Catch-up cap per radio-on window: after an outage the task drains
+// up to this many batches over ONE kept-alive TLS connection — the
+// 2-4 s handshake is paid once, not per batch.
+#define UPLINK_MAX_BATCHES_PER_WAKE 8
+#define UPLINK_TASK_STACK 6144          // TLS handshake needs room
+#define UPLINK_TASK_PRIORITY 1
+#define UPLINK_TASK_CORE 1
+
+// ============================================================================
+// MQTT TELEMETRY
+// ============================================================================
+// Local-broker mode for facility deployments (network/MqttTelemetry):
+// the packed BLE frame formats publish to an on-site MQTT broker
+// instead of (or alongside) the Firebase path. Alerts go out QoS 1
+// the moment they raise; routine telemetry coalesces into one QoS 0
+// publish per minute, so a 50-unit floor stays gentle on the broker
+// and the 2.4 GHz band. The session is persistent (clean_session off)
+// so reconnects skip re-subscription. Shares WIFI_UPLINK_SSID
+// credentials; unlike the uplink, the radio stays associated.
+#define MQTT_TELEMETRY_ENABLED 0
+#define MQTT_BROKER_URI "mqtt://broker.local:1883"
+#define MQTT_TOPIC_PREFIX "smartsync"   // <prefix>/<device-id>/telemetry|alert
+#define MQTT_BATCH_INTERVAL_MS 60000
+#define MQTT_BATCH_FRAMES 8             // 10 s cadence -> 6/min + headroom
+#define MQTT_KEEPALIVE_S 120
+#define MQTT_TASK_STACK 4096
+#define MQTT_TASK_PRIORITY 1
+#define MQTT_TASK_CORE 1
+
+// ============================================================================
+// DELTA OTA
+// ============================================================================
+// Patch-based firmware updates (network/DeltaOta): instead of pushing
+// the full ~1.4 MB image, tooling POSTs a patch that rebuilds the new
+// image mostly by copying ranges of the RUNNING one — the device is
+// its own dictionary, so typical updates are tens of KB. The patch
+// streams into the inactive OTA slot with a fixed 1 KB receive buffer
+// and a 256-byte copy window; nothing scales with image size. The
+// device reports its version at GET /version for patch selection.
+// Shares WIFI_UPLINK_SSID credentials, like the other WiFi modes.
+#define OTA_DELTA_ENABLED 0
+#define OTA_HTTP_PORT 3233           // espota's 3232 + 1, same firewall rules
+#define OTA_DELTA_KEY "smartsync"    // mirrors the espota auth password
+#define OTA_PATCH_MAGIC 0x50445353   // "SSDP" little-endian
+
+// ============================================================================
+// BLE OTA
+// ============================================================================
+// Full-image firmware transfer over BLE (system/FirmwareUpdater) for
+// units whose homes never configured WiFi. Chunks arrive on the
+// dedicated OTA characteristic as {offset u32, crc32 u32, bytes} and
+// stream straight into the inactive app slot — no RAM staging, one
+// MTU-sized chunk in flight at a time. Each chunk's CRC is checked
+// before the flash write, the begin/commit control path rides the
+// authenticated command channel, and a matching re-BEGIN after a
+// disconnect resumes at the reported offset instead of starting over.
+#define OTA_BLE_CHUNK_HEADER_LEN 8   // offset + per-chunk CRC
+#define OTA_BLE_REBOOT_DELAY_MS 750  // let the final status frame flush
+
+// Boot health gate (system/BootHealthGate): after any OTA commit the
+// next firmware runs on probation — it must start BLE advertising and
+// complete a full sensor cycle within the budget, across at most the
+// allowed boot attempts (a crash loop burns one per reset), or the
+// gate flips the boot slot back to the previous image. The Arduino
+// sdkconfig ships without the IDF bootloader rollback, so the gate
+// lives in the app: worst-case bad-update downtime is the probation
+// budget times the attempt cap, then the old firmware is back.
+#define OTA_BOOT_MAX_ATTEMPTS 3
+#define OTA_BOOT_HEALTH_BUDGET_MS 60000
+#define PREF_OTA_GUARD "ota_guard"   // pending-probation record in NVS
+
+// ============================================================================
+// MDNS DISCOVERY
+// ============================================================================
+// Service advertisement (network/MdnsAdvertiser): whenever a WiFi
+// feature has an IP, the unit answers _smartsync._tcp queries with
+// its device ID, firmware version, and capability flags in TXT
+// records. Deployment tooling and the app resolve any unit in
+// milliseconds instead of probing the subnet, and fleet OTA jobs
+// enumerate targets from one query.
+#define MDNS_ENABLED (WIFI_UPLINK_ENABLED || MQTT_TELEMETRY_ENABLED || \
+                      WS_SERVER_ENABLED)
+#define MDNS_SERVICE "smartsync"    // advertised as _smartsync._tcp
+#define MDNS_HOSTNAME_PREFIX "smartsync-"  // + device ID in hex
+
+// ============================================================================
+// WEBSOCKET LIVE SERVER
+// ============================================================================
+// LAN dashboard endpoint (network/WsLiveServer): a WebSocket at
+// ws://<device>:<port>/live streams the same packed SensorFrames the
+// BLE notify carries, so facility wall displays subscribe directly
+// over WiFi instead of each needing a BLE relay. Per-client frame
+// queues with slow-client eviction keep one stalled viewer from
+// backing up the rest. Shares WIFI_UPLINK_SSID credentials and keeps
+// the radio associated, like the MQTT mode.
+#define WS_SERVER_ENABLED 0
+#define WS_SERVER_PORT 8080
+#define WS_MAX_CLIENTS 8        // bounded by lwIP's socket budget
+#define WS_CLIENT_QUEUE 8       // frames buffered per client before eviction
+
+// ============================================================================
+// ESP-NOW MESH
+// ============================================================================
+// Peer exchange between co-located units (network/EspNowMesh):
+// connectionless broadcasts of a packed room snapshot, so multi-room
+// homes share occupancy context without the phone fanning out BLE
+// connections. Cross-room context feeds the motion-timeout alert —
+// a resident moving in another room means the house isn't quiet.
+// Opt-in: ESP-NOW holds the WiFi radio in STA (unassociated), which
+// costs BLE airtime the single-unit install shouldn't pay.
+#define ESPNOW_MESH_ENABLED 0
+#define ESPNOW_CHANNEL 1             // all units must share a channel
+#define ESPNOW_FRAME_MAGIC 0xA7      // distinct from BLE FRAME_MAGIC
+#define ESPNOW_FRAME_VERSION 1
+#define ESPNOW_MAX_PEERS 4           // units per home, aggregator included
+#define ESPNOW_PEER_STALE_MS 90000   // drop a room after 3 missed sends
+#define ESPNOW_SEND_INTERVAL_MS 30000
+// Time beacon + sampling slots: co-located HC-SR04s hear each other's
+// pings, so the aggregation unit (ESPNOW_BEACON_MASTER build) beacons
+// its clock and every unit takes a time-division slot — derived from
+// MAC ordering, so no assignment protocol — for its periodic
+// ultrasonic burst. Sample RATE is unchanged; only the phase shifts.
+#define ESPNOW_BEACON_MASTER 0
+#define ESPNOW_BEACON_MAGIC 0xA8     // distinct from the snapshot magic
+#define ESPNOW_SLOT_MS 60            // > one full HC-SR04 burst + echo tail
+#define ESPNOW_SLOT_COUNT (ESPNOW_MAX_PEERS + 1)
+// Aggregation role: the beacon-master unit also multiplexes its
+// peers' snapshots to the phone as unit-tagged frames and relays
+// actuator commands back over ESP-NOW unicast — one BLE connection
+// serves the whole home, and peers never need a phone of their own.
+#define ESPNOW_CMD_MAGIC 0xA9        // distinct from snapshot and beacon
+#define ESPNOW_CMD_MAX_PAYLOAD 8     // covers every relayable opcode
+// Emergency fan-out: falls and breaches broadcast to every unit so
+// the whole house sounds, not just the room that saw the event. Sent
+// blind N times per event (no acks in the critical path); receivers
+// dedup on the per-sender sequence number.
+#define ESPNOW_ALARM_MAGIC 0xAA      // distinct from the frames above
+#define ESPNOW_ALARM_REPEATS 3       // copies per event, loss cover
+
+// OTA pacing (system/OtaPacer): firmware transfers are background
+// work — a full-speed image push saturates the radio and the flash
+// write path exactly while the unit must keep monitoring. Every OTA
+// transport waits out standing emergencies and then spaces its flash
+// writes, trading transfer time for intact command and alarm budgets.
+#define OTA_PACE_GAP_MS 15           // min gap between writes; 0 = full speed
+#define OTA_PACE_ALERT_POLL_MS 250   // recheck cadence while paused
+
+// ============================================================================
+// OCCUPANCY BASELINE
+// ============================================================================
+// Learned per-hour quiet-time baseline (ml/OccupancyBaseline): the
+// motion-timeout alert compares against what is normal for this home
+// at this hour instead of the one-size MOTION_TIMEOUT. The EWMA of
+// each hour's longest motionless gap is constant memory (24 slots)
+// and persists daily to NVS.
+#define OCC_BASELINE_VERSION 1
+#define OCC_BASELINE_MIN_DAYS 3      // serve the static default until then
+#define OCC_BASELINE_ALPHA_SHIFT 2   // EWMA weight 1/4 per day
+#define OCC_BASELINE_MARGIN_NUM 3    // alert at 1.5x the learned gap
+#define OCC_BASELINE_MARGIN_DEN 2
+#define OCC_BASELINE_TIMEOUT_MIN_MS 120000   // never tighter than 2 min
+#define OCC_BASELINE_TIMEOUT_MAX_MS 3600000  // never looser than 1 h
+
+// ============================================================================
+// ANOMALY DETECTION
+// ============================================================================
+// On-device scoring of the ml/ anomaly features (ml/AnomalyDetector).
+// The per-home baseline lives in the model partition as an
+// AnomalyBaseline blob; compiled-in population defaults cover a blank
+// partition. Scoring starts once this many hourly bins have filled
+// after boot.
+#define ANOMALY_FEATURE_COUNT 5
+#define ANOMALY_MODEL_MAGIC 0x4D4F4E41  // "ANOM", little-endian
+#define ANOMALY_MODEL_VERSION 1
+#define ANOMALY_MIN_HOURS 4
+#define ANOMALY_COMFORT_TEMP_C100 2200  // 22 °C, the trainer's comfort point
+#define ANOMALY_NIGHT_START_HOUR 22
+#define ANOMALY_NIGHT_END_HOUR 6
+
+// ============================================================================
+// FALL DETECTION
+// ============================================================================
+// Classifier over the PSRAM high-rate ring (ml/FallDetector): a rapid
+// distance step followed by prolonged low stillness with no PIR
+// activity. Distances are cm × 10 like HighRateSample; variance is in
+// those units squared. The score threshold is Q16 (weights Q8 ×
+// features Q8); recovery clears the alarm after sustained PIR edges.
+#define FALL_WINDOW_SAMPLES 32
+#define FALL_STILL_SAMPLES 8
+#define FALL_DELTA_MIN 400          // 40 cm step to even be a candidate
+#define FALL_STILL_VAR_MAX 2500     // tail variance ceiling (5 cm sigma)
+#define FALL_PIR_QUIET_EDGES_MAX 1  // rising edges tolerated in the tail
+#define FALL_SCORE_THRESHOLD_Q16 49152
+#define FALL_RECOVERY_EDGES 4
+#define FALL_RECOVERY_WINDOW_MS 60000
+
+// ============================================================================
+// POWER MANAGEMENT
+// ============================================================================
+// Automatic light sleep between scheduled events. Requires the IDF
+// power-management and tickless-idle options (PM_ENABLE /
+// FREERTOS_USE_TICKLESS_IDLE) in the core config. The BT controller
+// follows the PM locks, so BLE stays connectable through sleep.
+#define POWER_SAVE_ENABLE true
+#define PM_MAX_FREQ_MHZ 240
+#define PM_MIN_FREQ_MHZ 80
+
+// Battery (deep-sleep duty cycle) profile for the outlet-less variant
+// (system/BatteryProfile, esp32dev-battery env). The cores deep-sleep
+// between sensor windows; wake sources are the RTC timer (next
+// window) and EXT0 on PIR_PIN — GPIO 25 is RTC-capable, so a motion
+// edge powers the chip straight up with no ULP program in the loop.
+// State rides RTC slow memory (RtcState) through every sleep. BLE
+// reduces to an advertising burst per awake window; a client that
+// connects during the burst holds the unit awake until it leaves.
+// Off by default: mains units keep the always-on architecture.
+#ifndef BATTERY_PROFILE_ENABLED
+#define BATTERY_PROFILE_ENABLED 0
+#endif
+#define BATTERY_WAKE_WINDOW_MS 4000 // awake budget per duty cycle
+#define BATTERY_MIN_SLEEP_MS 2000   // below this, sleeping costs more
+                                    // (radio/sensor restart) than it saves
+
+// ULP proximity watcher (system/UlpProximity, battery profile only).
+// While the cores deep-sleep, the ULP coprocessor pings the HC-SR04
+// every period, times the echo in poll-loop units and wakes the chip
+// after ULP_PROXIMITY_CONFIRM consecutive echoes inside
+// PROXIMITY_THRESHOLD — proximity coverage never goes dark between
+// wake windows. ULP_TIMING_LOOP_NS is the measured cost of one
+// echo-poll loop iteration (ULP-FSM instructions are multi-cycle and
+// RTC register reads dominate); recalibrate against a ruler if the
+// loop in UlpProximity.cpp changes.
+#define ULP_PROXIMITY_PERIOD_MS 500
+#define ULP_PROXIMITY_CONFIRM 2       // consecutive breach pings to wake
+#define ULP_TIMING_LOOP_NS 2400       // one poll-loop iteration
+#define ULP_ECHO_START_TIMEOUT_LOOPS 4000 // give up awaiting the rise
 
 // ============================================================================
 // DEBUG SETTINGS
 // ============================================================================
+// Overridable so the host test env can compile logging out — the ring
+// logger is a UART-fed task that does not exist off target.
+#ifndef DEBUG_SERIAL
 #define DEBUG_SERIAL true
+#endif
 #define DEBUG_BAUD_RATE 115200
 
+// Deferred logging (system/RingLogger): producers format on their own
+// stack and copy into a preallocated ring in microseconds; a drain
+// task just above idle feeds the UART. A full ring drops the oldest
+// whole lines and reports the gap in-band.
+#define LOG_RING_BYTES 4096
+#define LOG_LINE_MAX 160          // longest single formatted line
+#define LOG_DRAIN_TASK_STACK 2560
+#define LOG_DRAIN_TASK_PRIORITY 1
+#define LOG_DRAIN_TASK_CORE 1
+
+// Serial diagnostics console (system/SerialCli): a fixed-table CLI
+// polled from the log drain task's idle time, so a bench session reads
+// state without adding a task or perturbing the measured system. No
+// heap use: one static line buffer, tokenized in place.
+#ifndef SERIAL_CLI_ENABLED
+#define SERIAL_CLI_ENABLED DEBUG_SERIAL
+#endif
+#define CLI_LINE_MAX 96           // longest typed command line
+#define CLI_MAX_ARGS 4            // command name plus arguments
+
+// Bulk extraction over the USB bridge (system/BulkDump): the CLI's
+// `dump` command re-bauds the UART and streams a whole store as
+// CRC-framed chunks — seconds instead of the minutes the same data
+// takes through BLE notifications.
+#define BULK_DUMP_BAUD 921600     // default rate; CP2102-safe
+#define BULK_DUMP_CHUNK_BYTES 512 // payload per framed chunk
+
 #if DEBUG_SERIAL
-    #define DEBUG_PRINT(x) Serial.print(x)
-    #define DEBUG_PRINTLN(x) Serial.println(x)
-    #define DEBUG_PRINTF(x, ...) Serial.printf(x, __VA_ARGS__)
+    // Logging is the first thing shed under load; the dispatcher in
+    // main.cpp flips this flag when the command queue backs up.
+    extern volatile bool gShedLogging;
+    // Ring-buffer entry points, implemented in system/RingLogger.cpp.
+    void ringLog(const char* s);
+    void ringLog(const String& s);
+    void ringLogln(const char* s);
+    void ringLogln(const String& s);
+    void ringLogf(const char* fmt, ...)
+        __attribute__((format(printf, 1, 2)));
+    #define DEBUG_PRINT(x) do { if (!gShedLogging) ringLog(x); } while (0)
+    #define DEBUG_PRINTLN(x) do { if (!gShedLogging) ringLogln(x); } while (0)
+    #define DEBUG_PRINTF(x, ...) do { if (!gShedLogging) ringLogf(x, ##__VA_ARGS__); } while (0)
 #else
     #define DEBUG_PRINT(x)
     #define DEBUG_PRINTLN(x)
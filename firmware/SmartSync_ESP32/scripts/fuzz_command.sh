@@ -0,0 +1,47 @@
+#!/bin/sh
+# Builds and runs the RX command-parser fuzzer (test/fuzz) on the
+# host: clang + libFuzzer + ASan/UBSan against the exact parser the
+# firmware dispatches through. Run from firmware/SmartSync_ESP32.
+#
+#   scripts/fuzz_command.sh [libFuzzer args...]
+#
+# Without a libFuzzer-enabled clang, set FUZZ_CC=g++ to get the
+# standalone replayer (sanitizers only, no mutation) and feed it the
+# seed corpus or crash files.
+set -e
+
+FUZZ_CC="${FUZZ_CC:-clang++}"
+OUT=.pio/fuzz
+CORPUS="$OUT/corpus"
+ARDUINOJSON=.pio/libdeps/esp32dev/ArduinoJson/src
+
+mkdir -p "$CORPUS"
+
+# Seed corpus: one well-formed example per path, so coverage starts at
+# the interesting boundaries instead of random bytes. Octal escapes —
+# POSIX printf has no \xHH.
+printf '\305\001\200'                         > "$CORPUS/bin_set_fan"
+printf '\305\005\377\350\003'                 > "$CORPUS/bin_led_fade"
+printf '\305\013\001\200\100\001name'         > "$CORPUS/bin_define_scene"
+printf '\305\032\050\012'                     > "$CORPUS/bin_setpoint"
+printf '\305\004'                             > "$CORPUS/bin_get_status"
+printf '{"cmd":"SET_FAN","value":128}'        > "$CORPUS/json_set_fan"
+printf '{"cmd":"SET_LED_FADE","value":255,"duration":1000}' \
+                                              > "$CORPUS/json_led_fade"
+printf '{"value":1}'                          > "$CORPUS/json_no_cmd"
+
+COMMON="-std=gnu++11 -g -O1 -fsanitize=address,undefined \
+    -I test/native_stubs -I $ARDUINOJSON \
+    src/ble/CommandParser.cpp test/fuzz/fuzz_command.cpp"
+
+case "$FUZZ_CC" in
+clang*)
+    $FUZZ_CC $COMMON -fsanitize=fuzzer,address,undefined \
+        -o "$OUT/fuzz_command"
+    exec "$OUT/fuzz_command" "$CORPUS" "$@"
+    ;;
+*)
+    $FUZZ_CC $COMMON -DFUZZ_STANDALONE -o "$OUT/fuzz_command"
+    exec "$OUT/fuzz_command" "$CORPUS"/*
+    ;;
+esac
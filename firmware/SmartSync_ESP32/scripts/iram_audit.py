@@ -0,0 +1,63 @@
+# Post-build audit that ISR-reachable code landed in IRAM, wired in
+# via extra_scripts in platformio.ini. Code left in flash takes
+# multi-microsecond cache-miss stalls inside the interrupt, which is
+# fatal for echo-timing accuracy — and nothing at compile time catches
+# a dropped IRAM_ATTR. The build fails if any listed symbol resolves
+# into the flash text region; a symbol that does not appear at all was
+# inlined into its (audited) caller and is only noted.
+import subprocess
+
+Import("env")
+
+# Every function reachable from interrupt context. Keep in sync with
+# the IRAM_ATTR annotations in src/.
+ISR_SYMBOLS = (
+    "pirISR",
+    "onProximityEcho",
+    "UltrasonicSensor::echoISRThunk",
+    "UltrasonicSensor::handleEchoEdge",
+    "DHT22Sensor::edgeISRThunk",
+    "DHT22Sensor::handleFallingEdge",
+    "AlarmSystem::raiseFromISR",
+    "AlarmSystem::claimSlot",
+)
+
+IRAM_RANGES = (
+    (0x40080000, 0x400A0000),  # IRAM
+    (0x400C0000, 0x400C2000),  # RTC fast memory (also stall-free)
+)
+
+
+def _in_iram(addr):
+    return any(lo <= addr < hi for lo, hi in IRAM_RANGES)
+
+
+def audit(source, target, env):
+    nm = env.subst("$CC").replace("-gcc", "-nm")
+    out = subprocess.check_output(
+        [nm, "-C", target[0].get_abspath()]).decode("utf-8")
+
+    seen = set()
+    offenders = []
+    for line in out.splitlines():
+        parts = line.split(None, 2)
+        if len(parts) != 3 or parts[1].lower() != "t":
+            continue
+        addr = int(parts[0], 16)
+        for sym in ISR_SYMBOLS:
+            if sym in parts[2]:
+                seen.add(sym)
+                if not _in_iram(addr):
+                    offenders.append("%s @ 0x%08x" % (parts[2], addr))
+
+    for sym in ISR_SYMBOLS:
+        if sym not in seen:
+            print("IRAM audit: %s inlined (no standalone symbol)" % sym)
+    if offenders:
+        for entry in offenders:
+            print("IRAM audit: ISR code in FLASH: %s" % entry)
+        raise SystemExit("IRAM audit failed: ISR-path code left in flash")
+    print("IRAM audit: all ISR-path symbols in IRAM")
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", audit)
@@ -0,0 +1,57 @@
+# Post-build section size report, wired in via extra_scripts in
+# platformio.ini. Buckets the ELF sections into flash / IRAM / DRAM
+# and prints each total with its delta against the previous build of
+# the same environment (cached in the build dir), so a change that
+# bloats IRAM or DRAM shows up in the build log instead of at the
+# first failed link.
+import json
+import os
+import subprocess
+
+Import("env")
+
+BUCKETS = (
+    ("flash", ".flash."),
+    ("iram", ".iram0."),
+    ("dram", ".dram0."),
+)
+
+
+def _section_totals(elf_path):
+    out = subprocess.check_output(
+        [env.subst("$SIZETOOL"), "-A", elf_path]).decode("utf-8")
+    totals = {name: 0 for name, _ in BUCKETS}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) < 2 or not parts[0].startswith("."):
+            continue
+        try:
+            size = int(parts[1])
+        except ValueError:
+            continue
+        for name, prefix in BUCKETS:
+            if parts[0].startswith(prefix):
+                totals[name] += size
+                break
+    return totals
+
+
+def report(source, target, env):
+    totals = _section_totals(target[0].get_abspath())
+    cache = os.path.join(env.subst("$BUILD_DIR"), "size_report.json")
+    previous = {}
+    if os.path.isfile(cache):
+        with open(cache) as f:
+            previous = json.load(f)
+
+    print("Section sizes (%s):" % env.subst("$PIOENV"))
+    for name, _ in BUCKETS:
+        delta = totals[name] - previous.get(name, totals[name])
+        print("  %-5s %8d bytes  (%+d vs previous build)"
+              % (name, totals[name], delta))
+
+    with open(cache, "w") as f:
+        json.dump(totals, f)
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", report)
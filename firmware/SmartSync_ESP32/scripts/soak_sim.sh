@@ -0,0 +1,28 @@
+#!/bin/sh
+# Builds and runs the accelerated soak simulator (test/soak) on the
+# host: the portable control stack under the virtual clock, a month
+# of simulated operation in seconds. ASan/UBSan are always on — the
+# leak checker is the "no leak over 30 days" gate, the sanitizers the
+# overflow/overread one; the behavioral invariants live in
+# soak_sim.cpp. Run from firmware/SmartSync_ESP32.
+#
+#   scripts/soak_sim.sh [days]        (default 30, max 45)
+#
+# Set SOAK_CC to override the compiler (clang++ or g++ both work).
+set -e
+
+SOAK_CC="${SOAK_CC:-g++}"
+OUT=.pio/soak
+
+mkdir -p "$OUT"
+
+$SOAK_CC -std=gnu++11 -g -O1 -fsanitize=address,undefined \
+    -I test/native_stubs \
+    -DDEBUG_SERIAL=0 \
+    src/control/AutoModePolicy.cpp \
+    src/actuators/FanController.cpp \
+    src/sensors/OccupancyEstimator.cpp \
+    test/soak/soak_sim.cpp \
+    -o "$OUT/soak_sim"
+
+exec "$OUT/soak_sim" "$@"
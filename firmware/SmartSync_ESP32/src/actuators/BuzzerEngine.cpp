@@ -0,0 +1,140 @@
+#include "BuzzerEngine.h"
+
+// ============================================================================
+// MELODY TABLES
+// ============================================================================
+// Frequencies are equal-tempered pitches; durations chosen so the
+// longest note stays under the RMT item budget at BUZZER_RMT_CLK_DIV.
+static const BuzzerEngine::Note kChimeNotes[] = {
+    {1047, 120}, {1319, 120}, {1568, 180},          // C6 E6 G6
+};
+
+static const BuzzerEngine::Note kAlertNotes[] = {
+    {880, 150}, {0, 100}, {880, 150}, {0, 100}, {880, 150}, // A5 pips
+};
+
+static const BuzzerEngine::Note kEmergencyNotes[] = {
+    {1568, 250}, {1047, 250},                        // G6/C6 siren
+};
+
+struct MelodyDesc {
+    const BuzzerEngine::Note* notes;
+    uint8_t noteCount;
+    uint8_t priority; // higher interrupts lower
+    bool loop;        // replays until stop() or preemption
+};
+
+static const MelodyDesc kMelodies[] = {
+    { kChimeNotes, sizeof(kChimeNotes) / sizeof(kChimeNotes[0]), 0, false },
+    { kAlertNotes, sizeof(kAlertNotes) / sizeof(kAlertNotes[0]), 1, false },
+    { kEmergencyNotes,
+      sizeof(kEmergencyNotes) / sizeof(kEmergencyNotes[0]), 2, true },
+};
+
+// ============================================================================
+// ENGINE
+// ============================================================================
+BuzzerEngine::BuzzerEngine()
+    : timer(NULL),
+      playing(false),
+      activeMelody(0),
+      noteIndex(0) {
+}
+
+void BuzzerEngine::begin() {
+    // TX-only, no carrier: each RMT item is one full square-wave cycle
+    // (high half, low half) in 1 µs ticks at clk_div 80. Idle drives
+    // the pin low so the buzzer is silent between notes.
+    rmt_config_t config = {};
+    config.rmt_mode = RMT_MODE_TX;
+    config.channel = (rmt_channel_t)BUZZER_RMT_CHANNEL;
+    config.gpio_num = (gpio_num_t)BUZZER_PIN;
+    config.clk_div = BUZZER_RMT_CLK_DIV;
+    config.mem_block_num = 1;
+    config.tx_config.loop_en = false;
+    config.tx_config.carrier_en = false;
+    config.tx_config.idle_output_en = true;
+    config.tx_config.idle_level = RMT_IDLE_LEVEL_LOW;
+    rmt_config(&config);
+    rmt_driver_install((rmt_channel_t)BUZZER_RMT_CHANNEL, 0, 0);
+
+    esp_timer_create_args_t args = {};
+    args.callback = timerThunk;
+    args.arg = this;
+    args.name = "buzzer_note";
+    esp_timer_create(&args, &timer);
+
+    DEBUG_PRINTF("Buzzer engine on GPIO %d (RMT channel %d)\n",
+                 BUZZER_PIN, BUZZER_RMT_CHANNEL);
+}
+
+bool BuzzerEngine::play(Melody melody) {
+    if (playing &&
+        kMelodies[melody].priority < kMelodies[activeMelody].priority) {
+        return false; // the alarm outranks the chime, never the reverse
+    }
+
+    esp_timer_stop(timer);
+    rmt_tx_stop((rmt_channel_t)BUZZER_RMT_CHANNEL);
+
+    activeMelody = melody;
+    noteIndex = 0;
+    playing = true;
+    startNote();
+    return true;
+}
+
+void BuzzerEngine::stop() {
+    esp_timer_stop(timer);
+    rmt_tx_stop((rmt_channel_t)BUZZER_RMT_CHANNEL);
+    playing = false;
+}
+
+void BuzzerEngine::timerThunk(void* arg) {
+    static_cast<BuzzerEngine*>(arg)->advance();
+}
+
+// Compiles the current note into RMT symbols and hands the buffer to
+// the peripheral; the driver's interrupt refills the 64-item FIFO as
+// it drains, so the task is done the moment rmt_write_items returns.
+void BuzzerEngine::startNote() {
+    const MelodyDesc& desc = kMelodies[activeMelody];
+    const Note& note = desc.notes[noteIndex];
+
+    if (note.freqHz > 0) {
+        uint32_t halfUs = 500000UL / note.freqHz;
+        uint32_t cycles =
+            ((uint32_t)note.freqHz * note.durationMs) / 1000;
+        if (cycles > BUZZER_RMT_MAX_ITEMS) {
+            cycles = BUZZER_RMT_MAX_ITEMS; // budget caps the note length
+        }
+        for (uint32_t i = 0; i < cycles; i++) {
+            items[i].duration0 = halfUs;
+            items[i].level0 = 1;
+            items[i].duration1 = halfUs;
+            items[i].level1 = 0;
+        }
+        rmt_write_items((rmt_channel_t)BUZZER_RMT_CHANNEL,
+                        items, cycles, false);
+    }
+    // A rest writes nothing; idle_level holds the pin low.
+
+    // The one-shot covers the note plus a short articulation gap so
+    // repeated notes at the same pitch stay distinct.
+    esp_timer_start_once(timer,
+                         (uint64_t)(note.durationMs + BUZZER_NOTE_GAP_MS) * 1000);
+}
+
+void BuzzerEngine::advance() {
+    const MelodyDesc& desc = kMelodies[activeMelody];
+
+    noteIndex++;
+    if (noteIndex >= desc.noteCount) {
+        if (!desc.loop) {
+            playing = false;
+            return;
+        }
+        noteIndex = 0; // emergency keeps sounding until stop()
+    }
+    startNote();
+}
@@ -0,0 +1,59 @@
+#ifndef BUZZER_ENGINE_H
+#define BUZZER_ENGINE_H
+
+#include <Arduino.h>
+#include <driver/rmt.h>
+#include "../../include/config.h"
+
+// Buzzer melody engine on the RMT peripheral. Each note is compiled
+// into a buffer of RMT symbols (one symbol per square-wave cycle) that
+// the peripheral clocks out on its own; an esp_timer one-shot advances
+// to the next note, same idiom as LedPatternEngine. No delay() between
+// notes, so a multi-second alert melody costs zero task time — exactly
+// when the tasks are busiest.
+//
+// Melodies carry a priority: a play() at equal or higher priority
+// preempts whatever is sounding (emergency interrupts chime), a lower
+// one is dropped. Emergency loops until stopped or preempted.
+class BuzzerEngine {
+public:
+    enum Melody : uint8_t {
+        MELODY_CHIME,     // short ascending triad (boot, connect)
+        MELODY_ALERT,     // three pips (attention, non-urgent)
+        MELODY_EMERGENCY, // two-tone siren, loops until stop()
+    };
+
+    struct Note {
+        uint16_t freqHz;     // 0 = rest
+        uint16_t durationMs;
+    };
+
+    BuzzerEngine();
+
+    void begin();
+
+    // Starts a melody. Returns false (and leaves the current melody
+    // playing) when something higher-priority is already sounding.
+    bool play(Melody melody);
+
+    void stop();
+
+    bool busy() const { return playing; }
+
+private:
+    static void timerThunk(void* arg);
+    void startNote();
+    void advance();
+
+    esp_timer_handle_t timer;
+
+    volatile bool playing;
+    volatile uint8_t activeMelody;
+    volatile uint8_t noteIndex;
+
+    // One note's waveform; the RMT driver streams from this buffer, so
+    // it must stay valid for the whole note.
+    rmt_item32_t items[BUZZER_RMT_MAX_ITEMS];
+};
+
+#endif // BUZZER_ENGINE_H
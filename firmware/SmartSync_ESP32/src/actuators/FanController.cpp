@@ -0,0 +1,91 @@
+#include "FanController.h"
+
+// Gains in Q8.8, converted from the float constants at compile time.
+static const int32_t KP_Q8 = (int32_t)(FAN_PID_KP * 256.0f);
+static const int32_t KI_Q8 = (int32_t)(FAN_PID_KI * 256.0f);
+static const int32_t KD_Q8 = (int32_t)(FAN_PID_KD * 256.0f);
+
+FanController::FanController()
+    : setpointCenti((int32_t)(FAN_PID_SETPOINT_C * 100.0f)),
+      integralCentiSec(0),
+      prevErrorCenti(0),
+      prevMs(0),
+      havePrev(false),
+      lastDuty(0) {
+}
+
+void FanController::setSetpoint(float tempC) {
+    setSetpointCenti((int32_t)(tempC * 100.0f));
+}
+
+void FanController::setSetpointCenti(int32_t centi) {
+    setpointCenti = (centi != 0)
+        ? centi
+        : (int32_t)(FAN_PID_SETPOINT_C * 100.0f);
+    reset(); // old integrator history belongs to the old target
+}
+
+void FanController::reset() {
+    integralCentiSec = 0;
+    havePrev = false;
+}
+
+bool FanController::update(float tempC, uint32_t nowMs, uint8_t* dutyOut) {
+    // Positive error = room above setpoint = fan harder.
+    int32_t errorCenti = (int32_t)(tempC * 100.0f) - setpointCenti;
+
+    if (!havePrev) {
+        prevErrorCenti = errorCenti;
+        prevMs = nowMs;
+        havePrev = true;
+    }
+    uint32_t dtMs = nowMs - prevMs;
+    if (dtMs == 0) {
+        dtMs = 1;
+    }
+
+    // P and D terms. Gains are duty counts per °C (per °C/s for Kd);
+    // the /100 brings centi-degrees back to degrees, the >>8 drops
+    // the Q8.8 gain scale.
+    int64_t p = (int64_t)KP_Q8 * errorCenti;
+    int64_t d = ((int64_t)KD_Q8 * (errorCenti - prevErrorCenti) * 1000) /
+                (int32_t)dtMs;
+    int64_t i = (int64_t)KI_Q8 * integralCentiSec;
+
+    int32_t out = (int32_t)((p + i + d) / (256 * 100));
+
+    // Anti-windup by conditional integration: only accumulate while
+    // the output isn't pinned at the rail the error is pushing toward.
+    bool railHigh = out >= 255 && errorCenti > 0;
+    bool railLow = out <= 0 && errorCenti < 0;
+    if (!railHigh && !railLow) {
+        integralCentiSec += (errorCenti * (int32_t)dtMs) / 1000;
+        // Secondary clamp so a long excursion can't bank an absurd
+        // correction: the I term alone stays within the duty range.
+        int32_t iMax = KI_Q8 > 0 ? (255 * 256 * 100) / KI_Q8 : 0;
+        if (integralCentiSec > iMax) integralCentiSec = iMax;
+        if (integralCentiSec < 0) integralCentiSec = 0;
+    }
+
+    prevErrorCenti = errorCenti;
+    prevMs = nowMs;
+
+    if (out < 0) out = 0;
+    if (out > 255) out = 255;
+    uint8_t duty = (uint8_t)out;
+
+    // Deadband: ignore changes smaller than anyone can hear, unless
+    // they land on a rail (full stop / full speed should be exact).
+    int16_t delta = (int16_t)duty - (int16_t)lastDuty;
+    if (delta < 0) delta = -delta;
+    if (delta < FAN_PID_DEADBAND && duty != 0 && duty != 255) {
+        return false;
+    }
+    if (duty == lastDuty) {
+        return false;
+    }
+
+    lastDuty = duty;
+    *dutyOut = duty;
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef FAN_CONTROLLER_H
+#define FAN_CONTROLLER_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Closed-loop fan speed from a fixed-point PID on temperature,
+// replacing the bang-bang threshold ladder. The ladder's hard tier
+// edges caused audible speed hunting around each threshold — and
+// every hunt cycle was a PWM jump, an NVS write and a BLE delta.
+//
+// Arithmetic is integer only: the error lives in centi-degrees, the
+// gains in Q8.8, so an update is a handful of multiplies with no
+// float in the loop. Anti-windup is conditional integration (the
+// integrator freezes while the output is pinned at a rail), and a
+// minimum-change deadband swallows duty jitter smaller than anyone
+// can hear.
+
+class FanController {
+public:
+    FanController();
+
+    // Target temperature; error above it spins the fan up. The centi
+    // variant takes the settings-blob fixed-point value directly, no
+    // float on the path; 0 restores the compile-time default.
+    void setSetpoint(float tempC);
+    void setSetpointCenti(int32_t centi);
+
+    // One PID step at the sensor cadence. Returns true when the duty
+    // moved by at least the deadband (or hit a rail), with the new
+    // value in *dutyOut; false means hold the current speed.
+    bool update(float tempC, uint32_t nowMs, uint8_t* dutyOut);
+
+    uint8_t duty() const { return lastDuty; }
+
+    // Drops integrator and history (mode changes, occupancy gating).
+    void reset();
+
+private:
+    int32_t setpointCenti;
+
+    int32_t integralCentiSec; // accumulated error, centi-°C · s
+    int32_t prevErrorCenti;
+    uint32_t prevMs;
+    bool havePrev;
+
+    uint8_t lastDuty;
+};
+
+#endif // FAN_CONTROLLER_H
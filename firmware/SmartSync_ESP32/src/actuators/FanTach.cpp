@@ -0,0 +1,59 @@
+#include "FanTach.h"
+#include <driver/pcnt.h>
+
+FanTach::FanTach()
+    : lastSampleUs(0) {
+}
+
+void FanTach::begin() {
+    // Count rising edges only; the control input is unused. The high
+    // limit just keeps the 16-bit counter from wrapping silently —
+    // at 2 pulses/rev even a 10000 RPM fan stays well under it
+    // between 10 s sensor cycles.
+    pcnt_config_t config = {};
+    config.pulse_gpio_num = FAN_TACH_PIN;
+    config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+    config.channel = PCNT_CHANNEL_0;
+    config.unit = (pcnt_unit_t)FAN_TACH_PCNT_UNIT;
+    config.pos_mode = PCNT_COUNT_INC;
+    config.neg_mode = PCNT_COUNT_DIS;
+    config.lctrl_mode = PCNT_MODE_KEEP;
+    config.hctrl_mode = PCNT_MODE_KEEP;
+    config.counter_h_lim = 32767;
+    config.counter_l_lim = 0;
+    pcnt_unit_config(&config);
+
+    // Hardware glitch filter: pulses shorter than this many APB clock
+    // cycles (12.5 ns each) are ignored, so PWM coupling onto the
+    // open-collector tach line doesn't count as rotation.
+    pcnt_set_filter_value((pcnt_unit_t)FAN_TACH_PCNT_UNIT,
+                          FAN_TACH_FILTER_APB_TICKS);
+    pcnt_filter_enable((pcnt_unit_t)FAN_TACH_PCNT_UNIT);
+
+    pcnt_counter_pause((pcnt_unit_t)FAN_TACH_PCNT_UNIT);
+    pcnt_counter_clear((pcnt_unit_t)FAN_TACH_PCNT_UNIT);
+    pcnt_counter_resume((pcnt_unit_t)FAN_TACH_PCNT_UNIT);
+
+    lastSampleUs = esp_timer_get_time();
+    DEBUG_PRINTF("Fan tach on GPIO %d (PCNT unit %d)\n",
+                 FAN_TACH_PIN, FAN_TACH_PCNT_UNIT);
+}
+
+uint16_t FanTach::sampleRpm() {
+    int16_t pulses = 0;
+    pcnt_get_counter_value((pcnt_unit_t)FAN_TACH_PCNT_UNIT, &pulses);
+    pcnt_counter_clear((pcnt_unit_t)FAN_TACH_PCNT_UNIT);
+
+    int64_t nowUs = esp_timer_get_time();
+    int64_t dtUs = nowUs - lastSampleUs;
+    lastSampleUs = nowUs;
+
+    if (dtUs <= 0 || pulses <= 0) {
+        return 0;
+    }
+
+    // pulses / PULSES_PER_REV revolutions over dtUs microseconds.
+    uint64_t rpm = ((uint64_t)pulses * 60000000ULL) /
+                   ((uint64_t)dtUs * FAN_TACH_PULSES_PER_REV);
+    return (rpm > 65535) ? 65535 : (uint16_t)rpm;
+}
@@ -0,0 +1,29 @@
+#ifndef FAN_TACH_H
+#define FAN_TACH_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Fan tachometer on the PCNT pulse-counter peripheral. The counter
+// accumulates tach edges entirely in hardware between calls, so the
+// measurement costs one register read and clear per sensor cycle —
+// no interrupts, no polling, zero CPU while the fan spins.
+//
+// Without it a stalled fan is invisible: the PWM duty says "spinning"
+// while the room overheats. The RPM feeds the sensor frame and the
+// stall detector in main.cpp.
+class FanTach {
+public:
+    FanTach();
+
+    void begin();
+
+    // RPM averaged since the previous call. The first call after
+    // begin() returns 0 (no baseline interval yet).
+    uint16_t sampleRpm();
+
+private:
+    int64_t lastSampleUs;
+};
+
+#endif // FAN_TACH_H
@@ -0,0 +1,88 @@
+#include "LedPatternEngine.h"
+
+// Alternating on/off phase durations per pattern, even indexes = LED on.
+static const LedPatternEngine::Pattern FIRST_TIMED_PATTERN = LedPatternEngine::BLINK;
+
+struct PatternPhases {
+    uint16_t phaseMs[4];
+    uint8_t phaseCount;
+};
+
+static const PatternPhases PATTERN_TABLE[] = {
+    { {100, 100, 0, 0}, 2 },       // BLINK
+    { {500, 500, 0, 0}, 2 },       // PULSE
+    { {80, 120, 80, 720}, 4 },     // HEARTBEAT
+};
+
+LedPatternEngine::LedPatternEngine(uint8_t pin)
+    : pin(pin),
+      timer(NULL),
+      activePattern(OFF),
+      phaseIndex(0),
+      repeatsLeft(0),
+      continuous(false) {
+}
+
+void LedPatternEngine::begin() {
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+
+    esp_timer_create_args_t args = {};
+    args.callback = timerThunk;
+    args.arg = this;
+    args.name = "led_pattern";
+    esp_timer_create(&args, &timer);
+}
+
+void LedPatternEngine::play(Pattern pattern, uint8_t repeats) {
+    esp_timer_stop(timer);
+
+    activePattern = pattern;
+    phaseIndex = 0;
+    repeatsLeft = repeats;
+    continuous = (repeats == 0);
+
+    if (pattern == OFF) {
+        digitalWrite(pin, LOW);
+        return;
+    }
+    if (pattern == SOLID) {
+        digitalWrite(pin, HIGH);
+        return;
+    }
+
+    // Timed pattern: enter the first phase now.
+    const PatternPhases& phases = PATTERN_TABLE[pattern - FIRST_TIMED_PATTERN];
+    digitalWrite(pin, HIGH);
+    scheduleNext(phases.phaseMs[0]);
+}
+
+void LedPatternEngine::timerThunk(void* arg) {
+    static_cast<LedPatternEngine*>(arg)->step();
+}
+
+void LedPatternEngine::step() {
+    if (activePattern == OFF || activePattern == SOLID) {
+        return;
+    }
+
+    const PatternPhases& phases = PATTERN_TABLE[activePattern - FIRST_TIMED_PATTERN];
+
+    phaseIndex++;
+    if (phaseIndex >= phases.phaseCount) {
+        // One full cycle done.
+        if (!continuous && --repeatsLeft == 0) {
+            activePattern = OFF;
+            digitalWrite(pin, LOW);
+            return;
+        }
+        phaseIndex = 0;
+    }
+
+    digitalWrite(pin, (phaseIndex % 2 == 0) ? HIGH : LOW);
+    scheduleNext(phases.phaseMs[phaseIndex]);
+}
+
+void LedPatternEngine::scheduleNext(uint32_t delayMs) {
+    esp_timer_start_once(timer, (uint64_t)delayMs * 1000);
+}
@@ -0,0 +1,48 @@
+#ifndef LED_PATTERN_ENGINE_H
+#define LED_PATTERN_ENGINE_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Small status-LED pattern engine driven by esp_timer one-shots. Each
+// pattern is a descriptor of on/off phases that the timer callback steps
+// through, so callers request a pattern and return immediately — no
+// delay() on any task.
+class LedPatternEngine {
+public:
+    enum Pattern : uint8_t {
+        OFF,        // LED held low
+        SOLID,      // LED held high
+        BLINK,      // single 100 ms flash per repeat
+        PULSE,      // slow 500 ms on / 500 ms off
+        HEARTBEAT,  // double flash then a long gap
+    };
+
+    explicit LedPatternEngine(uint8_t pin);
+
+    void begin();
+
+    // Starts a pattern, replacing whatever is playing. repeats == 0
+    // plays until the next play() call.
+    void play(Pattern pattern, uint8_t repeats = 0);
+
+private:
+    struct PhaseTable {
+        uint16_t phaseMs[4]; // alternating on/off durations, 0-terminated
+        uint8_t phaseCount;
+    };
+
+    static void timerThunk(void* arg);
+    void step();
+    void scheduleNext(uint32_t delayMs);
+
+    uint8_t pin;
+    esp_timer_handle_t timer;
+
+    volatile Pattern activePattern;
+    volatile uint8_t phaseIndex;
+    volatile uint8_t repeatsLeft;
+    volatile bool continuous;
+};
+
+#endif // LED_PATTERN_ENGINE_H
@@ -1,16 +1,76 @@
 #include "BLEService.h"
-#include <ArduinoJson.h>
+#include <esp32/rom/crc.h>
+#include <esp_timer.h>
+#include <os/os_mbuf.h>
+#include "SensorFrame.h"
+#include "ChunkFramer.h"
+#include "HistoryEncoder.h"
+#include "JsonNumber.h"
+#include "HistoryFilter.h"
+#include "LttbSampler.h"
+#include "../actuators/LedPatternEngine.h"
+#include "../ml/ModelUpdater.h"
+#include "../system/FirmwareUpdater.h"
+#include "../system/SettingsStore.h"
+#include "../system/SelfTest.h"
+#include "../system/WellnessSummary.h"
+#include "../system/RtcState.h"
+#include "../system/PowerGovernor.h"
+#include "../system/OtaPacer.h"
+#include "../storage/CaptureStore.h"
+#include "../storage/CoreDumpStore.h"
+#include "../storage/HistoryLog.h"
+#include "../storage/RollupStore.h"
+#include "../network/EspNowMesh.h"
+#include "../system/Profiler.h"
+#include "../system/TaskStats.h"
+#include "../system/FlashOpStats.h"
+#include "../system/CmdLatency.h"
+#include "../system/TestRig.h"
+#include "../system/EventTrace.h"
+
+// The NimBLE host is sized by the [nimble] build flags in
+// platformio.ini; a libdeps build that missed them silently reverts to
+// the library defaults, and the default connection cap (3) is below
+// ours — catch that at compile time, not at the fourth client.
+#if CONFIG_BT_NIMBLE_MAX_CONNECTIONS < BLE_MAX_CLIENTS
+#error "CONFIG_BT_NIMBLE_MAX_CONNECTIONS below BLE_MAX_CLIENTS - stale NimBLE build flags?"
+#endif
 
 // Server callbacks
 class ServerCallbacks : public NimBLEServerCallbacks {
-    void onConnect(NimBLEServer* pServer) {
-        DEBUG_PRINTLN("Client connected");
+private:
+    BLEServiceManager* manager;
+
+public:
+    ServerCallbacks(BLEServiceManager* mgr) : manager(mgr) {}
+
+    void onConnect(NimBLEServer* pServer, ble_gap_conn_desc* desc) {
+        DEBUG_PRINTF("Client connected (handle %d)\n", desc->conn_handle);
+
+        // Request LE Data Length Extension so the negotiated MTU fits
+        // in single link-layer packets (251 octets / 2120 us).
+        ble_gap_set_data_len(desc->conn_handle, 251, 2120);
+
+        manager->handleConnect(desc->conn_handle);
+        manager->rememberPeer(desc->peer_id_addr);
+
+        // Keep accepting connections up to the client limit.
+        if (pServer->getConnectedCount() < BLE_MAX_CLIENTS) {
+            pServer->startAdvertising();
+        }
     }
-    
-    void onDisconnect(NimBLEServer* pServer) {
-        DEBUG_PRINTLN("Client disconnected");
-        // Start advertising again
-        pServer->startAdvertising();
+
+    void onMTUChange(uint16_t mtu, ble_gap_conn_desc* desc) {
+        DEBUG_PRINTF("MTU negotiated: %d (handle %d)\n", mtu, desc->conn_handle);
+        manager->handleMtuChange(desc->conn_handle, mtu);
+    }
+
+    void onDisconnect(NimBLEServer* pServer, ble_gap_conn_desc* desc) {
+        DEBUG_PRINTF("Client disconnected (handle %d)\n", desc->conn_handle);
+        manager->handleDisconnect(desc->conn_handle);
+        // Directed burst at the last bonded peer first, then generic.
+        manager->startReconnectAdvertising();
     }
 };
 
@@ -22,23 +82,243 @@ private:
 public:
     CharacteristicCallbacks(BLEServiceManager* mgr) : manager(mgr) {}
     
-    void onWrite(NimBLECharacteristic* pCharacteristic) {
-        std::string value = pCharacteristic->getValue();
-        if (value.length() > 0) {
-            String command = String(value.c_str());
-            DEBUG_PRINT("Received command: ");
-            DEBUG_PRINTLN(command);
-            manager->handleCommand(command);
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 ble_gap_conn_desc* desc) {
+        NimBLEAttValue value = pCharacteristic->getValue();
+        if (value.length() == 0) {
+            return;
+        }
+
+        const uint8_t* data = value.data();
+
+        if (data[0] == CMD_MAGIC) {
+            // Hot path: parse in place, no copies, no heap. The
+            // connection handle keys the session-auth state.
+            manager->handleBinaryCommand(data, value.length(),
+                                         desc->conn_handle);
+            return;
         }
+
+        // Legacy JSON path for old app versions.
+        DEBUG_PRINTF("Received command: %.*s\n", (int)value.length(),
+                     (const char*)data);
+        manager->handleCommand((const char*)data, value.length());
+    }
+};
+
+// OTA characteristic callbacks: raw firmware chunks, no CMD framing.
+// The write lands in the NimBLE host task; the flash program runs
+// here while the controller keeps ACKing link-layer traffic, so with
+// write-without-response the radio stays busy behind the write.
+class OtaCharacteristicCallbacks : public NimBLECharacteristicCallbacks {
+private:
+    BLEServiceManager* manager;
+
+public:
+    OtaCharacteristicCallbacks(BLEServiceManager* mgr) : manager(mgr) {}
+
+    void onWrite(NimBLECharacteristic* pCharacteristic,
+                 ble_gap_conn_desc* desc) {
+        NimBLEAttValue value = pCharacteristic->getValue();
+        manager->handleOtaChunk(value.data(), value.length());
+    }
+};
+
+// Settings characteristic callbacks: serializes the settings blob
+// just in time, so the read always reflects the current values. The
+// copy is made (and the PIN scrubbed) before setValue hands bytes to
+// the stack; NimBLE's long-read procedure covers clients whose MTU is
+// below the blob size.
+class SettingsCharacteristicCallbacks : public NimBLECharacteristicCallbacks {
+private:
+    BLEServiceManager* manager;
+
+public:
+    SettingsCharacteristicCallbacks(BLEServiceManager* mgr) : manager(mgr) {}
+
+    void onRead(NimBLECharacteristic* pCharacteristic,
+                ble_gap_conn_desc* desc) {
+        manager->fillSettingsCharacteristic(pCharacteristic);
+    }
+};
+
+// Alert characteristic callbacks: indications are link-layer
+// acknowledged, and the stack reports each outcome through onStatus —
+// that confirmation (or its absence) drives the redelivery engine.
+class AlertCharacteristicCallbacks : public NimBLECharacteristicCallbacks {
+private:
+    BLEServiceManager* manager;
+
+public:
+    AlertCharacteristicCallbacks(BLEServiceManager* mgr) : manager(mgr) {}
+
+    void onSubscribe(NimBLECharacteristic* pCharacteristic,
+                     ble_gap_conn_desc* desc, uint16_t subValue) {
+        manager->handleAlertSubscription(desc->conn_handle,
+                                         (subValue & 0x0002) != 0);
+    }
+
+    void onStatus(NimBLECharacteristic* pCharacteristic, Status status,
+                  int code) {
+        manager->handleAlertIndicationStatus(status ==
+                                             Status::SUCCESS_INDICATE);
+    }
+};
+
+// TX characteristic callbacks: tracks which connections actually
+// subscribed to notifications.
+class TxCharacteristicCallbacks : public NimBLECharacteristicCallbacks {
+private:
+    BLEServiceManager* manager;
+
+public:
+    TxCharacteristicCallbacks(BLEServiceManager* mgr) : manager(mgr) {}
+
+    void onSubscribe(NimBLECharacteristic* pCharacteristic,
+                     ble_gap_conn_desc* desc, uint16_t subValue) {
+        manager->handleSubscription(desc->conn_handle, (subValue & 0x0001) != 0);
     }
 };
 
-BLEServiceManager::BLEServiceManager() 
-    : deviceConnected(false), 
-      oldDeviceConnected(false),
+// ============================================================================
+// STATIC SERVICE TABLE
+// ============================================================================
+// The UUID strings in config.h are parsed at compile time into the
+// little-endian ble_uuid128_t the host stack wants, so begin() hands
+// NimBLE finished binary UUIDs instead of parsing text at boot. The
+// helpers are single return expressions to stay valid C++11 constexpr.
+static constexpr uint8_t uuidNibble(char c) {
+    return (c >= '0' && c <= '9') ? (uint8_t)(c - '0')
+         : (c >= 'a' && c <= 'f') ? (uint8_t)(c - 'a' + 10)
+         : (c >= 'A' && c <= 'F') ? (uint8_t)(c - 'A' + 10)
+         : 0;
+}
+
+static constexpr uint8_t uuidByte(const char* s, unsigned at) {
+    return (uint8_t)((uuidNibble(s[at]) << 4) | uuidNibble(s[at + 1]));
+}
+
+// Text layout is 8-4-4-4-12 with hyphens at 8/13/18/23; value[] runs
+// least-significant byte first per the NimBLE convention.
+static constexpr ble_uuid128_t uuid128(const char* s) {
+    return ble_uuid128_t{
+        { BLE_UUID_TYPE_128 },
+        { uuidByte(s, 34), uuidByte(s, 32), uuidByte(s, 30), uuidByte(s, 28),
+          uuidByte(s, 26), uuidByte(s, 24), uuidByte(s, 21), uuidByte(s, 19),
+          uuidByte(s, 16), uuidByte(s, 14), uuidByte(s, 11), uuidByte(s, 9),
+          uuidByte(s, 6),  uuidByte(s, 4),  uuidByte(s, 2),  uuidByte(s, 0) } };
+}
+
+static constexpr ble_uuid128_t SERVICE_UUID128 = uuid128(BLE_SERVICE_UUID);
+static constexpr ble_uuid128_t TX_UUID128 = uuid128(BLE_CHARACTERISTIC_UUID_TX);
+static constexpr ble_uuid128_t RX_UUID128 = uuid128(BLE_CHARACTERISTIC_UUID_RX);
+static constexpr ble_uuid128_t OTA_UUID128 =
+    uuid128(BLE_CHARACTERISTIC_UUID_OTA);
+static constexpr ble_uuid128_t SETTINGS_UUID128 =
+    uuid128(BLE_CHARACTERISTIC_UUID_SETTINGS);
+static constexpr ble_uuid128_t ALERT_UUID128 =
+    uuid128(BLE_CHARACTERISTIC_UUID_ALERT);
+
+const BLEServiceManager::CharacteristicDef
+BLEServiceManager::CHARACTERISTIC_TABLE[5] = {
+    { &TX_UUID128, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY,
+      &BLEServiceManager::pTxCharacteristic },
+    { &RX_UUID128, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR,
+      &BLEServiceManager::pRxCharacteristic },
+    { &OTA_UUID128, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR,
+      &BLEServiceManager::pOtaCharacteristic },
+    { &SETTINGS_UUID128, NIMBLE_PROPERTY::READ,
+      &BLEServiceManager::pSettingsCharacteristic },
+    { &ALERT_UUID128, NIMBLE_PROPERTY::INDICATE,
+      &BLEServiceManager::pAlertCharacteristic },
+};
+
+BLEServiceManager::BLEServiceManager()
+    : pAdvertising(nullptr),
+      advSequence(0),
+      deviceConnected(false),
+      jsonCompatMode(BLE_JSON_COMPAT_DEFAULT),
+      haveBondedPeer(false),
+      haveLastSent(false),
+      framesSinceKeyframe(0),
+      statusSnapshotLen(0),
+      statusSnapshotDirty(false),
+      stateStore(nullptr),
+      settingsSource(nullptr),
+      catchupHead(0),
+      catchupCount(0),
+      catchupLastRecordMs(0),
+      catchupLock(portMUX_INITIALIZER_UNLOCKED),
+      catchupSyncRunning(false),
+      catchupConnHandle(0xFFFF),
+      alertPendingCount(0),
+      alertLock(portMUX_INITIALIZER_UNLOCKED),
+      alertIndicationsOn(false),
+      alertInFlight(false),
+      alertInFlightIdx(0),
+      alertInFlightSinceMs(0),
+      jsonCacheBodyLen(0),
+      jsonCacheValid(false),
+      negotiatedCaps(PROTO_CAPS_SUPPORTED),
+      devicePin(0),
+      authDeviceId(0),
+      haveStretchedKey(false),
+      cmdConnHandle(0xFFFF),
+      notifyTaskHandle(NULL),
+      pendingLock(portMUX_INITIALIZER_UNLOCKED),
+      pendingTier{},
+      pendingTierValid{},
+      notifyStats{0, 0, 0, 0, 0},
+      tierStats{},
+      statusLed(nullptr),
       fanSpeedCallback(nullptr),
       ledBrightnessCallback(nullptr),
-      autoModeCallback(nullptr) {
+      ledFadeCallback(nullptr),
+      autoModeCallback(nullptr),
+      setpointCallback(nullptr),
+      sceneApplyCallback(nullptr),
+      sceneDefineCallback(nullptr),
+      benchRunning(false),
+      benchSeconds(BLE_BENCH_DEFAULT_SECONDS),
+      soakSampleCallback(nullptr),
+      historyLog(nullptr),
+      historySyncRunning(false),
+      historyFromSeq(0),
+      rollupStore(nullptr),
+      rollupSyncRunning(false),
+      rollupFromSeq(0),
+      rollupKind(0),
+      meshRelay(nullptr),
+      peerPushIdx(0),
+      chartSyncRunning(false),
+      chartFromMs(0),
+      chartToMs(0),
+      chartPoints(0),
+      chartField(0),
+      flashHealthCallback(nullptr),
+      modelUpdater(nullptr),
+      modelCommittedCallback(nullptr),
+      captureStore(nullptr),
+      captureSyncRunning(false),
+      coreDumpStore(nullptr),
+      coreDumpSyncRunning(false),
+      coreDumpEraseAfter(false),
+      traceSyncRunning(false),
+      latencyCallback(nullptr),
+      heapStatsCallback(nullptr),
+      bootStatsCallback(nullptr),
+      connProfile(CONN_PROFILE_INTERACTIVE),
+      connProfilePinned(false),
+      lastCommandMs(0),
+      advCadence(ADV_CADENCE_FAST),
+      advFastSinceMs(0),
+      disconnectCount(0),
+      lastDisconnectReason(0),
+      lastDisconnectMs(0),
+      cmdArrivalUs(0),
+      cmdOpcode(0),
+      firmwareUpdater(nullptr) {
+    memset(&statusFrame, 0, sizeof(statusFrame));
 }
 
 BLEServiceManager::~BLEServiceManager() {
@@ -53,143 +333,3337 @@ bool BLEServiceManager::begin() {
     // Initialize NimBLE
     NimBLEDevice::init(BLE_DEVICE_NAME);
     NimBLEDevice::setPower(ESP_PWR_LVL_P9); // Maximum power
-    
+    NimBLEDevice::setMTU(BLE_PREFERRED_MTU);
+
+    // Pool audit: the compile-time sizing against the mbuf pool the
+    // host actually built. msys blocks are the currency every notify
+    // and ACL fragment spends; if the free count here is below the
+    // configured count, something claimed buffers before we ever
+    // advertised.
+    DEBUG_PRINTF("NimBLE: %u conns, preferred MTU %u, msys %d blocks "
+                 "(%d free), host stack %u\n",
+                 CONFIG_BT_NIMBLE_MAX_CONNECTIONS,
+                 CONFIG_BT_NIMBLE_ATT_PREFERRED_MTU,
+                 os_msys_count(), os_msys_num_free(),
+                 CONFIG_BT_NIMBLE_HOST_TASK_STACK_SIZE);
+
+    // Bond without MITM so reconnects skip pairing entirely; keys
+    // persist in NVS via the NimBLE store.
+    NimBLEDevice::setSecurityAuth(true /*bond*/, false /*mitm*/, true /*sc*/);
+
+    // Last bonded peer, remembered across reboots so the first
+    // advertising burst after power-up can already be directed.
+    blePrefs.begin(PREF_NAMESPACE, false);
+    if (blePrefs.getBytes(PREF_LAST_PEER, &lastPeerAddr,
+                          sizeof(lastPeerAddr)) == sizeof(lastPeerAddr)) {
+        haveBondedPeer = true;
+    }
+
+    // Callback sinks live for the whole uptime; static instances keep
+    // service setup off the heap entirely.
+    static ServerCallbacks serverCallbacks(this);
+    static TxCharacteristicCallbacks txCallbacks(this);
+    static CharacteristicCallbacks rxCallbacks(this);
+    static OtaCharacteristicCallbacks otaCallbacks(this);
+    static SettingsCharacteristicCallbacks settingsCallbacks(this);
+    static AlertCharacteristicCallbacks alertCallbacks(this);
+
     // Create BLE Server
     pServer = NimBLEDevice::createServer();
-    pServer->setCallbacks(new ServerCallbacks());
-    
-    // Create BLE Service
-    pService = pServer->createService(BLE_SERVICE_UUID);
-    
-    // Create TX Characteristic (Server → Client notifications)
-    pTxCharacteristic = pService->createCharacteristic(
-        BLE_CHARACTERISTIC_UUID_TX,
-        NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY
-    );
-    
-    // Create RX Characteristic (Client → Server writes)
-    pRxCharacteristic = pService->createCharacteristic(
-        BLE_CHARACTERISTIC_UUID_RX,
-        NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR
-    );
-    pRxCharacteristic->setCallbacks(new CharacteristicCallbacks(this));
-    
+    pServer->setCallbacks(&serverCallbacks);
+
+    // Service and characteristics come from the compile-time table;
+    // the UUIDs are already in binary form.
+    pService = pServer->createService(NimBLEUUID(&SERVICE_UUID128));
+    for (const CharacteristicDef& def : CHARACTERISTIC_TABLE) {
+        this->*def.slot =
+            pService->createCharacteristic(NimBLEUUID(def.uuid),
+                                           def.properties);
+    }
+    pTxCharacteristic->setCallbacks(&txCallbacks);
+    pRxCharacteristic->setCallbacks(&rxCallbacks);
+    pOtaCharacteristic->setCallbacks(&otaCallbacks);
+    pSettingsCharacteristic->setCallbacks(&settingsCallbacks);
+    pAlertCharacteristic->setCallbacks(&alertCallbacks);
+
     // Start the service
     pService->start();
-    
+
     // Start advertising
-    NimBLEAdvertising* pAdvertising = NimBLEDevice::getAdvertising();
-    pAdvertising->addServiceUUID(BLE_SERVICE_UUID);
+    pAdvertising = NimBLEDevice::getAdvertising();
+    pAdvertising->addServiceUUID(NimBLEUUID(&SERVICE_UUID128));
     pAdvertising->setScanResponse(true);
-    pAdvertising->setMinPreferred(0x06);
-    pAdvertising->setMaxPreferred(0x12);
+    // Advertised preferred-parameter hint only; the phone is free to
+    // ignore it. The authoritative interval comes from the connection
+    // profiles (applyConnProfile), requested explicitly per link.
+    pAdvertising->setMinPreferred(BLE_CONN_INTERACTIVE_ITVL_MIN);
+    pAdvertising->setMaxPreferred(BLE_CONN_INTERACTIVE_ITVL_MAX);
+    // Boot is a likely-connect moment: start on the fast cadence and
+    // let the quiet window decay it to the slow beacon.
+    applyAdvCadence(ADV_CADENCE_FAST);
     NimBLEDevice::startAdvertising();
-    
+
+    // Host-level GAP listener for what the server callbacks don't
+    // surface — today that's the disconnect reason code.
+    static ble_gap_event_listener gapListener;
+    ble_gap_event_listener_register(&gapListener, gapEventThunk, this);
+
+    // Drain task for the notification send queue.
+    xTaskCreatePinnedToCore(
+        notifyTaskThunk, "ble_notify", BLE_NOTIFY_TASK_STACK, this,
+        BLE_TASK_PRIORITY, &notifyTaskHandle, BLE_TASK_CORE);
+
     DEBUG_PRINTLN("BLE Service started. Waiting for connections...");
     return true;
 }
 
-void BLEServiceManager::update() {
-    // Check connection status changes
-    deviceConnected = (pServer->getConnectedCount() > 0);
-    
-    if (deviceConnected != oldDeviceConnected) {
-        if (deviceConnected) {
-            DEBUG_PRINTLN("✓ Device connected");
-            digitalWrite(STATUS_LED_PIN, HIGH);
+// ============================================================================
+// NOTIFICATION SEND QUEUE
+// ============================================================================
+void BLEServiceManager::notifyTaskThunk(void* arg) {
+    static_cast<BLEServiceManager*>(arg)->notifyTaskLoop();
+}
+
+void BLEServiceManager::notifyTaskLoop() {
+    PendingNotify frame;
+
+    for (;;) {
+        // Bounded wait only while an alert awaits confirmation — the
+        // redelivery pump needs a clock; otherwise block for free.
+        ulTaskNotifyTake(pdTRUE, alertPendingCount > 0
+                                     ? pdMS_TO_TICKS(ALERT_RETRY_TICK_MS)
+                                     : portMAX_DELAY);
+
+        for (;;) {
+            // Highest-priority valid slot wins; rescanning from the
+            // top after every send lets an alert queued mid-drain go
+            // out ahead of telemetry that was there first.
+            uint8_t tier = TIER_COUNT;
+            portENTER_CRITICAL(&pendingLock);
+            for (uint8_t t = 0; t < TIER_COUNT; t++) {
+                if (pendingTierValid[t]) {
+                    frame = pendingTier[t];
+                    pendingTierValid[t] = false;
+                    tier = t;
+                    break;
+                }
+            }
+            portEXIT_CRITICAL(&pendingLock);
+
+            if (tier == TIER_COUNT) {
+                break;
+            }
+            if (!deviceConnected) {
+                continue;
+            }
+
+            fanOutNotification(frame);
+
+            uint32_t waitedMs = millis() - frame.queuedMs;
+            TierStats& stats = tierStats[tier];
+            stats.sent++;
+            stats.lastMs = waitedMs;
+            if (waitedMs > stats.maxMs) {
+                stats.maxMs = waitedMs;
+            }
+        }
+
+        pumpAlertRedelivery();
+    }
+}
+
+void BLEServiceManager::fanOutNotification(const PendingNotify& frame) {
+    uint32_t now = millis();
+
+    for (uint8_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (!clients.active(i)) {
+            continue;
+        }
+        ClientState& client = *clients.at(i);
+        if (!client.subscribed) {
+            continue; // command-only clients cost nothing here
+        }
+        if (frame.rateLimited) {
+            if (client.fieldMask == 0) {
+                continue; // alerts-only client: no sensor stream at all
+            }
+            if (client.lastSentMs != 0 &&
+                (now - client.lastSentMs) < client.updateIntervalMs) {
+                continue; // not due at this client's rate yet
+            }
+            // A delta frame that only carries fields this client opted
+            // out of is airtime spent on nothing — skip it. Keyframes
+            // (and the JSON path) always go through so a masked client
+            // keeps a baseline to apply later deltas to.
+            if (client.fieldMask != FIELD_ALL_MASK && frame.length >= 5 &&
+                frame.data[0] == FRAME_MAGIC &&
+                frame.data[2] == FRAME_TYPE_SENSOR_DELTA &&
+                (frame.data[4] & client.fieldMask) == 0) {
+                continue;
+            }
+        }
+
+        if (notifyClientWithRetry(client.connHandle, frame.data, frame.length)) {
+            client.lastSentMs = now;
         } else {
-            DEBUG_PRINTLN("✗ Device disconnected");
-            digitalWrite(STATUS_LED_PIN, LOW);
+            notifyStats.drops++;
         }
-        oldDeviceConnected = deviceConnected;
     }
 }
 
-bool BLEServiceManager::isConnected() {
-    return deviceConnected;
+void BLEServiceManager::queueNotification(const uint8_t* data, uint16_t length,
+                                          bool coalesce) {
+    // Legacy entry point: periodic frames coalesce on the telemetry
+    // tier, everything else rides control. Alerts use their tier
+    // explicitly (sendAlert).
+    queueTierNotification(coalesce ? TIER_TELEMETRY : TIER_CONTROL, data,
+                          length, coalesce);
 }
 
-void BLEServiceManager::sendSensorData(float temp, float humidity, int fanSpeed, 
-                                       int ledBright, bool motion, float distance) {
-    if (!deviceConnected) return;
-    
-    String json = createSensorJSON(temp, humidity, fanSpeed, ledBright, motion, distance);
-    pTxCharacteristic->setValue(json.c_str());
-    pTxCharacteristic->notify();
-    
-    DEBUG_PRINT("Sent: ");
-    DEBUG_PRINTLN(json);
+void BLEServiceManager::queueTierNotification(uint8_t tier, const uint8_t* data,
+                                              uint16_t length,
+                                              bool rateLimited) {
+    if (tier >= TIER_COUNT || length > sizeof(pendingTier[0].data)) {
+        return;
+    }
+
+    portENTER_CRITICAL(&pendingLock);
+    if (pendingTierValid[tier] && rateLimited) {
+        // A newer snapshot supersedes the unsent one — newest wins.
+        notifyStats.coalesced++;
+    }
+    PendingNotify& slot = pendingTier[tier];
+    memcpy(slot.data, data, length);
+    slot.length = length;
+    slot.rateLimited = rateLimited;
+    slot.queuedMs = millis();
+    pendingTierValid[tier] = true;
+    portEXIT_CRITICAL(&pendingLock);
+
+    if (notifyTaskHandle) {
+        xTaskNotifyGive(notifyTaskHandle);
+    }
 }
 
-String BLEServiceManager::createSensorJSON(float temp, float humidity, int fanSpeed, 
-                                           int ledBright, bool motion, float distance) {
-    StaticJsonDocument<256> doc;
-    
-    doc["type"] = "sensor_data";
-    doc["temperature"] = temp;
-    doc["humidity"] = humidity;
-    doc["fan_speed"] = fanSpeed;
-    doc["led_brightness"] = ledBright;
-    doc["motion"] = motion;
-    doc["distance"] = distance;
-    doc["timestamp"] = millis();
-    
-    String output;
-    serializeJson(doc, output);
-    return output;
+bool BLEServiceManager::notifyClientWithRetry(uint16_t connHandle,
+                                              const uint8_t* data,
+                                              uint16_t length) {
+    // Whole-call latency including retry sleeps: this is what a frame
+    // actually waits, which is the number that argues with "radio bad".
+    uint32_t startCycles = latencyCycleCount();
+    bool ok = notifyClientAttempts(connHandle, data, length);
+    notifyLatency.record(latencyCycleCount() - startCycles);
+    return ok;
 }
 
-void BLEServiceManager::handleCommand(String command) {
-    StaticJsonDocument<256> doc;
-    DeserializationError error = deserializeJson(doc, command);
-    
-    if (error) {
-        DEBUG_PRINT("JSON parse error: ");
-        DEBUG_PRINTLN(error.c_str());
-        return;
+bool BLEServiceManager::notifyClientAttempts(uint16_t connHandle,
+                                             const uint8_t* data,
+                                             uint16_t length) {
+    for (uint8_t attempt = 0; attempt <= BLE_NOTIFY_RETRY_MAX; attempt++) {
+        if (attempt > 0) {
+            notifyStats.retries++;
+            vTaskDelay(pdMS_TO_TICKS(BLE_NOTIFY_RETRY_DELAY_MS));
+        }
+
+        // Per-connection notify through the host API; the return code
+        // is the congestion signal (ENOMEM when mbufs run dry).
+        os_mbuf* om = ble_hs_mbuf_from_flat(data, length);
+        if (om == NULL) {
+            continue;
+        }
+
+        int rc = ble_gatts_notify_custom(connHandle,
+                                         pTxCharacteristic->getHandle(), om);
+        if (rc == 0) {
+            notifyStats.sent++;
+            return true;
+        }
     }
-    
-    const char* cmd = doc["cmd"];
-    
-    if (strcmp(cmd, "SET_FAN") == 0) {
-        uint8_t speed = doc["value"];
-        DEBUG_PRINTF("Setting fan speed to: %d\n", speed);
-        if (fanSpeedCallback) {
-            fanSpeedCallback(speed);
+    return false;
+}
+
+bool BLEServiceManager::notifyClientFill(uint16_t connHandle, uint16_t length,
+                                         bool (*fill)(void* ctx, uint8_t* dst),
+                                         void* ctx) {
+    uint32_t startCycles = latencyCycleCount();
+    bool ok = false;
+
+    for (uint8_t attempt = 0; attempt <= BLE_NOTIFY_RETRY_MAX; attempt++) {
+        if (attempt > 0) {
+            notifyStats.retries++;
+            vTaskDelay(pdMS_TO_TICKS(BLE_NOTIFY_RETRY_DELAY_MS));
+        }
+
+        os_mbuf* om = ble_hs_mbuf_att_pkt();
+        if (om == NULL) {
+            continue;
+        }
+        // Contiguous when non-NULL; a notify payload always fits one
+        // msys block at our MTU.
+        uint8_t* dst = (uint8_t*)os_mbuf_extend(om, length);
+        if (dst == NULL) {
+            os_mbuf_free_chain(om);
+            continue;
+        }
+        if (!fill(ctx, dst)) {
+            os_mbuf_free_chain(om);
+            break; // source error, not congestion — don't retry
+        }
+
+        int rc = ble_gatts_notify_custom(connHandle,
+                                         pTxCharacteristic->getHandle(), om);
+        if (rc == 0) {
+            notifyStats.sent++;
+            ok = true;
+            break;
         }
     }
-    else if (strcmp(cmd, "SET_LED") == 0) {
-        uint8_t brightness = doc["value"];
-        DEBUG_PRINTF("Setting LED brightness to: %d\n", brightness);
-        if (ledBrightnessCallback) {
-            ledBrightnessCallback(brightness);
+
+    notifyLatency.record(latencyCycleCount() - startCycles);
+    return ok;
+}
+
+// ============================================================================
+// CHUNK FRAMING
+// ============================================================================
+// Every bulk stream shares the same MTU clamp; a framed client also
+// gives up trailer room so the sealed chunk still fits one notify.
+uint16_t BLEServiceManager::chunkPayloadCap() const {
+    uint16_t cap = maxPayloadSize();
+    if (cap > BLE_PREFERRED_MTU - 3) {
+        cap = BLE_PREFERRED_MTU - 3;
+    }
+    if (negotiatedCaps & PROTO_CAP_FRAMED_CHUNKS) {
+        cap -= ChunkFramer::TRAILER_LEN;
+    }
+    return cap;
+}
+
+bool BLEServiceManager::notifyChunk(ChunkFramer& framer, uint16_t connHandle,
+                                    uint8_t* chunk, uint16_t length) {
+    // Bulk QoS gate: a queued alert (or an alert indication awaiting
+    // its link-layer ack) owns the air first. Yield this chunk slot
+    // until the notify task drains it; if the link is congested enough
+    // that the alert still hasn't cleared inside the bound, abort the
+    // sequence — every bulk loop treats a false return as "stop
+    // streaming", and the client re-requests from its cursor.
+    uint32_t yieldedMs = 0;
+    while ((pendingTierValid[TIER_ALERT] || alertInFlight) &&
+           yieldedMs < BLE_BULK_ALERT_YIELD_MS) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+        yieldedMs += 10;
+    }
+    if (pendingTierValid[TIER_ALERT] || alertInFlight) {
+        notifyStats.bulkAborts++;
+        return false;
+    }
+
+    if (negotiatedCaps & PROTO_CAP_FRAMED_CHUNKS) {
+        length = framer.seal(chunk, length);
+    }
+    return notifyClientWithRetry(connHandle, chunk, length);
+}
+
+// ============================================================================
+// PER-CLIENT STATE
+// ============================================================================
+BLEServiceManager::ClientState* BLEServiceManager::findClient(uint16_t connHandle) {
+    for (uint8_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (clients.active(i) && clients.at(i)->connHandle == connHandle) {
+            return clients.at(i);
         }
     }
-    else if (strcmp(cmd, "SET_AUTO") == 0) {
-        bool enabled = doc["value"];
-        DEBUG_PRINTF("Setting auto mode to: %s\n", enabled ? "ON" : "OFF");
-        if (autoModeCallback) {
-            autoModeCallback(enabled);
+    return nullptr;
+}
+
+void BLEServiceManager::handleConnect(uint16_t connHandle) {
+    // A freshly constructed slot: fields zeroed, session unauthenticated
+    // — handles get reused by the stack, and a reconstructed slot can't
+    // inherit the previous connection's session.
+    ClientState* client = clients.alloc();
+    if (client) {
+        client->connHandle = connHandle;
+        client->mtu = 23;
+        client->updateIntervalMs = BLE_UPDATE_INTERVAL;
+        client->fieldMask = FIELD_ALL_MASK;
+    }
+
+    deviceConnected = true;
+    TRACE_EVENT(TRACE_BLE_CONNECT, 0, connHandle);
+
+    // A fresh connection counts as activity — the app was just opened
+    // — so the link starts interactive and the quiet window relaxes it.
+    lastCommandMs = millis();
+    if (!connProfilePinned) {
+        connProfile = CONN_PROFILE_INTERACTIVE;
+    }
+    requestConnParams(connHandle);
+
+    if (statusLed) {
+        statusLed->play(LedPatternEngine::SOLID);
+    }
+}
+
+void BLEServiceManager::handleDisconnect(uint16_t connHandle) {
+    ClientState* client = findClient(connHandle);
+    if (client) {
+        client->auth.reset(); // session key dies with the connection
+        clients.release(client);
+    }
+    TRACE_EVENT(TRACE_BLE_DISCONNECT, 0, connHandle);
+
+    deviceConnected = !clients.empty();
+
+    if (!deviceConnected) {
+        // Pending alert slots stay; only the live indication state
+        // resets. The next subscriber drains the backlog.
+        alertIndicationsOn = false;
+        alertInFlight = false;
+
+        // The next connection renegotiates from the firmware defaults
+        // instead of inheriting the previous app's capabilities.
+        negotiatedCaps = PROTO_CAPS_SUPPORTED;
+        jsonCompatMode = BLE_JSON_COMPAT_DEFAULT;
+        statusSnapshotDirty = true;
+    }
+
+    if (!deviceConnected && statusLed) {
+        // Heartbeat while advertising so the unit is visibly alive.
+        statusLed->play(LedPatternEngine::HEARTBEAT);
+    }
+}
+
+// ============================================================================
+// CONNECTION-PARAMETER PROFILES
+// ============================================================================
+// One parameter-update request per link; the host stack negotiates,
+// and CMD_GET_LINK reports what the peer actually granted.
+void BLEServiceManager::requestConnParams(uint16_t connHandle) {
+    if (pServer == nullptr) {
+        return;
+    }
+    if (connProfile == CONN_PROFILE_INTERACTIVE) {
+        pServer->updateConnParams(connHandle,
+                                  BLE_CONN_INTERACTIVE_ITVL_MIN,
+                                  BLE_CONN_INTERACTIVE_ITVL_MAX,
+                                  BLE_CONN_INTERACTIVE_LATENCY,
+                                  BLE_CONN_SUPERVISION_TIMEOUT);
+    } else {
+        pServer->updateConnParams(connHandle,
+                                  BLE_CONN_MONITOR_ITVL_MIN,
+                                  BLE_CONN_MONITOR_ITVL_MAX,
+                                  BLE_CONN_MONITOR_LATENCY,
+                                  BLE_CONN_SUPERVISION_TIMEOUT);
+    }
+}
+
+void BLEServiceManager::applyConnProfile(ConnProfile profile) {
+    connProfile = profile;
+    for (uint8_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (clients.active(i)) {
+            requestConnParams(clients.at(i)->connHandle);
         }
     }
-    else if (strcmp(cmd, "GET_STATUS") == 0) {
-        // Send immediate status update
-        DEBUG_PRINTLN("Status request received");
+    DEBUG_PRINTF("Conn profile: %s\n",
+                 profile == CONN_PROFILE_INTERACTIVE ? "interactive"
+                                                     : "monitor");
+}
+
+// Every accepted command bumps the activity stamp; the first one after
+// a quiet stretch promotes the links back to interactive before its
+// handler runs, so the rest of a burst rides the short interval.
+void BLEServiceManager::noteCommandActivity() {
+    lastCommandMs = millis();
+    if (!connProfilePinned && connProfile != CONN_PROFILE_INTERACTIVE) {
+        applyConnProfile(CONN_PROFILE_INTERACTIVE);
+    }
+}
+
+// Checked from the periodic sensor push — interval granularity is
+// plenty against the relax window.
+void BLEServiceManager::relaxConnProfileIfIdle() {
+    if (connProfilePinned || connProfile != CONN_PROFILE_INTERACTIVE) {
+        return;
     }
-    else {
-        DEBUG_PRINT("Unknown command: ");
-        DEBUG_PRINTLN(cmd);
+    if ((millis() - lastCommandMs) >= BLE_CONN_IDLE_RELAX_MS) {
+        applyConnProfile(CONN_PROFILE_MONITOR);
     }
 }
 
-void BLEServiceManager::onFanSpeedChange(void (*callback)(uint8_t)) {
-    fanSpeedCallback = callback;
+void BLEServiceManager::cmdSetConnProfile(BLEServiceManager* mgr,
+                                          const uint8_t* payload, size_t length) {
+    switch (payload[0]) {
+    case 0: // auto: resume activity-based switching from a fresh stamp
+        mgr->connProfilePinned = false;
+        mgr->lastCommandMs = millis();
+        break;
+    case 1:
+        mgr->connProfilePinned = true;
+        mgr->applyConnProfile(CONN_PROFILE_INTERACTIVE);
+        break;
+    case 2:
+        mgr->connProfilePinned = true;
+        mgr->applyConnProfile(CONN_PROFILE_MONITOR);
+        break;
+    default:
+        DEBUG_PRINTF("Unknown conn profile %u\n", payload[0]);
+        break;
+    }
 }
 
-void BLEServiceManager::onLEDBrightnessChange(void (*callback)(uint8_t)) {
-    ledBrightnessCallback = callback;
+void BLEServiceManager::cmdSubscribe(BLEServiceManager* mgr,
+                                     const uint8_t* payload, size_t length) {
+    ClientState* client = mgr->findClient(mgr->cmdConnHandle);
+    if (client == nullptr) {
+        return;
+    }
+
+    uint16_t periodMs = (uint16_t)payload[0] | ((uint16_t)payload[1] << 8);
+    if (periodMs == 0) {
+        periodMs = BLE_UPDATE_INTERVAL;
+    } else if (periodMs < BLE_SUBSCRIBE_MIN_PERIOD_MS) {
+        periodMs = BLE_SUBSCRIBE_MIN_PERIOD_MS;
+    }
+
+    client->updateIntervalMs = periodMs;
+    client->fieldMask = payload[2] & FIELD_ALL_MASK;
+    DEBUG_PRINTF("Subscribe: conn %u period %u ms mask 0x%02X\n",
+                 client->connHandle, periodMs, client->fieldMask);
 }
 
-void BLEServiceManager::onAutoModeChange(void (*callback)(bool)) {
-    autoModeCallback = callback;
+// ============================================================================
+// BONDING / FAST RECONNECT
+// ============================================================================
+void BLEServiceManager::rememberPeer(const ble_addr_t& addr) {
+    if (haveBondedPeer && memcmp(&addr, &lastPeerAddr, sizeof(addr)) == 0) {
+        return; // same peer — no NVS wear
+    }
+
+    lastPeerAddr = addr;
+    haveBondedPeer = true;
+    blePrefs.putBytes(PREF_LAST_PEER, &lastPeerAddr, sizeof(lastPeerAddr));
+}
+
+int BLEServiceManager::gapEventThunk(struct ble_gap_event* event, void* arg) {
+    BLEServiceManager* mgr = static_cast<BLEServiceManager*>(arg);
+    if (event->type == BLE_GAP_EVENT_DISCONNECT) {
+        mgr->disconnectCount++;
+        mgr->lastDisconnectReason = (uint8_t)event->disconnect.reason;
+        mgr->lastDisconnectMs = millis();
+    }
+    return 0;
+}
+
+int BLEServiceManager::directedAdvGapEvent(struct ble_gap_event* event, void* arg) {
+    // The directed burst timed out without the peer answering — drop
+    // back to generic connectable advertising.
+    if (event->type == BLE_GAP_EVENT_ADV_COMPLETE) {
+        NimBLEDevice::startAdvertising();
+    }
+    return 0;
+}
+
+void BLEServiceManager::applyAdvCadence(AdvCadence cadence) {
+    if (pAdvertising == nullptr) {
+        return;
+    }
+    advCadence = cadence;
+    if (cadence == ADV_CADENCE_FAST) {
+        advFastSinceMs = millis();
+        pAdvertising->setMinInterval(BLE_ADV_FAST_ITVL_MIN);
+        pAdvertising->setMaxInterval(BLE_ADV_FAST_ITVL_MAX);
+    } else {
+        pAdvertising->setMinInterval(BLE_ADV_SLOW_ITVL_MIN);
+        pAdvertising->setMaxInterval(BLE_ADV_SLOW_ITVL_MAX);
+    }
+    // New intervals take effect on the next start; bounce a live set.
+    if (pAdvertising->isAdvertising()) {
+        pAdvertising->stop();
+        pAdvertising->start();
+    }
+    DEBUG_PRINTF("Adv cadence: %s\n",
+                 cadence == ADV_CADENCE_FAST ? "fast" : "slow");
+}
+
+// Checked from the periodic sensor cycle — interval granularity is
+// plenty against a 30 s window.
+void BLEServiceManager::relaxAdvCadenceIfQuiet() {
+    if (advCadence == ADV_CADENCE_FAST &&
+        (millis() - advFastSinceMs) >= BLE_ADV_FAST_WINDOW_MS) {
+        applyAdvCadence(ADV_CADENCE_SLOW);
+    }
+}
+
+void BLEServiceManager::noteMotionActivity() {
+    if (advCadence != ADV_CADENCE_FAST) {
+        applyAdvCadence(ADV_CADENCE_FAST);
+    } else {
+        advFastSinceMs = millis(); // already fast: extend the window
+    }
+}
+
+void BLEServiceManager::startReconnectAdvertising() {
+    // A disconnect restarts the likely-connect window — the phone that
+    // just dropped is the most probable next connection.
+    applyAdvCadence(ADV_CADENCE_FAST);
+
+    if (haveBondedPeer && pServer->getConnectedCount() == 0) {
+        // High-duty directed advertising at the last bonded peer: it
+        // reconnects in one connection interval instead of waiting out
+        // a scan window against generic advertising.
+        ble_gap_adv_params params;
+        memset(&params, 0, sizeof(params));
+        params.conn_mode = BLE_GAP_CONN_MODE_DIR;
+        params.disc_mode = BLE_GAP_DISC_MODE_NON;
+        params.high_duty_cycle = 1;
+
+        int rc = ble_gap_adv_start(BLE_OWN_ADDR_PUBLIC, &lastPeerAddr,
+                                   BLE_DIRECTED_ADV_MS, &params,
+                                   directedAdvGapEvent, nullptr);
+        if (rc == 0) {
+            DEBUG_PRINTLN("Directed advertising at last bonded peer");
+            return;
+        }
+        DEBUG_PRINTF("Directed adv failed (rc=%d), falling back\n", rc);
+    }
+
+    NimBLEDevice::startAdvertising();
+}
+
+void BLEServiceManager::handleMtuChange(uint16_t connHandle, uint16_t mtu) {
+    ClientState* client = findClient(connHandle);
+    if (client) {
+        client->mtu = mtu;
+    }
+}
+
+void BLEServiceManager::handleSubscription(uint16_t connHandle, bool subscribed) {
+    ClientState* client = findClient(connHandle);
+    if (client) {
+        client->subscribed = subscribed;
+        DEBUG_PRINTF("Client %d %s notifications\n", connHandle,
+                     subscribed ? "subscribed to" : "unsubscribed from");
+        // Backfill the minutes the client was away before the periodic
+        // cadence takes over — capability-gated, and pointless for an
+        // alerts-only subscription.
+        if (subscribed && (negotiatedCaps & PROTO_CAP_CATCHUP) &&
+            client->fieldMask != 0) {
+            startCatchupSync(connHandle);
+        }
+    }
+}
+
+uint16_t BLEServiceManager::maxPayloadSize() const {
+    // Sized for the most constrained subscribed client so one frame
+    // fits every link.
+    uint16_t mtu = BLE_PREFERRED_MTU;
+    bool anySubscribed = false;
+
+    for (uint8_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (clients.active(i) && clients.at(i)->subscribed) {
+            anySubscribed = true;
+            if (clients.at(i)->mtu < mtu) {
+                mtu = clients.at(i)->mtu;
+            }
+        }
+    }
+
+    return (anySubscribed ? mtu : (uint16_t)23) - 3; // ATT notify header
+}
+
+bool BLEServiceManager::isConnected() {
+    return deviceConnected;
+}
+
+void BLEServiceManager::sendSensorData(float temp, float humidity, int fanSpeed,
+                                       int ledBright, bool motion, float distance,
+                                       uint8_t occupancy, bool sensorFault,
+                                       uint16_t fanRpm, bool stale) {
+    PROFILE_SCOPE(PROF_SENSOR_PUSH);
+
+    // Packed frame: fixed offsets, no serialization and no heap. The
+    // legacy JSON path serializes from the encoded frame too, so both
+    // formats are fed by the same data.
+    SensorFrame frame;
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_SENSOR;
+    frame.flags = (motion ? SENSOR_FLAG_MOTION : 0) |
+                  (sensorFault ? SENSOR_FLAG_FAULT : 0) |
+                  ((coreDumpStore && coreDumpStore->hasDump())
+                       ? SENSOR_FLAG_COREDUMP : 0) |
+                  (stale ? SENSOR_FLAG_STALE : 0);
+    frame.temperature = (int16_t)(temp * 100.0f);
+    frame.humidity = (uint16_t)(humidity * 100.0f);
+    frame.fanSpeed = (uint8_t)fanSpeed;
+    frame.ledBrightness = (uint8_t)ledBright;
+    frame.distance = (uint16_t)(distance * 10.0f);
+    frame.occupancy = occupancy;
+    frame.fanRpm = fanRpm;
+    frame.timestampMs = (uint32_t)millis();
+
+    // The catch-up ring records with or without a connection — its
+    // whole point is covering the minutes nobody was subscribed.
+    recordCatchupFrame(frame);
+    relaxAdvCadenceIfQuiet();
+
+    if (!deviceConnected) return;
+
+    relaxConnProfileIfIdle();
+
+    // Feed the status snapshot cache; serialization waits until a
+    // CMD_GET_STATUS actually asks for it.
+    statusFrame = frame;
+    statusSnapshotDirty = true;
+
+    if (jsonCompatMode) {
+        // Legacy path for old app versions; serialized once per
+        // content change, not per tick (buildSensorJsonCached).
+        char json[192];
+        size_t len = buildSensorJsonCached(frame, json, sizeof(json));
+        if (len > 0) {
+            queueNotification((const uint8_t*)json, len, true);
+        }
+        return;
+    }
+
+    // Keyframe cadence: a full frame every BLE_KEYFRAME_EVERY updates
+    // (or on first send) resynchronizes clients; everything in between
+    // is a delta of only the changed fields — unless the negotiated
+    // capabilities say the app can't reassemble deltas.
+    if (!haveLastSent || framesSinceKeyframe >= BLE_KEYFRAME_EVERY ||
+        (negotiatedCaps & PROTO_CAP_DELTA_FRAMES) == 0) {
+        queueNotification((const uint8_t*)&frame, sizeof(frame), true);
+        lastSentFrame = frame;
+        haveLastSent = true;
+        framesSinceKeyframe = 0;
+        return;
+    }
+
+    sendDeltaFrame(frame);
+}
+
+void BLEServiceManager::sendDeltaFrame(const SensorFrame& frame) {
+    uint8_t bitmap = 0;
+    if (frame.temperature != lastSentFrame.temperature) bitmap |= FIELD_TEMPERATURE;
+    if (frame.humidity != lastSentFrame.humidity) bitmap |= FIELD_HUMIDITY;
+    if (frame.fanSpeed != lastSentFrame.fanSpeed) bitmap |= FIELD_FAN_SPEED;
+    if (frame.ledBrightness != lastSentFrame.ledBrightness) bitmap |= FIELD_LED_BRIGHT;
+    if (frame.distance != lastSentFrame.distance) bitmap |= FIELD_DISTANCE;
+    if (frame.occupancy != lastSentFrame.occupancy) bitmap |= FIELD_OCCUPANCY;
+    if (frame.fanRpm != lastSentFrame.fanRpm) bitmap |= FIELD_FAN_RPM;
+
+    framesSinceKeyframe++;
+
+    if (bitmap == 0 && frame.flags == lastSentFrame.flags) {
+        // Nothing changed — the common case in an empty room. Skip the
+        // notification entirely.
+        return;
+    }
+
+    // Header + bitmap + changed fields, packed in bit order.
+    uint8_t buf[sizeof(SensorFrame)];
+    uint8_t len = 0;
+    buf[len++] = FRAME_MAGIC;
+    buf[len++] = SENSOR_FRAME_VERSION;
+    buf[len++] = FRAME_TYPE_SENSOR_DELTA;
+    buf[len++] = frame.flags;
+    buf[len++] = bitmap;
+
+    if (bitmap & FIELD_TEMPERATURE) {
+        memcpy(&buf[len], &frame.temperature, sizeof(frame.temperature));
+        len += sizeof(frame.temperature);
+    }
+    if (bitmap & FIELD_HUMIDITY) {
+        memcpy(&buf[len], &frame.humidity, sizeof(frame.humidity));
+        len += sizeof(frame.humidity);
+    }
+    if (bitmap & FIELD_FAN_SPEED) {
+        buf[len++] = frame.fanSpeed;
+    }
+    if (bitmap & FIELD_LED_BRIGHT) {
+        buf[len++] = frame.ledBrightness;
+    }
+    if (bitmap & FIELD_DISTANCE) {
+        memcpy(&buf[len], &frame.distance, sizeof(frame.distance));
+        len += sizeof(frame.distance);
+    }
+    if (bitmap & FIELD_OCCUPANCY) {
+        buf[len++] = frame.occupancy;
+    }
+    if (bitmap & FIELD_FAN_RPM) {
+        memcpy(&buf[len], &frame.fanRpm, sizeof(frame.fanRpm));
+        len += sizeof(frame.fanRpm);
+    }
+
+    queueNotification(buf, len, true);
+    lastSentFrame = frame;
+}
+
+// ============================================================================
+// RECONNECT CATCH-UP
+// ============================================================================
+void BLEServiceManager::recordCatchupFrame(const SensorFrame& frame) {
+    uint32_t now = millis();
+    if (catchupLastRecordMs != 0 &&
+        (now - catchupLastRecordMs) < BLE_CATCHUP_INTERVAL_MS) {
+        return;
+    }
+    catchupLastRecordMs = now;
+
+    portENTER_CRITICAL(&catchupLock);
+    catchupRing[catchupHead] = frame;
+    catchupHead = (uint16_t)((catchupHead + 1) % BLE_CATCHUP_RING_FRAMES);
+    if (catchupCount < BLE_CATCHUP_RING_FRAMES) {
+        catchupCount++;
+    }
+    portEXIT_CRITICAL(&catchupLock);
+}
+
+void BLEServiceManager::startCatchupSync(uint16_t connHandle) {
+    if (catchupSyncRunning || catchupCount == 0) {
+        return;
+    }
+
+    catchupSyncRunning = true;
+    catchupConnHandle = connHandle;
+    TaskHandle_t handle;
+    if (xTaskCreatePinnedToCore(catchupTaskThunk, "ble_catchup",
+                                BLE_NOTIFY_TASK_STACK, this,
+                                BLE_TASK_PRIORITY, &handle,
+                                BLE_TASK_CORE) != pdPASS) {
+        catchupSyncRunning = false;
+    }
+}
+
+void BLEServiceManager::catchupTaskThunk(void* arg) {
+    static_cast<BLEServiceManager*>(arg)->catchupTaskLoop();
+    vTaskDelete(NULL);
+}
+
+// Streams the ring oldest-first, as many frames per chunk as the
+// negotiated MTU carries. The snapshot of (head, count) is taken once:
+// at the 5 s record cadence a second-long burst cannot be lapped by
+// the writer, and each chunk's frames are copied out under the lock.
+void BLEServiceManager::catchupTaskLoop() {
+    uint16_t connHandle = catchupConnHandle;
+    uint16_t chunkCap = chunkPayloadCap();
+    uint8_t frameCap = (uint8_t)((chunkCap - sizeof(CatchupChunkHeader)) /
+                                 sizeof(SensorFrame));
+    if (frameCap == 0) {
+        // Default 23-byte MTU can't carry even one frame — the client
+        // subscribed before negotiating. It gets the periodic stream.
+        DEBUG_PRINTLN("Catch-up: MTU too small, skipping burst");
+        catchupSyncRunning = false;
+        return;
+    }
+
+    portENTER_CRITICAL(&catchupLock);
+    uint16_t count = catchupCount;
+    uint16_t idx = (uint16_t)((catchupHead + BLE_CATCHUP_RING_FRAMES - count) %
+                              BLE_CATCHUP_RING_FRAMES);
+    portEXIT_CRITICAL(&catchupLock);
+
+    uint8_t chunk[BLE_PREFERRED_MTU];
+    ChunkFramer framer;
+    CatchupChunkHeader* header = (CatchupChunkHeader*)chunk;
+    header->magic = FRAME_MAGIC;
+    header->version = SENSOR_FRAME_VERSION;
+    header->type = FRAME_TYPE_CATCHUP_CHUNK;
+
+    uint16_t sent = 0;
+    bool aborted = false;
+    while (count > 0) {
+        uint8_t n = (count < frameCap) ? (uint8_t)count : frameCap;
+        SensorFrame* frames =
+            (SensorFrame*)(chunk + sizeof(CatchupChunkHeader));
+        portENTER_CRITICAL(&catchupLock);
+        for (uint8_t k = 0; k < n; k++) {
+            frames[k] = catchupRing[(idx + k) % BLE_CATCHUP_RING_FRAMES];
+        }
+        portEXIT_CRITICAL(&catchupLock);
+
+        header->frameCount = n;
+        if (!notifyChunk(framer, connHandle, chunk,
+                         sizeof(CatchupChunkHeader) +
+                             n * sizeof(SensorFrame))) {
+            DEBUG_PRINTLN("Catch-up: client congested, aborting");
+            aborted = true;
+            break;
+        }
+        idx = (uint16_t)((idx + n) % BLE_CATCHUP_RING_FRAMES);
+        count -= n;
+        sent += n;
+    }
+
+    // End-of-burst marker: the app closes its backfill window and
+    // resumes live updates.
+    if (!aborted) {
+        header->frameCount = 0;
+        notifyChunk(framer, connHandle, chunk, sizeof(CatchupChunkHeader));
+        DEBUG_PRINTF("Catch-up burst done: %u frames\n", sent);
+    }
+    catchupSyncRunning = false;
+}
+
+void BLEServiceManager::sendZoneEvent(uint8_t zone, uint8_t prevZone,
+                                      uint16_t distMm, uint32_t dwellMs) {
+    if (!deviceConnected) {
+        return; // offline gap: the catch-up ring's distance samples
+                // let the app re-derive missed transitions
+    }
+
+    ZoneEventFrame frame;
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_ZONE_EVENT;
+    frame.zone = zone;
+    frame.prevZone = prevZone;
+    frame.reserved = 0;
+    frame.distMm = distMm;
+    frame.dwellMs = dwellMs;
+
+    queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+void BLEServiceManager::sendAlert(uint8_t alarmType, uint16_t value,
+                                  uint32_t timestampMs) {
+    AlertFrame frame;
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_ALERT;
+    frame.alarmType = alarmType;
+    frame.value = value;
+    frame.reserved = 0;
+    frame.timestampMs = timestampMs;
+
+    // Authoritative copy: the acknowledged indication channel. Queued
+    // even with nobody connected — delivery happens on the next
+    // subscribe, and the newest slot rides RTC memory across resets.
+    queueAlertIndication(frame);
+
+    {
+        RtcStateData& rtc = RtcState::data();
+        rtc.alertPendingValid = 1;
+        rtc.alertPendingType = alarmType;
+        rtc.alertPendingValue = value;
+        rtc.alertPendingStampMs = timestampMs;
+        RtcState::commit();
+    }
+
+    if (!deviceConnected) {
+        return;
+    }
+
+    // Compatibility copy on the TX stream, fire-and-forget as before.
+    // TIER_ALERT: drained ahead of anything else in the send queue,
+    // and bulk chunk streams yield to it.
+    queueTierNotification(TIER_ALERT, (const uint8_t*)&frame, sizeof(frame),
+                          false);
+}
+
+// ============================================================================
+// GUARANTEED ALERT DELIVERY
+// ============================================================================
+void BLEServiceManager::queueAlertIndication(const AlertFrame& frame) {
+    portENTER_CRITICAL(&alertLock);
+    // Free slot, else evict the oldest unacked: when the ring is full
+    // of undeliverable alerts, the newest condition is the one the
+    // caregiver must see first.
+    uint8_t slot = 0xFF;
+    for (uint8_t i = 0; i < ALERT_PENDING_MAX; i++) {
+        if (!pendingAlerts[i].valid) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot == 0xFF) {
+        slot = 0;
+        for (uint8_t i = 1; i < ALERT_PENDING_MAX; i++) {
+            if (pendingAlerts[i].frame.timestampMs <
+                pendingAlerts[slot].frame.timestampMs) {
+                slot = i;
+            }
+        }
+        if (alertInFlight && alertInFlightIdx == slot) {
+            // Never yank the frame the stack is mid-indicating.
+            slot = (uint8_t)((slot + 1) % ALERT_PENDING_MAX);
+        }
+    } else {
+        alertPendingCount++;
+    }
+
+    pendingAlerts[slot].frame = frame;
+    pendingAlerts[slot].attempts = 0;
+    pendingAlerts[slot].nextTryMs = millis();
+    pendingAlerts[slot].backoffMs = ALERT_RETRY_BASE_MS;
+    pendingAlerts[slot].valid = true;
+    portEXIT_CRITICAL(&alertLock);
+
+    if (notifyTaskHandle) {
+        xTaskNotifyGive(notifyTaskHandle);
+    }
+}
+
+// Notify-task pump: one indication in flight at a time (the protocol
+// allows no more), due slots picked oldest-first so a burst delivers
+// in raise order.
+void BLEServiceManager::pumpAlertRedelivery() {
+    uint32_t now = millis();
+
+    if (alertInFlight) {
+        if ((now - alertInFlightSinceMs) < ALERT_INDICATE_GUARD_MS) {
+            return;
+        }
+        // The stack never reported back (disconnect mid-indication);
+        // treat as unconfirmed so the slot retries.
+        handleAlertIndicationStatus(false);
+    }
+    if (!alertIndicationsOn || alertPendingCount == 0) {
+        return;
+    }
+
+    uint8_t slot = 0xFF;
+    uint32_t oldest = 0xFFFFFFFF;
+    portENTER_CRITICAL(&alertLock);
+    for (uint8_t i = 0; i < ALERT_PENDING_MAX; i++) {
+        if (pendingAlerts[i].valid && pendingAlerts[i].nextTryMs <= now &&
+            pendingAlerts[i].frame.timestampMs < oldest) {
+            slot = i;
+            oldest = pendingAlerts[i].frame.timestampMs;
+        }
+    }
+    if (slot != 0xFF) {
+        alertInFlight = true;
+        alertInFlightIdx = slot;
+        alertInFlightSinceMs = now;
+    }
+    portEXIT_CRITICAL(&alertLock);
+    if (slot == 0xFF) {
+        return;
+    }
+
+    pAlertCharacteristic->setValue((const uint8_t*)&pendingAlerts[slot].frame,
+                                   sizeof(AlertFrame));
+    pAlertCharacteristic->indicate();
+}
+
+void BLEServiceManager::handleAlertIndicationStatus(bool confirmed) {
+    if (!alertInFlight) {
+        return; // status for a frame we no longer track
+    }
+
+    portENTER_CRITICAL(&alertLock);
+    PendingAlert& slot = pendingAlerts[alertInFlightIdx];
+    if (confirmed) {
+        slot.valid = false;
+        if (alertPendingCount > 0) {
+            alertPendingCount--;
+        }
+    } else {
+        slot.attempts++;
+        slot.nextTryMs = millis() + slot.backoffMs;
+        slot.backoffMs = (slot.backoffMs * 2 > ALERT_RETRY_MAX_MS)
+                             ? ALERT_RETRY_MAX_MS : slot.backoffMs * 2;
+    }
+    AlertFrame acked = slot.frame;
+    alertInFlight = false;
+    portEXIT_CRITICAL(&alertLock);
+
+    if (confirmed) {
+        // The phone has it; the reset-survival copy is done too.
+        RtcStateData& rtc = RtcState::data();
+        if (rtc.alertPendingValid &&
+            rtc.alertPendingStampMs == acked.timestampMs &&
+            rtc.alertPendingType == acked.alarmType) {
+            rtc.alertPendingValid = 0;
+            RtcState::commit();
+        }
+        DEBUG_PRINTF("Alert confirmed: type %u\n", acked.alarmType);
+    }
+
+    if (notifyTaskHandle) {
+        xTaskNotifyGive(notifyTaskHandle); // next due slot, if any
+    }
+}
+
+void BLEServiceManager::handleAlertSubscription(uint16_t connHandle,
+                                                bool indicate) {
+    alertIndicationsOn = indicate;
+    DEBUG_PRINTF("Client %u %s alert indications\n", connHandle,
+                 indicate ? "enabled" : "disabled");
+    if (indicate && notifyTaskHandle) {
+        xTaskNotifyGive(notifyTaskHandle); // flush the backlog now
+    }
+}
+
+void BLEServiceManager::broadcastSensorSnapshot(float temp, float humidity,
+                                                bool motion, uint8_t fanSpeed) {
+#if BLE_ADV_BROADCAST_ENABLE
+    if (!pAdvertising) {
+        return;
+    }
+
+    // Company ID (little-endian) followed by the packed snapshot.
+    uint8_t buf[2 + sizeof(AdvSensorFrame)];
+    buf[0] = BLE_ADV_COMPANY_ID & 0xFF;
+    buf[1] = (BLE_ADV_COMPANY_ID >> 8) & 0xFF;
+
+    AdvSensorFrame frame;
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.flags = motion ? SENSOR_FLAG_MOTION : 0;
+    frame.temperature = (int16_t)(temp * 100.0f);
+    frame.humidity = (uint16_t)(humidity * 100.0f);
+    frame.fanSpeed = fanSpeed;
+    frame.sequence = advSequence++;
+    memcpy(&buf[2], &frame, sizeof(frame));
+
+    // The controller only picks up new payload on a (re)start, so
+    // bounce advertising when it is live. When all client slots are
+    // taken advertising is stopped; the data still lands on the next
+    // start after a disconnect.
+    bool wasAdvertising = pAdvertising->isAdvertising();
+    if (wasAdvertising) {
+        pAdvertising->stop();
+    }
+    pAdvertising->setManufacturerData(
+        std::string((const char*)buf, sizeof(buf)));
+    if (wasAdvertising) {
+        pAdvertising->start();
+    }
+#endif
+}
+
+void BLEServiceManager::setJsonCompatMode(bool enabled) {
+    jsonCompatMode = enabled;
+}
+
+// Legacy JSON serializer, generated from SENSOR_FRAME_SCHEMA: keys
+// and punctuation are compile-time literals memcpy'd in place, and
+// each value goes through the fixed-point emitters in JsonNumber.h —
+// the overload on the schema's decode expression type picks integer
+// or one-decimal formatting at compile time. No snprintf at all: the
+// "%.1f" conversions it did per field were the dominant cost of this
+// path, generic double machinery for values that are scaled integers
+// on the wire. Still schema-driven, so it cannot drift from the
+// binary layout. Motion and the timestamp ride the frame header
+// rather than schema rows.
+#define SENSOR_JSON_EMIT(name, ctype, key, fmt, expr)            \
+    memcpy(p, "\"" key "\":", sizeof("\"" key "\":") - 1);       \
+    p += sizeof("\"" key "\":") - 1;                             \
+    p = jsonAppendNumber(p, expr);                               \
+    *p++ = ',';
+#define SENSOR_JSON_LITERAL(name, ctype, key, fmt, expr) "\"" key "\":,"
+#define SENSOR_JSON_SKIP(name, ctype)
+#define SENSOR_JSON_ONE(name, ctype, key, fmt, expr) +1
+
+// Worst-case lengths, derived from the schema so a new field can't
+// silently overrun: the literal skeleton plus JSON_NUMBER_MAX_LEN per
+// numeric value, and the integer timestamp tail.
+static const size_t SENSOR_JSON_BODY_MAX =
+    sizeof("{\"type\":\"sensor_data\","
+           SENSOR_FRAME_SCHEMA(SENSOR_JSON_LITERAL, SENSOR_JSON_SKIP)
+           "\"motion\":false,") - 1 +
+    (0 SENSOR_FRAME_SCHEMA(SENSOR_JSON_ONE, SENSOR_JSON_SKIP)) *
+        JSON_NUMBER_MAX_LEN;
+static const size_t SENSOR_JSON_TAIL_MAX =
+    sizeof("\"timestamp\":}") - 1 + 10 + 1; // value digits + NUL
+
+// Body and timestamp tail are built separately so the cache below can
+// reuse the body — every field but the timestamp — across ticks. The
+// caller guarantees SENSOR_JSON_BODY_MAX bytes.
+static size_t buildSensorJsonBody(const SensorFrame& frame, char* out) {
+    char* p = out;
+    memcpy(p, "{\"type\":\"sensor_data\",",
+           sizeof("{\"type\":\"sensor_data\",") - 1);
+    p += sizeof("{\"type\":\"sensor_data\",") - 1;
+    SENSOR_FRAME_SCHEMA(SENSOR_JSON_EMIT, SENSOR_JSON_SKIP)
+    if (frame.flags & SENSOR_FLAG_MOTION) {
+        memcpy(p, "\"motion\":true,", sizeof("\"motion\":true,") - 1);
+        p += sizeof("\"motion\":true,") - 1;
+    } else {
+        memcpy(p, "\"motion\":false,", sizeof("\"motion\":false,") - 1);
+        p += sizeof("\"motion\":false,") - 1;
+    }
+    return (size_t)(p - out);
+}
+
+static size_t appendSensorJsonTail(uint32_t timestampMs, char* out) {
+    char* p = out;
+    memcpy(p, "\"timestamp\":", sizeof("\"timestamp\":") - 1);
+    p += sizeof("\"timestamp\":") - 1;
+    p = jsonAppendNumber(p, (unsigned)timestampMs);
+    *p++ = '}';
+    *p = '\0'; // terminated like the snprintf it replaces, NUL unsent
+    return (size_t)(p - out);
+}
+
+size_t BLEServiceManager::createSensorJSON(const SensorFrame& frame,
+                                           char* out, size_t cap) {
+    if (cap < SENSOR_JSON_BODY_MAX + SENSOR_JSON_TAIL_MAX) {
+        return 0;
+    }
+    size_t len = buildSensorJsonBody(frame, out);
+    return len + appendSensorJsonTail(frame.timestampMs, out + len);
+}
+
+// Content-keyed cache over the body serializer. An unchanged tick —
+// the common overnight case — reduces to a memcmp of the frame (the
+// timestamp is excluded; it is the trailing field), a memcpy of the
+// cached body, and one integer format for the live timestamp. The key
+// covers sensor and actuator fields alike, so a state-store write
+// invalidates it the same way a temperature move does.
+size_t BLEServiceManager::buildSensorJsonCached(const SensorFrame& frame,
+                                                char* out, size_t cap) {
+    if (!jsonCacheValid ||
+        memcmp(&frame, &jsonCacheKey,
+               offsetof(SensorFrame, timestampMs)) != 0) {
+        static_assert(SENSOR_JSON_BODY_MAX <= sizeof(jsonCacheBody),
+                      "jsonCacheBody must hold a worst-case body");
+        jsonCacheBodyLen = (uint16_t)buildSensorJsonBody(frame, jsonCacheBody);
+        jsonCacheKey = frame;
+        jsonCacheValid = true;
+    }
+    if (jsonCacheBodyLen + SENSOR_JSON_TAIL_MAX > cap) {
+        return 0;
+    }
+    memcpy(out, jsonCacheBody, jsonCacheBodyLen);
+    size_t tail = appendSensorJsonTail(frame.timestampMs,
+                                       out + jsonCacheBodyLen);
+    return (size_t)jsonCacheBodyLen + tail;
+}
+
+// Indexed by opcode; slot 0 is unused. Minimum payload sizes live
+// with the validation in CommandParser::MIN_PAYLOAD — keep the two
+// tables in step when adding a command.
+const BLEServiceManager::CommandEntry
+BLEServiceManager::COMMAND_TABLE[CMD_OPCODE_MAX + 1] = {
+    { nullptr, 0 },                           // 0x00 (invalid)
+    { &BLEServiceManager::cmdSetFan, 1 },     // CMD_SET_FAN
+    { &BLEServiceManager::cmdSetLed, 1 },     // CMD_SET_LED
+    { &BLEServiceManager::cmdSetAuto, 1 },    // CMD_SET_AUTO
+    { &BLEServiceManager::cmdGetStatus, 0 },  // CMD_GET_STATUS
+    { &BLEServiceManager::cmdSetLedFade, 1 }, // CMD_SET_LED_FADE
+    { &BLEServiceManager::cmdGetBleStats, 0 },// CMD_GET_BLE_STATS
+    { &BLEServiceManager::cmdBenchmark, 0 },  // CMD_BENCHMARK
+    { &BLEServiceManager::cmdGetHistory, 0 }, // CMD_GET_HISTORY
+    { &BLEServiceManager::cmdGetFlashHealth, 0 }, // CMD_GET_FLASH_HEALTH
+    { &BLEServiceManager::cmdSetScene, 1 },   // CMD_SET_SCENE
+    { &BLEServiceManager::cmdDefineScene, 1 },// CMD_DEFINE_SCENE
+    { &BLEServiceManager::cmdModelBegin, 0 }, // CMD_MODEL_BEGIN
+    { &BLEServiceManager::cmdModelData, 0 },  // CMD_MODEL_DATA
+    { &BLEServiceManager::cmdModelCommit, 0 },// CMD_MODEL_COMMIT
+    { &BLEServiceManager::cmdGetCaptures, 0 },// CMD_GET_CAPTURES
+    { &BLEServiceManager::cmdGetLatency, 0 }, // CMD_GET_LATENCY
+    { &BLEServiceManager::cmdGetProfile, 0 }, // CMD_GET_PROFILE
+    { &BLEServiceManager::cmdGetHeap, 0 },    // CMD_GET_HEAP
+    { &BLEServiceManager::cmdGetTasks, 0 },   // CMD_GET_TASKS
+    { &BLEServiceManager::cmdGetBoot, 0 },    // CMD_GET_BOOT
+    { &BLEServiceManager::cmdGetFlashOps, 0 },// CMD_GET_FLASH_OPS
+    { &BLEServiceManager::cmdGetLink, 0 },    // CMD_GET_LINK
+    { &BLEServiceManager::cmdGetCoreDump, 0 },// CMD_GET_COREDUMP
+    { &BLEServiceManager::cmdGetCmdStats, 0 },// CMD_GET_CMDSTATS
+    { &BLEServiceManager::cmdGetTrace, 0 },   // CMD_GET_TRACE
+    { &BLEServiceManager::cmdSetSetpoint, 1 },// CMD_SET_SETPOINT
+    { &BLEServiceManager::cmdSoak, 0 },       // CMD_SOAK
+    { &BLEServiceManager::cmdSetConnProfile, 0 }, // CMD_SET_CONN_PROFILE
+    { &BLEServiceManager::cmdHello, 0 },      // CMD_HELLO
+    { &BLEServiceManager::cmdAuthStart, 0 },  // CMD_AUTH_START
+    { &BLEServiceManager::cmdAuth, 0 },       // CMD_AUTH
+    { &BLEServiceManager::cmdOtaBegin, 0 },   // CMD_OTA_BEGIN
+    { &BLEServiceManager::cmdOtaCommit, 0 },  // CMD_OTA_COMMIT
+    { &BLEServiceManager::cmdGetRollup, 0 },  // CMD_GET_ROLLUP
+    { &BLEServiceManager::cmdGetChart, 0 },   // CMD_GET_CHART
+    { &BLEServiceManager::cmdQueryHistory, 0 }, // CMD_QUERY_HISTORY
+    { &BLEServiceManager::cmdPeerCommand, 0 },  // CMD_PEER_COMMAND
+    { &BLEServiceManager::cmdBatch, 0 },        // CMD_BATCH
+    { &BLEServiceManager::cmdSubscribe, 0 },    // CMD_SUBSCRIBE
+    { &BLEServiceManager::cmdGetSelfTest, 0 },  // CMD_GET_SELFTEST
+    { &BLEServiceManager::cmdGetWellness, 0 },  // CMD_GET_WELLNESS
+    { &BLEServiceManager::cmdTagged, 0 },       // CMD_TAGGED
+    { &BLEServiceManager::cmdStream, 0 },       // CMD_STREAM
+};
+
+void BLEServiceManager::handleBinaryCommand(const uint8_t* data, size_t length,
+                                            uint16_t connHandle) {
+    PROFILE_SCOPE(PROF_BLE_COMMAND);
+
+    // Command arrival snaps DFS to full clock for parse + handler;
+    // scoped so every early return below releases.
+    PowerGovernor::FullClock fullClock(PowerGovernor::LOCK_CMD);
+
+    // All validation (magic, opcode bounds, minimum payload) lives in
+    // the portable parser so the fuzz harness exercises the exact code
+    // that gates dispatch here.
+    CommandParser::CommandFrame frame;
+    CommandParser::ParseStatus status =
+        CommandParser::parseBinary(data, length, frame);
+    if (status != CommandParser::PARSE_OK) {
+        DEBUG_PRINTF("Command rejected (status %u, %u bytes)\n",
+                     (unsigned)status, (unsigned)length);
+        return;
+    }
+
+    const CommandEntry& entry = COMMAND_TABLE[frame.opcode];
+    uint8_t opcode = frame.opcode;
+    cmdConnHandle = connHandle;
+
+    // Session gate: with a PIN provisioned, a mutating opcode must
+    // carry a valid MAC trailer for this connection's session. The
+    // check is SessionAuth::verifyCommand — two HMAC blocks — and the
+    // trailer is stripped before the handler sees the payload, so
+    // every handler below is oblivious to authentication.
+    if (authRequired() && CommandParser::requiresAuth(opcode)) {
+        ClientState* client = findClient(connHandle);
+        size_t needed =
+            (size_t)CommandParser::minPayload(opcode) + SessionAuth::TAIL_LEN;
+        if (client == nullptr || !client->auth.authenticated() ||
+            frame.length < needed ||
+            !client->auth.verifyCommand(opcode, frame.payload, frame.length)) {
+            DEBUG_PRINTF("Command 0x%02x rejected: not authenticated\n",
+                         opcode);
+            return;
+        }
+        frame.length -= SessionAuth::TAIL_LEN;
+    }
+
+    // Activity-based connection profile: the command that breaks a
+    // quiet stretch promotes the links to the interactive interval.
+    noteCommandActivity();
+
+    // Arrival stamp for command-to-actuation latency. Deferred
+    // commands carry it through the command queue (the actuator
+    // callbacks copy it into the Command) and record on the command
+    // task; inline commands record right here.
+    cmdArrivalUs = esp_timer_get_time();
+    cmdOpcode = opcode;
+    TEST_RIG_PULSE(TEST_RIG_PIN_COMMAND);
+    TRACE_EVENT(TRACE_CMD_RECEIVED, opcode, 0);
+
+    entry.handler(this, frame.payload, frame.length);
+
+    if (!entry.deferred) {
+        CmdLatency::record(opcode,
+                           (uint32_t)(esp_timer_get_time() - cmdArrivalUs), 0);
+    }
+    cmdArrivalUs = 0;
+}
+
+void BLEServiceManager::cmdSetFan(BLEServiceManager* mgr,
+                                  const uint8_t* payload, size_t length) {
+    if (mgr->fanSpeedCallback) {
+        mgr->fanSpeedCallback(payload[0]);
+    }
+}
+
+void BLEServiceManager::cmdSetLed(BLEServiceManager* mgr,
+                                  const uint8_t* payload, size_t length) {
+    if (mgr->ledBrightnessCallback) {
+        mgr->ledBrightnessCallback(payload[0]);
+    }
+}
+
+void BLEServiceManager::cmdSetAuto(BLEServiceManager* mgr,
+                                   const uint8_t* payload, size_t length) {
+    if (mgr->autoModeCallback) {
+        mgr->autoModeCallback(payload[0] != 0);
+    }
+}
+
+void BLEServiceManager::cmdSetSetpoint(BLEServiceManager* mgr,
+                                       const uint8_t* payload, size_t length) {
+    if (mgr->setpointCallback) {
+        int16_t centi = (int16_t)((uint16_t)payload[0] |
+                                  ((uint16_t)payload[1] << 8));
+        mgr->setpointCallback(centi);
+    }
+}
+
+void BLEServiceManager::cmdSetScene(BLEServiceManager* mgr,
+                                    const uint8_t* payload, size_t length) {
+    if (mgr->sceneApplyCallback) {
+        mgr->sceneApplyCallback(payload[0]);
+    }
+}
+
+void BLEServiceManager::cmdDefineScene(BLEServiceManager* mgr,
+                                       const uint8_t* payload, size_t length) {
+    ScenePreset preset;
+    memset(&preset, 0, sizeof(preset));
+    preset.inUse = 1;
+    preset.fanSpeed = payload[1];
+    preset.ledBrightness = payload[2];
+    preset.autoMode = (payload[3] != 0) ? 1 : 0;
+
+    size_t nameLen = length - 4;
+    if (nameLen > sizeof(preset.name)) {
+        nameLen = sizeof(preset.name);
+    }
+    memcpy(preset.name, payload + 4, nameLen);
+
+    if (mgr->sceneDefineCallback) {
+        mgr->sceneDefineCallback(payload[0], preset);
+    }
+}
+
+// Batched writes: [len][opcode][payload] entries dispatched in order
+// from one RX write, so an app-side settings sync pays one connection
+// interval instead of one per command. Each entry passes the same
+// parseInner validation a standalone write does; the session MAC was
+// verified (and stripped) on the batch as a whole before this runs,
+// so sub-commands carry no individual trailers. Dispatch is
+// fail-stop: the length prefixes are the framing, so the first
+// malformed entry makes everything behind it unparseable — stop and
+// report rather than guess at resynchronization.
+void BLEServiceManager::cmdBatch(BLEServiceManager* mgr,
+                                 const uint8_t* payload, size_t length) {
+    uint8_t executed = 0;
+    uint8_t failedIndex = 0xFF;
+    size_t at = 0;
+    uint8_t index = 0;
+
+    while (at < length) {
+        uint8_t subLen = payload[at++];
+        CommandParser::CommandFrame sub;
+        if (subLen == 0 || at + subLen > length ||
+            CommandParser::parseInner(payload + at, subLen, sub) !=
+                CommandParser::PARSE_OK ||
+            sub.opcode == CMD_BATCH) { // no nesting
+            failedIndex = index;
+            break;
+        }
+        TRACE_EVENT(TRACE_CMD_RECEIVED, sub.opcode, 0);
+        COMMAND_TABLE[sub.opcode].handler(mgr, sub.payload, sub.length);
+        executed++;
+        index++;
+        at += subLen;
+    }
+
+    BatchResultFrame frame;
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_BATCH_RESULT;
+    frame.executed = executed;
+    frame.failedIndex = failedIndex;
+    frame.reserved = 0;
+    // Replies bypass coalescing, like every other command ack.
+    mgr->queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+// Tagged write: [tag u16][opcode][payload], dispatched like a
+// standalone command, then acked with the tag echoed. The MAC was
+// verified (and stripped) on the tagged write as a whole, same as a
+// batch. Composite opcodes are rejected — a wrapped batch would
+// double-reply, and tag-in-tag buys nothing.
+void BLEServiceManager::cmdTagged(BLEServiceManager* mgr,
+                                  const uint8_t* payload, size_t length) {
+    int64_t start = esp_timer_get_time();
+    uint16_t tag = (uint16_t)payload[0] | ((uint16_t)payload[1] << 8);
+
+    CommandParser::CommandFrame inner;
+    uint8_t status = 0;
+    uint8_t opcode = 0;
+    if (CommandParser::parseInner(payload + 2, length - 2, inner) !=
+            CommandParser::PARSE_OK ||
+        inner.opcode == CMD_TAGGED || inner.opcode == CMD_BATCH) {
+        status = 1;
+    } else {
+        opcode = inner.opcode;
+        TRACE_EVENT(TRACE_CMD_RECEIVED, inner.opcode, 0);
+        COMMAND_TABLE[inner.opcode].handler(mgr, inner.payload, inner.length);
+    }
+
+    CmdAckFrame frame;
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_CMD_ACK;
+    frame.status = status;
+    frame.tag = tag;
+    frame.opcode = opcode;
+    frame.reserved = 0;
+    frame.processingUs = (uint32_t)(esp_timer_get_time() - start);
+    // Replies bypass coalescing, like every other command ack.
+    mgr->queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+// Sequenced lossy stream: [seq u8][opcode][payload], arriving as
+// write-without-response while a slider is being dragged. Newest
+// wins — NimBLE delivers writes in order on one connection, so a
+// lower-or-equal seq is a packet the controller queued behind a
+// fresher one and the finger has already moved past; applying it
+// would make the LED step backwards. Only the idempotent level
+// setters are allowed: dropping an intermediate brightness is
+// invisible, dropping an intermediate scene or OTA chunk is not.
+// Deliberately no reply — the per-update cost is the one packet —
+// and the app commits the final value on release with the plain
+// acknowledged opcode, which also serves as the delivery guarantee.
+void BLEServiceManager::cmdStream(BLEServiceManager* mgr,
+                                  const uint8_t* payload, size_t length) {
+    ClientState* client = mgr->findClient(mgr->cmdConnHandle);
+    if (client == nullptr) {
+        return;
+    }
+    uint8_t seq = payload[0];
+    if (client->streamSeen && (int8_t)(seq - client->streamSeq) <= 0) {
+        return; // stale or duplicate: a newer drag update already landed
+    }
+
+    CommandParser::CommandFrame inner;
+    if (CommandParser::parseInner(payload + 1, length - 1, inner) !=
+        CommandParser::PARSE_OK) {
+        return;
+    }
+    switch (inner.opcode) {
+        case CMD_SET_FAN:
+        case CMD_SET_LED:
+        case CMD_SET_SETPOINT:
+            break;
+        default:
+            return;
+    }
+
+    // Accepting advances the window; rejected bytes never do.
+    client->streamSeq = seq;
+    client->streamSeen = true;
+    TRACE_EVENT(TRACE_CMD_RECEIVED, inner.opcode, 0);
+    COMMAND_TABLE[inner.opcode].handler(mgr, inner.payload, inner.length);
+}
+
+void BLEServiceManager::cmdGetStatus(BLEServiceManager* mgr,
+                                     const uint8_t* payload, size_t length) {
+    if (mgr->statusFrame.magic != FRAME_MAGIC) {
+        return; // nothing sampled yet; the first periodic push covers it
+    }
+    // Pull actuator writes that landed since the last poll or push.
+    // takeDirty is O(changed fields): clean mask, no work. snapshot()
+    // is a coherent read, so a poll racing a scene apply never mixes
+    // the old fan with the new LED.
+    if (mgr->stateStore != nullptr) {
+        uint8_t dirty = mgr->stateStore->takeDirty(StateStore::CONSUMER_STATUS);
+        if (dirty & (StateStore::bit(StateStore::FIELD_FAN_SPEED) |
+                     StateStore::bit(StateStore::FIELD_LED_BRIGHTNESS))) {
+            int32_t snap[StateStore::FIELD_COUNT];
+            mgr->stateStore->snapshot(snap);
+            mgr->statusFrame.fanSpeed =
+                (uint8_t)snap[StateStore::FIELD_FAN_SPEED];
+            mgr->statusFrame.ledBrightness =
+                (uint8_t)snap[StateStore::FIELD_LED_BRIGHTNESS];
+            mgr->statusSnapshotDirty = true;
+        }
+    }
+    if (mgr->statusSnapshotDirty) {
+        mgr->rebuildStatusSnapshot();
+    }
+    // Replies bypass coalescing so they can't be superseded by a frame.
+    mgr->queueNotification(mgr->statusSnapshot, mgr->statusSnapshotLen, false);
+}
+
+void BLEServiceManager::rebuildStatusSnapshot() {
+    if (jsonCompatMode) {
+        statusSnapshotLen = (uint16_t)createSensorJSON(
+            statusFrame, (char*)statusSnapshot, sizeof(statusSnapshot));
+    } else {
+        memcpy(statusSnapshot, &statusFrame, sizeof(statusFrame));
+        statusSnapshotLen = sizeof(statusFrame);
+    }
+    statusSnapshotDirty = false;
+}
+
+void BLEServiceManager::attachStateStore(StateStore* store) {
+    stateStore = store;
+}
+
+void BLEServiceManager::setSettingsSource(SettingsStore* store) {
+    settingsSource = store;
+}
+
+void BLEServiceManager::fillSettingsCharacteristic(
+        NimBLECharacteristic* characteristic) {
+    if (settingsSource == nullptr) {
+        characteristic->setValue((const uint8_t*)"", 0);
+        return;
+    }
+    // Served copy, never the live struct: the PIN is write-only from
+    // the app's point of view and must not leave the device on an
+    // open read characteristic.
+    PersistedSettings blob = settingsSource->data();
+    blob.devicePin = 0;
+    characteristic->setValue((const uint8_t*)&blob, sizeof(blob));
+}
+
+void BLEServiceManager::cmdHello(BLEServiceManager* mgr,
+                                 const uint8_t* payload, size_t length) {
+    uint32_t appCaps = (uint32_t)payload[1] |
+                       ((uint32_t)payload[2] << 8) |
+                       ((uint32_t)payload[3] << 16) |
+                       ((uint32_t)payload[4] << 24);
+    mgr->negotiatedCaps = appCaps & PROTO_CAPS_SUPPORTED;
+
+    // The frame format follows the negotiation: a JSON-only app keeps
+    // the compatibility path, a binary one leaves it. Both the
+    // preserialized status snapshot and the delta state resync so the
+    // first frame after the handshake is a full one in the new format.
+    mgr->jsonCompatMode =
+        (mgr->negotiatedCaps & PROTO_CAP_BINARY_FRAMES) == 0;
+    mgr->statusSnapshotDirty = true;
+    mgr->haveLastSent = false;
+
+    HelloFrame frame;
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_HELLO;
+    frame.reserved = 0;
+    frame.caps = mgr->negotiatedCaps;
+    mgr->queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+
+    DEBUG_PRINTF("Hello: app proto v%u, caps 0x%02x -> 0x%02x\n",
+                 payload[0], (unsigned)appCaps,
+                 (unsigned)mgr->negotiatedCaps);
+}
+
+// ============================================================================
+// SESSION AUTHENTICATION
+// ============================================================================
+void BLEServiceManager::setAuthCredentials(uint32_t pin, uint32_t deviceId) {
+    devicePin = pin;
+    authDeviceId = deviceId;
+    haveStretchedKey = false; // re-derive lazily if the PIN changed
+}
+
+// The KDF is the slow part by design (AUTH_KDF_ITERATIONS); deriving
+// lazily on the first handshake and caching means the boot path never
+// pays it and later connections get it for free.
+const uint8_t* BLEServiceManager::stretchedPinKey() {
+    if (!haveStretchedKey) {
+        int64_t startUs = esp_timer_get_time();
+        SessionAuth::stretchPin(devicePin, authDeviceId, stretchedKey);
+        haveStretchedKey = true;
+        DEBUG_PRINTF("Auth: PIN key derived in %lld us\n",
+                     esp_timer_get_time() - startUs);
+    }
+    return stretchedKey;
+}
+
+void BLEServiceManager::sendAuthFrame(uint8_t status, const uint8_t* nonce) {
+    AuthFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_AUTH;
+    frame.status = status;
+    if (nonce != nullptr) {
+        memcpy(frame.nonce, nonce, SessionAuth::NONCE_LEN);
+    }
+    queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+void BLEServiceManager::cmdAuthStart(BLEServiceManager* mgr,
+                                     const uint8_t* payload, size_t length) {
+    ClientState* client = mgr->findClient(mgr->cmdConnHandle);
+    if (client == nullptr) {
+        return;
+    }
+    if (!mgr->authRequired()) {
+        // No PIN provisioned: tell the app it is already in.
+        mgr->sendAuthFrame(AUTH_STATUS_OK, nullptr);
+        return;
+    }
+    client->auth.issueChallenge(esp_random(), esp_random());
+    mgr->sendAuthFrame(AUTH_STATUS_CHALLENGE, client->auth.nonce());
+}
+
+void BLEServiceManager::cmdAuth(BLEServiceManager* mgr,
+                                const uint8_t* payload, size_t length) {
+    ClientState* client = mgr->findClient(mgr->cmdConnHandle);
+    if (client == nullptr) {
+        return;
+    }
+    if (!mgr->authRequired()) {
+        mgr->sendAuthFrame(AUTH_STATUS_OK, nullptr);
+        return;
+    }
+    bool ok = client->auth.completeAuth(mgr->stretchedPinKey(),
+                                        payload, length);
+    mgr->sendAuthFrame(ok ? AUTH_STATUS_OK : AUTH_STATUS_FAIL, nullptr);
+    DEBUG_PRINTF("Auth: conn %u %s\n", mgr->cmdConnHandle,
+                 ok ? "session established" : "challenge failed");
+}
+
+void BLEServiceManager::cmdSetLedFade(BLEServiceManager* mgr,
+                                      const uint8_t* payload, size_t length) {
+    if (mgr->ledFadeCallback) {
+        uint16_t durationMs = (uint16_t)payload[1] | ((uint16_t)payload[2] << 8);
+        mgr->ledFadeCallback(payload[0], durationMs);
+    }
+}
+
+static inline uint16_t clampMs16(uint32_t ms) {
+    return ms > 0xFFFF ? 0xFFFF : (uint16_t)ms;
+}
+
+void BLEServiceManager::cmdGetBleStats(BLEServiceManager* mgr,
+                                       const uint8_t* payload, size_t length) {
+    NotifyStatsFrame frame;
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_NOTIFY_STATS;
+    frame.reserved = 0;
+    frame.sent = mgr->notifyStats.sent;
+    frame.retries = mgr->notifyStats.retries;
+    frame.drops = mgr->notifyStats.drops;
+    frame.coalesced = mgr->notifyStats.coalesced;
+    frame.bulkAborts = mgr->notifyStats.bulkAborts;
+    frame.alertLastMs = clampMs16(mgr->tierStats[TIER_ALERT].lastMs);
+    frame.alertMaxMs = clampMs16(mgr->tierStats[TIER_ALERT].maxMs);
+    frame.controlMaxMs = clampMs16(mgr->tierStats[TIER_CONTROL].maxMs);
+    frame.telemetryMaxMs = clampMs16(mgr->tierStats[TIER_TELEMETRY].maxMs);
+
+    // Replies bypass coalescing so they can't be superseded by a frame.
+    mgr->queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+void BLEServiceManager::cmdBenchmark(BLEServiceManager* mgr,
+                                     const uint8_t* payload, size_t length) {
+    uint8_t seconds = (length >= 1) ? payload[0] : 0;
+    mgr->startBenchmark(seconds);
+}
+
+// ============================================================================
+// THROUGHPUT BENCHMARK
+// ============================================================================
+void BLEServiceManager::startBenchmark(uint8_t seconds) {
+    if (benchRunning || !deviceConnected) {
+        return;
+    }
+    if (seconds == 0) {
+        seconds = BLE_BENCH_DEFAULT_SECONDS;
+    }
+    if (seconds > BLE_BENCH_MAX_SECONDS) {
+        seconds = BLE_BENCH_MAX_SECONDS;
+    }
+
+    benchSeconds = seconds;
+    benchRunning = true;
+
+    // One-shot task so the RX callback returns immediately; the run
+    // itself saturates the notify path for benchSeconds.
+    TaskHandle_t handle;
+    if (xTaskCreatePinnedToCore(benchTaskThunk, "ble_bench",
+                                BLE_BENCH_TASK_STACK, this,
+                                BLE_TASK_PRIORITY, &handle,
+                                BLE_TASK_CORE) != pdPASS) {
+        benchRunning = false;
+    }
+}
+
+void BLEServiceManager::benchTaskThunk(void* arg) {
+    static_cast<BLEServiceManager*>(arg)->benchTaskLoop();
+    vTaskDelete(NULL);
+}
+
+void BLEServiceManager::benchTaskLoop() {
+    // Target the first subscribed client so the numbers reflect one
+    // link, not fan-out overhead.
+    uint16_t connHandle = 0xFFFF;
+    for (uint8_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (clients.active(i) && clients.at(i)->subscribed) {
+            connHandle = clients.at(i)->connHandle;
+            break;
+        }
+    }
+
+    if (connHandle == 0xFFFF) {
+        DEBUG_PRINTLN("Benchmark: no subscribed client");
+        benchRunning = false;
+        return;
+    }
+
+    uint16_t payloadLen = maxPayloadSize();
+    if (payloadLen > BLE_PREFERRED_MTU - 3) {
+        payloadLen = BLE_PREFERRED_MTU - 3;
+    }
+    if (payloadLen < sizeof(BenchDataHeader)) {
+        payloadLen = sizeof(BenchDataHeader);
+    }
+
+    uint8_t buf[BLE_PREFERRED_MTU];
+    memset(buf, 0x55, payloadLen); // recognizable filler
+    BenchDataHeader* header = (BenchDataHeader*)buf;
+    header->magic = FRAME_MAGIC;
+    header->version = SENSOR_FRAME_VERSION;
+    header->type = FRAME_TYPE_BENCH_DATA;
+    header->reserved = 0;
+
+    DEBUG_PRINTF("Benchmark: %u s, %u-byte frames\n", benchSeconds, payloadLen);
+
+    uint32_t framesSent = 0;
+    uint32_t congestion = 0;
+    uint64_t notifyTimeUs = 0;
+    uint32_t sequence = 0;
+
+    int64_t startUs = esp_timer_get_time();
+    int64_t deadlineUs = startUs + (int64_t)benchSeconds * 1000000;
+
+    while (esp_timer_get_time() < deadlineUs) {
+        header->sequence = sequence;
+
+        os_mbuf* om = ble_hs_mbuf_from_flat(buf, payloadLen);
+        if (om == NULL) {
+            congestion++;
+            vTaskDelay(pdMS_TO_TICKS(BLE_BENCH_BACKOFF_MS));
+            continue;
+        }
+
+        int64_t t0 = esp_timer_get_time();
+        int rc = ble_gatts_notify_custom(connHandle,
+                                         pTxCharacteristic->getHandle(), om);
+        notifyTimeUs += (uint64_t)(esp_timer_get_time() - t0);
+
+        if (rc == 0) {
+            framesSent++;
+            sequence++;
+        } else {
+            // Usually ENOMEM: the controller buffers are full. Back
+            // off one tick and keep the same sequence number.
+            congestion++;
+            vTaskDelay(pdMS_TO_TICKS(BLE_BENCH_BACKOFF_MS));
+        }
+    }
+
+    uint32_t elapsedMs = (uint32_t)((esp_timer_get_time() - startUs) / 1000);
+    uint32_t attempts = framesSent + congestion;
+
+    BenchReportFrame report;
+    report.magic = FRAME_MAGIC;
+    report.version = SENSOR_FRAME_VERSION;
+    report.type = FRAME_TYPE_BENCH_REPORT;
+    report.reserved = 0;
+    report.framesSent = framesSent;
+    report.bytesPerSec = (elapsedMs > 0)
+        ? (uint32_t)(((uint64_t)framesSent * payloadLen * 1000) / elapsedMs)
+        : 0;
+    report.congestion = congestion;
+    report.meanNotifyUs = (attempts > 0)
+        ? (uint32_t)(notifyTimeUs / attempts) : 0;
+
+    DEBUG_PRINTF("Benchmark: %u frames, %u B/s, %u congestion, %u us mean\n",
+                 report.framesSent, report.bytesPerSec, report.congestion,
+                 report.meanNotifyUs);
+
+    // The report rides the normal send queue, uncoalesced, so it is
+    // delivered even if a sensor frame is pending.
+    queueNotification((const uint8_t*)&report, sizeof(report), false);
+    benchRunning = false;
+}
+
+// ============================================================================
+// SOAK MODE
+// ============================================================================
+// One esp_timer for the single manager instance, like the HeapGuard
+// report timer. The timer callback runs on the esp_timer task, which
+// queueNotification already tolerates (it only takes the pending
+// lock).
+static esp_timer_handle_t soakTimer = nullptr;
+
+void BLEServiceManager::cmdSoak(BLEServiceManager* mgr,
+                                const uint8_t* payload, size_t length) {
+    uint16_t intervalS = (uint16_t)payload[0] | ((uint16_t)payload[1] << 8);
+
+    if (soakTimer == nullptr) {
+        esp_timer_create_args_t args = {};
+        args.callback = &BLEServiceManager::soakTimerThunk;
+        args.arg = mgr;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "soak";
+        esp_timer_create(&args, &soakTimer);
+    }
+    esp_timer_stop(soakTimer); // no-op when not armed
+
+    if (intervalS == 0) {
+        DEBUG_PRINTLN("Soak mode stopped");
+        return;
+    }
+
+    esp_timer_start_periodic(soakTimer, (uint64_t)intervalS * 1000000ULL);
+    DEBUG_PRINTF("Soak mode: metrics every %u s\n", intervalS);
+    // First point immediately, so the harness gets its baseline at
+    // t=0 instead of one interval into the run.
+    mgr->emitSoakFrame();
+}
+
+void BLEServiceManager::soakTimerThunk(void* arg) {
+    static_cast<BLEServiceManager*>(arg)->emitSoakFrame();
+}
+
+void BLEServiceManager::emitSoakFrame() {
+    uint8_t buf[sizeof(SoakMetricsFrameHeader) +
+                SOAK_TASK_ENTRIES * sizeof(TaskStatsEntry)];
+    SoakMetricsFrameHeader* frame = (SoakMetricsFrameHeader*)buf;
+    memset(frame, 0, sizeof(*frame));
+    frame->magic = FRAME_MAGIC;
+    frame->version = SENSOR_FRAME_VERSION;
+    frame->type = FRAME_TYPE_SOAK_METRICS;
+    frame->uptimeS = (uint32_t)(esp_timer_get_time() / 1000000ULL);
+    frame->heapFreeBytes = esp_get_free_heap_size();
+    frame->heapMinFreeBytes = esp_get_minimum_free_heap_size();
+    frame->notifyDrops = notifyStats.drops;
+    frame->notifyRetries = notifyStats.retries;
+    frame->flashWorstUs = FlashOpStats::worstUs();
+    frame->nvsCommits = FlashOpStats::op(FLASH_NVS_COMMIT).count();
+
+    // Queue depths and shed counters live in main.cpp.
+    if (soakSampleCallback) {
+        soakSampleCallback(*frame);
+    }
+
+    // Per-task CPU over the window since the previous frame. Shares
+    // the diff snapshot with CMD_GET_TASKS — don't interleave the two
+    // during a soak run or both windows lie.
+    TaskStatsEntry* entries =
+        (TaskStatsEntry*)(buf + sizeof(SoakMetricsFrameHeader));
+    frame->taskCount = TaskStats::fill(entries, SOAK_TASK_ENTRIES);
+
+    queueNotification(buf,
+                      sizeof(SoakMetricsFrameHeader) +
+                          frame->taskCount * sizeof(TaskStatsEntry),
+                      false);
+}
+
+void BLEServiceManager::onSoakSample(
+        void (*callback)(SoakMetricsFrameHeader&)) {
+    soakSampleCallback = callback;
+}
+
+void BLEServiceManager::cmdGetFlashHealth(BLEServiceManager* mgr,
+                                          const uint8_t* payload, size_t length) {
+    if (mgr->flashHealthCallback == nullptr) {
+        return;
+    }
+
+    FlashHealthFrame frame;
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_FLASH_HEALTH;
+    frame.reserved = 0;
+    frame.nvsCommits = 0;
+    frame.historyErases = 0;
+    frame.historySectors = 0;
+    frame.reserved2 = 0;
+    mgr->flashHealthCallback(frame);
+
+    mgr->queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+void BLEServiceManager::onFlashHealthRequest(void (*callback)(FlashHealthFrame&)) {
+    flashHealthCallback = callback;
+}
+
+void BLEServiceManager::cmdGetLatency(BLEServiceManager* mgr,
+                                      const uint8_t* payload, size_t length) {
+    if (mgr->latencyCallback == nullptr) {
+        return;
+    }
+    bool reset = (length >= 1) && (payload[0] & 0x01);
+
+    LatencyStatsFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_LATENCY_STATS;
+    mgr->latencyCallback(frame, reset);
+
+    mgr->queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+void BLEServiceManager::onLatencyRequest(void (*callback)(LatencyStatsFrame&,
+                                                          bool)) {
+    latencyCallback = callback;
+}
+
+// The profiler registry is static, so unlike the latency paths (whose
+// histograms live with their owners) no callback into main is needed.
+void BLEServiceManager::cmdGetProfile(BLEServiceManager* mgr,
+                                      const uint8_t* payload, size_t length) {
+    bool reset = (length >= 1) && (payload[0] & 0x01);
+
+    uint8_t buf[sizeof(ProfileFrameHeader) +
+                PROF_SECTION_COUNT * sizeof(ProfileEntry)];
+    ProfileFrameHeader* header = (ProfileFrameHeader*)buf;
+    header->magic = FRAME_MAGIC;
+    header->version = SENSOR_FRAME_VERSION;
+    header->type = FRAME_TYPE_PROFILE;
+    header->sectionCount = PROF_SECTION_COUNT;
+
+    ProfileEntry* entries = (ProfileEntry*)(buf + sizeof(ProfileFrameHeader));
+    for (uint8_t i = 0; i < PROF_SECTION_COUNT; i++) {
+        LatencyHistogram& hist = Profiler::section(i);
+        entries[i].id = i;
+        memset(entries[i].reserved, 0, sizeof(entries[i].reserved));
+        entries[i].stats.count = hist.count();
+        entries[i].stats.minUs = hist.minUs();
+        entries[i].stats.avgUs = hist.avgUs();
+        entries[i].stats.maxUs = hist.maxUs();
+        entries[i].stats.p99Us = hist.p99Us();
+        if (reset) {
+            hist.reset();
+        }
+    }
+
+    // Replies bypass coalescing.
+    mgr->queueNotification(buf, sizeof(buf), false);
+}
+
+void BLEServiceManager::cmdGetHeap(BLEServiceManager* mgr,
+                                   const uint8_t* payload, size_t length) {
+    if (mgr->heapStatsCallback == nullptr) {
+        return;
+    }
+    HeapStatsFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_HEAP_STATS;
+    mgr->heapStatsCallback(frame);
+
+    mgr->queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+void BLEServiceManager::cmdGetSelfTest(BLEServiceManager* mgr,
+                                       const uint8_t* payload, size_t length) {
+    SelfTestFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_SELFTEST;
+    for (uint8_t i = 0; i < SelfTest::CHECK_COUNT; i++) {
+        frame.status[i] = SelfTest::status(i);
+    }
+    frame.cycles = SelfTest::cycles();
+    frame.failEvents = SelfTest::failEvents();
+    frame.lastCycleMs = SelfTest::lastCycleMs();
+
+    mgr->queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+void BLEServiceManager::cmdGetWellness(BLEServiceManager* mgr,
+                                       const uint8_t* payload, size_t length) {
+    const WellnessSummary::Summary& last = WellnessSummary::last();
+
+    WellnessFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_WELLNESS;
+    frame.valid = last.valid ? 1 : 0;
+    frame.motionCount = last.motionCount;
+    frame.outOfBedCount = last.outOfBedCount;
+    frame.alertCount = last.alertCount;
+    frame.comfortMinutes = last.comfortMinutes;
+    frame.windowMinutes = last.windowMinutes;
+    frame.tempMin = last.tempMin;
+    frame.tempMax = last.tempMax;
+    frame.sealedAtMs = last.sealedAtMs;
+
+    mgr->queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+void BLEServiceManager::onHeapStatsRequest(void (*callback)(HeapStatsFrame&)) {
+    heapStatsCallback = callback;
+}
+
+// Like the profiler, TaskStats is static — no callback into main.
+// Entries are capped to what one notification carries; the kernel
+// tasks the cap would cut are the idle/IPC ones nobody tunes.
+void BLEServiceManager::cmdGetTasks(BLEServiceManager* mgr,
+                                    const uint8_t* payload, size_t length) {
+    const uint8_t maxFit =
+        (sizeof(((PendingNotify*)0)->data) - sizeof(TaskStatsFrameHeader)) /
+        sizeof(TaskStatsEntry);
+
+    uint8_t buf[sizeof(TaskStatsFrameHeader) +
+                maxFit * sizeof(TaskStatsEntry)];
+    TaskStatsEntry* entries =
+        (TaskStatsEntry*)(buf + sizeof(TaskStatsFrameHeader));
+    uint8_t count = TaskStats::fill(entries, maxFit);
+
+    TaskStatsFrameHeader* header = (TaskStatsFrameHeader*)buf;
+    header->magic = FRAME_MAGIC;
+    header->version = SENSOR_FRAME_VERSION;
+    header->type = FRAME_TYPE_TASK_STATS;
+    header->taskCount = count;
+
+    mgr->queueNotification(buf, sizeof(TaskStatsFrameHeader) +
+                                count * sizeof(TaskStatsEntry), false);
+}
+
+void BLEServiceManager::cmdGetBoot(BLEServiceManager* mgr,
+                                   const uint8_t* payload, size_t length) {
+    if (mgr->bootStatsCallback == nullptr) {
+        return;
+    }
+    BootStatsFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_BOOT_STATS;
+    mgr->bootStatsCallback(frame);
+
+    mgr->queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+void BLEServiceManager::onBootStatsRequest(void (*callback)(BootStatsFrame&)) {
+    bootStatsCallback = callback;
+}
+
+// FlashOpStats is static like the profiler — no callback into main.
+void BLEServiceManager::cmdGetFlashOps(BLEServiceManager* mgr,
+                                       const uint8_t* payload, size_t length) {
+    bool reset = (length >= 1) && (payload[0] & 0x01);
+
+    uint8_t buf[sizeof(FlashOpsFrameHeader) +
+                FLASH_CALLER_COUNT * sizeof(ProfileEntry)];
+    FlashOpsFrameHeader* header = (FlashOpsFrameHeader*)buf;
+    memset(header, 0, sizeof(*header));
+    header->magic = FRAME_MAGIC;
+    header->version = SENSOR_FRAME_VERSION;
+    header->type = FRAME_TYPE_FLASH_OPS;
+    header->opCount = FLASH_CALLER_COUNT;
+    header->worstUs = FlashOpStats::worstUs();
+    header->worstCaller = FlashOpStats::worstCaller();
+    header->worstAgeMs = FlashOpStats::worstAgeMs();
+
+    ProfileEntry* entries = (ProfileEntry*)(buf + sizeof(FlashOpsFrameHeader));
+    for (uint8_t i = 0; i < FLASH_CALLER_COUNT; i++) {
+        LatencyHistogram& hist = FlashOpStats::op(i);
+        entries[i].id = i;
+        memset(entries[i].reserved, 0, sizeof(entries[i].reserved));
+        entries[i].stats.count = hist.count();
+        entries[i].stats.minUs = hist.minUs();
+        entries[i].stats.avgUs = hist.avgUs();
+        entries[i].stats.maxUs = hist.maxUs();
+        entries[i].stats.p99Us = hist.p99Us();
+        if (reset) {
+            hist.reset();
+        }
+    }
+
+    mgr->queueNotification(buf, sizeof(buf), false);
+}
+
+void BLEServiceManager::cmdGetLink(BLEServiceManager* mgr,
+                                   const uint8_t* payload, size_t length) {
+    uint8_t buf[sizeof(LinkQualityFrame) +
+                BLE_MAX_CLIENTS * sizeof(LinkClientEntry)];
+    LinkQualityFrame* frame = (LinkQualityFrame*)buf;
+    memset(frame, 0, sizeof(*frame));
+    frame->magic = FRAME_MAGIC;
+    frame->version = SENSOR_FRAME_VERSION;
+    frame->type = FRAME_TYPE_LINK_QUALITY;
+
+    frame->notify.count = mgr->notifyLatency.count();
+    frame->notify.minUs = mgr->notifyLatency.minUs();
+    frame->notify.avgUs = mgr->notifyLatency.avgUs();
+    frame->notify.maxUs = mgr->notifyLatency.maxUs();
+    frame->notify.p99Us = mgr->notifyLatency.p99Us();
+
+    frame->disconnects = mgr->disconnectCount;
+    frame->lastDisconnectReason = mgr->lastDisconnectReason;
+    frame->lastDisconnectAgeMs =
+        mgr->disconnectCount ? millis() - mgr->lastDisconnectMs : 0;
+
+    // Per-connection radio numbers, queried live so the interval is
+    // what the peer granted, not what we requested.
+    LinkClientEntry* entries =
+        (LinkClientEntry*)(buf + sizeof(LinkQualityFrame));
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (!mgr->clients.active(i)) {
+            continue;
+        }
+        ClientState& client = *mgr->clients.at(i);
+        ble_gap_conn_desc desc;
+        if (ble_gap_conn_find(client.connHandle, &desc) != 0) {
+            continue;
+        }
+        LinkClientEntry& e = entries[count];
+        e.connHandle = client.connHandle;
+        e.connItvlUnits = desc.conn_itvl;
+        e.connLatency = desc.conn_latency;
+        e.mtu = client.mtu;
+        int8_t rssi;
+        e.rssiDbm = (ble_gap_conn_rssi(client.connHandle, &rssi) == 0)
+                        ? rssi : 127;
+        e.subscribed = client.subscribed ? 1 : 0;
+        count++;
+    }
+    frame->clientCount = count;
+
+    mgr->queueNotification(buf, sizeof(LinkQualityFrame) +
+                                count * sizeof(LinkClientEntry), false);
+}
+
+// ============================================================================
+// MODEL TRANSFER
+// ============================================================================
+void BLEServiceManager::setModelUpdater(ModelUpdater* updater) {
+    modelUpdater = updater;
+}
+
+void BLEServiceManager::onModelCommitted(void (*callback)(void)) {
+    modelCommittedCallback = callback;
+}
+
+void BLEServiceManager::sendModelStatus(uint8_t status) {
+    ModelStatusFrame frame;
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_MODEL_STATUS;
+    frame.status = status;
+    frame.generation = 0;
+    frame.received = 0;
+    if (modelUpdater != nullptr) {
+        frame.generation = modelUpdater->activeGeneration();
+        frame.received = modelUpdater->bytesReceived();
+    }
+
+    // Replies bypass coalescing so they can't be superseded by a frame.
+    queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+void BLEServiceManager::cmdModelBegin(BLEServiceManager* mgr,
+                                      const uint8_t* payload, size_t length) {
+    if (mgr->modelUpdater == nullptr) {
+        return;
+    }
+    uint32_t totalSize, crc;
+    memcpy(&totalSize, payload, sizeof(totalSize));
+    memcpy(&crc, payload + 4, sizeof(crc));
+    mgr->sendModelStatus(mgr->modelUpdater->beginTransfer(totalSize, crc));
+}
+
+void BLEServiceManager::cmdModelData(BLEServiceManager* mgr,
+                                     const uint8_t* payload, size_t length) {
+    if (mgr->modelUpdater == nullptr) {
+        return;
+    }
+    uint32_t offset;
+    memcpy(&offset, payload, sizeof(offset));
+    ModelUpdater::Status status = mgr->modelUpdater->writeChunk(
+        offset, payload + 4, (uint16_t)(length - 4));
+    // Chunks only reply on failure — a per-chunk ack would pace the
+    // transfer on the notify queue; commit verifies the whole image.
+    if (status != ModelUpdater::XFER_OK) {
+        mgr->sendModelStatus(status);
+    }
+}
+
+void BLEServiceManager::cmdModelCommit(BLEServiceManager* mgr,
+                                       const uint8_t* payload, size_t length) {
+    if (mgr->modelUpdater == nullptr) {
+        return;
+    }
+    ModelUpdater::Status status = mgr->modelUpdater->commit();
+    if (status == ModelUpdater::XFER_OK &&
+        mgr->modelCommittedCallback != nullptr) {
+        mgr->modelCommittedCallback();
+    }
+    mgr->sendModelStatus(status);
+}
+
+// ============================================================================
+// FIRMWARE TRANSFER (BLE OTA)
+// ============================================================================
+void BLEServiceManager::setFirmwareUpdater(FirmwareUpdater* updater) {
+    firmwareUpdater = updater;
+}
+
+void BLEServiceManager::sendOtaStatus(uint8_t status) {
+    OtaStatusFrame frame;
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_OTA_STATUS;
+    frame.status = status;
+    frame.received = 0;
+    if (firmwareUpdater != nullptr) {
+        frame.received = firmwareUpdater->bytesReceived();
+    }
+
+    // Replies bypass coalescing so they can't be superseded by a frame.
+    queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+void BLEServiceManager::cmdOtaBegin(BLEServiceManager* mgr,
+                                    const uint8_t* payload, size_t length) {
+    if (mgr->firmwareUpdater == nullptr) {
+        return;
+    }
+    uint32_t totalSize, crc;
+    memcpy(&totalSize, payload, sizeof(totalSize));
+    memcpy(&crc, payload + 4, sizeof(crc));
+    mgr->sendOtaStatus(mgr->firmwareUpdater->beginTransfer(totalSize, crc));
+}
+
+// Raw chunk from the OTA characteristic: {offset u32, crc32 u32,
+// bytes}. No auth trailer here — chunks only land inside a transfer
+// opened by an authenticated CMD_OTA_BEGIN, their integrity is the
+// per-chunk CRC, and commit verifies the whole image against the CRC
+// the authenticated BEGIN pinned. Like the model path, chunks only
+// reply on failure so the transfer isn't paced by the notify queue.
+void BLEServiceManager::handleOtaChunk(const uint8_t* data, size_t length) {
+    // Background pacing first (may block this task), THEN full clock
+    // for the CRC + flash write — the pause must not pin the CPU
+    // frequency, and the write should still run fast once allowed.
+    OtaPacer::yieldPoint();
+    PowerGovernor::FullClock fullClock(PowerGovernor::LOCK_OTA);
+    if (firmwareUpdater == nullptr ||
+        length <= OTA_BLE_CHUNK_HEADER_LEN) {
+        return;
+    }
+    uint32_t offset, chunkCrc;
+    memcpy(&offset, data, sizeof(offset));
+    memcpy(&chunkCrc, data + 4, sizeof(chunkCrc));
+    FirmwareUpdater::Status status = firmwareUpdater->writeChunk(
+        offset, chunkCrc, data + OTA_BLE_CHUNK_HEADER_LEN,
+        (uint16_t)(length - OTA_BLE_CHUNK_HEADER_LEN));
+    if (status != FirmwareUpdater::OTA_OK) {
+        sendOtaStatus(status);
+    }
+}
+
+void BLEServiceManager::rebootTask(void* param) {
+    // Enough for the notify task to push the OTA_OK frame before the
+    // link drops; esp_restart runs the registered shutdown handlers
+    // (deferred settings flush).
+    vTaskDelay(pdMS_TO_TICKS(OTA_BLE_REBOOT_DELAY_MS));
+    DEBUG_PRINTLN("OTA: rebooting into new firmware");
+    esp_restart();
+}
+
+void BLEServiceManager::cmdOtaCommit(BLEServiceManager* mgr,
+                                     const uint8_t* payload, size_t length) {
+    if (mgr->firmwareUpdater == nullptr) {
+        return;
+    }
+    FirmwareUpdater::Status status = mgr->firmwareUpdater->commit();
+    mgr->sendOtaStatus(status);
+    if (status == FirmwareUpdater::OTA_OK) {
+        xTaskCreatePinnedToCore(rebootTask, "ota_boot", 2048, nullptr, 1,
+                                NULL, 1);
+    }
+}
+
+// Pushed-down predicates for CMD_QUERY_HISTORY; the plain sync clears
+// it. One instance is enough — only one history stream runs at a time.
+static HistoryFilter historyQueryFilter;
+
+void BLEServiceManager::cmdGetHistory(BLEServiceManager* mgr,
+                                      const uint8_t* payload, size_t length) {
+    uint32_t fromSeq;
+    memcpy(&fromSeq, payload, sizeof(fromSeq));
+    if (mgr->historySyncRunning) {
+        return; // never retouch the filter under a live stream
+    }
+    historyQueryFilter.clear();
+    mgr->startHistorySync(fromSeq);
+}
+
+void BLEServiceManager::cmdQueryHistory(BLEServiceManager* mgr,
+                                        const uint8_t* payload,
+                                        size_t length) {
+    uint32_t fromSeq;
+    memcpy(&fromSeq, payload, sizeof(fromSeq));
+    if (mgr->historySyncRunning) {
+        return; // never retouch the filter under a live stream
+    }
+    // A predicate list that doesn't parse streams nothing — the empty
+    // terminator chunk tells the app its query was rejected, rather
+    // than silently degrading to a full sync.
+    if (!historyQueryFilter.parse(payload + 4, length - 4)) {
+        DEBUG_PRINTLN("History query: bad predicate list");
+    }
+    mgr->startHistorySync(fromSeq);
+}
+
+// ============================================================================
+// HISTORY SYNC
+// ============================================================================
+void BLEServiceManager::setHistorySource(HistoryLog* log) {
+    historyLog = log;
+}
+
+void BLEServiceManager::startHistorySync(uint32_t fromSeq) {
+    // chartSyncRunning too: both streams use FRAME_TYPE_HISTORY_CHUNK.
+    if (historySyncRunning || chartSyncRunning || historyLog == nullptr ||
+        !deviceConnected) {
+        return;
+    }
+
+    historyFromSeq = fromSeq;
+    historySyncRunning = true;
+
+    // Like the benchmark: a one-shot task so the RX callback returns
+    // immediately and the NimBLE host task is never blocked on flash.
+    TaskHandle_t handle;
+    if (xTaskCreatePinnedToCore(historyTaskThunk, "ble_history",
+                                BLE_NOTIFY_TASK_STACK, this,
+                                BLE_TASK_PRIORITY, &handle,
+                                BLE_TASK_CORE) != pdPASS) {
+        historySyncRunning = false;
+    }
+}
+
+void BLEServiceManager::historyTaskThunk(void* arg) {
+    static_cast<BLEServiceManager*>(arg)->historyTaskLoop();
+    vTaskDelete(NULL);
+}
+
+void BLEServiceManager::historyTaskLoop() {
+    uint16_t connHandle = 0xFFFF;
+    for (uint8_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (clients.active(i) && clients.at(i)->subscribed) {
+            connHandle = clients.at(i)->connHandle;
+            break;
+        }
+    }
+
+    if (connHandle == 0xFFFF) {
+        DEBUG_PRINTLN("History sync: no subscribed client");
+        historySyncRunning = false;
+        return;
+    }
+
+    uint16_t chunkCap = chunkPayloadCap();
+
+    uint8_t chunk[BLE_PREFERRED_MTU];
+    ChunkFramer framer;
+    HistoryEncoder encoder;
+    HistoryLog::Cursor cursor = historyLog->cursorFromSeq(historyFromSeq);
+    HistoryRecord record;
+    uint32_t sent = 0;
+    bool pending = false;
+
+    DEBUG_PRINTF("History sync from seq %u\n", historyFromSeq);
+
+    for (;;) {
+        encoder.beginChunk(chunk, chunkCap);
+
+        // A record that did not fit the previous chunk leads this one.
+        if (pending) {
+            encoder.addRecord(record);
+            pending = false;
+        }
+        while (historyLog->readNext(cursor, record)) {
+            // Pushdown point: non-matching records cost one mapped
+            // read here instead of a radio slot.
+            if (!historyQueryFilter.matches(record)) {
+                continue;
+            }
+            if (!encoder.addRecord(record)) {
+                pending = true;
+                break;
+            }
+        }
+
+        uint16_t len = encoder.finishChunk();
+        uint8_t count = encoder.recordCount();
+
+        // The empty chunk doubles as the end-of-stream marker.
+        if (!notifyChunk(framer, connHandle, chunk, len)) {
+            DEBUG_PRINTLN("History sync: client congested, aborting");
+            break;
+        }
+        if (count == 0) {
+            break;
+        }
+        sent += count;
+    }
+
+    DEBUG_PRINTF("History sync done: %u records\n", sent);
+    historySyncRunning = false;
+}
+
+// ============================================================================
+// ROLLUP SYNC
+// ============================================================================
+void BLEServiceManager::setRollupSource(RollupStore* store) {
+    rollupStore = store;
+}
+
+void BLEServiceManager::cmdGetRollup(BLEServiceManager* mgr,
+                                     const uint8_t* payload, size_t length) {
+    uint32_t fromSeq;
+    memcpy(&fromSeq, payload, sizeof(fromSeq));
+    mgr->startRollupSync(fromSeq, payload[4]);
+}
+
+void BLEServiceManager::startRollupSync(uint32_t fromSeq, uint8_t kind) {
+    if (rollupSyncRunning || rollupStore == nullptr || !deviceConnected ||
+        kind > RollupStore::ROLLUP_HOUR) {
+        return;
+    }
+
+    rollupFromSeq = fromSeq;
+    rollupKind = kind;
+    rollupSyncRunning = true;
+
+    TaskHandle_t handle;
+    if (xTaskCreatePinnedToCore(rollupTaskThunk, "ble_rollup",
+                                BLE_NOTIFY_TASK_STACK, this,
+                                BLE_TASK_PRIORITY, &handle,
+                                BLE_TASK_CORE) != pdPASS) {
+        rollupSyncRunning = false;
+    }
+}
+
+void BLEServiceManager::rollupTaskThunk(void* arg) {
+    static_cast<BLEServiceManager*>(arg)->rollupTaskLoop();
+    vTaskDelete(NULL);
+}
+
+// Verbatim 32-byte records behind a RollupChunkHeader; even a day
+// view is a couple dozen records, so the stream is a handful of
+// notifies and the empty chunk that ends it.
+void BLEServiceManager::rollupTaskLoop() {
+    uint16_t connHandle = 0xFFFF;
+    for (uint8_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (clients.active(i) && clients.at(i)->subscribed) {
+            connHandle = clients.at(i)->connHandle;
+            break;
+        }
+    }
+
+    if (connHandle == 0xFFFF) {
+        DEBUG_PRINTLN("Rollup sync: no subscribed client");
+        rollupSyncRunning = false;
+        return;
+    }
+
+    uint16_t chunkCap = chunkPayloadCap();
+    uint8_t maxRecords =
+        (uint8_t)((chunkCap - sizeof(RollupChunkHeader)) /
+                  sizeof(RollupRecord));
+
+    uint8_t chunk[BLE_PREFERRED_MTU];
+    ChunkFramer framer;
+    RollupChunkHeader* header = (RollupChunkHeader*)chunk;
+    header->magic = FRAME_MAGIC;
+    header->version = SENSOR_FRAME_VERSION;
+    header->type = FRAME_TYPE_ROLLUP_CHUNK;
+
+    RollupStore::Kind kind = (RollupStore::Kind)rollupKind;
+    RollupStore::Cursor cursor =
+        rollupStore->cursorFromSeq(kind, rollupFromSeq);
+    RollupRecord record;
+    uint32_t sent = 0;
+
+    DEBUG_PRINTF("Rollup sync: kind %u from seq %u\n", rollupKind,
+                 rollupFromSeq);
+
+    for (;;) {
+        uint8_t count = 0;
+        uint16_t len = sizeof(RollupChunkHeader);
+        while (count < maxRecords &&
+               rollupStore->readNext(kind, cursor, record)) {
+            memcpy(&chunk[len], &record, sizeof(record));
+            len += sizeof(record);
+            count++;
+        }
+        header->count = count;
+
+        // The empty chunk doubles as the end-of-stream marker.
+        if (!notifyChunk(framer, connHandle, chunk, len)) {
+            DEBUG_PRINTLN("Rollup sync: client congested, aborting");
+            break;
+        }
+        if (count == 0) {
+            break;
+        }
+        sent += count;
+    }
+
+    DEBUG_PRINTF("Rollup sync done: %u records\n", sent);
+    rollupSyncRunning = false;
+}
+
+// ============================================================================
+// AGGREGATION ROLE
+// ============================================================================
+void BLEServiceManager::setMeshRelay(EspNowMesh* mesh) {
+    meshRelay = mesh;
+}
+
+// Only opcodes a caregiver adjusts room-to-room; everything heavier
+// (OTA, model, diagnostics) requires connecting to the unit itself.
+static bool peerRelayable(uint8_t opcode) {
+    switch (opcode) {
+        case CMD_SET_FAN:
+        case CMD_SET_LED:
+        case CMD_SET_LED_FADE:
+        case CMD_SET_AUTO:
+        case CMD_SET_SETPOINT:
+        case CMD_SET_SCENE:
+            return true;
+    }
+    return false;
+}
+
+void BLEServiceManager::cmdPeerCommand(BLEServiceManager* mgr,
+                                       const uint8_t* payload, size_t length) {
+    if (mgr->meshRelay == nullptr ||
+        (mgr->negotiatedCaps & PROTO_CAP_AGGREGATION) == 0) {
+        return;
+    }
+    uint8_t inner = payload[6];
+    size_t innerLen = length - 7;
+    // The inner command must satisfy the same floor a direct write
+    // would, so the peer's dispatch never sees a short payload.
+    if (!peerRelayable(inner) ||
+        (int)innerLen < CommandParser::minPayload(inner) ||
+        innerLen > ESPNOW_CMD_MAX_PAYLOAD) {
+        DEBUG_PRINTF("Peer relay: rejected inner opcode 0x%02x\n", inner);
+        return;
+    }
+    mgr->meshRelay->relayCommand(payload, inner, payload + 7,
+                                 (uint8_t)innerLen);
+}
+
+void BLEServiceManager::pushNextPeerFrame() {
+    if (meshRelay == nullptr || !deviceConnected ||
+        (negotiatedCaps & PROTO_CAP_AGGREGATION) == 0) {
+        return;
+    }
+
+    // One peer per push cycle, round-robin: the pending-notify slot
+    // holds a single frame, and peers refresh every
+    // ESPNOW_SEND_INTERVAL_MS anyway, so spreading them across
+    // cycles loses nothing.
+    PeerSensorFrame frame;
+    MeshFrame snap;
+    uint8_t count = meshRelay->peerCount();
+    if (count == 0) {
+        return;
+    }
+    peerPushIdx = (uint8_t)(peerPushIdx % count);
+    uint32_t ageMs = 0;
+    if (!meshRelay->peerSnapshot(peerPushIdx, frame.mac, snap, ageMs)) {
+        peerPushIdx = 0;
+        return; // table shifted under us; realign next cycle
+    }
+    peerPushIdx++;
+
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_PEER_SENSOR;
+    frame.flags = snap.motion ? SENSOR_FLAG_MOTION : 0;
+    frame.temperature = snap.temperature;
+    frame.humidity = snap.humidity;
+    frame.occupancy = snap.occupancy;
+    frame.fanSpeed = snap.fanSpeed;
+    frame.ledBrightness = snap.ledBrightness;
+    frame.reserved = 0;
+    frame.ageMs = ageMs;
+    queueNotification((const uint8_t*)&frame, sizeof(frame), false);
+}
+
+// ============================================================================
+// CHART DOWNSAMPLING
+// ============================================================================
+// LTTB over the memory-mapped log: two cursor passes bound the range
+// (start offset + record count), then the sampler random-accesses
+// records by index while selections stream out as ordinary history
+// chunks. Nothing is buffered but the chunk being filled.
+
+namespace {
+
+struct ChartCtx {
+    BLEServiceManager* mgr;
+    HistoryLog* log;
+    uint32_t startOffset; // offset of range record 0
+    uint8_t field;        // 0 temp, 1 humidity, 2 distance
+    uint16_t connHandle;
+    uint16_t chunkCap;
+    bool congested;
+    uint32_t sent;
+    ChunkFramer framer;
+    HistoryEncoder encoder;
+    uint8_t chunk[BLE_PREFERRED_MTU];
+};
+
+bool chartRecordAt(ChartCtx* ctx, uint32_t index, HistoryRecord& rec) {
+    uint32_t offset = (ctx->startOffset +
+                       index * (uint32_t)sizeof(HistoryRecord)) %
+                      ctx->log->logSpan();
+    return ctx->log->recordAtOffset(offset, rec);
+}
+
+bool chartPointAt(void* arg, uint32_t index, int64_t& x, int64_t& y) {
+    ChartCtx* ctx = static_cast<ChartCtx*>(arg);
+    HistoryRecord rec;
+    if (!chartRecordAt(ctx, index, rec)) {
+        return false;
+    }
+    x = rec.timestampMs;
+    switch (ctx->field) {
+        case 1: y = rec.humidity; break;
+        case 2: y = rec.distance; break;
+        default: y = rec.temperature; break;
+    }
+    return true;
+}
+
+} // namespace
+
+void BLEServiceManager::cmdGetChart(BLEServiceManager* mgr,
+                                    const uint8_t* payload, size_t length) {
+    uint32_t fromMs, toMs;
+    uint16_t points;
+    memcpy(&fromMs, payload, sizeof(fromMs));
+    memcpy(&toMs, payload + 4, sizeof(toMs));
+    memcpy(&points, payload + 8, sizeof(points));
+    mgr->startChartSync(fromMs, toMs, points, payload[10]);
+}
+
+void BLEServiceManager::startChartSync(uint32_t fromMs, uint32_t toMs,
+                                       uint16_t points, uint8_t field) {
+    // Chart and full sync share the chunk frame type, so only one may
+    // stream at a time or the app can't attribute the records.
+    if (chartSyncRunning || historySyncRunning || historyLog == nullptr ||
+        !deviceConnected || points == 0 || field > 2 || toMs < fromMs) {
+        return;
+    }
+
+    chartFromMs = fromMs;
+    chartToMs = toMs;
+    chartPoints = points > CHART_MAX_POINTS ? CHART_MAX_POINTS : points;
+    chartField = field;
+    chartSyncRunning = true;
+
+    TaskHandle_t handle;
+    if (xTaskCreatePinnedToCore(chartTaskThunk, "ble_chart",
+                                BLE_NOTIFY_TASK_STACK, this,
+                                BLE_TASK_PRIORITY, &handle,
+                                BLE_TASK_CORE) != pdPASS) {
+        chartSyncRunning = false;
+    }
+}
+
+void BLEServiceManager::chartTaskThunk(void* arg) {
+    static_cast<BLEServiceManager*>(arg)->chartTaskLoop();
+    vTaskDelete(NULL);
+}
+
+// Emit side of the sampler: selected records append to the current
+// chunk; a full chunk notifies and a fresh one takes the record.
+bool BLEServiceManager::chartEmit(void* arg, uint32_t index) {
+    ChartCtx* ctx = static_cast<ChartCtx*>(arg);
+    HistoryRecord rec;
+    if (!chartRecordAt(ctx, index, rec)) {
+        return false;
+    }
+    if (!ctx->encoder.addRecord(rec)) {
+        uint16_t len = ctx->encoder.finishChunk();
+        if (!ctx->mgr->notifyChunk(ctx->framer, ctx->connHandle, ctx->chunk,
+                                   len)) {
+            ctx->congested = true;
+            return false;
+        }
+        ctx->encoder.beginChunk(ctx->chunk, ctx->chunkCap);
+        ctx->encoder.addRecord(rec);
+    }
+    ctx->sent++;
+    return true;
+}
+
+void BLEServiceManager::chartTaskLoop() {
+    uint16_t connHandle = 0xFFFF;
+    for (uint8_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (clients.active(i) && clients.at(i)->subscribed) {
+            connHandle = clients.at(i)->connHandle;
+            break;
+        }
+    }
+
+    if (connHandle == 0xFFFF) {
+        DEBUG_PRINTLN("Chart query: no subscribed client");
+        chartSyncRunning = false;
+        return;
+    }
+
+    // Pass 1: pin the range — offset of its first record and how many
+    // records it spans. Mapped-flash reads, bandwidth-bound.
+    HistoryLog::Cursor scan = historyLog->cursorFromTime(chartFromMs);
+    HistoryRecord rec;
+    uint32_t startOffset = 0;
+    uint32_t n = 0;
+    for (;;) {
+        uint32_t before = scan.offset;
+        if (!historyLog->readNext(scan, rec)) {
+            break;
+        }
+        if (rec.timestampMs < chartFromMs) {
+            continue; // index-stride records ahead of the exact start
+        }
+        if (rec.timestampMs > chartToMs) {
+            break;
+        }
+        if (n == 0) {
+            startOffset = before;
+        }
+        n++;
+    }
+
+    ChartCtx ctx;
+    ctx.mgr = this;
+    ctx.log = historyLog;
+    ctx.startOffset = startOffset;
+    ctx.field = chartField;
+    ctx.connHandle = connHandle;
+    ctx.congested = false;
+    ctx.sent = 0;
+    ctx.chunkCap = chunkPayloadCap();
+    ctx.encoder.beginChunk(ctx.chunk, ctx.chunkCap);
+
+    DEBUG_PRINTF("Chart query: %u records in range, %u points\n",
+                 n, chartPoints);
+
+    LttbSampler::select(chartPointAt, &ctx, n, chartPoints,
+                        chartEmit, &ctx);
+
+    // Flush the partial chunk, then the empty end-of-stream chunk.
+    if (!ctx.congested) {
+        uint16_t len = ctx.encoder.finishChunk();
+        bool delivered = true;
+        if (ctx.encoder.recordCount() > 0) {
+            delivered = notifyChunk(ctx.framer, connHandle, ctx.chunk, len);
+            if (delivered) {
+                ctx.encoder.beginChunk(ctx.chunk, ctx.chunkCap);
+                len = ctx.encoder.finishChunk();
+            }
+        }
+        if (delivered) {
+            notifyChunk(ctx.framer, connHandle, ctx.chunk, len);
+        }
+    }
+
+    DEBUG_PRINTF("Chart query done: %u of %u records sent\n", ctx.sent, n);
+    chartSyncRunning = false;
+}
+
+// ============================================================================
+// CAPTURE EXPORT
+// ============================================================================
+void BLEServiceManager::setCaptureSource(CaptureStore* store) {
+    captureStore = store;
+}
+
+void BLEServiceManager::cmdGetCaptures(BLEServiceManager* mgr,
+                                       const uint8_t* payload, size_t length) {
+    mgr->startCaptureSync();
+}
+
+void BLEServiceManager::startCaptureSync() {
+    if (captureSyncRunning || captureStore == nullptr || !deviceConnected) {
+        return;
+    }
+
+    captureSyncRunning = true;
+    TaskHandle_t handle;
+    if (xTaskCreatePinnedToCore(captureTaskThunk, "ble_capture",
+                                BLE_NOTIFY_TASK_STACK, this,
+                                BLE_TASK_PRIORITY, &handle,
+                                BLE_TASK_CORE) != pdPASS) {
+        captureSyncRunning = false;
+    }
+}
+
+void BLEServiceManager::captureTaskThunk(void* arg) {
+    static_cast<BLEServiceManager*>(arg)->captureTaskLoop();
+    vTaskDelete(NULL);
+}
+
+// Streams every CRC-valid capture record as raw bytes under
+// CaptureChunkHeader framing; the training pipeline decodes the
+// delta-varint payload offline, so the device never re-expands it.
+void BLEServiceManager::captureTaskLoop() {
+    uint16_t connHandle = 0xFFFF;
+    for (uint8_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (clients.active(i) && clients.at(i)->subscribed) {
+            connHandle = clients.at(i)->connHandle;
+            break;
+        }
+    }
+    if (connHandle == 0xFFFF) {
+        DEBUG_PRINTLN("Capture export: no subscribed client");
+        captureSyncRunning = false;
+        return;
+    }
+
+    uint16_t chunkCap = chunkPayloadCap();
+
+    uint8_t chunk[BLE_PREFERRED_MTU];
+    ChunkFramer framer;
+    CaptureChunkHeader* frame = (CaptureChunkHeader*)chunk;
+    frame->magic = FRAME_MAGIC;
+    frame->version = SENSOR_FRAME_VERSION;
+    frame->type = FRAME_TYPE_CAPTURE_CHUNK;
+    frame->reserved = 0;
+    uint16_t byteCap = chunkCap - sizeof(CaptureChunkHeader);
+
+    uint32_t exported = 0;
+    bool aborted = false;
+    CaptureStore::Cursor cursor = captureStore->firstRecord();
+    CaptureHeader header;
+    while (!aborted && captureStore->readHeader(cursor, header)) {
+        // Pre-pass CRC so a record torn by a wrap erase is skipped
+        // whole instead of poisoning the stream.
+        uint32_t crc = 0;
+        for (uint16_t at = 0; at < header.encodedLen;) {
+            uint16_t span = header.encodedLen - at;
+            if (span > byteCap) {
+                span = byteCap;
+            }
+            if (captureStore->readPayload(cursor, at, chunk +
+                                          sizeof(CaptureChunkHeader),
+                                          span) != span) {
+                break;
+            }
+            crc = crc32_le(crc, chunk + sizeof(CaptureChunkHeader), span);
+            at += span;
+        }
+        if (crc != header.crc) {
+            captureStore->nextRecord(cursor);
+            continue;
+        }
+
+        // Header + payload as one contiguous byte range; the first
+        // chunk carries the CaptureHeader itself.
+        uint16_t total = sizeof(CaptureHeader) + header.encodedLen;
+        frame->sequence = header.sequence;
+        for (uint16_t at = 0; at < total;) {
+            uint16_t span = total - at;
+            if (span > byteCap) {
+                span = byteCap;
+            }
+            uint8_t* dst = chunk + sizeof(CaptureChunkHeader);
+            if (at < sizeof(CaptureHeader)) {
+                // Chunks never straddle the header/payload boundary;
+                // the header is smaller than any usable MTU.
+                span = sizeof(CaptureHeader);
+                memcpy(dst, &header, span);
+            } else if (captureStore->readPayload(
+                           cursor, at - sizeof(CaptureHeader), dst,
+                           span) != span) {
+                aborted = true;
+                break;
+            }
+            frame->offset = at;
+            if (!notifyChunk(framer, connHandle, chunk,
+                             sizeof(CaptureChunkHeader) + span)) {
+                DEBUG_PRINTLN("Capture export: client congested, aborting");
+                aborted = true;
+                break;
+            }
+            at += span;
+        }
+        if (!aborted) {
+            exported++;
+        }
+        captureStore->nextRecord(cursor);
+    }
+
+    // End-of-stream marker: sequence 0, no bytes.
+    frame->sequence = 0;
+    frame->offset = 0;
+    notifyChunk(framer, connHandle, chunk, sizeof(CaptureChunkHeader));
+
+    DEBUG_PRINTF("Capture export done: %u records\n", exported);
+    captureSyncRunning = false;
+}
+
+// Opcodes that have never run are skipped, so the frame stays small;
+// the cap only matters if most of the opcode space runs between
+// resets, and then the busiest (lowest) opcodes still fit.
+void BLEServiceManager::cmdGetCmdStats(BLEServiceManager* mgr,
+                                       const uint8_t* payload, size_t length) {
+    bool reset = (length >= 1) && (payload[0] & 0x01);
+
+    const uint8_t maxFit =
+        (sizeof(((PendingNotify*)0)->data) - sizeof(CmdLatencyFrameHeader)) /
+        sizeof(CmdLatencyEntry);
+
+    uint8_t buf[sizeof(CmdLatencyFrameHeader) +
+                maxFit * sizeof(CmdLatencyEntry)];
+    CmdLatencyEntry* entries =
+        (CmdLatencyEntry*)(buf + sizeof(CmdLatencyFrameHeader));
+    uint8_t count = 0;
+    for (uint8_t op = 0; op < CMD_LATENCY_SLOTS && count < maxFit; op++) {
+        const CmdOpStats& s = CmdLatency::op(op);
+        if (s.count == 0) {
+            continue;
+        }
+        entries[count].opcode = op;
+        memset(entries[count].reserved, 0, sizeof(entries[count].reserved));
+        entries[count].count = s.count;
+        entries[count].avgUs = (uint32_t)(s.sumUs / s.count);
+        entries[count].maxUs = s.maxUs;
+        count++;
+    }
+
+    CmdLatencyFrameHeader* header = (CmdLatencyFrameHeader*)buf;
+    header->magic = FRAME_MAGIC;
+    header->version = SENSOR_FRAME_VERSION;
+    header->type = FRAME_TYPE_CMD_LATENCY;
+    header->opCount = count;
+    header->slowOpcode = CmdLatency::slowestOpcode();
+    header->slowQueueDepth = CmdLatency::slowestQueueDepth();
+    header->reserved = 0;
+    header->slowUs = CmdLatency::slowestUs();
+    header->slowAgeMs = CmdLatency::slowestAgeMs();
+
+    if (reset) {
+        CmdLatency::reset();
+    }
+
+    mgr->queueNotification(buf, sizeof(CmdLatencyFrameHeader) +
+                                count * sizeof(CmdLatencyEntry), false);
+}
+
+// ============================================================================
+// CORE-DUMP EXPORT
+// ============================================================================
+void BLEServiceManager::setCoreDumpSource(CoreDumpStore* store) {
+    coreDumpStore = store;
+}
+
+void BLEServiceManager::cmdGetCoreDump(BLEServiceManager* mgr,
+                                       const uint8_t* payload, size_t length) {
+    bool eraseAfter = (length >= 1) && (payload[0] & 0x01);
+    mgr->startCoreDumpSync(eraseAfter);
+}
+
+void BLEServiceManager::startCoreDumpSync(bool eraseAfter) {
+    if (coreDumpSyncRunning || coreDumpStore == nullptr ||
+        !deviceConnected || !coreDumpStore->hasDump()) {
+        return;
+    }
+
+    coreDumpSyncRunning = true;
+    coreDumpEraseAfter = eraseAfter;
+    TaskHandle_t handle;
+    if (xTaskCreatePinnedToCore(coreDumpTaskThunk, "ble_coredmp",
+                                BLE_NOTIFY_TASK_STACK, this,
+                                BLE_TASK_PRIORITY, &handle,
+                                BLE_TASK_CORE) != pdPASS) {
+        coreDumpSyncRunning = false;
+    }
+}
+
+void BLEServiceManager::coreDumpTaskThunk(void* arg) {
+    static_cast<BLEServiceManager*>(arg)->coreDumpTaskLoop();
+    vTaskDelete(NULL);
+}
+
+// Chunk serializer for notifyClientFill: header plus a flash read,
+// written straight into the host-stack mbuf. Re-reading the partition
+// on a congestion retry is cheaper than staging every chunk through a
+// flat buffer on the common path.
+struct CoreDumpFillCtx {
+    CoreDumpStore* store;
+    ChunkFramer* framer; // NULL for a client without framed chunks
+    CoreDumpChunkHeader header;
+    uint16_t span; // payload bytes after the header, 0 = end marker
+};
+
+static bool fillCoreDumpChunk(void* arg, uint8_t* dst) {
+    CoreDumpFillCtx* ctx = (CoreDumpFillCtx*)arg;
+    memcpy(dst, &ctx->header, sizeof(ctx->header));
+    if (ctx->span != 0 &&
+        ctx->store->read(ctx->header.offset, dst + sizeof(ctx->header),
+                         ctx->span) != ctx->span) {
+        return false;
+    }
+    if (ctx->framer != NULL) {
+        // Re-sealed per attempt with the same sequence; the loop
+        // advances it only once the chunk is delivered.
+        ctx->framer->sealAt(dst, sizeof(ctx->header) + ctx->span);
+    }
+    return true;
+}
+
+// Streams the dump image as raw bytes under CoreDumpChunkHeader
+// framing; espcoredump.py decodes it offline against the matching
+// ELF, so the device never parses its own corpse.
+void BLEServiceManager::coreDumpTaskLoop() {
+    uint16_t connHandle = 0xFFFF;
+    for (uint8_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (clients.active(i) && clients.at(i)->subscribed) {
+            connHandle = clients.at(i)->connHandle;
+            break;
+        }
+    }
+    if (connHandle == 0xFFFF) {
+        DEBUG_PRINTLN("Core-dump export: no subscribed client");
+        coreDumpSyncRunning = false;
+        return;
+    }
+
+    uint16_t chunkCap = chunkPayloadCap();
+
+    ChunkFramer framer;
+    CoreDumpFillCtx ctx;
+    ctx.store = coreDumpStore;
+    ctx.framer =
+        (negotiatedCaps & PROTO_CAP_FRAMED_CHUNKS) ? &framer : NULL;
+    ctx.header.magic = FRAME_MAGIC;
+    ctx.header.version = SENSOR_FRAME_VERSION;
+    ctx.header.type = FRAME_TYPE_COREDUMP_CHUNK;
+    ctx.header.reserved = 0;
+    ctx.header.totalSize = coreDumpStore->size();
+    uint16_t byteCap = chunkCap - sizeof(CoreDumpChunkHeader);
+
+    bool aborted = false;
+    uint32_t at = 0;
+    while (at < ctx.header.totalSize) {
+        uint32_t span = ctx.header.totalSize - at;
+        if (span > byteCap) {
+            span = byteCap;
+        }
+        ctx.header.offset = at;
+        ctx.span = (uint16_t)span;
+        uint16_t trailer = ctx.framer ? ChunkFramer::TRAILER_LEN : 0;
+        if (!notifyClientFill(connHandle,
+                              sizeof(CoreDumpChunkHeader) + ctx.span +
+                                  trailer,
+                              fillCoreDumpChunk, &ctx)) {
+            DEBUG_PRINTLN("Core-dump export: aborting");
+            aborted = true;
+            break;
+        }
+        framer.advance();
+        at += span;
+    }
+
+    // End-of-stream marker: offset == totalSize, no bytes.
+    if (!aborted) {
+        ctx.header.offset = ctx.header.totalSize;
+        ctx.span = 0;
+        notifyClientFill(connHandle,
+                         sizeof(CoreDumpChunkHeader) +
+                             (ctx.framer ? ChunkFramer::TRAILER_LEN : 0),
+                         fillCoreDumpChunk, &ctx);
+        if (coreDumpEraseAfter) {
+            coreDumpStore->erase();
+        }
+        DEBUG_PRINTF("Core-dump export done: %u bytes\n",
+                     ctx.header.totalSize);
+    }
+    coreDumpSyncRunning = false;
+}
+
+// ============================================================================
+// EVENT TRACE EXPORT
+// ============================================================================
+void BLEServiceManager::cmdGetTrace(BLEServiceManager* mgr,
+                                    const uint8_t* payload, size_t length) {
+    mgr->startTraceSync();
+}
+
+void BLEServiceManager::startTraceSync() {
+    if (traceSyncRunning || !deviceConnected) {
+        return;
+    }
+
+    traceSyncRunning = true;
+    TaskHandle_t handle;
+    if (xTaskCreatePinnedToCore(traceTaskThunk, "ble_trace",
+                                BLE_NOTIFY_TASK_STACK, this,
+                                BLE_TASK_PRIORITY, &handle,
+                                BLE_TASK_CORE) != pdPASS) {
+        traceSyncRunning = false;
+    }
+}
+
+void BLEServiceManager::traceTaskThunk(void* arg) {
+    static_cast<BLEServiceManager*>(arg)->traceTaskLoop();
+    vTaskDelete(NULL);
+}
+
+// Walks the EventTrace ring oldest-first by absolute sequence while
+// writers keep appending. A record that gets lapped mid-dump fails
+// read() and ends the walk early; the host sees the gap in firstSeq
+// of the end marker and reports it instead of hiding it.
+void BLEServiceManager::traceTaskLoop() {
+    uint16_t connHandle = 0xFFFF;
+    for (uint8_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (clients.active(i) && clients.at(i)->subscribed) {
+            connHandle = clients.at(i)->connHandle;
+            break;
+        }
+    }
+    if (connHandle == 0xFFFF) {
+        DEBUG_PRINTLN("Trace export: no subscribed client");
+        traceSyncRunning = false;
+        return;
+    }
+
+    uint16_t chunkCap = chunkPayloadCap();
+    uint8_t recordCap = (chunkCap - sizeof(TraceChunkHeader)) /
+                        sizeof(TraceRecord);
+
+    uint8_t chunk[BLE_PREFERRED_MTU];
+    ChunkFramer framer;
+    TraceChunkHeader* frame = (TraceChunkHeader*)chunk;
+    frame->magic = FRAME_MAGIC;
+    frame->version = SENSOR_FRAME_VERSION;
+    frame->type = FRAME_TYPE_TRACE_CHUNK;
+
+    uint32_t seq = EventTrace::writeSequence() - EventTrace::available();
+    uint32_t end = EventTrace::writeSequence();
+    uint32_t sent = 0;
+    bool aborted = false;
+    while (seq < end) {
+        TraceRecord* records =
+            (TraceRecord*)(chunk + sizeof(TraceChunkHeader));
+        uint8_t n = 0;
+        while (n < recordCap && seq + n < end) {
+            if (!EventTrace::read(seq + n, records[n])) {
+                break; // lapped by writers — resume past the gap
+            }
+            n++;
+        }
+        if (n == 0) {
+            // Everything up to `end` that still existed got lapped;
+            // skip ahead to the oldest surviving record.
+            uint32_t oldest =
+                EventTrace::writeSequence() - EventTrace::available();
+            if (oldest <= seq) {
+                break; // no progress possible
+            }
+            seq = oldest;
+            continue;
+        }
+        frame->recordCount = n;
+        frame->firstSeq = seq;
+        if (!notifyChunk(framer, connHandle, chunk,
+                         sizeof(TraceChunkHeader) +
+                             n * sizeof(TraceRecord))) {
+            DEBUG_PRINTLN("Trace export: client congested, aborting");
+            aborted = true;
+            break;
+        }
+        seq += n;
+        sent += n;
+    }
+
+    // End-of-stream marker: no records, firstSeq = next unread.
+    if (!aborted) {
+        frame->recordCount = 0;
+        frame->firstSeq = seq;
+        notifyChunk(framer, connHandle, chunk, sizeof(TraceChunkHeader));
+        DEBUG_PRINTF("Trace export done: %u records\n", sent);
+    }
+    traceSyncRunning = false;
+}
+
+void BLEServiceManager::handleCommand(const char* data, size_t length) {
+    // The decode — and every rejection path — lives in the portable
+    // parser, normalized onto the binary opcode space; only the
+    // callback wiring stays here.
+    CommandParser::JsonCommand cmd;
+    if (!CommandParser::parseJson(data, length, cmd)) {
+        DEBUG_PRINTLN("Rejected legacy JSON command");
+        return;
+    }
+
+    noteCommandActivity();
+
+    // The JSON grammar predates the MAC trailer, so it cannot carry
+    // one: with a PIN provisioned, mutating legacy commands are
+    // refused outright rather than left as an unauthenticated side
+    // door around the session gate.
+    if (authRequired() && CommandParser::requiresAuth(cmd.opcode)) {
+        DEBUG_PRINTLN("Legacy JSON command rejected: PIN is set");
+        return;
+    }
+
+    // A legacy JSON write is an implicit hello from an app that
+    // predates the handshake: land it on the compatibility path and
+    // stop sending deltas it could never parse.
+    if (!jsonCompatMode) {
+        negotiatedCaps = 0;
+        jsonCompatMode = true;
+        statusSnapshotDirty = true;
+        DEBUG_PRINTLN("Legacy JSON client: compatibility mode on");
+    }
+
+    switch (cmd.opcode) {
+    case CMD_SET_FAN:
+        DEBUG_PRINTF("Setting fan speed to: %d\n", cmd.value);
+        if (fanSpeedCallback) {
+            fanSpeedCallback(cmd.value);
+        }
+        break;
+    case CMD_SET_LED:
+        DEBUG_PRINTF("Setting LED brightness to: %d\n", cmd.value);
+        if (ledBrightnessCallback) {
+            ledBrightnessCallback(cmd.value);
+        }
+        break;
+    case CMD_SET_LED_FADE:
+        DEBUG_PRINTF("Fading LED to %d over %d ms\n", cmd.value,
+                     cmd.durationMs);
+        if (ledFadeCallback) {
+            ledFadeCallback(cmd.value, cmd.durationMs);
+        }
+        break;
+    case CMD_SET_AUTO:
+        DEBUG_PRINTF("Setting auto mode to: %s\n",
+                     cmd.value != 0 ? "ON" : "OFF");
+        if (autoModeCallback) {
+            autoModeCallback(cmd.value != 0);
+        }
+        break;
+    case CMD_BENCHMARK:
+        DEBUG_PRINTF("Benchmark requested: %d s\n", (uint8_t)cmd.durationMs);
+        startBenchmark((uint8_t)cmd.durationMs);
+        break;
+    case CMD_GET_STATUS:
+        DEBUG_PRINTLN("Status request received");
+        cmdGetStatus(this, nullptr, 0); // same snapshot as the binary path
+        break;
+    }
+}
+
+void BLEServiceManager::setStatusLed(LedPatternEngine* led) {
+    statusLed = led;
+}
+
+void BLEServiceManager::onFanSpeedChange(void (*callback)(uint8_t)) {
+    fanSpeedCallback = callback;
+}
+
+void BLEServiceManager::onLEDBrightnessChange(void (*callback)(uint8_t)) {
+    ledBrightnessCallback = callback;
+}
+
+void BLEServiceManager::onLEDFade(void (*callback)(uint8_t, uint16_t)) {
+    ledFadeCallback = callback;
+}
+
+void BLEServiceManager::onSceneApply(void (*callback)(uint8_t)) {
+    sceneApplyCallback = callback;
+}
+
+void BLEServiceManager::onSceneDefine(void (*callback)(uint8_t,
+                                                       const ScenePreset&)) {
+    sceneDefineCallback = callback;
+}
+
+void BLEServiceManager::onAutoModeChange(void (*callback)(bool)) {
+    autoModeCallback = callback;
+}
+
+void BLEServiceManager::onSetpointChange(void (*callback)(int16_t)) {
+    setpointCallback = callback;
 }
\ No newline at end of file
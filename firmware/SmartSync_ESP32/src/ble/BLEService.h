@@ -3,7 +3,25 @@
 
 #include <Arduino.h>
 #include <NimBLEDevice.h>
+#include <Preferences.h>
 #include "../../include/config.h"
+#include "SensorFrame.h"
+#include "CommandParser.h"
+#include "SessionAuth.h"
+#include "../system/LatencyStats.h"
+#include "../system/SlotPool.h"
+#include "../system/StateStore.h"
+
+class ChunkFramer;
+class EspNowMesh;
+class SettingsStore;
+class LedPatternEngine;
+class HistoryLog;
+class RollupStore;
+class ModelUpdater;
+class FirmwareUpdater;
+class CaptureStore;
+class CoreDumpStore;
 
 class BLEServiceManager {
 public:
@@ -11,33 +29,685 @@ public:
     ~BLEServiceManager();
     
     bool begin();
-    void update();
     bool isConnected();
-    void sendSensorData(float temp, float humidity, int fanSpeed, 
-                       int ledBright, bool motion, float distance);
+
+    // Called from the NimBLE server callbacks, keyed by connection
+    // handle so multiple clients get consistent service.
+    void handleConnect(uint16_t connHandle);
+    void handleDisconnect(uint16_t connHandle);
+
+    // Remembers the bonded peer and restarts advertising after a
+    // disconnect — directed at the last peer first for fast reconnect.
+    void rememberPeer(const ble_addr_t& addr);
+    void startReconnectAdvertising();
+    void handleMtuChange(uint16_t connHandle, uint16_t mtu);
+    void handleSubscription(uint16_t connHandle, bool subscribed);
+
+    // Largest notification payload carried without link-layer
+    // fragmentation on the most constrained subscribed client.
+    uint16_t maxPayloadSize() const;
+
+    // Called from the RX characteristic callback with the raw write
+    // (magic byte included) and the writing connection. CommandParser
+    // validates before any handler runs; binary commands are parsed in
+    // place from the attribute buffer. When a device PIN is set,
+    // mutating opcodes must carry a valid SessionAuth trailer for this
+    // connection's session or they are dropped here.
+    void handleBinaryCommand(const uint8_t* data, size_t length,
+                             uint16_t connHandle);
+    // Legacy JSON command path: parses straight out of the attribute
+    // buffer into a stack document — no copies, no heap. Oversized
+    // payloads fail the parse and are logged, not truncated.
+    void handleCommand(const char* data, size_t length);
+    void sendSensorData(float temp, float humidity, int fanSpeed,
+                       int ledBright, bool motion, float distance,
+                       uint8_t occupancy, bool sensorFault,
+                       uint16_t fanRpm, bool stale);
+
+    // Hands over the auth credentials (settings blob fields; main.cpp
+    // owns the store). A PIN of 0 means authentication is not
+    // configured and every command stays open — existing fleets keep
+    // working until a PIN is provisioned.
+    void setAuthCredentials(uint32_t devicePin, uint32_t deviceId);
+
+    // Registers the central device-state store. CMD_GET_STATUS drains
+    // the store's STATUS dirty mask lazily, so a poll right after a
+    // slider write sees the new actuator values without the command
+    // task pushing anything here.
+    void attachStateStore(StateStore* store);
+
+    // Registers the settings store served by the read-only settings
+    // characteristic: app launch pulls the whole packed blob (schema
+    // version first) in one GATT read instead of a GET conversation.
+    // The device PIN is redacted from the served copy.
+    void setSettingsSource(SettingsStore* store);
+
+    // Alarm raise/clear from the AlarmSystem drain task; bypasses the
+    // per-client rate pacing periodic frames honor.
+    void sendAlert(uint8_t alarmType, uint16_t value, uint32_t timestampMs);
+
+    // Zone transition from the classifier (sensor task). Control tier:
+    // events must not coalesce away, but they don't preempt alerts.
+    void sendZoneEvent(uint8_t zone, uint8_t prevZone, uint16_t distMm,
+                       uint32_t dwellMs);
+
+    // PIR rising edge from the sensor task: someone is present and may
+    // want to connect, so advertising snaps back to the fast cadence.
+    void noteMotionActivity();
+
+    // Refreshes the snapshot embedded in advertising manufacturer data
+    // (AdvSensorFrame) so passive scanners see live values. Called from
+    // the sensor task each SENSOR_READ_INTERVAL.
+    void broadcastSensorSnapshot(float temp, float humidity, bool motion,
+                                 uint8_t fanSpeed);
+
+    // Legacy JSON notifications for app versions that predate the
+    // packed frame format (default: binary).
+    void setJsonCompatMode(bool enabled);
+
+    // Legacy JSON path, generated from SENSOR_FRAME_SCHEMA. Writes
+    // into the caller's buffer; returns the length, 0 on overflow.
+    // Public so test/test_bench can cost it against the packed frame.
+    size_t createSensorJSON(const SensorFrame& frame, char* out,
+                            size_t cap);
     
     // Callback setters
     void onFanSpeedChange(void (*callback)(uint8_t));
     void onLEDBrightnessChange(void (*callback)(uint8_t));
+    void onLEDFade(void (*callback)(uint8_t target, uint16_t durationMs));
     void onAutoModeChange(void (*callback)(bool));
-    
+    void onSetpointChange(void (*callback)(int16_t centi));
+    void onSceneApply(void (*callback)(uint8_t index));
+    void onSceneDefine(void (*callback)(uint8_t index,
+                                        const ScenePreset& preset));
+
+    // Connection indications are played on the status LED when set.
+    void setStatusLed(LedPatternEngine* led);
+
+    // History log to stream from on CMD_GET_HISTORY.
+    void setHistorySource(HistoryLog* log);
+
+    // Rollup aggregates to stream from on CMD_GET_ROLLUP.
+    void setRollupSource(RollupStore* store);
+
+    // Aggregation role (network/EspNowMesh): the mesh whose peer
+    // snapshots multiplex onto this connection and whose unicast
+    // relay carries CMD_PEER_COMMAND back out.
+    void setMeshRelay(EspNowMesh* mesh);
+
+    // Notifies one fresh peer's snapshot as FRAME_TYPE_PEER_SENSOR,
+    // round-robin across peers; called on the sensor push cadence by
+    // the aggregation unit. No-op unless the client negotiated
+    // PROTO_CAP_AGGREGATION.
+    void pushNextPeerFrame();
+
+    // Fills wear counters for CMD_GET_FLASH_HEALTH; main.cpp owns the
+    // stores, so it provides the numbers.
+    void onFlashHealthRequest(void (*callback)(FlashHealthFrame& frame));
+
+    // Receives CMD_MODEL_* transfers. Commit success fires the
+    // callback so main.cpp can rebind the detectors to the new bank.
+    void setModelUpdater(ModelUpdater* updater);
+    void onModelCommitted(void (*callback)(void));
+
+    // Receives BLE firmware transfers: CMD_OTA_BEGIN/COMMIT control,
+    // raw chunks on the dedicated OTA characteristic. Commit success
+    // schedules a reboot into the new slot.
+    void setFirmwareUpdater(FirmwareUpdater* updater);
+
+    // Capture store to stream from on CMD_GET_CAPTURES.
+    void setCaptureSource(CaptureStore* store);
+
+    // Crash dump to stream from on CMD_GET_COREDUMP; while one is
+    // pending, sensor frames carry SENSOR_FLAG_COREDUMP.
+    void setCoreDumpSource(CoreDumpStore* store);
+
+    // Fills the hot-path latency aggregates for CMD_GET_LATENCY;
+    // main.cpp owns the histograms. reset clears them after the read.
+    void onLatencyRequest(void (*callback)(LatencyStatsFrame& frame,
+                                           bool reset));
+
+    // Arrival stamp and opcode of the command currently dispatching,
+    // valid only inside the synchronous actuator callbacks — main.cpp
+    // copies them into the queued Command so the command task can
+    // record the full command-to-actuation span.
+    int64_t currentCommandArrivalUs() const { return cmdArrivalUs; }
+    uint8_t currentCommandOpcode() const { return cmdOpcode; }
+
+    // Fills heap health numbers for CMD_GET_HEAP; main.cpp owns the
+    // HeapMonitor.
+    void onHeapStatsRequest(void (*callback)(HeapStatsFrame& frame));
+
+    // Fills the main-side fields of the periodic soak frame (queue
+    // depths, shed/drop counters) each CMD_SOAK interval; everything
+    // BLE- or diagnostics-owned is filled here.
+    void onSoakSample(void (*callback)(SoakMetricsFrameHeader& frame));
+
+    // Fills boot-stage timings for CMD_GET_BOOT; main.cpp owns the
+    // stage table and the RTC shadow of the previous boot.
+    void onBootStatsRequest(void (*callback)(BootStatsFrame& frame));
+
 private:
     NimBLEServer* pServer;
     NimBLEService* pService;
+    NimBLEAdvertising* pAdvertising;
+    uint8_t advSequence;
     NimBLECharacteristic* pTxCharacteristic;
     NimBLECharacteristic* pRxCharacteristic;
+    NimBLECharacteristic* pOtaCharacteristic;
+    NimBLECharacteristic* pSettingsCharacteristic;
+    NimBLECharacteristic* pAlertCharacteristic;
+
+    // Service layout, fixed at compile time: constexpr helpers in the
+    // translation unit parse the UUID strings from config.h into the
+    // host stack's binary form, and begin() walks this table instead
+    // of re-parsing text on the boot path.
+    struct CharacteristicDef {
+        const ble_uuid128_t* uuid;
+        uint32_t properties;
+        NimBLECharacteristic* BLEServiceManager::* slot;
+    };
+    static const CharacteristicDef CHARACTERISTIC_TABLE[5];
     
-    bool deviceConnected;
-    bool oldDeviceConnected;
+    bool deviceConnected; // any client connected
+    bool jsonCompatMode;
+
+    // Per-connection state, keyed by NimBLE connection handle, pooled
+    // in fixed slots (SlotPool) so connect/disconnect churn never
+    // touches the heap; a freed slot is reconstructed on reuse, so no
+    // field survives into the next connection. Clients that never
+    // subscribe (command-only apps) cost no radio time on the notify
+    // path.
+    struct ClientState {
+        uint16_t connHandle;
+        uint16_t mtu;
+        uint16_t updateIntervalMs; // per-client notification rate
+        uint32_t lastSentMs;
+        bool subscribed;
+        uint8_t fieldMask; // SensorFieldBits this client consumes;
+                           // 0 = alerts only (CMD_SUBSCRIBE)
+        SessionAuth auth; // per-connection session; fresh per slot
+        uint8_t streamSeq; // newest CMD_STREAM seq applied
+        bool streamSeen;   // streamSeq holds a real sequence
+    };
+    SlotPool<ClientState, BLE_MAX_CLIENTS> clients;
+
+    ClientState* findClient(uint16_t connHandle);
+
+    // Bonding: the last bonded peer's identity address, persisted in
+    // the shared Preferences namespace across reboots.
+    Preferences blePrefs;
+    ble_addr_t lastPeerAddr;
+    bool haveBondedPeer;
+
+    static int directedAdvGapEvent(struct ble_gap_event* event, void* arg);
+
+    // Delta encoding state: last values on the air and the keyframe
+    // cadence counter.
+    SensorFrame lastSentFrame;
+    bool haveLastSent;
+    uint8_t framesSinceKeyframe;
+
+    // --- Status snapshot cache --------------------------------------------
+    // CMD_GET_STATUS answers from a preserialized buffer. The frame is
+    // reserialized only when the underlying state changed (periodic
+    // push, or an actuator write recorded in the state store's STATUS
+    // dirty mask), so a poll — even from every client at once — costs
+    // one queueNotification of bytes already on hand.
+    void rebuildStatusSnapshot();
+
+    SensorFrame statusFrame;
+    uint8_t statusSnapshot[192]; // sized for the worst-case JSON form
+    uint16_t statusSnapshotLen;
+    bool statusSnapshotDirty;
+    StateStore* stateStore; // actuator fields pulled on demand; may be null
+
+    // --- Bulk settings read -----------------------------------------------
+    // The settings characteristic serializes the blob just in time on
+    // each read (onRead callback), so the app always sees the current
+    // values — including writes it batched moments earlier — with the
+    // PIN field zeroed before the bytes leave the device.
+    void fillSettingsCharacteristic(NimBLECharacteristic* characteristic);
+
+    SettingsStore* settingsSource; // may be null (bench builds)
+
+    // --- Reconnect catch-up ring ------------------------------------------
+    // Recent sealed frames at full resolution, recorded with or
+    // without a client connected; a fresh subscription gets the
+    // backlog as a high-rate burst (FRAME_TYPE_CATCHUP_CHUNK, as many
+    // frames per notification as the MTU carries) before the periodic
+    // cadence resumes, so the app's chart backfills in about a second
+    // without touching the flash history path.
+    void recordCatchupFrame(const SensorFrame& frame);
+    void startCatchupSync(uint16_t connHandle);
+    static void catchupTaskThunk(void* arg);
+    void catchupTaskLoop();
+
+    SensorFrame catchupRing[BLE_CATCHUP_RING_FRAMES];
+    uint16_t catchupHead;         // next write slot
+    uint16_t catchupCount;
+    uint32_t catchupLastRecordMs;
+    portMUX_TYPE catchupLock;     // sensor task writes, burst task reads
+    volatile bool catchupSyncRunning;
+    uint16_t catchupConnHandle;
+
+    // --- Guaranteed alert delivery ----------------------------------------
+    // Alerts dual-path: the TX notification stays for compatibility,
+    // but the authoritative copy goes out the dedicated alert
+    // characteristic as an indication — link-layer acknowledged — and
+    // an unconfirmed slot retransmits with doubling backoff until the
+    // phone confirms. Slots survive disconnects (delivered on the next
+    // subscribe), and the newest one also rides RTC memory across
+    // resets (RtcState). Local escalation never waits on delivery: the
+    // timer-wheel ladder keeps climbing whether or not the phone acks.
+    struct PendingAlert {
+        AlertFrame frame;
+        uint8_t attempts;
+        uint32_t nextTryMs;
+        uint32_t backoffMs;
+        bool valid;
+    };
+    void queueAlertIndication(const AlertFrame& frame);
+    void pumpAlertRedelivery();                     // notify task only
+    void handleAlertIndicationStatus(bool confirmed);
+    void handleAlertSubscription(uint16_t connHandle, bool indicate);
+
+    PendingAlert pendingAlerts[ALERT_PENDING_MAX];
+    volatile uint8_t alertPendingCount;
+    portMUX_TYPE alertLock; // alarm drain task queues, notify task pumps
+    bool alertIndicationsOn;
+    bool alertInFlight;
+    uint8_t alertInFlightIdx;
+    uint32_t alertInFlightSinceMs;
+
+    // --- Serialized-frame cache (JSON compat path) ------------------------
+    // The legacy path reformats ~10 numbers every BLE_UPDATE_INTERVAL
+    // even when the room is static — the common overnight case. The
+    // serialized body short of the timestamp tail is cached, keyed on
+    // the frame content (which subsumes the state store's generation:
+    // actuator fields ride the frame), so an unchanged tick costs one
+    // memcmp, one memcpy, and formatting a single integer. The binary
+    // path needs no counterpart — a frame is its own wire form, and
+    // the delta encoder already skips unchanged ticks outright.
+    size_t buildSensorJsonCached(const SensorFrame& frame, char* out,
+                                 size_t cap);
+
+    char jsonCacheBody[176];    // through "motion":..., sans timestamp
+    uint16_t jsonCacheBodyLen;
+    SensorFrame jsonCacheKey;   // frame the body was serialized from
+    bool jsonCacheValid;
+
+    // --- Protocol negotiation ---------------------------------------------
+    // CMD_HELLO intersects the app's PROTO_CAP_* bits with ours and
+    // replies a HelloFrame; the result gates delta frames and the JSON
+    // compatibility path, and resets to the firmware defaults when the
+    // last client leaves. A legacy app that only ever writes JSON is
+    // treated as an implicit hello with no capabilities.
+    static void cmdHello(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+
+    uint32_t negotiatedCaps;
+
+    // --- Session authentication -------------------------------------------
+    // CMD_AUTH_START issues a nonce, CMD_AUTH proves PIN knowledge and
+    // derives the session key (SessionAuth). The stretched PIN key is
+    // cached here — the deliberately slow KDF runs once per boot, not
+    // per connection. cmdConnHandle identifies the writing connection
+    // inside handlers, same pattern as cmdArrivalUs.
+    static void cmdAuthStart(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdAuth(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void sendAuthFrame(uint8_t status, const uint8_t* nonce);
+    bool authRequired() const { return devicePin != 0; }
+    const uint8_t* stretchedPinKey();
+
+    uint32_t devicePin;
+    uint32_t authDeviceId;
+    uint8_t stretchedKey[SessionAuth::KEY_LEN];
+    bool haveStretchedKey;
+    uint16_t cmdConnHandle;
+
+    // --- Notification send queue -----------------------------------------
+    // Frames are queued and drained by a dedicated task that retries on
+    // congestion. Sensor frames coalesce: a newer frame replaces an
+    // unsent one instead of queuing behind it.
+    struct PendingNotify {
+        uint8_t data[BLE_PREFERRED_MTU];
+        uint16_t length;
+        bool rateLimited; // periodic frames honor per-client rates
+        uint32_t queuedMs; // enqueue stamp for the per-tier latency stats
+    };
+
+    // Send-queue QoS: one newest-wins slot per tier, drained strictly
+    // in tier order. An alert can never sit behind a command reply or
+    // a telemetry frame (the old single slot let exactly that happen),
+    // and the bulk chunk streams — which bypass these slots — yield to
+    // a queued alert inside notifyChunk().
+    enum NotifyTier : uint8_t {
+        TIER_ALERT = 0,     // alarm frames: drained first, always
+        TIER_CONTROL = 1,   // command replies and event frames
+        TIER_TELEMETRY = 2, // coalescing periodic sensor frames
+        TIER_COUNT = 3,
+    };
+
+    struct NotifyStats {
+        uint32_t sent;
+        uint32_t retries;
+        uint32_t drops;
+        uint32_t coalesced;
+        uint32_t bulkAborts; // chunk sequences aborted by alert pressure
+    };
+
+    // Queue wait per tier (enqueue to handed-to-stack), the number
+    // that proves alerts hold their budget during a history sync.
+    struct TierStats {
+        uint32_t sent;
+        uint32_t lastMs;
+        uint32_t maxMs;
+    };
+
+    static void notifyTaskThunk(void* arg);
+    void notifyTaskLoop();
+    void queueNotification(const uint8_t* data, uint16_t length, bool coalesce);
+    void queueTierNotification(uint8_t tier, const uint8_t* data,
+                               uint16_t length, bool rateLimited);
+    void fanOutNotification(const PendingNotify& frame);
+    bool notifyClientWithRetry(uint16_t connHandle, const uint8_t* data,
+                               uint16_t length);
+    bool notifyClientAttempts(uint16_t connHandle, const uint8_t* data,
+                              uint16_t length);
+    // Bulk-path variant: reserves a contiguous region inside the
+    // host-stack mbuf and calls fill() to serialize straight into it,
+    // skipping the intermediate flat-buffer copy. The stack consumes
+    // the mbuf on every attempt, so fill() must be repeatable; it
+    // returns false to abort the send.
+    bool notifyClientFill(uint16_t connHandle, uint16_t length,
+                          bool (*fill)(void* ctx, uint8_t* dst), void* ctx);
+
+    // Shared chunk framing (ChunkFramer.h): every bulk stream sizes
+    // its chunks with chunkPayloadCap() — the MTU clamp minus trailer
+    // room when the client negotiated PROTO_CAP_FRAMED_CHUNKS — and
+    // sends through notifyChunk(), which seals sequence + CRC-16 onto
+    // the chunk for a framed client and is a plain notify otherwise.
+    uint16_t chunkPayloadCap() const;
+    bool notifyChunk(ChunkFramer& framer, uint16_t connHandle,
+                     uint8_t* chunk, uint16_t length);
+
+    TaskHandle_t notifyTaskHandle;
+    portMUX_TYPE pendingLock;
+    PendingNotify pendingTier[TIER_COUNT];
+    bool pendingTierValid[TIER_COUNT];
+    NotifyStats notifyStats;
+    TierStats tierStats[TIER_COUNT];
+
+    LedPatternEngine* statusLed;
     
     // Callbacks
     void (*fanSpeedCallback)(uint8_t);
     void (*ledBrightnessCallback)(uint8_t);
+    void (*ledFadeCallback)(uint8_t, uint16_t);
     void (*autoModeCallback)(bool);
+    void (*setpointCallback)(int16_t);
+    void (*sceneApplyCallback)(uint8_t);
+    void (*sceneDefineCallback)(uint8_t, const ScenePreset&);
     
-    void handleCommand(String command);
-    String createSensorJSON(float temp, float humidity, int fanSpeed, 
-                           int ledBright, bool motion, float distance);
+    void sendDeltaFrame(const SensorFrame& frame);
+
+    // O(1) opcode dispatch: the table is indexed by opcode. Payload
+    // validation happens first in CommandParser (which owns the
+    // per-opcode minimum sizes); only PARSE_OK frames reach a handler.
+    // New commands register a row here and a minimum there.
+    typedef void (*CommandHandler)(BLEServiceManager* mgr,
+                                   const uint8_t* payload, size_t length);
+    struct CommandEntry {
+        CommandHandler handler;
+        // Deferred commands enqueue to the command task and record
+        // their latency there, when the actuator call returns; inline
+        // commands record at handler return on the NimBLE task.
+        uint8_t deferred;
+    };
+    static const CommandEntry COMMAND_TABLE[CMD_OPCODE_MAX + 1];
+
+    static void cmdSetFan(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdSetLed(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdSetAuto(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdSetSetpoint(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdGetStatus(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdSetLedFade(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdGetBleStats(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdBenchmark(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdSetScene(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdDefineScene(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    // Batched writes: length-prefixed sub-commands dispatched in
+    // sequence from one RX write, acknowledged with one
+    // BatchResultFrame — N settings in one connection interval.
+    static void cmdBatch(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+
+    // --- Throughput benchmark --------------------------------------------
+    // A one-shot task streams sequence-numbered frames as fast as the
+    // stack accepts them, then notifies a BenchReportFrame. Gives
+    // tests/performance/load_test.py a ground truth for tuning
+    // connection parameters.
+    void startBenchmark(uint8_t seconds);
+    static void benchTaskThunk(void* arg);
+    void benchTaskLoop();
+
+    volatile bool benchRunning;
+    uint8_t benchSeconds;
+
+    // --- Soak mode --------------------------------------------------------
+    // CMD_SOAK arms a periodic esp_timer that notifies one
+    // SoakMetricsFrame per interval: a long stress run watches
+    // internal degradation curves (heap, queues, drops) instead of
+    // polling individual diagnostic commands and perturbing the load.
+    static void cmdSoak(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void soakTimerThunk(void* arg);
+    void emitSoakFrame();
+
+    void (*soakSampleCallback)(SoakMetricsFrameHeader&);
+
+    // --- History sync ----------------------------------------------------
+    // CMD_GET_HISTORY spawns a one-shot task that streams the log as
+    // delta-varint chunks (HistoryEncoder) to the first subscribed
+    // client; an empty chunk terminates the stream.
+    static void cmdGetHistory(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdQueryHistory(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void startHistorySync(uint32_t fromSeq);
+    static void historyTaskThunk(void* arg);
+    void historyTaskLoop();
+
+    HistoryLog* historyLog;
+    volatile bool historySyncRunning;
+    uint32_t historyFromSeq;
+
+    // --- Rollup sync ------------------------------------------------------
+    // CMD_GET_ROLLUP streams one granularity's sealed buckets as
+    // verbatim-record chunks — small enough that no delta encoding is
+    // worth it. Same one-shot-task shape as the history sync.
+    static void cmdGetRollup(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void startRollupSync(uint32_t fromSeq, uint8_t kind);
+    static void rollupTaskThunk(void* arg);
+    void rollupTaskLoop();
+
+    RollupStore* rollupStore;
+    volatile bool rollupSyncRunning;
+    uint32_t rollupFromSeq;
+    uint8_t rollupKind;
+
+    // --- Aggregation role -------------------------------------------------
+    // CMD_PEER_COMMAND relays a whitelisted actuator opcode to a peer
+    // unit over the mesh; peer snapshots go the other way through
+    // pushNextPeerFrame().
+    static void cmdPeerCommand(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+
+    EspNowMesh* meshRelay;
+    uint8_t peerPushIdx;
+
+    // --- Chart downsampling -----------------------------------------------
+    // CMD_GET_CHART streams an LTTB-picked subset of a time range —
+    // one record per requested chart pixel — in the same
+    // FRAME_TYPE_HISTORY_CHUNK encoding the full sync uses, so the
+    // app decodes both with one path.
+    static void cmdGetChart(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void startChartSync(uint32_t fromMs, uint32_t toMs, uint16_t points,
+                        uint8_t field);
+    static void chartTaskThunk(void* arg);
+    void chartTaskLoop();
+    static bool chartEmit(void* arg, uint32_t index); // LttbSampler::Emit
+
+    volatile bool chartSyncRunning;
+    uint32_t chartFromMs;
+    uint32_t chartToMs;
+    uint16_t chartPoints;
+    uint8_t chartField;
+
+    // --- Capture export ---------------------------------------------------
+    // CMD_GET_CAPTURES spawns a one-shot task that streams every
+    // CRC-valid capture record as raw CaptureChunkHeader-framed bytes;
+    // the training pipeline decodes them offline.
+    static void cmdGetCaptures(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void startCaptureSync();
+    static void captureTaskThunk(void* arg);
+    void captureTaskLoop();
+
+    CaptureStore* captureStore;
+    volatile bool captureSyncRunning;
+
+    // --- Core-dump export -------------------------------------------------
+    // CMD_GET_COREDUMP spawns a one-shot task that streams the crash
+    // dump image as CoreDumpChunkHeader-framed bytes; bit 0 of the
+    // flags erases the partition after a complete stream.
+    static void cmdGetCmdStats(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    int64_t cmdArrivalUs;
+    uint8_t cmdOpcode;
+
+    static void cmdGetCoreDump(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void startCoreDumpSync(bool eraseAfter);
+    static void coreDumpTaskThunk(void* arg);
+    void coreDumpTaskLoop();
+
+    CoreDumpStore* coreDumpStore;
+    volatile bool coreDumpSyncRunning;
+    bool coreDumpEraseAfter;
+
+    // --- Event trace export -----------------------------------------------
+    // CMD_GET_TRACE spawns a one-shot task that streams the EventTrace
+    // ring oldest-first as TraceChunkHeader-framed records; a chunk with
+    // recordCount 0 ends the stream.
+    static void cmdGetTrace(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void startTraceSync();
+    static void traceTaskThunk(void* arg);
+    void traceTaskLoop();
+
+    volatile bool traceSyncRunning;
+
+    static void cmdGetFlashHealth(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void (*flashHealthCallback)(FlashHealthFrame&);
+
+    static void cmdGetLatency(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdGetProfile(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void (*latencyCallback)(LatencyStatsFrame&, bool);
+
+    static void cmdGetHeap(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdGetSelfTest(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdGetWellness(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdTagged(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdStream(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void (*heapStatsCallback)(HeapStatsFrame&);
+
+    static void cmdGetTasks(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+
+    static void cmdGetBoot(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void (*bootStatsCallback)(BootStatsFrame&);
+
+    static void cmdGetFlashOps(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+
+    // --- Connection-parameter profiles ------------------------------------
+    // The preferred-parameter hints in advertising are just hints; the
+    // phone picks whatever interval it likes. These profiles request
+    // parameters explicitly: interactive (7.5-15 ms) whenever a command
+    // arrives, monitor (100-200 ms with slave latency) after
+    // BLE_CONN_IDLE_RELAX_MS of command silence. CMD_SET_CONN_PROFILE
+    // pins one — the app forces interactive for the length of a slider
+    // drag — until it writes auto again.
+    enum ConnProfile : uint8_t {
+        CONN_PROFILE_INTERACTIVE = 0,
+        CONN_PROFILE_MONITOR = 1,
+    };
+    static void cmdSetConnProfile(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    // Per-client stream shaping: period and field mask for the sending
+    // connection only, enforced in fanOutNotification. Keyframes still
+    // reach partially-masked clients so they keep a resync baseline.
+    static void cmdSubscribe(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void applyConnProfile(ConnProfile profile);
+    void requestConnParams(uint16_t connHandle);
+    void noteCommandActivity();
+    void relaxConnProfileIfIdle();
+
+    ConnProfile connProfile;
+    bool connProfilePinned;     // app override: no automatic switches
+    uint32_t lastCommandMs;
+
+    // --- Adaptive advertising cadence -------------------------------------
+    // Same shape as the connection profiles, one layer down: fast
+    // advertising (20-30 ms) while a connection is likely — after
+    // boot, a disconnect, or fresh motion — then a 1 s beacon once
+    // BLE_ADV_FAST_WINDOW_MS passes without one. Fast cadence costs
+    // real idle power around the clock; slow costs first-connect
+    // latency exactly when someone just walked in. This pays each
+    // price only when it buys something.
+    enum AdvCadence : uint8_t {
+        ADV_CADENCE_FAST = 0,
+        ADV_CADENCE_SLOW = 1,
+    };
+    void applyAdvCadence(AdvCadence cadence);
+    void relaxAdvCadenceIfQuiet();
+
+    AdvCadence advCadence;
+    uint32_t advFastSinceMs;
+
+    // --- Link quality -----------------------------------------------------
+    // CMD_GET_LINK separates "firmware slow" from "radio bad": notify
+    // submit-to-completion latency on one side, per-connection RSSI /
+    // granted interval / disconnect reasons on the other. Disconnect
+    // reasons come from a host GAP event listener, since the server
+    // callback API doesn't surface them.
+    static void cmdGetLink(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static int gapEventThunk(struct ble_gap_event* event, void* arg);
+
+    LatencyHistogram notifyLatency;
+    uint32_t disconnectCount;
+    uint8_t lastDisconnectReason;
+    uint32_t lastDisconnectMs;
+
+    // --- Model transfer --------------------------------------------------
+    // CMD_MODEL_BEGIN/DATA/COMMIT forward to the ModelUpdater; status
+    // frames go back uncoalesced. Data chunks only reply on error so
+    // the transfer isn't paced by the notification path.
+    static void cmdModelBegin(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdModelData(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdModelCommit(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void sendModelStatus(uint8_t status);
+
+    ModelUpdater* modelUpdater;
+    void (*modelCommittedCallback)(void);
+
+    // --- Firmware transfer (BLE OTA) -------------------------------------
+    // Control (CMD_OTA_BEGIN/COMMIT) rides the authenticated command
+    // channel; data chunks arrive on the dedicated characteristic and
+    // go through handleOtaChunk, which — like the model path — only
+    // replies on error. Commit success notifies OTA_OK, then a
+    // one-shot task reboots into the new slot once the frame has had
+    // time to flush.
+    friend class OtaCharacteristicCallbacks;
+    friend class SettingsCharacteristicCallbacks;
+    friend class AlertCharacteristicCallbacks;
+    static void cmdOtaBegin(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    static void cmdOtaCommit(BLEServiceManager* mgr, const uint8_t* payload, size_t length);
+    void handleOtaChunk(const uint8_t* data, size_t length);
+    void sendOtaStatus(uint8_t status);
+    static void rebootTask(void* param);
+
+    FirmwareUpdater* firmwareUpdater;
+
 };
 
 #endif // BLE_SERVICE_H
\ No newline at end of file
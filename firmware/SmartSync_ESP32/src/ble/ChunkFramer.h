@@ -0,0 +1,63 @@
+#ifndef CHUNK_FRAMER_H
+#define CHUNK_FRAMER_H
+
+#include <Arduino.h>
+
+// Shared framing for every chunked TX stream (history/chart, rollup,
+// capture, core dump, trace): a 4-byte trailer — per-stream sequence
+// number plus CRC-16 over header and payload — sealed onto each chunk
+// before it is notified. A dropped or corrupted notification shows up
+// as a sequence gap or a CRC mismatch at the host, which re-requests
+// from the channel's own resume parameter (fromSeq, offset) instead of
+// decoding garbage or silently missing records.
+//
+// The CRC is CRC-16/CCITT through a 256-entry table in flash-cached
+// rodata, 8 bits per lookup — a 244-byte chunk costs ~250 lookups
+// where the bitwise loop costs ~2000 shift/xor rounds, which matters
+// at sustained history-sync rates. 16 bits is plenty for a 247-byte
+// frame already protected by the link layer; the trailer guards
+// against host-buffer truncation and reassembly bugs, not radio noise.
+//
+// Legacy apps never see the trailer: it is sealed only for clients
+// that negotiated PROTO_CAP_FRAMED_CHUNKS via CMD_HELLO.
+class ChunkFramer {
+public:
+    struct __attribute__((packed)) Trailer {
+        uint16_t sequence; // per-stream, starts at 0
+        uint16_t crc;      // CRC-16/CCITT over everything before it
+    };
+
+    static const uint16_t TRAILER_LEN = sizeof(Trailer);
+
+    ChunkFramer() : sequence(0) {}
+
+    // Restarts the sequence; call once per stream.
+    void begin() { sequence = 0; }
+
+    // Writes the trailer at chunk + length using the current sequence
+    // (no advance, so a congestion retry re-seals identically).
+    void sealAt(uint8_t* chunk, uint16_t length) const;
+
+    // sealAt + advance: the buffer-based streams seal once per chunk
+    // and retry the sealed bytes verbatim. Returns the framed length.
+    uint16_t seal(uint8_t* chunk, uint16_t length);
+
+    // The fill-based notify path seals inside the fill callback (which
+    // may rerun per attempt) and advances only on a delivered chunk.
+    void advance() { sequence++; }
+
+    // Host-side/test counterpart: trailer present, CRC good, sequence
+    // out-param. False on a truncated or corrupted chunk.
+    static bool check(const uint8_t* chunk, uint16_t length,
+                      uint16_t& sequenceOut);
+
+    // Table-driven CRC-16/CCITT (poly 0x1021, init 0xFFFF); seeded so
+    // a split range can be folded in pieces.
+    static uint16_t crc16(const uint8_t* data, size_t length,
+                          uint16_t seed = 0xFFFF);
+
+private:
+    uint16_t sequence;
+};
+
+#endif // CHUNK_FRAMER_H
@@ -0,0 +1,188 @@
+#include "CommandParser.h"
+
+#include <string.h>
+#include <ArduinoJson.h>
+
+// ============================================================================
+// BINARY PATH
+// ============================================================================
+// Indexed by opcode; slot 0 is unassigned. 0xFF marks an opcode with
+// no command behind it — parseBinary rejects it before dispatch ever
+// indexes a table with it.
+#define CMD_UNASSIGNED 0xFF
+
+const uint8_t CommandParser::MIN_PAYLOAD[CMD_OPCODE_MAX + 1] = {
+    CMD_UNASSIGNED, // 0x00 (invalid)
+    1,              // CMD_SET_FAN
+    1,              // CMD_SET_LED
+    1,              // CMD_SET_AUTO
+    0,              // CMD_GET_STATUS
+    3,              // CMD_SET_LED_FADE
+    0,              // CMD_GET_BLE_STATS
+    0,              // CMD_BENCHMARK
+    4,              // CMD_GET_HISTORY
+    0,              // CMD_GET_FLASH_HEALTH
+    1,              // CMD_SET_SCENE
+    4,              // CMD_DEFINE_SCENE
+    8,              // CMD_MODEL_BEGIN
+    5,              // CMD_MODEL_DATA
+    0,              // CMD_MODEL_COMMIT
+    0,              // CMD_GET_CAPTURES
+    0,              // CMD_GET_LATENCY
+    0,              // CMD_GET_PROFILE
+    0,              // CMD_GET_HEAP
+    0,              // CMD_GET_TASKS
+    0,              // CMD_GET_BOOT
+    0,              // CMD_GET_FLASH_OPS
+    0,              // CMD_GET_LINK
+    0,              // CMD_GET_COREDUMP
+    0,              // CMD_GET_CMDSTATS
+    0,              // CMD_GET_TRACE
+    2,              // CMD_SET_SETPOINT
+    2,              // CMD_SOAK
+    1,              // CMD_SET_CONN_PROFILE
+    5,              // CMD_HELLO
+    0,              // CMD_AUTH_START
+    8,              // CMD_AUTH (SessionAuth::RESPONSE_LEN)
+    8,              // CMD_OTA_BEGIN
+    0,              // CMD_OTA_COMMIT
+    5,              // CMD_GET_ROLLUP
+    11,             // CMD_GET_CHART
+    5,              // CMD_QUERY_HISTORY
+    7,              // CMD_PEER_COMMAND (mac + inner opcode)
+    2,              // CMD_BATCH (one len byte + one opcode, minimum)
+    3,              // CMD_SUBSCRIBE (period + field mask)
+    0,              // CMD_GET_SELFTEST
+    0,              // CMD_GET_WELLNESS
+    3,              // CMD_TAGGED (tag + one opcode, minimum)
+    3,              // CMD_STREAM (seq + one level setter, minimum)
+};
+
+int CommandParser::minPayload(uint8_t opcode) {
+    if (opcode > CMD_OPCODE_MAX || MIN_PAYLOAD[opcode] == CMD_UNASSIGNED) {
+        return -1;
+    }
+    return MIN_PAYLOAD[opcode];
+}
+
+bool CommandParser::requiresAuth(uint8_t opcode) {
+    // Everything that changes what the unit does or stores. The GET_*
+    // diagnostics, the hello/profile negotiation and the handshake
+    // opcodes themselves stay open — they leak nothing a passive
+    // scanner doesn't already see in advertising.
+    switch (opcode) {
+        case CMD_SET_FAN:
+        case CMD_SET_LED:
+        case CMD_SET_AUTO:
+        case CMD_SET_LED_FADE:
+        case CMD_BENCHMARK:
+        case CMD_SET_SCENE:
+        case CMD_DEFINE_SCENE:
+        case CMD_MODEL_BEGIN:
+        case CMD_MODEL_DATA:
+        case CMD_MODEL_COMMIT:
+        case CMD_SET_SETPOINT:
+        case CMD_SOAK:
+        case CMD_OTA_BEGIN:
+        case CMD_OTA_COMMIT:
+        case CMD_PEER_COMMAND: // mutates a *peer* — same gate
+        case CMD_BATCH:        // may carry any of the above; one MAC
+                               // covers the whole batch
+        case CMD_TAGGED:       // may wrap any of the above; the MAC
+                               // covers the wrapped command
+        case CMD_STREAM:       // wraps the level setters; each lossy
+                               // update carries its own MAC
+            return true;
+    }
+    return false;
+}
+
+CommandParser::ParseStatus CommandParser::parseBinary(const uint8_t* data,
+                                                      size_t length,
+                                                      CommandFrame& out) {
+    if (length == 0) {
+        return PARSE_EMPTY;
+    }
+    if (data[0] != CMD_MAGIC) {
+        return PARSE_NOT_BINARY;
+    }
+    if (length < 2) {
+        return PARSE_EMPTY; // magic with no opcode
+    }
+    return parseInner(data + 1, length - 1, out);
+}
+
+CommandParser::ParseStatus CommandParser::parseInner(const uint8_t* data,
+                                                     size_t length,
+                                                     CommandFrame& out) {
+    if (length == 0) {
+        return PARSE_EMPTY;
+    }
+
+    uint8_t opcode = data[0];
+    int required = minPayload(opcode);
+    if (required < 0) {
+        return PARSE_BAD_OPCODE;
+    }
+
+    size_t payloadLen = length - 1;
+    if (payloadLen < (size_t)required) {
+        return PARSE_SHORT_PAYLOAD;
+    }
+
+    out.opcode = opcode;
+    out.payload = data + 1;
+    out.length = payloadLen;
+    return PARSE_OK;
+}
+
+// ============================================================================
+// LEGACY JSON PATH
+// ============================================================================
+// Command names the first app generation sent, mapped onto the binary
+// opcode space so BLEService dispatches both paths the same way.
+struct JsonCommandName {
+    const char* name;
+    uint8_t opcode;
+};
+
+static const JsonCommandName JSON_COMMANDS[] = {
+    { "SET_FAN", CMD_SET_FAN },
+    { "SET_LED", CMD_SET_LED },
+    { "SET_LED_FADE", CMD_SET_LED_FADE },
+    { "SET_AUTO", CMD_SET_AUTO },
+    { "BENCHMARK", CMD_BENCHMARK },
+    { "GET_STATUS", CMD_GET_STATUS },
+};
+
+bool CommandParser::parseJson(const char* data, size_t length,
+                              JsonCommand& out) {
+    // Const input makes ArduinoJson copy strings into the document's
+    // own stack pool instead of mutating the attribute buffer.
+    StaticJsonDocument<256> doc;
+    DeserializationError error = deserializeJson(doc, data, length);
+    if (error) {
+        return false;
+    }
+
+    // A payload without "cmd" (or with a non-string one) must fail
+    // cleanly: any phone in range can write this characteristic.
+    const char* cmd = doc["cmd"];
+    if (cmd == nullptr) {
+        return false;
+    }
+
+    for (size_t i = 0; i < sizeof(JSON_COMMANDS) / sizeof(JSON_COMMANDS[0]);
+         i++) {
+        if (strcmp(cmd, JSON_COMMANDS[i].name) == 0) {
+            out.opcode = JSON_COMMANDS[i].opcode;
+            out.value = doc["value"];
+            out.durationMs = doc["duration"] |
+                (out.opcode == CMD_BENCHMARK
+                     ? (uint16_t)BLE_BENCH_DEFAULT_SECONDS
+                     : (uint16_t)LED_FADE_DEFAULT_MS);
+            return true;
+        }
+    }
+    return false;
+}
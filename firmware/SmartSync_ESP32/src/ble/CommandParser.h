@@ -0,0 +1,172 @@
+#ifndef COMMAND_PARSER_H
+#define COMMAND_PARSER_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// The RX command protocol and its validation front-end, separated from
+// the NimBLE plumbing so it builds for the host: any phone in range
+// can write arbitrary bytes to BLE_CHARACTERISTIC_UUID_RX, so this is
+// the firmware's network-facing attack surface, and the fuzz harness
+// (test/fuzz, scripts/fuzz_command.sh) hammers exactly these
+// functions. BLEService routes every RX write through here before any
+// handler runs; nothing downstream sees a frame this file rejected.
+
+// Binary command format on BLE_CHARACTERISTIC_UUID_RX:
+//   [CMD_MAGIC][opcode][payload...]
+// parsed in place from the attribute buffer — no copy, no heap, no JSON.
+// CMD_MAGIC can never start a JSON document, so legacy app versions that
+// still write JSON are routed to the compatibility parser transparently.
+#define CMD_MAGIC 0xC5
+
+enum CommandOpcode : uint8_t {
+    CMD_SET_FAN = 0x01,      // payload: uint8 speed
+    CMD_SET_LED = 0x02,      // payload: uint8 brightness
+    CMD_SET_AUTO = 0x03,     // payload: uint8 bool
+    CMD_GET_STATUS = 0x04,   // no payload
+    CMD_SET_LED_FADE = 0x05, // payload: uint8 target, uint16 duration ms
+    CMD_GET_BLE_STATS = 0x06, // no payload; replies with NotifyStatsFrame
+    CMD_BENCHMARK = 0x07,    // payload: uint8 seconds (0 = default)
+    CMD_GET_HISTORY = 0x08,  // payload: uint32 fromSeq (LE)
+    CMD_GET_FLASH_HEALTH = 0x09, // no payload; replies FlashHealthFrame
+    CMD_SET_SCENE = 0x0A,    // payload: uint8 scene index
+    CMD_DEFINE_SCENE = 0x0B, // payload: uint8 index, uint8 fan, uint8 led,
+                             //          uint8 auto, char name[0-8]
+    CMD_MODEL_BEGIN = 0x0C,  // payload: uint32 totalSize, uint32 crc (LE)
+    CMD_MODEL_DATA = 0x0D,   // payload: uint32 offset (LE), bytes
+    CMD_MODEL_COMMIT = 0x0E, // no payload; replies ModelStatusFrame
+    CMD_GET_CAPTURES = 0x0F, // no payload; streams capture records
+    CMD_GET_LATENCY = 0x10,  // payload: uint8 flags (bit 0: reset)
+    CMD_GET_PROFILE = 0x11,  // payload: uint8 flags (bit 0: reset)
+    CMD_GET_HEAP = 0x12,     // no payload; replies HeapStatsFrame
+    CMD_GET_TASKS = 0x13,    // no payload; replies TaskStatsFrame
+    CMD_GET_BOOT = 0x14,     // no payload; replies BootStatsFrame
+    CMD_GET_FLASH_OPS = 0x15, // payload: uint8 flags (bit 0: reset)
+    CMD_GET_LINK = 0x16,     // no payload; replies LinkQualityFrame
+    CMD_GET_COREDUMP = 0x17, // payload: uint8 flags (bit 0: erase after)
+    CMD_GET_CMDSTATS = 0x18, // payload: uint8 flags (bit 0: reset)
+    CMD_GET_TRACE = 0x19,    // no payload; streams TraceChunkHeader frames
+    CMD_SET_SETPOINT = 0x1A, // payload: int16 centi-°C (LE); 0 = default
+    CMD_SOAK = 0x1B,         // payload: uint16 interval s (LE); 0 = stop
+    CMD_SET_CONN_PROFILE = 0x1C, // payload: uint8 (0 = auto,
+                             //          1 = pin interactive, 2 = pin monitor)
+    CMD_HELLO = 0x1D,        // payload: uint8 proto version,
+                             //          uint32 PROTO_CAP_* bits (LE)
+    CMD_AUTH_START = 0x1E,   // no payload; replies AuthFrame challenge
+    CMD_AUTH = 0x1F,         // payload: uint8 response[8] (SessionAuth)
+    CMD_OTA_BEGIN = 0x20,    // payload: uint32 totalSize, uint32 crc (LE);
+                             //          replies OtaStatusFrame
+    CMD_OTA_COMMIT = 0x21,   // no payload; replies OtaStatusFrame,
+                             //          reboots on success
+    CMD_GET_ROLLUP = 0x22,   // payload: uint32 fromSeq (LE), uint8 kind
+                             //          (RollupStore::Kind); streams
+                             //          FRAME_TYPE_ROLLUP_CHUNK
+    CMD_GET_CHART = 0x23,    // payload: uint32 fromMs, uint32 toMs,
+                             //          uint16 points, uint8 field (LE);
+                             //          streams LTTB-picked records as
+                             //          FRAME_TYPE_HISTORY_CHUNK
+    CMD_QUERY_HISTORY = 0x24, // payload: uint32 fromSeq, uint8 count,
+                             //          count × predicates
+                             //          (HistoryFilter); streams
+                             //          matching records as
+                             //          FRAME_TYPE_HISTORY_CHUNK
+    CMD_PEER_COMMAND = 0x25, // payload: uint8 mac[6], uint8 opcode,
+                             //          opcode's payload; relayed over
+                             //          ESP-NOW to the peer unit
+                             //          (aggregation role, EspNowMesh)
+    CMD_BATCH = 0x26,        // payload: repeated [uint8 len][opcode]
+                             //          [payload...] entries, dispatched
+                             //          in order; replies one
+                             //          BatchResultFrame. Nested batches
+                             //          are rejected.
+    CMD_SUBSCRIBE = 0x27,    // payload: uint16 period ms (LE; 0 =
+                             //          BLE_UPDATE_INTERVAL), uint8
+                             //          SensorFieldBits mask (0 = alerts
+                             //          only); applies to the sending
+                             //          connection's sensor stream
+    CMD_GET_SELFTEST = 0x28, // no payload; replies SelfTestFrame
+    CMD_GET_WELLNESS = 0x29, // no payload; replies WellnessFrame
+    CMD_TAGGED = 0x2A,       // payload: uint16 client tag (LE), then one
+                             //          [opcode][payload...] entry
+                             //          (parseInner form); dispatches it
+                             //          and replies CmdAckFrame echoing
+                             //          the tag. Composite opcodes
+                             //          (BATCH, TAGGED) are rejected.
+    CMD_STREAM = 0x2B,       // payload: uint8 seq, then one
+                             //          [opcode][payload...] entry
+                             //          (parseInner form; level
+                             //          setters only). Sent as
+                             //          write-without-response during
+                             //          a slider drag; newest seq
+                             //          wins, stale ones drop, and no
+                             //          reply is sent — the release
+                             //          sends the plain acknowledged
+                             //          opcode as the commit.
+    CMD_OPCODE_MAX = CMD_STREAM,
+};
+
+class CommandParser {
+public:
+    enum ParseStatus : uint8_t {
+        PARSE_OK = 0,
+        PARSE_NOT_BINARY,    // no CMD_MAGIC: route to the legacy JSON path
+        PARSE_EMPTY,         // magic with nothing behind it
+        PARSE_BAD_OPCODE,    // out of range or unassigned
+        PARSE_SHORT_PAYLOAD, // below the opcode's declared minimum
+    };
+
+    // A validated binary command: the opcode is assigned and the
+    // payload view (into the caller's buffer) meets its minimum
+    // length. Handlers may rely on both.
+    struct CommandFrame {
+        uint8_t opcode;
+        const uint8_t* payload;
+        size_t length;
+    };
+
+    // Validates one raw RX write against the protocol. PARSE_OK fills
+    // `out`; every other status means no handler may run. Rejections
+    // happen here, in bounded code with no side effects — malformed
+    // bytes from an unauthenticated peer never reach dispatch.
+    static ParseStatus parseBinary(const uint8_t* data, size_t length,
+                                   CommandFrame& out);
+
+    // Validates one magic-less [opcode][payload...] entry — the form
+    // batch sub-commands take on the wire. parseBinary is this plus
+    // the magic check, so both paths share one validation body and
+    // the fuzz harness covers batch entries through it.
+    static ParseStatus parseInner(const uint8_t* data, size_t length,
+                                  CommandFrame& out);
+
+    // Minimum payload bytes for an opcode, or -1 when the opcode is
+    // not assigned. parseBinary enforces it; the dispatch table in
+    // BLEService trusts it.
+    static int minPayload(uint8_t opcode);
+
+    // Whether an opcode mutates device state and therefore needs a
+    // per-command MAC once a device PIN is set (SessionAuth). Reads
+    // and the auth handshake itself stay open; the policy lives here,
+    // next to the opcode space, so host tests and the fuzz harness
+    // cover it.
+    static bool requiresAuth(uint8_t opcode);
+
+    // A legacy JSON command, normalized onto the binary opcode space.
+    // value/durationMs carry the decoded arguments for the opcodes
+    // that take them (defaults already applied).
+    struct JsonCommand {
+        uint8_t opcode;
+        uint8_t value;
+        uint16_t durationMs;
+    };
+
+    // Decodes a legacy JSON write ({"cmd":"SET_FAN","value":128}).
+    // Returns false — with no side effects — on malformed JSON, a
+    // missing "cmd" key, or an unknown command name.
+    static bool parseJson(const char* data, size_t length,
+                          JsonCommand& out);
+
+private:
+    static const uint8_t MIN_PAYLOAD[CMD_OPCODE_MAX + 1];
+};
+
+#endif // COMMAND_PARSER_H
@@ -0,0 +1,72 @@
+#include "HistoryEncoder.h"
+
+// Header + firstSeq.
+#define CHUNK_HEADER_LEN 8
+#define COUNT_OFFSET 3
+#define FIRST_SEQ_OFFSET 4
+
+// A delta record can never exceed four 5-byte varints plus flags.
+#define WORST_CASE_DELTA (4 * 5 + 1)
+#define FIRST_RECORD_LEN 11
+
+void HistoryEncoder::beginChunk(uint8_t* chunkBuf, uint16_t chunkCap) {
+    buf = chunkBuf;
+    cap = chunkCap;
+    len = CHUNK_HEADER_LEN;
+    count = 0;
+
+    buf[0] = FRAME_MAGIC;
+    buf[1] = SENSOR_FRAME_VERSION;
+    buf[2] = FRAME_TYPE_HISTORY_CHUNK;
+    buf[COUNT_OFFSET] = 0;
+    memset(&buf[FIRST_SEQ_OFFSET], 0, 4);
+}
+
+bool HistoryEncoder::addRecord(const HistoryRecord& record) {
+    if (count == 0) {
+        if (len + FIRST_RECORD_LEN > cap) {
+            return false;
+        }
+
+        memcpy(&buf[FIRST_SEQ_OFFSET], &record.sequence, 4);
+        memcpy(&buf[len], &record.timestampMs, 4); len += 4;
+        memcpy(&buf[len], &record.temperature, 2); len += 2;
+        memcpy(&buf[len], &record.humidity, 2); len += 2;
+        memcpy(&buf[len], &record.distance, 2); len += 2;
+        buf[len++] = record.flags;
+    } else {
+        if (len + WORST_CASE_DELTA > cap || count == 255) {
+            return false;
+        }
+
+        putVarint(record.timestampMs - prev.timestampMs);
+        putSignedVarint((int32_t)record.temperature - prev.temperature);
+        putSignedVarint((int32_t)record.humidity - prev.humidity);
+        putSignedVarint((int32_t)record.distance - prev.distance);
+        buf[len++] = record.flags;
+    }
+
+    prev = record;
+    count++;
+    return true;
+}
+
+uint16_t HistoryEncoder::finishChunk() {
+    buf[COUNT_OFFSET] = count;
+    return len;
+}
+
+// LEB128: 7 data bits per byte, top bit marks continuation.
+void HistoryEncoder::putVarint(uint32_t value) {
+    while (value >= 0x80) {
+        buf[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buf[len++] = (uint8_t)value;
+}
+
+// ZigZag maps small negative deltas onto small unsigned values so they
+// still encode in one byte.
+void HistoryEncoder::putSignedVarint(int32_t value) {
+    putVarint(((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
@@ -0,0 +1,50 @@
+#ifndef HISTORY_ENCODER_H
+#define HISTORY_ENCODER_H
+
+#include <Arduino.h>
+#include "../storage/HistoryLog.h"
+#include "SensorFrame.h"
+
+// Packs history records into MTU-sized chunks for BLE sync. The first
+// record in a chunk is stored verbatim; every following record is
+// zigzag-varint deltas against its predecessor. Consecutive 10 s room
+// samples rarely differ by more than tenths of a degree, so most
+// deltas fit one byte and a chunk carries an order of magnitude more
+// records than the fixed 16-byte encoding would.
+//
+// Chunk layout (little-endian):
+//   [FRAME_MAGIC][SENSOR_FRAME_VERSION][FRAME_TYPE_HISTORY_CHUNK][count]
+//   [uint32 firstSeq]
+//   first record:   uint32 timestampMs, int16 temp, uint16 hum,
+//                   uint16 dist, uint8 flags (verbatim)
+//   later records:  varint Δtimestamp, svarint Δtemp, svarint Δhum,
+//                   svarint Δdist, uint8 flags
+// count == 0 marks the end of the stream.
+
+class HistoryEncoder {
+public:
+    // Starts a chunk in buf (cap bytes). firstSeq is patched in when
+    // the first record is added.
+    void beginChunk(uint8_t* buf, uint16_t cap);
+
+    // Appends one record; false when the worst-case encoding would not
+    // fit (finish the chunk and start a new one).
+    bool addRecord(const HistoryRecord& record);
+
+    // Patches the record count and returns the chunk length in bytes.
+    uint16_t finishChunk();
+
+    uint8_t recordCount() const { return count; }
+
+private:
+    uint8_t* buf;
+    uint16_t cap;
+    uint16_t len;
+    uint8_t count;
+    HistoryRecord prev;
+
+    void putVarint(uint32_t value);
+    void putSignedVarint(int32_t value);
+};
+
+#endif // HISTORY_ENCODER_H
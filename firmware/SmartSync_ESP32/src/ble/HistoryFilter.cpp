@@ -0,0 +1,81 @@
+#include "HistoryFilter.h"
+
+#include <string.h>
+
+HistoryFilter::HistoryFilter()
+    : predicateCount(0),
+      usable(true) {
+}
+
+void HistoryFilter::clear() {
+    predicateCount = 0;
+    usable = true;
+}
+
+bool HistoryFilter::parse(const uint8_t* payload, size_t length) {
+    predicateCount = 0;
+    usable = false;
+
+    if (length < 1) {
+        return false;
+    }
+    uint8_t declared = payload[0];
+    if (declared > MAX_PREDICATES ||
+        length < (size_t)1 + (size_t)declared * PREDICATE_LEN) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < declared; i++) {
+        const uint8_t* entry = payload + 1 + i * PREDICATE_LEN;
+        if (entry[0] > FIELD_MAX || entry[1] > OP_MAX) {
+            return false;
+        }
+        int16_t raw;
+        memcpy(&raw, entry + 2, sizeof(raw));
+
+        Predicate& pred = predicates[i];
+        pred.field = entry[0];
+        pred.op = entry[1];
+        // Signed only for temperature; the unsigned fields widen via
+        // the uint16 reinterpretation so 0x8000+ compares correctly.
+        pred.value = (entry[0] == FIELD_TEMPERATURE)
+            ? (int32_t)raw
+            : (int32_t)(uint16_t)raw;
+    }
+
+    predicateCount = declared;
+    usable = true;
+    return true;
+}
+
+bool HistoryFilter::matches(const HistoryRecord& record) const {
+    if (!usable) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < predicateCount; i++) {
+        const Predicate& pred = predicates[i];
+
+        int32_t field;
+        switch (pred.field) {
+            case FIELD_TEMPERATURE: field = record.temperature; break;
+            case FIELD_HUMIDITY:    field = record.humidity; break;
+            case FIELD_DISTANCE:    field = record.distance; break;
+            default:                field = record.flags; break;
+        }
+
+        bool hold;
+        switch (pred.op) {
+            case OP_LT:        hold = field < pred.value; break;
+            case OP_GT:        hold = field > pred.value; break;
+            case OP_EQ:        hold = field == pred.value; break;
+            case OP_NE:        hold = field != pred.value; break;
+            case OP_MASK_ANY:  hold = (field & pred.value) != 0; break;
+            default:           hold = (field & pred.value) == 0; break;
+        }
+        if (!hold) {
+            return false;
+        }
+    }
+    return true;
+}
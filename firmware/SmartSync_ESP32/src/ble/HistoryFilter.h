@@ -0,0 +1,71 @@
+#ifndef HISTORY_FILTER_H
+#define HISTORY_FILTER_H
+
+#include <Arduino.h>
+#include "../storage/HistoryLog.h"
+
+// Predicate pushdown for history queries: "all intervals with motion"
+// or "temperature above 28 °C" filter on-device, during the
+// sequential scan over mapped flash, instead of shipping the whole
+// range for the app to discard. The scan is memory-bandwidth-cheap;
+// the radio is the scarce resource, so a selective predicate saves
+// 10-100x on transfer.
+//
+// Wire format (CMD_QUERY_HISTORY payload, after fromSeq):
+//   [uint8 count][count × {uint8 field, uint8 op, int16 value (LE)}]
+// Predicates AND together. Like CommandParser, parse() validates
+// attacker-controlled bytes in bounded code with no side effects —
+// the fuzz-adjacent contract for anything decoded off the RX
+// characteristic — and a filter that fails to parse matches nothing.
+class HistoryFilter {
+public:
+    enum Field : uint8_t {
+        FIELD_TEMPERATURE = 0, // °C × 100, signed
+        FIELD_HUMIDITY = 1,    // %RH × 100
+        FIELD_DISTANCE = 2,    // cm × 10
+        FIELD_FLAGS = 3,       // SensorFrameFlags byte
+        FIELD_MAX = FIELD_FLAGS,
+    };
+
+    enum Op : uint8_t {
+        OP_LT = 0,
+        OP_GT = 1,
+        OP_EQ = 2,
+        OP_NE = 3,
+        OP_MASK_ANY = 4,  // (field & value) != 0 — "motion set"
+        OP_MASK_NONE = 5, // (field & value) == 0 — "no fault"
+        OP_MAX = OP_MASK_NONE,
+    };
+
+    static const uint8_t MAX_PREDICATES = 4;
+    static const uint8_t PREDICATE_LEN = 4; // field, op, int16 value
+
+    HistoryFilter();
+
+    // Decodes a predicate list. False (and an unusable filter) on a
+    // short buffer, an unknown field or op, or too many predicates.
+    bool parse(const uint8_t* payload, size_t length);
+
+    // Everything passes; the unfiltered CMD_GET_HISTORY path.
+    void clear();
+
+    bool valid() const { return usable; }
+    uint8_t count() const { return predicateCount; }
+
+    // All predicates hold (vacuously true when empty); false for a
+    // filter that never parsed.
+    bool matches(const HistoryRecord& record) const;
+
+private:
+    struct Predicate {
+        int32_t value;
+        uint8_t field;
+        uint8_t op;
+    };
+
+    Predicate predicates[MAX_PREDICATES];
+    uint8_t predicateCount;
+    bool usable;
+};
+
+#endif // HISTORY_FILTER_H
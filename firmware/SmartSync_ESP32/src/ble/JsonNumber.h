@@ -0,0 +1,58 @@
+#ifndef JSON_NUMBER_H
+#define JSON_NUMBER_H
+
+#include <Arduino.h>
+
+// Fixed-point number formatting for the legacy JSON compatibility
+// path (createSensorJSON). Every numeric field there is either a
+// plain integer or a one-decimal reading whose wire form is already a
+// scaled integer, so generic printf float conversion — built for
+// shortest-round-trip doubles — is an order of magnitude more work
+// than the divide-and-carry below. Overloads on the schema expression
+// type pick the right emitter at compile time.
+//
+// No bounds parameter: callers budget JSON_NUMBER_MAX_LEN per value.
+
+// Worst case "-214748364.8": sign, ten digits, decimal point.
+#define JSON_NUMBER_MAX_LEN 12
+
+static inline char* jsonAppendUint(char* p, uint32_t v) {
+    char tmp[10];
+    uint8_t n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    while (n > 0) {
+        *p++ = tmp[--n];
+    }
+    return p;
+}
+
+static inline char* jsonAppendNumber(char* p, unsigned v) {
+    return jsonAppendUint(p, v);
+}
+
+static inline char* jsonAppendNumber(char* p, int v) {
+    if (v < 0) {
+        *p++ = '-';
+        return jsonAppendUint(p, (uint32_t)(-(int64_t)v));
+    }
+    return jsonAppendUint(p, (uint32_t)v);
+}
+
+// One-decimal field ("%.1f" replacement): scale to tenths rounding
+// half away from zero, emit integer part, point, tenth digit.
+static inline char* jsonAppendNumber(char* p, float v) {
+    int32_t tenths = (int32_t)(v * 10.0f + (v >= 0.0f ? 0.5f : -0.5f));
+    if (tenths < 0) {
+        *p++ = '-';
+        tenths = -tenths;
+    }
+    p = jsonAppendUint(p, (uint32_t)(tenths / 10));
+    *p++ = '.';
+    *p++ = (char)('0' + tenths % 10);
+    return p;
+}
+
+#endif // JSON_NUMBER_H
@@ -0,0 +1,119 @@
+#include "LttbSampler.h"
+
+bool LttbSampler::bucketAverage(RecordAt recordAt, void* recordCtx,
+                                uint32_t start, uint32_t end,
+                                int64_t& avgX, int64_t& avgY) {
+    int64_t sumX = 0;
+    int64_t sumY = 0;
+    int64_t x, y;
+    for (uint32_t i = start; i < end; i++) {
+        if (!recordAt(recordCtx, i, x, y)) {
+            return false;
+        }
+        sumX += x;
+        sumY += y;
+    }
+    uint32_t count = end - start;
+    avgX = sumX / count;
+    avgY = sumY / count;
+    return true;
+}
+
+uint32_t LttbSampler::select(RecordAt recordAt, void* recordCtx, uint32_t n,
+                             uint32_t target, Emit emit, void* emitCtx) {
+    if (n == 0 || target == 0) {
+        return 0;
+    }
+
+    // Nothing to decimate: the range already fits the chart.
+    if (n <= target) {
+        uint32_t emitted = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            if (!emit(emitCtx, i)) {
+                break;
+            }
+            emitted++;
+        }
+        return emitted;
+    }
+
+    // Fewer points than the algorithm's two endpoints plus a bucket:
+    // just the range edges.
+    if (target < 3) {
+        if (!emit(emitCtx, 0)) {
+            return 0;
+        }
+        if (target >= 2 && emit(emitCtx, n - 1)) {
+            return 2;
+        }
+        return 1;
+    }
+
+    if (!emit(emitCtx, 0)) {
+        return 0;
+    }
+    uint32_t emitted = 1;
+
+    int64_t prevX, prevY;
+    if (!recordAt(recordCtx, 0, prevX, prevY)) {
+        return emitted;
+    }
+
+    // Interior bucket b spans [1 + b*(n-2)/B, 1 + (b+1)*(n-2)/B) —
+    // integer boundaries, off by at most one record from the real
+    // division, invisible at chart resolution.
+    uint32_t buckets = target - 2;
+    for (uint32_t b = 0; b < buckets; b++) {
+        uint32_t start = 1 + (uint32_t)((uint64_t)b * (n - 2) / buckets);
+        uint32_t end = 1 + (uint32_t)((uint64_t)(b + 1) * (n - 2) / buckets);
+
+        // The next bucket's centroid anchors the triangle; the final
+        // bucket uses the last record (always selected) instead.
+        int64_t nextX, nextY;
+        if (b + 1 < buckets) {
+            uint32_t nextEnd =
+                1 + (uint32_t)((uint64_t)(b + 2) * (n - 2) / buckets);
+            if (!bucketAverage(recordAt, recordCtx, end, nextEnd,
+                               nextX, nextY)) {
+                return emitted;
+            }
+        } else if (!recordAt(recordCtx, n - 1, nextX, nextY)) {
+            return emitted;
+        }
+
+        uint32_t bestIdx = start;
+        int64_t bestArea = -1;
+        int64_t bestX = prevX;
+        int64_t bestY = prevY;
+        int64_t x, y;
+        for (uint32_t i = start; i < end; i++) {
+            if (!recordAt(recordCtx, i, x, y)) {
+                return emitted;
+            }
+            // Twice the triangle area, sign dropped.
+            int64_t area = (prevX - nextX) * (y - prevY) -
+                           (prevX - x) * (nextY - prevY);
+            if (area < 0) {
+                area = -area;
+            }
+            if (area > bestArea) {
+                bestArea = area;
+                bestIdx = i;
+                bestX = x;
+                bestY = y;
+            }
+        }
+
+        if (!emit(emitCtx, bestIdx)) {
+            return emitted;
+        }
+        emitted++;
+        prevX = bestX;
+        prevY = bestY;
+    }
+
+    if (emit(emitCtx, n - 1)) {
+        emitted++;
+    }
+    return emitted;
+}
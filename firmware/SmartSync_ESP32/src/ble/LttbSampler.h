@@ -0,0 +1,46 @@
+#ifndef LTTB_SAMPLER_H
+#define LTTB_SAMPLER_H
+
+#include <Arduino.h>
+
+// Largest-Triangle-Three-Buckets downsampling for chart queries: out
+// of n records the sampler picks the `target` points that best keep
+// the series' visual shape — peaks, troughs and slope changes survive
+// where naive striding would alias them away. The app asks for its
+// chart pixel width and BLE carries exactly that many records,
+// typically a 50-100x reduction against shipping the raw range.
+//
+// The classic algorithm, kept streaming: both endpoints are always
+// selected, the interior splits into target-2 equal buckets, and each
+// bucket contributes the point forming the largest triangle with the
+// previously selected point and the next bucket's average. Records
+// are pulled through an accessor (a memory-mapped flash dereference
+// on device, an array in the host tests), each bucket is walked twice
+// (once inside the next-average pass, once to score), and selections
+// are emitted in index order — no buffer of the series, no buffer of
+// the result. Areas are 64-bit: millisecond x-deltas times
+// fixed-point y-deltas overflow 32 bits comfortably.
+class LttbSampler {
+public:
+    // Pulls record `index` (0-based within the queried range) into
+    // x/y. Returning false aborts the run (a reader losing its race
+    // against the writer's sector erase).
+    typedef bool (*RecordAt)(void* ctx, uint32_t index,
+                             int64_t& x, int64_t& y);
+
+    // Receives each selected index, ascending. Returning false stops
+    // the run early (congested client).
+    typedef bool (*Emit)(void* ctx, uint32_t index);
+
+    // Downsamples n records to at most `target` selections (everything
+    // when n <= target). Returns the number of indices emitted.
+    static uint32_t select(RecordAt recordAt, void* recordCtx, uint32_t n,
+                           uint32_t target, Emit emit, void* emitCtx);
+
+private:
+    static bool bucketAverage(RecordAt recordAt, void* recordCtx,
+                              uint32_t start, uint32_t end,
+                              int64_t& avgX, int64_t& avgY);
+};
+
+#endif // LTTB_SAMPLER_H
@@ -0,0 +1,624 @@
+#ifndef SENSOR_FRAME_H
+#define SENSOR_FRAME_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Packed binary frames notified on BLE_CHARACTERISTIC_UUID_TX. All
+// fields are little-endian (native on both ESP32 and the phones we
+// target). The header is fixed so future frame types can share the
+// characteristic: readers switch on (magic, version, type).
+
+#define FRAME_MAGIC 0xA5
+#define SENSOR_FRAME_VERSION 3 // v2: occupancy byte; v3: fan RPM
+
+enum FrameType : uint8_t {
+    FRAME_TYPE_SENSOR = 0x01,
+    FRAME_TYPE_SENSOR_DELTA = 0x02,
+    FRAME_TYPE_NOTIFY_STATS = 0x03,
+    FRAME_TYPE_BENCH_DATA = 0x04,
+    FRAME_TYPE_BENCH_REPORT = 0x05,
+    FRAME_TYPE_HISTORY_CHUNK = 0x06, // layout in HistoryEncoder.h
+    FRAME_TYPE_FLASH_HEALTH = 0x07,
+    FRAME_TYPE_ALERT = 0x08,
+    FRAME_TYPE_MODEL_STATUS = 0x09,
+    FRAME_TYPE_CAPTURE_CHUNK = 0x0A,
+    FRAME_TYPE_LATENCY_STATS = 0x0B,
+    FRAME_TYPE_PROFILE = 0x0C,
+    FRAME_TYPE_HEAP_STATS = 0x0D,
+    FRAME_TYPE_TASK_STATS = 0x0E,
+    FRAME_TYPE_BOOT_STATS = 0x0F,
+    FRAME_TYPE_FLASH_OPS = 0x10,
+    FRAME_TYPE_LINK_QUALITY = 0x11,
+    FRAME_TYPE_COREDUMP_CHUNK = 0x12,
+    FRAME_TYPE_CMD_LATENCY = 0x13,
+    FRAME_TYPE_TRACE_CHUNK = 0x14,
+    FRAME_TYPE_SOAK_METRICS = 0x15,
+    FRAME_TYPE_HELLO = 0x16,
+    FRAME_TYPE_AUTH = 0x17,
+    FRAME_TYPE_OTA_STATUS = 0x18,
+    FRAME_TYPE_ROLLUP_CHUNK = 0x19, // RollupChunkHeader + RollupRecords
+    FRAME_TYPE_PEER_SENSOR = 0x1A,  // aggregation: one peer unit's snapshot
+    FRAME_TYPE_BATCH_RESULT = 0x1B, // combined ack for one CMD_BATCH
+    FRAME_TYPE_CATCHUP_CHUNK = 0x1C, // reconnect backlog burst of
+                                     // recent SensorFrames
+    FRAME_TYPE_SELFTEST = 0x1D,      // background self-test verdicts
+    FRAME_TYPE_ZONE_EVENT = 0x1E,    // distance zone transition
+    FRAME_TYPE_WELLNESS = 0x1F,      // sealed daily wellness summary
+    FRAME_TYPE_CMD_ACK = 0x20,       // tagged-command completion
+};
+
+enum SensorFrameFlags : uint8_t {
+    SENSOR_FLAG_MOTION = 0x01,
+    SENSOR_FLAG_FAULT = 0x02,    // a sensor channel is quarantined
+    SENSOR_FLAG_COREDUMP = 0x04, // a crash dump awaits CMD_GET_COREDUMP
+    SENSOR_FLAG_STALE = 0x08,    // pre-reset snapshot, not a live read
+};
+
+// Delta frame field bitmap. A delta frame is the 4-byte header, the
+// bitmap byte, then the changed fields only, packed in bit order with
+// the same encodings as SensorFrame.
+enum SensorFieldBits : uint8_t {
+    FIELD_TEMPERATURE = 0x01, // int16, °C × 100
+    FIELD_HUMIDITY = 0x02,    // uint16, %RH × 100
+    FIELD_FAN_SPEED = 0x04,   // uint8
+    FIELD_LED_BRIGHT = 0x08,  // uint8
+    FIELD_DISTANCE = 0x10,    // uint16, cm × 10
+    FIELD_OCCUPANCY = 0x20,   // uint8, confidence 0-255
+    FIELD_FAN_RPM = 0x40,     // uint16, tach-measured RPM
+    FIELD_ALL_MASK = 0x7F,    // every field above (CMD_SUBSCRIBE default)
+};
+
+// Single schema for the sensor snapshot payload, one row per field in
+// wire order. FIELD rows exist in both the packed frame and the
+// legacy JSON (columns: member, C type, JSON key, printf format, and
+// the decode expression the serializer prints — it expects a
+// SensorFrame named `frame` in scope). BIN rows are binary-only,
+// added after the JSON app generation froze. The struct body below
+// and the generated serializer in BLEService.cpp both expand this
+// list, so the two formats cannot drift apart. The Flutter parser and
+// the Python harness library are generated from this header — after
+// editing, rerun scripts/codegen/gen_protocol.py to refresh
+// app/lib/models/sensor_frame.g.dart and
+// tests/performance/smartsync_protocol.py.
+#define SENSOR_FRAME_SCHEMA(FIELD, BIN) \
+    /* °C × 100 */ \
+    FIELD(temperature, int16_t, "temperature", "%.1f", \
+          frame.temperature * 0.01f) \
+    /* %RH × 100 */ \
+    FIELD(humidity, uint16_t, "humidity", "%.1f", \
+          frame.humidity * 0.01f) \
+    /* raw PWM duty */ \
+    FIELD(fanSpeed, uint8_t, "fan_speed", "%u", frame.fanSpeed) \
+    /* raw PWM duty */ \
+    FIELD(ledBrightness, uint8_t, "led_brightness", "%u", \
+          frame.ledBrightness) \
+    /* cm × 10 */ \
+    FIELD(distance, uint16_t, "distance", "%.1f", frame.distance * 0.1f) \
+    /* fused confidence, 0-255 */ \
+    BIN(occupancy, uint8_t) \
+    /* tach-measured RPM, 0 when the fan is off */ \
+    BIN(fanRpm, uint16_t)
+
+// Full sensor snapshot, 19 bytes vs ~150 for the JSON equivalent.
+#define SENSOR_FRAME_MEMBER(name, ctype, key, fmt, expr) ctype name;
+#define SENSOR_FRAME_MEMBER_BIN(name, ctype) ctype name;
+struct __attribute__((packed)) SensorFrame {
+    uint8_t magic;          // FRAME_MAGIC
+    uint8_t version;        // SENSOR_FRAME_VERSION
+    uint8_t type;           // FRAME_TYPE_SENSOR
+    uint8_t flags;          // SensorFrameFlags
+    SENSOR_FRAME_SCHEMA(SENSOR_FRAME_MEMBER, SENSOR_FRAME_MEMBER_BIN)
+    uint32_t timestampMs;   // device millis()
+};
+#undef SENSOR_FRAME_MEMBER
+#undef SENSOR_FRAME_MEMBER_BIN
+
+// Connectionless snapshot carried in the advertising manufacturer-data
+// field (after the 2-byte company ID). Passive scanners — wall tablets,
+// dashboards — read live values with no connection and no per-client
+// cost. 9 bytes keeps the whole AD structure inside a legacy 31-byte
+// advertising payload next to the service UUID.
+struct __attribute__((packed)) AdvSensorFrame {
+    uint8_t magic;          // FRAME_MAGIC
+    uint8_t version;        // SENSOR_FRAME_VERSION
+    uint8_t flags;          // SensorFrameFlags
+    int16_t temperature;    // °C × 100
+    uint16_t humidity;      // %RH × 100
+    uint8_t fanSpeed;       // raw PWM duty
+    uint8_t sequence;       // bumps each refresh so scanners dedupe
+};
+
+// Alarm event, notified by the AlarmSystem drain task the moment an
+// alarm raises or clears — never batched behind sensor frames. The
+// type byte carries AlarmSystem::AlarmType; value is event-specific
+// (distance in cm, quiet minutes).
+struct __attribute__((packed)) AlertFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;          // FRAME_TYPE_ALERT
+    uint8_t alarmType;     // AlarmSystem::AlarmType
+    uint16_t value;
+    uint16_t reserved;
+    uint32_t timestampMs;  // device millis() at the raise
+};
+
+// One instrumented path's aggregates, microseconds. p99 comes from a
+// log2 histogram, so it reads as the enclosing bucket's upper bound.
+struct __attribute__((packed)) PathLatency {
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t avgUs;
+    uint32_t maxUs;
+    uint32_t p99Us;
+};
+
+// Reply to CMD_GET_LATENCY: the budgeted hot paths, end to end the
+// fall-to-alarm pipeline is mlRun (feature extraction + scoring +
+// raise) plus alarmDispatch (drain task to buzzer).
+struct __attribute__((packed)) LatencyStatsFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;       // FRAME_TYPE_LATENCY_STATS
+    uint8_t reserved;
+    PathLatency mlRun;
+    PathLatency alarmDispatch;
+};
+
+// One profiler section's aggregates; the id indexes the ProfSection
+// enum (system/Profiler.h), which the app mirrors for names.
+struct __attribute__((packed)) ProfileEntry {
+    uint8_t id;
+    uint8_t reserved[3];
+    PathLatency stats;
+};
+
+// Reply to CMD_GET_PROFILE: every instrumented section in one frame.
+// sectionCount entries follow the header.
+struct __attribute__((packed)) ProfileFrameHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;          // FRAME_TYPE_PROFILE
+    uint8_t sectionCount;
+};
+
+// Reply to CMD_GET_HEAP: live internal-heap numbers plus the worst
+// largest-free-block the minute sampler has seen this run. A falling
+// lowestLargestBlock under a stable freeBytes is fragmentation.
+struct __attribute__((packed)) HeapStatsFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;               // FRAME_TYPE_HEAP_STATS
+    uint8_t reserved;
+    uint32_t freeBytes;         // internal heap free right now
+    uint32_t minFreeBytes;      // minimum-ever watermark since boot
+    uint32_t largestBlock;      // largest allocatable block right now
+    uint32_t lowestLargestBlock; // worst largest-block in the ring
+    uint32_t sampleCount;       // samples in the RTC ring
+};
+
+// One task's accounting over the window since the last CMD_GET_TASKS.
+// cpuPermille is of total run time across both cores, so a task
+// pinned to one core tops out at 500; state carries FreeRTOS
+// eTaskState.
+struct __attribute__((packed)) TaskStatsEntry {
+    char name[8];                // truncated, NUL-padded
+    uint16_t cpuPermille;
+    uint16_t stackHighWaterWords; // closest the stack has come to full
+    uint8_t priority;
+    uint8_t state;
+};
+
+// Reply to CMD_GET_TASKS: taskCount entries follow the header, capped
+// to what fits one notification.
+struct __attribute__((packed)) TaskStatsFrameHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;        // FRAME_TYPE_TASK_STATS
+    uint8_t taskCount;
+};
+
+// Reply to CMD_GET_BOOT: per-stage setup() durations for this boot
+// and the previous one (shadowed in RTC memory, so it survives the
+// reset between them). Stage order is fixed in setup(); the app
+// mirrors the names like it does ProfSection. resetReason carries
+// esp_reset_reason() to pair a slow boot with what caused it.
+struct __attribute__((packed)) BootStatsFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;            // FRAME_TYPE_BOOT_STATS
+    uint8_t stageCount;
+    uint8_t prevStageCount;  // 0 when the RTC shadow was cold
+    uint8_t resetReason;
+    uint16_t reserved;
+    uint16_t stagesMs[BOOT_STAGE_MAX];
+    uint16_t prevStagesMs[BOOT_STAGE_MAX];
+};
+
+// Reply to CMD_GET_FLASH_OPS: the worst single flash stall in the
+// trailing hour — and which caller ran it — followed by opCount
+// ProfileEntry records whose ids index the FlashCaller enum
+// (system/FlashOpStats.h).
+struct __attribute__((packed)) FlashOpsFrameHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;         // FRAME_TYPE_FLASH_OPS
+    uint8_t opCount;
+    uint32_t worstUs;     // 0 when the record has expired
+    uint8_t worstCaller;  // FlashCaller
+    uint8_t reserved[3];
+    uint32_t worstAgeMs;
+};
+
+// One live connection's radio-side numbers, queried at read time so
+// they reflect what the peer actually granted, not what we asked for.
+struct __attribute__((packed)) LinkClientEntry {
+    uint16_t connHandle;
+    uint16_t connItvlUnits;  // connection interval, 1.25 ms units
+    uint16_t connLatency;    // peripheral latency the peer granted
+    uint16_t mtu;
+    int8_t rssiDbm;          // 127 when the read failed
+    uint8_t subscribed;
+};
+
+// Reply to CMD_GET_LINK: notify submit-to-completion latency,
+// disconnect history, then clientCount LinkClientEntry records.
+// Separates "firmware slow" (notify latency high) from "radio bad"
+// (RSSI low, interval wide, disconnects with timeout reasons).
+struct __attribute__((packed)) LinkQualityFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;            // FRAME_TYPE_LINK_QUALITY
+    uint8_t clientCount;
+    PathLatency notify;      // full notify call including retries
+    uint32_t disconnects;    // lifetime since boot
+    uint8_t lastDisconnectReason; // BLE_ERR_* from the host
+    uint8_t reserved[3];
+    uint32_t lastDisconnectAgeMs;
+};
+
+// One opcode's command-to-actuation aggregates. Only opcodes that
+// have run since the last reset are included.
+struct __attribute__((packed)) CmdLatencyEntry {
+    uint8_t opcode;
+    uint8_t reserved[3];
+    uint32_t count;
+    uint32_t avgUs;
+    uint32_t maxUs;
+};
+
+// Reply to CMD_GET_CMDSTATS: the slowest recent command (opcode,
+// duration, command-queue depth at completion — deep queue means
+// backlog, empty queue means the handler itself), then opCount
+// CmdLatencyEntry records.
+struct __attribute__((packed)) CmdLatencyFrameHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;           // FRAME_TYPE_CMD_LATENCY
+    uint8_t opCount;
+    uint8_t slowOpcode;
+    uint8_t slowQueueDepth;
+    uint16_t reserved;
+    uint32_t slowUs;
+    uint32_t slowAgeMs;
+};
+
+// Event-trace export chunk: recordCount 8-byte TraceRecords
+// (system/EventTrace.h) starting at absolute sequence firstSeq,
+// oldest first. A chunk with recordCount 0 ends the stream; gaps in
+// firstSeq mean writers lapped the dump, which the host reports
+// rather than hides.
+struct __attribute__((packed)) TraceChunkHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;        // FRAME_TYPE_TRACE_CHUNK
+    uint8_t recordCount;
+    uint32_t firstSeq;
+};
+
+// Background self-test verdicts (CMD_GET_SELFTEST): one status byte
+// per SelfTest::CheckId (0 unknown, 1 pass, 2 fail), plus how many
+// full check cycles have completed and how many transitions into FAIL
+// fleet monitoring should count.
+struct __attribute__((packed)) SelfTestFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;          // FRAME_TYPE_SELFTEST
+    uint8_t reserved;
+    uint8_t status[4];     // indexed by SelfTest::CheckId
+    uint16_t cycles;
+    uint16_t failEvents;
+    uint32_t lastCycleMs;  // device millis() of the last completed cycle
+};
+
+// Distance zone transition (ZoneClassifier): published only when the
+// occupant moves between bands, so a quiet night is two events — into
+// bed, out of bed — instead of a raw distance stream.
+struct __attribute__((packed)) ZoneEventFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;       // FRAME_TYPE_ZONE_EVENT
+    uint8_t zone;       // ZoneClassifier::ZoneId entered
+    uint8_t prevZone;   // zone left (ZONE_UNKNOWN on the first fix)
+    uint8_t reserved;
+    uint16_t distMm;    // sample that committed the transition
+    uint32_t dwellMs;   // time spent in the zone left
+};
+
+// Sealed daily wellness summary (CMD_GET_WELLNESS): one record per
+// night, sealed at WELLNESS_SUMMARY_HOUR from the hour rollups plus
+// live zone/alarm tallies. valid is 0 until the first seal after
+// boot; windowMinutes says how much of the night the counters cover.
+struct __attribute__((packed)) WellnessFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;           // FRAME_TYPE_WELLNESS
+    uint8_t valid;
+    uint16_t motionCount;   // PIR events over the covered window
+    uint16_t outOfBedCount; // ZONE_BED exits inside the night window
+    uint16_t alertCount;    // alarms raised inside the night window
+    uint16_t comfortMinutes; // minutes with mean temp in the comfort band
+    uint16_t windowMinutes; // rollup coverage actually summed
+    int16_t tempMin;        // °C × 100 over the window (0 when none)
+    int16_t tempMax;        // °C × 100 over the window (0 when none)
+    uint32_t sealedAtMs;    // device millis() when the record sealed
+};
+
+// Reconnect catch-up chunk: frameCount full SensorFrames (each with
+// its own header and timestamp) follow, oldest first, drawn from the
+// in-RAM recent-frame ring. A chunk with frameCount 0 ends the burst
+// and the periodic cadence resumes.
+struct __attribute__((packed)) CatchupChunkHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;        // FRAME_TYPE_CATCHUP_CHUNK
+    uint8_t frameCount;
+};
+
+// Periodic soak-mode sample (CMD_SOAK): the internal state a long
+// stress run correlates against its applied load, one frame per
+// interval. Counters are since-boot; the harness diffs consecutive
+// frames, so a lost notification costs one point, not the series.
+// taskCount TaskStatsEntry records follow (CPU share over the window
+// since the previous frame).
+struct __attribute__((packed)) SoakMetricsFrameHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;              // FRAME_TYPE_SOAK_METRICS
+    uint8_t taskCount;
+    uint32_t uptimeS;
+    uint32_t heapFreeBytes;
+    uint32_t heapMinFreeBytes; // since-boot watermark: leaks bend this
+    uint8_t cmdQueueDepth;
+    uint8_t sensorEventQueueDepth;
+    uint8_t mlQueueDepth;
+    uint8_t reserved;
+    uint32_t mlDrops;          // ml queue full events
+    uint32_t pushesShed;       // BLE_PUSH events dropped under load
+    uint32_t notifyDrops;
+    uint32_t notifyRetries;
+    uint32_t flashWorstUs;     // worst single stall, trailing hour
+    uint32_t nvsCommits;       // deferred Preferences flushes run
+};
+
+// Protocol capability bits, negotiated once per connection by
+// CMD_HELLO: the app writes the set it supports, the firmware replies
+// with the intersection in a HelloFrame, and every later frame uses
+// the agreed fixed layout with no per-frame metadata. An app that
+// never says hello keeps the firmware defaults; one that only writes
+// legacy JSON lands on the createSensorJSON compatibility path.
+#define PROTO_CAP_BINARY_FRAMES 0x01 // packed frames instead of JSON
+#define PROTO_CAP_DELTA_FRAMES 0x02  // changed-fields deltas between keyframes
+#define PROTO_CAP_CHUNKED_XFER 0x04  // history/capture/coredump/trace streams
+#define PROTO_CAP_SESSION_AUTH 0x08  // CMD_AUTH_START/CMD_AUTH handshake
+#define PROTO_CAP_BLE_OTA 0x10       // firmware transfer characteristic
+#define PROTO_CAP_ROLLUPS 0x20       // CMD_GET_ROLLUP aggregate streams
+#define PROTO_CAP_FRAMED_CHUNKS 0x40 // seq + CRC-16 chunk trailer (ChunkFramer.h)
+#define PROTO_CAP_AGGREGATION 0x80   // peer frames + CMD_PEER_COMMAND relay
+#define PROTO_CAP_CATCHUP 0x100      // reconnect backlog burst on subscribe
+#define PROTO_CAPS_SUPPORTED \
+    (PROTO_CAP_BINARY_FRAMES | PROTO_CAP_DELTA_FRAMES | \
+     PROTO_CAP_CHUNKED_XFER | PROTO_CAP_SESSION_AUTH | \
+     PROTO_CAP_BLE_OTA | PROTO_CAP_ROLLUPS | PROTO_CAP_FRAMED_CHUNKS | \
+     PROTO_CAP_AGGREGATION | PROTO_CAP_CATCHUP)
+
+// CMD_HELLO reply: the firmware's protocol version and the negotiated
+// capability intersection.
+struct __attribute__((packed)) HelloFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;       // FRAME_TYPE_HELLO
+    uint8_t reserved;
+    uint32_t caps;      // PROTO_CAP_* bits both sides support
+};
+
+// Auth handshake replies (SessionAuth): CHALLENGE carries the nonce a
+// CMD_AUTH response must HMAC; OK/FAIL answer the attempt with the
+// nonce field zeroed.
+enum AuthStatus : uint8_t {
+    AUTH_STATUS_CHALLENGE = 0,
+    AUTH_STATUS_OK = 1,
+    AUTH_STATUS_FAIL = 2,
+};
+
+struct __attribute__((packed)) AuthFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;      // FRAME_TYPE_AUTH
+    uint8_t status;    // AuthStatus
+    uint8_t nonce[8];  // SessionAuth::NONCE_LEN
+};
+
+// Firmware-transfer status, notified after CMD_OTA_BEGIN and
+// CMD_OTA_COMMIT (and on a failed data chunk). status carries
+// FirmwareUpdater::Status; received is the resume offset — after a
+// reconnect the host re-sends BEGIN with the same size and CRC and
+// continues from here.
+struct __attribute__((packed)) OtaStatusFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;      // FRAME_TYPE_OTA_STATUS
+    uint8_t status;    // FirmwareUpdater::Status
+    uint32_t received; // contiguous bytes landed in the inactive slot
+};
+
+// Rollup stream chunk (CMD_GET_ROLLUP): `count` verbatim 32-byte
+// RollupRecords (storage/RollupStore.h) follow the header. The
+// records are already compact — 24 of them cover a day-view chart —
+// so no delta encoding; a chunk with count == 0 ends the stream.
+struct __attribute__((packed)) RollupChunkHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;  // FRAME_TYPE_ROLLUP_CHUNK
+    uint8_t count; // records in this chunk
+};
+
+// One peer unit's room snapshot, multiplexed onto the aggregation
+// unit's phone connection (PROTO_CAP_AGGREGATION). The MAC is the
+// unit tag — stable across reboots, and the address CMD_PEER_COMMAND
+// relays back to. ageMs is how stale the snapshot already was when
+// notified (peers broadcast every ESPNOW_SEND_INTERVAL_MS).
+struct __attribute__((packed)) PeerSensorFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;         // FRAME_TYPE_PEER_SENSOR
+    uint8_t flags;        // SENSOR_FLAG_MOTION only
+    uint8_t mac[6];       // peer unit's STA MAC
+    int16_t temperature;  // °C × 100
+    uint16_t humidity;    // %RH × 100
+    uint8_t occupancy;    // fused confidence, 0-255
+    uint8_t fanSpeed;     // raw PWM duty
+    uint8_t ledBrightness;
+    uint8_t reserved;
+    uint32_t ageMs;
+};
+
+// Combined acknowledgment for one CMD_BATCH write: how many
+// sub-commands dispatched, and the zero-based index of the entry that
+// stopped the walk (0xFF when the whole batch ran). Dispatch is
+// fail-stop — the length prefixes are the framing, so the first
+// malformed entry makes everything behind it unparseable.
+struct __attribute__((packed)) BatchResultFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;        // FRAME_TYPE_BATCH_RESULT
+    uint8_t executed;    // sub-commands dispatched
+    uint8_t failedIndex; // first rejected entry, 0xFF = none
+    uint8_t reserved;
+};
+
+// Completion ack for one CMD_TAGGED write: the client's tag echoed
+// back with the firmware-side handler duration, so the app confirms
+// the command applied (no more optimistic-UI drift), retries on a
+// missing ack, and RTT minus processingUs gives true link latency
+// from production phones. For deferred commands processingUs covers
+// the dispatch only; actuation latency stays with CMD_GET_LATENCY.
+struct __attribute__((packed)) CmdAckFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;          // FRAME_TYPE_CMD_ACK
+    uint8_t status;        // 0 = dispatched, 1 = inner entry rejected
+    uint16_t tag;          // echoed from the command
+    uint8_t opcode;        // inner opcode dispatched (0 when rejected)
+    uint8_t reserved;
+    uint32_t processingUs; // RX arrival to ack enqueue
+};
+
+// Core-dump export chunk: raw bytes of the crash dump image at the
+// given offset. totalSize lets the host preallocate and detect a
+// short stream; a chunk with offset == totalSize and no bytes ends
+// the transfer. The payload is whatever the IDF panic handler wrote —
+// decoded offline with espcoredump.py, never on the device.
+struct __attribute__((packed)) CoreDumpChunkHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;       // FRAME_TYPE_COREDUMP_CHUNK
+    uint8_t reserved;
+    uint32_t offset;
+    uint32_t totalSize;
+};
+
+// Capture export chunk: raw bytes of one capture record (CaptureHeader
+// plus its compressed payload) at the given byte offset. The host
+// reassembles by sequence; a chunk with sequence 0 and no bytes ends
+// the stream.
+struct __attribute__((packed)) CaptureChunkHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;      // FRAME_TYPE_CAPTURE_CHUNK
+    uint8_t reserved;
+    uint32_t sequence; // record being streamed; 0 in the end marker
+    uint16_t offset;   // this chunk's byte offset within the record
+};
+
+// Model-transfer status, notified after CMD_MODEL_BEGIN and
+// CMD_MODEL_COMMIT (and on a failed CMD_MODEL_DATA). status carries
+// ModelUpdater::Status; generation is the active directory generation
+// so the host can stamp generation + 1 into the image it sends.
+struct __attribute__((packed)) ModelStatusFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;          // FRAME_TYPE_MODEL_STATUS
+    uint8_t status;        // ModelUpdater::Status
+    uint32_t generation;   // active bank's generation
+    uint32_t received;     // bytes landed in the inactive bank
+};
+
+// Benchmark stream frame: header, a 32-bit sequence number, then
+// filler up to the negotiated payload size. Receivers detect drops
+// from sequence gaps.
+struct __attribute__((packed)) BenchDataHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;          // FRAME_TYPE_BENCH_DATA
+    uint8_t reserved;
+    uint32_t sequence;
+};
+
+// Benchmark summary, notified once when the run ends. Asserted against
+// by tests/performance/load_test.py across firmware releases.
+struct __attribute__((packed)) BenchReportFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;           // FRAME_TYPE_BENCH_REPORT
+    uint8_t reserved;
+    uint32_t framesSent;    // accepted by the stack
+    uint32_t bytesPerSec;   // payload throughput over the whole run
+    uint32_t congestion;    // rejected notifies (mbuf exhaustion)
+    uint32_t meanNotifyUs;  // mean time in the notify call
+};
+
+// Flash wear telemetry, reply to CMD_GET_FLASH_HEALTH. Lifetime
+// counters persist in the settings blob; fleet maintenance ranks units
+// by wear instead of replacing on failure.
+struct __attribute__((packed)) FlashHealthFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;            // FRAME_TYPE_FLASH_HEALTH
+    uint8_t reserved;
+    uint32_t nvsCommits;     // settings-blob commits, lifetime
+    uint32_t historyErases;  // history-log sector erases, lifetime
+    uint16_t historySectors; // sectors the erases spread across
+    uint16_t reserved2;
+};
+
+// Send-queue health counters, reply to CMD_GET_BLE_STATS.
+struct __attribute__((packed)) NotifyStatsFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;          // FRAME_TYPE_NOTIFY_STATS
+    uint8_t reserved;
+    uint32_t sent;         // notifications accepted by the stack
+    uint32_t retries;      // congestion retries
+    uint32_t drops;        // frames abandoned after max retries
+    uint32_t coalesced;    // superseded sensor frames replaced in queue
+    // QoS tiers: queue wait per tier (ms, clamped to 16 bits) and the
+    // bulk sequences aborted because an alert owned the air.
+    uint32_t bulkAborts;
+    uint16_t alertLastMs;     // queue wait of the most recent alert
+    uint16_t alertMaxMs;      // worst alert queue wait since boot
+    uint16_t controlMaxMs;    // worst command-reply queue wait
+    uint16_t telemetryMaxMs;  // worst periodic-frame queue wait
+};
+
+#endif // SENSOR_FRAME_H
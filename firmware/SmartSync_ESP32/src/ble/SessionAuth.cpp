@@ -0,0 +1,311 @@
+#include "SessionAuth.h"
+
+#include <string.h>
+
+// ============================================================================
+// SHA-256 (FIPS 180-4)
+// ============================================================================
+// Self-contained so the module builds for the host unchanged. The
+// messages here are one or two blocks; a hardware digest's setup cost
+// would exceed the software compress.
+
+namespace {
+
+struct Sha256 {
+    uint32_t state[8];
+    uint64_t totalBits;
+    uint8_t block[64];
+    size_t blockLen;
+};
+
+const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+inline uint32_t rotr(uint32_t x, uint32_t n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+void sha256Init(Sha256& ctx) {
+    ctx.state[0] = 0x6a09e667; ctx.state[1] = 0xbb67ae85;
+    ctx.state[2] = 0x3c6ef372; ctx.state[3] = 0xa54ff53a;
+    ctx.state[4] = 0x510e527f; ctx.state[5] = 0x9b05688c;
+    ctx.state[6] = 0x1f83d9ab; ctx.state[7] = 0x5be0cd19;
+    ctx.totalBits = 0;
+    ctx.blockLen = 0;
+}
+
+void sha256Compress(Sha256& ctx, const uint8_t* p) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)p[i * 4] << 24) | ((uint32_t)p[i * 4 + 1] << 16) |
+               ((uint32_t)p[i * 4 + 2] << 8) | (uint32_t)p[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = ctx.state[0], b = ctx.state[1], c = ctx.state[2];
+    uint32_t d = ctx.state[3], e = ctx.state[4], f = ctx.state[5];
+    uint32_t g = ctx.state[6], h = ctx.state[7];
+
+    for (int i = 0; i < 64; i++) {
+        uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + ch + SHA256_K[i] + w[i];
+        uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + maj;
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    ctx.state[0] += a; ctx.state[1] += b; ctx.state[2] += c;
+    ctx.state[3] += d; ctx.state[4] += e; ctx.state[5] += f;
+    ctx.state[6] += g; ctx.state[7] += h;
+}
+
+void sha256Update(Sha256& ctx, const uint8_t* data, size_t length) {
+    ctx.totalBits += (uint64_t)length * 8;
+    while (length > 0) {
+        size_t take = 64 - ctx.blockLen;
+        if (take > length) {
+            take = length;
+        }
+        memcpy(ctx.block + ctx.blockLen, data, take);
+        ctx.blockLen += take;
+        data += take;
+        length -= take;
+        if (ctx.blockLen == 64) {
+            sha256Compress(ctx, ctx.block);
+            ctx.blockLen = 0;
+        }
+    }
+}
+
+void sha256Final(Sha256& ctx, uint8_t out[32]) {
+    uint64_t bits = ctx.totalBits;
+    uint8_t pad = 0x80;
+    sha256Update(ctx, &pad, 1);
+    uint8_t zero = 0x00;
+    while (ctx.blockLen != 56) {
+        sha256Update(ctx, &zero, 1);
+    }
+    uint8_t lenBytes[8];
+    for (int i = 0; i < 8; i++) {
+        lenBytes[i] = (uint8_t)(bits >> (56 - i * 8));
+    }
+    // Length bytes complete the block; don't recount them.
+    ctx.totalBits = bits;
+    sha256Update(ctx, lenBytes, 8);
+    for (int i = 0; i < 8; i++) {
+        out[i * 4] = (uint8_t)(ctx.state[i] >> 24);
+        out[i * 4 + 1] = (uint8_t)(ctx.state[i] >> 16);
+        out[i * 4 + 2] = (uint8_t)(ctx.state[i] >> 8);
+        out[i * 4 + 3] = (uint8_t)ctx.state[i];
+    }
+}
+
+// Byte-wise OR-accumulated comparison: runtime independent of where
+// a mismatch sits, so a radio peer can't clock-edge its way through
+// MAC bytes.
+bool constantTimeEqual(const uint8_t* a, const uint8_t* b, size_t length) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < length; i++) {
+        diff |= (uint8_t)(a[i] ^ b[i]);
+    }
+    return diff == 0;
+}
+
+} // namespace
+
+// ============================================================================
+// HMAC / KDF
+// ============================================================================
+// Two-part message variant so verifyCommand can MAC the header and
+// the in-place payload without a scratch concatenation.
+static void hmacSha256Parts(const uint8_t* key, size_t keyLen,
+                            const uint8_t* msg1, size_t len1,
+                            const uint8_t* msg2, size_t len2,
+                            uint8_t out[SessionAuth::KEY_LEN]) {
+    uint8_t keyBlock[64];
+    memset(keyBlock, 0, sizeof(keyBlock));
+    if (keyLen > sizeof(keyBlock)) {
+        Sha256 ctx;
+        sha256Init(ctx);
+        sha256Update(ctx, key, keyLen);
+        sha256Final(ctx, keyBlock);
+    } else {
+        memcpy(keyBlock, key, keyLen);
+    }
+
+    uint8_t pad[64];
+    uint8_t inner[SessionAuth::KEY_LEN];
+
+    for (int i = 0; i < 64; i++) {
+        pad[i] = keyBlock[i] ^ 0x36;
+    }
+    Sha256 ctx;
+    sha256Init(ctx);
+    sha256Update(ctx, pad, sizeof(pad));
+    sha256Update(ctx, msg1, len1);
+    if (len2 > 0) {
+        sha256Update(ctx, msg2, len2);
+    }
+    sha256Final(ctx, inner);
+
+    for (int i = 0; i < 64; i++) {
+        pad[i] = keyBlock[i] ^ 0x5c;
+    }
+    sha256Init(ctx);
+    sha256Update(ctx, pad, sizeof(pad));
+    sha256Update(ctx, inner, sizeof(inner));
+    sha256Final(ctx, out);
+}
+
+void SessionAuth::hmacSha256(const uint8_t* key, size_t keyLen,
+                             const uint8_t* msg, size_t msgLen,
+                             uint8_t out[KEY_LEN]) {
+    hmacSha256Parts(key, keyLen, msg, msgLen, nullptr, 0, out);
+}
+
+void SessionAuth::stretchPin(uint32_t pin, uint32_t deviceId,
+                             uint8_t out[KEY_LEN]) {
+    // Seed binds the PIN to this unit, so one grind doesn't cover a
+    // fleet; the chain makes each guess cost the full iteration count.
+    uint8_t seed[8];
+    for (int i = 0; i < 4; i++) {
+        seed[i] = (uint8_t)(pin >> (i * 8));
+        seed[4 + i] = (uint8_t)(deviceId >> (i * 8));
+    }
+
+    hmacSha256(seed, sizeof(seed), (const uint8_t*)"smartsync-auth", 14, out);
+    for (uint32_t i = 1; i < AUTH_KDF_ITERATIONS; i++) {
+        hmacSha256(seed, sizeof(seed), out, KEY_LEN, out);
+    }
+}
+
+// ============================================================================
+// SESSION STATE
+// ============================================================================
+SessionAuth::SessionAuth()
+    : highCounter(0), windowBits(0), challenged(false), authed(false) {
+    memset(nonceBuf, 0, sizeof(nonceBuf));
+    memset(sessionKey, 0, sizeof(sessionKey));
+}
+
+void SessionAuth::reset() {
+    memset(nonceBuf, 0, sizeof(nonceBuf));
+    memset(sessionKey, 0, sizeof(sessionKey));
+    highCounter = 0;
+    windowBits = 0;
+    challenged = false;
+    authed = false;
+}
+
+void SessionAuth::issueChallenge(uint32_t entropyA, uint32_t entropyB) {
+    reset();
+    for (int i = 0; i < 4; i++) {
+        nonceBuf[i] = (uint8_t)(entropyA >> (i * 8));
+        nonceBuf[4 + i] = (uint8_t)(entropyB >> (i * 8));
+    }
+    challenged = true;
+}
+
+bool SessionAuth::completeAuth(const uint8_t stretchedKey[KEY_LEN],
+                               const uint8_t* response, size_t length) {
+    if (!challenged || length < RESPONSE_LEN) {
+        return false;
+    }
+
+    uint8_t expected[KEY_LEN];
+    hmacSha256(stretchedKey, KEY_LEN, nonceBuf, NONCE_LEN, expected);
+    if (!constantTimeEqual(expected, response, RESPONSE_LEN)) {
+        // A failed attempt burns the challenge: the next guess costs
+        // the client another CMD_AUTH_START round trip.
+        reset();
+        return false;
+    }
+
+    // Session key != response key: a domain byte on the nonce keeps
+    // the on-air response useless for forging command MACs.
+    uint8_t material[NONCE_LEN + 1];
+    memcpy(material, nonceBuf, NONCE_LEN);
+    material[NONCE_LEN] = 0x01;
+    hmacSha256(stretchedKey, KEY_LEN, material, sizeof(material), sessionKey);
+
+    highCounter = 0;
+    windowBits = 0;
+    challenged = false;
+    authed = true;
+    return true;
+}
+
+bool SessionAuth::verifyCommand(uint8_t opcode, const uint8_t* payload,
+                                size_t length) {
+    if (!authed || length < TAIL_LEN) {
+        return false;
+    }
+
+    size_t bodyLen = length - TAIL_LEN;
+    const uint8_t* tail = payload + bodyLen;
+    uint32_t counter = (uint32_t)tail[0] | ((uint32_t)tail[1] << 8) |
+                       ((uint32_t)tail[2] << 16) | ((uint32_t)tail[3] << 24);
+
+    // Cheap window check before spending the HMAC: a counter behind
+    // the window or with its seen-bit set can never be accepted.
+    // Counters start at 1 so a fresh session's high mark of 0 means
+    // "nothing seen yet".
+    if (counter == 0) {
+        return false;
+    }
+    if (counter <= highCounter) {
+        uint32_t age = highCounter - counter;
+        if (age >= WINDOW_SIZE || ((windowBits >> age) & 1u)) {
+            return false; // replayed, or too stale to track
+        }
+    }
+
+    // MAC input: counter || opcode || payload proper — the counter
+    // first so two commands never share a prefix.
+    uint8_t mac[KEY_LEN];
+    uint8_t header[4 + 1];
+    memcpy(header, tail, 4);
+    header[4] = opcode;
+    hmacSha256Parts(sessionKey, KEY_LEN, header, sizeof(header),
+                    payload, bodyLen, mac);
+
+    if (!constantTimeEqual(mac, tail + 4, MAC_LEN)) {
+        return false;
+    }
+
+    // Only now touch the window — a forged frame must not be able to
+    // poison it. Advancing shifts history out; a late arrival just
+    // sets its bit.
+    if (counter > highCounter) {
+        uint32_t advance = counter - highCounter;
+        windowBits = (advance >= WINDOW_SIZE) ? 0 : (windowBits << advance);
+        windowBits |= 1u;
+        highCounter = counter;
+    } else {
+        windowBits |= (uint64_t)1 << (highCounter - counter);
+    }
+    return true;
+}
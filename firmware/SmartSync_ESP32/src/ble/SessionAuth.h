@@ -0,0 +1,93 @@
+#ifndef SESSION_AUTH_H
+#define SESSION_AUTH_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Session authentication for the RX command path. The device PIN
+// never crosses the air: on connect the client requests a challenge
+// (CMD_AUTH_START), proves PIN knowledge with an HMAC over the nonce
+// (CMD_AUTH), and both sides derive a per-session key. From then on
+// every mutating command carries a short trailing MAC over a sequence
+// counter checked against a sliding replay window — possession of the
+// session key plus freshness, verified in a couple of HMAC blocks.
+//
+// The cost profile matches where the time budget is: the deliberately
+// slow part (AUTH_KDF_ITERATIONS of iterated HMAC, so a radio
+// attacker can't grind the 4-8 digit PIN space quickly) runs once,
+// and the per-command check is microseconds — a slider drag's command
+// stream never notices it. The stretched PIN key depends only on PIN
+// and device ID, so BLEService caches it across connections and even
+// the handshake pays the KDF only on the first connect after boot.
+//
+// Everything here is portable (the SHA-256 is self-contained; at
+// these message sizes hardware acceleration buys nothing), so the
+// host tests and the fuzz harness cover the exact verification path
+// that gates dispatch.
+
+class SessionAuth {
+public:
+    static const size_t KEY_LEN = 32;     // SHA-256 output
+    static const size_t NONCE_LEN = 8;    // challenge nonce
+    static const size_t RESPONSE_LEN = 8; // truncated challenge HMAC
+    static const size_t MAC_LEN = 4;      // truncated per-command MAC
+    static const size_t TAIL_LEN = 4 + MAC_LEN; // counter + MAC
+
+    SessionAuth();
+
+    // Drops any session and challenge; connect/disconnect both land
+    // here.
+    void reset();
+
+    // Issues a fresh challenge from caller-supplied entropy. Replaces
+    // any previous challenge or session — re-authing mid-session is
+    // allowed and atomic from the client's view.
+    void issueChallenge(uint32_t entropyA, uint32_t entropyB);
+    const uint8_t* nonce() const { return nonceBuf; }
+
+    // Verifies the client's response (HMAC of the nonce under the
+    // stretched PIN key, truncated) and on success derives and caches
+    // the session key. Constant-time compare; failure drops the
+    // challenge so every retry costs the client a fresh round trip.
+    bool completeAuth(const uint8_t stretchedKey[KEY_LEN],
+                      const uint8_t* response, size_t length);
+
+    bool authenticated() const { return authed; }
+
+    // Verifies one authenticated command frame. `payload`/`length` is
+    // the parsed payload INCLUDING the TAIL_LEN trailer: little-endian
+    // counter, then the MAC over counter || opcode || payload proper.
+    // Freshness uses the DTLS sliding-window construction: a counter
+    // is accepted if it moves the high-water mark forward or lands
+    // inside the last WINDOW_SIZE numbers without its seen-bit set.
+    // O(1) time and eight bytes of state regardless of session length,
+    // and tolerant of the mild reordering unacked GATT writes can see
+    // across a connection-parameter update. Accepting marks the
+    // counter seen; the caller strips the trailer before dispatch.
+    bool verifyCommand(uint8_t opcode, const uint8_t* payload,
+                       size_t length);
+
+    // Replay window width — one bit per recently seen counter.
+    static const uint32_t WINDOW_SIZE = 64;
+
+    // One-time PIN stretching: AUTH_KDF_ITERATIONS of chained HMAC
+    // over PIN and device ID. Deliberately slow — this is the online
+    // guessing rate limit.
+    static void stretchPin(uint32_t pin, uint32_t deviceId,
+                           uint8_t out[KEY_LEN]);
+
+    // Exposed for the host tests (known-answer vectors).
+    static void hmacSha256(const uint8_t* key, size_t keyLen,
+                           const uint8_t* msg, size_t msgLen,
+                           uint8_t out[KEY_LEN]);
+
+private:
+    uint8_t nonceBuf[NONCE_LEN];
+    uint8_t sessionKey[KEY_LEN];
+    uint32_t highCounter;  // highest counter accepted so far
+    uint64_t windowBits;   // bit n = highCounter - n already seen
+    bool challenged;
+    bool authed;
+};
+
+#endif // SESSION_AUTH_H
@@ -0,0 +1,63 @@
+#include "AutoModePolicy.h"
+
+AutoModePolicy::AutoModePolicy()
+    : trend(TREND_ALPHA, TREND_BETA),
+      overTempLatched(false),
+      roomActiveLatched(false) {
+}
+
+void AutoModePolicy::noteTemperature(float tempC, uint32_t nowMs) {
+    trend.update(tempC, nowMs);
+}
+
+AutoModePolicy::Decision AutoModePolicy::evaluate(float tempNow,
+                                                  uint8_t occupancyConfidence,
+                                                  uint32_t nowMs) {
+    // Predictive: control on where the room will be in 15 minutes, so
+    // the fan ramps while the temperature is climbing instead of
+    // after it arrived. Safety checks stay on the instant reading.
+    float temp = trend.primed()
+        ? trend.projected(TREND_HORIZON_MS)
+        : tempNow;
+
+    // Over-temperature latch: enters at the threshold, releases one
+    // hysteresis band below it, so a room hovering at the limit can't
+    // toggle full speed every cycle.
+    if (!overTempLatched && tempNow >= TEMP_MAX_THRESHOLD) {
+        overTempLatched = true;
+    } else if (overTempLatched &&
+               tempNow < TEMP_MAX_THRESHOLD - TEMP_MAX_HYSTERESIS_C) {
+        overTempLatched = false;
+    }
+
+    // Occupancy latch: becomes active one band above the confidence
+    // floor, drops at the floor.
+    if (roomActiveLatched && occupancyConfidence < OCCUPANCY_CONFIDENCE_MIN) {
+        roomActiveLatched = false;
+    } else if (!roomActiveLatched &&
+               occupancyConfidence >=
+                   OCCUPANCY_CONFIDENCE_MIN + OCCUPANCY_HYSTERESIS) {
+        roomActiveLatched = true;
+    }
+
+    // Absolute over-temperature override, independent of the loop and
+    // of occupancy — it protects the space, not the occupant.
+    if (overTempLatched) {
+        return { 255, true };
+    }
+
+    // Empty room: hold the fan off. The PID resets so its integrator
+    // doesn't wind up while the gate holds zero.
+    if (!roomActiveLatched) {
+        fan.reset();
+        return { 0, false };
+    }
+
+    // Closed loop: the PID's deadband decides whether this cycle's
+    // correction is worth a PWM change. Re-issuing the held output
+    // lets a dwell-dropped request land on a later cycle instead of
+    // being lost.
+    uint8_t duty;
+    fan.update(temp, nowMs, &duty);
+    return { fan.duty(), false };
+}
@@ -0,0 +1,51 @@
+#ifndef AUTO_MODE_POLICY_H
+#define AUTO_MODE_POLICY_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+#include "../actuators/FanController.h"
+#include "../sensors/TrendEstimator.h"
+
+// The auto-mode decision chain — temperature trend, over-temperature
+// latch, occupancy gate, PID — as one portable object. It takes its
+// inputs and the clock as parameters and touches no hardware, so the
+// exact code that runs on the unit also runs on the native build:
+// the replay harness (test/test_replay) can push a captured history
+// trace through it with a virtual clock and reproduce hours of field
+// behavior in seconds. main.cpp keeps the queue-side concerns (dwell,
+// dedupe against the applied duty, trace events) in
+// requestAutoFanSpeed.
+class AutoModePolicy {
+public:
+    struct Decision {
+        uint8_t duty;
+        bool urgent; // over-temperature override: bypasses the dwell
+    };
+
+    AutoModePolicy();
+
+    // Feed each accepted temperature sample (sensor task cadence);
+    // keeps the Holt trend the projection acts on.
+    void noteTemperature(float tempC, uint32_t nowMs);
+
+    // One auto-mode cycle: latches update, then the duty to request.
+    // Safety latching uses the instant reading; the PID controls on
+    // the 15-minute projection once the trend is primed.
+    Decision evaluate(float tempNow, uint8_t occupancyConfidence,
+                      uint32_t nowMs);
+
+    // The PID is owned here; scenes reset it, CMD_SET_SETPOINT
+    // retargets it.
+    FanController& controller() { return fan; }
+
+    bool overTemperature() const { return overTempLatched; }
+    bool roomActive() const { return roomActiveLatched; }
+
+private:
+    FanController fan;
+    TrendEstimator trend;
+    bool overTempLatched;
+    bool roomActiveLatched;
+};
+
+#endif // AUTO_MODE_POLICY_H
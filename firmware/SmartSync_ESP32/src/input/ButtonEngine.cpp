@@ -0,0 +1,62 @@
+#include "ButtonEngine.h"
+
+ButtonEngine::ButtonEngine()
+    : pin(0),
+      callback(nullptr),
+      lastEdgeCycles(0),
+      lastDownUs(0),
+      doublePending(false) {
+}
+
+void ButtonEngine::begin(uint8_t buttonPin, Callback cb) {
+    pin = buttonPin;
+    callback = cb;
+    // Far enough in the past that the first press is never taken for
+    // the second half of a double.
+    lastDownUs = -(int64_t)BUTTON_DOUBLE_GAP_MS * 1000;
+    pinMode(pin, INPUT_PULLUP);
+    attachInterruptArg(digitalPinToInterrupt(pin), isrThunk, this, CHANGE);
+    DEBUG_PRINTF("Button engine on GPIO %u\n", pin);
+}
+
+void IRAM_ATTR ButtonEngine::isrThunk(void* arg) {
+    static_cast<ButtonEngine*>(arg)->onEdge();
+}
+
+void IRAM_ATTR ButtonEngine::onEdge() {
+    // Bounce gate: a tact switch chatters for milliseconds around both
+    // edges; everything inside the window rides the first edge. The
+    // cycle counter wraps every ~18 s at 240 MHz, which can only admit
+    // one bounce edge early — the gap/hold math below still measures
+    // against esp_timer and stays correct.
+    uint32_t nowCycles = xthal_get_ccount();
+    if ((uint32_t)(nowCycles - lastEdgeCycles) <
+        BUTTON_DEBOUNCE_US * (F_CPU / 1000000)) {
+        return;
+    }
+    lastEdgeCycles = nowCycles;
+
+    bool down = (digitalRead(pin) == LOW);
+    int64_t nowUs = esp_timer_get_time();
+
+    if (down) {
+        if ((nowUs - lastDownUs) < (int64_t)BUTTON_DOUBLE_GAP_MS * 1000) {
+            // Second press inside the gap: promote. The release of
+            // this press classifies nothing.
+            doublePending = true;
+            callback(PRESS_DOUBLE);
+        } else {
+            doublePending = false;
+            callback(PRESS_SHORT);
+        }
+        lastDownUs = nowUs;
+        return;
+    }
+
+    // Release: only a hold still means something here — the short
+    // already fired on the down edge.
+    if (!doublePending &&
+        (nowUs - lastDownUs) >= (int64_t)BUTTON_LONG_PRESS_MS * 1000) {
+        callback(PRESS_LONG);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef BUTTON_ENGINE_H
+#define BUTTON_ENGINE_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Interrupt-driven user button: short / long / double press classified
+// entirely in the GPIO ISR, no polling task and no timers. Debounce is
+// the PIR's stage-1 scheme — edges closer than BUTTON_DEBOUNCE_US to
+// the previous one are contact bounce and dropped on the cycle
+// counter, which also swallows fan-PWM coupling on the line.
+//
+// Classification is eager, because waiting is latency: a down edge
+// fires PRESS_SHORT immediately instead of sitting out the double-gap
+// to see whether a second press follows. When one does (inside
+// BUTTON_DOUBLE_GAP_MS), PRESS_DOUBLE fires and the consumer reverts
+// what the eager short did — the fan blips one step for a quarter
+// second, beneath rotor inertia, while a plain short press acts in the
+// ISR-to-actuation path with no classification wait at all. A hold
+// fires PRESS_LONG on the release edge once the press outlasts
+// BUTTON_LONG_PRESS_MS; its eager short gets reverted the same way.
+//
+// The callback runs in ISR context: queue-send and return, like the
+// PIR path.
+
+class ButtonEngine {
+public:
+    enum Press : uint8_t {
+        PRESS_SHORT,  // down edge, fired eagerly
+        PRESS_DOUBLE, // second down inside the gap; revert the short
+        PRESS_LONG,   // release after a hold; revert the short
+    };
+    typedef void (*Callback)(Press press);
+
+    ButtonEngine();
+
+    // Configures the pin (pullup, switch to ground) and attaches the
+    // edge ISR. The callback is mandatory and ISR-context.
+    void begin(uint8_t pin, Callback callback);
+
+private:
+    static void IRAM_ATTR isrThunk(void* arg);
+    void IRAM_ATTR onEdge();
+
+    uint8_t pin;
+    Callback callback;
+    volatile uint32_t lastEdgeCycles;
+    volatile int64_t lastDownUs;
+    volatile bool doublePending; // release belongs to a double press
+};
+
+#endif // BUTTON_ENGINE_H
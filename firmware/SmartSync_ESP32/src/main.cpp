@@ -1,51 +1,663 @@
+// Unity test builds (pio test) compile src/ alongside the test
+// runner, which supplies its own setup()/loop() — everything here
+// drops out of those builds.
+#ifndef PIO_UNIT_TESTING
+
 #include <Arduino.h>
 #include <Wire.h>
-#include <DHT.h>
 #include <Preferences.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <driver/gpio.h>
+#include <driver/ledc.h>
 #include "../include/config.h"
 #include "ble/BLEService.h"
+#include "actuators/BuzzerEngine.h"
+#include "actuators/FanTach.h"
+#include "actuators/GammaLut.h"
+#include "actuators/LedPatternEngine.h"
+#include "control/AutoModePolicy.h"
+#include "input/ButtonEngine.h"
+#include "ml/AnomalyDetector.h"
+#include "ml/FallDetector.h"
+#include "ml/InferenceArena.h"
+#include "ml/MlKernels.h"
+#include "ml/ModelStore.h"
+#include "ml/ModelUpdater.h"
+#include "ml/OccupancyBaseline.h"
+#include "network/CloudUplink.h"
+#include "network/EspNowMesh.h"
+#include "network/MqttTelemetry.h"
+#include "network/DeltaOta.h"
+#include "network/MdnsAdvertiser.h"
+#include "network/WsLiveServer.h"
+#include "system/Profiler.h"
+#include "system/HeapMonitor.h"
+#include "system/BootHealthGate.h"
+#include "system/FirmwareUpdater.h"
+#include "system/FlashOpStats.h"
+#include "system/BulkDump.h"
+#include "system/RingLogger.h"
+#include "system/SerialCli.h"
+#include "system/CmdLatency.h"
+#include "system/EventTrace.h"
+#include "system/PowerGovernor.h"
+#include "system/OtaPacer.h"
+#include "system/StackPlacer.h"
+#include "system/SelfTest.h"
+#include "system/WellnessSummary.h"
+#include "system/HeapGuard.h"
+#include "storage/CaptureStore.h"
+#include "storage/CoreDumpStore.h"
+#include "sensors/OccupancyEstimator.h"
+#include "sensors/ZoneClassifier.h"
+#include "sensors/SensorBank.h"
+#include "scheduler/ScheduleManager.h"
+#include "security/AlarmSystem.h"
+#include "security/EscalationLadder.h"
+#include "storage/HighRateRing.h"
+#include "storage/HistoryLog.h"
+#include "storage/RollupStore.h"
+#include "system/LatencyStats.h"
+#include "system/MonoClock.h"
+#include "system/RtcClock.h"
+#include "system/RtcState.h"
+#include "system/SettingsStore.h"
+#include "system/SpscRing.h"
+#include "system/StateStore.h"
+#include "system/PowerBench.h"
+#include "system/BatteryProfile.h"
+#include "system/UlpProximity.h"
+#include "system/TestRig.h"
+#include "system/WatchdogSupervisor.h"
 
 // ============================================================================
 // GLOBAL OBJECTS
 // ============================================================================
-DHT dht(DHT_PIN, DHT_TYPE);
-Preferences preferences;
+SettingsStore settingsStore;
 BLEServiceManager bleManager;
+SensorBank sensorBank;
+LedPatternEngine statusLed(STATUS_LED_PIN);
+WatchdogSupervisor watchdog;
+HistoryLog historyLog;
+RollupStore rollupStore;
+HighRateRing highRateRing;
+RtcClock rtcClock;
+
+// Fuses PIR, distance trend and time of day into the confidence score
+// that gates auto-mode actuation.
+OccupancyEstimator occupancyEstimator;
+ZoneClassifier zoneClassifier;
+
+// The whole auto-mode decision chain (trend, latches, PID) lives in
+// one portable object so the replay harness runs the same code.
+AutoModePolicy autoPolicy;
+
+// Tach pulses counted by the PCNT peripheral; proves the fan actually
+// spins at the duty we command.
+FanTach fanTach;
+
+// Melodies rendered by the RMT peripheral; play() returns immediately.
+BuzzerEngine buzzer;
+
+// Local control without the radio: short/long/double press classified
+// in the GPIO ISR, actions ride the same command queue as BLE.
+ButtonEngine userButton;
+
+// Lock-free alarm pipeline: ISRs and timers raise, a top-priority
+// drain task fans out to buzzer, BLE and status LED.
+AlarmSystem alarmSystem;
+
+// Timed stages layered on a standing motion timeout: app re-notify,
+// then caregiver urgency, cancelled the moment motion resumes.
+EscalationLadder escalationLadder;
+
+// Min-heap schedule engine: one esp_timer armed for exactly the next
+// entry's deadline, no periodic scanning.
+ScheduleManager scheduleManager;
+
+// Quantized model blobs served zero-copy from the mapped model
+// partition; deployed independently of the firmware image.
+ModelStore modelStore;
+
+// Single PSRAM block all ML working buffers are carved from at init;
+// sealed after setup, so steady-state inference never touches the heap.
+InferenceArena inferenceArena;
+
+// Blockwise BLE model deployment into the store's inactive bank; a
+// committed update rebinds the detectors without a reboot.
+ModelUpdater modelUpdater;
+
+// Full-image BLE firmware transfer into the inactive OTA slot, for
+// units that never see the WiFi update paths.
+FirmwareUpdater firmwareUpdater;
+
+// Labeled training windows: alarm triggers freeze the high-rate ring
+// into the capture partition, exported over the history-sync channel.
+CaptureStore captureStore;
+
+// Crash dump left by the panic handler, streamed out over BLE on the
+// next boot instead of needing a serial cable.
+CoreDumpStore coreDumpStore;
+
+// On-device routine scoring over 24 h of hourly bins; deviations raise
+// through the alarm pipeline without a cloud round trip.
+AnomalyDetector anomalyDetector;
+
+// Fixed-point fall classifier over the PSRAM high-rate ring.
+FallDetector fallDetector;
+
+// Per-hour quiet-time learner behind the motion-timeout alert.
+OccupancyBaseline occupancyBaseline;
+
+// Optional batched TLS uplink of the history log to the backend;
+// compiled out (and a no-op) unless WIFI_UPLINK_ENABLED.
+CloudUplink cloudUplink;
+
+// ESP-NOW peer exchange between co-located units; gives this unit the
+// whole house's recent motion picture. Opt-in (ESPNOW_MESH_ENABLED)
+// because it keeps the WiFi radio up alongside BLE.
+EspNowMesh espNowMesh;
+
+// Local-broker telemetry for facility installs; compiled out (and a
+// no-op) unless MQTT_TELEMETRY_ENABLED.
+MqttTelemetry mqttTelemetry;
+
+// WebSocket live stream for LAN wall dashboards; compiled out (and a
+// no-op) unless WS_SERVER_ENABLED.
+WsLiveServer wsLiveServer;
+
+// mDNS identity whenever a WiFi feature holds an IP; compiled out
+// with the BLE-only build.
+MdnsAdvertiser mdnsAdvertiser;
+
+// Delta firmware patches over HTTP; compiled out (and a no-op)
+// unless OTA_DELTA_ENABLED.
+DeltaOta deltaOta;
+
+// Minute-cadence heap sampler into RTC slow memory; a reset replays
+// the previous run's final hour for fragmentation forensics.
+HeapMonitor heapMonitor;
+
+// Inference runs on its own idle-priority task on the sensor core;
+// the sensor and BLE paths only enqueue. Per-run duration is recorded
+// so the budget stays visible as models grow.
+struct MlEvent {
+    enum Type : uint8_t {
+        SENSOR_SAMPLE,   // 10 s cycle: temperature + motion level
+        MODEL_REBIND,    // a model update committed; re-resolve weights
+        CAPTURE,         // alarm trigger: freeze the ring to flash
+        DISTANCE_SAMPLE, // high-rate echo landed in the ring
+        PIR_EDGE,        // transition, for fall-recovery tracking
+    } type;
+    float temperature;
+    uint8_t level;
+    uint16_t value;  // CAPTURE only: the alarm's event-specific value
+    uint32_t timestampMs;
+};
+
+// Two inbound paths, split by producer. The sample stream (sensor
+// samples, PIR edges, high-rate echoes) comes from the sensor task
+// alone, so it rides a lock-free SPSC ring: the hot-path handoff is
+// two atomic index updates plus a task notify, no critical section.
+// Control events (model rebinds from the command task, captures from
+// the alarm drain task) are rare and multi-producer, so they keep a
+// FreeRTOS queue. The ML task drains the ring first, then the queue.
+SpscRing<MlEvent, ML_QUEUE_LENGTH> mlSampleRing;
+QueueHandle_t mlQueue;
+TaskHandle_t mlTaskHandle = NULL;
+
+struct MlStats {
+    uint32_t runs;
+    uint32_t drops;     // queue full; the next sample re-scores anyway
+    uint32_t lastRunUs;
+    uint32_t maxRunUs;
+};
+MlStats mlStats = {0, 0, 0, 0};
+
+// Cycle-accurate run latency (feature extraction through alarm raise),
+// read alongside the alarm pipeline's own histogram via CMD_GET_LATENCY.
+LatencyHistogram mlRunLatency;
 
 // ============================================================================
 // GLOBAL VARIABLES
 // ============================================================================
 struct SensorData {
-    float temperature;
-    float humidity;
+    float temperature;     // EWMA-filtered (drives auto mode, BLE, history)
+    float humidity;        // EWMA-filtered
+    float temperatureRaw;  // last raw DHT22 sample
+    float humidityRaw;
+    uint8_t occupancy;     // fused confidence, 0-255
+    uint16_t fanRpm;       // tach-measured, 0 when the fan is off
+    bool sensorFault;      // a sensor channel is quarantined or stalled
     bool motionDetected;
     float distance;
-    unsigned long lastMotionTime;
+    int64_t lastMotionTime; // MonoClock::nowMs(); 0 = none since boot
+    bool stale; // pre-reset RTC snapshot, cleared by the first DHT read
 };
 
 SensorData sensorData;
-bool autoMode = false;
-uint8_t currentFanSpeed = 0;
-uint8_t currentLEDBrightness = 0;
 
-unsigned long lastSensorRead = 0;
-unsigned long lastBLEUpdate = 0;
+// Device-owned control state (fan, LED, auto mode, setpoint) with
+// per-consumer dirty tracking; replaces the old volatile globals. The
+// command task writes it; the NVS coalescer and the GET_STATUS cache
+// drain their dirty masks instead of re-comparing every field.
+StateStore deviceState;
+
+// Duty actually on the peripherals. Can lead the current* values above
+// by micro-adjustments that hit the PWM but weren't worth persisting
+// or notifying (ACTUATOR_DEADBAND in config.h).
+uint8_t appliedFanSpeed = 0;
+uint8_t appliedLEDBrightness = 0;
+
+// A real DHT22 reading landed this boot: only then is sensorData worth
+// snapshotting into RTC memory for the next reset's warm start.
+static bool sensorDataLive = false;
+
+// ============================================================================
+// LOAD SHEDDING
+// ============================================================================
+// When the command queue backs up, work is shed in priority order:
+// logging first, then periodic notifications, then the sensor rate —
+// BLE command handling always keeps its slice. Counters record how
+// often each tier was shed so field load can be sized.
+volatile bool gShedLogging = false;
+
+struct LoadStats {
+    uint32_t logShedEntries;   // times logging was switched off
+    uint32_t pushesShed;       // BLE_PUSH events dropped under load
+    uint32_t sensorDowngrades; // times the sensor rate was degraded
+};
+LoadStats loadStats = {0, 0, 0};
+bool sensorRateDegraded = false;
+
+#if POWER_BENCH_ENABLED
+// Radio-only power bench states park the sensor path on this flag;
+// the event queue keeps draining so the watchdog stays fed.
+volatile bool gPowerBenchSensorsIdle = false;
+#endif
+
+// ============================================================================
+// FREERTOS OBJECTS
+// ============================================================================
+// Sensor acquisition runs pinned to core 0; BLE servicing and actuator
+// commands run pinned to core 1. The two sides only talk through queues,
+// so a slow sensor read can never delay a user command.
+TaskHandle_t sensorTaskHandle = NULL;
+TaskHandle_t bleTaskHandle = NULL;
+
+// Depth-1 queue holding the latest sensor snapshot (writer overwrites).
+QueueHandle_t sensorDataQueue = NULL;
+
+// Work items for the BLE/command task: actuator commands from the BLE
+// callbacks and auto mode, plus periodic events posted by esp_timer.
+struct Command {
+    enum Type : uint8_t {
+        FAN_SPEED,
+        LED_BRIGHTNESS,
+        LED_FADE,       // hardware fade to value over duration
+        AUTO_MODE,
+        FAN_SETPOINT,   // user PID setpoint, centi-°C in duration
+        SCENE_APPLY,    // apply a stored scene preset atomically
+        SCENE_SAVE,     // drain pending scene definitions into the blob
+        ALARM_SILENCE,  // quiet the siren (button long press)
+        BLE_PUSH,       // periodic notification deadline
+        SCHEDULE_CHECK, // periodic schedule evaluation deadline
+        PREFS_FLUSH,    // deferred NVS commit deadline
+        BATTERY_SLEEP,  // duty-cycle window spent (battery profile)
+    };
+    Type type;
+    uint8_t value;
+    uint16_t duration; // LED_FADE ms; FAN_SETPOINT centi-°C
+
+    // Command-to-actuation latency: BLE-originated commands carry
+    // their RX arrival stamp (esp_timer µs) and opcode through the
+    // queue; 0 marks internal work (timers, schedules), which isn't
+    // user-perceived and isn't recorded.
+    uint8_t opcode;
+    int64_t arrivalUs;
+};
+QueueHandle_t commandQueue = NULL;
+
+// Scene definitions are too wide for a Command, so the BLE callback
+// parks them here and enqueues SCENE_SAVE; the command task drains
+// this queue into the settings blob (its thread, no locking).
+struct SceneDefinition {
+    uint8_t index;
+    ScenePreset preset;
+};
+QueueHandle_t sceneDefQueue = NULL;
+
+// Work items for the sensor task: timestamped PIR edges from the GPIO
+// ISR and periodic read deadlines posted by esp_timer. Both tasks block
+// on their queues with no timeout — every deadline arrives as an event.
+struct SensorEvent {
+    enum Type : uint8_t { MOTION_EDGE, READ_DUE, HIGHRATE_DUE };
+    Type type;
+    bool level;
+    unsigned long timestampMs;
+};
+QueueHandle_t sensorEventQueue = NULL;
+
+// Periodic deadline timers (exact, no polling jitter).
+esp_timer_handle_t sensorReadTimer = NULL;
+esp_timer_handle_t bleUpdateTimer = NULL;
+esp_timer_handle_t scheduleCheckTimer = NULL;
+esp_timer_handle_t highRateTimer = NULL;
+
+// ============================================================================
+// DEFERRED PREFERENCE WRITES
+// ============================================================================
+// Setters update RAM and mark their key dirty; the actual NVS commit is
+// a one-shot deadline that re-arms on every change (quiet period) but
+// never slips past PREFS_FLUSH_MAX_MS from the first dirty mark. All
+// marking and flushing runs on the BLE/command task, so no locking.
+enum PrefDirtyBits : uint8_t {
+    PREF_DIRTY_FAN = 0x01,
+    PREF_DIRTY_LED = 0x02,
+    PREF_DIRTY_AUTO = 0x04,
+    PREF_DIRTY_WEAR = 0x08, // flash wear counters drifted from the blob
+    PREF_DIRTY_SCENE = 0x10, // scene presets edited in the blob
+    PREF_DIRTY_SETPOINT = 0x20, // user PID setpoint edited in the blob
+};
+uint8_t prefsDirty = 0;
+int64_t prefsFirstDirtyUs = 0;
+esp_timer_handle_t prefsFlushTimer = NULL;
+
+// History-log erases already folded into the persisted wear counter.
+uint32_t syncedHistoryErases = 0;
+
+// Dirty-state shadow in RTC slow memory, maintained eagerly on every
+// mark (a RAM write) and cleared on flush. A brownout resets the chip
+// before the deferred NVS commit can run, but RTC memory survives the
+// reset, so setup() replays the shadowed values — recovery is instant
+// and needs no work in the brownout window itself.
+#define RTC_SHADOW_MAGIC 0x53485357
+RTC_NOINIT_ATTR uint32_t rtcShadowMagic;
+RTC_NOINIT_ATTR uint8_t rtcShadowAuto;
+RTC_NOINIT_ATTR uint8_t rtcShadowFan;
+RTC_NOINIT_ATTR uint8_t rtcShadowLed;
+RTC_NOINIT_ATTR uint8_t rtcShadowDirty;
+
+// ============================================================================
+// INTERRUPT SERVICE ROUTINES
+// ============================================================================
+void IRAM_ATTR pirISR() {
+    // EMI gate (debounce stage 1): fan-PWM switching couples
+    // microsecond edge bursts onto the PIR line, and each would
+    // otherwise wake the sensor task. Edges closer than
+    // PIR_GLITCH_REJECT_US to the previous one are dropped right
+    // here. The cycle counter wraps every ~18 s at 240 MHz; a wrap
+    // can only admit one edge early, which stage 2 still checks.
+    static uint32_t lastEdgeCycles = 0;
+    uint32_t nowCycles = xthal_get_ccount();
+    if ((uint32_t)(nowCycles - lastEdgeCycles) <
+        PIR_GLITCH_REJECT_US * (F_CPU / 1000000)) {
+        return;
+    }
+    lastEdgeCycles = nowCycles;
+
+    TEST_RIG_PULSE(TEST_RIG_PIN_SENSOR);
+    SensorEvent evt;
+    evt.type = SensorEvent::MOTION_EDGE;
+    evt.level = (digitalRead(PIR_PIN) == HIGH);
+    evt.timestampMs = (unsigned long)(esp_timer_get_time() / 1000);
+
+    BaseType_t higherPriorityWoken = pdFALSE;
+    xQueueSendFromISR(sensorEventQueue, &evt, &higherPriorityWoken);
+    if (higherPriorityWoken) {
+        portYIELD_FROM_ISR();
+    }
+
+    // A rising edge also feeds the alarm pipeline, which clears any
+    // standing motion-timeout alarm (no-op otherwise).
+    if (evt.level) {
+        alarmSystem.raiseFromISR(AlarmSystem::ALARM_MOTION_RESUMED, 0);
+    }
+}
+
+// Proximity watch rides the ultrasonic echo ISR: the breach test runs
+// the instant the edge timestamp resolves — integer compare on the
+// fixed-point millimetre distance, trigger-to-alarm well under a
+// millisecond regardless of what the tasks are doing. Hysteresis: a
+// breach arms below the threshold but only clears beyond threshold
+// plus band, and only state changes raise events, so a resident
+// hovering at the edge costs nothing per echo instead of chattering
+// breach/clear pairs.
+void IRAM_ATTR onProximityEcho(uint32_t distanceMm) {
+    static bool breached = false;
+    if (!breached) {
+        if (distanceMm == 0 ||
+            distanceMm >= (uint32_t)PROXIMITY_THRESHOLD * 10) {
+            return;
+        }
+        breached = true;
+        alarmSystem.raiseFromISR(AlarmSystem::ALARM_PROXIMITY_BREACH,
+                                 (uint16_t)(distanceMm / 10));
+    } else {
+        // A zero (no echo) never clears: absence of an echo is not
+        // evidence the resident moved away.
+        if (distanceMm <
+            (uint32_t)(PROXIMITY_THRESHOLD + PROXIMITY_HYSTERESIS) * 10) {
+            return;
+        }
+        breached = false;
+        alarmSystem.raiseFromISR(AlarmSystem::ALARM_PROXIMITY_CLEAR,
+                                 (uint16_t)(distanceMm / 10));
+    }
+}
+
+// Button presses become commands right in the edge ISR — press to
+// LEDC write is one queue hop on the command task, the same fast path
+// BLE commands ride minus the radio. The eager short (see
+// ButtonEngine.h) means a double or long press must first put the fan
+// duty back where its down edge found it.
+volatile uint8_t buttonFanPrev = 0;   // duty before the eager step
+volatile uint8_t buttonLedLastOn = 255; // brightness the toggle restores
+
+void IRAM_ATTR onButtonPress(ButtonEngine::Press press) {
+    TEST_RIG_PULSE(TEST_RIG_PIN_SENSOR);
+    Command cmd = {};
+    BaseType_t higherPriorityWoken = pdFALSE;
+
+    switch (press) {
+        case ButtonEngine::PRESS_SHORT: {
+            uint8_t duty = (uint8_t)deviceState.fanSpeed();
+            buttonFanPrev = duty;
+            uint16_t next =
+                ((uint16_t)(duty / BUTTON_FAN_STEP) + 1) * BUTTON_FAN_STEP;
+            cmd.type = Command::FAN_SPEED;
+            cmd.value = (next > 255) ? 0 : (uint8_t)next;
+            xQueueSendFromISR(commandQueue, &cmd, &higherPriorityWoken);
+            break;
+        }
+        case ButtonEngine::PRESS_DOUBLE: {
+            cmd.type = Command::FAN_SPEED;
+            cmd.value = buttonFanPrev;
+            xQueueSendFromISR(commandQueue, &cmd, &higherPriorityWoken);
+
+            uint8_t led = (uint8_t)deviceState.ledBrightness();
+            if (led > 0) {
+                buttonLedLastOn = led;
+            }
+            cmd.type = Command::LED_BRIGHTNESS;
+            cmd.value = (led > 0) ? 0 : buttonLedLastOn;
+            xQueueSendFromISR(commandQueue, &cmd, &higherPriorityWoken);
+            break;
+        }
+        case ButtonEngine::PRESS_LONG: {
+            cmd.type = Command::FAN_SPEED;
+            cmd.value = buttonFanPrev;
+            xQueueSendFromISR(commandQueue, &cmd, &higherPriorityWoken);
+
+            cmd.type = Command::ALARM_SILENCE;
+            cmd.value = 0;
+            xQueueSendFromISR(commandQueue, &cmd, &higherPriorityWoken);
+            break;
+        }
+    }
+
+    if (higherPriorityWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// ============================================================================
+// DEADLINE TIMER CALLBACKS
+// ============================================================================
+void onSensorReadDue(void* arg) {
+    SensorEvent evt = { SensorEvent::READ_DUE, false, 0 };
+    xQueueSend(sensorEventQueue, &evt, 0);
+}
+
+void onBLEUpdateDue(void* arg) {
+    Command cmd = { Command::BLE_PUSH, 0 };
+    xQueueSend(commandQueue, &cmd, 0);
+}
+
+void onScheduleCheckDue(void* arg) {
+    Command cmd = { Command::SCHEDULE_CHECK, 0 };
+    xQueueSend(commandQueue, &cmd, 0);
+}
+
+void onHighRateDue(void* arg) {
+    SensorEvent evt = { SensorEvent::HIGHRATE_DUE, false, 0 };
+    xQueueSend(sensorEventQueue, &evt, 0);
+}
+
+void onPrefsFlushDue(void* arg) {
+    Command cmd = { Command::PREFS_FLUSH, 0 };
+    xQueueSend(commandQueue, &cmd, 0);
+}
 
 // ============================================================================
 // CALLBACK FUNCTIONS
 // ============================================================================
+// BLE callbacks run in the NimBLE host task context; they only enqueue
+// work so the radio stack is never blocked by flash or PWM writes.
+// Each copies the dispatching command's arrival stamp into the queued
+// Command so the command task can record the full span at actuation.
+static void stampCommand(Command& cmd) {
+    cmd.opcode = bleManager.currentCommandOpcode();
+    cmd.arrivalUs = bleManager.currentCommandArrivalUs();
+}
+
 void onFanSpeedChanged(uint8_t speed) {
-    setFanSpeed(speed);
+    Command cmd = { Command::FAN_SPEED, speed };
+    stampCommand(cmd);
+    xQueueSend(commandQueue, &cmd, 0);
 }
 
 void onLEDBrightnessChanged(uint8_t brightness) {
-    setLEDBrightness(brightness);
+    Command cmd = { Command::LED_BRIGHTNESS, brightness };
+    stampCommand(cmd);
+    xQueueSend(commandQueue, &cmd, 0);
+}
+
+void onLEDFadeRequested(uint8_t target, uint16_t durationMs) {
+    Command cmd = { Command::LED_FADE, target, durationMs };
+    stampCommand(cmd);
+    xQueueSend(commandQueue, &cmd, 0);
 }
 
 void onAutoModeChanged(bool enabled) {
-    autoMode = enabled;
-    preferences.putBool(PREF_AUTO_MODE, enabled);
-    DEBUG_PRINTF("Auto mode %s\n", enabled ? "ENABLED" : "DISABLED");
+    Command cmd = { Command::AUTO_MODE, (uint8_t)enabled };
+    stampCommand(cmd);
+    xQueueSend(commandQueue, &cmd, 0);
+}
+
+void onFanSetpointChanged(int16_t centi) {
+    Command cmd = { Command::FAN_SETPOINT, 0, (uint16_t)centi };
+    stampCommand(cmd);
+    xQueueSend(commandQueue, &cmd, 0);
+}
+
+void onSceneApplyRequested(uint8_t index) {
+    Command cmd = { Command::SCENE_APPLY, index };
+    stampCommand(cmd);
+    xQueueSend(commandQueue, &cmd, 0);
+}
+
+void onSceneDefineRequested(uint8_t index, const ScenePreset& preset) {
+    SceneDefinition def = { index, preset };
+    if (xQueueSend(sceneDefQueue, &def, 0) != pdTRUE) {
+        return; // definition burst overflow; the app retries
+    }
+    Command cmd = { Command::SCENE_SAVE, 0 };
+    stampCommand(cmd);
+    xQueueSend(commandQueue, &cmd, 0);
+}
+
+// Normalized command from a non-BLE source — a relayed peer command
+// over the mesh (WiFi task context) or a typed CLI test command (log
+// drain task) — enqueued onto the same command queue the BLE callbacks
+// feed. The mesh side vetted opcodes against the aggregation whitelist
+// before relaying; this switch is the defense on the receiving side,
+// so a forged frame can at worst do what a local button press could.
+void onRelayedCommand(uint8_t opcode, const uint8_t* payload,
+                      uint8_t length) {
+    if ((int)length < CommandParser::minPayload(opcode)) {
+        return;
+    }
+    Command cmd;
+    switch (opcode) {
+        case CMD_SET_FAN:
+            cmd = { Command::FAN_SPEED, payload[0] };
+            break;
+        case CMD_SET_LED:
+            cmd = { Command::LED_BRIGHTNESS, payload[0] };
+            break;
+        case CMD_SET_LED_FADE: {
+            uint16_t durationMs =
+                (uint16_t)payload[1] | ((uint16_t)payload[2] << 8);
+            cmd = { Command::LED_FADE, payload[0], durationMs };
+            break;
+        }
+        case CMD_SET_AUTO:
+            cmd = { Command::AUTO_MODE, payload[0] };
+            break;
+        case CMD_SET_SETPOINT: {
+            int16_t centi;
+            memcpy(&centi, payload, sizeof(centi));
+            cmd = { Command::FAN_SETPOINT, 0, (uint16_t)centi };
+            break;
+        }
+        case CMD_SET_SCENE:
+            cmd = { Command::SCENE_APPLY, payload[0] };
+            break;
+        default:
+            return;
+    }
+    xQueueSend(commandQueue, &cmd, 0);
+}
+
+// Schedule deadlines fire in esp_timer context; like the BLE
+// callbacks, they only enqueue so actuation stays on the command task.
+void onScheduleAction(uint8_t action, uint8_t value) {
+    Command cmd;
+    switch (action) {
+        case ScheduleManager::ACTION_FAN_SPEED:
+            cmd = { Command::FAN_SPEED, value };
+            break;
+        case ScheduleManager::ACTION_LED_BRIGHTNESS:
+            cmd = { Command::LED_BRIGHTNESS, value };
+            break;
+        case ScheduleManager::ACTION_AUTO_MODE:
+            cmd = { Command::AUTO_MODE, value };
+            break;
+        default:
+            return;
+    }
+    xQueueSend(commandQueue, &cmd, 0);
+}
+
+// Diagnostics: persisted lifetime wear plus erases not yet flushed.
+void onFlashHealthRequested(FlashHealthFrame& frame) {
+    frame.nvsCommits = settingsStore.data().nvsCommits;
+    frame.historyErases = settingsStore.data().historyErases +
+                          (historyLog.eraseCount() - syncedHistoryErases);
+    frame.historySectors = (uint16_t)historyLog.sectorCount();
 }
 
 // ============================================================================
@@ -55,95 +667,1330 @@ void setupPins();
 void setupSensors();
 void setupPWM();
 void setupBLE();
+void setupPowerManagement();
+void setupTasks();
+void setupTimers();
+void sensorTask(void* pvParameters);
+void bleTask(void* pvParameters);
+void mlTask(void* pvParameters);
+void queueMlEvent(uint8_t type, float temperature, uint8_t level,
+                  uint32_t timestampMs);
+void queueMlControl(const MlEvent& evt);
+void runMlEvent(const MlEvent& evt);
+void updateLoadShedding();
+void handleMotionEvent(const SensorEvent& evt);
+void sampleHighRate();
+void setHighRateInterval(uint32_t intervalMs);
+void decayHighRateInterval();
+void pushSensorUpdate();
+void checkSchedules();
 void readSensors();
+void checkFanStall();
 void updateAutoMode();
+void applyCommand(const Command& cmd);
+void applyScene(uint8_t index);
+void saveSceneDefinitions();
 void setFanSpeed(uint8_t speed);
 void setLEDBrightness(uint8_t brightness);
+void setLEDBrightnessFade(uint8_t target, uint16_t durationMs);
 void checkMotionTimeout();
+extern bool motionTimeoutRaised; // defined with checkMotionTimeout()
+extern bool fanStallLatched;     // defined with checkFanStall()
+void markPrefDirty(uint8_t bit);
+void flushPreferences();
+void prefsShutdownFlush();
+
+// Hot-path latency aggregates for CMD_GET_LATENCY. The reads race the
+// recording tasks only field-by-field — fine for diagnostics; reset
+// between stress-test passes, not mid-burst.
+void onLatencyRequested(LatencyStatsFrame& frame, bool reset) {
+    frame.mlRun.count = mlRunLatency.count();
+    frame.mlRun.minUs = mlRunLatency.minUs();
+    frame.mlRun.avgUs = mlRunLatency.avgUs();
+    frame.mlRun.maxUs = mlRunLatency.maxUs();
+    frame.mlRun.p99Us = mlRunLatency.p99Us();
+
+    LatencyHistogram& dispatch = alarmSystem.dispatchLatency();
+    frame.alarmDispatch.count = dispatch.count();
+    frame.alarmDispatch.minUs = dispatch.minUs();
+    frame.alarmDispatch.avgUs = dispatch.avgUs();
+    frame.alarmDispatch.maxUs = dispatch.maxUs();
+    frame.alarmDispatch.p99Us = dispatch.p99Us();
+
+    if (reset) {
+        mlRunLatency.reset();
+        dispatch.reset();
+    }
+}
+
+// Heap health for CMD_GET_HEAP; the monitor owns the RTC-memory ring.
+void onHeapStatsRequested(HeapStatsFrame& frame) {
+    heapMonitor.fill(frame);
+}
+
+// Main-side fields of the periodic soak frame (CMD_SOAK): the queues
+// and shed counters only this file can see. Depth reads race the
+// producers harmlessly — a soak curve cares about trend, not the
+// exact message count at one instant.
+void onSoakSample(SoakMetricsFrameHeader& frame) {
+    frame.cmdQueueDepth = (uint8_t)uxQueueMessagesWaiting(commandQueue);
+    frame.sensorEventQueueDepth =
+        (uint8_t)uxQueueMessagesWaiting(sensorEventQueue);
+    frame.mlQueueDepth = (uint8_t)(uxQueueMessagesWaiting(mlQueue) +
+                                   mlSampleRing.depth());
+    frame.mlDrops = mlStats.drops;
+    frame.pushesShed = loadStats.pushesShed;
+}
+
+// A model update committed on the BLE task; the detectors rebind on
+// the ML task, which owns their state.
+void onModelCommitted() {
+    MlEvent evt;
+    evt.type = MlEvent::MODEL_REBIND;
+    evt.temperature = 0.0f;
+    evt.level = 0;
+    evt.value = 0;
+    evt.timestampMs = millis();
+    queueMlControl(evt);
+}
+
+// An alarm worth a training window fired; the flash write happens on
+// the ML task, far below the alarm pipeline's latency budget.
+void onCaptureTriggered(uint8_t type, uint16_t value) {
+    MlEvent evt;
+    evt.type = MlEvent::CAPTURE;
+    evt.temperature = 0.0f;
+    evt.level = type;
+    evt.value = value;
+    evt.timestampMs = millis();
+    queueMlControl(evt);
+}
+
+// Mirror every alarm event to the broker path; esp-mqtt enqueues
+// without blocking, so the drain task keeps its budget.
+void onAlarmMirrored(uint8_t type, uint16_t value, uint32_t timestampMs) {
+    mqttTelemetry.queueAlert(type, value, timestampMs);
+
+    // Emergencies (and their clears) also fan out to the other units
+    // over ESP-NOW, so the whole house sounds. Only local-origin
+    // events go out: ALARM_REMOTE_* never re-broadcasts, which is
+    // what keeps two units from feeding each other.
+    switch (type) {
+        case AlarmSystem::ALARM_PROXIMITY_BREACH:
+        case AlarmSystem::ALARM_FALL_SUSPECTED:
+        case AlarmSystem::ALARM_PROXIMITY_CLEAR:
+        case AlarmSystem::ALARM_FALL_CLEAR:
+            espNowMesh.broadcastAlarm(type, value);
+            break;
+    }
+}
+
+// A peer unit's alarm, already deduplicated by the mesh. WiFi task
+// context: raise() is the same lock-free slot claim every other
+// producer uses, so this is enqueue, not actuation.
+void onPeerAlarm(uint8_t type, uint16_t value) {
+    switch (type) {
+        case AlarmSystem::ALARM_PROXIMITY_BREACH:
+        case AlarmSystem::ALARM_FALL_SUSPECTED:
+            alarmSystem.raise(AlarmSystem::ALARM_REMOTE_EMERGENCY, type);
+            break;
+        case AlarmSystem::ALARM_PROXIMITY_CLEAR:
+        case AlarmSystem::ALARM_FALL_CLEAR:
+            alarmSystem.raise(AlarmSystem::ALARM_REMOTE_CLEAR, type);
+            break;
+    }
+}
+
+// ============================================================================
+// BOOT INSTRUMENTATION
+// ============================================================================
+// Per-stage timestamps so the time-to-advertising budget (500 ms) is
+// measurable on every boot instead of guessed at.
+struct BootStage {
+    const char* name;
+    uint32_t ms;
+};
+BootStage bootStages[BOOT_STAGE_MAX];
+uint8_t bootStageCount = 0;
+int64_t bootStagePrevUs = 0;
+
+// The previous boot's breakdown shadows in RTC memory across the
+// reset, so a slow boot reported from the field is examined after the
+// fact through CMD_GET_BOOT instead of reproduced on a bench.
+#define RTC_BOOT_MAGIC 0x54425353 // "SSBT"
+RTC_NOINIT_ATTR uint32_t rtcBootMagic;
+RTC_NOINIT_ATTR uint8_t rtcBootStageCount;
+RTC_NOINIT_ATTR uint16_t rtcBootStagesMs[BOOT_STAGE_MAX];
+
+uint16_t prevBootStagesMs[BOOT_STAGE_MAX];
+uint8_t prevBootStageCount = 0;
+
+void bootMark(const char* name) {
+    int64_t nowUs = esp_timer_get_time();
+    if (bootStageCount < (sizeof(bootStages) / sizeof(bootStages[0]))) {
+        bootStages[bootStageCount].name = name;
+        bootStages[bootStageCount].ms =
+            (uint32_t)((nowUs - bootStagePrevUs) / 1000);
+        bootStageCount++;
+    }
+    bootStagePrevUs = nowUs;
+}
+
+void bootReport() {
+    // Pull the previous boot's shadow before overwriting it.
+    if (rtcBootMagic == RTC_BOOT_MAGIC &&
+        rtcBootStageCount <= BOOT_STAGE_MAX) {
+        prevBootStageCount = rtcBootStageCount;
+        memcpy(prevBootStagesMs, rtcBootStagesMs, sizeof(prevBootStagesMs));
+    }
+
+    DEBUG_PRINTLN("Boot stages:");
+    uint32_t totalMs = 0;
+    for (uint8_t i = 0; i < bootStageCount; i++) {
+        totalMs += bootStages[i].ms;
+        if (i < prevBootStageCount) {
+            DEBUG_PRINTF("  %-10s %4u ms (%u ms in, prev %u ms)\n",
+                         bootStages[i].name, bootStages[i].ms, totalMs,
+                         prevBootStagesMs[i]);
+        } else {
+            DEBUG_PRINTF("  %-10s %4u ms (%u ms in)\n",
+                         bootStages[i].name, bootStages[i].ms, totalMs);
+        }
+    }
+
+    rtcBootStageCount = bootStageCount;
+    for (uint8_t i = 0; i < bootStageCount; i++) {
+        uint32_t ms = bootStages[i].ms;
+        rtcBootStagesMs[i] = (ms > 0xFFFF) ? 0xFFFF : (uint16_t)ms;
+    }
+    rtcBootMagic = RTC_BOOT_MAGIC;
+}
+
+// Boot-stage timings for CMD_GET_BOOT: this boot plus the RTC-
+// shadowed previous one. Stage order is the bootMark() order in
+// setup(); the app mirrors the names.
+void onBootStatsRequested(BootStatsFrame& frame) {
+    frame.stageCount = bootStageCount;
+    for (uint8_t i = 0; i < bootStageCount; i++) {
+        uint32_t ms = bootStages[i].ms;
+        frame.stagesMs[i] = (ms > 0xFFFF) ? 0xFFFF : (uint16_t)ms;
+    }
+    frame.prevStageCount = prevBootStageCount;
+    memcpy(frame.prevStagesMs, prevBootStagesMs, sizeof(frame.prevStagesMs));
+    frame.resetReason = (uint8_t)esp_reset_reason();
+}
 
 // ============================================================================
 // SETUP
 // ============================================================================
+// Ordered for time-to-advertising: the radio comes up before anything
+// that can wait. No serial-wait — a headless unit must not stall on a
+// monitor that is never attached. Sensor warmup rides behind
+// everything else; the first READ_DUE deadline is 10 s out anyway.
+//
+// The two expensive, independent halves run on separate cores: the
+// NimBLE controller bring-up (hundreds of ms) on core 0 while this
+// core works through settings, actuators and storage, joining before
+// the tasks stage — cold boot costs max(radio, the rest) instead of
+// their sum.
+
+// BLE bring-up worker. setupBLE() touches nothing the concurrent
+// stages write (they only assign unrelated bleManager sinks, exactly
+// as they already did after advertising went live), so the only
+// ordering that matters is the join in setup().
+static void bleBringupTask(void* param) {
+    setupBLE();
+    xTaskNotifyGive((TaskHandle_t)param);
+    vTaskDelete(NULL);
+}
+
 void setup() {
+    bootStagePrevUs = esp_timer_get_time();
+
     #if DEBUG_SERIAL
     Serial.begin(DEBUG_BAUD_RATE);
-    while (!Serial) delay(10);
+    // Drain task for the deferred log ring; DEBUG_* lines queued
+    // before this flush the moment it first runs.
+    RingLogger::begin();
     DEBUG_PRINTLN("\n=================================");
     DEBUG_PRINTLN("SmartSync ESP32 Starting...");
-    DEBUG_PRINTF("Firmware Version: %s\n", FIRMWARE_VERSION);
+    DEBUG_PRINTF("Firmware Version: %s (%s)\n", FIRMWARE_VERSION, BUILD_INFO);
     DEBUG_PRINTLN("=================================\n");
     #endif
+    bootMark("serial");
 
+    #if BATTERY_PROFILE_ENABLED
+    // Classify the wake cause before anything else so the PIR fast
+    // path below can steer setup.
+    BatteryProfile::begin();
+    #endif
+
+    // Judges this boot when an OTA is pending: may roll back and
+    // restart right here. Must precede the BLE spawn below, or the
+    // worker could report its milestone before probation is armed.
+    BootHealthGate::begin();
+
+    // Radio first: caregivers see the unit the moment it has power.
+    // Bring-up runs on core 0 (where the NimBLE host task lands
+    // anyway) while this core continues below; joined before the
+    // tasks stage. Sequential fallback if the task slot is denied.
+    bool bleBootDeferred = xTaskCreatePinnedToCore(
+        bleBringupTask, "ble_boot", BLE_TASK_STACK,
+        xTaskGetCurrentTaskHandle(), 2, NULL, 0) == pdPASS;
+    if (!bleBootDeferred) {
+        setupBLE();
+    }
+    bootMark("ble_spawn");
+
+    // Settings: one journal read, then replay any brownout shadow.
+    settingsStore.begin();
+    deviceState.setAutoMode(settingsStore.data().autoMode != 0);
+    deviceState.setFanSpeed(settingsStore.data().fanSpeed);
+    deviceState.setLedBrightness(settingsStore.data().ledBrightness);
+    // Per-unit PID setpoint override; 0 keeps the compile-time default.
+    deviceState.setSetpointCenti(settingsStore.data().fanSetpointCenti);
+    autoPolicy.controller().setSetpointCenti(
+        settingsStore.data().fanSetpointCenti);
+    bleManager.attachStateStore(&deviceState);
+    // One-read configuration sync: the app pulls the whole settings
+    // blob from the settings characteristic at launch.
+    bleManager.setSettingsSource(&settingsStore);
+    // Session auth credentials come from the settings blob; a zero
+    // PIN (unprovisioned) leaves every command open as before.
+    bleManager.setAuthCredentials(settingsStore.data().devicePin,
+                                  settingsStore.data().deviceId);
+
+    if (rtcShadowMagic == RTC_SHADOW_MAGIC && rtcShadowDirty) {
+        deviceState.setAutoMode(rtcShadowAuto != 0);
+        deviceState.setFanSpeed(rtcShadowFan);
+        deviceState.setLedBrightness(rtcShadowLed);
+        prefsDirty |= PREF_DIRTY_FAN | PREF_DIRTY_LED | PREF_DIRTY_AUTO;
+        flushPreferences();
+        DEBUG_PRINTLN("Recovered unsaved settings from RTC shadow");
+    }
+    rtcShadowMagic = RTC_SHADOW_MAGIC;
+    rtcShadowDirty = 0;
+    bootMark("settings");
+
+    // Actuators back to their saved state.
     setupPins();
     setupPWM();
+    setFanSpeed(deviceState.fanSpeed());
+    setLEDBrightness(deviceState.ledBrightness());
+    bootMark("actuators");
+
+    WatchdogSupervisor::logResetCause();
+    RtcState::begin();
+    if (RtcState::carriedOver() && RtcState::data().alertPendingValid) {
+        // An alert the phone never confirmed rode RTC memory through
+        // the reset — back into the redelivery queue it goes.
+        bleManager.sendAlert(RtcState::data().alertPendingType,
+                             RtcState::data().alertPendingValue,
+                             RtcState::data().alertPendingStampMs);
+    }
+    historyLog.begin();
+    rollupStore.begin();
+    highRateRing.begin();
+    captureStore.begin();
+    coreDumpStore.begin();
+    // rtcClock.begin() runs later (sensors stage); the uplink only
+    // dereferences the clock at upload time, minutes after boot.
+    cloudUplink.begin(&historyLog, &rtcClock);
+    espNowMesh.begin();
+    espNowMesh.onCommand(onRelayedCommand);
+    espNowMesh.onAlarm(onPeerAlarm);
+    mqttTelemetry.begin();
+    wsLiveServer.begin();
+    mdnsAdvertiser.begin(&settingsStore);
+    deltaOta.begin();
+    heapMonitor.begin();
+    EventTrace::begin();
+    // Idle-slice self-test: evidence rides the sensor read path, the
+    // checks run only when the event queue is empty (sensorTask).
+    SelfTest::begin(&settingsStore, &rtcClock);
+    // Morning wellness record: seals once per day from the hour
+    // rollups plus the night's live zone/alarm tallies.
+    WellnessSummary::begin(&rollupStore, &rtcClock);
+    #if SERIAL_CLI_ENABLED
+    // Bench diagnostics over the same UART the log drain task owns;
+    // test commands enqueue like the mesh relay's.
+    SerialCli::begin(&deviceState, &settingsStore, onRelayedCommand);
+    BulkDump::begin(&historyLog, &coreDumpStore);
+    #endif
+    bleManager.setHistorySource(&historyLog);
+    bleManager.setRollupSource(&rollupStore);
+    bleManager.setMeshRelay(&espNowMesh);
+    bleManager.setCaptureSource(&captureStore);
+    bleManager.setCoreDumpSource(&coreDumpStore);
+    bootMark("storage");
+
+    // Join the radio bring-up: past this point tasks and the
+    // watchdog's SUBSYS_BLE deadline assume the service is up. On a
+    // typical boot the radio finished while storage was mounting and
+    // this costs nothing.
+    if (bleBootDeferred) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    bootMark("ble_join");
+
+    setupTasks();
+    watchdog.begin();
+    setupPowerManagement();
+
+    // Planned restarts (esp_restart) flush deferred settings first.
+    esp_register_shutdown_handler(prefsShutdownFlush);
+    bootMark("tasks");
+
+    // Deferred: the DHT22 needs ~2 s after power before its first
+    // conversion, so nothing is lost by bringing sensors up last.
     setupSensors();
-    setupBLE();
+    bootMark("sensors");
 
-    // Load preferences
-    preferences.begin(PREF_NAMESPACE, false);
-    autoMode = preferences.getBool(PREF_AUTO_MODE, false);
-    currentFanSpeed = preferences.getUInt(PREF_FAN_SPEED, 0);
-    currentLEDBrightness = preferences.getUInt(PREF_LED_BRIGHTNESS, 128);
+    #if BATTERY_PROFILE_ENABLED
+    // A PIR wake consumed its edge powering the chip up, so the GPIO
+    // ISR never saw it; replay it into the sensor pipeline (alarm
+    // clear, occupancy, high-rate ring) instead of waiting for the
+    // next physical edge. Either way the wake's sensor window runs
+    // immediately rather than at the first timer deadline.
+    if (BatteryProfile::wokeOnMotion()) {
+        SensorEvent motionEvt;
+        motionEvt.type = SensorEvent::MOTION_EDGE;
+        motionEvt.level = digitalRead(PIR_PIN) == HIGH;
+        motionEvt.timestampMs = millis();
+        xQueueSend(sensorEventQueue, &motionEvt, 0);
+    }
+    // Same replay for a ULP proximity wake: the breach was confirmed
+    // while the cores slept, so raise it now rather than waiting for
+    // the first awake echo to re-cross the threshold. onProximityEcho
+    // takes over (including the eventual clear) once the ultrasonic
+    // driver is pinging again.
+    if (BatteryProfile::wokeOnProximity()) {
+        alarmSystem.raise(AlarmSystem::ALARM_PROXIMITY_BREACH,
+                          UlpProximity::lastDistanceCm());
+    }
+    SensorEvent readEvt = { SensorEvent::READ_DUE, false, 0 };
+    xQueueSend(sensorEventQueue, &readEvt, 0);
+    #endif
 
-    // Apply saved settings
-    setFanSpeed(currentFanSpeed);
-    setLEDBrightness(currentLEDBrightness);
+    // Power bench schedule starts only once everything it measures is
+    // up; no-op in production builds.
+    POWER_BENCH_BEGIN(applyPowerBenchState);
 
-    DEBUG_PRINTLN("Setup complete. Entering main loop...\n");
+    bootReport();
+    // One line per live task: stack home (DRAM/PSRAM) and high-water
+    // margin, so a placement regression shows on every boot log.
+    StackPlacer::audit();
+    // Audible ready: costs nothing here, the RMT plays it out.
+    buzzer.play(BuzzerEngine::MELODY_CHIME);
+    // Setup's one-time pools are all allocated by now; from here on
+    // our tasks are meant to be allocation-free (heapguard env traps
+    // anything that isn't).
+    HeapGuard::arm();
+    DEBUG_PRINTLN("Setup complete. Tasks running.\n");
 }
 
 // ============================================================================
 // MAIN LOOP
 // ============================================================================
 void loop() {
-    unsigned long currentMillis = millis();
+    // All work happens in the pinned tasks; park the Arduino loop task.
+    vTaskDelay(portMAX_DELAY);
+}
 
-    // Update BLE connection status
-    bleManager.update();
+// ============================================================================
+// TASK SETUP
+// ============================================================================
+void setupTasks() {
+    DEBUG_PRINTLN("Creating FreeRTOS tasks...");
+
+    sensorDataQueue = xQueueCreate(1, sizeof(SensorData));
+    if (sensorData.stale) {
+        // Warm-started snapshot (setupSensors): make it the first
+        // frame an early connection sees, not an empty queue.
+        xQueueOverwrite(sensorDataQueue, &sensorData);
+    }
+    commandQueue = xQueueCreate(COMMAND_QUEUE_LENGTH, sizeof(Command));
+    sceneDefQueue = xQueueCreate(SCENE_MAX_COUNT, sizeof(SceneDefinition));
+    sensorEventQueue = xQueueCreate(SENSOR_EVENT_QUEUE_LENGTH, sizeof(SensorEvent));
+    mlQueue = xQueueCreate(ML_QUEUE_LENGTH, sizeof(MlEvent));
+
+    // Rig pins must be outputs before the first ISR can pulse them.
+    TEST_RIG_BEGIN();
+    attachInterrupt(digitalPinToInterrupt(PIR_PIN), pirISR, CHANGE);
+    // Only after the queues exist: the button ISR sends straight into
+    // commandQueue.
+    userButton.begin(BUTTON_PIN, onButtonPress);
+
+    xTaskCreatePinnedToCore(
+        sensorTask, "sensor", SENSOR_TASK_STACK, NULL,
+        SENSOR_TASK_PRIORITY, &sensorTaskHandle, SENSOR_TASK_CORE);
+
+    xTaskCreatePinnedToCore(
+        bleTask, "ble", BLE_TASK_STACK, NULL,
+        BLE_TASK_PRIORITY, &bleTaskHandle, BLE_TASK_CORE);
+
+    xTaskCreatePinnedToCore(
+        mlTask, "ml", ML_TASK_STACK, NULL,
+        ML_TASK_PRIORITY, &mlTaskHandle, ML_TASK_CORE);
+
+    // Sinks are already begun (setupPins/setupBLE ran before us).
+    alarmSystem.begin(&buzzer, &statusLed, &bleManager);
+    alarmSystem.onCaptureTrigger(onCaptureTriggered);
+    alarmSystem.onEventMirror(onAlarmMirrored);
+    // OTA transfers throttle themselves against the alarm pipeline's
+    // standing state from here on.
+    OtaPacer::begin(&alarmSystem);
+    escalationLadder.begin(&alarmSystem);
+
+    setupTimers();
+
+    DEBUG_PRINTLN("Tasks created.");
+}
+
+// ============================================================================
+// DEADLINE TIMER SETUP
+// ============================================================================
+void setupTimers() {
+    esp_timer_create_args_t args = {};
+
+    args.callback = onSensorReadDue;
+    args.name = "sensor_read";
+    esp_timer_create(&args, &sensorReadTimer);
+    esp_timer_start_periodic(sensorReadTimer, (uint64_t)SENSOR_READ_INTERVAL * 1000);
+
+    args.callback = onBLEUpdateDue;
+    args.name = "ble_update";
+    esp_timer_create(&args, &bleUpdateTimer);
+    esp_timer_start_periodic(bleUpdateTimer, (uint64_t)BLE_UPDATE_INTERVAL * 1000);
+
+    args.callback = onScheduleCheckDue;
+    args.name = "schedule_check";
+    esp_timer_create(&args, &scheduleCheckTimer);
+    esp_timer_start_periodic(scheduleCheckTimer, (uint64_t)SCHEDULE_CHECK_INTERVAL * 1000);
+
+    args.callback = onHighRateDue;
+    args.name = "highrate_sample";
+    esp_timer_create(&args, &highRateTimer);
+    esp_timer_start_periodic(highRateTimer,
+                             (uint64_t)HIGHRATE_SAMPLE_INTERVAL_MS * 1000);
+
+    // One-shot, armed by markPrefDirty() on the first dirty key.
+    args.callback = onPrefsFlushDue;
+    args.name = "prefs_flush";
+    esp_timer_create(&args, &prefsFlushTimer);
+}
+
+// ============================================================================
+// SENSOR TASK (CORE 0)
+// ============================================================================
+void sensorTask(void* pvParameters) {
+    SensorEvent evt;
+
+    for (;;) {
+        // Fully event-driven: PIR edges and READ_DUE deadlines both
+        // arrive on this queue, so the idle path blocks indefinitely.
+        if (xQueueReceive(sensorEventQueue, &evt, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        watchdog.heartbeat(WatchdogSupervisor::SUBSYS_SENSOR);
+
+        #if POWER_BENCH_ENABLED
+        // Radio-only bench states: drain events without doing any
+        // sampling work, so the analyzer sees the radio alone while
+        // the watchdog keeps getting fed.
+        if (gPowerBenchSensorsIdle) {
+            continue;
+        }
+        #endif
+
+        if (evt.type == SensorEvent::MOTION_EDGE) {
+            // Debounce stage 2: the level must still hold at dequeue
+            // (minimum assertion = ISR-to-task latency). A glitch
+            // pulse whose rising edge beat the ISR interval gate is
+            // back low by now and never commits.
+            if ((digitalRead(PIR_PIN) == HIGH) != evt.level) {
+                continue;
+            }
+            handleMotionEvent(evt);
+            xQueueOverwrite(sensorDataQueue, &sensorData);
+            continue;
+        }
+
+        if (evt.type == SensorEvent::HIGHRATE_DUE) {
+            sampleHighRate();
+            continue;
+        }
+
+        // Co-located units hear each other's ultrasonic pings; hold
+        // the burst until this unit's time-division slot when the
+        // mesh beacon is providing one. The slot frame (hundreds of
+        // ms) is far inside SENSOR_READ_INTERVAL, so the sample RATE
+        // is unchanged — only its phase shifts.
+        uint32_t slotHoldMs = espNowMesh.ultrasonicHoldoffMs();
+        if (slotHoldMs > 0) {
+            vTaskDelay(pdMS_TO_TICKS(slotHoldMs));
+        }
 
-    // Read sensors periodically
-    if (currentMillis - lastSensorRead >= SENSOR_READ_INTERVAL) {
-        lastSensorRead = currentMillis;
         readSensors();
+        checkFanStall();
+
+        // Self-test evidence, accumulated for free on the read path:
+        // the stall verdict reuses checkFanStall's debounced latch.
+        {
+            int8_t fanEvidence = -1;
+            if (fanStallLatched) {
+                fanEvidence = 0;
+            } else if (appliedFanSpeed >= FAN_STALL_MIN_DUTY &&
+                       sensorData.fanRpm >= FAN_STALL_MIN_RPM) {
+                fanEvidence = 1;
+            }
+            SelfTest::observe(sensorData.distance,
+                              sensorData.motionDetected, fanEvidence);
+        }
+
+        queueMlEvent(MlEvent::SENSOR_SAMPLE, sensorData.temperature,
+                     sensorData.motionDetected, millis());
 
-        if (autoMode) {
+        if (deviceState.autoMode()) {
             updateAutoMode();
         }
 
         checkMotionTimeout();
+
+        // Tick the RTC slow-memory segment: cumulative uptime plus the
+        // motion-timeout context a reset must not lose. RAM writes and
+        // a short ROM CRC — no flash involved — so staleness after a
+        // crash is bounded at one sensor interval.
+        RtcState::noteUptime();
+        {
+            RtcStateData& rtc = RtcState::data();
+            rtc.hadMotionContext = sensorData.lastMotionTime != 0;
+            int64_t quiet = rtc.hadMotionContext
+                ? MonoClock::nowMs() - sensorData.lastMotionTime : 0;
+            // The slow-memory field is 32-bit; a quiet spell past its
+            // range saturates rather than wrapping back to "fresh".
+            rtc.quietMs = quiet > (int64_t)UINT32_MAX
+                ? UINT32_MAX : (uint32_t)quiet;
+            rtc.motionTimeoutRaised = motionTimeoutRaised ? 1 : 0;
+
+            // Warm-start snapshot: only live readings overwrite it —
+            // a boot still serving the previous snapshot must not
+            // re-save it with a fresher stamp.
+            if (sensorDataLive) {
+                rtc.snapshotValid = 1;
+                rtc.snapshotTemp = (int16_t)(sensorData.temperature * 100.0f);
+                rtc.snapshotHum = (uint16_t)(sensorData.humidity * 100.0f);
+                rtc.snapshotDist = (uint16_t)(sensorData.distance * 10.0f);
+                rtc.snapshotOccupancy = sensorData.occupancy;
+                rtc.snapshotUptimeSec = rtc.uptimeAccumSec;
+            }
+        }
+        RtcState::commit();
+
+        // A full acquisition cycle made it this far: sensors read,
+        // filters run, auto mode applied — the probation milestone.
+        BootHealthGate::noteMilestone(BootHealthGate::MILESTONE_SENSOR);
+
+        // Append to the history log; batching inside means most calls
+        // touch RAM only (one page program per 16 samples).
+        HistoryRecord record;
+        record.sequence = 0; // stamped by the log
+        record.timestampMs = millis();
+        record.temperature = (int16_t)(sensorData.temperature * 100.0f);
+        record.humidity = (uint16_t)(sensorData.humidity * 100.0f);
+        record.distance = (uint16_t)(sensorData.distance * 10.0f);
+        record.flags = sensorData.motionDetected ? 0x01 : 0;
+        record.reserved = 0;
+        {
+            PROFILE_SCOPE(PROF_HISTORY_APPEND);
+            historyLog.append(record);
+        }
+
+        // Fold the same sample into the minute/hour rollup buckets —
+        // integer min/max/sum updates, flash only when a bucket seals.
+        rollupStore.addSample(record);
+
+        // Seal the daily wellness record when the summary hour comes
+        // around — a clock compare per cycle, rollup reads once a day.
+        WellnessSummary::tick(millis());
+
+        // WiFi transports get the same packed frame BLE notifies:
+        // MQTT coalesces it into the per-minute batch, the WebSocket
+        // server fans it out live. No-ops when disabled.
+        SensorFrame netFrame;
+        netFrame.magic = FRAME_MAGIC;
+        netFrame.version = SENSOR_FRAME_VERSION;
+        netFrame.type = FRAME_TYPE_SENSOR;
+        netFrame.flags = (sensorData.motionDetected ? SENSOR_FLAG_MOTION : 0) |
+                         (sensorData.sensorFault ? SENSOR_FLAG_FAULT : 0);
+        netFrame.temperature = record.temperature;
+        netFrame.humidity = record.humidity;
+        netFrame.fanSpeed = deviceState.fanSpeed();
+        netFrame.ledBrightness = deviceState.ledBrightness();
+        netFrame.distance = record.distance;
+        netFrame.occupancy = sensorData.occupancy;
+        netFrame.fanRpm = sensorData.fanRpm;
+        netFrame.timestampMs = record.timestampMs;
+        mqttTelemetry.queueTelemetry(netFrame);
+        wsLiveServer.push(netFrame);
+
+        // Publish the latest snapshot; overwrite keeps only the newest.
+        xQueueOverwrite(sensorDataQueue, &sensorData);
+
+        // Refresh the connectionless broadcast so passive scanners see
+        // the same values without a GATT connection.
+        bleManager.broadcastSensorSnapshot(sensorData.temperature,
+                                           sensorData.humidity,
+                                           sensorData.motionDetected,
+                                           deviceState.fanSpeed());
+
+        // Share the same snapshot with sibling units; rate-limited
+        // internally, so most calls return immediately.
+        espNowMesh.sendSnapshot(sensorData.temperature,
+                                sensorData.humidity,
+                                sensorData.motionDetected,
+                                sensorData.occupancy,
+                                deviceState.fanSpeed(),
+                                deviceState.ledBrightness());
+
+        #if ESPNOW_BEACON_MASTER
+        // Aggregation role: multiplex one peer's snapshot per cycle
+        // onto the phone connection as a unit-tagged frame.
+        bleManager.pushNextPeerFrame();
+        #endif
+
+        #if BATTERY_PROFILE_ENABLED
+        // Window spent and nothing holding us awake: hand the power-
+        // down to the command task, which owns the deferred NVS state
+        // that must flush before the lights go out.
+        if (BatteryProfile::windowExpired() && !bleManager.isConnected() &&
+            !sensorData.motionDetected) {
+            Command sleepCmd = { Command::BATTERY_SLEEP, 0 };
+            xQueueSend(commandQueue, &sleepCmd, 0);
+        }
+        #endif
+
+        // Idle-slice self-test: at most one bounded check, and only
+        // when no real event is already waiting — anything queued
+        // pre-empts the slice simply by existing.
+        if (uxQueueMessagesWaiting(sensorEventQueue) == 0) {
+            SelfTest::step();
+            // Erase-ahead for the history log: the next sector's 4 KB
+            // erase lands here, in the idle slice, so appends are
+            // always page programs into pre-erased flash.
+            historyLog.prepareAhead();
+        }
+    }
+}
+
+// ============================================================================
+// MOTION EVENT HANDLING
+// ============================================================================
+void handleMotionEvent(const SensorEvent& evt) {
+    if (evt.level && !sensorData.motionDetected) {
+        sensorData.motionDetected = true;
+        sensorData.lastMotionTime = MonoClock::widenMs(evt.timestampMs);
+        DEBUG_PRINTLN("Motion detected!");
+        // Presence makes a connection likely: advertising snaps back
+        // to the fast cadence for its window.
+        bleManager.noteMotionActivity();
+        statusLed.play(LedPatternEngine::BLINK, 1);
+        occupancyEstimator.noteMotion(sensorData.lastMotionTime);
+        // Activity: snap the high-rate cadence back to full speed.
+        setHighRateInterval(HIGHRATE_SAMPLE_INTERVAL_MS);
+        #if BATTERY_PROFILE_ENABLED
+        BatteryProfile::noteActivity();
+        #endif
+    } else if (!evt.level) {
+        sensorData.motionDetected = false;
+    }
+
+    // Every PIR transition lands in the PSRAM ring at full rate.
+    HighRateSample sample;
+    sample.timestampMs = evt.timestampMs;
+    sample.distance = 0xFFFF;
+    sample.type = HIGHRATE_PIR_EDGE;
+    sample.flags = evt.level ? 0x01 : 0;
+    highRateRing.push(sample);
+
+    // Sustained activity after a suspected fall clears the alarm;
+    // tracked on the ML task, which owns all detector state.
+    queueMlEvent(MlEvent::PIR_EDGE, 0.0f, evt.level, evt.timestampMs);
+}
+
+// ============================================================================
+// ADAPTIVE SAMPLING
+// ============================================================================
+// The high-rate cadence follows activity: a PIR rising edge snaps it
+// to 1 Hz; after HIGHRATE_DECAY_QUIET_MS of stillness the interval
+// doubles on each sample until the idle ceiling. Sensor-task only, so
+// no locking; load shedding owns sensorReadTimer and is unaffected.
+uint32_t highRateIntervalMs = HIGHRATE_SAMPLE_INTERVAL_MS;
+
+void setHighRateInterval(uint32_t intervalMs) {
+    if (intervalMs == highRateIntervalMs) {
+        return;
+    }
+    highRateIntervalMs = intervalMs;
+    esp_timer_stop(highRateTimer);
+    esp_timer_start_periodic(highRateTimer, (uint64_t)intervalMs * 1000);
+    DEBUG_PRINTF("High-rate sampling interval: %u ms\n", intervalMs);
+}
+
+void decayHighRateInterval() {
+    if (sensorData.motionDetected ||
+        MonoClock::nowMs() - sensorData.lastMotionTime <
+            HIGHRATE_DECAY_QUIET_MS ||
+        highRateIntervalMs >= HIGHRATE_IDLE_MAX_INTERVAL_MS) {
+        return;
+    }
+    uint32_t next = highRateIntervalMs * 2;
+    if (next > HIGHRATE_IDLE_MAX_INTERVAL_MS) {
+        next = HIGHRATE_IDLE_MAX_INTERVAL_MS;
+    }
+    setHighRateInterval(next);
+}
+
+// ============================================================================
+// HIGH-RATE SAMPLING (PSRAM RING)
+// ============================================================================
+void sampleHighRate() {
+    if (!highRateRing.isReady()) {
+        return;
+    }
+
+    HighRateSample sample;
+    sample.timestampMs = millis();
+    sample.distance = 0xFFFF;
+    sample.type = HIGHRATE_DISTANCE;
+    sample.flags = sensorData.motionDetected ? 0x01 : 0;
+
+    // One ping of the primary ultrasonic; the echo ISR does the timing.
+    UltrasonicSensor* primary = sensorBank.ultrasonic(0);
+    if (!primary->isBusy()) {
+        primary->startMeasurement();
+        if (primary->waitForResult(ULTRASONIC_TIMEOUT_MS)) {
+            sample.distance = (uint16_t)(primary->lastDistanceCm() * 10.0f);
+        }
+    }
+
+    highRateRing.push(sample);
+
+    // Classify with the new sample included: the ML task picks the
+    // event up immediately on the otherwise-idle core, so a fall still
+    // reaches the alarm pipeline within one sample period.
+    queueMlEvent(MlEvent::DISTANCE_SAMPLE, 0.0f, 0, sample.timestampMs);
+
+    decayHighRateInterval();
+}
+
+// ============================================================================
+// ML INFERENCE TASK (CORE 0, IDLE PRIORITY)
+// ============================================================================
+// Producers enqueue and forget; all detector state lives on this task,
+// so no inference ever runs on a latency-sensitive context. Per-run
+// duration is recorded against the wall clock — watch maxRunUs as
+// models grow.
+void queueMlEvent(uint8_t type, float temperature, uint8_t level,
+                  uint32_t timestampMs) {
+    // Sensor task ONLY: it is the single producer of the sample ring.
+    // Control events from any other task go through queueMlControl.
+    MlEvent evt;
+    evt.type = (MlEvent::Type)type;
+    evt.temperature = temperature;
+    evt.level = level;
+    evt.value = 0;
+    evt.timestampMs = timestampMs;
+    if (!mlSampleRing.push(evt)) {
+        mlStats.drops++; // the next sample re-scores; nothing is lost
+        return;
+    }
+    if (mlTaskHandle) {
+        xTaskNotifyGive(mlTaskHandle);
+    }
+}
+
+// Control-path enqueue for the rare multi-producer events (model
+// rebinds from the command task, captures from the alarm drain task).
+void queueMlControl(const MlEvent& evt) {
+    if (xQueueSend(mlQueue, &evt, 0) != pdTRUE) {
+        mlStats.drops++;
+        return;
+    }
+    if (mlTaskHandle) {
+        xTaskNotifyGive(mlTaskHandle);
+    }
+}
+
+void mlTask(void* pvParameters) {
+    MlEvent evt;
+    for (;;) {
+        // Producers notify after every enqueue; the take batches any
+        // backlog, so one wake drains everything pending. Samples
+        // first (the ring orders the hot path), then control events.
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // One full-clock window spans the whole drained batch — far
+        // cheaper than a DFS transition per event.
+        PowerGovernor::acquire(PowerGovernor::LOCK_ML);
+        while (mlSampleRing.pop(evt)) {
+            runMlEvent(evt);
+        }
+        while (xQueueReceive(mlQueue, &evt, 0) == pdTRUE) {
+            runMlEvent(evt);
+        }
+        PowerGovernor::release(PowerGovernor::LOCK_ML);
+    }
+}
+
+void runMlEvent(const MlEvent& evt) {
+    int64_t startUs = esp_timer_get_time();
+    uint32_t startCycles = latencyCycleCount();
+    switch (evt.type) {
+        case MlEvent::SENSOR_SAMPLE:
+            anomalyDetector.feed(evt.temperature, evt.level != 0);
+            occupancyBaseline.feed(evt.level != 0, evt.timestampMs);
+            break;
+        case MlEvent::DISTANCE_SAMPLE:
+            fallDetector.evaluate();
+            break;
+        case MlEvent::PIR_EDGE:
+            fallDetector.notePirEdge(evt.level != 0, evt.timestampMs);
+            break;
+        case MlEvent::MODEL_REBIND:
+            // On this task so the model pointers never move under
+            // a score in progress.
+            anomalyDetector.rebind(&modelStore);
+            fallDetector.rebind(&modelStore);
+            break;
+        case MlEvent::CAPTURE:
+            // Flash-heavy (sector erases), so it runs here at idle
+            // priority — never on the alarm drain task.
+            captureStore.capture(evt.level, evt.value, &highRateRing);
+            break;
+    }
+    uint32_t runUs = (uint32_t)(esp_timer_get_time() - startUs);
+    mlRunLatency.record(latencyCycleCount() - startCycles);
+
+    mlStats.runs++;
+    mlStats.lastRunUs = runUs;
+    if (runUs > mlStats.maxRunUs) {
+        mlStats.maxRunUs = runUs;
+        DEBUG_PRINTF("ML run high-water: %u us (run #%u)\n",
+                     runUs, mlStats.runs);
+    }
+}
+
+// ============================================================================
+// BLE TASK (CORE 1)
+// ============================================================================
+void bleTask(void* pvParameters) {
+    Command cmd;
+
+    for (;;) {
+        // Commands and periodic deadlines all arrive as queue events;
+        // nothing here polls, so the task blocks until there is work.
+        if (xQueueReceive(commandQueue, &cmd, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        watchdog.heartbeat(WatchdogSupervisor::SUBSYS_BLE);
+        updateLoadShedding();
+
+        // Fold new history-log erases into the persisted wear counter
+        // on the next quiet-period flush (this task owns the dirty
+        // bits, so the check lives here and not on the sensor task).
+        if (historyLog.eraseCount() != syncedHistoryErases) {
+            markPrefDirty(PREF_DIRTY_WEAR);
+        }
+
+        // Under pressure, periodic pushes yield their slice to real
+        // user commands still waiting in the queue.
+        if (gShedLogging && cmd.type == Command::BLE_PUSH) {
+            loadStats.pushesShed++;
+            continue;
+        }
+
+        applyCommand(cmd);
+
+        // Full command-to-actuation span for BLE-originated commands;
+        // the queue depth at completion says whether a slow one was
+        // backlog or the handler itself.
+        if (cmd.arrivalUs != 0) {
+            CmdLatency::record(
+                cmd.opcode,
+                (uint32_t)(esp_timer_get_time() - cmd.arrivalUs),
+                (uint8_t)uxQueueMessagesWaiting(commandQueue));
+        }
+    }
+}
+
+// ============================================================================
+// LOAD-SHEDDING CONTROL
+// ============================================================================
+void updateLoadShedding() {
+    UBaseType_t depth = uxQueueMessagesWaiting(commandQueue);
+
+    if (!gShedLogging && depth >= LOAD_SHED_QUEUE_HIGH) {
+        gShedLogging = true;
+        loadStats.logShedEntries++;
+
+        if (!sensorRateDegraded) {
+            sensorRateDegraded = true;
+            loadStats.sensorDowngrades++;
+            esp_timer_stop(sensorReadTimer);
+            esp_timer_start_periodic(sensorReadTimer,
+                                     (uint64_t)SENSOR_READ_INTERVAL_DEGRADED * 1000);
+        }
+    } else if (gShedLogging && depth <= LOAD_SHED_QUEUE_LOW) {
+        gShedLogging = false;
+
+        if (sensorRateDegraded) {
+            sensorRateDegraded = false;
+            esp_timer_stop(sensorReadTimer);
+            esp_timer_start_periodic(sensorReadTimer,
+                                     (uint64_t)SENSOR_READ_INTERVAL * 1000);
+        }
+
+        DEBUG_PRINTF("Load shed recovered (log entries: %u, pushes: %u, downgrades: %u)\n",
+                     loadStats.logShedEntries, loadStats.pushesShed,
+                     loadStats.sensorDowngrades);
+    }
+}
+
+// ============================================================================
+// PERIODIC BLE PUSH
+// ============================================================================
+void pushSensorUpdate() {
+    SensorData snapshot;
+
+    if (!bleManager.isConnected()) {
+        return;
+    }
+    if (xQueuePeek(sensorDataQueue, &snapshot, 0) != pdTRUE) {
+        return;
+    }
+
+    bleManager.sendSensorData(
+        snapshot.temperature,
+        snapshot.humidity,
+        deviceState.fanSpeed(),
+        deviceState.ledBrightness(),
+        snapshot.motionDetected,
+        snapshot.distance,
+        snapshot.occupancy,
+        snapshot.sensorFault,
+        snapshot.fanRpm,
+        snapshot.stale
+    );
+}
+
+// ============================================================================
+// PERIODIC SCHEDULE CHECK
+// ============================================================================
+void checkSchedules() {
+    watchdog.heartbeat(WatchdogSupervisor::SUBSYS_SCHEDULER);
+    // Not a scan: schedule actions fire from the engine's own deadline
+    // timer. This periodic event only feeds the watchdog and re-arms
+    // the engine if the RTC wasn't valid at boot.
+    scheduleManager.ensureArmed();
+
+    // The escalation wheel has no timer of its own; this heartbeat is
+    // its tick source. Minute cadence against minute-scale stage
+    // delays — the quantization is in the noise.
+    escalationLadder.tick(millis());
+}
+
+// ============================================================================
+// COMMAND DISPATCH
+// ============================================================================
+void applyCommand(const Command& cmd) {
+    #if BATTERY_PROFILE_ENABLED
+    if (cmd.type <= Command::ALARM_SILENCE) {
+        BatteryProfile::noteActivity(); // user-originated: stay awake
+    }
+    #endif
+    switch (cmd.type) {
+        case Command::FAN_SPEED:
+            setFanSpeed(cmd.value);
+            break;
+        case Command::LED_BRIGHTNESS:
+            setLEDBrightness(cmd.value);
+            break;
+        case Command::LED_FADE:
+            setLEDBrightnessFade(cmd.value, cmd.duration);
+            break;
+        case Command::AUTO_MODE:
+            if (deviceState.setAutoMode(cmd.value != 0)) {
+                markPrefDirty(PREF_DIRTY_AUTO);
+            }
+            DEBUG_PRINTF("Auto mode %s\n",
+                         deviceState.autoMode() ? "ENABLED" : "DISABLED");
+            break;
+        case Command::FAN_SETPOINT: {
+            int16_t centi = (int16_t)cmd.duration;
+            autoPolicy.controller().setSetpointCenti(centi);
+            if (deviceState.setSetpointCenti(centi)) {
+                markPrefDirty(PREF_DIRTY_SETPOINT);
+            }
+            DEBUG_PRINTF("Fan setpoint %s (%d centi-C)\n",
+                         centi ? "set" : "reset to default", centi);
+            break;
+        }
+        case Command::SCENE_APPLY:
+            applyScene(cmd.value);
+            break;
+        case Command::SCENE_SAVE:
+            saveSceneDefinitions();
+            break;
+        case Command::ALARM_SILENCE:
+            // Quiets the siren only; the status LED keeps showing the
+            // alarm state, and a still-true condition re-raises on its
+            // next transition.
+            buzzer.stop();
+            DEBUG_PRINTLN("Siren silenced (button)");
+            break;
+        case Command::BLE_PUSH:
+            pushSensorUpdate();
+            break;
+        case Command::SCHEDULE_CHECK:
+            checkSchedules();
+            break;
+        case Command::PREFS_FLUSH:
+            flushPreferences();
+            break;
+        case Command::BATTERY_SLEEP:
+            #if BATTERY_PROFILE_ENABLED
+            // Re-check on the owning task: a client may have connected
+            // or a command landed since the sensor task queued this.
+            if (BatteryProfile::windowExpired() && !bleManager.isConnected() &&
+                !sensorData.motionDetected) {
+                flushPreferences();
+                historyLog.flush();
+                rollupStore.flush();
+                BatteryProfile::sleepUntilNextWindow();
+            }
+            #endif
+            break;
+    }
+}
+
+// ============================================================================
+// SCENES
+// ============================================================================
+// One dispatch sets all three targets: the LEDC writes land back to
+// back (no visible staggering between fan and light) and the three
+// dirty marks coalesce into a single deferred NVS commit — versus one
+// commit per BLE round trip when the app staged them itself.
+void applyScene(uint8_t index) {
+    if (index >= SCENE_MAX_COUNT) {
+        return;
+    }
+    const ScenePreset& scene = settingsStore.data().scenes[index];
+    if (!scene.inUse) {
+        DEBUG_PRINTF("Scene %u is empty\n", index);
+        return;
+    }
+
+    if (deviceState.setAutoMode(scene.autoMode != 0)) {
+        markPrefDirty(PREF_DIRTY_AUTO);
+    }
+    setFanSpeed(scene.fanSpeed);
+    setLEDBrightness(scene.ledBrightness);
+    // The PID restarts from the scene's fan speed instead of fighting
+    // it with stale history.
+    autoPolicy.controller().reset();
+
+    DEBUG_PRINTF("Scene %u (%.8s) applied\n", index, scene.name);
+}
+
+void saveSceneDefinitions() {
+    SceneDefinition def;
+    while (xQueueReceive(sceneDefQueue, &def, 0) == pdTRUE) {
+        if (def.index >= SCENE_MAX_COUNT) {
+            continue;
+        }
+        settingsStore.data().scenes[def.index] = def.preset;
+        markPrefDirty(PREF_DIRTY_SCENE);
+        DEBUG_PRINTF("Scene %u (%.8s) defined\n",
+                     def.index, def.preset.name);
+    }
+}
+
+// ============================================================================
+// DEFERRED PREFERENCE WRITES
+// ============================================================================
+void markPrefDirty(uint8_t bit) {
+    int64_t nowUs = esp_timer_get_time();
+
+    if (prefsDirty == 0) {
+        prefsFirstDirtyUs = nowUs;
+    }
+    prefsDirty |= bit;
+
+    // Keep the brownout shadow current; this is the only work needed
+    // for power-loss safety on the hot path. A coherent snapshot so a
+    // shadow written mid-scene never mixes old and new fields.
+    int32_t snap[StateStore::FIELD_COUNT];
+    deviceState.snapshot(snap);
+    rtcShadowAuto = snap[StateStore::FIELD_AUTO_MODE] ? 1 : 0;
+    rtcShadowFan = (uint8_t)snap[StateStore::FIELD_FAN_SPEED];
+    rtcShadowLed = (uint8_t)snap[StateStore::FIELD_LED_BRIGHTNESS];
+    rtcShadowDirty = 1;
+
+    if (prefsFlushTimer == NULL) {
+        return; // setup(): values just loaded from NVS, nothing to defer
+    }
+
+    // Re-arm for the quiet period, but never past the hard cap from
+    // the first dirty mark — a continuous slider drag still commits.
+    int64_t quietUs = (int64_t)PREFS_FLUSH_QUIET_MS * 1000;
+    int64_t capUs = prefsFirstDirtyUs + (int64_t)PREFS_FLUSH_MAX_MS * 1000 - nowUs;
+    int64_t delayUs = (capUs < quietUs) ? capUs : quietUs;
+    if (delayUs < 1000) {
+        delayUs = 1000;
+    }
+
+    esp_timer_stop(prefsFlushTimer);
+    esp_timer_start_once(prefsFlushTimer, (uint64_t)delayUs);
+}
+
+void flushPreferences() {
+    if (prefsDirty == 0) {
+        return;
+    }
+    PROFILE_SCOPE(PROF_NVS_COMMIT);
+    FLASH_OP_SCOPE(FLASH_NVS_COMMIT);
+
+    // The blob carries every setting, so one atomic commit covers all
+    // dirty keys regardless of which bits are set. Only fields the
+    // store marked dirty are copied in — O(changed), not O(all).
+    uint8_t stateDirty = deviceState.takeDirty(StateStore::CONSUMER_PERSIST);
+    if (stateDirty & StateStore::bit(StateStore::FIELD_AUTO_MODE)) {
+        settingsStore.data().autoMode = deviceState.autoMode() ? 1 : 0;
+    }
+    if (stateDirty & StateStore::bit(StateStore::FIELD_FAN_SPEED)) {
+        settingsStore.data().fanSpeed = deviceState.fanSpeed();
+    }
+    if (stateDirty & StateStore::bit(StateStore::FIELD_LED_BRIGHTNESS)) {
+        settingsStore.data().ledBrightness = deviceState.ledBrightness();
+    }
+    if (stateDirty & StateStore::bit(StateStore::FIELD_FAN_SETPOINT)) {
+        settingsStore.data().fanSetpointCenti = deviceState.setpointCenti();
     }
+    settingsStore.data().historyErases +=
+        historyLog.eraseCount() - syncedHistoryErases;
+    syncedHistoryErases = historyLog.eraseCount();
+    settingsStore.commit();
 
-    // Send BLE updates
-    if (bleManager.isConnected() && 
-        (currentMillis - lastBLEUpdate >= BLE_UPDATE_INTERVAL)) {
-        lastBLEUpdate = currentMillis;
-        
-        bleManager.sendSensorData(
-            sensorData.temperature,
-            sensorData.humidity,
-            currentFanSpeed,
-            currentLEDBrightness,
-            sensorData.motionDetected,
-            sensorData.distance
-        );
+    DEBUG_PRINTF("Settings committed (mask 0x%02X)\n", prefsDirty);
+    TRACE_EVENT(TRACE_NVS_COMMIT, prefsDirty, 0);
+    prefsDirty = 0;
+    rtcShadowDirty = 0;
+}
+
+// Forced flush on planned shutdown: esp_restart() runs registered
+// shutdown handlers before the reset, so deferred writes still land.
+void prefsShutdownFlush() {
+    flushPreferences();
+    historyLog.flush();
+    rollupStore.flush();
+}
+
+// ============================================================================
+// POWER MANAGEMENT SETUP
+// ============================================================================
+void setupPowerManagement() {
+    #if POWER_SAVE_ENABLE
+    DEBUG_PRINTLN("Enabling automatic light sleep...");
+
+    // Both tasks block on queues and all deadlines are esp_timer driven,
+    // so the idle hook can drop into light sleep until the next timer or
+    // wake source. esp_pm arbitrates against the BT controller, keeping
+    // the connection alive across sleep windows.
+    esp_pm_config_esp32_t pmConfig = {};
+    pmConfig.max_freq_mhz = PM_MAX_FREQ_MHZ;
+    pmConfig.min_freq_mhz = PM_MIN_FREQ_MHZ;
+    pmConfig.light_sleep_enable = true;
+
+    esp_err_t err = esp_pm_configure(&pmConfig);
+    if (err != ESP_OK) {
+        DEBUG_PRINTF("esp_pm_configure failed: %d (PM support missing?)\n", err);
+        return;
     }
 
-    delay(10);
+    // A PIR edge must wake the chip immediately, not at the next timer.
+    gpio_wakeup_enable((gpio_num_t)PIR_PIN, GPIO_INTR_HIGH_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+
+    // Latency-critical windows (alarm dispatch, commands, inference,
+    // OTA chunks, echo capture) pin 240 MHz through these locks; the
+    // governor is free to sit at PM_MIN_FREQ_MHZ everywhere else.
+    PowerGovernor::begin();
+
+    DEBUG_PRINTLN("Light sleep enabled (PIR and BLE wake).");
+    #endif
 }
 
+#if POWER_BENCH_ENABLED
+// ============================================================================
+// POWER BENCHMARK STATES
+// ============================================================================
+// Runs on the bench task at each schedule step. The states build on
+// each other — idle isolates the radio, each later state adds one
+// subsystem — so the analyzer attributes the current delta between
+// consecutive windows to exactly that subsystem. STREAMING adds no
+// firmware-side switch: the host script connects and subscribes, and
+// the normal notify path does the rest; the marker still delimits the
+// window.
+void applyPowerBenchState(uint8_t state) {
+    switch (state) {
+        case POWER_STATE_IDLE_ADV:
+            deviceState.setAutoMode(false); // nothing may fight the bench's actuators
+            gPowerBenchSensorsIdle = true;
+            setFanSpeed(0);
+            setLEDBrightness(0);
+            break;
+        case POWER_STATE_SENSORS:
+        case POWER_STATE_STREAMING:
+            gPowerBenchSensorsIdle = false;
+            setFanSpeed(0);
+            break;
+        case POWER_STATE_FAN:
+            gPowerBenchSensorsIdle = false;
+            setFanSpeed(255);
+            break;
+    }
+}
+#endif // POWER_BENCH_ENABLED
+
 // ============================================================================
 // BLE SETUP
 // ============================================================================
 void setupBLE() {
     DEBUG_PRINTLN("Setting up BLE service...");
-    
+
     if (bleManager.begin()) {
         // Register callbacks
+        bleManager.setStatusLed(&statusLed);
         bleManager.onFanSpeedChange(onFanSpeedChanged);
         bleManager.onLEDBrightnessChange(onLEDBrightnessChanged);
+        bleManager.onLEDFade(onLEDFadeRequested);
         bleManager.onAutoModeChange(onAutoModeChanged);
-        
+        bleManager.onSetpointChange(onFanSetpointChanged);
+        bleManager.onSceneApply(onSceneApplyRequested);
+        bleManager.onSceneDefine(onSceneDefineRequested);
+        bleManager.onFlashHealthRequest(onFlashHealthRequested);
+        bleManager.setModelUpdater(&modelUpdater);
+        bleManager.onModelCommitted(onModelCommitted);
+        bleManager.setFirmwareUpdater(&firmwareUpdater);
+        bleManager.onLatencyRequest(onLatencyRequested);
+        bleManager.onHeapStatsRequest(onHeapStatsRequested);
+        bleManager.onSoakSample(onSoakSample);
+        bleManager.onBootStatsRequest(onBootStatsRequested);
+
         DEBUG_PRINTLN("BLE service ready.");
+        BootHealthGate::noteMilestone(BootHealthGate::MILESTONE_BLE);
     } else {
         DEBUG_PRINTLN("BLE initialization failed!");
     }
@@ -155,12 +2002,9 @@ void setupBLE() {
 void setupPins() {
     DEBUG_PRINTLN("Setting up GPIO pins...");
     pinMode(PIR_PIN, INPUT);
-    pinMode(ULTRASONIC_ECHO_PIN, INPUT);
-    pinMode(STATUS_LED_PIN, OUTPUT);
-    pinMode(ULTRASONIC_TRIG_PIN, OUTPUT);
-    pinMode(BUZZER_PIN, OUTPUT);
-    digitalWrite(STATUS_LED_PIN, LOW);
-    digitalWrite(BUZZER_PIN, LOW);
+    // The RMT peripheral owns BUZZER_PIN from here; idle drives it low.
+    buzzer.begin();
+    statusLed.begin();
     DEBUG_PRINTLN("GPIO pins configured.");
 }
 
@@ -173,6 +2017,13 @@ void setupPWM() {
     ledcAttachPin(FAN_PIN, FAN_PWM_CHANNEL);
     ledcSetup(LED_PWM_CHANNEL, LED_PWM_FREQ, LED_PWM_RESOLUTION);
     ledcAttachPin(LED_PIN, LED_PWM_CHANNEL);
+
+    // Hardware fade support for LED ramps (runs inside the LEDC block).
+    ledc_fade_func_install(0);
+
+    // Tach feedback: the PCNT counter runs from here on with no CPU.
+    fanTach.begin();
+
     DEBUG_PRINTLN("PWM channels configured.");
 }
 
@@ -181,106 +2032,402 @@ void setupPWM() {
 // ============================================================================
 void setupSensors() {
     DEBUG_PRINTLN("Initializing sensors...");
-    dht.begin();
+    sensorBank.begin();
+    // Per-unit trims live in the settings blob (seeded from the
+    // config tables on first boot).
+    sensorBank.setCalibration(settingsStore.data().calTempOffset,
+                              settingsStore.data().calHumOffset,
+                              settingsStore.data().calDistScaleQ15);
+    // Proximity breaches are detected in the echo ISR itself.
+    sensorBank.ultrasonic(0)->onComplete(onProximityEcho);
     Wire.begin(RTC_SDA_PIN, RTC_SCL_PIN);
+    // One blocking DS3231 read to seed wall-clock time; every later
+    // read is esp_timer arithmetic, resynced off-path for drift.
+    rtcClock.begin();
+    // Schedules need the wall clock; the engine arms a single deadline
+    // timer from the persisted entries.
+    scheduleManager.begin(&settingsStore, &rtcClock, onScheduleAction);
+    // Deployed model weights are referenced straight from mapped
+    // flash; detectors fall back to compiled-in defaults without them.
+    // Working buffers carve from the arena, sealed once both are up.
+    modelStore.begin();
+    modelUpdater.begin(&modelStore);
+    firmwareUpdater.begin();
+    inferenceArena.begin(ML_ARENA_BYTES);
+    anomalyDetector.begin(&rtcClock, &alarmSystem, &modelStore,
+                          &inferenceArena);
+    fallDetector.begin(&highRateRing, &alarmSystem, &modelStore,
+                       &inferenceArena);
+    occupancyBaseline.begin(&rtcClock);
+    inferenceArena.seal();
+    mlKernelBenchmark();
     sensorData.temperature = 0.0f;
     sensorData.humidity = 0.0f;
+    sensorData.temperatureRaw = 0.0f;
+    sensorData.humidityRaw = 0.0f;
+    sensorData.occupancy = 0;
+    sensorData.fanRpm = 0;
+    sensorData.sensorFault = false;
     sensorData.motionDetected = false;
     sensorData.distance = 0.0f;
     sensorData.lastMotionTime = 0;
+    sensorData.stale = false;
+
+    // Warm start from RTC slow memory: the pre-reset readings, served
+    // flagged as stale, beat the 0.0 °C a caregiver would otherwise
+    // stare at for the DHT22's warmup plus a read cycle. The age shown
+    // here excludes reset downtime (the clock it is measured on
+    // pauses), which for a watchdog or OTA restart is a wash.
+    if (RtcState::carriedOver() && RtcState::data().snapshotValid) {
+        const RtcStateData& rtc = RtcState::data();
+        sensorData.temperature = rtc.snapshotTemp * 0.01f;
+        sensorData.humidity = rtc.snapshotHum * 0.01f;
+        sensorData.distance = rtc.snapshotDist * 0.1f;
+        sensorData.occupancy = rtc.snapshotOccupancy;
+        sensorData.stale = true;
+        DEBUG_PRINTF("Sensor warm start: %.1f°C, %.1f%% (age %u s)\n",
+                     sensorData.temperature, sensorData.humidity,
+                     rtc.uptimeAccumSec - rtc.snapshotUptimeSec);
+    }
+
+    // Rebuild the motion-timeout context from RTC slow memory: the
+    // quiet spell keeps aging as if the reset never happened (the
+    // restored anchor simply sits before boot — negative is fine on
+    // the signed 64-bit timeline), and a warning that was already
+    // delivered stays delivered.
+    if (RtcState::carriedOver() && RtcState::data().hadMotionContext) {
+        sensorData.lastMotionTime =
+            MonoClock::nowMs() - (int64_t)RtcState::data().quietMs;
+        motionTimeoutRaised = RtcState::data().motionTimeoutRaised != 0;
+        if (motionTimeoutRaised) {
+            // Escalation stages live in RAM and did not survive the
+            // reset; restart them from now so a still-quiet room keeps
+            // climbing toward the caregiver alert.
+            escalationLadder.armMotionLadder();
+        }
+        DEBUG_PRINTF("Motion context restored: quiet %u ms%s\n",
+                     RtcState::data().quietMs,
+                     motionTimeoutRaised ? ", timeout already raised" : "");
+    }
     DEBUG_PRINTLN("Sensors initialized.");
 }
 
+// ============================================================================
+// FAN STALL DETECTION
+// ============================================================================
+// The tach runs in the PCNT peripheral, so a stall check costs one
+// counter read per sensor cycle. A fan commanded above the stall floor
+// but reporting no rotation gets one recovery re-ramp — off for a
+// cycle, then back up, because the restart torque is what unsticks a
+// seized rotor, not more duty. A second strike latches a fault that
+// rides SENSOR_FLAG_FAULT out to every connected client.
+uint8_t fanStallCycles = 0;
+bool fanStallRecovering = false;
+bool fanStallLatched = false;
+uint8_t fanStallRestoreDuty = 0;
+
+void checkFanStall() {
+    // Second half of a recovery: the fan sat off for a cycle, ramp it
+    // back to the speed it was commanded at. If something else already
+    // changed the speed meanwhile, that command wins.
+    if (fanStallRestoreDuty != 0) {
+        if (appliedFanSpeed == 0) {
+            Command cmd = { Command::FAN_SPEED, fanStallRestoreDuty };
+            xQueueSend(commandQueue, &cmd, 0);
+            DEBUG_PRINTF("Fan stall recovery: re-ramping to %u\n",
+                         fanStallRestoreDuty);
+        }
+        fanStallRestoreDuty = 0;
+        return;
+    }
+
+    if (appliedFanSpeed < FAN_STALL_MIN_DUTY) {
+        // Too slow to expect reliable tach pulses; not evidence either way.
+        fanStallCycles = 0;
+        return;
+    }
+
+    if (sensorData.fanRpm >= FAN_STALL_MIN_RPM) {
+        if (fanStallRecovering || fanStallLatched) {
+            DEBUG_PRINTF("Fan spinning again (%u RPM)\n", sensorData.fanRpm);
+        }
+        fanStallCycles = 0;
+        fanStallRecovering = false;
+        fanStallLatched = false;
+        return;
+    }
+
+    if (fanStallLatched || ++fanStallCycles < FAN_STALL_CYCLES) {
+        return;
+    }
+    fanStallCycles = 0;
+
+    if (!fanStallRecovering) {
+        // First strike: stop now, restore next cycle. Both legs ride
+        // the command queue so the LEDC writes stay on the command task.
+        fanStallRecovering = true;
+        fanStallRestoreDuty = appliedFanSpeed;
+        Command cmd = { Command::FAN_SPEED, 0 };
+        xQueueSend(commandQueue, &cmd, 0);
+        DEBUG_PRINTF("Fan stall suspected (%u RPM at duty %u), recovering\n",
+                     sensorData.fanRpm, appliedFanSpeed);
+        return;
+    }
+
+    // Second strike: the re-ramp didn't take. Latch the fault so the
+    // next frames carry it; the flag clears itself if the fan ever
+    // spins back up.
+    fanStallLatched = true;
+    sensorData.sensorFault = true;
+    statusLed.play(LedPatternEngine::BLINK, 3);
+    DEBUG_PRINTLN("Fan stalled — recovery failed, fault latched");
+}
+
 // ============================================================================
 // READ SENSORS
 // ============================================================================
 void readSensors() {
-    float temp = dht.readTemperature();
-    float hum = dht.readHumidity();
+    PROFILE_SCOPE(PROF_READ_SENSORS);
+    // Starts, gathers and filters every configured channel; the waits
+    // all overlap inside the bank, so the cycle costs the slowest
+    // channel rather than the sum.
+    sensorBank.acquire();
+    DEBUG_PRINTF("Acquisition: %u us\n", sensorBank.lastAcquireUs());
 
-    if (!isnan(temp) && !isnan(hum)) {
-        sensorData.temperature = temp;
-        sensorData.humidity = hum;
-        DEBUG_PRINTF("Temp: %.1f°C, Humidity: %.1f%%\n", temp, hum);
+    // Channel 0 is the primary: it feeds sensorData and everything
+    // downstream of it. Extra channels stay available in the bank's
+    // sample arrays.
+    const SensorBank::DhtSamples& dht = sensorBank.dht();
+    if (dht.valid[0]) {
+        sensorData.temperatureRaw = dht.temperatureRaw[0];
+        sensorData.humidityRaw = dht.humidityRaw[0];
+        sensorData.temperature = dht.temperature[0];
+        sensorData.humidity = dht.humidity[0];
+        sensorData.stale = false; // live data supersedes the warm start
+        sensorDataLive = true;
+        autoPolicy.noteTemperature(sensorData.temperature, millis());
+        DEBUG_PRINTF("Temp: %.1f°C (raw %.1f), Humidity: %.1f%% (raw %.1f)\n",
+                     sensorData.temperature, sensorData.temperatureRaw,
+                     sensorData.humidity, sensorData.humidityRaw);
     }
 
-    bool motion = digitalRead(PIR_PIN);
-    if (motion && !sensorData.motionDetected) {
-        sensorData.motionDetected = true;
-        sensorData.lastMotionTime = millis();
-        DEBUG_PRINTLN("Motion detected!");
-        digitalWrite(STATUS_LED_PIN, HIGH);
-        delay(100);
-        digitalWrite(STATUS_LED_PIN, LOW);
-    } else if (!motion) {
-        sensorData.motionDetected = false;
-    }
+    // PIR state is maintained by the edge ISR via handleMotionEvent().
 
-    digitalWrite(ULTRASONIC_TRIG_PIN, LOW);
-    delayMicroseconds(2);
-    digitalWrite(ULTRASONIC_TRIG_PIN, HIGH);
-    delayMicroseconds(10);
-    digitalWrite(ULTRASONIC_TRIG_PIN, LOW);
+    const SensorBank::RangeSamples& range = sensorBank.range();
+    if (range.valid[0]) {
+        sensorData.distance = range.distance[0];
+        occupancyEstimator.noteDistance(sensorData.distance);
 
-    long duration = pulseIn(ULTRASONIC_ECHO_PIN, HIGH, 30000);
-    if (duration > 0) {
-        sensorData.distance = duration * 0.034 / 2;
+        // Semantic zone from the same sample: one fixed-point compare
+        // chain, publishes only on a committed transition.
+        uint16_t distMm = (uint16_t)(sensorData.distance * 10.0f);
+        if (zoneClassifier.feed(distMm, millis())) {
+            occupancyEstimator.noteZone(zoneClassifier.zone());
+            WellnessSummary::noteZoneTransition(zoneClassifier.previousZone(),
+                                                zoneClassifier.zone());
+            TRACE_EVENT(TRACE_ZONE_CHANGE, zoneClassifier.zone(), distMm);
+            bleManager.sendZoneEvent(zoneClassifier.zone(),
+                                     zoneClassifier.previousZone(), distMm,
+                                     zoneClassifier.lastDwellMs());
+        }
     }
+
+    // Pure arithmetic — RtcClock keeps time off the I2C bus.
+    occupancyEstimator.setHourOfDay(rtcClock.hourOfDay());
+    sensorData.occupancy = occupancyEstimator.confidence();
+
+    // One PCNT register read; the peripheral counted every tach pulse
+    // since the previous cycle.
+    sensorData.fanRpm = fanTach.sampleRpm();
+
+    sensorData.sensorFault = sensorBank.faultActive() || fanStallLatched;
 }
 
 // ============================================================================
 // AUTO MODE LOGIC
 // ============================================================================
-void updateAutoMode() {
-    AutoModeSettings settings;
-    uint8_t targetSpeed = 0;
-    float temp = sensorData.temperature;
-
-    if (temp < TEMP_MIN_THRESHOLD) {
-        targetSpeed = 0;
-    } else if (temp < settings.tempLow) {
-        targetSpeed = settings.fanSpeedLow;
-    } else if (temp < settings.tempHigh) {
-        targetSpeed = settings.fanSpeedMed;
-    } else if (temp < TEMP_MAX_THRESHOLD) {
-        targetSpeed = settings.fanSpeedHigh;
-    } else {
-        targetSpeed = 255;
+// The decision chain itself (trend, latches, PID) lives in
+// AutoModePolicy so the replay harness (test/test_replay) runs the
+// same code against captured traces. What stays here is the queue
+// side: non-urgent speed changes respect a minimum dwell, and the
+// transition counter shows up in the logs so field captures can
+// verify flapping stopped.
+uint32_t autoLastFanChangeMs = 0;
+uint32_t autoFanTransitions = 0;
+
+// Auto-mode fan requests funnel through here: dwell-limited unless
+// urgent (over-temperature), counted, and routed through the command
+// queue so actuator and flash writes stay on the BLE/command task.
+static void requestAutoFanSpeed(uint8_t duty, bool urgent) {
+    if (duty == appliedFanSpeed) {
+        return; // already on the peripheral, reported or not
+    }
+    uint32_t now = millis();
+    if (!urgent && autoLastFanChangeMs != 0 &&
+        now - autoLastFanChangeMs < FAN_MIN_DWELL_MS) {
+        return;
     }
 
-    if (targetSpeed != currentFanSpeed) {
-        setFanSpeed(targetSpeed);
+    Command cmd = { Command::FAN_SPEED, duty };
+    xQueueSend(commandQueue, &cmd, 0);
+    autoLastFanChangeMs = now;
+    autoFanTransitions++;
+    TRACE_EVENT(TRACE_AUTO_DECISION, duty,
+                (uint16_t)(sensorData.temperature * 100.0f));
+    DEBUG_PRINTF("Auto fan transition #%u -> %u\n", autoFanTransitions, duty);
+}
+
+void updateAutoMode() {
+    AutoModePolicy::Decision d = autoPolicy.evaluate(
+        sensorData.temperature, occupancyEstimator.confidence(), millis());
+    requestAutoFanSpeed(d.duty, d.urgent);
+}
+
+// ============================================================================
+// ACTUATOR CHANGE QUANTIZATION
+// ============================================================================
+// True when a new actuator value is worth persisting and notifying:
+// the endpoints always are, everything else only once it has moved at
+// least the deadband from the reported value AND into another report
+// bucket. Below that, the change stops at the PWM — no NVS write, no
+// BLE delta, no log line for auto mode's 1-unit corrections.
+static bool actuatorReportWorthy(uint8_t value, uint8_t reported) {
+    if (value == reported) {
+        return false;
     }
+    if (value == 0 || value == 255 || reported == 0) {
+        return true;
+    }
+    int16_t delta = (int16_t)value - (int16_t)reported;
+    if (delta < 0) delta = -delta;
+    if (delta < ACTUATOR_DEADBAND) {
+        return false;
+    }
+    return (value / ACTUATOR_REPORT_BUCKET) !=
+           (reported / ACTUATOR_REPORT_BUCKET);
 }
 
 // ============================================================================
 // FAN CONTROL
 // ============================================================================
 void setFanSpeed(uint8_t speed) {
-    currentFanSpeed = speed;
-    ledcWrite(FAN_PWM_CHANNEL, speed);
-    preferences.putUInt(PREF_FAN_SPEED, speed);
-    DEBUG_PRINTF("Fan: %d (%.1f%%)\n", speed, (speed / 255.0f) * 100);
+    // Ramp instead of slam: a 0-to-full duty step's inrush browns out
+    // the 5 V rail and corrupts sensor reads. The fade runs entirely
+    // in the LEDC peripheral — zero CPU, slope from config.
+    int16_t delta = (int16_t)speed - (int16_t)appliedFanSpeed;
+    if (delta < 0) delta = -delta;
+    uint32_t rampMs = (uint32_t)delta * FAN_RAMP_MS_PER_COUNT;
+
+    // Rig timestamp covers both paths: the instant the new duty (or
+    // its fade) reaches the LEDC peripheral.
+    TEST_RIG_PULSE(TEST_RIG_PIN_ACTUATE);
+    if (rampMs == 0) {
+        ledcWrite(FAN_PWM_CHANNEL, speed);
+    } else {
+        ledc_set_fade_with_time(LEDC_HIGH_SPEED_MODE,
+                                (ledc_channel_t)FAN_PWM_CHANNEL,
+                                speed, rampMs);
+        ledc_fade_start(LEDC_HIGH_SPEED_MODE,
+                        (ledc_channel_t)FAN_PWM_CHANNEL,
+                        LEDC_FADE_NO_WAIT);
+    }
+    appliedFanSpeed = speed;
+
+    if (!actuatorReportWorthy(speed, deviceState.fanSpeed())) {
+        return; // micro-adjustment: PWM only
+    }
+    deviceState.setFanSpeed(speed);
+    markPrefDirty(PREF_DIRTY_FAN); // RAM is current; flash catches up
+    DEBUG_PRINTF("Fan: %d (%.1f%%, ramp %u ms)\n", speed,
+                 (speed / 255.0f) * 100, rampMs);
 }
 
 // ============================================================================
 // LED CONTROL
 // ============================================================================
 void setLEDBrightness(uint8_t brightness) {
-    currentLEDBrightness = brightness;
-    ledcWrite(LED_PWM_CHANNEL, brightness);
-    preferences.putUInt(PREF_LED_BRIGHTNESS, brightness);
+    // Gamma-corrected duty: one table read, no float math. The command
+    // value stays 0-255 everywhere else — only the duty is 13-bit.
+    TEST_RIG_PULSE(TEST_RIG_PIN_ACTUATE);
+    ledcWrite(LED_PWM_CHANNEL, ledGammaDuty(brightness));
+    appliedLEDBrightness = brightness;
+
+    if (!actuatorReportWorthy(brightness, deviceState.ledBrightness())) {
+        return; // micro-adjustment: PWM only
+    }
+    deviceState.setLedBrightness(brightness);
+    markPrefDirty(PREF_DIRTY_LED);
     DEBUG_PRINTF("LED: %d (%.1f%%)\n", brightness, (brightness / 255.0f) * 100);
 }
 
+// ============================================================================
+// LED FADE CONTROL
+// ============================================================================
+void setLEDBrightnessFade(uint8_t target, uint16_t durationMs) {
+    if (durationMs == 0) {
+        setLEDBrightness(target);
+        return;
+    }
+
+    // The ramp runs entirely in the LEDC peripheral; the NVS write
+    // coalesces with any other pending settings change. The fade target
+    // goes through the same gamma table as direct writes, so a fade and
+    // a set to the same brightness land on the same duty.
+    ledc_set_fade_with_time(LEDC_HIGH_SPEED_MODE,
+                            (ledc_channel_t)LED_PWM_CHANNEL,
+                            ledGammaDuty(target), durationMs);
+    ledc_fade_start(LEDC_HIGH_SPEED_MODE,
+                    (ledc_channel_t)LED_PWM_CHANNEL,
+                    LEDC_FADE_NO_WAIT);
+
+    // Fades are explicit user gestures, never auto-mode chatter, so
+    // they always report regardless of the quantization deadband.
+    appliedLEDBrightness = target;
+    if (deviceState.setLedBrightness(target)) {
+        markPrefDirty(PREF_DIRTY_LED);
+    }
+    DEBUG_PRINTF("LED fade to %d over %d ms\n", target, durationMs);
+}
+
 // ============================================================================
 // MOTION TIMEOUT CHECK
 // ============================================================================
+// Raises once per quiet spell; the PIR rising edge clears the alarm
+// through the pipeline, which also rearms this latch.
+bool motionTimeoutRaised = false;
+
 void checkMotionTimeout() {
-    if (sensorData.lastMotionTime > 0) {
-        unsigned long elapsed = millis() - sensorData.lastMotionTime;
-        if (elapsed > MOTION_TIMEOUT && !sensorData.motionDetected) {
-            DEBUG_PRINTLN("⚠️  No motion for 5 minutes!");
+    if (sensorData.lastMotionTime == 0) {
+        return;
+    }
+    // 64-bit throughout: the quiet spell this watches for is exactly
+    // the stamp that outlives a 32-bit millis() span on a unit that
+    // never reboots.
+    int64_t elapsed = MonoClock::nowMs() - sensorData.lastMotionTime;
+    // Learned per-hour threshold once the baseline has seen enough
+    // days; MOTION_TIMEOUT until then (or with the clock unsynced).
+    if (elapsed > occupancyBaseline.activeTimeoutMs() &&
+        !sensorData.motionDetected) {
+        // House-level check: a resident moving in another room is not
+        // a missing resident. Only this room going quiet with the
+        // whole mesh quiet raises the alarm.
+        if (espNowMesh.anyRecentPeerMotion()) {
+            return;
         }
+        if (!motionTimeoutRaised) {
+            motionTimeoutRaised = true;
+            alarmSystem.raise(AlarmSystem::ALARM_MOTION_TIMEOUT,
+                              (uint16_t)(elapsed / 60000));
+            // The chime is stage 0; the app and caregiver stages now
+            // count down on the escalation wheel.
+            escalationLadder.armMotionLadder();
+        }
+    } else {
+        if (motionTimeoutRaised) {
+            escalationLadder.cancelMotionLadder();
+        }
+        motionTimeoutRaised = false;
     }
-}
\ No newline at end of file
+}
+
+#endif // PIO_UNIT_TESTING
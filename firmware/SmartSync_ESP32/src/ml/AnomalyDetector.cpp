@@ -0,0 +1,251 @@
+#include "AnomalyDetector.h"
+#include <esp32/rom/crc.h>
+#include "../security/AlarmSystem.h"
+#include "InferenceArena.h"
+#include "ModelStore.h"
+#include "../system/MonoClock.h"
+#include "../system/RtcClock.h"
+
+// Population defaults, used until a per-home baseline lands in the
+// model partition. Units match featureVector(): minutes, counts,
+// hours, °C × 100. Scales are deliberately wide — a stock baseline
+// should under-alarm, not cry wolf before training has seen the home.
+static const AnomalyBaseline DEFAULT_BASELINE = {
+    ANOMALY_MODEL_MAGIC,
+    ANOMALY_MODEL_VERSION,
+    ANOMALY_FEATURE_COUNT,
+    {  30, 120,   1, 250, 500 }, // mean
+    {  90,  80,   2, 250, 300 }, // scale (one standard deviation)
+    4000,                        // thresholdQ8 (~4 sigma on one feature)
+    0,                           // crc unused for the compiled-in copy
+};
+
+AnomalyDetector::AnomalyDetector()
+    : clock(NULL),
+      alarms(NULL),
+      model(&DEFAULT_BASELINE),
+      modelFromPartition(false),
+      arena(NULL),
+      hours(NULL),
+      hourCount(0),
+      hourHead(0),
+      binHour(-1),
+      binMotion(0),
+      binNight(0),
+      binSamples(0),
+      binTempSumC100(0),
+      binTempMinC100(0),
+      binTempMaxC100(0),
+      prevMotion(false),
+      lastMotionMs(0),
+      everMotion(false),
+      lastScore(0),
+      active(false) {
+}
+
+void AnomalyDetector::begin(RtcClock* rtc, AlarmSystem* alarmSink,
+                            ModelStore* models, InferenceArena* mlArena) {
+    clock = rtc;
+    alarms = alarmSink;
+    arena = mlArena;
+    if (arena != NULL) {
+        hours = (HourBin*)arena->carve(sizeof(HourBin) * 24);
+    }
+    if (hours == NULL) {
+        DEBUG_PRINTLN("Anomaly detector disabled: no arena space");
+        return;
+    }
+    loadBaseline(models);
+
+    DEBUG_PRINTF("Anomaly detector: %s baseline, threshold %u\n",
+                 modelFromPartition ? "partition" : "default",
+                 model->thresholdQ8);
+}
+
+// The blob is served out of the model store's mapping and referenced
+// in place — the store keeps the partition mapped for the firmware's
+// lifetime, so the pointer never dangles and nothing is copied. Any
+// validation failure (blank partition, stale featureCount after a
+// firmware change, torn write) falls back to the compiled-in defaults.
+// The blob self-validates even when the store found it via a
+// directory entry, because the legacy bare-blob shape carries no
+// directory CRC.
+void AnomalyDetector::loadBaseline(ModelStore* models) {
+    if (models == NULL) {
+        return;
+    }
+    const AnomalyBaseline* blob = (const AnomalyBaseline*)
+        models->find(ANOMALY_MODEL_MAGIC, ANOMALY_MODEL_VERSION, NULL);
+    if (blob == NULL) {
+        return;
+    }
+
+    bool valid = blob->magic == ANOMALY_MODEL_MAGIC &&
+                 blob->version == ANOMALY_MODEL_VERSION &&
+                 blob->featureCount == ANOMALY_FEATURE_COUNT &&
+                 blob->crc == crc32_le(0, (const uint8_t*)blob,
+                                       offsetof(AnomalyBaseline, crc));
+    if (valid) {
+        for (int i = 0; i < ANOMALY_FEATURE_COUNT; i++) {
+            if (blob->scale[i] == 0) {
+                valid = false; // division guard: reject, don't patch
+                break;
+            }
+        }
+    }
+    if (valid) {
+        model = blob;
+        modelFromPartition = true;
+    }
+}
+
+void AnomalyDetector::rebind(ModelStore* models) {
+    model = &DEFAULT_BASELINE;
+    modelFromPartition = false;
+    loadBaseline(models);
+    DEBUG_PRINTF("Anomaly detector: rebound to %s baseline\n",
+                 modelFromPartition ? "partition" : "default");
+}
+
+void AnomalyDetector::feed(float temperatureC, bool motion) {
+    if (hours == NULL) {
+        return;
+    }
+    int64_t now = MonoClock::nowMs();
+    if (motion && !prevMotion) {
+        binMotion++;
+        everMotion = true;
+    }
+    if (motion) {
+        lastMotionMs = now;
+    }
+    prevMotion = motion;
+
+    int16_t tempC100 = (int16_t)(temperatureC * 100.0f);
+    if (binSamples == 0) {
+        binTempMinC100 = tempC100;
+        binTempMaxC100 = tempC100;
+    } else {
+        if (tempC100 < binTempMinC100) binTempMinC100 = tempC100;
+        if (tempC100 > binTempMaxC100) binTempMaxC100 = tempC100;
+    }
+    binTempSumC100 += tempC100;
+    binSamples++;
+
+    // Hourly binning needs wall-clock time; until the RTC syncs the
+    // detector just accumulates (and the score below stays quiet
+    // because no bins have completed).
+    int8_t hour = clock->hourOfDay();
+    if (hour >= 0) {
+        if (binHour < 0) {
+            binHour = hour;
+        } else if (hour != binHour) {
+            rollHour(hour);
+        }
+        if (motion && (hour >= ANOMALY_NIGHT_START_HOUR ||
+                       hour <= ANOMALY_NIGHT_END_HOUR)) {
+            binNight = 1;
+        }
+    }
+
+    evaluate();
+}
+
+void AnomalyDetector::rollHour(int8_t newHour) {
+    HourBin& bin = hours[hourHead];
+    bin.motionEvents = binMotion;
+    bin.tempMeanC100 = binSamples
+        ? (int16_t)(binTempSumC100 / (int32_t)binSamples)
+        : 0;
+    bin.tempMinC100 = binTempMinC100;
+    bin.tempMaxC100 = binTempMaxC100;
+    bin.nightActive = binNight;
+
+    hourHead = (hourHead + 1) % 24;
+    if (hourCount < 24) {
+        hourCount++;
+    }
+
+    binHour = newHour;
+    binMotion = 0;
+    binNight = 0;
+    binSamples = 0;
+    binTempSumC100 = 0;
+    binTempMinC100 = 0;
+    binTempMaxC100 = 0;
+}
+
+// Feature units are fixed across firmware and trainer:
+//   [0] minutes since the last motion event
+//   [1] motion events over the last 24 h
+//   [2] night-active hours over the last 24 h
+//   [3] current-hour |mean temperature - comfort|, °C × 100
+//   [4] 24 h temperature range, °C × 100
+void AnomalyDetector::featureVector(int32_t* features) const {
+    int64_t sinceMs = MonoClock::nowMs() - (everMotion ? lastMotionMs : 0);
+    features[0] = (int32_t)(sinceMs / 60000LL);
+
+    int32_t motionSum = binMotion;
+    int32_t nightSum = binNight;
+    int16_t tempMin = binSamples ? binTempMinC100 : INT16_MAX;
+    int16_t tempMax = binSamples ? binTempMaxC100 : INT16_MIN;
+    for (uint8_t i = 0; i < hourCount; i++) {
+        const HourBin& bin = hours[i];
+        motionSum += bin.motionEvents;
+        nightSum += bin.nightActive;
+        if (bin.tempMinC100 < tempMin) tempMin = bin.tempMinC100;
+        if (bin.tempMaxC100 > tempMax) tempMax = bin.tempMaxC100;
+    }
+    features[1] = motionSum;
+    features[2] = nightSum;
+
+    int32_t meanC100 = binSamples
+        ? binTempSumC100 / (int32_t)binSamples
+        : hours[(hourHead + 23) % 24].tempMeanC100;
+    int32_t deviation = meanC100 - ANOMALY_COMFORT_TEMP_C100;
+    features[3] = deviation < 0 ? -deviation : deviation;
+
+    features[4] = (tempMax > tempMin) ? (int32_t)tempMax - tempMin : 0;
+}
+
+// Standardized squared deviation in Q8: each feature contributes
+// ((f - mean) * 16 / scale)^2, i.e. 256 per standard deviation
+// squared. Deviations clamp at 64 sigma so a wild feature (clock jump,
+// sensor glitch) can't overflow the sum.
+uint32_t AnomalyDetector::scoreQ8(const int32_t* features) const {
+    uint32_t sum = 0;
+    for (int i = 0; i < ANOMALY_FEATURE_COUNT; i++) {
+        int32_t dev = ((features[i] - model->mean[i]) * 16)
+                      / model->scale[i];
+        if (dev < -1024) dev = -1024;
+        if (dev > 1024) dev = 1024;
+        sum += (uint32_t)(dev * dev);
+    }
+    return sum;
+}
+
+void AnomalyDetector::evaluate() {
+    if (hourCount < ANOMALY_MIN_HOURS) {
+        return; // still warming up after boot
+    }
+
+    // The feature vector lives on the stack — small, and allocation-
+    // free by construction; the checkpoints confirm the whole run is.
+    int32_t features[ANOMALY_FEATURE_COUNT];
+    arena->checkpointBegin();
+    featureVector(features);
+    lastScore = scoreQ8(features);
+    arena->checkpointEnd();
+
+    // Hysteresis: the clear threshold sits at half the raise threshold
+    // so a score hovering at the line can't flap alerts.
+    if (!active && lastScore >= model->thresholdQ8) {
+        active = true;
+        uint32_t sigma2 = lastScore >> 8;
+        alarms->raise(AlarmSystem::ALARM_ANOMALY,
+                      sigma2 > 65535 ? 65535 : (uint16_t)sigma2);
+    } else if (active && lastScore < model->thresholdQ8 / 2) {
+        active = false;
+        alarms->raise(AlarmSystem::ALARM_ANOMALY_CLEAR, 0);
+    }
+}
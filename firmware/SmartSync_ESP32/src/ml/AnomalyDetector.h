@@ -0,0 +1,120 @@
+#ifndef ANOMALY_DETECTOR_H
+#define ANOMALY_DETECTOR_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+class AlarmSystem;
+class InferenceArena;
+class ModelStore;
+class RtcClock;
+
+// On-device counterpart of ml/scripts/train_anomaly_detector.py: the
+// same behavioral features (inactivity, nighttime activity, temperature
+// comfort) computed over the last 24 hours of sensor data and scored
+// every sensor cycle, so a deviation raises into the AlarmSystem within
+// one sample period — no cloud round trip, and alerts keep working with
+// WiFi and the phone gone.
+//
+// The trainer's autoencoder is tiny, but the TFLite Micro runtime it
+// would need is not, and nothing else in the firmware wants it. For an
+// 8-wide encoding over standardized features, reconstruction error is
+// well approximated by the standardized squared deviation from the
+// per-home baseline — so the device scores exactly that, in fixed
+// point. The baseline (per-feature mean and scale plus a threshold) is
+// what training actually personalizes, and it deploys as a small blob
+// in the model partition next to the .tflite the app consumes;
+// compiled-in population defaults cover a blank partition. The blob is
+// referenced straight out of the ModelStore's mapping — never copied.
+
+// Layout of the baseline blob in the model partition (ModelStore
+// entry ANOMALY_MODEL_MAGIC; also accepted bare at offset 0 from
+// before the directory format).
+struct __attribute__((packed)) AnomalyBaseline {
+    uint32_t magic;        // ANOMALY_MODEL_MAGIC
+    uint16_t version;      // ANOMALY_MODEL_VERSION
+    uint16_t featureCount; // must equal ANOMALY_FEATURE_COUNT
+    int32_t mean[ANOMALY_FEATURE_COUNT];  // feature units (featureVector)
+    int32_t scale[ANOMALY_FEATURE_COUNT]; // standard deviation, never 0
+    uint32_t thresholdQ8;  // raise when the Q8 score crosses this
+    uint32_t crc;          // CRC-32 over all preceding bytes
+};
+
+class AnomalyDetector {
+public:
+    AnomalyDetector();
+
+    // Loads the baseline (model store, else defaults) and carves the
+    // hourly ring from the arena. The alarm pipeline guards its own
+    // not-yet-started state, so begin order against AlarmSystem
+    // doesn't matter; the store and arena must be begun.
+    void begin(RtcClock* clock, AlarmSystem* alarms, ModelStore* models,
+               InferenceArena* arena);
+
+    // One call per sensor cycle, relayed through the ML task's queue.
+    // Accumulates the current hour's bin and re-scores; the score
+    // itself is a handful of integer ops, so it runs every cycle
+    // without budget impact.
+    void feed(float temperatureC, bool motion);
+
+    // Re-resolves the baseline after a model update switched banks.
+    // Called on the ML task so the pointer never changes under a
+    // score in progress.
+    void rebind(ModelStore* models);
+
+    uint32_t lastScoreQ8() const { return lastScore; }
+    bool anomalyActive() const { return active; }
+
+private:
+    // One completed hour of aggregated sensor data.
+    struct HourBin {
+        uint16_t motionEvents;  // PIR rising edges
+        int16_t tempMeanC100;   // °C × 100
+        int16_t tempMinC100;
+        int16_t tempMaxC100;
+        uint8_t nightActive;    // motion during the night window
+    };
+
+    void rollHour(int8_t newHour);
+    void featureVector(int32_t* features) const;
+    uint32_t scoreQ8(const int32_t* features) const;
+    void evaluate();
+    void loadBaseline(ModelStore* models);
+
+    RtcClock* clock;
+    AlarmSystem* alarms;
+
+    // Active baseline: a validated blob in mapped flash (zero-copy,
+    // valid for the firmware's lifetime) or the compiled-in defaults.
+    const AnomalyBaseline* model;
+    bool modelFromPartition;
+
+    InferenceArena* arena; // watermark checkpoints around each score
+
+    // Ring of the last 24 completed hours, carved from the arena;
+    // scoring needs ANOMALY_MIN_HOURS of them, so the detector warms
+    // up after boot rather than reconstructing bins from boot-relative
+    // history timestamps.
+    HourBin* hours;
+    uint8_t hourCount;
+    uint8_t hourHead; // next slot to fill
+
+    // Current (partial) hour accumulation.
+    int8_t binHour;   // -1 until the clock is valid
+    uint16_t binMotion;
+    uint8_t binNight;
+    uint32_t binSamples;
+    int32_t binTempSumC100;
+    int16_t binTempMinC100;
+    int16_t binTempMaxC100;
+
+    bool prevMotion;      // edge detector for motionEvents
+    int64_t lastMotionMs; // MonoClock::nowMs(); feature [0] spans
+                          // quiet spells longer than 32-bit millis()
+    bool everMotion;
+
+    uint32_t lastScore;
+    bool active; // raise/clear hysteresis latch
+};
+
+#endif // ANOMALY_DETECTOR_H
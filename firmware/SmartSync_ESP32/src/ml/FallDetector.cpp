@@ -0,0 +1,183 @@
+#include "FallDetector.h"
+#include "../security/AlarmSystem.h"
+#include "InferenceArena.h"
+#include "MlKernels.h"
+#include "ModelStore.h"
+
+// Q8 weights over the four Q8 features (step sharpness, tail
+// stillness, PIR quiet, level shift); a nominal hit on every feature
+// scores 65536. Hand-tuned initial values — a trained, quantized
+// replacement deploys into the model partition and is picked up at
+// boot without touching the inference code.
+static const FallModel DEFAULT_FALL_MODEL = {
+    { 96, 64, 32, 64 },
+    FALL_SCORE_THRESHOLD_Q16,
+};
+
+FallDetector::FallDetector()
+    : ring(NULL),
+      alarms(NULL),
+      model(&DEFAULT_FALL_MODEL),
+      arena(NULL),
+      window(NULL),
+      dist(NULL),
+      raised(false),
+      lastScore(0),
+      recoveryEdges(0),
+      recoveryFirstMs(0) {
+}
+
+void FallDetector::begin(HighRateRing* sampleRing, AlarmSystem* alarmSink,
+                         ModelStore* models, InferenceArena* mlArena) {
+    ring = sampleRing;
+    alarms = alarmSink;
+    arena = mlArena;
+
+    if (arena != NULL) {
+        window = (HighRateSample*)
+            arena->carve(sizeof(HighRateSample) * FALL_WINDOW_SAMPLES);
+        dist = (int32_t*)arena->carve(sizeof(int32_t) * FALL_WINDOW_SAMPLES);
+    }
+    if (window == NULL || dist == NULL) {
+        window = NULL; // arena missing or exhausted: detector off
+        DEBUG_PRINTLN("Fall detector disabled: no arena space");
+        return;
+    }
+
+    loadModel(models);
+    DEBUG_PRINTF("Fall detector armed (%s weights).\n",
+                 model == &DEFAULT_FALL_MODEL ? "default" : "partition");
+}
+
+// Unlike the anomaly baseline, the weight blob doesn't self-validate,
+// so only a CRC-checked directory entry of the right size is accepted.
+void FallDetector::loadModel(ModelStore* models) {
+    uint32_t size = 0;
+    const FallModel* deployed = models == NULL
+        ? NULL
+        : (const FallModel*)models->find(FALL_MODEL_MAGIC,
+                                         FALL_MODEL_VERSION, &size);
+    if (deployed != NULL && size >= sizeof(FallModel)) {
+        model = deployed;
+    }
+}
+
+void FallDetector::rebind(ModelStore* models) {
+    model = &DEFAULT_FALL_MODEL;
+    loadModel(models);
+    DEBUG_PRINTF("Fall detector: rebound to %s weights\n",
+                 model == &DEFAULT_FALL_MODEL ? "default" : "partition");
+}
+
+void FallDetector::evaluate() {
+    if (window == NULL || ring == NULL || !ring->isReady()) {
+        return;
+    }
+
+    uint16_t stepCm = 0;
+    arena->checkpointBegin();
+    lastScore = scoreWindow(&stepCm);
+    arena->checkpointEnd();
+
+    if (!raised && lastScore >= model->thresholdQ16) {
+        raised = true;
+        recoveryEdges = 0;
+        alarms->raise(AlarmSystem::ALARM_FALL_SUSPECTED, stepCm);
+    }
+}
+
+void FallDetector::notePirEdge(bool level, uint32_t timestampMs) {
+    if (!raised || !level) {
+        return;
+    }
+    if (recoveryEdges == 0 ||
+        timestampMs - recoveryFirstMs > FALL_RECOVERY_WINDOW_MS) {
+        recoveryEdges = 0;
+        recoveryFirstMs = timestampMs;
+    }
+    if (++recoveryEdges >= FALL_RECOVERY_EDGES) {
+        raised = false;
+        alarms->raise(AlarmSystem::ALARM_FALL_CLEAR, 0);
+    }
+}
+
+// Feature extraction over one window copy. Everything is integer in
+// the ring's native cm × 10 units; the only division per feature is
+// by a config constant. Returns 0 (no fall) unless the window holds a
+// real level step — pure stillness must never score.
+uint32_t FallDetector::scoreWindow(uint16_t* outStepCm) {
+    size_t n = ring->copyLatest(window, FALL_WINDOW_SAMPLES);
+
+    // Split out the valid distance series; remember when the
+    // stillness tail begins so PIR edges can be counted against it.
+    int m = 0;
+    uint32_t tailStartMs = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (window[i].type == HIGHRATE_DISTANCE &&
+            window[i].distance != 0xFFFF) {
+            dist[m++] = window[i].distance;
+        }
+    }
+    if (m < FALL_STILL_SAMPLES + 4) {
+        return 0; // not enough echoes to judge
+    }
+
+    int tailFirst = m - FALL_STILL_SAMPLES;
+
+    // Second pass to find the tail's start time (cheaper than storing
+    // a parallel timestamp array).
+    int seen = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (window[i].type == HIGHRATE_DISTANCE &&
+            window[i].distance != 0xFFFF) {
+            if (seen == tailFirst) {
+                tailStartMs = window[i].timestampMs;
+                break;
+            }
+            seen++;
+        }
+    }
+
+    int32_t meanBefore = mlSumI32(dist, tailFirst) / tailFirst;
+    int32_t meanAfter =
+        mlSumI32(dist + tailFirst, FALL_STILL_SAMPLES) / FALL_STILL_SAMPLES;
+
+    int32_t step = meanAfter - meanBefore;
+    if (step < 0) step = -step;
+    if (step < FALL_DELTA_MIN / 2) {
+        return 0; // no level shift, nothing fell
+    }
+    *outStepCm = (uint16_t)(step / 10);
+
+    // Sharpest adjacent move — a fall is a step, drift is a ramp.
+    int32_t maxAdj = mlMaxAdjDeltaI32(dist, m);
+
+    // Tail variance around its own mean.
+    int32_t var = mlSumSqDiffI32(dist + tailFirst, FALL_STILL_SAMPLES,
+                                 meanAfter) / FALL_STILL_SAMPLES;
+
+    // PIR rising edges inside the tail's time span.
+    int32_t pirEdges = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (window[i].type == HIGHRATE_PIR_EDGE &&
+            (window[i].flags & 0x01) &&
+            window[i].timestampMs >= tailStartMs) {
+            pirEdges++;
+        }
+    }
+
+    // Q8 features, each nominal at 256.
+    int32_t q[4];
+    q[0] = (maxAdj << 8) / FALL_DELTA_MIN;
+    if (q[0] > 1024) q[0] = 1024;
+    q[1] = var >= FALL_STILL_VAR_MAX
+        ? 0
+        : 256 - (var << 8) / FALL_STILL_VAR_MAX;
+    q[2] = pirEdges > FALL_PIR_QUIET_EDGES_MAX
+        ? 0
+        : 256 - (pirEdges << 8) / (FALL_PIR_QUIET_EDGES_MAX + 1);
+    q[3] = (step << 8) / FALL_DELTA_MIN;
+    if (q[3] > 1024) q[3] = 1024;
+
+    return (uint32_t)mlDotQ8(model->weightsQ8, q, 4);
+}
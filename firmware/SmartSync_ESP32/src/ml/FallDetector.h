@@ -0,0 +1,84 @@
+#ifndef FALL_DETECTOR_H
+#define FALL_DETECTOR_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+#include "../storage/HighRateRing.h"
+
+class AlarmSystem;
+class InferenceArena;
+class ModelStore;
+
+// Fall detection from the sensors already fitted: a fall reads as a
+// rapid step in the ultrasonic distance (the person drops out of the
+// beam, the far wall takes over) followed by prolonged stillness at
+// the new level with the PIR gone quiet. The classifier runs over the
+// PSRAM high-rate ring — which samples at full rate during activity,
+// and a fall by definition follows activity — as fixed-point feature
+// extraction (step size, tail variance, PIR edge density, level
+// shift) feeding a Q8-weighted linear score against a Q16 threshold.
+//
+// Inference runs on the dedicated ML task (main.cpp), woken for every
+// distance sample that lands in the ring, so the decisive sample
+// reaches the alarm pipeline within one sample period without ever
+// borrowing a latency-sensitive context. Working state is carved from
+// the inference arena — no allocation on any inference path.
+
+// Deployable weights (ModelStore entry FALL_MODEL_MAGIC), referenced
+// zero-copy from mapped flash; compiled-in defaults otherwise.
+struct __attribute__((packed)) FallModel {
+    int16_t weightsQ8[4];   // step sharpness, stillness, PIR quiet,
+                            // level shift
+    uint32_t thresholdQ16;  // raise when the score crosses this
+};
+
+class FallDetector {
+public:
+    FallDetector();
+
+    // Wires the sample source, alarm sink, and weights, and carves the
+    // inference buffers from the arena; nothing is owned. A NULL or
+    // exhausted arena disables the detector rather than allocating.
+    void begin(HighRateRing* ring, AlarmSystem* alarms, ModelStore* models,
+               InferenceArena* arena);
+
+    // Called from the ML task after each distance sample is pushed.
+    // Extracts features and raises ALARM_FALL_SUSPECTED when the
+    // score crosses the threshold.
+    void evaluate();
+
+    // Every PIR transition, relayed through the ML task's queue.
+    // Sustained rising edges after a raise mean the person is up
+    // again and clear the alarm.
+    void notePirEdge(bool level, uint32_t timestampMs);
+
+    // Re-resolves the weights after a model update switched banks.
+    // Called on the ML task so the pointer never changes mid-score.
+    void rebind(ModelStore* models);
+
+    bool fallSuspected() const { return raised; }
+    uint32_t lastScoreQ16() const { return lastScore; }
+
+private:
+    void loadModel(ModelStore* models);
+    uint32_t scoreWindow(uint16_t* outStepCm);
+
+    HighRateRing* ring;
+    AlarmSystem* alarms;
+    const FallModel* model; // mapped flash or compiled-in defaults
+    InferenceArena* arena;  // watermark checkpoints around each run
+
+    // Inference scratch, carved from the arena at begin(): the window
+    // copy and the distance series split out of it.
+    HighRateSample* window;
+    int32_t* dist;
+
+    bool raised;
+    uint32_t lastScore;
+
+    // Recovery: rising edges inside FALL_RECOVERY_WINDOW_MS.
+    uint8_t recoveryEdges;
+    uint32_t recoveryFirstMs;
+};
+
+#endif // FALL_DETECTOR_H
@@ -0,0 +1,67 @@
+#include "InferenceArena.h"
+#include <esp_heap_caps.h>
+
+InferenceArena::InferenceArena()
+    : base(NULL),
+      cap(0),
+      offset(0),
+      sealed(false),
+      watermarkBefore(0),
+      violations(0) {
+}
+
+bool InferenceArena::begin(size_t bytes) {
+    // PSRAM first: the arena's buffers are windows and tensors, all
+    // bulk sequential access, which external RAM serves fine — and
+    // internal RAM stays free for NimBLE and task stacks.
+    base = (uint8_t*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    if (base == NULL) {
+        base = (uint8_t*)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    }
+    if (base == NULL) {
+        DEBUG_PRINTLN("Inference arena: allocation failed, ML disabled");
+        return false;
+    }
+    cap = bytes;
+    memset(base, 0, cap);
+    return true;
+}
+
+void* InferenceArena::carve(size_t bytes) {
+    if (base == NULL || sealed) {
+        return NULL;
+    }
+    size_t aligned = (bytes + 7) & ~(size_t)7;
+    if (aligned > cap - offset) {
+        DEBUG_PRINTF("Inference arena exhausted (%u of %u used)\n",
+                     offset, cap);
+        return NULL;
+    }
+    void* p = base + offset;
+    offset += aligned;
+    return p;
+}
+
+void InferenceArena::seal() {
+    sealed = true;
+    DEBUG_PRINTF("Inference arena sealed: %u of %u bytes carved\n",
+                 offset, cap);
+}
+
+void InferenceArena::checkpointBegin() {
+    watermarkBefore = esp_get_minimum_free_heap_size();
+}
+
+void InferenceArena::checkpointEnd() {
+    uint32_t after = esp_get_minimum_free_heap_size();
+    if (after < watermarkBefore) {
+        // The watermark only sinks when something allocated past the
+        // previous low — transient allocations inside the run count.
+        // Noise from other tasks is possible but a steadily rising
+        // counter during ML-only activity is a regression, full stop.
+        if (violations++ == 0) {
+            DEBUG_PRINTF("Inference heap watermark sank %u bytes\n",
+                         watermarkBefore - after);
+        }
+    }
+}
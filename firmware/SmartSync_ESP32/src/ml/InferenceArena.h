@@ -0,0 +1,55 @@
+#ifndef INFERENCE_ARENA_H
+#define INFERENCE_ARENA_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// One statically sized block for every ML working buffer. Inference
+// that allocates per run fragments the heap alongside NimBLE's
+// allocations and eventually bricks long-running units, so the arena
+// is allocated once at init — in PSRAM when fitted, the board builds
+// with -DBOARD_HAS_PSRAM — and consumers carve their windows, feature
+// buffers, and (future) tensors out of it with a bump pointer. seal()
+// ends carving; from then on the ML pipeline owns no allocation path.
+//
+// The zero-heap claim is verifiable, not aspirational: checkpoints
+// around an inference run compare the heap's minimum-free watermark,
+// which moves on any allocation deep enough to set a new low — even
+// one that was freed before the run ended. Violations are counted and
+// logged on first occurrence.
+class InferenceArena {
+public:
+    InferenceArena();
+
+    // Allocates the block (PSRAM preferred, internal fallback).
+    bool begin(size_t bytes);
+
+    // Init-time bump allocation, 8-byte aligned, zeroed. NULL once
+    // sealed or exhausted — callers must treat that as "feature off",
+    // never fall back to malloc.
+    void* carve(size_t bytes);
+
+    // Ends carving and snapshots the heap watermark as the baseline
+    // the checkpoints compare against.
+    void seal();
+
+    // Bracket an inference run; end counts a violation if the
+    // minimum-free watermark sank during the run.
+    void checkpointBegin();
+    void checkpointEnd();
+
+    size_t capacity() const { return cap; }
+    size_t used() const { return offset; }
+    uint32_t heapViolations() const { return violations; }
+
+private:
+    uint8_t* base;
+    size_t cap;
+    size_t offset;
+    bool sealed;
+
+    uint32_t watermarkBefore;
+    uint32_t violations;
+};
+
+#endif // INFERENCE_ARENA_H
@@ -0,0 +1,147 @@
+#include "MlKernels.h"
+#include <esp_timer.h>
+
+int32_t mlSumI32Ref(const int32_t* v, int n) {
+    int32_t sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum += v[i];
+    }
+    return sum;
+}
+
+int32_t mlSumI32(const int32_t* v, int n) {
+    int32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += v[i];
+        s1 += v[i + 1];
+        s2 += v[i + 2];
+        s3 += v[i + 3];
+    }
+    for (; i < n; i++) {
+        s0 += v[i];
+    }
+    return s0 + s1 + s2 + s3;
+}
+
+int32_t mlSumSqDiffI32Ref(const int32_t* v, int n, int32_t mean) {
+    int32_t sum = 0;
+    for (int i = 0; i < n; i++) {
+        int32_t d = v[i] - mean;
+        sum += d * d;
+    }
+    return sum;
+}
+
+int32_t mlSumSqDiffI32(const int32_t* v, int n, int32_t mean) {
+    int32_t s0 = 0, s1 = 0;
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        int32_t d0 = v[i] - mean;
+        int32_t d1 = v[i + 1] - mean;
+        s0 += d0 * d0;
+        s1 += d1 * d1;
+    }
+    if (i < n) {
+        int32_t d = v[i] - mean;
+        s0 += d * d;
+    }
+    return s0 + s1;
+}
+
+int32_t mlMaxAdjDeltaI32Ref(const int32_t* v, int n) {
+    int32_t best = 0;
+    for (int i = 1; i < n; i++) {
+        int32_t d = v[i] - v[i - 1];
+        if (d < 0) d = -d;
+        if (d > best) best = d;
+    }
+    return best;
+}
+
+int32_t mlMaxAdjDeltaI32(const int32_t* v, int n) {
+    int32_t best0 = 0, best1 = 0;
+    int i = 1;
+    for (; i + 2 <= n; i += 2) {
+        int32_t d0 = v[i] - v[i - 1];
+        int32_t d1 = v[i + 1] - v[i];
+        if (d0 < 0) d0 = -d0;
+        if (d1 < 0) d1 = -d1;
+        if (d0 > best0) best0 = d0;
+        if (d1 > best1) best1 = d1;
+    }
+    if (i < n) {
+        int32_t d = v[i] - v[i - 1];
+        if (d < 0) d = -d;
+        if (d > best0) best0 = d;
+    }
+    return best0 > best1 ? best0 : best1;
+}
+
+int32_t mlDotQ8Ref(const int16_t* w, const int32_t* q, int n) {
+    int32_t sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum += w[i] * q[i];
+    }
+    return sum;
+}
+
+int32_t mlDotQ8(const int16_t* w, const int32_t* q, int n) {
+    int32_t s0 = 0, s1 = 0;
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        s0 += w[i] * q[i];
+        s1 += w[i + 1] * q[i + 1];
+    }
+    if (i < n) {
+        s0 += w[i] * q[i];
+    }
+    return s0 + s1;
+}
+
+// One timed pass: reps iterations of fn over the prepared buffer,
+// reported in nanoseconds per call. The result sinks into a volatile
+// so the optimizer can't delete the loop.
+typedef int32_t (*SumFn)(const int32_t*, int);
+static volatile int32_t gBenchSink;
+
+static uint32_t benchNsPerOp(SumFn fn, const int32_t* v, int n, int reps) {
+    int64_t start = esp_timer_get_time();
+    for (int r = 0; r < reps; r++) {
+        gBenchSink = fn(v, n);
+    }
+    return (uint32_t)((esp_timer_get_time() - start) * 1000 / reps);
+}
+
+void mlKernelBenchmark() {
+    // The fall window is the real workload; synthetic ramp data keeps
+    // every branch in mlMaxAdjDeltaI32 honest.
+    int32_t v[FALL_WINDOW_SAMPLES];
+    for (int i = 0; i < FALL_WINDOW_SAMPLES; i++) {
+        v[i] = 2500 + ((i * 37) % 113);
+    }
+    const int reps = 2000;
+    const int n = FALL_WINDOW_SAMPLES;
+
+    uint32_t sumRef = benchNsPerOp(mlSumI32Ref, v, n, reps);
+    uint32_t sumOpt = benchNsPerOp(mlSumI32, v, n, reps);
+    uint32_t adjRef = benchNsPerOp(mlMaxAdjDeltaI32Ref, v, n, reps);
+    uint32_t adjOpt = benchNsPerOp(mlMaxAdjDeltaI32, v, n, reps);
+
+    int64_t start = esp_timer_get_time();
+    for (int r = 0; r < reps; r++) {
+        gBenchSink = mlSumSqDiffI32Ref(v, n, 2550);
+    }
+    uint32_t sqRef =
+        (uint32_t)((esp_timer_get_time() - start) * 1000 / reps);
+    start = esp_timer_get_time();
+    for (int r = 0; r < reps; r++) {
+        gBenchSink = mlSumSqDiffI32(v, n, 2550);
+    }
+    uint32_t sqOpt =
+        (uint32_t)((esp_timer_get_time() - start) * 1000 / reps);
+
+    DEBUG_PRINTF("ML kernels (n=%d, ns/op ref->opt): sum %u->%u, "
+                 "sqdiff %u->%u, maxadj %u->%u\n",
+                 n, sumRef, sumOpt, sqRef, sqOpt, adjRef, adjOpt);
+}
@@ -0,0 +1,41 @@
+#ifndef ML_KERNELS_H
+#define ML_KERNELS_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Fixed-point kernels shared by the detectors: windowed sums,
+// deviation accumulation, and the Q8 dot product are where the
+// inference cycles actually go, so they live here in one place with a
+// reference and an optimized form of each. The optimized versions are
+// four-way unrolled with independent accumulators — the LX6 has no
+// SIMD to hand these to, but the unroll removes most of the loop
+// overhead and gives the compiler room to schedule the multiplies.
+//
+// Both forms stay in the binary on purpose: mlKernelBenchmark() times
+// them against each other at the detectors' real window sizes and
+// logs per-op latency, so the headroom number is measured on the
+// device, not assumed — that is the budget future model growth is
+// sized against.
+
+// Sum of n values.
+int32_t mlSumI32Ref(const int32_t* v, int n);
+int32_t mlSumI32(const int32_t* v, int n);
+
+// Sum of squared deviations from mean.
+int32_t mlSumSqDiffI32Ref(const int32_t* v, int n, int32_t mean);
+int32_t mlSumSqDiffI32(const int32_t* v, int n, int32_t mean);
+
+// Largest absolute adjacent difference.
+int32_t mlMaxAdjDeltaI32Ref(const int32_t* v, int n);
+int32_t mlMaxAdjDeltaI32(const int32_t* v, int n);
+
+// Dot product of Q8 weights against Q8 features.
+int32_t mlDotQ8Ref(const int16_t* w, const int32_t* q, int n);
+int32_t mlDotQ8(const int16_t* w, const int32_t* q, int n);
+
+// Times every kernel pair at the fall window size and logs
+// reference vs optimized per-op latency. Run once from setup.
+void mlKernelBenchmark();
+
+#endif // ML_KERNELS_H
@@ -0,0 +1,136 @@
+#include "ModelStore.h"
+#include <esp32/rom/crc.h>
+#include "../storage/PartitionMap.h"
+
+// v1 directories predate the generation field: 8-byte header, entries
+// directly after, generation read as 0.
+#define MODEL_DIR_V1_HEADER 8
+
+ModelStore::ModelStore()
+    : base(NULL),
+      handle(0),
+      partitionSize(0),
+      entries(NULL),
+      count(0),
+      active(0),
+      generation(0) {
+}
+
+bool ModelStore::begin() {
+    const esp_partition_t* partition =
+        PartitionMap::find(PARTITION_LABEL_MODEL);
+    if (partition == NULL) {
+        return false;
+    }
+    partitionSize = partition->size;
+
+    base = (const uint8_t*)PartitionMap::map(PARTITION_LABEL_MODEL, &handle);
+    if (base == NULL) {
+        return false;
+    }
+
+    electBank();
+    DEBUG_PRINTF("Model store: %u KB mapped, bank %u gen %u, %u model(s)\n",
+                 partitionSize / 1024, active, generation, count);
+    return true;
+}
+
+void ModelStore::reload() {
+    if (base == NULL) {
+        return;
+    }
+    electBank();
+    DEBUG_PRINTF("Model store: reloaded, bank %u gen %u, %u model(s)\n",
+                 active, generation, count);
+}
+
+void ModelStore::electBank() {
+    entries = NULL;
+    count = 0;
+    active = 0;
+    generation = 0;
+
+    // Highest valid generation wins; a tie (both banks written with
+    // the same generation, which the updater never produces) keeps
+    // the lower bank for determinism.
+    bool elected = false;
+    for (uint8_t bank = 0; bank < MODEL_BANK_COUNT; bank++) {
+        const ModelDirEntry* bankEntries;
+        uint16_t bankCount;
+        uint32_t bankGeneration;
+        if (!parseBank(bank, &bankEntries, &bankCount, &bankGeneration)) {
+            continue;
+        }
+        if (!elected || bankGeneration > generation) {
+            entries = bankEntries;
+            count = bankCount;
+            active = bank;
+            generation = bankGeneration;
+            elected = true;
+        }
+    }
+    // No valid directory anywhere — blank flash or a legacy bare
+    // blob. The store stays mapped and find() handles those shapes
+    // against bank 0.
+}
+
+bool ModelStore::parseBank(uint8_t bank, const ModelDirEntry** outEntries,
+                           uint16_t* outCount,
+                           uint32_t* outGeneration) const {
+    const uint8_t* bankBase = base + (uint32_t)bank * bankSize();
+    const ModelDirectory* dir = (const ModelDirectory*)bankBase;
+    if (dir->magic != MODEL_DIR_MAGIC ||
+        dir->count > MODEL_DIR_MAX_ENTRIES) {
+        return false;
+    }
+    if (dir->version == 1) {
+        *outEntries = (const ModelDirEntry*)(bankBase + MODEL_DIR_V1_HEADER);
+        *outGeneration = 0;
+    } else if (dir->version == MODEL_DIR_VERSION) {
+        *outEntries = (const ModelDirEntry*)(bankBase +
+                                             sizeof(ModelDirectory));
+        *outGeneration = dir->generation;
+    } else {
+        return false;
+    }
+    *outCount = dir->count;
+    return true;
+}
+
+const void* ModelStore::find(uint32_t id, uint16_t version,
+                             uint32_t* outSize) const {
+    if (base == NULL) {
+        return NULL;
+    }
+    const uint8_t* bankBase = base + (uint32_t)active * bankSize();
+
+    for (uint16_t i = 0; i < count; i++) {
+        const ModelDirEntry& e = entries[i];
+        if (e.id != id || e.version != version) {
+            continue;
+        }
+        // Bounds, then payload CRC — done at lookup so the cost lands
+        // once per consumer at boot, not per inference.
+        if (e.offset > bankSize() || e.size > bankSize() - e.offset) {
+            return NULL;
+        }
+        if (e.crc != crc32_le(0, bankBase + e.offset, e.size)) {
+            return NULL;
+        }
+        if (outSize != NULL) {
+            *outSize = e.size;
+        }
+        return bankBase + e.offset;
+    }
+
+    // Legacy shape: a single self-validating blob at offset 0, from
+    // before the directory format. Served only to its own consumer
+    // (the magic at offset 0 must match), which checks the CRC itself.
+    if (count == 0 && active == 0 && *(const uint32_t*)base == id) {
+        if (outSize != NULL) {
+            *outSize = 0;
+        }
+        return base;
+    }
+    return NULL;
+}
@@ -0,0 +1,90 @@
+#ifndef MODEL_STORE_H
+#define MODEL_STORE_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "../../include/config.h"
+
+// Serves quantized model blobs from the model partition without ever
+// copying them to RAM: the partition is memory-mapped once at begin()
+// and stays mapped for the firmware's lifetime, so a consumer holds a
+// plain pointer into cached flash and pays RAM only for activations.
+// Models deploy independently of the firmware image — an OTA doesn't
+// carry them and retraining doesn't reflash the app.
+//
+// The partition is split into MODEL_BANK_COUNT equal banks and the
+// store serves whichever bank holds the valid directory with the
+// highest generation. Updates (ml/ModelUpdater) land blockwise in the
+// other bank and win by writing generation + 1, so a torn transfer
+// leaves the active bank untouched and the switch itself is a single
+// validated directory comparison.
+//
+// Bank layout: a ModelDirectory at the bank base followed by the
+// payloads it points at, entry offsets relative to the bank. Each
+// entry is identified by a four-char magic, versioned, and CRC-guarded
+// individually, so one bad deployment can't poison the others. A
+// partition written before the formats existed (the bare
+// AnomalyBaseline blob at offset 0) is still served to the one
+// consumer that self-validates it; a v1 directory (no generation) is
+// read as generation 0.
+
+struct __attribute__((packed)) ModelDirEntry {
+    uint32_t id;       // model magic ("ANOM", "FALW", ...)
+    uint16_t version;
+    uint16_t reserved; // zeroed
+    uint32_t offset;   // payload start, from the bank base
+    uint32_t size;     // payload bytes
+    uint32_t crc;      // CRC-32 over the payload
+};
+
+struct __attribute__((packed)) ModelDirectory {
+    uint32_t magic;      // MODEL_DIR_MAGIC
+    uint16_t version;    // MODEL_DIR_VERSION
+    uint16_t count;      // entries following this header
+    uint32_t generation; // monotonic; highest valid bank serves (v2+)
+};
+
+class ModelStore {
+public:
+    ModelStore();
+
+    // Maps the partition and elects the active bank. Returns false
+    // when no partition is fitted; a blank or legacy partition still
+    // returns true with zero directory entries.
+    bool begin();
+
+    // Re-elects the active bank after an update committed. Consumers
+    // holding pointers from before must rebind through find() — the
+    // store only re-reads directories, it can't chase their pointers.
+    void reload();
+
+    // Looks up a directory entry by magic and exact version in the
+    // active bank. Bounds and CRC are checked here, so a non-NULL
+    // return is a validated payload in mapped flash, valid until the
+    // next reload(). outSize is 0 for a legacy bare blob (the caller
+    // self-validates those).
+    const void* find(uint32_t id, uint16_t version, uint32_t* outSize) const;
+
+    bool isReady() const { return base != NULL; }
+    uint16_t entryCount() const { return count; }
+    uint32_t bankSize() const { return partitionSize / MODEL_BANK_COUNT; }
+    uint8_t activeBank() const { return active; }
+    uint32_t activeGeneration() const { return generation; }
+
+private:
+    // Validates the directory at one bank; returns true with the
+    // entry table, count, and generation on success.
+    bool parseBank(uint8_t bank, const ModelDirEntry** outEntries,
+                   uint16_t* outCount, uint32_t* outGeneration) const;
+    void electBank();
+
+    const uint8_t* base;
+    spi_flash_mmap_handle_t handle;
+    uint32_t partitionSize;
+    const ModelDirEntry* entries;
+    uint16_t count;
+    uint8_t active;
+    uint32_t generation;
+};
+
+#endif // MODEL_STORE_H
@@ -0,0 +1,158 @@
+#include "ModelUpdater.h"
+#include <esp32/rom/crc.h>
+#include "ModelStore.h"
+#include "../storage/PartitionMap.h"
+#include "../system/FlashOpStats.h"
+
+ModelUpdater::ModelUpdater()
+    : store(NULL),
+      partition(NULL),
+      state(IDLE),
+      bankOffset(0),
+      totalSize(0),
+      expectedCrc(0),
+      received(0) {
+}
+
+bool ModelUpdater::begin(ModelStore* modelStore) {
+    store = modelStore;
+    partition = PartitionMap::find(PARTITION_LABEL_MODEL);
+    return partition != NULL && store != NULL && store->isReady();
+}
+
+uint32_t ModelUpdater::activeGeneration() const {
+    return store != NULL ? store->activeGeneration() : 0;
+}
+
+ModelUpdater::Status ModelUpdater::beginTransfer(uint32_t size,
+                                                 uint32_t crc) {
+    if (partition == NULL) {
+        return XFER_BAD_STATE;
+    }
+    if (state == ERASING) {
+        // The erase task is mid-flight; restarting under it would race
+        // the flash driver. The host retries after the erase settles.
+        return XFER_BUSY;
+    }
+    if (size == 0 || size > store->bankSize()) {
+        return XFER_BAD_RANGE;
+    }
+
+    // A stale RECEIVING transfer is simply abandoned — the bank gets
+    // re-erased for the new one.
+    bankOffset = ((store->activeBank() + 1) % MODEL_BANK_COUNT) *
+                 store->bankSize();
+    totalSize = size;
+    expectedCrc = crc;
+    received = 0;
+    state = ERASING;
+
+    // Block erase takes seconds at this size; like the benchmark and
+    // history sync, it runs on a one-shot task so the BLE task keeps
+    // serving commands.
+    BaseType_t ok = xTaskCreatePinnedToCore(eraseTask, "mdl_erase", 3072,
+                                            this, 1, NULL, 1);
+    if (ok != pdPASS) {
+        state = IDLE;
+        return XFER_FLASH_FAIL;
+    }
+    return XFER_OK;
+}
+
+void ModelUpdater::eraseTask(void* param) {
+    ModelUpdater* updater = (ModelUpdater*)param;
+    esp_err_t err;
+    {
+        FLASH_OP_SCOPE(FLASH_MODEL_ERASE);
+        err = esp_partition_erase_range(updater->partition,
+                                        updater->bankOffset,
+                                        updater->store->bankSize());
+    }
+    if (err == ESP_OK) {
+        updater->state = RECEIVING;
+        DEBUG_PRINTF("Model update: bank at 0x%x erased, expecting %u bytes\n",
+                     updater->bankOffset, updater->totalSize);
+    } else {
+        updater->state = IDLE;
+        DEBUG_PRINTF("Model update: erase failed (%d)\n", err);
+    }
+    vTaskDelete(NULL);
+}
+
+ModelUpdater::Status ModelUpdater::writeChunk(uint32_t offset,
+                                              const uint8_t* data,
+                                              uint16_t length) {
+    if (state == ERASING) {
+        return XFER_BUSY;
+    }
+    if (state != RECEIVING) {
+        return XFER_BAD_STATE;
+    }
+    if (length == 0 || offset > totalSize || length > totalSize - offset) {
+        return XFER_BAD_RANGE;
+    }
+    esp_err_t err;
+    {
+        FLASH_OP_SCOPE(FLASH_MODEL_WRITE);
+        err = esp_partition_write(partition, bankOffset + offset,
+                                  data, length);
+    }
+    if (err != ESP_OK) {
+        DEBUG_PRINTF("Model update: write at 0x%x failed (%d)\n",
+                     offset, err);
+        return XFER_FLASH_FAIL;
+    }
+    received += length;
+    return XFER_OK;
+}
+
+ModelUpdater::Status ModelUpdater::commit() {
+    if (state != RECEIVING) {
+        return state == ERASING ? XFER_BUSY : XFER_BAD_STATE;
+    }
+    state = IDLE;
+
+    // Whole-image CRC, read back through the flash driver rather than
+    // the store's mapping so we verify what actually landed.
+    uint8_t buf[256];
+    uint32_t crc = 0;
+    for (uint32_t done = 0; done < totalSize;) {
+        uint32_t span = totalSize - done;
+        if (span > sizeof(buf)) {
+            span = sizeof(buf);
+        }
+        if (esp_partition_read(partition, bankOffset + done, buf,
+                               span) != ESP_OK) {
+            return XFER_FLASH_FAIL;
+        }
+        crc = crc32_le(crc, buf, span);
+        done += span;
+    }
+    if (crc != expectedCrc) {
+        DEBUG_PRINTF("Model update: image CRC mismatch (got 0x%08x)\n", crc);
+        return XFER_BAD_CRC;
+    }
+
+    // The image must open with a v2 directory whose generation beats
+    // the active bank's, or the boot-time election would pick the old
+    // bank right back.
+    ModelDirectory dir;
+    if (totalSize < sizeof(dir) ||
+        esp_partition_read(partition, bankOffset, &dir,
+                           sizeof(dir)) != ESP_OK) {
+        return XFER_FLASH_FAIL;
+    }
+    if (dir.magic != MODEL_DIR_MAGIC || dir.version != MODEL_DIR_VERSION ||
+        dir.count > MODEL_DIR_MAX_ENTRIES ||
+        dir.generation <= store->activeGeneration()) {
+        DEBUG_PRINTLN("Model update: directory rejected");
+        return XFER_BAD_DIR;
+    }
+
+    // Classic ESP32 flushes both CPUs' caches around flash writes, so
+    // the store's mapping already sees the new bytes.
+    store->reload();
+    DEBUG_PRINTF("Model update: switched to bank gen %u (%u bytes)\n",
+                 store->activeGeneration(), totalSize);
+    return XFER_OK;
+}
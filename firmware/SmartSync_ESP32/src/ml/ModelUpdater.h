@@ -0,0 +1,83 @@
+#ifndef MODEL_UPDATER_H
+#define MODEL_UPDATER_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "../../include/config.h"
+
+class ModelStore;
+
+// Blockwise model deployment into the inactive bank of the model
+// partition. A full model refresh is a ~50 KB transfer instead of a
+// ~1.5 MB firmware OTA, and because the active bank is never written,
+// a torn or corrupt transfer costs nothing: the unit keeps serving
+// the models it had, and the half-written bank is simply erased by
+// the next attempt.
+//
+// Protocol (driven by the binary BLE commands in BLEService):
+//   BEGIN(totalSize, crc) — erases the inactive bank on a one-shot
+//     task (block erase takes seconds; the BLE task must not stall),
+//     then accepts chunks.
+//   DATA(offset, bytes)   — writes straight to flash at the bank
+//     offset; chunks may arrive in any order but must not overlap
+//     a previous write (NOR flash only clears bits).
+//   COMMIT               — reads the bank back, checks the whole-image
+//     CRC, validates the directory (v2, generation strictly above the
+//     active bank's), then switches the store to it.
+//
+// The image the host sends is a complete bank: a v2 ModelDirectory
+// stamped generation = active + 1, entries, payloads. Read the active
+// generation from the status frame after BEGIN.
+class ModelUpdater {
+public:
+    // Status values carried in ModelStatusFrame.status.
+    enum Status : uint8_t {
+        XFER_OK = 0,
+        XFER_BUSY = 1,       // erase still running, retry BEGIN later
+        XFER_BAD_STATE = 2,  // command outside the protocol order
+        XFER_BAD_RANGE = 3,  // size or offset outside the bank
+        XFER_BAD_CRC = 4,    // image CRC mismatch on commit
+        XFER_BAD_DIR = 5,    // directory invalid or generation stale
+        XFER_FLASH_FAIL = 6, // esp_partition op returned an error
+    };
+
+    ModelUpdater();
+
+    // Wires the store whose inactive bank receives transfers. Returns
+    // false (and stays inert) when the store has no partition.
+    bool begin(ModelStore* store);
+
+    // Starts a transfer: kicks the erase task and latches the expected
+    // size and CRC. A transfer already in flight is abandoned and
+    // restarted; XFER_BUSY only while the erase itself is running.
+    Status beginTransfer(uint32_t totalSize, uint32_t expectedCrc);
+
+    // One chunk, written through to flash at the given bank offset.
+    Status writeChunk(uint32_t offset, const uint8_t* data, uint16_t length);
+
+    // Verifies and switches. XFER_OK means the store now serves the
+    // new bank; anything else leaves the old bank active.
+    Status commit();
+
+    bool transferActive() const { return state != IDLE; }
+    uint32_t bytesReceived() const { return received; }
+
+    // The active bank's generation, reported in the status frame so
+    // the host knows what to beat.
+    uint32_t activeGeneration() const;
+
+private:
+    enum State : uint8_t { IDLE, ERASING, RECEIVING };
+
+    static void eraseTask(void* param);
+
+    ModelStore* store;
+    const esp_partition_t* partition;
+    volatile State state;
+    uint32_t bankOffset;   // inactive bank's base within the partition
+    uint32_t totalSize;
+    uint32_t expectedCrc;
+    uint32_t received;
+};
+
+#endif // MODEL_UPDATER_H
@@ -0,0 +1,118 @@
+#include "OccupancyBaseline.h"
+#include "../system/RtcClock.h"
+
+OccupancyBaseline::OccupancyBaseline()
+    : clock(NULL),
+      daysSeen(0),
+      trackedHour(-1),
+      hourMaxGapMs(0),
+      gapStartMs(0),
+      inGap(false),
+      publishedTimeoutMs(MOTION_TIMEOUT) {
+    memset(quietEwmaMs, 0, sizeof(quietEwmaMs));
+}
+
+void OccupancyBaseline::begin(RtcClock* rtc) {
+    clock = rtc;
+    prefs.begin(PREF_NAMESPACE, false);
+
+    Persisted image;
+    if (prefs.getBytes(PREF_OCC_BASELINE, &image,
+                       sizeof(image)) == sizeof(image) &&
+        image.version == OCC_BASELINE_VERSION) {
+        daysSeen = image.daysSeen;
+        memcpy(quietEwmaMs, image.quietEwmaMs, sizeof(quietEwmaMs));
+        DEBUG_PRINTF("Occupancy baseline: %u day(s) learned\n", daysSeen);
+    }
+}
+
+// EWMA fold of one finished hour. The first observation seeds the
+// slot directly so warmup isn't dragged down from zero.
+void OccupancyBaseline::foldHour(int8_t hour) {
+    uint32_t sample = hourMaxGapMs;
+    if (sample > OCC_BASELINE_TIMEOUT_MAX_MS) {
+        sample = OCC_BASELINE_TIMEOUT_MAX_MS; // an empty house isn't data
+    }
+    if (quietEwmaMs[hour] == 0) {
+        quietEwmaMs[hour] = sample;
+        return;
+    }
+    int32_t delta = (int32_t)sample - (int32_t)quietEwmaMs[hour];
+    quietEwmaMs[hour] =
+        (uint32_t)((int32_t)quietEwmaMs[hour] +
+                   (delta >> OCC_BASELINE_ALPHA_SHIFT));
+}
+
+uint32_t OccupancyBaseline::timeoutForHour(int8_t hour) const {
+    if (hour < 0 || daysSeen < OCC_BASELINE_MIN_DAYS ||
+        quietEwmaMs[hour] == 0) {
+        return MOTION_TIMEOUT;
+    }
+    uint32_t t = quietEwmaMs[hour] * OCC_BASELINE_MARGIN_NUM /
+                 OCC_BASELINE_MARGIN_DEN;
+    if (t < OCC_BASELINE_TIMEOUT_MIN_MS) {
+        t = OCC_BASELINE_TIMEOUT_MIN_MS;
+    }
+    if (t > OCC_BASELINE_TIMEOUT_MAX_MS) {
+        t = OCC_BASELINE_TIMEOUT_MAX_MS;
+    }
+    return t;
+}
+
+void OccupancyBaseline::save() {
+    Persisted image;
+    image.version = OCC_BASELINE_VERSION;
+    image.daysSeen = daysSeen;
+    image.reserved = 0;
+    memcpy(image.quietEwmaMs, quietEwmaMs, sizeof(quietEwmaMs));
+    prefs.putBytes(PREF_OCC_BASELINE, &image, sizeof(image));
+    DEBUG_PRINTF("Occupancy baseline saved (%u days)\n", daysSeen);
+}
+
+void OccupancyBaseline::feed(bool motion, uint32_t nowMs) {
+    int8_t hour = (clock != NULL && clock->isValid())
+        ? clock->hourOfDay() : -1;
+    if (hour < 0) {
+        // Nothing to attribute an hour slot to; keep the default out.
+        publishedTimeoutMs = MOTION_TIMEOUT;
+        return;
+    }
+
+    if (trackedHour < 0) {
+        trackedHour = hour;
+        hourMaxGapMs = 0;
+        inGap = !motion;
+        gapStartMs = nowMs;
+    }
+
+    // The running gap is credited continuously, so a spell spanning
+    // hour boundaries (or still open at fold time) counts in full
+    // against every hour it covers — exactly what the night slots need.
+    if (motion) {
+        inGap = false;
+    } else {
+        if (!inGap) {
+            inGap = true;
+            gapStartMs = nowMs;
+        }
+        uint32_t gap = nowMs - gapStartMs;
+        if (gap > hourMaxGapMs) {
+            hourMaxGapMs = gap;
+        }
+    }
+
+    if (hour != trackedHour) {
+        foldHour(trackedHour);
+        if (trackedHour == 23) {
+            // Day rolled: that's one more day learned, worth a commit.
+            if (daysSeen < 255) {
+                daysSeen++;
+            }
+            save();
+        }
+        trackedHour = hour;
+        hourMaxGapMs = inGap ? nowMs - gapStartMs : 0;
+    }
+
+    publishedTimeoutMs = timeoutForHour(hour);
+}
@@ -0,0 +1,68 @@
+#ifndef OCCUPANCY_BASELINE_H
+#define OCCUPANCY_BASELINE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "../../include/config.h"
+
+class RtcClock;
+
+// Learned quiet-time baseline for the motion-timeout alert. A fixed
+// MOTION_TIMEOUT misfires both ways: five motionless minutes are
+// normal mid-afternoon nap territory and alarming at 3 AM. The
+// baseline keeps, per hour of day, an EWMA of the longest motionless
+// gap it has seen in that hour — constant memory, 24 slots of running
+// aggregates — and the timeout check compares against a margin over
+// that instead of the static constant. Hours the home hasn't taught
+// yet (or a clock that never synced) fall back to MOTION_TIMEOUT.
+//
+// Fed from the ML task once per sensor cycle; the published
+// current-hour timeout is a single aligned word, so the sensor task
+// reads it lock-free. The aggregate table persists to NVS once per
+// day — 365 small commits a year is noise against the settings blob.
+class OccupancyBaseline {
+public:
+    OccupancyBaseline();
+
+    // Loads the persisted table (if any) and wires the clock.
+    void begin(RtcClock* clock);
+
+    // One call per sensor cycle from the ML task: extends or closes
+    // the running quiet gap, folds finished hours into their slots,
+    // and republishes the active timeout.
+    void feed(bool motion, uint32_t nowMs);
+
+    // Timeout the motion-timeout check should apply right now.
+    // Lock-free; callable from any task.
+    uint32_t activeTimeoutMs() const { return publishedTimeoutMs; }
+
+    uint8_t daysLearned() const { return daysSeen; }
+
+private:
+    // NVS image: versioned so a layout change reads as "start over".
+    struct __attribute__((packed)) Persisted {
+        uint8_t version;     // OCC_BASELINE_VERSION
+        uint8_t daysSeen;
+        uint16_t reserved;
+        uint32_t quietEwmaMs[24];
+    };
+
+    uint32_t timeoutForHour(int8_t hour) const;
+    void foldHour(int8_t hour);
+    void save();
+
+    RtcClock* clock;
+    Preferences prefs;
+
+    uint32_t quietEwmaMs[24]; // longest quiet gap per hour-of-day, EWMA
+    uint8_t daysSeen;         // saturating; gates the learned threshold
+
+    int8_t trackedHour;       // hour being accumulated, -1 before sync
+    uint32_t hourMaxGapMs;    // longest gap observed this hour so far
+    uint32_t gapStartMs;      // start of the running motionless gap
+    bool inGap;
+
+    volatile uint32_t publishedTimeoutMs;
+};
+
+#endif // OCCUPANCY_BASELINE_H
@@ -0,0 +1,268 @@
+#include "CloudUplink.h"
+
+#if WIFI_UPLINK_ENABLED
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <HTTPClient.h>
+#include <esp_heap_caps.h>
+#include "../ble/HistoryEncoder.h"
+#include "../storage/HistoryLog.h"
+#include "../system/RtcClock.h"
+#include "LzssCodec.h"
+#endif
+
+CloudUplink::CloudUplink()
+    : historyLog(NULL),
+      rtcClock(NULL),
+      body(NULL),
+      cbody(NULL),
+      lastAckedSeq(0),
+      sent(0),
+      failures(0),
+      rawBytes(0),
+      wireBytes(0) {
+}
+
+#if WIFI_UPLINK_ENABLED
+
+void CloudUplink::begin(HistoryLog* log, RtcClock* clock) {
+    historyLog = log;
+    rtcClock = clock;
+    if (historyLog == NULL || strlen(WIFI_UPLINK_SSID) == 0) {
+        return;
+    }
+
+    body = (uint8_t*)heap_caps_malloc(UPLINK_BODY_BYTES, MALLOC_CAP_SPIRAM);
+    if (body == NULL) {
+        body = (uint8_t*)malloc(UPLINK_BODY_BYTES);
+    }
+    if (body == NULL) {
+        DEBUG_PRINTLN("Uplink disabled: no batch buffer");
+        return;
+    }
+    // LZSS output stage; same size, since a batch that compresses to
+    // no smaller than itself ships raw.
+    cbody = (uint8_t*)heap_caps_malloc(UPLINK_BODY_BYTES, MALLOC_CAP_SPIRAM);
+    if (cbody == NULL) {
+        cbody = (uint8_t*)malloc(UPLINK_BODY_BYTES);
+    }
+
+    prefs.begin(PREF_NAMESPACE, false);
+    lastAckedSeq = prefs.getUInt(PREF_UPLINK_SEQ, 0);
+
+    xTaskCreatePinnedToCore(taskThunk, "uplink", UPLINK_TASK_STACK, this,
+                            UPLINK_TASK_PRIORITY, NULL, UPLINK_TASK_CORE);
+    DEBUG_PRINTF("Uplink armed: resume from seq %u\n", lastAckedSeq);
+}
+
+void CloudUplink::taskThunk(void* arg) {
+    static_cast<CloudUplink*>(arg)->taskLoop();
+}
+
+void CloudUplink::taskLoop() {
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(UPLINK_INTERVAL_MS));
+
+        // Nothing new since the last acknowledged batch: stay off the
+        // air entirely.
+        if (historyLog->nextSequence() <= lastAckedSeq + 1) {
+            continue;
+        }
+
+        uploadPending();
+
+        // The radio never stays up between windows.
+        WiFi.disconnect(true);
+        WiFi.mode(WIFI_OFF);
+    }
+}
+
+// Pinned TLS anchor for UPLINK_URL: GTS Root R1, the Google Trust
+// Services root that cloudfunctions.net chains to (expires
+// 2036-06-22). Pinning the root rather than the leaf survives
+// Google's routine leaf and intermediate rotation; a root rotation
+// ships as a firmware update, with OTA in place well before then.
+static const char UPLINK_ROOT_CA[] =
+    "-----BEGIN CERTIFICATE-----\n"
+    "MIIFVzCCAz+gAwIBAgINAgPlk28xsBNJiGuiFzANBgkqhkiG9w0BAQwFADBHMQsw\n"
+    "CQYDVQQGEwJVUzEiMCAGA1UEChMZR29vZ2xlIFRydXN0IFNlcnZpY2VzIExMQzEU\n"
+    "MBIGA1UEAxMLR1RTIFJvb3QgUjEwHhcNMTYwNjIyMDAwMDAwWhcNMzYwNjIyMDAw\n"
+    "MDAwWjBHMQswCQYDVQQGEwJVUzEiMCAGA1UEChMZR29vZ2xlIFRydXN0IFNlcnZp\n"
+    "Y2VzIExMQzEUMBIGA1UEAxMLR1RTIFJvb3QgUjEwggIiMA0GCSqGSIb3DQEBAQUA\n"
+    "A4ICDwAwggIKAoICAQC2EQKLHuOhd5s73L+UPreVp0A8of2C+X0yBoJx9vaMf/vo\n"
+    "27xqLpeXo4xL+Sv2sfnOhB2x+cWX3u+58qPpvBKJXqeqUqv4IyfLpLGcY9vXmX7w\n"
+    "Cl7raKb0xlpHDU0QM+NOsROjyBhsS+z8CZDfnWQpJSMHobTSPS5g4M/SCYe7zUjw\n"
+    "TcLCeoiKu7rPWRnWr4+wB7CeMfGCwcDfLqZtbBkOtdh+JhpFAz2weaSUKK0Pfybl\n"
+    "qAj+lug8aJRT7oM6iCsVlgmy4HqMLnXWnOunVmSPlk9orj2XwoSPwLxAwAtcvfaH\n"
+    "szVsrBhQf4TgTM2S0yDpM7xSma8ytSmzJSq0SPly4cpk9+aCEI3oncKKiPo4Zor8\n"
+    "Y/kB+Xj9e1x3+naH+uzfsQ55lVe0vSbv1gHR6xYKu44LtcXFilWr06zqkUspzBmk\n"
+    "MiVOKvFlRNACzqrOSbTqn3yDsEB750Orp2yjj32JgfpMpf/VjsPOS+C12LOORc92\n"
+    "wO1AK/1TD7Cn1TsNsYqiA94xrcx36m97PtbfkSIS5r762DL8EGMUUXLeXdYWk70p\n"
+    "aDPvOmbsB4om3xPXV2V4J95eSRQAogB/mqghtqmxlbCluQ0WEdrHbEg8QOB+DVrN\n"
+    "VjzRlwW5y0vtOUucxD/SVRNuJLDWcfr0wbrM7Rv1/oFB2ACYPTrIrnqYNxgFlQID\n"
+    "AQABo0IwQDAOBgNVHQ8BAf8EBAMCAYYwDwYDVR0TAQH/BAUwAwEB/zAdBgNVHQ4E\n"
+    "FgQU5K8rJnEaK0gnhS9SZizv8IkTcT4wDQYJKoZIhvcNAQEMBQADggIBAJ+qQibb\n"
+    "C5u+/x6Wki4+omVKapi6Ist9wTrYggoGxval3sBOh2Z5ofmmWJyq+bXmYOfg6LEe\n"
+    "QkEzCzc9zolwFcq1JKjPa7XSQCGYzyI0zzvFIoTgxQ6KfF2I5DUkzps+GlQebtuy\n"
+    "h6f88/qBVRRiClmpIgUxPoLW7ttXNLwzldMXG+gnoot7TiYaelpkttGsN/H9oPM4\n"
+    "7HLwEXWdyzRSjeZ2axfG34arJ45JK3VmgRAhpuo+9K4l/3wV3s6MJT/KYnAK9y8J\n"
+    "ZgfIPxz88NtFMN9iiMG1D53Dn0reWVlHxYciNuaCp+0KueIHoI17eko8cdLiA6Ef\n"
+    "MgfdG+RCzgwARWGAtQsgWSl4vflVy2PFPEz0tv/bal8xa5meLMFrUKTX5hgUvYU/\n"
+    "Z6tGn6D/Qqc6f1zLXbBwHSs09dR2CQzreExZBfMzQsNhFRAbd03OIozUhfJFfbdT\n"
+    "6u9AWpQKXCBfTkBdYiJ23//OYb2MI3jSNwLgjt7RETeJ9r/tSQdirpLsQBqvFAnZ\n"
+    "0E6yove+7u7Y/9waLd64NnHi/Hm3lCXRSHNboTXns5lndcEZOitHTtNCjv0xyBZm\n"
+    "2tIMPNuzjsmhDYAPexZ3FL//2wmUspO8IFgV6dtxQ/PeEMMA3KgqlbbC1j+Qa3bb\n"
+    "bP6MvPJwNQzcmRk13NfIRmPVNnGuV/u3gm3c\n"
+    "-----END CERTIFICATE-----\n";
+
+void CloudUplink::uploadPending() {
+    if (!connectWifi()) {
+        failures++;
+        return;
+    }
+
+    // One TLS connection for the whole window: the handshake is the
+    // expensive part, so keep-alive reuses the session for every
+    // batch the backlog needs before the radio drops.
+    WiFiClientSecure client;
+    client.setCACert(UPLINK_ROOT_CA);
+    HTTPClient http;
+    http.setReuse(true);
+    if (!http.begin(client, UPLINK_URL)) {
+        failures++;
+        return;
+    }
+
+    for (uint32_t i = 0; i < UPLINK_MAX_BATCHES_PER_WAKE; i++) {
+        if (historyLog->nextSequence() <= lastAckedSeq + 1) {
+            break; // caught up
+        }
+        if (uploadBatch(&http)) {
+            sent++;
+        } else {
+            // The records stay in the log; the next window resumes
+            // from the same sequence.
+            failures++;
+            break;
+        }
+    }
+    http.end();
+}
+
+bool CloudUplink::connectWifi() {
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(WIFI_UPLINK_SSID, WIFI_UPLINK_PASSWORD);
+
+    uint32_t start = millis();
+    while (WiFi.status() != WL_CONNECTED) {
+        if (millis() - start > UPLINK_CONNECT_TIMEOUT_MS) {
+            DEBUG_PRINTLN("Uplink: WiFi connect timeout");
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    return true;
+}
+
+bool CloudUplink::uploadBatch(void* httpArg) {
+    HTTPClient& http = *(HTTPClient*)httpArg;
+
+    // Encode from the resume point in BLE history-chunk format, as
+    // many full chunks as the body holds (or the batch cap allows).
+    HistoryEncoder encoder;
+    HistoryLog::Cursor cursor = historyLog->cursorFromSeq(lastAckedSeq + 1);
+    HistoryRecord record;
+    uint32_t bodyLen = 0;
+    uint32_t records = 0;
+    uint32_t highestSeq = lastAckedSeq;
+    bool pending = false;
+
+    while (records < UPLINK_BATCH_RECORDS &&
+           UPLINK_BODY_BYTES - bodyLen > 64) {
+        encoder.beginChunk(body + bodyLen,
+                           (uint16_t)(UPLINK_BODY_BYTES - bodyLen));
+        if (pending) {
+            encoder.addRecord(record);
+            pending = false;
+        }
+        while (records + encoder.recordCount() < UPLINK_BATCH_RECORDS &&
+               historyLog->readNext(cursor, record)) {
+            if (!encoder.addRecord(record)) {
+                pending = true;
+                break;
+            }
+            highestSeq = record.sequence;
+        }
+        if (pending) {
+            highestSeq = record.sequence;
+        }
+        uint16_t len = encoder.finishChunk();
+        if (encoder.recordCount() == 0) {
+            break;
+        }
+        records += encoder.recordCount();
+        bodyLen += len;
+    }
+    if (records == 0) {
+        return true; // nothing to send is not a failure
+    }
+
+    // Compression stage: LZSS over the whole batch body. Adjacent
+    // chunks still repeat structure the per-record delta coding can't
+    // see; a batch that doesn't shrink ships raw, flagged by the
+    // absent Content-Encoding.
+    uint8_t* payload = body;
+    uint32_t payloadLen = bodyLen;
+    if (cbody != NULL) {
+        size_t clen = lzssCompress(body, bodyLen, cbody, bodyLen - 1);
+        if (clen > 0) {
+            payload = cbody;
+            payloadLen = (uint32_t)clen;
+        }
+    }
+    rawBytes += bodyLen;
+    wireBytes += payloadLen;
+
+    // The connection (and its TLS session) belongs to the caller and
+    // is reused across batches; the payload itself is integrity-
+    // checked per-record server-side.
+    http.addHeader("Content-Type", "application/octet-stream");
+    if (payload == cbody) {
+        http.addHeader("Content-Encoding", "x-lzss");
+        http.addHeader("X-Orig-Length", String(bodyLen));
+    }
+    http.addHeader("X-Device-Id", String((uint32_t)ESP.getEfuseMac(), HEX));
+    // Epoch seconds at millis() == 0 (SNTP-disciplined): one offset
+    // that converts every record's timestampMs to real wall time, so
+    // the backend can correlate history across devices. 0 = unsynced.
+    if (rtcClock != NULL) {
+        http.addHeader("X-Boot-Epoch", String(rtcClock->epochAtBoot()));
+    }
+    int status = http.POST(payload, payloadLen);
+    // No http.end() here: with setReuse the connection stays up for
+    // the next batch; the window closes it once.
+
+    if (status < 200 || status >= 300) {
+        DEBUG_PRINTF("Uplink: HTTP %d\n", status);
+        return false;
+    }
+
+    // Acknowledge only after the 2xx: a failed POST re-sends the same
+    // records, and the backend dedupes on sequence.
+    lastAckedSeq = highestSeq;
+    prefs.putUInt(PREF_UPLINK_SEQ, lastAckedSeq);
+    DEBUG_PRINTF("Uplink: %u records, %u -> %u bytes (through seq %u)\n",
+                 records, bodyLen, payloadLen, lastAckedSeq);
+    return true;
+}
+
+#else // !WIFI_UPLINK_ENABLED
+
+// BLE-only build: the class stays linkable so main.cpp needs no
+// conditionals, but nothing runs and no task exists.
+void CloudUplink::begin(HistoryLog* log, RtcClock* clock) {
+    historyLog = log;
+    rtcClock = clock;
+}
+
+#endif // WIFI_UPLINK_ENABLED
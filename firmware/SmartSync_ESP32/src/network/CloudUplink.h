@@ -0,0 +1,69 @@
+#ifndef CLOUD_UPLINK_H
+#define CLOUD_UPLINK_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "../../include/config.h"
+
+class HistoryLog;
+class RtcClock;
+
+// Optional WiFi path to the Firebase backend. Without it, cloud data
+// exists only while the phone app is in range relaying BLE frames —
+// and the app burns battery doing it. The uplink task wakes on a slow
+// cadence, brings WiFi up, POSTs one batch of history records as a
+// single compressed body over a single TLS connection, and takes the
+// radio back down; between batches the device is BLE-only, so the
+// coexistence cost is bounded to a few seconds per interval.
+//
+// Store-and-forward rides the history partition itself: the last
+// acknowledged sequence persists in NVS, and each batch resumes from
+// there, so an outage of hours or days costs nothing — the records
+// were being logged anyway and upload when connectivity returns. The
+// body is the same delta-varint chunk stream the BLE history sync
+// notifies, so the backend decodes one format.
+//
+// The TLS handshake is the expensive part (seconds of CPU-bound
+// crypto), so each radio-on window opens ONE connection and reuses it
+// with keep-alive for every batch the backlog needs — steady state is
+// one handshake per interval, and catch-up after an outage amortizes
+// it across up to UPLINK_MAX_BATCHES_PER_WAKE POSTs.
+//
+// Compiled in only with WIFI_UPLINK_ENABLED; the BLE-only build pays
+// no flash or RAM for it.
+class CloudUplink {
+public:
+    CloudUplink();
+
+    // Wires the log and clock and spawns the uplink task when enabled
+    // and credentials are configured; a no-op otherwise.
+    void begin(HistoryLog* log, RtcClock* clock);
+
+    uint32_t batchesSent() const { return sent; }
+    uint32_t batchesFailed() const { return failures; }
+
+    // Compression-ratio counters: payload bytes before and after the
+    // LZSS stage, cumulative. Ratio = raw / wire.
+    uint32_t rawBytesSent() const { return rawBytes; }
+    uint32_t wireBytesSent() const { return wireBytes; }
+
+private:
+    static void taskThunk(void* arg);
+    void taskLoop();
+    void uploadPending();
+    bool uploadBatch(void* http); // HTTPClient*, kept out of this header
+    bool connectWifi();
+
+    HistoryLog* historyLog;
+    RtcClock* rtcClock;
+    Preferences prefs;
+    uint8_t* body;          // UPLINK_BODY_BYTES, PSRAM
+    uint8_t* cbody;         // LZSS output, same size, PSRAM
+    uint32_t lastAckedSeq;  // persisted; resume point across outages
+    uint32_t sent;
+    uint32_t failures;
+    uint32_t rawBytes;
+    uint32_t wireBytes;
+};
+
+#endif // CLOUD_UPLINK_H
@@ -0,0 +1,272 @@
+#include "DeltaOta.h"
+
+#if OTA_DELTA_ENABLED
+#include <WiFi.h>
+#include <esp_http_server.h>
+#include <esp_ota_ops.h>
+#include <esp32/rom/crc.h>
+#include "../system/OtaPacer.h"
+#endif
+
+DeltaOta* DeltaOta::instance = NULL;
+
+DeltaOta::DeltaOta()
+    : server(NULL) {
+}
+
+#if OTA_DELTA_ENABLED
+
+struct __attribute__((packed)) PatchHeader {
+    uint32_t magic;      // OTA_PATCH_MAGIC
+    uint32_t targetSize; // rebuilt image size
+    uint32_t targetCrc;  // crc32 of the rebuilt image
+    uint32_t baseLen;    // bytes of the running image the patch assumes
+    uint32_t baseCrc;    // crc32 over those bytes
+};
+
+enum PatchOp : uint8_t {
+    OP_COPY = 0x00, // {srcOffset u32, len u16} from the running image
+    OP_DATA = 0x01, // {len u16, literal bytes}
+};
+
+// Pulls exactly len bytes from the request body; httpd_req_recv
+// returns short reads at TCP segment boundaries.
+static bool recvExact(httpd_req_t* req, uint8_t* out, size_t len) {
+    size_t got = 0;
+    while (got < len) {
+        int r = httpd_req_recv(req, (char*)(out + got), len - got);
+        if (r <= 0) {
+            return false;
+        }
+        got += r;
+    }
+    return true;
+}
+
+void DeltaOta::begin() {
+    if (strlen(WIFI_UPLINK_SSID) == 0) {
+        return;
+    }
+    instance = this;
+    xTaskCreatePinnedToCore(startTaskThunk, "ota_start", 3072, this, 1,
+                            NULL, 1);
+}
+
+void DeltaOta::startTaskThunk(void* arg) {
+    static_cast<DeltaOta*>(arg)->startTask();
+    vTaskDelete(NULL);
+}
+
+void DeltaOta::startTask() {
+    // Another WiFi feature may already own the association; only join
+    // ourselves if nobody has.
+    if (WiFi.getMode() == WIFI_OFF || WiFi.getMode() == WIFI_MODE_NULL) {
+        WiFi.mode(WIFI_STA);
+        WiFi.begin(WIFI_UPLINK_SSID, WIFI_UPLINK_PASSWORD);
+    }
+    while (WiFi.status() != WL_CONNECTED) {
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = OTA_HTTP_PORT;
+    config.ctrl_port = OTA_HTTP_PORT + 10000; // distinct from other instances
+    config.max_open_sockets = 2;
+    // The apply path runs on this task: base verify + flash writes.
+    config.stack_size = 6144;
+
+    httpd_handle_t handle = NULL;
+    if (httpd_start(&handle, &config) != ESP_OK) {
+        DEBUG_PRINTLN("OTA: httpd start failed");
+        return;
+    }
+
+    httpd_uri_t version = {};
+    version.uri = "/version";
+    version.method = HTTP_GET;
+    version.handler = versionHandler;
+    httpd_register_uri_handler(handle, &version);
+
+    httpd_uri_t patch = {};
+    patch.uri = "/patch";
+    patch.method = HTTP_POST;
+    patch.handler = patchHandlerThunk;
+    httpd_register_uri_handler(handle, &patch);
+
+    server = handle;
+    DEBUG_PRINTF("OTA: delta endpoint on :%d\n", OTA_HTTP_PORT);
+}
+
+// Tooling reads this to pick the patch base.
+esp_err_t DeltaOta::versionHandler(struct httpd_req* req) {
+    httpd_resp_set_type(req, "text/plain");
+    return httpd_resp_sendstr(req, FIRMWARE_VERSION);
+}
+
+esp_err_t DeltaOta::patchHandlerThunk(struct httpd_req* req) {
+    return instance->patchHandler(req);
+}
+
+esp_err_t DeltaOta::patchHandler(struct httpd_req* req) {
+    char key[32] = {0};
+    if (httpd_req_get_hdr_value_str(req, "X-Ota-Key", key, sizeof(key))
+            != ESP_OK ||
+        strcmp(key, OTA_DELTA_KEY) != 0) {
+        httpd_resp_set_status(req, "403 Forbidden");
+        return httpd_resp_sendstr(req, "bad key");
+    }
+
+    if (applyPatch(req, req->content_len)) {
+        httpd_resp_sendstr(req, "ok, rebooting");
+        DEBUG_PRINTLN("OTA: patch applied, rebooting");
+        vTaskDelay(pdMS_TO_TICKS(250)); // let the response flush
+        esp_restart();
+        return ESP_OK; // not reached
+    }
+    httpd_resp_set_status(req, "400 Bad Request");
+    return httpd_resp_sendstr(req, "patch rejected");
+}
+
+bool DeltaOta::applyPatch(struct httpd_req* req, size_t contentLen) {
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    const esp_partition_t* target = esp_ota_get_next_update_partition(NULL);
+    if (running == NULL || target == NULL || contentLen < sizeof(PatchHeader)) {
+        return false;
+    }
+
+    PatchHeader hdr;
+    if (!recvExact(req, (uint8_t*)&hdr, sizeof(hdr))) {
+        return false;
+    }
+    size_t remaining = contentLen - sizeof(PatchHeader);
+    if (hdr.magic != OTA_PATCH_MAGIC || hdr.targetSize > target->size ||
+        hdr.baseLen > running->size) {
+        return false;
+    }
+
+    // Refuse a patch built against a different base BEFORE touching
+    // flash — a mismatched copy source would brick the slot silently.
+    uint8_t window[256];
+    uint32_t crc = 0;
+    for (uint32_t off = 0; off < hdr.baseLen;) {
+        uint32_t chunk = hdr.baseLen - off;
+        if (chunk > sizeof(window)) {
+            chunk = sizeof(window);
+        }
+        if (esp_partition_read(running, off, window, chunk) != ESP_OK) {
+            return false;
+        }
+        crc = crc32_le(crc, window, chunk);
+        off += chunk;
+    }
+    if (crc != hdr.baseCrc) {
+        DEBUG_PRINTLN("OTA: base mismatch, refusing patch");
+        return false;
+    }
+
+    esp_ota_handle_t ota;
+    if (esp_ota_begin(target, hdr.targetSize, &ota) != ESP_OK) {
+        return false;
+    }
+
+    uint8_t* buf = (uint8_t*)malloc(1024);
+    if (buf == NULL) {
+        esp_ota_abort(ota);
+        return false;
+    }
+
+    uint32_t written = 0;
+    crc = 0;
+    bool ok = true;
+    while (ok && remaining > 0) {
+        // Background pacing per command: holds through emergencies,
+        // spaces the flash writes otherwise. The HTTP client just
+        // sees a slow server; TCP flow control does the rest.
+        OtaPacer::yieldPoint();
+
+        uint8_t op;
+        uint8_t args[6];
+        if (!recvExact(req, &op, 1)) {
+            ok = false;
+            break;
+        }
+        remaining--;
+
+        if (op == OP_COPY) {
+            if (remaining < 6 || !recvExact(req, args, 6)) {
+                ok = false;
+                break;
+            }
+            remaining -= 6;
+            uint32_t srcOff;
+            uint16_t len;
+            memcpy(&srcOff, args, 4);
+            memcpy(&len, args + 4, 2);
+            if ((uint64_t)srcOff + len > running->size) {
+                ok = false;
+                break;
+            }
+            for (uint32_t i = 0; ok && i < len;) {
+                uint32_t chunk = len - i;
+                if (chunk > sizeof(window)) {
+                    chunk = sizeof(window);
+                }
+                ok = esp_partition_read(running, srcOff + i, window, chunk)
+                         == ESP_OK &&
+                     esp_ota_write(ota, window, chunk) == ESP_OK;
+                crc = crc32_le(crc, window, chunk);
+                written += chunk;
+                i += chunk;
+            }
+        } else if (op == OP_DATA) {
+            if (remaining < 2 || !recvExact(req, args, 2)) {
+                ok = false;
+                break;
+            }
+            remaining -= 2;
+            uint16_t len;
+            memcpy(&len, args, 2);
+            if (len > remaining) {
+                ok = false;
+                break;
+            }
+            for (uint32_t i = 0; ok && i < len;) {
+                uint32_t chunk = len - i;
+                if (chunk > 1024) {
+                    chunk = 1024;
+                }
+                ok = recvExact(req, buf, chunk) &&
+                     esp_ota_write(ota, buf, chunk) == ESP_OK;
+                crc = crc32_le(crc, buf, chunk);
+                written += chunk;
+                remaining -= chunk;
+                i += chunk;
+            }
+        } else {
+            ok = false;
+        }
+    }
+    free(buf);
+
+    if (!ok || written != hdr.targetSize || crc != hdr.targetCrc) {
+        DEBUG_PRINTF("OTA: rebuild failed (%u/%u bytes)\n", written,
+                     hdr.targetSize);
+        esp_ota_abort(ota);
+        return false;
+    }
+    // esp_ota_end validates the image header; set_boot flips the slot
+    // only after that passes, so a bad patch can't take the next boot.
+    if (esp_ota_end(ota) != ESP_OK ||
+        esp_ota_set_boot_partition(target) != ESP_OK) {
+        return false;
+    }
+    return true;
+}
+
+#else // !OTA_DELTA_ENABLED
+
+// BLE-only build: linkable no-op so main.cpp needs no conditionals.
+void DeltaOta::begin() {
+}
+
+#endif // OTA_DELTA_ENABLED
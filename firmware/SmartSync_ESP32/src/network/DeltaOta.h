@@ -0,0 +1,51 @@
+#ifndef DELTA_OTA_H
+#define DELTA_OTA_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+struct httpd_req; // esp_http_server request, kept out of this header
+
+// Delta firmware updates over HTTP. A full image push at home-WiFi
+// speeds takes minutes per unit and hours per fleet; the patch format
+// here rebuilds the new image mostly from ranges of the image already
+// running — the device is its own dictionary — so a typical release
+// ships as tens of KB of patch instead of 1.4 MB.
+//
+// Patch layout (builder in scripts/deployment): a 20-byte header
+//   {magic u32, targetSize u32, targetCrc u32, baseLen u32, baseCrc u32}
+// followed by a command stream:
+//   0x00 COPY  {srcOffset u32, len u16}  bytes from the running image
+//   0x01 DATA  {len u16, literal bytes}  new bytes
+// The device verifies baseCrc over baseLen bytes of the running
+// partition before touching flash (a patch built against the wrong
+// base is refused, not half-applied), streams the rebuild into the
+// inactive OTA slot through esp_ota, checks targetCrc, flips the boot
+// partition, and reboots. RAM cost is one 1 KB receive buffer and a
+// 256-byte copy window, independent of image size.
+//
+// POSTs must carry X-Ota-Key matching OTA_DELTA_KEY — the same shared
+// secret the espota channel uses. GET /version reports the running
+// firmware version so tooling picks the right patch.
+class DeltaOta {
+public:
+    DeltaOta();
+
+    // Spawns a one-shot task that waits for WiFi (joining it if no
+    // other feature has) and starts the endpoint; a no-op otherwise.
+    void begin();
+
+private:
+    static void startTaskThunk(void* arg);
+    void startTask();
+    static esp_err_t versionHandler(struct httpd_req* req);
+    static esp_err_t patchHandlerThunk(struct httpd_req* req);
+    esp_err_t patchHandler(struct httpd_req* req);
+    bool applyPatch(struct httpd_req* req, size_t contentLen);
+
+    void* server; // httpd_handle_t, opaque here
+
+    static DeltaOta* instance; // httpd handlers are C functions
+};
+
+#endif // DELTA_OTA_H
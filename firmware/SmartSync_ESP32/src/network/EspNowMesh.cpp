@@ -0,0 +1,402 @@
+#include "EspNowMesh.h"
+#include "../system/MonoClock.h"
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+
+static const uint8_t BROADCAST_MAC[6] = {0xFF, 0xFF, 0xFF,
+                                         0xFF, 0xFF, 0xFF};
+
+EspNowMesh* EspNowMesh::instance = NULL;
+
+EspNowMesh::EspNowMesh()
+    : initialized(false),
+      lastSendMs(0),
+      alarmSeq(0),
+      commandSink(NULL),
+      alarmSink(NULL),
+      beaconOffsetMs(0),
+      lastBeaconMs(0),
+      beaconSlotCount(0),
+      beaconSlotMs(0),
+      lock(portMUX_INITIALIZER_UNLOCKED) {
+    memset(ownMac, 0, sizeof(ownMac));
+    memset(peers, 0, sizeof(peers));
+}
+
+void EspNowMesh::begin() {
+#if ESPNOW_MESH_ENABLED
+    // STA mode without association: ESP-NOW only needs the radio up
+    // on a known channel. The uplink (when also enabled) reconnects
+    // through this same interface without conflict.
+    WiFi.mode(WIFI_STA);
+    esp_wifi_set_channel(ESPNOW_CHANNEL, WIFI_SECOND_CHAN_NONE);
+
+    if (esp_now_init() != ESP_OK) {
+        DEBUG_PRINTLN("Mesh: esp_now_init failed");
+        return;
+    }
+
+    esp_now_peer_info_t broadcast;
+    memset(&broadcast, 0, sizeof(broadcast));
+    memcpy(broadcast.peer_addr, BROADCAST_MAC, 6);
+    broadcast.channel = ESPNOW_CHANNEL;
+    broadcast.encrypt = false;
+    if (esp_now_add_peer(&broadcast) != ESP_OK) {
+        DEBUG_PRINTLN("Mesh: broadcast peer add failed");
+        return;
+    }
+
+    esp_wifi_get_mac(WIFI_IF_STA, ownMac);
+    instance = this;
+    esp_now_register_recv_cb(recvThunk);
+    initialized = true;
+    DEBUG_PRINTF("Mesh up on channel %d%s\n", ESPNOW_CHANNEL,
+                 ESPNOW_BEACON_MASTER ? " (beacon master)" : "");
+#endif
+}
+
+void EspNowMesh::sendSnapshot(float temperature, float humidity,
+                              bool motion, uint8_t occupancy,
+                              uint8_t fanSpeed, uint8_t ledBrightness) {
+    if (!initialized) {
+        return;
+    }
+    // The aggregation unit beacons its clock on every pass (each
+    // SENSOR_READ_INTERVAL) — often enough that crystal drift between
+    // beacons stays well under a millisecond.
+    if (ESPNOW_BEACON_MASTER) {
+        sendBeacon();
+    }
+    uint32_t now = millis();
+    if (lastSendMs != 0 && now - lastSendMs < ESPNOW_SEND_INTERVAL_MS) {
+        return;
+    }
+    lastSendMs = now;
+
+    MeshFrame frame;
+    frame.magic = ESPNOW_FRAME_MAGIC;
+    frame.version = ESPNOW_FRAME_VERSION;
+    frame.motion = motion ? 1 : 0;
+    frame.occupancy = occupancy;
+    frame.temperature = (int16_t)(temperature * 100.0f);
+    frame.humidity = (uint16_t)(humidity * 100.0f);
+    frame.fanSpeed = fanSpeed;
+    frame.ledBrightness = ledBrightness;
+    frame.reserved = 0;
+    frame.uptimeMs = now;
+
+    // Fire and forget: the next send is 30 s away and the peer table
+    // tolerates loss by design (staleness, not acks).
+    esp_now_send(BROADCAST_MAC, (const uint8_t*)&frame, sizeof(frame));
+}
+
+void EspNowMesh::sendBeacon() {
+    BeaconFrame beacon;
+    beacon.magic = ESPNOW_BEACON_MAGIC;
+    beacon.version = ESPNOW_FRAME_VERSION;
+    beacon.slotCount = ESPNOW_SLOT_COUNT;
+    beacon.reserved = 0;
+    beacon.slotMs = ESPNOW_SLOT_MS;
+    beacon.reserved2 = 0;
+    beacon.masterMs = millis();
+    esp_now_send(BROADCAST_MAC, (const uint8_t*)&beacon, sizeof(beacon));
+    // The master schedules against its own clock; a self-beacon keeps
+    // the slot math identical on every unit.
+    handleBeacon(beacon);
+}
+
+// WiFi task context — table update only, under the same spinlock the
+// readers take.
+void EspNowMesh::recvThunk(const uint8_t* mac, const uint8_t* data,
+                           int len) {
+    if (instance == NULL || len < 1) {
+        return;
+    }
+    if (data[0] == ESPNOW_BEACON_MAGIC) {
+        if (len < (int)sizeof(BeaconFrame)) {
+            return;
+        }
+        const BeaconFrame* beacon = (const BeaconFrame*)data;
+        if (beacon->version == ESPNOW_FRAME_VERSION) {
+            instance->handleBeacon(*beacon);
+        }
+        return;
+    }
+    if (data[0] == ESPNOW_CMD_MAGIC) {
+        if (len < (int)sizeof(CmdRelayFrame)) {
+            return;
+        }
+        const CmdRelayFrame* cmd = (const CmdRelayFrame*)data;
+        if (cmd->version != ESPNOW_FRAME_VERSION ||
+            cmd->length > ESPNOW_CMD_MAX_PAYLOAD ||
+            instance->commandSink == NULL) {
+            return;
+        }
+        // Unicast only reaches the addressed unit; the sink enqueues
+        // onto the command task like any other command source.
+        instance->commandSink(cmd->opcode, cmd->payload, cmd->length);
+        return;
+    }
+    if (data[0] == ESPNOW_ALARM_MAGIC) {
+        if (len < (int)sizeof(AlarmRelayFrame)) {
+            return;
+        }
+        const AlarmRelayFrame* alarm = (const AlarmRelayFrame*)data;
+        if (alarm->version == ESPNOW_FRAME_VERSION) {
+            instance->handleAlarm(mac, *alarm);
+        }
+        return;
+    }
+    if (len < (int)sizeof(MeshFrame)) {
+        return;
+    }
+    const MeshFrame* frame = (const MeshFrame*)data;
+    if (frame->magic != ESPNOW_FRAME_MAGIC ||
+        frame->version != ESPNOW_FRAME_VERSION) {
+        return;
+    }
+    instance->handleFrame(mac, *frame);
+}
+
+void EspNowMesh::handleBeacon(const BeaconFrame& frame) {
+    uint32_t now = millis();
+    beaconOffsetMs = (int32_t)(frame.masterMs - now);
+    beaconSlotCount = frame.slotCount;
+    beaconSlotMs = frame.slotMs;
+    lastBeaconMs = now;
+}
+
+// Existing slot, else a free one, else the stalest — a fifth unit
+// displaces whichever room went quiet longest ago. A displaced or
+// fresh slot comes back with inUse still false so the caller can see
+// it is meeting this MAC for the first time.
+EspNowMesh::PeerState* EspNowMesh::claimPeerSlot(const uint8_t* mac) {
+    PeerState* slot = NULL;
+    PeerState* stalest = &peers[0];
+    for (uint8_t i = 0; i < ESPNOW_MAX_PEERS; i++) {
+        if (peers[i].inUse && memcmp(peers[i].mac, mac, 6) == 0) {
+            return &peers[i];
+        }
+        if (!peers[i].inUse) {
+            if (slot == NULL) {
+                slot = &peers[i];
+            }
+        } else if (peers[i].lastSeenMs < stalest->lastSeenMs) {
+            stalest = &peers[i];
+        }
+    }
+    if (slot == NULL) {
+        slot = stalest;
+        slot->inUse = false;
+    }
+    memcpy(slot->mac, mac, 6);
+    return slot;
+}
+
+void EspNowMesh::handleFrame(const uint8_t* mac, const MeshFrame& frame) {
+    int64_t now = MonoClock::nowMs();
+    portENTER_CRITICAL(&lock);
+
+    PeerState* slot = claimPeerSlot(mac);
+    slot->last = frame;
+    slot->lastSeenMs = now;
+    if (frame.motion) {
+        slot->lastMotionMs = now;
+    } else if (!slot->inUse) {
+        slot->lastMotionMs = 0;
+    }
+    if (!slot->inUse) {
+        slot->alarmSeen = false;
+    }
+    slot->inUse = true;
+
+    portEXIT_CRITICAL(&lock);
+}
+
+// WiFi task. Dedup under the lock, sink call outside it: the sink
+// claims an alarm ring slot, which must never run inside a spinlock
+// the echo ISR path can also contend.
+void EspNowMesh::handleAlarm(const uint8_t* mac,
+                             const AlarmRelayFrame& frame) {
+    bool fresh;
+    portENTER_CRITICAL(&lock);
+    PeerState* slot = claimPeerSlot(mac);
+    fresh = !slot->inUse || !slot->alarmSeen ||
+            slot->lastAlarmSeq != frame.seq;
+    slot->lastAlarmSeq = frame.seq;
+    slot->alarmSeen = true;
+    if (!slot->inUse) {
+        // First contact via an alarm: mark the slot live but with no
+        // motion history to misread.
+        slot->lastSeenMs = MonoClock::nowMs();
+        slot->lastMotionMs = 0;
+        memset(&slot->last, 0, sizeof(slot->last));
+        slot->inUse = true;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (fresh && alarmSink != NULL) {
+        alarmSink(frame.alarmType, frame.value);
+    }
+}
+
+void EspNowMesh::broadcastAlarm(uint8_t alarmType, uint16_t value) {
+    if (!initialized) {
+        return;
+    }
+
+    AlarmRelayFrame frame;
+    frame.magic = ESPNOW_ALARM_MAGIC;
+    frame.version = ESPNOW_FRAME_VERSION;
+    frame.alarmType = alarmType;
+    frame.reserved = 0;
+    frame.value = value;
+    frame.seq = ++alarmSeq;
+    frame.uptimeMs = millis();
+
+    // Blind repeats instead of acks: each send is sub-millisecond, so
+    // three copies still land inside the alarm latency budget, and
+    // the receiver's sequence dedup makes the extras free.
+    for (uint8_t i = 0; i < ESPNOW_ALARM_REPEATS; i++) {
+        esp_now_send(BROADCAST_MAC, (const uint8_t*)&frame, sizeof(frame));
+    }
+}
+
+bool EspNowMesh::anyRecentPeerMotion() const {
+    if (!initialized) {
+        return false;
+    }
+    int64_t now = MonoClock::nowMs();
+    bool recent = false;
+    portENTER_CRITICAL(&lock);
+    for (uint8_t i = 0; i < ESPNOW_MAX_PEERS; i++) {
+        if (peers[i].inUse && peers[i].lastMotionMs != 0 &&
+            now - peers[i].lastMotionMs < ESPNOW_PEER_STALE_MS) {
+            recent = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return recent;
+}
+
+uint8_t EspNowMesh::mySlot() const {
+    // Rank of our MAC among the active peers', ascending: every unit
+    // computes the same ordering from the same converged table.
+    uint8_t slot = 0;
+    int64_t now = MonoClock::nowMs();
+    for (uint8_t i = 0; i < ESPNOW_MAX_PEERS; i++) {
+        if (peers[i].inUse &&
+            now - peers[i].lastSeenMs < ESPNOW_PEER_STALE_MS &&
+            memcmp(peers[i].mac, ownMac, 6) < 0) {
+            slot++;
+        }
+    }
+    return slot;
+}
+
+uint32_t EspNowMesh::ultrasonicHoldoffMs() const {
+    if (!initialized || lastBeaconMs == 0) {
+        return 0;
+    }
+    uint32_t now = millis();
+    if (now - lastBeaconMs > ESPNOW_PEER_STALE_MS) {
+        return 0; // master gone; free-run rather than stall
+    }
+    uint8_t slots = beaconSlotCount;
+    uint16_t width = beaconSlotMs;
+    if (slots == 0 || width == 0) {
+        return 0;
+    }
+
+    portENTER_CRITICAL(&lock);
+    uint8_t slot = mySlot() % slots;
+    portEXIT_CRITICAL(&lock);
+
+    uint32_t frame = (uint32_t)slots * width;
+    uint32_t phase = (now + (uint32_t)beaconOffsetMs) % frame;
+    uint32_t start = (uint32_t)slot * width;
+    // "In slot" means the first half, so the burst and its echo tail
+    // finish before the next unit's slot opens.
+    if (phase >= start && phase < start + width / 2u) {
+        return 0;
+    }
+    return (start + frame - phase) % frame;
+}
+
+bool EspNowMesh::peerSnapshot(uint8_t index, uint8_t mac[6],
+                              MeshFrame& out, uint32_t& ageMs) const {
+    if (!initialized) {
+        return false;
+    }
+    int64_t now = MonoClock::nowMs();
+    bool found = false;
+    uint8_t fresh = 0;
+    portENTER_CRITICAL(&lock);
+    for (uint8_t i = 0; i < ESPNOW_MAX_PEERS; i++) {
+        if (!peers[i].inUse ||
+            now - peers[i].lastSeenMs >= ESPNOW_PEER_STALE_MS) {
+            continue;
+        }
+        if (fresh == index) {
+            memcpy(mac, peers[i].mac, 6);
+            out = peers[i].last;
+            // Always below the stale window here, so the 32-bit wire
+            // field cannot truncate it.
+            ageMs = (uint32_t)(now - peers[i].lastSeenMs);
+            found = true;
+            break;
+        }
+        fresh++;
+    }
+    portEXIT_CRITICAL(&lock);
+    return found;
+}
+
+bool EspNowMesh::relayCommand(const uint8_t mac[6], uint8_t opcode,
+                              const uint8_t* payload, uint8_t length) {
+    if (!initialized || length > ESPNOW_CMD_MAX_PAYLOAD) {
+        return false;
+    }
+
+    // Unicast needs a registered peer; register lazily so the table
+    // only ever holds units the phone actually addressed.
+    if (!esp_now_is_peer_exist(mac)) {
+        esp_now_peer_info_t peer;
+        memset(&peer, 0, sizeof(peer));
+        memcpy(peer.peer_addr, mac, 6);
+        peer.channel = ESPNOW_CHANNEL;
+        peer.encrypt = false;
+        if (esp_now_add_peer(&peer) != ESP_OK) {
+            return false;
+        }
+    }
+
+    CmdRelayFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.magic = ESPNOW_CMD_MAGIC;
+    frame.version = ESPNOW_FRAME_VERSION;
+    frame.opcode = opcode;
+    frame.length = length;
+    memcpy(frame.payload, payload, length);
+
+    // Fire and forget like the snapshots: the app observes the effect
+    // (or its absence) in the peer's next relayed frame and retries.
+    return esp_now_send(mac, (const uint8_t*)&frame,
+                        sizeof(frame)) == ESP_OK;
+}
+
+uint8_t EspNowMesh::peerCount() const {
+    int64_t now = MonoClock::nowMs();
+    uint8_t count = 0;
+    portENTER_CRITICAL(&lock);
+    for (uint8_t i = 0; i < ESPNOW_MAX_PEERS; i++) {
+        if (peers[i].inUse &&
+            now - peers[i].lastSeenMs < ESPNOW_PEER_STALE_MS) {
+            count++;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return count;
+}
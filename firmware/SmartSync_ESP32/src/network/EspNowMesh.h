@@ -0,0 +1,186 @@
+#ifndef ESP_NOW_MESH_H
+#define ESP_NOW_MESH_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Direct unit-to-unit exchange for multi-room homes. Each unit
+// broadcasts a packed room snapshot over ESP-NOW — connectionless,
+// sub-millisecond sends, no association — and keeps a table of the
+// snapshots it hears, so every unit holds the whole house's recent
+// occupancy picture without the phone maintaining one BLE connection
+// per room. Any unit can therefore act as the aggregation point: its
+// BLE client reads house-level context from whichever unit it is
+// already connected to.
+//
+// First consumer is the motion-timeout alert: a resident who left the
+// bedroom for the bathroom is motion in *some* room, and the house
+// check suppresses the false alarm the single-room check would raise.
+//
+// Frames are broadcast on a fixed channel and carry no secrets (room
+// climate and motion booleans); pairing-free beats key management for
+// the in-home threat model the BLE bond already covers.
+
+// Time beacon from the aggregation unit: aligns every unit's notion
+// of "mesh time" to sub-millisecond (ESP-NOW delivery is sub-ms and
+// unqueued) and carries the slot geometry for time-division
+// ultrasonic sampling. 12 bytes on the air.
+struct __attribute__((packed)) BeaconFrame {
+    uint8_t magic;      // ESPNOW_BEACON_MAGIC
+    uint8_t version;    // ESPNOW_FRAME_VERSION
+    uint8_t slotCount;  // slots per frame
+    uint8_t reserved;
+    uint16_t slotMs;    // slot width
+    uint16_t reserved2;
+    uint32_t masterMs;  // master millis() at send
+};
+
+// Command relay from the aggregation unit to one peer, unicast. The
+// inner opcode/payload are the peer's own binary command space
+// (ble/CommandParser.h), so the peer dispatches a relayed SET_FAN
+// exactly like a local one. Carries only the low-risk actuator subset
+// the aggregator whitelists; consistent with the threat model above,
+// the hop itself is unauthenticated — the phone-side write already
+// passed the BLE session gate.
+struct __attribute__((packed)) CmdRelayFrame {
+    uint8_t magic;    // ESPNOW_CMD_MAGIC
+    uint8_t version;  // ESPNOW_FRAME_VERSION
+    uint8_t opcode;   // CommandOpcode
+    uint8_t length;   // payload bytes used
+    uint8_t payload[ESPNOW_CMD_MAX_PAYLOAD];
+};
+
+// Emergency alarm fan-out, broadcast. Connectionless like the
+// snapshots, so a fall in one room is audible house-wide within the
+// local pipeline's own budget — no coordinator, no association, no
+// retry state. Each event goes out ESPNOW_ALARM_REPEATS times under
+// one sequence number; receivers dedup per sender. 12 bytes on the
+// air.
+struct __attribute__((packed)) AlarmRelayFrame {
+    uint8_t magic;      // ESPNOW_ALARM_MAGIC
+    uint8_t version;    // ESPNOW_FRAME_VERSION
+    uint8_t alarmType;  // sender's AlarmSystem::AlarmType
+    uint8_t reserved;
+    uint16_t value;     // the raise's event-specific value
+    uint16_t seq;       // per-sender, bumps once per event
+    uint32_t uptimeMs;  // sender millis(), for debugging skew
+};
+
+// 16 bytes on the air.
+struct __attribute__((packed)) MeshFrame {
+    uint8_t magic;        // ESPNOW_FRAME_MAGIC
+    uint8_t version;      // ESPNOW_FRAME_VERSION
+    uint8_t motion;       // PIR state at send time
+    uint8_t occupancy;    // fused confidence, 0-255
+    int16_t temperature;  // °C × 100
+    uint16_t humidity;    // %RH × 100
+    uint8_t fanSpeed;
+    uint8_t ledBrightness;
+    uint16_t reserved;
+    uint32_t uptimeMs;    // sender millis(), for debugging skew
+};
+
+class EspNowMesh {
+public:
+    EspNowMesh();
+
+    // Brings up ESP-NOW on the fixed channel and registers the
+    // receive path. No-op unless ESPNOW_MESH_ENABLED.
+    void begin();
+
+    // Broadcasts this unit's snapshot; called from the sensor push
+    // cadence, rate-limited internally to ESPNOW_SEND_INTERVAL_MS.
+    void sendSnapshot(float temperature, float humidity, bool motion,
+                      uint8_t occupancy, uint8_t fanSpeed,
+                      uint8_t ledBrightness);
+
+    // True when any peer reported motion within ESPNOW_PEER_STALE_MS —
+    // the house-level side of the motion-timeout check. Lock-free
+    // readable from the sensor task.
+    bool anyRecentPeerMotion() const;
+
+    // Milliseconds to hold the next ultrasonic burst so it lands in
+    // this unit's time-division slot; 0 when already in-slot, alone,
+    // or no beacon heard recently. The slot index is this unit's MAC
+    // rank among active peers — deterministic with no assignment
+    // round-trip (briefly collidable while tables converge, which is
+    // no worse than today's always-colliding behavior).
+    uint32_t ultrasonicHoldoffMs() const;
+
+    uint8_t peerCount() const;
+    bool isActive() const { return initialized; }
+
+    // ===== AGGREGATION ROLE =====
+    // Copies the index-th fresh peer's MAC and last snapshot; false
+    // past the end. Indexes compact over fresh peers only, so the
+    // caller round-robins 0..peerCount()-1.
+    bool peerSnapshot(uint8_t index, uint8_t mac[6], MeshFrame& out,
+                      uint32_t& ageMs) const;
+
+    // Unicasts a whitelisted command to one peer (aggregation unit
+    // only); adds the unicast ESP-NOW peer entry on first use. False
+    // when inactive, the payload oversized, or the send refused.
+    bool relayCommand(const uint8_t mac[6], uint8_t opcode,
+                      const uint8_t* payload, uint8_t length);
+
+    // Sink for relayed commands arriving at a peer. Runs in the WiFi
+    // task: enqueue, never actuate — same contract as the BLE command
+    // callbacks.
+    typedef void (*CommandSink)(uint8_t opcode, const uint8_t* payload,
+                                uint8_t length);
+    void onCommand(CommandSink sink) { commandSink = sink; }
+
+    // ===== ALARM FAN-OUT =====
+    // Broadcasts one emergency event to every unit in range, repeated
+    // ESPNOW_ALARM_REPEATS times under one sequence number. Called
+    // from the alarm drain task's mirror point — each send is
+    // sub-millisecond and unqueued, so the house-wide sound lands
+    // within the local pipeline's own latency budget.
+    void broadcastAlarm(uint8_t alarmType, uint16_t value);
+
+    // Sink for deduplicated peer alarms. Runs in the WiFi task; the
+    // alarm ring's raise() is the intended call — it is a lock-free
+    // slot claim, not actuation.
+    typedef void (*AlarmSink)(uint8_t alarmType, uint16_t value);
+    void onAlarm(AlarmSink sink) { alarmSink = sink; }
+
+private:
+    struct PeerState {
+        uint8_t mac[6];
+        MeshFrame last;
+        int64_t lastSeenMs;    // MonoClock::nowMs()
+        int64_t lastMotionMs;  // last frame that carried motion; 0 = never.
+                               // 64-bit so a month-dead peer can never
+                               // wrap back into the freshness window.
+        uint16_t lastAlarmSeq; // dedup across the repeated sends
+        bool alarmSeen;        // lastAlarmSeq holds a real sequence
+        bool inUse;
+    };
+
+    static void recvThunk(const uint8_t* mac, const uint8_t* data, int len);
+    void handleFrame(const uint8_t* mac, const MeshFrame& frame);
+    void handleAlarm(const uint8_t* mac, const AlarmRelayFrame& frame);
+    void handleBeacon(const BeaconFrame& frame);
+    PeerState* claimPeerSlot(const uint8_t* mac); // lock held by caller
+    void sendBeacon();
+    uint8_t mySlot() const; // lock held by the caller
+
+    bool initialized;
+    uint32_t lastSendMs;
+    uint16_t alarmSeq;      // this unit's outbound alarm sequence
+    CommandSink commandSink;
+    AlarmSink alarmSink;
+    uint8_t ownMac[6];
+    PeerState peers[ESPNOW_MAX_PEERS];
+
+    // Beacon-derived TDMA state; offset is master millis() minus ours.
+    volatile int32_t beaconOffsetMs;
+    volatile uint32_t lastBeaconMs;
+    volatile uint8_t beaconSlotCount;
+    volatile uint16_t beaconSlotMs;
+    mutable portMUX_TYPE lock;
+
+    static EspNowMesh* instance; // ESP-NOW callbacks are C functions
+};
+
+#endif // ESP_NOW_MESH_H
@@ -0,0 +1,83 @@
+#include "LzssCodec.h"
+
+// Longest match for in[pos..] within the trailing window. Linear scan:
+// for the 8 KB batch body this is a few million byte compares, a few
+// milliseconds at 240 MHz on a task with no latency budget.
+static size_t findMatch(const uint8_t* in, size_t inLen, size_t pos,
+                        size_t* bestOffset) {
+    size_t windowStart = pos > LZSS_WINDOW ? pos - LZSS_WINDOW : 0;
+    size_t bestLen = 0;
+
+    for (size_t cand = windowStart; cand < pos; cand++) {
+        if (in[cand] != in[pos]) {
+            continue;
+        }
+        size_t len = 1;
+        size_t maxLen = inLen - pos;
+        if (maxLen > LZSS_MAX_MATCH) {
+            maxLen = LZSS_MAX_MATCH;
+        }
+        // Matches may run past pos into their own output (overlapping
+        // copy); the decoder copies byte-at-a-time, so that's legal.
+        while (len < maxLen && in[cand + len] == in[pos + len]) {
+            len++;
+        }
+        if (len > bestLen) {
+            bestLen = len;
+            *bestOffset = pos - cand;
+            if (len == maxLen) {
+                break;
+            }
+        }
+    }
+    return bestLen;
+}
+
+size_t lzssCompress(const uint8_t* in, size_t inLen,
+                    uint8_t* out, size_t outCap) {
+    size_t pos = 0;
+    size_t outLen = 0;
+    size_t ctrlAt = 0; // position of the pending control byte
+    uint8_t ctrlBits = 0;
+    uint8_t ctrlCount = 0;
+
+    while (pos < inLen) {
+        if (ctrlCount == 0) {
+            if (outLen >= outCap) {
+                return 0;
+            }
+            ctrlAt = outLen++;
+        }
+
+        size_t offset = 0;
+        size_t matchLen = findMatch(in, inLen, pos, &offset);
+
+        ctrlBits <<= 1;
+        if (matchLen >= LZSS_MIN_MATCH) {
+            if (outLen + 2 > outCap) {
+                return 0;
+            }
+            out[outLen++] = (uint8_t)offset;
+            out[outLen++] = (uint8_t)(matchLen - LZSS_MIN_MATCH + 1);
+            pos += matchLen;
+        } else {
+            if (outLen >= outCap) {
+                return 0;
+            }
+            ctrlBits |= 1;
+            out[outLen++] = in[pos++];
+        }
+
+        if (++ctrlCount == 8) {
+            out[ctrlAt] = ctrlBits;
+            ctrlBits = 0;
+            ctrlCount = 0;
+        }
+    }
+
+    if (ctrlCount != 0) {
+        // Left-align the partial group so the decoder reads MSB first.
+        out[ctrlAt] = (uint8_t)(ctrlBits << (8 - ctrlCount));
+    }
+    return outLen;
+}
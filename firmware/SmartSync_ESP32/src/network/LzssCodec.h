@@ -0,0 +1,30 @@
+#ifndef LZSS_CODEC_H
+#define LZSS_CODEC_H
+
+#include <Arduino.h>
+
+// Tiny LZSS compressor for upload payloads. The delta-varint history
+// chunks already strip per-field redundancy, but adjacent chunks still
+// repeat structure (headers, flag runs, quiet-period deltas); a
+// byte-oriented LZSS pass over the whole batch body recovers that at
+// a cost of a few milliseconds on the uplink task and zero heap — the
+// encoder's only state is its two scan indices.
+//
+// Format (decoder: backend/functions/src/lzss.ts): a control byte
+// precedes each
+// group of 8 tokens, MSB first; bit 1 = literal byte, bit 0 = match
+// pair {offset byte (1-255 back), length byte (LZSS_MIN_MATCH-258)}.
+// No container header — the transport labels compressed bodies
+// (Content-Encoding: x-lzss) and carries the original length.
+
+#define LZSS_MIN_MATCH 4    // below this a pair costs more than literals
+#define LZSS_MAX_MATCH 258  // length byte + MIN_MATCH - 1
+#define LZSS_WINDOW 255     // one-byte offsets
+
+// Compresses in[0..inLen) into out; returns the compressed size, or 0
+// when the result would not fit outCap (incompressible input — send
+// the original instead).
+size_t lzssCompress(const uint8_t* in, size_t inLen,
+                    uint8_t* out, size_t outCap);
+
+#endif // LZSS_CODEC_H
@@ -0,0 +1,99 @@
+#include "MdnsAdvertiser.h"
+
+#if MDNS_ENABLED
+#include <WiFi.h>
+#include <ESPmDNS.h>
+#include "../system/SettingsStore.h"
+#endif
+
+MdnsAdvertiser* MdnsAdvertiser::instance = NULL;
+
+MdnsAdvertiser::MdnsAdvertiser()
+    : settingsStore(NULL) {
+    hostname[0] = '\0';
+}
+
+#if MDNS_ENABLED
+
+// Capability flags mirror the compile-time feature set, so tooling
+// knows what a unit speaks before connecting to it.
+static const char* capabilityFlags() {
+    return "ble"
+#if MQTT_TELEMETRY_ENABLED
+           ",mqtt"
+#endif
+#if WS_SERVER_ENABLED
+           ",ws"
+#endif
+#if WIFI_UPLINK_ENABLED
+           ",uplink"
+#endif
+#if ESPNOW_MESH_ENABLED
+           ",mesh"
+#endif
+        ;
+}
+
+static void onGotIp(WiFiEvent_t event, WiFiEventInfo_t info) {
+    (void)event;
+    (void)info;
+    // Runs on the WiFi event task; MDNS.begin is idempotent across
+    // re-associations (the uplink cycles the radio every batch).
+    MdnsAdvertiser* self = MdnsAdvertiser::instanceForEvent();
+    if (self != NULL) {
+        self->registerServices();
+    }
+}
+
+void MdnsAdvertiser::begin(SettingsStore* settings) {
+    settingsStore = settings;
+    uint32_t id = settingsStore != NULL ? settingsStore->data().deviceId : 0;
+    if (id == 0) {
+        id = (uint32_t)ESP.getEfuseMac();
+    }
+    snprintf(hostname, sizeof(hostname), "%s%08x", MDNS_HOSTNAME_PREFIX, id);
+
+    instance = this;
+    WiFi.onEvent(onGotIp, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+}
+
+void MdnsAdvertiser::registerServices() {
+    if (!MDNS.begin(hostname)) {
+        DEBUG_PRINTLN("mDNS: responder start failed");
+        return;
+    }
+
+    // The port points at the most useful TCP endpoint compiled in;
+    // the TXT records are the real payload for discovery.
+#if WS_SERVER_ENABLED
+    uint16_t port = WS_SERVER_PORT;
+#else
+    uint16_t port = 80;
+#endif
+    MDNS.addService(MDNS_SERVICE, "tcp", port);
+    char idTxt[12];
+    snprintf(idTxt, sizeof(idTxt), "%08x",
+             settingsStore != NULL && settingsStore->data().deviceId != 0
+                 ? settingsStore->data().deviceId
+                 : (uint32_t)ESP.getEfuseMac());
+    MDNS.addServiceTxt(MDNS_SERVICE, "tcp", "id", idTxt);
+    MDNS.addServiceTxt(MDNS_SERVICE, "tcp", "fw", FIRMWARE_VERSION);
+    MDNS.addServiceTxt(MDNS_SERVICE, "tcp", "hw", HARDWARE_VERSION);
+    MDNS.addServiceTxt(MDNS_SERVICE, "tcp", "build", BUILD_INFO);
+    MDNS.addServiceTxt(MDNS_SERVICE, "tcp", "caps", capabilityFlags());
+
+    DEBUG_PRINTF("mDNS: %s.local (_%s._tcp)\n", hostname, MDNS_SERVICE);
+}
+
+MdnsAdvertiser* MdnsAdvertiser::instanceForEvent() {
+    return instance;
+}
+
+#else // !MDNS_ENABLED
+
+// BLE-only build: linkable no-op so main.cpp needs no conditionals.
+void MdnsAdvertiser::begin(SettingsStore* settings) {
+    settingsStore = settings;
+}
+
+#endif // MDNS_ENABLED
@@ -0,0 +1,39 @@
+#ifndef MDNS_ADVERTISER_H
+#define MDNS_ADVERTISER_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+class SettingsStore;
+
+// mDNS identity for the WiFi modes: the unit registers
+// <smartsync-id>.local and answers _smartsync._tcp queries with the
+// device ID, firmware version, and capability flags in TXT records.
+// Tooling resolves a unit by one multicast query instead of scanning
+// the subnet, and a fleet OTA job gets its whole target list the same
+// way.
+//
+// Registration rides the WiFi GOT_IP event, so it follows whichever
+// feature owns the association (and re-registers if the uplink cycles
+// the radio). Compiled in only with a WiFi feature enabled.
+class MdnsAdvertiser {
+public:
+    MdnsAdvertiser();
+
+    // Hooks the WiFi event; actual registration happens when an IP
+    // arrives. A no-op without a WiFi feature compiled in.
+    void begin(SettingsStore* settings);
+
+    // WiFi event path (GOT_IP): starts the responder and publishes
+    // the service + TXT records. Idempotent across re-associations.
+    void registerServices();
+    static MdnsAdvertiser* instanceForEvent();
+
+private:
+    SettingsStore* settingsStore;
+    char hostname[24];
+
+    static MdnsAdvertiser* instance; // WiFi events are free functions
+};
+
+#endif // MDNS_ADVERTISER_H
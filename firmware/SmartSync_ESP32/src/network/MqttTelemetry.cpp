@@ -0,0 +1,185 @@
+#include "MqttTelemetry.h"
+
+#if MQTT_TELEMETRY_ENABLED
+#include <WiFi.h>
+#include <mqtt_client.h>
+#include "../system/StackPlacer.h"
+#endif
+
+MqttTelemetry::MqttTelemetry()
+    : client(NULL),
+      connected(false),
+      pendingCount(0),
+      dropped(0),
+      batches(0),
+      lock(portMUX_INITIALIZER_UNLOCKED) {
+    topicTelemetry[0] = '\0';
+    topicAlert[0] = '\0';
+}
+
+#if MQTT_TELEMETRY_ENABLED
+
+// esp-mqtt's own task delivers these; only the connection flag is
+// touched here, so no locking against the batch task is needed.
+void MqttTelemetry::eventThunk(void* arg, const char* base,
+                               int32_t eventId, void* eventData) {
+    MqttTelemetry* self = static_cast<MqttTelemetry*>(arg);
+    (void)base;
+    (void)eventData;
+    switch (eventId) {
+        case MQTT_EVENT_CONNECTED:
+            DEBUG_PRINTLN("MQTT: connected");
+            self->connected = true;
+            break;
+        case MQTT_EVENT_DISCONNECTED:
+            DEBUG_PRINTLN("MQTT: disconnected");
+            self->connected = false;
+            break;
+        default:
+            break;
+    }
+}
+
+void MqttTelemetry::begin() {
+    if (strlen(WIFI_UPLINK_SSID) == 0 || strlen(MQTT_BROKER_URI) == 0) {
+        return;
+    }
+
+    // Topic per device, keyed by the efuse MAC like the uplink's
+    // X-Device-Id, so the broker side correlates the two paths.
+    uint32_t deviceId = (uint32_t)ESP.getEfuseMac();
+    snprintf(topicTelemetry, sizeof(topicTelemetry), "%s/%08x/telemetry",
+             MQTT_TOPIC_PREFIX, deviceId);
+    snprintf(topicAlert, sizeof(topicAlert), "%s/%08x/alert",
+             MQTT_TOPIC_PREFIX, deviceId);
+
+    // PSRAM stack: the batch loop works in RAM and hands frames to
+    // esp-mqtt, whose own internal-stack task owns the socket.
+    StackPlacer::createPsram(taskThunk, "mqtt", MQTT_TASK_STACK, this,
+                             MQTT_TASK_PRIORITY, MQTT_TASK_CORE);
+}
+
+void MqttTelemetry::taskThunk(void* arg) {
+    static_cast<MqttTelemetry*>(arg)->taskLoop();
+}
+
+void MqttTelemetry::taskLoop() {
+    // Facility mode keeps the radio associated — the broker link is
+    // the product here, and the AP is in the same building.
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(WIFI_UPLINK_SSID, WIFI_UPLINK_PASSWORD);
+    while (WiFi.status() != WL_CONNECTED) {
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+    DEBUG_PRINTLN("MQTT: WiFi up");
+
+    char clientId[24];
+    snprintf(clientId, sizeof(clientId), "smartsync-%08x",
+             (uint32_t)ESP.getEfuseMac());
+
+    esp_mqtt_client_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.uri = MQTT_BROKER_URI;
+    config.client_id = clientId;
+    config.keepalive = MQTT_KEEPALIVE_S;
+    // Persistent session: the broker keeps subscription state and any
+    // queued QoS 1 traffic across reconnects, so 50 units coming back
+    // after a broker restart don't all re-subscribe at once.
+    config.disable_clean_session = true;
+
+    esp_mqtt_client_handle_t handle = esp_mqtt_client_init(&config);
+    if (handle == NULL) {
+        DEBUG_PRINTLN("MQTT: client init failed");
+        vTaskDelete(NULL);
+        return;
+    }
+    esp_mqtt_client_register_event(handle, MQTT_EVENT_ANY,
+                                   eventThunk, this);
+    client = handle;
+    esp_mqtt_client_start(handle);
+
+    // esp-mqtt reconnects on its own; this loop only paces the batch.
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(MQTT_BATCH_INTERVAL_MS));
+        publishBatch();
+    }
+}
+
+void MqttTelemetry::queueTelemetry(const SensorFrame& frame) {
+    portENTER_CRITICAL(&lock);
+    if (pendingCount < MQTT_BATCH_FRAMES) {
+        pending[pendingCount++] = frame;
+    } else {
+        // Batch full (publish stalled): drop the new frame. The
+        // history log still has the sample; telemetry is best-effort.
+        dropped++;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void MqttTelemetry::queueAlert(uint8_t alarmType, uint16_t value,
+                               uint32_t timestampMs) {
+    if (client == NULL || !connected) {
+        return;
+    }
+    AlertFrame frame;
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_ALERT;
+    frame.alarmType = alarmType;
+    frame.value = value;
+    frame.reserved = 0;
+    frame.timestampMs = timestampMs;
+
+    // QoS 1, enqueued (non-blocking): the caller is the alarm drain
+    // task, which must not wait on the network.
+    esp_mqtt_client_enqueue((esp_mqtt_client_handle_t)client, topicAlert,
+                            (const char*)&frame, sizeof(frame), 1, 0, true);
+}
+
+void MqttTelemetry::publishBatch() {
+    if (client == NULL || !connected) {
+        return; // frames keep accumulating up to the batch cap
+    }
+
+    // Copy out under the lock, publish outside it.
+    SensorFrame batch[MQTT_BATCH_FRAMES];
+    uint8_t count;
+    portENTER_CRITICAL(&lock);
+    count = pendingCount;
+    memcpy(batch, pending, count * sizeof(SensorFrame));
+    pendingCount = 0;
+    portEXIT_CRITICAL(&lock);
+    if (count == 0) {
+        return;
+    }
+
+    // One QoS 0 publish carrying the concatenated frames; each is
+    // self-delimiting (magic + fixed size), so the subscriber splits
+    // the payload by sizeof(SensorFrame).
+    int id = esp_mqtt_client_publish((esp_mqtt_client_handle_t)client,
+                                     topicTelemetry, (const char*)batch,
+                                     count * sizeof(SensorFrame), 0, 0);
+    if (id >= 0) {
+        batches++;
+    }
+}
+
+#else // !MQTT_TELEMETRY_ENABLED
+
+// BLE-only build: linkable no-ops so main.cpp needs no conditionals.
+void MqttTelemetry::begin() {
+}
+
+void MqttTelemetry::queueTelemetry(const SensorFrame& frame) {
+    (void)frame;
+}
+
+void MqttTelemetry::queueAlert(uint8_t alarmType, uint16_t value,
+                               uint32_t timestampMs) {
+    (void)alarmType;
+    (void)value;
+    (void)timestampMs;
+}
+
+#endif // MQTT_TELEMETRY_ENABLED
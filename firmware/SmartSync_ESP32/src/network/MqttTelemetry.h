@@ -0,0 +1,61 @@
+#ifndef MQTT_TELEMETRY_H
+#define MQTT_TELEMETRY_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+#include "../ble/SensorFrame.h"
+
+// Local-broker telemetry for facility deployments that run their own
+// MQTT infrastructure and skip the Firebase path. The wire format is
+// the packed BLE frames verbatim — one decoder serves both transports.
+//
+// Two QoS tiers keep a 50-unit floor from melting the broker: alerts
+// publish QoS 1 the moment the alarm drain task fires (delivery
+// matters, duplicates are deduped on timestampMs), while routine
+// sensor frames coalesce in RAM and go out as one QoS 0 publish per
+// minute (a lost batch costs one minute of samples the history log
+// still holds). The broker session is persistent, so a reconnect
+// resumes without the re-subscription stampede.
+//
+// Compiled in only with MQTT_TELEMETRY_ENABLED; the BLE-only build
+// pays no flash or RAM for it.
+class MqttTelemetry {
+public:
+    MqttTelemetry();
+
+    // Connects WiFi, starts the broker session, and spawns the batch
+    // task when enabled and configured; a no-op otherwise.
+    void begin();
+
+    // Sensor task: appends one frame to the pending batch. Cheap —
+    // a memcpy under a spinlock; the task owns the actual publish.
+    void queueTelemetry(const SensorFrame& frame);
+
+    // Alarm drain task: QoS 1 publish, immediate (the esp-mqtt client
+    // queues it from any task). Mirrors the BLE alert notify.
+    void queueAlert(uint8_t alarmType, uint16_t value, uint32_t timestampMs);
+
+    bool isConnected() const { return connected; }
+    uint32_t batchesPublished() const { return batches; }
+
+private:
+    static void taskThunk(void* arg);
+    void taskLoop();
+    void publishBatch();
+    // esp-mqtt event callback; esp_event_base_t is const char*, kept
+    // primitive here so the header stays free of IDF includes.
+    static void eventThunk(void* arg, const char* base, int32_t eventId,
+                           void* eventData);
+
+    void* client;            // esp_mqtt_client_handle_t, opaque here
+    volatile bool connected; // set from the esp-mqtt event task
+    char topicTelemetry[48];
+    char topicAlert[48];
+    SensorFrame pending[MQTT_BATCH_FRAMES];
+    uint8_t pendingCount;
+    uint32_t dropped;        // frames lost to a full batch
+    uint32_t batches;
+    portMUX_TYPE lock;
+};
+
+#endif // MQTT_TELEMETRY_H
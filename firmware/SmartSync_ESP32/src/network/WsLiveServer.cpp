@@ -0,0 +1,234 @@
+#include "WsLiveServer.h"
+
+#if WS_SERVER_ENABLED
+#include <WiFi.h>
+#include <esp_http_server.h>
+#endif
+
+WsLiveServer* WsLiveServer::instance = NULL;
+
+WsLiveServer::WsLiveServer()
+    : server(NULL),
+      drainQueued(false),
+      evicted(0),
+      lock(portMUX_INITIALIZER_UNLOCKED) {
+    memset(clients, 0, sizeof(clients));
+}
+
+#if WS_SERVER_ENABLED
+
+void WsLiveServer::begin() {
+    if (strlen(WIFI_UPLINK_SSID) == 0) {
+        return;
+    }
+    instance = this;
+    // One-shot: waits for the association, starts httpd, exits. The
+    // boot path stays on budget.
+    xTaskCreatePinnedToCore(startTaskThunk, "ws_start", 3072, this, 1,
+                            NULL, 1);
+}
+
+void WsLiveServer::startTaskThunk(void* arg) {
+    static_cast<WsLiveServer*>(arg)->startTask();
+    vTaskDelete(NULL);
+}
+
+void WsLiveServer::startTask() {
+    // Another WiFi feature (MQTT) may already own the association;
+    // only join ourselves if nobody has.
+    if (WiFi.getMode() == WIFI_OFF || WiFi.getMode() == WIFI_MODE_NULL) {
+        WiFi.mode(WIFI_STA);
+        WiFi.begin(WIFI_UPLINK_SSID, WIFI_UPLINK_PASSWORD);
+    }
+    while (WiFi.status() != WL_CONNECTED) {
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = WS_SERVER_PORT;
+    config.max_open_sockets = WS_MAX_CLIENTS;
+    config.lru_purge_enable = true; // oldest idle socket yields a slot
+
+    httpd_handle_t handle = NULL;
+    if (httpd_start(&handle, &config) != ESP_OK) {
+        DEBUG_PRINTLN("WS: httpd start failed");
+        return;
+    }
+
+    httpd_uri_t live = {};
+    live.uri = "/live";
+    live.method = HTTP_GET;
+    live.handler = wsHandlerThunk;
+    live.is_websocket = true;
+    httpd_register_uri_handler(handle, &live);
+
+    server = handle;
+    DEBUG_PRINTF("WS: live endpoint on :%d/live\n", WS_SERVER_PORT);
+}
+
+esp_err_t WsLiveServer::wsHandlerThunk(struct httpd_req* req) {
+    return instance->wsHandler(req);
+}
+
+esp_err_t WsLiveServer::wsHandler(struct httpd_req* req) {
+    // GET = the handshake just completed: claim a slot for the fd.
+    if (req->method == HTTP_GET) {
+        int fd = httpd_req_to_sockfd(req);
+        portENTER_CRITICAL(&lock);
+        ClientSlot* slot = NULL;
+        for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+            if (clients[i].inUse && clients[i].fd == fd) {
+                slot = &clients[i]; // fd reused after a close we missed
+                break;
+            }
+            if (!clients[i].inUse && slot == NULL) {
+                slot = &clients[i];
+            }
+        }
+        if (slot != NULL) {
+            slot->fd = fd;
+            slot->head = 0;
+            slot->count = 0;
+            slot->inUse = true;
+        }
+        portEXIT_CRITICAL(&lock);
+        if (slot == NULL) {
+            return ESP_FAIL; // table full; lru purge will make room
+        }
+        DEBUG_PRINTF("WS: client on fd %d\n", fd);
+        return ESP_OK;
+    }
+
+    // Inbound frames: the dashboard is read-only, but the handler must
+    // consume whatever arrives (ping/close are handled by httpd).
+    httpd_ws_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    esp_err_t err = httpd_ws_recv_frame(req, &frame, 0);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (frame.len > 0) {
+        // Drain and discard the payload so the socket stays in sync.
+        uint8_t scratch[64];
+        frame.payload = scratch;
+        frame.len = frame.len > sizeof(scratch) ? sizeof(scratch) : frame.len;
+        httpd_ws_recv_frame(req, &frame, frame.len);
+    }
+    return ESP_OK;
+}
+
+void WsLiveServer::push(const SensorFrame& frame) {
+    if (server == NULL) {
+        return;
+    }
+
+    bool needDrain = false;
+    portENTER_CRITICAL(&lock);
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        ClientSlot& slot = clients[i];
+        if (!slot.inUse) {
+            continue;
+        }
+        if (slot.count >= WS_CLIENT_QUEUE) {
+            // Reading slower than the sensor cadence for a full ring:
+            // evict rather than stall or drop silently forever.
+            closeSlot(slot, true);
+            continue;
+        }
+        slot.queue[(slot.head + slot.count) % WS_CLIENT_QUEUE] = frame;
+        slot.count++;
+        needDrain = true;
+    }
+    bool schedule = needDrain && !drainQueued;
+    if (schedule) {
+        drainQueued = true;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    // Sends happen on the httpd task; a slow socket blocks only its
+    // own drain pass, never the sensor task.
+    if (schedule &&
+        httpd_queue_work((httpd_handle_t)server, drainThunk, this) != ESP_OK) {
+        drainQueued = false;
+    }
+}
+
+void WsLiveServer::drainThunk(void* arg) {
+    static_cast<WsLiveServer*>(arg)->drain();
+}
+
+void WsLiveServer::drain() {
+    drainQueued = false;
+
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        // Pop one client's backlog with the lock dropped around each
+        // send; push() may run concurrently on the sensor task.
+        for (;;) {
+            SensorFrame frame;
+            int fd;
+            portENTER_CRITICAL(&lock);
+            if (!clients[i].inUse || clients[i].count == 0) {
+                portEXIT_CRITICAL(&lock);
+                break;
+            }
+            frame = clients[i].queue[clients[i].head];
+            clients[i].head = (clients[i].head + 1) % WS_CLIENT_QUEUE;
+            clients[i].count--;
+            fd = clients[i].fd;
+            portEXIT_CRITICAL(&lock);
+
+            httpd_ws_frame_t ws;
+            memset(&ws, 0, sizeof(ws));
+            ws.type = HTTPD_WS_TYPE_BINARY;
+            ws.payload = (uint8_t*)&frame;
+            ws.len = sizeof(frame);
+            if (httpd_ws_send_frame_async((httpd_handle_t)server, fd, &ws)
+                    != ESP_OK) {
+                portENTER_CRITICAL(&lock);
+                if (clients[i].inUse && clients[i].fd == fd) {
+                    closeSlot(clients[i], false);
+                }
+                portEXIT_CRITICAL(&lock);
+                break;
+            }
+        }
+    }
+}
+
+// Lock held by the caller.
+void WsLiveServer::closeSlot(ClientSlot& slot, bool evict) {
+    if (evict) {
+        evicted++;
+        httpd_sess_trigger_close((httpd_handle_t)server, slot.fd);
+    }
+    slot.inUse = false;
+    slot.count = 0;
+}
+
+uint8_t WsLiveServer::clientCount() const {
+    uint8_t count = 0;
+    portENTER_CRITICAL(&lock);
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (clients[i].inUse) {
+            count++;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return count;
+}
+
+#else // !WS_SERVER_ENABLED
+
+// BLE-only build: linkable no-ops so main.cpp needs no conditionals.
+void WsLiveServer::begin() {
+}
+
+void WsLiveServer::push(const SensorFrame& frame) {
+    (void)frame;
+}
+
+uint8_t WsLiveServer::clientCount() const {
+    return 0;
+}
+
+#endif // WS_SERVER_ENABLED
@@ -0,0 +1,64 @@
+#ifndef WS_LIVE_SERVER_H
+#define WS_LIVE_SERVER_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+#include "../ble/SensorFrame.h"
+
+struct httpd_req; // esp_http_server request, kept out of this header
+
+// WebSocket live-data endpoint for LAN dashboards, on the IDF HTTP
+// server already in the core libs. Wall displays connect to
+// ws://<device>:WS_SERVER_PORT/live and receive the same packed
+// SensorFrames the BLE notify path produces — one decoder, two
+// transports — at LAN latency and with zero BLE airtime per viewer.
+//
+// The sensor task never blocks on a socket: push() appends to a
+// per-client frame ring under a spinlock and schedules a drain on the
+// HTTP server's own task, which does the actual sends. A client whose
+// ring overflows is reading slower than the sensor cadence and gets
+// evicted, so one wedged dashboard can't back pressure the rest.
+//
+// Compiled in only with WS_SERVER_ENABLED; the BLE-only build pays
+// no flash or RAM for it.
+class WsLiveServer {
+public:
+    WsLiveServer();
+
+    // Spawns a one-shot task that waits for WiFi (joining it if no
+    // other feature has) and starts the server; a no-op otherwise.
+    void begin();
+
+    // Sensor task: fan a frame out to every connected client's ring.
+    void push(const SensorFrame& frame);
+
+    uint8_t clientCount() const;
+    uint32_t evictions() const { return evicted; }
+
+private:
+    struct ClientSlot {
+        int fd;
+        SensorFrame queue[WS_CLIENT_QUEUE];
+        uint8_t head;  // next frame to send (drain-owned)
+        uint8_t count; // queued frames
+        bool inUse;
+    };
+
+    static void startTaskThunk(void* arg);
+    void startTask();
+    static esp_err_t wsHandlerThunk(struct httpd_req* req);
+    esp_err_t wsHandler(struct httpd_req* req);
+    static void drainThunk(void* arg);
+    void drain();
+    void closeSlot(ClientSlot& slot, bool evict);
+
+    void* server; // httpd_handle_t, opaque here
+    ClientSlot clients[WS_MAX_CLIENTS];
+    volatile bool drainQueued; // one pending drain at a time
+    uint32_t evicted;
+    mutable portMUX_TYPE lock;
+
+    static WsLiveServer* instance; // httpd handlers are C functions
+};
+
+#endif // WS_LIVE_SERVER_H
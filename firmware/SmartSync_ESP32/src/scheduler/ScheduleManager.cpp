@@ -0,0 +1,231 @@
+#include "ScheduleManager.h"
+
+ScheduleManager::ScheduleManager()
+    : heapSize(0),
+      armed(false),
+      timer(NULL),
+      heapLock(portMUX_INITIALIZER_UNLOCKED),
+      store(NULL),
+      clock(NULL),
+      callback(NULL) {
+}
+
+void ScheduleManager::begin(SettingsStore* settingsStore, RtcClock* rtc,
+                            ActionCallback cb) {
+    store = settingsStore;
+    clock = rtc;
+    callback = cb;
+
+    esp_timer_create_args_t args = {};
+    args.callback = timerThunk;
+    args.arg = this;
+    args.name = "schedule";
+    esp_timer_create(&args, &timer);
+
+    rebuild();
+}
+
+// ============================================================================
+// HEAP
+// ============================================================================
+void ScheduleManager::heapPush(const HeapNode& node) {
+    uint8_t i = heapSize++;
+    heap[i] = node;
+    while (i > 0) {
+        uint8_t parent = (i - 1) / 2;
+        if (heap[parent].fireEpoch <= heap[i].fireEpoch) {
+            break;
+        }
+        HeapNode tmp = heap[parent];
+        heap[parent] = heap[i];
+        heap[i] = tmp;
+        i = parent;
+    }
+}
+
+ScheduleManager::HeapNode ScheduleManager::heapPopMin() {
+    HeapNode min = heap[0];
+    heap[0] = heap[--heapSize];
+    uint8_t i = 0;
+    for (;;) {
+        uint8_t left = 2 * i + 1;
+        uint8_t right = left + 1;
+        uint8_t smallest = i;
+        if (left < heapSize &&
+            heap[left].fireEpoch < heap[smallest].fireEpoch) {
+            smallest = left;
+        }
+        if (right < heapSize &&
+            heap[right].fireEpoch < heap[smallest].fireEpoch) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            break;
+        }
+        HeapNode tmp = heap[smallest];
+        heap[smallest] = heap[i];
+        heap[i] = tmp;
+        i = smallest;
+    }
+    return min;
+}
+
+// ============================================================================
+// NEXT OCCURRENCE
+// ============================================================================
+// Epoch day 0 (1970-01-01) was a Thursday; +4 maps day counts onto
+// Sunday-based weekdays. The DS3231 is assumed to hold local time, so
+// no zone handling here. Scans at most 8 days — an entry whose mask
+// skips today fires on its next enabled weekday.
+uint32_t ScheduleManager::nextFireEpoch(const ScheduleEntry& e,
+                                        uint32_t nowEpoch) const {
+    if (!e.enabled || e.daysMask == 0 || e.hour > 23 || e.minute > 59) {
+        return 0;
+    }
+
+    uint32_t days = nowEpoch / 86400;
+    uint32_t midnight = days * 86400;
+    uint32_t target = (uint32_t)e.hour * 3600 + (uint32_t)e.minute * 60;
+    uint8_t dow = (days + 4) % 7;
+
+    for (uint8_t d = 0; d < 8; d++) {
+        if (e.daysMask & (1 << ((dow + d) % 7))) {
+            uint32_t candidate = midnight + (uint32_t)d * 86400 + target;
+            if (candidate > nowEpoch) {
+                return candidate;
+            }
+        }
+    }
+    return 0;
+}
+
+// ============================================================================
+// ARMING
+// ============================================================================
+void ScheduleManager::timerThunk(void* arg) {
+    static_cast<ScheduleManager*>(arg)->onDeadline();
+}
+
+// Single one-shot for exactly the earliest deadline; nothing to do
+// means no timer at all.
+void ScheduleManager::armTimer(uint32_t fireEpoch, uint32_t nowEpoch) {
+    esp_timer_stop(timer);
+    if (fireEpoch == 0) {
+        return;
+    }
+    uint64_t deltaUs = (fireEpoch > nowEpoch)
+        ? (uint64_t)(fireEpoch - nowEpoch) * 1000000ULL
+        : 1000000ULL; // clock stepped past a deadline: fire in 1 s
+    esp_timer_start_once(timer, deltaUs);
+}
+
+void ScheduleManager::rebuildLocked(uint32_t nowEpoch) {
+    heapSize = 0;
+    const ScheduleEntry* entries = store->data().schedules;
+    for (uint8_t i = 0; i < SCHEDULE_MAX_ENTRIES; i++) {
+        uint32_t fire = nextFireEpoch(entries[i], nowEpoch);
+        if (fire != 0) {
+            HeapNode node = { fire, i };
+            heapPush(node);
+        }
+    }
+}
+
+void ScheduleManager::rebuild() {
+    if (!clock->isValid()) {
+        armed = false; // ensureArmed() retries once time exists
+        return;
+    }
+    uint32_t now = clock->unixTime();
+
+    portENTER_CRITICAL(&heapLock);
+    rebuildLocked(now);
+    uint8_t count = heapSize;
+    uint32_t next = (heapSize > 0) ? heap[0].fireEpoch : 0;
+    portEXIT_CRITICAL(&heapLock);
+
+    armTimer(next, now);
+    armed = true;
+    if (count > 0) {
+        DEBUG_PRINTF("Schedules: %u active, next in %u s\n",
+                     count, next - now);
+    }
+}
+
+void ScheduleManager::ensureArmed() {
+    if (armed || clock == NULL) {
+        return;
+    }
+    rebuild();
+}
+
+// ============================================================================
+// DEADLINE
+// ============================================================================
+void ScheduleManager::onDeadline() {
+    struct DueAction {
+        uint8_t action;
+        uint8_t value;
+    };
+    DueAction due[SCHEDULE_MAX_ENTRIES];
+    uint8_t dueCount = 0;
+
+    uint32_t now = clock->unixTime();
+
+    portENTER_CRITICAL(&heapLock);
+    while (heapSize > 0 && heap[0].fireEpoch <= now) {
+        HeapNode node = heapPopMin();
+        const ScheduleEntry& e = store->data().schedules[node.entry];
+        if (!e.enabled) {
+            continue; // edited out from under a stale heap node
+        }
+        due[dueCount].action = e.action;
+        due[dueCount].value = e.value;
+        dueCount++;
+
+        uint32_t renewedFire = nextFireEpoch(e, now);
+        if (renewedFire != 0) {
+            HeapNode renewed = { renewedFire, node.entry };
+            heapPush(renewed);
+        }
+    }
+    uint32_t next = (heapSize > 0) ? heap[0].fireEpoch : 0;
+    portEXIT_CRITICAL(&heapLock);
+
+    armTimer(next, now);
+
+    // Actions fire outside the lock; the callback only enqueues.
+    for (uint8_t i = 0; i < dueCount; i++) {
+        DEBUG_PRINTF("Schedule fired: action %u value %u\n",
+                     due[i].action, due[i].value);
+        callback(due[i].action, due[i].value);
+    }
+}
+
+// ============================================================================
+// ENTRY EDITING
+// ============================================================================
+bool ScheduleManager::setEntry(uint8_t index, const ScheduleEntry& entry) {
+    if (index >= SCHEDULE_MAX_ENTRIES) {
+        return false;
+    }
+    store->data().schedules[index] = entry;
+    rebuild();
+    return true;
+}
+
+bool ScheduleManager::clearEntry(uint8_t index) {
+    if (index >= SCHEDULE_MAX_ENTRIES) {
+        return false;
+    }
+    memset(&store->data().schedules[index], 0, sizeof(ScheduleEntry));
+    rebuild();
+    return true;
+}
+
+uint32_t ScheduleManager::nextDeadline() const {
+    portENTER_CRITICAL(&heapLock);
+    uint32_t next = (heapSize > 0) ? heap[0].fireEpoch : 0;
+    portEXIT_CRITICAL(&heapLock);
+    return next;
+}
@@ -0,0 +1,88 @@
+#ifndef SCHEDULE_MANAGER_H
+#define SCHEDULE_MANAGER_H
+
+#include <Arduino.h>
+#include "esp_timer.h"
+#include "../../include/config.h"
+#include "../system/RtcClock.h"
+#include "../system/SettingsStore.h"
+
+// Schedule engine: entries persist in the settings blob, a min-heap
+// keyed by next-fire epoch orders them, and a single one-shot
+// esp_timer is armed for exactly the earliest deadline. Determining
+// what fires next is an O(1) peek — the schedule list is never
+// scanned on a period. When the deadline lands, every due entry fires
+// through the action callback, gets its next occurrence recomputed
+// and re-heaped, and the timer re-arms for the new minimum.
+//
+// The heap is touched from the command task (rebuilds after edits)
+// and the esp_timer task (deadlines), so mutations run under a
+// spinlock — the same pattern RtcClock uses for its time base.
+class ScheduleManager {
+public:
+    enum Action : uint8_t {
+        ACTION_FAN_SPEED,
+        ACTION_LED_BRIGHTNESS,
+        ACTION_AUTO_MODE,
+    };
+
+    // Fires in esp_timer task context; implementations should only
+    // enqueue work (the main.cpp callback posts a Command).
+    typedef void (*ActionCallback)(uint8_t action, uint8_t value);
+
+    ScheduleManager();
+
+    // Wires the stores and arms the first deadline. The clock may not
+    // be valid yet (RTC never set); ensureArmed() retries later.
+    void begin(SettingsStore* store, RtcClock* clock, ActionCallback cb);
+
+    // Rebuilds the heap from the persisted entries and re-arms. Call
+    // after entries change or after a clock resync.
+    void rebuild();
+
+    // Cheap no-op while armed; re-arms once the clock becomes valid.
+    // Hangs off the periodic watchdog heartbeat, not a scan.
+    void ensureArmed();
+
+    // Entry editing: updates the blob in RAM and re-heaps. The caller
+    // owns persistence (deferred-commit path in main.cpp).
+    bool setEntry(uint8_t index, const ScheduleEntry& entry);
+    bool clearEntry(uint8_t index);
+
+    // Next fire time (epoch seconds), 0 when nothing is scheduled.
+    uint32_t nextDeadline() const;
+
+private:
+    struct HeapNode {
+        uint32_t fireEpoch;
+        uint8_t entry;
+    };
+
+    static void timerThunk(void* arg);
+    void onDeadline();
+
+    // Lock held by callers.
+    void rebuildLocked(uint32_t nowEpoch);
+
+    // Timer arming stays outside the spinlock (esp_timer calls can
+    // block on their internal mutex).
+    void armTimer(uint32_t fireEpoch, uint32_t nowEpoch);
+    void heapPush(const HeapNode& node);
+    HeapNode heapPopMin();
+
+    // Earliest occurrence of the entry strictly after nowEpoch, or 0.
+    uint32_t nextFireEpoch(const ScheduleEntry& e, uint32_t nowEpoch) const;
+
+    HeapNode heap[SCHEDULE_MAX_ENTRIES];
+    uint8_t heapSize;
+    bool armed;
+
+    esp_timer_handle_t timer;
+    mutable portMUX_TYPE heapLock;
+
+    SettingsStore* store;
+    RtcClock* clock;
+    ActionCallback callback;
+};
+
+#endif // SCHEDULE_MANAGER_H
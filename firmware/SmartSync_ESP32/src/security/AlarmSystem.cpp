@@ -0,0 +1,322 @@
+#include "AlarmSystem.h"
+#include "../system/EventTrace.h"
+#include "../system/PowerGovernor.h"
+#include "../system/WellnessSummary.h"
+
+AlarmSystem::AlarmSystem()
+    : head(0),
+      tail(0),
+      drops(0),
+      taskHandle(NULL),
+      buzzer(NULL),
+      statusLed(NULL),
+      bleManager(NULL),
+      captureCallback(NULL),
+      mirrorCallback(NULL),
+      proximityActive(false),
+      motionTimeoutActive(false),
+      anomalyActive(false),
+      fallActive(false),
+      remoteActive(false) {
+    memset((void*)ring, 0, sizeof(ring));
+}
+
+void AlarmSystem::begin(BuzzerEngine* buzzerSink, LedPatternEngine* led,
+                        BLEServiceManager* ble) {
+    buzzer = buzzerSink;
+    statusLed = led;
+    bleManager = ble;
+
+    xTaskCreatePinnedToCore(
+        taskThunk, "alarm", ALARM_TASK_STACK, this,
+        ALARM_TASK_PRIORITY, &taskHandle, ALARM_TASK_CORE);
+
+    DEBUG_PRINTLN("Alarm pipeline armed.");
+}
+
+// Multi-producer slot claim: the CAS loop makes concurrent raises (a
+// PIR edge preempting a timer raise) land in distinct slots, and the
+// capacity check happens before head moves — a full ring drops the
+// event without consuming a sequence, so every claimed slot is always
+// published and the drain's tail can never wedge behind a slot whose
+// ready flag will never be set. The ready flag is stored last with
+// release order so the drain task never reads a half-written event.
+// The tail read is racy but only ever stale in the safe direction (it
+// can drop when there was room, never overwrite an unread slot).
+bool IRAM_ATTR AlarmSystem::claimSlot(AlarmType type, uint16_t value) {
+    uint32_t slot = __atomic_load_n((uint32_t*)&head, __ATOMIC_RELAXED);
+    do {
+        if (slot - tail >= ALARM_QUEUE_LENGTH) {
+            __atomic_fetch_add((uint32_t*)&drops, 1, __ATOMIC_RELAXED);
+            return false;
+        }
+    } while (!__atomic_compare_exchange_n((uint32_t*)&head, &slot, slot + 1,
+                                          true, __ATOMIC_RELAXED,
+                                          __ATOMIC_RELAXED));
+
+    AlarmEvent& evt = ring[slot % ALARM_QUEUE_LENGTH];
+    evt.timestampMs = (uint32_t)(esp_timer_get_time() / 1000);
+    evt.value = value;
+    evt.type = type;
+    __atomic_store_n(&evt.ready, 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void IRAM_ATTR AlarmSystem::raiseFromISR(AlarmType type, uint16_t value) {
+    if (taskHandle == NULL || !claimSlot(type, value)) {
+        return;
+    }
+    BaseType_t higherPriorityWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(taskHandle, &higherPriorityWoken);
+    if (higherPriorityWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void AlarmSystem::raise(AlarmType type, uint16_t value) {
+    if (taskHandle == NULL || !claimSlot(type, value)) {
+        return;
+    }
+    xTaskNotifyGive(taskHandle);
+}
+
+void AlarmSystem::taskThunk(void* arg) {
+    static_cast<AlarmSystem*>(arg)->drainLoop();
+}
+
+void AlarmSystem::drainLoop() {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Drain every ready slot in claim order. Slots claimed but not
+        // yet ready (a producer mid-write) end the pass; their notify
+        // is already pending, so nothing is lost.
+        while (__atomic_load_n(&ring[tail % ALARM_QUEUE_LENGTH].ready,
+                               __ATOMIC_ACQUIRE)) {
+            AlarmEvent evt = ring[tail % ALARM_QUEUE_LENGTH];
+            __atomic_store_n(&ring[tail % ALARM_QUEUE_LENGTH].ready, 0,
+                             __ATOMIC_RELEASE);
+            tail++;
+            // Full clock for the dispatch: alarm latency is the spec
+            // this task exists for, and it also keeps the cycle-count
+            // histogram comparable across DFS states.
+            PowerGovernor::acquire(PowerGovernor::LOCK_ALARM);
+            uint32_t startCycles = latencyCycleCount();
+            dispatch(evt);
+            dispatchHist.record(latencyCycleCount() - startCycles);
+            PowerGovernor::release(PowerGovernor::LOCK_ALARM);
+
+            // Trace after the timed window; clears keep the value arg
+            // off since the raise already carried it.
+            switch (evt.type) {
+                case ALARM_PROXIMITY_CLEAR:
+                case ALARM_MOTION_RESUMED:
+                case ALARM_ANOMALY_CLEAR:
+                case ALARM_FALL_CLEAR:
+                case ALARM_REMOTE_CLEAR:
+                    TRACE_EVENT(TRACE_ALARM_CLEARED, evt.type, 0);
+                    break;
+                default:
+                    TRACE_EVENT(TRACE_ALARM_RAISED, evt.type, evt.value);
+                    // Night-window raises count toward the morning
+                    // wellness tally (no-op outside the window).
+                    WellnessSummary::noteAlert();
+                    break;
+            }
+
+            // Mirror after the sinks (and outside the timed window):
+            // secondary transports never tax the buzzer path.
+            if (mirrorCallback != NULL) {
+                mirrorCallback(evt.type, evt.value, evt.timestampMs);
+            }
+        }
+    }
+}
+
+// Sinks in priority order: buzzer carries the latency budget, the BLE
+// alert and the LED follow. Standing alarms don't retrigger.
+void AlarmSystem::dispatch(const AlarmEvent& evt) {
+    switch (evt.type) {
+        case ALARM_PROXIMITY_BREACH:
+            if (proximityActive) {
+                break;
+            }
+            proximityActive = true;
+            buzzer->play(BuzzerEngine::MELODY_EMERGENCY);
+            bleManager->sendAlert(evt.type, evt.value, evt.timestampMs);
+            statusLed->play(LedPatternEngine::SOLID);
+            DEBUG_PRINTF("ALARM: proximity breach (%u cm)\n", evt.value);
+            if (captureCallback != NULL) {
+                captureCallback(evt.type, evt.value);
+            }
+            break;
+
+        case ALARM_PROXIMITY_CLEAR:
+            if (!proximityActive) {
+                break;
+            }
+            proximityActive = false;
+            if (!fallActive && !remoteActive) {
+                buzzer->stop(); // any other siren outlives this clear
+            }
+            bleManager->sendAlert(evt.type, evt.value, evt.timestampMs);
+            // Fall back to whatever indication still stands.
+            statusLed->play(standingLedPattern());
+            DEBUG_PRINTLN("Alarm cleared: proximity");
+            break;
+
+        case ALARM_MOTION_TIMEOUT:
+            if (motionTimeoutActive) {
+                break;
+            }
+            motionTimeoutActive = true;
+            // The warning never talks over an active emergency siren.
+            if (!proximityActive) {
+                buzzer->play(BuzzerEngine::MELODY_ALERT);
+                statusLed->play(LedPatternEngine::HEARTBEAT);
+            }
+            bleManager->sendAlert(evt.type, evt.value, evt.timestampMs);
+            DEBUG_PRINTF("ALARM: no motion for %u minutes\n", evt.value);
+            if (captureCallback != NULL) {
+                captureCallback(evt.type, evt.value);
+            }
+            break;
+
+        case ALARM_MOTION_RESUMED:
+            if (!motionTimeoutActive) {
+                break;
+            }
+            motionTimeoutActive = false;
+            bleManager->sendAlert(evt.type, evt.value, evt.timestampMs);
+            if (!proximityActive) {
+                statusLed->play(standingLedPattern());
+            }
+            DEBUG_PRINTLN("Alarm cleared: motion resumed");
+            break;
+
+        case ALARM_FALL_SUSPECTED:
+            if (fallActive) {
+                break;
+            }
+            fallActive = true;
+            buzzer->play(BuzzerEngine::MELODY_EMERGENCY);
+            bleManager->sendAlert(evt.type, evt.value, evt.timestampMs);
+            statusLed->play(LedPatternEngine::SOLID);
+            DEBUG_PRINTF("ALARM: fall suspected (step %u cm)\n", evt.value);
+            if (captureCallback != NULL) {
+                captureCallback(evt.type, evt.value);
+            }
+            break;
+
+        case ALARM_FALL_CLEAR:
+            if (!fallActive) {
+                break;
+            }
+            fallActive = false;
+            if (!proximityActive && !remoteActive) {
+                buzzer->stop();
+            }
+            bleManager->sendAlert(evt.type, evt.value, evt.timestampMs);
+            statusLed->play(standingLedPattern());
+            DEBUG_PRINTLN("Alarm cleared: fall recovery");
+            break;
+
+        case ALARM_MOTION_ESCALATED:
+            // Ladder stage (security/EscalationLadder): the timeout is
+            // still standing and the chime didn't resolve it. Stage 1
+            // re-notifies the app over BLE, stage 2 is the caregiver
+            // urgency the MQTT mirror below carries; a stage that
+            // crossed a resume in flight dies on this flag.
+            if (!motionTimeoutActive) {
+                break;
+            }
+            if (!proximityActive && !fallActive && !remoteActive) {
+                buzzer->play(BuzzerEngine::MELODY_ALERT);
+            }
+            bleManager->sendAlert(evt.type, evt.value, evt.timestampMs);
+            DEBUG_PRINTF("ALARM: motion timeout escalated (stage %u)\n",
+                         evt.value);
+            break;
+
+        case ALARM_ANOMALY:
+            if (anomalyActive) {
+                break;
+            }
+            anomalyActive = true;
+            // The caregiver alert is the point; on-device indication
+            // stays subordinate to any louder standing alarm.
+            if (!proximityActive && !fallActive && !remoteActive &&
+                !motionTimeoutActive) {
+                buzzer->play(BuzzerEngine::MELODY_ALERT);
+                statusLed->play(LedPatternEngine::PULSE);
+            }
+            bleManager->sendAlert(evt.type, evt.value, evt.timestampMs);
+            DEBUG_PRINTF("ALARM: routine anomaly (score %u sigma^2)\n",
+                         evt.value);
+            break;
+
+        case ALARM_ANOMALY_CLEAR:
+            if (!anomalyActive) {
+                break;
+            }
+            anomalyActive = false;
+            bleManager->sendAlert(evt.type, evt.value, evt.timestampMs);
+            if (!proximityActive) {
+                statusLed->play(standingLedPattern());
+            }
+            DEBUG_PRINTLN("Alarm cleared: anomaly");
+            break;
+
+        case ALARM_REMOTE_EMERGENCY:
+            // A peer unit's siren, relayed over ESP-NOW: sound here
+            // too so a helper out of earshot of the origin room still
+            // hears it. Never re-mirrored to the mesh (main.cpp only
+            // broadcasts local-origin emergencies), so two units can't
+            // feed each other.
+            if (remoteActive) {
+                break;
+            }
+            remoteActive = true;
+            buzzer->play(BuzzerEngine::MELODY_EMERGENCY);
+            bleManager->sendAlert(evt.type, evt.value, evt.timestampMs);
+            statusLed->play(LedPatternEngine::SOLID);
+            DEBUG_PRINTF("ALARM: peer emergency (origin type %u)\n",
+                         evt.value);
+            break;
+
+        case ALARM_REMOTE_CLEAR:
+            if (!remoteActive) {
+                break;
+            }
+            remoteActive = false;
+            if (!proximityActive && !fallActive) {
+                buzzer->stop();
+            }
+            bleManager->sendAlert(evt.type, evt.value, evt.timestampMs);
+            statusLed->play(standingLedPattern());
+            DEBUG_PRINTLN("Alarm cleared: peer emergency over");
+            break;
+    }
+}
+
+void AlarmSystem::onCaptureTrigger(void (*callback)(uint8_t, uint16_t)) {
+    captureCallback = callback;
+}
+
+void AlarmSystem::onEventMirror(void (*callback)(uint8_t, uint16_t,
+                                                 uint32_t)) {
+    mirrorCallback = callback;
+}
+
+LedPatternEngine::Pattern AlarmSystem::standingLedPattern() const {
+    if (proximityActive || fallActive || remoteActive) {
+        return LedPatternEngine::SOLID;
+    }
+    if (motionTimeoutActive) {
+        return LedPatternEngine::HEARTBEAT;
+    }
+    if (anomalyActive) {
+        return LedPatternEngine::PULSE;
+    }
+    return LedPatternEngine::OFF;
+}
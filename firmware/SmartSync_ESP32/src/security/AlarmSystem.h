@@ -0,0 +1,122 @@
+#ifndef ALARM_SYSTEM_H
+#define ALARM_SYSTEM_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+#include "../actuators/BuzzerEngine.h"
+#include "../system/LatencyStats.h"
+#include "../actuators/LedPatternEngine.h"
+#include "../ble/BLEService.h"
+
+// Prioritized alarm pipeline. Producers run in ISR context (PIR edges,
+// proximity breaches from the ultrasonic echo ISR) and timer context
+// (motion timeout); each raise claims a ring slot with a single atomic
+// add — no lock, no allocation, no queue API — and wakes the drain
+// task with a direct task notification. The drain task runs above
+// every other task in the system, so the ISR-to-buzzer path for an
+// emergency is one notify-wake: tens of microseconds, comfortably
+// under the 1 ms budget.
+//
+// Sinks fire in priority order per event: buzzer first (the only one
+// with a latency requirement), then the BLE alert frame, then the
+// status LED. Sink state is owned by the drain task, so clears and
+// escalations need no locking either.
+class AlarmSystem {
+public:
+    enum AlarmType : uint8_t {
+        ALARM_PROXIMITY_BREACH, // emergency: siren until clear
+        ALARM_PROXIMITY_CLEAR,
+        ALARM_MOTION_TIMEOUT,   // warning: pips, heartbeat LED
+        ALARM_MOTION_RESUMED,   // clears a standing motion timeout
+        ALARM_ANOMALY,          // routine deviation (ml/AnomalyDetector)
+        ALARM_ANOMALY_CLEAR,    // score dropped back below the line
+        ALARM_FALL_SUSPECTED,   // emergency: siren until recovery
+        ALARM_FALL_CLEAR,       // sustained PIR activity after a fall
+        ALARM_MOTION_ESCALATED, // ladder stage reached (value = stage)
+        ALARM_REMOTE_EMERGENCY, // peer unit's emergency over ESP-NOW
+                                // (value = the origin AlarmType); never
+                                // re-broadcast, so no fan-out loops
+        ALARM_REMOTE_CLEAR,     // peer unit's emergency cleared
+    };
+
+    AlarmSystem();
+
+    // Wires the sinks and starts the drain task. Sinks must already be
+    // begun (the pipeline never initializes hardware it doesn't own).
+    void begin(BuzzerEngine* buzzer, LedPatternEngine* led,
+               BLEServiceManager* ble);
+
+    // Producer side. raiseFromISR is IRAM-safe; raise is the same slot
+    // claim from task/timer context. Value is event-specific (distance
+    // in cm, quiet minutes).
+    void IRAM_ATTR raiseFromISR(AlarmType type, uint16_t value);
+    void raise(AlarmType type, uint16_t value);
+
+    // Dropped raises (ring full); visible for field diagnostics.
+    uint32_t dropCount() const { return drops; }
+
+    // True while an emergency alarm (breach, fall, or a peer's relayed
+    // emergency) is standing. Drain-task-owned flags read cross-task:
+    // at worst one event stale, which for the OTA pause that polls
+    // this costs one poll interval, never an unsounded alarm.
+    bool emergencyStanding() const {
+        return proximityActive || fallActive || remoteActive;
+    }
+
+    // Per-event dispatch latency (cycle counter around the sink
+    // fan-out), drain-task recorded. Read/reset via CMD_GET_LATENCY.
+    LatencyHistogram& dispatchLatency() { return dispatchHist; }
+
+    // Fired from the drain task when a raise is worth a training
+    // capture (breach, timeout, fall) — after the sinks, so the
+    // callback can't cost the buzzer its latency budget.
+    void onCaptureTrigger(void (*callback)(uint8_t type, uint16_t value));
+
+    // Fired from the drain task for every dispatched event, after the
+    // sinks — a mirror point for transports beyond BLE (MQTT). Must
+    // not block.
+    void onEventMirror(void (*callback)(uint8_t type, uint16_t value,
+                                        uint32_t timestampMs));
+
+private:
+    struct AlarmEvent {
+        uint32_t timestampMs;
+        uint16_t value;
+        uint8_t type;
+        volatile uint8_t ready; // release-stored last by the producer
+    };
+
+    static void taskThunk(void* arg);
+    void drainLoop();
+    void dispatch(const AlarmEvent& evt);
+
+    bool IRAM_ATTR claimSlot(AlarmType type, uint16_t value);
+
+    LatencyHistogram dispatchHist;
+
+    AlarmEvent ring[ALARM_QUEUE_LENGTH];
+    volatile uint32_t head; // producer claim counter (atomic add)
+    uint32_t tail;          // consumer-owned
+    volatile uint32_t drops;
+
+    TaskHandle_t taskHandle;
+
+    BuzzerEngine* buzzer;
+    LedPatternEngine* statusLed;
+    BLEServiceManager* bleManager;
+    void (*captureCallback)(uint8_t, uint16_t);
+    void (*mirrorCallback)(uint8_t, uint16_t, uint32_t);
+
+    // Standing-alarm state, drain-task only.
+    bool proximityActive;
+    bool motionTimeoutActive;
+    bool anomalyActive;
+    bool fallActive;
+    bool remoteActive;
+
+    // LED precedence when a standing alarm clears: emergency > motion
+    // warning > anomaly indication > off.
+    LedPatternEngine::Pattern standingLedPattern() const;
+};
+
+#endif // ALARM_SYSTEM_H
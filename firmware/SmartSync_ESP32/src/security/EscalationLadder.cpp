@@ -0,0 +1,74 @@
+#include "EscalationLadder.h"
+
+EscalationLadder::EscalationLadder()
+    : lock(portMUX_INITIALIZER_UNLOCKED),
+      alarms(NULL),
+      appHandle(Wheel::NO_TIMER),
+      caregiverHandle(Wheel::NO_TIMER),
+      expiredCount(0) {
+}
+
+void EscalationLadder::begin(AlarmSystem* alarmSink) {
+    alarms = alarmSink;
+}
+
+void EscalationLadder::armMotionLadder() {
+    const uint8_t none = Wheel::NO_TIMER;
+    portENTER_CRITICAL(&lock);
+    if (appHandle == none && caregiverHandle == none) {
+        appHandle = wheel.schedule(
+            ESCALATION_APP_DELAY_MS / ESCALATION_TICK_MS,
+            STAGE_APP_NOTIFY);
+        caregiverHandle = wheel.schedule(
+            ESCALATION_CLOUD_DELAY_MS / ESCALATION_TICK_MS,
+            STAGE_CAREGIVER);
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void EscalationLadder::cancelMotionLadder() {
+    const uint8_t none = Wheel::NO_TIMER;
+    portENTER_CRITICAL(&lock);
+    if (appHandle != none) {
+        wheel.cancel(appHandle);
+        appHandle = none;
+    }
+    if (caregiverHandle != none) {
+        wheel.cancel(caregiverHandle);
+        caregiverHandle = none;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+// Inside the lock, during advance(): record the stage and forget its
+// handle — the wheel reuses the node the moment the callback returns.
+void EscalationLadder::onExpiry(uint32_t tag, void* ctx) {
+    EscalationLadder* self = static_cast<EscalationLadder*>(ctx);
+    if (tag == STAGE_APP_NOTIFY) {
+        self->appHandle = Wheel::NO_TIMER;
+    } else if (tag == STAGE_CAREGIVER) {
+        self->caregiverHandle = Wheel::NO_TIMER;
+    }
+    if (self->expiredCount < MAX_EXPIRED_PER_TICK) {
+        self->expired[self->expiredCount++] = tag;
+    }
+}
+
+void EscalationLadder::tick(uint32_t nowMs) {
+    if (alarms == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&lock);
+    expiredCount = 0;
+    wheel.advance(nowMs / ESCALATION_TICK_MS, onExpiry, this);
+    uint8_t count = expiredCount;
+    portEXIT_CRITICAL(&lock);
+
+    // Raises outside the lock; the drain task revalidates against the
+    // standing motion-timeout flag, so a stage crossing a resume in
+    // flight dies there.
+    for (uint8_t i = 0; i < count; i++) {
+        alarms->raise(AlarmSystem::ALARM_MOTION_ESCALATED,
+                      (uint16_t)expired[i]);
+    }
+}
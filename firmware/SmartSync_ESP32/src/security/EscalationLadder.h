@@ -0,0 +1,72 @@
+#ifndef ESCALATION_LADDER_H
+#define ESCALATION_LADDER_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+#include "../system/TimerWheel.h"
+#include "AlarmSystem.h"
+
+// Timed escalation on top of the alarm pipeline. The pipeline handles
+// the instant a condition raises; this ladder handles the condition
+// *staying* raised: a motion timeout that the local chime didn't
+// resolve re-notifies the app after ESCALATION_APP_DELAY_MS and
+// escalates to the caregiver path after ESCALATION_CLOUD_DELAY_MS,
+// unless motion cancels the whole ladder first.
+//
+// Stages are entries on a hashed timer wheel — O(1) to arm and to
+// cancel regardless of how many are pending, no esp_timer handle per
+// stage. The wheel has no tick source of its own: tick() piggybacks
+// on the periodic schedule check, and stage expiry only enqueues into
+// the alarm ring (the drain task owns every sink, so a stage that
+// races a just-dispatched resume is dropped there, not here).
+//
+// Arm/cancel run on the sensor task, tick on the command task, so the
+// wheel sits under a spinlock — the ScheduleManager heap pattern.
+class EscalationLadder {
+public:
+    EscalationLadder();
+
+    void begin(AlarmSystem* alarms);
+
+    // Arms the app and caregiver stages; called alongside the
+    // ALARM_MOTION_TIMEOUT raise. Re-arming while armed is a no-op —
+    // the ladder measures from the first raise.
+    void armMotionLadder();
+
+    // Drops every pending motion stage; called when the quiet spell
+    // ends (or the timeout latch otherwise clears).
+    void cancelMotionLadder();
+
+    // Advances the wheel to now. Rides the periodic schedule check;
+    // expiries raise ALARM_MOTION_ESCALATED outside the lock.
+    void tick(uint32_t nowMs);
+
+private:
+    // Stage index doubles as the alarm value byte the app and the
+    // MQTT mirror see.
+    enum StageTag : uint32_t {
+        STAGE_APP_NOTIFY = 1,
+        STAGE_CAREGIVER = 2,
+    };
+
+    static const uint8_t MAX_EXPIRED_PER_TICK = 4;
+
+    static void onExpiry(uint32_t tag, void* ctx);
+
+    // 64 buckets: ESCALATION_TICK_MS granularity hashes minute-scale
+    // deadlines across laps, which is the case the wheel exists for.
+    typedef TimerWheel<6, ESCALATION_TIMER_CAPACITY> Wheel;
+    Wheel wheel;
+
+    portMUX_TYPE lock;
+    AlarmSystem* alarms;
+
+    uint8_t appHandle;
+    uint8_t caregiverHandle;
+
+    // advance() collects here (inside the lock); tick() raises after.
+    uint32_t expired[MAX_EXPIRED_PER_TICK];
+    uint8_t expiredCount;
+};
+
+#endif // ESCALATION_LADDER_H
@@ -0,0 +1,44 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <Arduino.h>
+
+// Per-unit sensor calibration in fixed point. The human-readable
+// float constants in config.h are turned into integer form by the
+// constexpr converters below at compile time; what runs per sample is
+// integer multiply-and-shift — no float division on the hot path.
+//
+// Temperature and humidity carry per-channel offsets (our DHT22s show
+// consistent ±0.8 °C unit-to-unit spread); distance carries a
+// per-channel scale plus the temperature-compensated speed-of-sound
+// ratio, since the HC-SR04 driver's constant assumes 340 m/s air.
+
+// °C or %RH offset → centi-units.
+constexpr int16_t calOffsetCenti(float v) {
+    return (int16_t)(v * 100.0f + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+// Dimensionless scale → Q15 (32768 = unity).
+constexpr uint16_t calScaleQ15(float scale) {
+    return (uint16_t)(scale * 32768.0f + 0.5f);
+}
+
+// Scale-then-offset in centi-units: one multiply, one shift, one add.
+inline int32_t calApply(int32_t centi, uint16_t scaleQ15,
+                        int16_t offsetCenti) {
+    return (int32_t)(((int64_t)centi * scaleQ15) >> 15) + offsetCenti;
+}
+
+// Q15 ratio of the true speed of sound (c = 331.3 + 0.606·T m/s) to
+// the 340 m/s the driver assumes. Computed once per acquisition cycle
+// from the already-measured air temperature, applied per sample as an
+// integer multiply. Clamped so a bad temperature cannot skew ranges
+// more than 10%.
+inline uint16_t soundSpeedRatioQ15(float tempC) {
+    float ratio = (331.3f + 0.606f * tempC) / 340.0f;
+    if (ratio < 0.9f) ratio = 0.9f;
+    if (ratio > 1.1f) ratio = 1.1f;
+    return (uint16_t)(ratio * 32768.0f);
+}
+
+#endif // CALIBRATION_H
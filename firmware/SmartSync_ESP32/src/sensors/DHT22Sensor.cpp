@@ -0,0 +1,142 @@
+#include "DHT22Sensor.h"
+
+// Bit cells shorter than this (falling edge to falling edge) decode as
+// 0, longer as 1. A "0" cell is ~78 us, a "1" cell ~120 us.
+static const int64_t BIT_THRESHOLD_US = 100;
+
+// Whole-transfer guard: start pulse + response + 40 bits is < 6 ms.
+static const int64_t TRANSFER_TIMEOUT_US = 10000;
+
+DHT22Sensor::DHT22Sensor(uint8_t pin)
+    : pin(pin),
+      state(IDLE),
+      edgeCount(0),
+      startTimer(NULL),
+      transferStartUs(0),
+      lastReadMs(0),
+      readCompleted(false) {
+    lastReading.temperature = NAN;
+    lastReading.humidity = NAN;
+    lastReading.timestampMs = 0;
+    lastReading.valid = false;
+}
+
+void DHT22Sensor::begin() {
+    pinMode(pin, INPUT_PULLUP);
+
+    esp_timer_create_args_t args = {};
+    args.callback = startPulseDone;
+    args.arg = this;
+    args.name = "dht22_start";
+    esp_timer_create(&args, &startTimer);
+
+    attachInterruptArg(digitalPinToInterrupt(pin), edgeISRThunk, this, FALLING);
+}
+
+bool DHT22Sensor::startRead() {
+    if (state != IDLE) {
+        return false;
+    }
+    if (lastReadMs != 0 && (millis() - lastReadMs) < DHT_MIN_INTERVAL_MS) {
+        return false;
+    }
+
+    state = START_PULSE;
+    edgeCount = 0;
+    transferStartUs = esp_timer_get_time();
+
+    // Host start signal: hold the line low for 2 ms, then release. The
+    // release and everything after it happens in timer/ISR context.
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+    esp_timer_start_once(startTimer, DHT_START_PULSE_US);
+
+    return true;
+}
+
+bool DHT22Sensor::poll() {
+    if (state == FRAME_READY) {
+        decodeFrame();
+        state = IDLE;
+        readCompleted = true;
+    } else if (state != IDLE &&
+               (esp_timer_get_time() - transferStartUs) > TRANSFER_TIMEOUT_US) {
+        // Sensor never answered or the frame was cut short.
+        DEBUG_PRINTF("DHT22 timeout (%d edges)\n", edgeCount);
+        pinMode(pin, INPUT_PULLUP);
+        state = IDLE;
+        lastReading.valid = false;
+        readCompleted = true;
+    }
+
+    if (readCompleted) {
+        readCompleted = false;
+        lastReadMs = millis();
+        return true;
+    }
+    return false;
+}
+
+bool DHT22Sensor::isBusy() const {
+    return state != IDLE;
+}
+
+DHT22Sensor::Reading DHT22Sensor::latest() const {
+    return lastReading;
+}
+
+void DHT22Sensor::startPulseDone(void* arg) {
+    DHT22Sensor* self = static_cast<DHT22Sensor*>(arg);
+    // Release the line; the sensor responds with its preamble and the
+    // 40-bit frame, captured as falling edges by the ISR.
+    pinMode(self->pin, INPUT_PULLUP);
+    self->state = RECEIVING;
+}
+
+void IRAM_ATTR DHT22Sensor::edgeISRThunk(void* arg) {
+    static_cast<DHT22Sensor*>(arg)->handleFallingEdge();
+}
+
+void IRAM_ATTR DHT22Sensor::handleFallingEdge() {
+    if (state != RECEIVING || edgeCount >= EXPECTED_EDGES) {
+        return;
+    }
+
+    edgeTimesUs[edgeCount++] = esp_timer_get_time();
+
+    if (edgeCount == EXPECTED_EDGES) {
+        state = FRAME_READY;
+    }
+}
+
+void DHT22Sensor::decodeFrame() {
+    uint8_t bytes[5] = {0};
+
+    // Edge 0 is the response preamble; edges 1..41 bracket the 40 bit
+    // cells.
+    for (uint8_t bit = 0; bit < 40; bit++) {
+        int64_t cellUs = edgeTimesUs[bit + 2] - edgeTimesUs[bit + 1];
+        bytes[bit / 8] <<= 1;
+        if (cellUs > BIT_THRESHOLD_US) {
+            bytes[bit / 8] |= 1;
+        }
+    }
+
+    uint8_t checksum = bytes[0] + bytes[1] + bytes[2] + bytes[3];
+    if (checksum != bytes[4]) {
+        DEBUG_PRINTLN("DHT22 checksum mismatch");
+        lastReading.valid = false;
+        return;
+    }
+
+    uint16_t rawHumidity = ((uint16_t)bytes[0] << 8) | bytes[1];
+    uint16_t rawTemp = ((uint16_t)bytes[2] << 8) | bytes[3];
+
+    lastReading.humidity = rawHumidity / 10.0f;
+    lastReading.temperature = (rawTemp & 0x7FFF) / 10.0f;
+    if (rawTemp & 0x8000) {
+        lastReading.temperature = -lastReading.temperature;
+    }
+    lastReading.timestampMs = millis();
+    lastReading.valid = true;
+}
@@ -0,0 +1,74 @@
+#ifndef DHT22_SENSOR_H
+#define DHT22_SENSOR_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Non-blocking DHT22 driver. One combined read delivers temperature and
+// humidity from a single 40-bit frame, decoded from falling-edge
+// timestamps captured in an ISR — the caller never bit-bangs or blocks
+// on the sensor line.
+//
+// Usage: startRead() begins a transfer (the 2 ms host start pulse runs
+// on an esp_timer one-shot); call poll() until it returns true, then
+// fetch the result with latest().
+class DHT22Sensor {
+public:
+    struct Reading {
+        float temperature;
+        float humidity;
+        unsigned long timestampMs;
+        bool valid;
+    };
+
+    explicit DHT22Sensor(uint8_t pin);
+
+    void begin();
+
+    // Begins a read. Returns false if a read is in flight or the sensor
+    // is still inside its 2 s minimum sampling interval.
+    bool startRead();
+
+    // Advances the state machine (decode, timeout detection). Returns
+    // true once a read has completed — successfully or not — since the
+    // last call that returned true.
+    bool poll();
+
+    bool isBusy() const;
+    Reading latest() const;
+
+private:
+    enum State : uint8_t {
+        IDLE,           // line released, no transfer
+        START_PULSE,    // host holding the line low (esp_timer pending)
+        RECEIVING,      // ISR collecting falling-edge timestamps
+        FRAME_READY,    // 40 bits captured, awaiting decode in poll()
+    };
+
+    static void startPulseDone(void* arg);
+    static void IRAM_ATTR edgeISRThunk(void* arg);
+    void IRAM_ATTR handleFallingEdge();
+
+    void decodeFrame();
+
+    // Falling edges seen per transfer: response preamble, the start of
+    // each of the 40 bit cells, and the end-of-frame low. Intervals
+    // between consecutive bit-cell edges encode the bits (~78 us = 0,
+    // ~120 us = 1).
+    static const uint8_t EXPECTED_EDGES = 42;
+
+    uint8_t pin;
+    volatile State state;
+
+    volatile int64_t edgeTimesUs[EXPECTED_EDGES];
+    volatile uint8_t edgeCount;
+
+    esp_timer_handle_t startTimer;
+    int64_t transferStartUs;
+    unsigned long lastReadMs;
+
+    Reading lastReading;
+    bool readCompleted;
+};
+
+#endif // DHT22_SENSOR_H
@@ -0,0 +1,49 @@
+#ifndef EWMA_FILTER_H
+#define EWMA_FILTER_H
+
+#include <Arduino.h>
+
+// Exponentially-weighted moving average in Q16.16 fixed point:
+//   state += alpha * (sample - state)
+// with alpha in Q0.16 (65536 = 1.0). Integer-only so it is safe from
+// any future ISR context, where the Xtensa FPU is off limits. One
+// filter per channel smooths single-sample DHT22 noise before it can
+// flap auto mode — every flap being a PWM change, an NVS write, and a
+// BLE delta.
+
+class EwmaFilter {
+public:
+    // alphaQ16: smoothing factor in Q0.16; larger follows faster.
+    explicit EwmaFilter(uint32_t alphaQ16)
+        : alpha(alphaQ16), state(0), hasValue(false) {}
+
+    // Array-member form (SensorBank): configure with setAlpha().
+    EwmaFilter() : alpha(0), state(0), hasValue(false) {}
+    void setAlpha(uint32_t alphaQ16) { alpha = alphaQ16; }
+
+    // Feeds one sample, returns the filtered value. The first sample
+    // primes the state directly so there is no cold-start ramp.
+    float update(float sample) {
+        int32_t x = (int32_t)(sample * 65536.0f);
+        if (!hasValue) {
+            state = x;
+            hasValue = true;
+        } else {
+            // 48-bit intermediate: alpha (Q0.16) × delta (Q16.16).
+            int64_t delta = (int64_t)(x - state);
+            state += (int32_t)((delta * (int64_t)alpha) >> 16);
+        }
+        return value();
+    }
+
+    float value() const { return (float)state / 65536.0f; }
+    bool primed() const { return hasValue; }
+    void reset() { hasValue = false; }
+
+private:
+    uint32_t alpha; // Q0.16
+    int32_t state;  // Q16.16
+    bool hasValue;
+};
+
+#endif // EWMA_FILTER_H
@@ -0,0 +1,77 @@
+#ifndef MEDIAN_FILTER_H
+#define MEDIAN_FILTER_H
+
+#include <Arduino.h>
+
+// Median-of-5 over a circular buffer of recent ultrasonic echoes, with
+// a deviation gate in front of it. Soft furnishings scatter single
+// echoes tens of centimetres off, and one bad echo used to be enough
+// to trip PROXIMITY_THRESHOLD. The median absorbs up to two bad
+// samples per window; the gate rejects a sample that jumps more than
+// the configured deviation from the current median — unless the jump
+// persists for a full window of consecutive samples, which is a real
+// approach and is admitted so the filter can follow it.
+
+class MedianFilter {
+public:
+    static const uint8_t WINDOW = 5;
+
+    // maxDeviation: a sample further than this from the median is
+    // gated as an outlier (in the caller's units, here cm).
+    explicit MedianFilter(float maxDeviation)
+        : deviation(maxDeviation), head(0), count(0), outlierRun(0) {}
+
+    // Array-member form (SensorBank): configure with setDeviation().
+    MedianFilter() : deviation(0.0f), head(0), count(0), outlierRun(0) {}
+    void setDeviation(float maxDeviation) { deviation = maxDeviation; }
+
+    // Feeds one sample, returns the filtered value.
+    float update(float sample) {
+        if (count >= WINDOW && fabsf(sample - median()) > deviation) {
+            // Outlier: hold the median, but a whole window of
+            // consecutive outliers is a genuine step change.
+            if (++outlierRun < WINDOW) {
+                return median();
+            }
+        }
+        outlierRun = 0;
+
+        samples[head] = sample;
+        head = (head + 1) % WINDOW;
+        if (count < WINDOW) {
+            count++;
+        }
+        return median();
+    }
+
+    float value() const { return median(); }
+    bool primed() const { return count >= WINDOW; }
+    void reset() { count = 0; head = 0; outlierRun = 0; }
+
+private:
+    float median() const {
+        if (count == 0) {
+            return 0.0f;
+        }
+        // Insertion sort of a copy; at most 5 elements.
+        float sorted[WINDOW];
+        for (uint8_t i = 0; i < count; i++) {
+            float v = samples[i];
+            uint8_t j = i;
+            while (j > 0 && sorted[j - 1] > v) {
+                sorted[j] = sorted[j - 1];
+                j--;
+            }
+            sorted[j] = v;
+        }
+        return sorted[count / 2];
+    }
+
+    float samples[WINDOW];
+    float deviation;
+    uint8_t head;
+    uint8_t count;
+    uint8_t outlierRun; // consecutive gated samples
+};
+
+#endif // MEDIAN_FILTER_H
@@ -0,0 +1,112 @@
+#include "OccupancyEstimator.h"
+#include "ZoneClassifier.h"
+#include "../system/MonoClock.h"
+
+OccupancyEstimator::OccupancyEstimator()
+    : lastMotionMs(0),
+      haveMotion(false),
+      baselineCm(0.0f),
+      currentCm(0.0f),
+      haveDistance(false),
+      hourOfDay(-1),
+      lastZone(ZoneClassifier::ZONE_UNKNOWN) {
+}
+
+void OccupancyEstimator::noteZone(uint8_t zone) {
+    lastZone = zone;
+}
+
+void OccupancyEstimator::noteMotion(int64_t timestampMs) {
+    lastMotionMs = timestampMs;
+    haveMotion = true;
+}
+
+void OccupancyEstimator::noteDistance(float distanceCm) {
+    if (!haveDistance) {
+        baselineCm = distanceCm;
+        currentCm = distanceCm;
+        haveDistance = true;
+        return;
+    }
+
+    // Fast average tracks what is in the beam now; the baseline creeps
+    // slowly enough (1/64 per sample) that a person standing there for
+    // minutes does not become the new empty room.
+    currentCm += (distanceCm - currentCm) * 0.25f;
+    baselineCm += (distanceCm - baselineCm) * (1.0f / 64.0f);
+}
+
+void OccupancyEstimator::setHourOfDay(int8_t hour) {
+    hourOfDay = (hour >= 0 && hour <= 23) ? hour : -1;
+}
+
+// Full strength at the edge, fading linearly to zero over the decay
+// window — the same shape as the motion timeout.
+uint8_t OccupancyEstimator::pirScore() const {
+    if (!haveMotion) {
+        return 0;
+    }
+    int64_t elapsed = MonoClock::nowMs() - lastMotionMs;
+    if (elapsed >= OCCUPANCY_PIR_DECAY_MS) {
+        return 0;
+    }
+    return (uint8_t)(255 - (elapsed * 255) / OCCUPANCY_PIR_DECAY_MS);
+}
+
+// How far the fast average sits inside the empty-room baseline: a body
+// in the beam shortens the range. Scales linearly, saturating at twice
+// the configured delta.
+uint8_t OccupancyEstimator::distanceScore() const {
+    if (!haveDistance) {
+        return 0;
+    }
+    float closer = baselineCm - currentCm;
+    if (closer <= OCCUPANCY_DISTANCE_DELTA_CM * 0.5f) {
+        return 0;
+    }
+    float scaled = closer / (OCCUPANCY_DISTANCE_DELTA_CM * 2.0f);
+    if (scaled >= 1.0f) {
+        return 255;
+    }
+    return (uint8_t)(scaled * 255.0f);
+}
+
+uint8_t OccupancyEstimator::timeOfDayPrior() const {
+    if (hourOfDay < 0) {
+        return 128; // no RTC: neutral
+    }
+    bool active = hourOfDay >= OCCUPANCY_ACTIVE_HOUR_START &&
+                  hourOfDay < OCCUPANCY_ACTIVE_HOUR_END;
+    return active ? 192 : 32;
+}
+
+// A committed zone is the strongest still-occupant evidence: in the
+// bed bands it is a localized body, past the door band the room read
+// empty through a full dwell.
+uint8_t OccupancyEstimator::zoneScore() const {
+    switch (lastZone) {
+        case ZoneClassifier::ZONE_BED:
+        case ZoneClassifier::ZONE_BESIDE:
+            return 255;
+        case ZoneClassifier::ZONE_ROOM:
+            return 160;
+        case ZoneClassifier::ZONE_OUT:
+            return 0;
+        default:
+            return 128; // no classifier fix yet: neutral
+    }
+}
+
+// Weighted fusion: PIR carries most of the weight (it is the only
+// direct presence sensor), distance trend corroborates a still
+// occupant after PIR decays, and time of day only nudges. Once the
+// zone classifier has a fix, its verdict averages in at equal weight —
+// it is the only signal that survives a motionless night.
+uint8_t OccupancyEstimator::confidence() const {
+    uint32_t score = 6 * pirScore() + 3 * distanceScore() + 1 * timeOfDayPrior();
+    score /= 10;
+    if (lastZone != ZoneClassifier::ZONE_UNKNOWN) {
+        score = (score + zoneScore()) / 2;
+    }
+    return (uint8_t)score;
+}
@@ -0,0 +1,62 @@
+#ifndef OCCUPANCY_ESTIMATOR_H
+#define OCCUPANCY_ESTIMATOR_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Fuses the three presence signals the hardware already produces into
+// one confidence score (0-255):
+//
+//   - PIR edges: strong evidence, decaying linearly since the last one
+//   - distance trend: a fast EWMA of the (median-filtered) ultrasonic
+//     range against a slow empty-room baseline — a body between the
+//     unit and the far wall pulls the fast average down
+//   - time of day: a weak prior from the DS3231, low overnight
+//
+// Auto mode gates actuation on the score, so an empty room stops
+// paying fan/LED duty — and the NVS commit and BLE delta every
+// actuator change generates — for a warm afternoon.
+
+class OccupancyEstimator {
+public:
+    OccupancyEstimator();
+
+    // Called from the sensor task on each PIR rising edge, with a
+    // MonoClock::nowMs() stamp (widened from the ISR's 32-bit one).
+    void noteMotion(int64_t timestampMs);
+
+    // Called with each filtered distance reading.
+    void noteDistance(float distanceCm);
+
+    // Hour 0-23 from the RTC, or -1 when unavailable (neutral prior).
+    void setHourOfDay(int8_t hour);
+
+    // Committed zone transition from the classifier. A body localized
+    // in the bed or beside-bed band is direct presence evidence that
+    // outlives PIR decay — a sleeping occupant triggers neither PIR
+    // nor much distance delta, but holds ZONE_BED for hours.
+    void noteZone(uint8_t zone);
+
+    uint8_t confidence() const;
+    bool roomOccupied() const {
+        return confidence() >= OCCUPANCY_CONFIDENCE_MIN;
+    }
+
+private:
+    uint8_t pirScore() const;
+    uint8_t distanceScore() const;
+    uint8_t timeOfDayPrior() const;
+    uint8_t zoneScore() const;
+
+    int64_t lastMotionMs;
+    bool haveMotion;
+
+    float baselineCm;  // slow EWMA: empty-room geometry
+    float currentCm;   // fast EWMA: what is in front of us now
+    bool haveDistance;
+
+    int8_t hourOfDay;
+    uint8_t lastZone;  // ZoneClassifier::ZoneId, ZONE_UNKNOWN until fed
+};
+
+#endif // OCCUPANCY_ESTIMATOR_H
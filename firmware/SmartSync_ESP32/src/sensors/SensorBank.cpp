@@ -0,0 +1,239 @@
+#include "SensorBank.h"
+#if SENSOR_BANK_MOCK_DRIVERS
+// The profiler is cycle-counter hardware; on the host the mock ISR
+// cycle numbers are still read so the call site stays honest.
+#define PROFILER_RECORD(id, cycles) ((void)(cycles))
+#else
+#include "../system/Profiler.h"
+#define PROFILER_RECORD(id, cycles) Profiler::record(id, cycles)
+#endif
+
+static const uint8_t kDhtPins[SensorBank::DHT_COUNT] = DHT_SENSOR_PINS;
+static const uint8_t kTrigPins[SensorBank::ULTRA_COUNT] = ULTRASONIC_TRIG_PINS;
+static const uint8_t kEchoPins[SensorBank::ULTRA_COUNT] = ULTRASONIC_ECHO_PINS;
+
+SensorBank::SensorBank()
+    : calTempOffset(nullptr),
+      calHumOffset(nullptr),
+      calDistScale(nullptr),
+      soundRatioQ15(32768),
+      haveAirTemp(false),
+      acquireUs(0) {
+    memset(&dhtData, 0, sizeof(dhtData));
+    memset(&rangeData, 0, sizeof(rangeData));
+    memset(dhtFaults, 0, sizeof(dhtFaults));
+    memset(ultraFaults, 0, sizeof(ultraFaults));
+    memset(ultraGotEcho, 0, sizeof(ultraGotEcho));
+    memset(ultraStartMs, 0, sizeof(ultraStartMs));
+}
+
+void SensorBank::setCalibration(const int16_t* tempOffsetCenti,
+                                const int16_t* humOffsetCenti,
+                                const uint16_t* distScaleQ15) {
+    calTempOffset = tempOffsetCenti;
+    calHumOffset = humOffsetCenti;
+    calDistScale = distScaleQ15;
+}
+
+bool SensorBank::faultActive() const {
+    for (uint8_t i = 0; i < DHT_COUNT; i++) {
+        if (dhtFaults[i].backoff != 0) return true;
+    }
+    for (uint8_t i = 0; i < ULTRA_COUNT; i++) {
+        if (ultraFaults[i].backoff != 0) return true;
+    }
+    return false;
+}
+
+// Streak bookkeeping shared by both sensor types. A failed probe from
+// quarantine doubles the backoff; any success clears everything.
+void SensorBank::noteResult(FaultState& fault, bool ok, const char* what,
+                            uint8_t channel) {
+    if (ok) {
+        if (fault.backoff != 0) {
+            DEBUG_PRINTF("Sensor bank: %s %u recovered\n", what, channel);
+        }
+        fault.fails = 0;
+        fault.backoff = 0;
+        return;
+    }
+
+    if (fault.fails < 255) {
+        fault.fails++;
+    }
+    if (fault.fails < SENSOR_FAULT_THRESHOLD) {
+        return;
+    }
+
+    fault.backoff = (fault.backoff == 0)
+        ? SENSOR_FAULT_BACKOFF_START
+        : (uint16_t)min((int)fault.backoff * 2, SENSOR_FAULT_BACKOFF_MAX);
+    fault.skipCycles = fault.backoff;
+    DEBUG_PRINTF("Sensor bank: %s %u quarantined, next probe in %u cycles\n",
+                 what, channel, fault.backoff);
+}
+
+void SensorBank::begin() {
+    for (uint8_t i = 0; i < DHT_COUNT; i++) {
+        dhtSensors.emplace(i, kDhtPins[i]).begin();
+        tempFilters[i].setAlpha(EWMA_ALPHA_TEMP_Q16);
+        humFilters[i].setAlpha(EWMA_ALPHA_HUMIDITY_Q16);
+    }
+    for (uint8_t i = 0; i < ULTRA_COUNT; i++) {
+        ultraSensors.emplace(i, kTrigPins[i], kEchoPins[i]).begin();
+        rangeFilters[i].setDeviation(DISTANCE_OUTLIER_CM);
+    }
+    DEBUG_PRINTF("Sensor bank: %u DHT22, %u ultrasonic\n",
+                 DHT_COUNT, ULTRA_COUNT);
+}
+
+void SensorBank::acquire() {
+    int64_t t0 = esp_timer_get_time();
+
+    // One float evaluation per cycle; every sample then pays only the
+    // integer multiply in gatherAll().
+    if (haveAirTemp) {
+        soundRatioQ15 = soundSpeedRatioQ15(dhtData.temperature[0]);
+    }
+
+    // Round-robin the per-channel protothreads. The first pass runs
+    // every start back to back (ultrasonic triggers first, so their
+    // echoes overlap the DHT start pulse), then each pass advances
+    // whichever channels completed — one timed-out channel can never
+    // serialize the others behind its wait.
+    for (uint8_t i = 0; i < ULTRA_COUNT; i++) {
+        ultraPt[i].restart();
+    }
+    for (uint8_t i = 0; i < DHT_COUNT; i++) {
+        dhtPt[i].restart();
+    }
+    bool pending = true;
+    while (pending) {
+        pending = false;
+        for (uint8_t i = 0; i < ULTRA_COUNT; i++) {
+            pending |= stepUltrasonic(i);
+        }
+        for (uint8_t i = 0; i < DHT_COUNT; i++) {
+            pending |= stepDht(i);
+        }
+        if (pending) {
+            vTaskDelay(1);
+        }
+    }
+
+    applyFilters();
+
+    acquireUs = (uint32_t)(esp_timer_get_time() - t0);
+}
+
+// One DHT channel, start to fault note, as linear code. The transfer
+// itself runs in timer/ISR context; poll() embeds the whole-transfer
+// timeout, so the wait below always terminates.
+bool SensorBank::stepDht(uint8_t channel) {
+    Protothread* pt = &dhtPt[channel];
+    PT_BEGIN(pt);
+
+    dhtData.valid[channel] = 0;
+    if (dhtFaults[channel].skipCycles > 0) {
+        dhtFaults[channel].skipCycles--;
+        PT_EXIT(pt); // quarantined: no start, no wait, no fault note
+    }
+    if (!dhtSensors[channel].startRead()) {
+        PT_EXIT(pt); // inside the sensor's minimum sampling interval
+    }
+
+    PT_WAIT_UNTIL(pt, dhtSensors[channel].poll());
+
+    {
+        DHT22Sensor::Reading reading = dhtSensors[channel].latest();
+        if (reading.valid) {
+            // Per-unit trim in the centi-unit integer domain.
+            int32_t tCenti = (int32_t)(reading.temperature * 100.0f);
+            int32_t hCenti = (int32_t)(reading.humidity * 100.0f);
+            if (calTempOffset != nullptr) {
+                tCenti += calTempOffset[channel];
+                hCenti += calHumOffset[channel];
+            }
+            dhtData.timestampMs[channel] = reading.timestampMs;
+            dhtData.temperatureRaw[channel] = tCenti * 0.01f;
+            dhtData.humidityRaw[channel] = hCenti * 0.01f;
+            dhtData.valid[channel] = 1;
+        }
+        noteResult(dhtFaults[channel], reading.valid, "DHT22", channel);
+    }
+
+    PT_END(pt);
+}
+
+// One ultrasonic channel. The echo ISR posts the completion; a
+// channel with nothing in range either goes idle without a result or
+// rides the deadline out, and is then released with cancel().
+bool SensorBank::stepUltrasonic(uint8_t channel) {
+    Protothread* pt = &ultraPt[channel];
+    PT_BEGIN(pt);
+
+    rangeData.valid[channel] = 0;
+    if (ultraFaults[channel].skipCycles > 0) {
+        ultraFaults[channel].skipCycles--;
+        PT_EXIT(pt); // quarantined: no start, no wait, no fault note
+    }
+    if (!ultraSensors[channel].startMeasurement()) {
+        PT_EXIT(pt); // still busy from an out-of-cycle ping
+    }
+    ultraGotEcho[channel] = false;
+    ultraStartMs[channel] = millis();
+
+    PT_WAIT_UNTIL(pt,
+        (ultraGotEcho[channel] = ultraSensors[channel].pollResult()) ||
+        !ultraSensors[channel].isBusy() ||
+        (uint32_t)(millis() - ultraStartMs[channel]) >= ULTRASONIC_TIMEOUT_MS);
+
+    if (!ultraGotEcho[channel]) {
+        // The ISR drops busy before posting the completion; one more
+        // probe closes that window before the channel is written off.
+        ultraGotEcho[channel] = ultraSensors[channel].pollResult();
+    }
+    if (ultraGotEcho[channel]) {
+        // ISR self-timing, folded in from task context so the
+        // record itself never runs in the interrupt.
+        PROFILER_RECORD(PROF_ECHO_ISR, ultraSensors[channel].lastIsrCycles());
+        // Sound-speed compensation and per-unit scale: two integer
+        // multiplies in the millimetre domain.
+        int32_t mm = (int32_t)(ultraSensors[channel].lastDistanceCm() * 10.0f);
+        mm = (int32_t)(((int64_t)mm * soundRatioQ15) >> 15);
+        if (calDistScale != nullptr) {
+            mm = (int32_t)(((int64_t)mm * calDistScale[channel]) >> 15);
+        }
+        rangeData.timestampMs[channel] = millis();
+        rangeData.distanceRaw[channel] = mm * 0.1f;
+        rangeData.valid[channel] = 1;
+    } else {
+        ultraSensors[channel].cancel();
+    }
+    noteResult(ultraFaults[channel], rangeData.valid[channel] != 0,
+               "ultrasonic", channel);
+
+    PT_END(pt);
+}
+
+// Batch filter pass: straight runs over the raw arrays into the
+// filtered arrays, the layout the EWMA and median updates want.
+void SensorBank::applyFilters() {
+    for (uint8_t i = 0; i < DHT_COUNT; i++) {
+        if (dhtData.valid[i]) {
+            dhtData.temperature[i] =
+                tempFilters[i].update(dhtData.temperatureRaw[i]);
+            dhtData.humidity[i] =
+                humFilters[i].update(dhtData.humidityRaw[i]);
+            if (i == 0) {
+                haveAirTemp = true; // sound-speed source is live
+            }
+        }
+    }
+    for (uint8_t i = 0; i < ULTRA_COUNT; i++) {
+        if (rangeData.valid[i]) {
+            rangeData.distance[i] =
+                rangeFilters[i].update(rangeData.distanceRaw[i]);
+        }
+    }
+}
@@ -0,0 +1,151 @@
+#ifndef SENSOR_BANK_H
+#define SENSOR_BANK_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+#include "Calibration.h"
+#include "EwmaFilter.h"
+#include "MedianFilter.h"
+#include "SensorSet.h"
+#include "../system/Protothread.h"
+#if SENSOR_BANK_MOCK_DRIVERS
+// Host test builds (env:native) substitute scripted mocks with the
+// same class names and call surface, so the acquisition, quarantine
+// and filter logic below runs against waveforms the tests script
+// instead of live hardware. Resolved from test/native_stubs.
+#include "MockSensorDrivers.h"
+#else
+#include "DHT22Sensor.h"
+#include "UltrasonicSensor.h"
+#endif
+
+// N sensors per type, pinned from the tables in config.h — adding a
+// room/window DHT22 or a bed/door ultrasonic is a config entry, not a
+// code fork. Channel 0 is the primary that drives auto mode and
+// proximity.
+//
+// A channel that fails SENSOR_FAULT_THRESHOLD cycles in a row (a
+// degrading cable reads as NaN frames or echo timeouts forever) is
+// quarantined: it stops being started at all, reclaiming its share of
+// the acquisition window, and is probed for recovery on an
+// exponential backoff of cycles. Quarantine state surfaces through
+// faultActive() into the BLE frame's diagnostics flag.
+//
+// Samples live in struct-of-arrays layout: parallel arrays of
+// timestamps, values and validity, one slot per channel. Batch passes
+// — the filter update, a history flush, frame serialization — walk
+// one contiguous array per field instead of chasing per-sensor
+// objects through cache lines of unrelated driver state.
+
+class SensorBank {
+public:
+    static const uint8_t DHT_COUNT = DHT_SENSOR_COUNT;
+    static const uint8_t ULTRA_COUNT = ULTRASONIC_SENSOR_COUNT;
+
+    struct DhtSamples {
+        uint32_t timestampMs[DHT_COUNT];
+        float temperature[DHT_COUNT];     // EWMA-filtered
+        float humidity[DHT_COUNT];
+        float temperatureRaw[DHT_COUNT];
+        float humidityRaw[DHT_COUNT];
+        uint8_t valid[DHT_COUNT];         // fresh this cycle
+    };
+
+    struct RangeSamples {
+        uint32_t timestampMs[ULTRA_COUNT];
+        float distance[ULTRA_COUNT];      // median-filtered, cm
+        float distanceRaw[ULTRA_COUNT];
+        uint8_t valid[ULTRA_COUNT];
+    };
+
+    SensorBank();
+
+    // Constructs the driver instances from the config pin tables.
+    void begin();
+
+    // One pipelined acquisition cycle: every channel runs as a
+    // protothread stepped round-robin until all complete, then the
+    // filter pass runs. Wall time is the slowest channel, not the
+    // sum — the DHT frame, the ultrasonic echo and the start pulses
+    // all run concurrently in timer/ISR context.
+    void acquire();
+
+    // Wall time of the last acquire() for the timing budget.
+    uint32_t lastAcquireUs() const { return acquireUs; }
+
+    // True while any channel of any type is quarantined.
+    bool faultActive() const;
+
+    // Points the bank at the per-unit trim tables in the settings
+    // blob (one entry per channel, fixed point — Calibration.h).
+    // Applied at ingestion, so raw and filtered values are both
+    // calibrated. Null (the default) disables correction.
+    void setCalibration(const int16_t* tempOffsetCenti,
+                        const int16_t* humOffsetCenti,
+                        const uint16_t* distScaleQ15);
+
+    const DhtSamples& dht() const { return dhtData; }
+    const RangeSamples& range() const { return rangeData; }
+
+    // Direct driver access for out-of-cycle uses (high-rate sampling
+    // pings the primary ultrasonic between full acquisitions).
+    UltrasonicSensor* ultrasonic(uint8_t channel) {
+        return &ultraSensors[channel];
+    }
+
+private:
+    // One acquisition channel as a protothread (Protothread.h):
+    // quarantine skip, start, await completion, ingest, fault note —
+    // linear code per channel instead of start/gather stages handing
+    // state to each other through scratch arrays. acquire() steps the
+    // threads round-robin, so every start fires in the first pass and
+    // all the waits overlap.
+    bool stepDht(uint8_t channel);
+    bool stepUltrasonic(uint8_t channel);
+    void applyFilters();
+
+    // Per-channel fault tracking, parallel to the sample arrays. A
+    // quarantined channel has skipCycles > 0; backoff remembers the
+    // current probe interval so each failed probe doubles it.
+    struct FaultState {
+        uint8_t fails;       // consecutive failed cycles
+        uint16_t skipCycles; // cycles until the next recovery probe
+        uint16_t backoff;    // probe interval, 0 = healthy
+    };
+    void noteResult(FaultState& fault, bool ok, const char* what,
+                    uint8_t channel);
+
+    FaultState dhtFaults[DHT_COUNT];
+    FaultState ultraFaults[ULTRA_COUNT];
+
+    // Per-channel coroutine state plus what must survive a wait
+    // (protothread locals don't).
+    Protothread dhtPt[DHT_COUNT];
+    Protothread ultraPt[ULTRA_COUNT];
+    bool ultraGotEcho[ULTRA_COUNT];
+    uint32_t ultraStartMs[ULTRA_COUNT];
+
+    // Calibration tables (settings blob) and the per-cycle
+    // speed-of-sound ratio derived from the primary air temperature.
+    const int16_t* calTempOffset;
+    const int16_t* calHumOffset;
+    const uint16_t* calDistScale;
+    uint16_t soundRatioQ15;
+    bool haveAirTemp;
+
+    uint32_t acquireUs;
+
+    // Drivers live in place (SensorSet.h): concrete types, direct
+    // calls, no heap registration.
+    SensorSet<DHT22Sensor, DHT_COUNT> dhtSensors;
+    SensorSet<UltrasonicSensor, ULTRA_COUNT> ultraSensors;
+
+    DhtSamples dhtData;
+    RangeSamples rangeData;
+
+    EwmaFilter tempFilters[DHT_COUNT];
+    EwmaFilter humFilters[DHT_COUNT];
+    MedianFilter rangeFilters[ULTRA_COUNT];
+};
+
+#endif // SENSOR_BANK_H
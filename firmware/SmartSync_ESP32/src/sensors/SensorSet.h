@@ -0,0 +1,40 @@
+#ifndef SENSOR_SET_H
+#define SENSOR_SET_H
+
+#include <Arduino.h>
+#include <new>
+
+// Compile-time channel set: N drivers of one concrete type, stored in
+// place. The driver type is a template argument, not an interface, so
+// every call through the set is a direct (inlinable) call on the
+// concrete class — no vtable, no per-sample indirect branch — and the
+// full sensor list is known at link time, so an unused driver type is
+// dead-stripped with its ISRs. Adding a sensor type to the bank costs
+// one member declaration.
+//
+// Channels are constructed by emplace() at begin() time because the
+// pin arguments live in the config tables; the storage itself is
+// static, so registration never touches the heap. Drivers live for
+// the device's whole uptime and are never destroyed.
+template <typename Driver, uint8_t N>
+class SensorSet {
+public:
+    static const uint8_t COUNT = N;
+
+    template <typename... Args>
+    Driver& emplace(uint8_t channel, Args... args) {
+        return *(new (storage[channel]) Driver(args...));
+    }
+
+    Driver& operator[](uint8_t channel) {
+        return *reinterpret_cast<Driver*>(storage[channel]);
+    }
+    const Driver& operator[](uint8_t channel) const {
+        return *reinterpret_cast<const Driver*>(storage[channel]);
+    }
+
+private:
+    alignas(Driver) uint8_t storage[N][sizeof(Driver)];
+};
+
+#endif // SENSOR_SET_H
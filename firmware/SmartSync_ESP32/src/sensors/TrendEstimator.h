@@ -0,0 +1,70 @@
+#ifndef TREND_ESTIMATOR_H
+#define TREND_ESTIMATOR_H
+
+#include <Arduino.h>
+
+// Double-EWMA (Holt) trend estimator: a smoothed level plus a smoothed
+// slope, updated in O(1) with constant memory — two floats of state no
+// matter the effective window. The slope is kept per millisecond so
+// irregular sampling intervals (the adaptive cadence) update cleanly,
+// and projected() extrapolates the level along it.
+//
+// Auto mode acts on the 15-minute projection instead of the instant
+// reading, so on a hot afternoon the fan ramps while the room is
+// heading for uncomfortable rather than after it arrived.
+
+class TrendEstimator {
+public:
+    // alpha smooths the level, beta the slope; both 0..1, larger
+    // follows faster.
+    TrendEstimator(float alpha, float beta)
+        : alpha(alpha), beta(beta), level(0.0f), slopePerMs(0.0f),
+          lastMs(0), samples(0) {}
+
+    void update(float sample, uint32_t timestampMs) {
+        if (samples == 0) {
+            level = sample;
+            slopePerMs = 0.0f;
+            lastMs = timestampMs;
+            samples = 1;
+            return;
+        }
+
+        uint32_t dt = timestampMs - lastMs;
+        if (dt == 0) {
+            return;
+        }
+
+        float predicted = level + slopePerMs * (float)dt;
+        float prevLevel = level;
+        level = alpha * sample + (1.0f - alpha) * predicted;
+        slopePerMs = beta * ((level - prevLevel) / (float)dt) +
+                     (1.0f - beta) * slopePerMs;
+        lastMs = timestampMs;
+        if (samples < 255) {
+            samples++;
+        }
+    }
+
+    // Level extrapolated horizonMs into the future.
+    float projected(uint32_t horizonMs) const {
+        return level + slopePerMs * (float)horizonMs;
+    }
+
+    float slopePerMinute() const { return slopePerMs * 60000.0f; }
+
+    // Two samples establish a slope; require a few more before anyone
+    // acts on the projection.
+    bool primed() const { return samples >= 3; }
+    void reset() { samples = 0; }
+
+private:
+    float alpha;
+    float beta;
+    float level;
+    float slopePerMs;
+    uint32_t lastMs;
+    uint8_t samples;
+};
+
+#endif // TREND_ESTIMATOR_H
@@ -0,0 +1,121 @@
+#include "UltrasonicSensor.h"
+#include <xtensa/hal.h>
+#include "../system/PowerGovernor.h"
+
+UltrasonicSensor::UltrasonicSensor(uint8_t trigPin, uint8_t echoPin)
+    : trigPin(trigPin),
+      echoPin(echoPin),
+      busy(false),
+      echoStartUs(0),
+      lastDistMm(0),
+      isrCycles(0),
+      doneSemaphore(NULL),
+      completeCallback(nullptr) {
+}
+
+void UltrasonicSensor::begin() {
+    pinMode(trigPin, OUTPUT);
+    pinMode(echoPin, INPUT);
+    digitalWrite(trigPin, LOW);
+
+    doneSemaphore = xSemaphoreCreateBinary();
+
+    attachInterruptArg(digitalPinToInterrupt(echoPin), echoISRThunk, this, CHANGE);
+}
+
+bool UltrasonicSensor::startMeasurement() {
+    if (busy) {
+        return false;
+    }
+    busy = true;
+    // The echo window is pure time measurement; a DFS frequency switch
+    // mid-flight would stretch the trigger pulse and skew the cycle
+    // diagnostics. Pin full clock until the edge (or timeout) clears
+    // busy — every busy true->false transition below releases.
+    PowerGovernor::acquire(PowerGovernor::LOCK_ECHO);
+    echoStartUs = 0;
+    xSemaphoreTake(doneSemaphore, 0); // clear any stale completion
+
+    // 10 us trigger pulse; the echo is then captured entirely by the ISR.
+    digitalWrite(trigPin, LOW);
+    delayMicroseconds(2);
+    digitalWrite(trigPin, HIGH);
+    delayMicroseconds(10);
+    digitalWrite(trigPin, LOW);
+
+    return true;
+}
+
+bool UltrasonicSensor::waitForResult(uint32_t timeoutMs) {
+    if (xSemaphoreTake(doneSemaphore, pdMS_TO_TICKS(timeoutMs)) == pdTRUE) {
+        return true;
+    }
+    // Echo never came back (nothing in range); release for the next cycle.
+    busy = false;
+    PowerGovernor::release(PowerGovernor::LOCK_ECHO);
+    return false;
+}
+
+bool UltrasonicSensor::pollResult() {
+    return xSemaphoreTake(doneSemaphore, 0) == pdTRUE;
+}
+
+void UltrasonicSensor::cancel() {
+    if (busy) {
+        busy = false;
+        PowerGovernor::release(PowerGovernor::LOCK_ECHO);
+    }
+}
+
+bool UltrasonicSensor::isBusy() const {
+    return busy;
+}
+
+float UltrasonicSensor::lastDistanceCm() const {
+    return (float)lastDistMm / 10.0f;
+}
+
+void UltrasonicSensor::onComplete(void (*callback)(uint32_t)) {
+    completeCallback = callback;
+}
+
+void IRAM_ATTR UltrasonicSensor::echoISRThunk(void* arg) {
+    static_cast<UltrasonicSensor*>(arg)->handleEchoEdge();
+}
+
+void IRAM_ATTR UltrasonicSensor::handleEchoEdge() {
+    uint32_t c0 = xthal_get_ccount();
+    int64_t now = esp_timer_get_time();
+
+    if (digitalRead(echoPin) == HIGH) {
+        echoStartUs = now;
+        return;
+    }
+
+    if (!busy || echoStartUs == 0) {
+        return;
+    }
+
+    int64_t durationUs = now - echoStartUs;
+    // Fixed point: 58 us of round trip per cm at 343 m/s, so mm =
+    // us * 10 / 58. Integer throughout — the FPU must not be touched
+    // in ISR context, and the old float product here did exactly that.
+    lastDistMm = (uint32_t)((durationUs * 10) / 58);
+    busy = false;
+    PowerGovernor::release(PowerGovernor::LOCK_ECHO); // ISR-safe, IRAM
+
+    if (completeCallback) {
+        completeCallback(lastDistMm);
+    }
+
+    BaseType_t higherPriorityWoken = pdFALSE;
+    xSemaphoreGiveFromISR(doneSemaphore, &higherPriorityWoken);
+
+    // Own execution time; with everything IRAM-pinned this should be
+    // near constant, so jitter here is the cache-stall diagnostic.
+    isrCycles = xthal_get_ccount() - c0;
+
+    if (higherPriorityWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef ULTRASONIC_SENSOR_H
+#define ULTRASONIC_SENSOR_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// HC-SR04 driver that captures the echo pulse with edge interrupts and
+// esp_timer timestamps instead of pulseIn(), so the CPU never busy-waits
+// on the echo line. A measurement is started with startMeasurement();
+// the result arrives via the completion callback (ISR context) and the
+// internal done-semaphore, which waitForResult() blocks on cooperatively.
+class UltrasonicSensor {
+public:
+    UltrasonicSensor(uint8_t trigPin, uint8_t echoPin);
+
+    void begin();
+
+    // Fires the 10 us trigger pulse and arms the echo ISR.
+    // Returns false if a measurement is already in flight.
+    bool startMeasurement();
+
+    // Blocks (yielding the CPU) until the echo completes or times out.
+    // Returns true if a valid distance was captured.
+    bool waitForResult(uint32_t timeoutMs);
+
+    // Non-blocking completion probe for cooperative pollers (the
+    // protothread acquisition in SensorBank): true once the echo ISR
+    // has posted a result. Never releases the driver — when the echo
+    // doesn't come back, the poller calls cancel() at its deadline.
+    bool pollResult();
+
+    // Releases a measurement whose echo never arrived so the next
+    // cycle can start.
+    void cancel();
+
+    bool isBusy() const;
+    float lastDistanceCm() const;
+    uint32_t lastDistanceMm() const { return lastDistMm; }
+
+    // Execution cycles of the last completing echo ISR, entry to
+    // exit. The handler is IRAM-pinned, so the spread between runs is
+    // the flash-cache/stall jitter diagnostic: a widening max means
+    // ISR-path code or data fell out of internal RAM. SensorBank
+    // folds this into the PROF_ECHO_ISR histogram from task context.
+    uint32_t lastIsrCycles() const { return isrCycles; }
+
+    // Optional completion callback. Runs in ISR context — keep it
+    // short, IRAM-safe, and integer-only: the distance arrives in
+    // fixed-point millimetres because the FPU is off limits in ISRs.
+    void onComplete(void (*callback)(uint32_t distanceMm));
+
+private:
+    static void IRAM_ATTR echoISRThunk(void* arg);
+    void IRAM_ATTR handleEchoEdge();
+
+    uint8_t trigPin;
+    uint8_t echoPin;
+
+    volatile bool busy;
+    volatile int64_t echoStartUs;
+    volatile uint32_t lastDistMm;
+    volatile uint32_t isrCycles;
+
+    SemaphoreHandle_t doneSemaphore;
+    void (*completeCallback)(uint32_t);
+};
+
+#endif // ULTRASONIC_SENSOR_H
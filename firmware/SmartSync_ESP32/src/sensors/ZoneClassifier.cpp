@@ -0,0 +1,56 @@
+#include "ZoneClassifier.h"
+
+ZoneClassifier::ZoneClassifier()
+    : currentZone(ZONE_UNKNOWN),
+      prevZone(ZONE_UNKNOWN),
+      candidateZone(ZONE_UNKNOWN),
+      candidateSinceMs(0),
+      enteredMs(0),
+      dwellMs(0),
+      transitionCount(0) {
+}
+
+uint8_t ZoneClassifier::classify(uint16_t distMm) const {
+    static const uint16_t bounds[3] = {
+        ZONE_BED_MAX_MM, ZONE_BESIDE_MAX_MM, ZONE_DOOR_MAX_MM,
+    };
+
+    for (uint8_t z = 0; z < 3; z++) {
+        int32_t edge = bounds[z];
+        // Each edge leans toward the zone we are already in, so a
+        // reading hovering on a boundary can't oscillate. No lean
+        // before the first commit.
+        if (currentZone != ZONE_UNKNOWN) {
+            edge += (currentZone <= z) ? ZONE_HYSTERESIS_MM
+                                       : -ZONE_HYSTERESIS_MM;
+        }
+        if ((int32_t)distMm < edge) {
+            return z;
+        }
+    }
+    return ZONE_OUT;
+}
+
+bool ZoneClassifier::feed(uint16_t distMm, uint32_t nowMs) {
+    uint8_t raw = classify(distMm);
+
+    if (raw == currentZone) {
+        candidateZone = currentZone; // an interrupted dwell starts over
+        return false;
+    }
+    if (raw != candidateZone) {
+        candidateZone = raw;
+        candidateSinceMs = nowMs;
+        return false;
+    }
+    if (nowMs - candidateSinceMs < ZONE_MIN_DWELL_MS) {
+        return false;
+    }
+
+    prevZone = currentZone;
+    dwellMs = (currentZone == ZONE_UNKNOWN) ? 0 : nowMs - enteredMs;
+    currentZone = raw;
+    enteredMs = nowMs;
+    transitionCount++;
+    return true;
+}
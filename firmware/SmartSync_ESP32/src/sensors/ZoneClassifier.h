@@ -0,0 +1,56 @@
+#ifndef ZONE_CLASSIFIER_H
+#define ZONE_CLASSIFIER_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Classifies the filtered ultrasonic range into semantic zones —
+// in bed, beside the bed, room / near the door, out of range — so the
+// app (and the occupancy estimator) consume transitions instead of
+// interpreting the raw distance stream themselves. Steady state
+// publishes nothing: a sleeping occupant is one ZONE_BED entry event,
+// not a night of identical distance frames.
+//
+// Evaluation is integer millimetres throughout (the same fixed point
+// the echo ISR produces). Two anti-flap stages, in the spirit of the
+// auto-mode dwell logic: each band edge shifts by ZONE_HYSTERESIS_MM
+// in favour of the current zone, and a new zone must hold for
+// ZONE_MIN_DWELL_MS of consecutive samples before the transition
+// commits — a hand waved through the beam classifies as nothing.
+class ZoneClassifier {
+public:
+    enum ZoneId : uint8_t {
+        ZONE_BED = 0,    // closer than ZONE_BED_MAX_MM
+        ZONE_BESIDE = 1, // up to ZONE_BESIDE_MAX_MM
+        ZONE_ROOM = 2,   // up to ZONE_DOOR_MAX_MM (near the door)
+        ZONE_OUT = 3,    // beyond every band: room reads empty
+        ZONE_UNKNOWN = 4,
+    };
+
+    ZoneClassifier();
+
+    // One call per valid range sample. Returns true when a transition
+    // committed; zone()/previousZone()/lastDwellMs() then describe it.
+    bool feed(uint16_t distMm, uint32_t nowMs);
+
+    uint8_t zone() const { return currentZone; }
+    uint8_t previousZone() const { return prevZone; }
+
+    // Time spent in the zone just left, valid after feed() returns true.
+    uint32_t lastDwellMs() const { return dwellMs; }
+
+    uint16_t transitions() const { return transitionCount; }
+
+private:
+    uint8_t classify(uint16_t distMm) const;
+
+    uint8_t currentZone;
+    uint8_t prevZone;
+    uint8_t candidateZone;
+    uint32_t candidateSinceMs; // first sample that voted candidateZone
+    uint32_t enteredMs;        // when currentZone committed
+    uint32_t dwellMs;
+    uint16_t transitionCount;
+};
+
+#endif // ZONE_CLASSIFIER_H
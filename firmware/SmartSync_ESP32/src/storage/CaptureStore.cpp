@@ -0,0 +1,249 @@
+#include "CaptureStore.h"
+#include <esp32/rom/crc.h>
+#include <esp_heap_caps.h>
+#include "PartitionMap.h"
+#include "../system/FlashOpStats.h"
+
+#define CAPTURE_SECTOR_SIZE 4096
+
+// Worst case per encoded sample: 5-byte Δtimestamp varint, 3-byte
+// Δdistance zigzag varint, type, flags. The first sample is verbatim.
+#define CAPTURE_WORST_PER_SAMPLE 10
+#define CAPTURE_FIRST_SAMPLE_BYTES 8
+
+// Records shorter than this are noise, not a training window.
+#define CAPTURE_MIN_SAMPLES 8
+
+static uint32_t align4(uint32_t value) {
+    return (value + 3) & ~(uint32_t)3;
+}
+
+CaptureStore::CaptureStore()
+    : partition(nullptr),
+      scratch(nullptr),
+      encoded(nullptr),
+      encodedCap(0),
+      writeOffset(0),
+      nextSeq(1),
+      lastCaptureMs(0),
+      captures(0),
+      drops(0) {
+}
+
+bool CaptureStore::begin() {
+    partition = PartitionMap::find(PARTITION_LABEL_CAPTURE);
+    if (partition == nullptr) {
+        return false;
+    }
+
+    // Scratch lives in PSRAM next to the ring it snapshots; the
+    // encoded image is sized for the worst case so encoding can never
+    // overrun.
+    encodedCap = CAPTURE_FIRST_SAMPLE_BYTES +
+                 (uint32_t)(CAPTURE_WINDOW_SAMPLES - 1) *
+                     CAPTURE_WORST_PER_SAMPLE;
+    scratch = (HighRateSample*)heap_caps_malloc(
+        CAPTURE_WINDOW_SAMPLES * sizeof(HighRateSample), MALLOC_CAP_SPIRAM);
+    if (scratch == nullptr) {
+        scratch = (HighRateSample*)malloc(CAPTURE_WINDOW_SAMPLES *
+                                          sizeof(HighRateSample));
+    }
+    encoded = (uint8_t*)heap_caps_malloc(encodedCap, MALLOC_CAP_SPIRAM);
+    if (encoded == nullptr) {
+        encoded = (uint8_t*)malloc(encodedCap);
+    }
+    if (scratch == nullptr || encoded == nullptr) {
+        DEBUG_PRINTLN("Capture store disabled: no scratch memory");
+        partition = nullptr;
+        return false;
+    }
+
+    findAppendPosition();
+    DEBUG_PRINTF("Capture store ready: next seq %u at offset 0x%x\n",
+                 nextSeq, writeOffset);
+    return true;
+}
+
+// Walks the log from the partition base: contiguous valid headers up
+// to the first blank one. Records beyond the current lap's frontier
+// (left over from before the last wrap) are unreachable and simply
+// age out as the lap overwrites them.
+void CaptureStore::findAppendPosition() {
+    uint32_t offset = 0;
+    while (offset + sizeof(CaptureHeader) <= partition->size) {
+        CaptureHeader header;
+        if (esp_partition_read(partition, offset, &header,
+                               sizeof(header)) != ESP_OK) {
+            break;
+        }
+        if (header.magic != CAPTURE_MAGIC ||
+            header.encodedLen > partition->size - offset -
+                                    sizeof(CaptureHeader)) {
+            break;
+        }
+        if (header.sequence >= nextSeq) {
+            nextSeq = header.sequence + 1;
+        }
+        offset += align4(sizeof(CaptureHeader) + header.encodedLen);
+    }
+    writeOffset = offset;
+}
+
+// First sample verbatim, then Δtimestamp (always forward, plain
+// varint) and Δdistance (zigzag — 0xFFFF no-echo markers swing both
+// ways) plus the raw type and flags bytes. Adjacent high-rate samples
+// are near-identical, so most samples cost 4 bytes against 8 raw.
+uint16_t CaptureStore::encodeSamples(const HighRateSample* samples,
+                                     uint16_t count, uint8_t* out,
+                                     uint16_t cap) const {
+    uint16_t len = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        const HighRateSample& s = samples[i];
+        if (i == 0) {
+            memcpy(out + len, &s.timestampMs, 4);
+            memcpy(out + len + 4, &s.distance, 2);
+            out[len + 6] = s.type;
+            out[len + 7] = s.flags;
+            len += CAPTURE_FIRST_SAMPLE_BYTES;
+            continue;
+        }
+        if ((uint32_t)len + CAPTURE_WORST_PER_SAMPLE > cap) {
+            break; // sized never to happen; belt and braces
+        }
+        uint32_t dt = s.timestampMs - samples[i - 1].timestampMs;
+        while (dt >= 0x80) {
+            out[len++] = (uint8_t)(dt | 0x80);
+            dt >>= 7;
+        }
+        out[len++] = (uint8_t)dt;
+
+        int32_t dd = (int32_t)s.distance - (int32_t)samples[i - 1].distance;
+        uint32_t zz = ((uint32_t)dd << 1) ^ (uint32_t)(dd >> 31);
+        while (zz >= 0x80) {
+            out[len++] = (uint8_t)(zz | 0x80);
+            zz >>= 7;
+        }
+        out[len++] = (uint8_t)zz;
+
+        out[len++] = s.type;
+        out[len++] = s.flags;
+    }
+    return len;
+}
+
+// Sectors are erased as the record claims them — each erased once per
+// lap, exactly the history log's wear pattern. A record from the
+// previous lap that loses its payload to an erase fails its CRC at
+// export and is dropped there.
+void CaptureStore::eraseRange(uint32_t offset, uint32_t length) {
+    uint32_t sector = offset & ~(uint32_t)(CAPTURE_SECTOR_SIZE - 1);
+    if (sector != offset) {
+        sector += CAPTURE_SECTOR_SIZE; // current sector already erased
+    }
+    while (sector < offset + length) {
+        FLASH_OP_SCOPE(FLASH_CAPTURE_ERASE);
+        esp_partition_erase_range(partition, sector, CAPTURE_SECTOR_SIZE);
+        sector += CAPTURE_SECTOR_SIZE;
+    }
+}
+
+void CaptureStore::capture(uint8_t trigger, uint16_t value,
+                           HighRateRing* ring) {
+    if (partition == nullptr || ring == nullptr || !ring->isReady()) {
+        return;
+    }
+    uint32_t now = millis();
+    if (captures != 0 && now - lastCaptureMs < CAPTURE_MIN_GAP_MS) {
+        // A trigger this soon sits inside the previous record's
+        // window; writing it again would double the flash cost for
+        // the same trace.
+        drops++;
+        return;
+    }
+
+    uint16_t count =
+        (uint16_t)ring->copyLatest(scratch, CAPTURE_WINDOW_SAMPLES);
+    if (count < CAPTURE_MIN_SAMPLES) {
+        drops++;
+        return;
+    }
+
+    CaptureHeader header;
+    header.magic = CAPTURE_MAGIC;
+    header.sequence = nextSeq;
+    header.timestampMs = now;
+    header.trigger = trigger;
+    header.reserved = 0;
+    header.value = value;
+    header.sampleCount = count;
+    header.encodedLen = encodeSamples(scratch, count, encoded, encodedCap);
+    header.crc = crc32_le(0, encoded, header.encodedLen);
+
+    uint32_t total = align4(sizeof(header) + header.encodedLen);
+    if (writeOffset + total > partition->size) {
+        writeOffset = 0; // wrap; the lap starts over
+    }
+    eraseRange(writeOffset, total);
+
+    {
+        FLASH_OP_SCOPE(FLASH_CAPTURE_WRITE);
+        if (esp_partition_write(partition, writeOffset, &header,
+                                sizeof(header)) != ESP_OK ||
+            esp_partition_write(partition, writeOffset + sizeof(header),
+                                encoded, header.encodedLen) != ESP_OK) {
+            DEBUG_PRINTLN("Capture write failed");
+            drops++;
+            return;
+        }
+    }
+
+    writeOffset += total;
+    nextSeq++;
+    captures++;
+    lastCaptureMs = now;
+    DEBUG_PRINTF("Capture %u: trigger %u, %u samples in %u bytes\n",
+                 header.sequence, trigger, count, header.encodedLen);
+}
+
+CaptureStore::Cursor CaptureStore::firstRecord() const {
+    Cursor cursor;
+    cursor.offset = 0;
+    cursor.valid = partition != nullptr;
+    return cursor;
+}
+
+bool CaptureStore::readHeader(const Cursor& cursor, CaptureHeader& out) const {
+    if (partition == nullptr || !cursor.valid ||
+        cursor.offset + sizeof(CaptureHeader) > partition->size) {
+        return false;
+    }
+    if (esp_partition_read(partition, cursor.offset, &out,
+                           sizeof(out)) != ESP_OK) {
+        return false;
+    }
+    return out.magic == CAPTURE_MAGIC &&
+           out.encodedLen <=
+               partition->size - cursor.offset - sizeof(CaptureHeader);
+}
+
+uint16_t CaptureStore::readPayload(const Cursor& cursor, uint16_t at,
+                                   uint8_t* out, uint16_t maxLen) const {
+    if (partition == nullptr || !cursor.valid) {
+        return 0;
+    }
+    if (esp_partition_read(partition,
+                           cursor.offset + sizeof(CaptureHeader) + at, out,
+                           maxLen) != ESP_OK) {
+        return 0;
+    }
+    return maxLen;
+}
+
+void CaptureStore::nextRecord(Cursor& cursor) const {
+    CaptureHeader header;
+    if (!readHeader(cursor, header)) {
+        cursor.valid = false;
+        return;
+    }
+    cursor.offset += align4(sizeof(CaptureHeader) + header.encodedLen);
+}
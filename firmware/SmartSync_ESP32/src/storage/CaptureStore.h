@@ -0,0 +1,86 @@
+#ifndef CAPTURE_STORE_H
+#define CAPTURE_STORE_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "../../include/config.h"
+#include "HighRateRing.h"
+
+// Labeled training windows for the ml/ pipeline. ml/data is populated
+// by hand today; the traces that actually matter — the minutes around
+// a fall, a breach, a motion timeout — are exactly the ones nobody is
+// standing by to record. So the alarm path triggers a capture: the
+// most recent CAPTURE_WINDOW_SAMPLES of the PSRAM high-rate ring are
+// frozen into one compressed flash record, tagged with the alarm type
+// that labeled them, and exported in bulk over the history-sync
+// channel next time the app connects. Nothing streams continuously;
+// flash only sees the interesting windows.
+//
+// Records are delta-varint encoded (the HistoryEncoder idea applied
+// to HighRateSample: first sample verbatim, then Δtimestamp and
+// Δdistance per sample), appended sequentially, and wrap the capture
+// partition like the history log wraps its own — oldest records give
+// way, each sector erased once per lap. The payload CRC in the header
+// keeps a record torn by a wrap erase from reaching the exporter.
+
+// Precedes each record's encoded payload. Blank flash (0xFFFFFFFF
+// magic) marks the end of the log.
+struct __attribute__((packed)) CaptureHeader {
+    uint32_t magic;       // CAPTURE_MAGIC
+    uint32_t sequence;    // monotonic, never 0xFFFFFFFF
+    uint32_t timestampMs; // trigger time, device millis()
+    uint8_t trigger;      // AlarmSystem::AlarmType that labeled it
+    uint8_t reserved;
+    uint16_t value;       // event-specific (distance cm, quiet minutes)
+    uint16_t sampleCount;
+    uint16_t encodedLen;  // payload bytes following this header
+    uint32_t crc;         // CRC-32 over the payload
+};
+
+class CaptureStore {
+public:
+    CaptureStore();
+
+    // Locates the partition, scans for the append position, and
+    // allocates the sample scratch in PSRAM (internal fallback).
+    bool begin();
+
+    // Freezes the ring's most recent window into one record. Rate
+    // limited by CAPTURE_MIN_GAP_MS; a trigger inside the gap is
+    // already inside the previous record's window anyway.
+    void capture(uint8_t trigger, uint16_t value, HighRateRing* ring);
+
+    // Read side for the export task: walk records oldest-first and
+    // read each one (header + payload) as raw bytes the host decodes.
+    struct Cursor {
+        uint32_t offset; // record start, byte offset into the partition
+        bool valid;
+    };
+    Cursor firstRecord() const;
+    bool readHeader(const Cursor& cursor, CaptureHeader& out) const;
+    uint16_t readPayload(const Cursor& cursor, uint16_t at, uint8_t* out,
+                         uint16_t maxLen) const;
+    void nextRecord(Cursor& cursor) const;
+
+    bool isReady() const { return partition != nullptr; }
+    uint32_t captureCount() const { return captures; }
+    uint32_t dropCount() const { return drops; }
+
+private:
+    uint16_t encodeSamples(const HighRateSample* samples, uint16_t count,
+                           uint8_t* out, uint16_t cap) const;
+    void eraseRange(uint32_t offset, uint32_t length);
+    void findAppendPosition();
+
+    const esp_partition_t* partition;
+    HighRateSample* scratch;  // CAPTURE_WINDOW_SAMPLES, PSRAM
+    uint8_t* encoded;         // worst-case encoding of the scratch
+    uint32_t encodedCap;
+    uint32_t writeOffset;
+    uint32_t nextSeq;
+    uint32_t lastCaptureMs;
+    uint32_t captures;        // records written since boot
+    uint32_t drops;           // rate-limited or failed triggers
+};
+
+#endif // CAPTURE_STORE_H
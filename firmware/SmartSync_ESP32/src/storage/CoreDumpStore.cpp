@@ -0,0 +1,53 @@
+#include "CoreDumpStore.h"
+#include <esp_core_dump.h>
+
+CoreDumpStore::CoreDumpStore()
+    : partition(nullptr),
+      dumpSize(0) {
+}
+
+bool CoreDumpStore::begin() {
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                         ESP_PARTITION_SUBTYPE_DATA_COREDUMP,
+                                         NULL);
+    if (partition == nullptr) {
+        // Unit still on a partition table without the coredump slot;
+        // everything degrades to "no dump".
+        DEBUG_PRINTLN("CoreDump: no partition");
+        return false;
+    }
+
+    // The IDF validates the image (header + CRC), so a blank or torn
+    // partition reads as no dump rather than garbage.
+    size_t addr = 0;
+    size_t size = 0;
+    if (esp_core_dump_image_get(&addr, &size) == ESP_OK && size > 0) {
+        dumpSize = (uint32_t)size;
+        DEBUG_PRINTF("CoreDump: %u-byte dump from previous crash\n",
+                     dumpSize);
+    }
+    return true;
+}
+
+uint32_t CoreDumpStore::read(uint32_t offset, uint8_t* out,
+                             uint32_t length) const {
+    if (partition == nullptr || offset >= dumpSize) {
+        return 0;
+    }
+    if (length > dumpSize - offset) {
+        length = dumpSize - offset;
+    }
+    if (esp_partition_read(partition, offset, out, length) != ESP_OK) {
+        return 0;
+    }
+    return length;
+}
+
+void CoreDumpStore::erase() {
+    if (partition == nullptr) {
+        return;
+    }
+    esp_partition_erase_range(partition, 0, partition->size);
+    dumpSize = 0;
+    DEBUG_PRINTLN("CoreDump: erased");
+}
@@ -0,0 +1,38 @@
+#ifndef CORE_DUMP_STORE_H
+#define CORE_DUMP_STORE_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "../../include/config.h"
+
+// Crash core dumps, retrievable without a serial cable. The IDF panic
+// handler writes a dump to the coredump partition as the unit dies;
+// on the next boot this store notices it, the sensor frame raises
+// SENSOR_FLAG_COREDUMP, and the app pulls the dump over the chunked
+// BLE channel (CMD_GET_COREDUMP) for offline decoding with
+// espcoredump.py — an actionable backtrace instead of "it rebooted
+// sometime last week".
+class CoreDumpStore {
+public:
+    CoreDumpStore();
+
+    // Probes the coredump partition for a valid image.
+    bool begin();
+
+    bool hasDump() const { return dumpSize != 0; }
+    uint32_t size() const { return dumpSize; }
+
+    // Reads length bytes of the dump image at offset; returns bytes
+    // actually read (0 past the end or on a flash error).
+    uint32_t read(uint32_t offset, uint8_t* out, uint32_t length) const;
+
+    // Erases the partition once the app has the dump, clearing the
+    // sensor-frame flag with it.
+    void erase();
+
+private:
+    const esp_partition_t* partition;
+    uint32_t dumpSize;
+};
+
+#endif // CORE_DUMP_STORE_H
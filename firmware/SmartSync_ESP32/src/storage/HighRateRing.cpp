@@ -0,0 +1,57 @@
+#include "HighRateRing.h"
+#include <esp_heap_caps.h>
+
+HighRateRing::HighRateRing()
+    : buffer(nullptr),
+      cap(0),
+      head(0),
+      filled(0),
+      lock(portMUX_INITIALIZER_UNLOCKED) {
+}
+
+bool HighRateRing::begin() {
+    // One allocation at boot; steady state never touches the heap.
+    buffer = (HighRateSample*)heap_caps_malloc(HIGHRATE_RING_BYTES,
+                                               MALLOC_CAP_SPIRAM);
+    if (buffer == nullptr) {
+        DEBUG_PRINTLN("HighRateRing: no PSRAM available");
+        return false;
+    }
+
+    cap = HIGHRATE_RING_BYTES / sizeof(HighRateSample);
+    DEBUG_PRINTF("HighRateRing: %u samples (%u KB PSRAM)\n",
+                 cap, HIGHRATE_RING_BYTES / 1024);
+    return true;
+}
+
+void HighRateRing::push(const HighRateSample& sample) {
+    if (buffer == nullptr) {
+        return;
+    }
+
+    portENTER_CRITICAL(&lock);
+    buffer[head] = sample;
+    head = (head + 1) % cap;
+    if (filled < cap) {
+        filled++;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+size_t HighRateRing::copyLatest(HighRateSample* out, size_t maxCount) const {
+    if (buffer == nullptr) {
+        return 0;
+    }
+
+    portENTER_CRITICAL(&lock);
+    size_t n = (maxCount < filled) ? maxCount : filled;
+
+    // Oldest-first: start n samples behind the head, wrapping.
+    size_t start = (head + cap - n) % cap;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = buffer[(start + i) % cap];
+    }
+    portEXIT_CRITICAL(&lock);
+
+    return n;
+}
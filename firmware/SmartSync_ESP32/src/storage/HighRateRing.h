@@ -0,0 +1,54 @@
+#ifndef HIGH_RATE_RING_H
+#define HIGH_RATE_RING_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Ring buffer in external PSRAM (the board builds with
+// -DBOARD_HAS_PSRAM) holding high-rate samples: per-second ultrasonic
+// distance and PIR transitions, far denser than the 10 s history-log
+// snapshots. The planned fall-detection analysis reads recent motion
+// at full rate with zero flash writes; overflow overwrites the oldest
+// region, so steady state allocates nothing.
+
+// 8 bytes; HIGHRATE_RING_BYTES / 8 samples ≈ 9 h at 1 Hz for 256 KB.
+struct __attribute__((packed)) HighRateSample {
+    uint32_t timestampMs;   // device millis() at capture
+    uint16_t distance;      // cm × 10 (0xFFFF: no echo / PIR-only)
+    uint8_t type;           // HighRateSampleType
+    uint8_t flags;          // PIR level in bit 0
+};
+
+enum HighRateSampleType : uint8_t {
+    HIGHRATE_DISTANCE = 0x01,
+    HIGHRATE_PIR_EDGE = 0x02,
+};
+
+class HighRateRing {
+public:
+    HighRateRing();
+
+    // Allocates the ring in PSRAM; false when no external RAM is fitted.
+    bool begin();
+
+    // Single-writer push from the sensor task; oldest sample is
+    // overwritten once the ring is full.
+    void push(const HighRateSample& sample);
+
+    // Copies up to maxCount of the most recent samples (oldest first).
+    // Returns the number copied.
+    size_t copyLatest(HighRateSample* out, size_t maxCount) const;
+
+    size_t count() const { return filled; }
+    size_t capacity() const { return cap; }
+    bool isReady() const { return buffer != nullptr; }
+
+private:
+    HighRateSample* buffer;
+    size_t cap;      // samples
+    size_t head;     // next write index
+    size_t filled;
+    mutable portMUX_TYPE lock;
+};
+
+#endif // HIGH_RATE_RING_H
@@ -0,0 +1,403 @@
+#include "HistoryLog.h"
+#include "PartitionMap.h"
+#include "../system/FlashOpStats.h"
+
+#define HISTORY_SECTOR_SIZE 4096
+#define HISTORY_PAGE_SIZE 256 // matches sizeof(HistoryLog::batch)
+#define HISTORY_BLANK_SEQ 0xFFFFFFFFu
+
+HistoryLog::HistoryLog()
+    : partition(nullptr),
+      mapped(nullptr),
+      logSize(0),
+      writeOffset(0),
+      nextSeq(0),
+      erases(0),
+      preparedOffset(0),
+      preparedValid(false),
+      index(nullptr),
+      indexCap(0),
+      indexTail(0),
+      indexCount(0),
+      batchLen(0) {
+}
+
+uint32_t HistoryLog::sectorCount() const {
+    return partition ? logSize / HISTORY_SECTOR_SIZE : 0;
+}
+
+void HistoryLog::eraseSector(uint32_t offset) {
+    FLASH_OP_SCOPE(FLASH_HISTORY_ERASE);
+    esp_partition_erase_range(partition, offset, HISTORY_SECTOR_SIZE);
+    erases++;
+    evictIndexForSector(offset);
+}
+
+// ============================================================================
+// MOUNT
+// ============================================================================
+bool HistoryLog::begin() {
+    // Dedicated history partition from partitions_smartsync.csv; units
+    // still on the old min_spiffs table fall back to the (unused)
+    // SPIFFS partition until their next full flash.
+    partition = PartitionMap::find(PARTITION_LABEL_HISTORY);
+    if (partition == nullptr) {
+        partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                             ESP_PARTITION_SUBTYPE_DATA_SPIFFS,
+                                             NULL);
+    }
+    if (partition == nullptr) {
+        DEBUG_PRINTLN("History: no data partition found");
+        return false;
+    }
+
+    // Zero-copy reads: the whole partition mapped into the data
+    // address space. Falls back to esp_partition_read when mapping
+    // fails (address space pressure).
+    spi_flash_mmap_handle_t mmapHandle;
+    mapped = (const uint8_t*)PartitionMap::map(partition->label, &mmapHandle);
+
+    // The tail sectors belong to the rollup streams (RollupStore); a
+    // head that scanned into them before the split is re-homed by the
+    // page-boundary clamp below.
+    logSize = partition->size -
+              (uint32_t)(HISTORY_ROLLUP_MINUTE_SECTORS +
+                         HISTORY_ROLLUP_HOUR_SECTORS) * HISTORY_SECTOR_SIZE;
+
+    findAppendPosition();
+    buildIndex();
+
+    DEBUG_PRINTF("History: %u KB at 0x%X, next seq %u, %u index entries\n",
+                 logSize / 1024, partition->address, nextSeq,
+                 indexCount);
+    return true;
+}
+
+bool HistoryLog::recordAt(uint32_t offset, HistoryRecord& out) {
+    if (mapped != nullptr) {
+        memcpy(&out, mapped + offset, sizeof(out));
+    } else if (esp_partition_read(partition, offset, &out,
+                                  sizeof(out)) != ESP_OK) {
+        return false;
+    }
+    return out.sequence != HISTORY_BLANK_SEQ;
+}
+
+bool HistoryLog::firstRecordOfSector(uint32_t sector, HistoryRecord& out) {
+    return recordAt(sector * HISTORY_SECTOR_SIZE, out);
+}
+
+// The log is circular, so sector-leading sequence numbers increase up
+// to the write head and drop after it. One read per sector finds the
+// head's sector; one scan inside finds the exact append offset.
+void HistoryLog::findAppendPosition() {
+    uint32_t sectorCount = logSize / HISTORY_SECTOR_SIZE;
+    uint32_t headSector = 0;
+    uint32_t highestSeq = 0;
+    bool anyData = false;
+
+    HistoryRecord rec;
+    for (uint32_t s = 0; s < sectorCount; s++) {
+        if (!firstRecordOfSector(s, rec)) {
+            continue; // blank sector
+        }
+        anyData = true;
+        if (rec.sequence >= highestSeq) {
+            highestSeq = rec.sequence;
+            headSector = s;
+        }
+    }
+
+    if (!anyData) {
+        // Fresh partition: start at the beginning, erase the first
+        // sector in case it holds stale SPIFFS data.
+        eraseSector(0);
+        writeOffset = 0;
+        nextSeq = 0;
+        return;
+    }
+
+    // Walk the head sector to the first blank slot.
+    uint32_t offset = headSector * HISTORY_SECTOR_SIZE;
+    uint32_t end = offset + HISTORY_SECTOR_SIZE;
+    while (offset < end && recordAt(offset, rec)) {
+        highestSeq = rec.sequence;
+        offset += sizeof(HistoryRecord);
+    }
+
+    nextSeq = highestSeq + 1;
+
+    // Mid-page positions can hold partially-programmed flash after a
+    // power cut; round up to a fresh page boundary.
+    writeOffset = (offset + HISTORY_PAGE_SIZE - 1) & ~(HISTORY_PAGE_SIZE - 1);
+    if (writeOffset >= logSize) {
+        writeOffset = 0;
+        eraseSector(0);
+    }
+}
+
+// ============================================================================
+// SPARSE TIME INDEX
+// ============================================================================
+void HistoryLog::buildIndex() {
+    // Worst case one entry per stride across the whole partition.
+    indexCap = logSize / (sizeof(HistoryRecord) * HISTORY_INDEX_STRIDE);
+    index = (IndexEntry*)malloc(indexCap * sizeof(IndexEntry));
+    if (index == nullptr) {
+        indexCap = 0;
+        return;
+    }
+
+    // One sequential pass from the oldest record; every readNext is a
+    // mapped-flash dereference, so the rebuild is bandwidth-bound.
+    Cursor cursor = cursorFromSeq(0);
+    HistoryRecord rec;
+    while (readNext(cursor, rec)) {
+        uint32_t offset = cursor.offset == 0
+            ? logSize - sizeof(HistoryRecord)
+            : cursor.offset - sizeof(HistoryRecord);
+        indexMaybeAdd(rec, offset);
+    }
+}
+
+void HistoryLog::indexMaybeAdd(const HistoryRecord& record, uint32_t offset) {
+    if (index == nullptr || (record.sequence % HISTORY_INDEX_STRIDE) != 0) {
+        return;
+    }
+
+    if (indexCount == indexCap) {
+        indexTail = (indexTail + 1) % indexCap; // overwrite oldest
+        indexCount--;
+    }
+    IndexEntry& entry = index[(indexTail + indexCount) % indexCap];
+    entry.timestampMs = record.timestampMs;
+    entry.offset = offset;
+    indexCount++;
+}
+
+// Sector erase invalidates any entries pointing into it; they are
+// always the oldest, so this only trims the tail.
+void HistoryLog::evictIndexForSector(uint32_t sectorOffset) {
+    while (indexCount > 0) {
+        const IndexEntry& oldest = index[indexTail];
+        if (oldest.offset < sectorOffset ||
+            oldest.offset >= sectorOffset + HISTORY_SECTOR_SIZE) {
+            break;
+        }
+        indexTail = (indexTail + 1) % indexCap;
+        indexCount--;
+    }
+}
+
+HistoryLog::Cursor HistoryLog::cursorFromTime(uint32_t sinceTimestampMs) {
+    Cursor cursor = { 0, false };
+    if (partition == nullptr) {
+        return cursor;
+    }
+    if (indexCount == 0) {
+        return cursorFromSeq(0); // no index: start at the oldest record
+    }
+
+    // Binary search for the last entry at or before the requested
+    // time; O(log n) probes into RAM, no flash reads.
+    uint32_t lo = 0;
+    uint32_t hi = indexCount; // exclusive
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        const IndexEntry& entry = index[(indexTail + mid) % indexCap];
+        if (entry.timestampMs <= sinceTimestampMs) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    const IndexEntry& start =
+        index[(indexTail + (lo > 0 ? lo - 1 : 0)) % indexCap];
+    cursor.offset = start.offset;
+    cursor.valid = true;
+
+    // At most one stride of records to skip to the exact start.
+    Cursor probe = cursor;
+    HistoryRecord rec;
+    while (readNext(probe, rec)) {
+        if (rec.timestampMs >= sinceTimestampMs) {
+            break;
+        }
+        cursor = probe;
+    }
+    return cursor;
+}
+
+// ============================================================================
+// APPEND
+// ============================================================================
+bool HistoryLog::append(const HistoryRecord& record) {
+    if (partition == nullptr) {
+        return false;
+    }
+
+    HistoryRecord stamped = record;
+    stamped.sequence = nextSeq++;
+
+    // Modulo covers the pending wrap when the head sits at the end of
+    // the partition between flushes.
+    indexMaybeAdd(stamped, (writeOffset + batchLen) % logSize);
+
+    memcpy(&batch[batchLen], &stamped, sizeof(stamped));
+    batchLen += sizeof(stamped);
+
+    if (batchLen >= HISTORY_PAGE_SIZE) {
+        flush();
+    }
+    return true;
+}
+
+void HistoryLog::flush() {
+    if (partition == nullptr || batchLen == 0) {
+        return;
+    }
+
+    // Entering a new sector: it must be blank first, wrapping at the
+    // end. Each sector is erased once per lap around the partition,
+    // which is all the wear leveling a strictly sequential log needs.
+    // prepareAhead() normally did the erase already in an idle slice;
+    // the synchronous erase here is the fallback for a head that
+    // outran the idle cadence (and the boot paths that never ran it).
+    if ((writeOffset % HISTORY_SECTOR_SIZE) == 0) {
+        if (writeOffset >= logSize) {
+            writeOffset = 0;
+        }
+        if (preparedValid && preparedOffset == writeOffset) {
+            preparedValid = false; // pre-erased; page program only
+        } else {
+            eraseSector(writeOffset);
+        }
+    }
+
+    // Pad the tail with 0xFF so unwritten slots read as blank.
+    if (batchLen < HISTORY_PAGE_SIZE) {
+        memset(&batch[batchLen], 0xFF, HISTORY_PAGE_SIZE - batchLen);
+    }
+
+    {
+        FLASH_OP_SCOPE(FLASH_HISTORY_WRITE);
+        esp_partition_write(partition, writeOffset, batch, HISTORY_PAGE_SIZE);
+    }
+    writeOffset += HISTORY_PAGE_SIZE;
+    batchLen = 0;
+}
+
+// Runs from an idle slice (sensorTask, event queue empty), which is
+// the same task the flushes run on — no locking needed. The sector
+// erased is the oldest data in the log anyway; losing it a few
+// minutes before the head would have lapped it costs nothing.
+void HistoryLog::prepareAhead() {
+    if (partition == nullptr) {
+        return;
+    }
+
+    // The boundary the head will next sit on: the current offset when
+    // it is already sector-aligned (that sector's erase is still
+    // pending), the next boundary otherwise.
+    uint32_t target = writeOffset % HISTORY_SECTOR_SIZE == 0
+        ? writeOffset
+        : (writeOffset / HISTORY_SECTOR_SIZE + 1) * HISTORY_SECTOR_SIZE;
+    if (target >= logSize) {
+        target = 0;
+    }
+
+    if (preparedValid && preparedOffset == target) {
+        return; // already blank, nothing to do this slice
+    }
+    eraseSector(target);
+    preparedOffset = target;
+    preparedValid = true;
+}
+
+// ============================================================================
+// READ
+// ============================================================================
+HistoryLog::Cursor HistoryLog::cursorFromSeq(uint32_t fromSeq) {
+    Cursor cursor = { 0, false };
+    if (partition == nullptr) {
+        return cursor;
+    }
+
+    // Same sector-header scan as mount: find the first sector whose
+    // leading record reaches fromSeq, then step inside it.
+    uint32_t sectorCount = logSize / HISTORY_SECTOR_SIZE;
+    uint32_t bestSector = 0xFFFFFFFF;
+    uint32_t bestSeq = 0;
+    uint32_t oldestSector = 0xFFFFFFFF;
+    uint32_t oldestSeq = 0xFFFFFFFF;
+
+    HistoryRecord rec;
+    for (uint32_t s = 0; s < sectorCount; s++) {
+        if (!firstRecordOfSector(s, rec)) {
+            continue;
+        }
+        // The sector containing fromSeq leads with the largest
+        // sequence that is still <= fromSeq. Track the oldest sector
+        // separately — the two races interleave in sector order, so
+        // folding them into one pair of variables let whichever was
+        // seen first block the other.
+        if (rec.sequence <= fromSeq &&
+            (bestSector == 0xFFFFFFFF || rec.sequence > bestSeq)) {
+            bestSeq = rec.sequence;
+            bestSector = s;
+        }
+        if (rec.sequence < oldestSeq) {
+            oldestSeq = rec.sequence;
+            oldestSector = s;
+        }
+    }
+
+    // Nothing reaches back to fromSeq (it was erased, or predates the
+    // log): start at the oldest record still on flash.
+    if (bestSector == 0xFFFFFFFF) {
+        bestSector = oldestSector;
+    }
+    if (bestSector == 0xFFFFFFFF) {
+        return cursor; // empty log
+    }
+
+    cursor.offset = bestSector * HISTORY_SECTOR_SIZE;
+    cursor.valid = true;
+
+    // Skip records older than requested within the sector.
+    Cursor probe = cursor;
+    while (readNext(probe, rec)) {
+        if (rec.sequence >= fromSeq) {
+            break;
+        }
+        cursor = probe;
+    }
+    return cursor;
+}
+
+bool HistoryLog::readNext(Cursor& cursor, HistoryRecord& out) {
+    if (partition == nullptr || !cursor.valid) {
+        return false;
+    }
+
+    // Unflushed batch records are not visible to readers; stop at the
+    // last programmed page. Equality, not >=: after the first lap the
+    // oldest records live at offsets past the head, and the traversal
+    // wraps at logSize below before it can walk into it. writeOffset
+    // is page-aligned and records pack pages exactly, so a cursor
+    // lands on it, never steps over.
+    if (cursor.offset == writeOffset) {
+        return false;
+    }
+
+    if (!recordAt(cursor.offset, out)) {
+        return false; // blank slot: end of data in this sector
+    }
+
+    cursor.offset += sizeof(HistoryRecord);
+    if (cursor.offset >= logSize) {
+        cursor.offset = 0;
+    }
+    return true;
+}
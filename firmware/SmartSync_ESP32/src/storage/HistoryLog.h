@@ -0,0 +1,123 @@
+#ifndef HISTORY_LOG_H
+#define HISTORY_LOG_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "../../include/config.h"
+
+// Append-only time-series log of sensor readings in the (otherwise
+// unused) SPIFFS data partition. Records are fixed-size and written
+// strictly sequentially, so wear levels itself: the log wraps around
+// its span of the partition and each sector is erased exactly once
+// per lap. The tail HISTORY_ROLLUP_*_SECTORS belong to RollupStore;
+// the log never touches them.
+//
+// Writes are batched into one flash page (16 records ≈ 160 s of data
+// at SENSOR_READ_INTERVAL), so the steady-state flash cost is a single
+// page program per dozens of samples. Blank flash is 0xFF, so a
+// record with sequence 0xFFFFFFFF marks the end of the log.
+
+// 16 bytes; 16 per flash page, 256 per sector.
+struct __attribute__((packed)) HistoryRecord {
+    uint32_t sequence;      // monotonic, never 0xFFFFFFFF
+    uint32_t timestampMs;   // device millis() at capture
+    int16_t temperature;    // °C × 100
+    uint16_t humidity;      // %RH × 100
+    uint16_t distance;      // cm × 10
+    uint8_t flags;          // SensorFrameFlags
+    uint8_t reserved;
+};
+
+class HistoryLog {
+public:
+    HistoryLog();
+
+    // Locates the partition and scans for the append position.
+    bool begin();
+
+    // Batches the record; programs a page when the batch fills.
+    bool append(const HistoryRecord& record);
+
+    // Programs any partial batch immediately (shutdown path).
+    void flush();
+
+    // Erase-ahead: erases the next sector boundary the write head
+    // will cross, so the 4 KB erase (tens of ms, cache-stalled) runs
+    // in an idle slice instead of landing synchronously in whatever
+    // path triggered the flush. Idempotent — one erase per boundary,
+    // re-calls are a compare. The erase-at-flush path stays as the
+    // fallback for a head that outruns the idle cadence.
+    void prepareAhead();
+
+    // Read cursor for history sync: positioned at the oldest record
+    // with sequence >= fromSeq, stepped with readNext().
+    struct Cursor {
+        uint32_t offset;   // byte offset into the partition
+        bool valid;
+    };
+    Cursor cursorFromSeq(uint32_t fromSeq);
+    bool readNext(Cursor& cursor, HistoryRecord& out);
+
+    // Time-range queries ("14:00-15:00 yesterday"): binary search over
+    // the sparse index finds the start in O(log n) probes, then the
+    // caller reads forward until past its end timestamp. Timestamps
+    // are device millis(), monotonic within a boot session; entries
+    // from before the last reboot are matched best-effort.
+    Cursor cursorFromTime(uint32_t sinceTimestampMs);
+
+    uint32_t nextSequence() const { return nextSeq; }
+    bool isReady() const { return partition != nullptr; }
+
+    // Random access for chart downsampling (LttbSampler): the record
+    // at a byte offset obtained from a cursor, and the log's byte
+    // span for offset arithmetic across the wrap. Callers stay inside
+    // a range a cursor pass already bounded — these do not re-check
+    // the batch-visibility rule readNext enforces.
+    bool recordAtOffset(uint32_t offset, HistoryRecord& out) {
+        return recordAt(offset, out);
+    }
+    uint32_t logSpan() const { return logSize; }
+
+    // Wear telemetry: sector erases since boot and the partition's
+    // sector count (erases spread evenly — the log is sequential).
+    uint32_t eraseCount() const { return erases; }
+    uint32_t sectorCount() const;
+
+private:
+    const esp_partition_t* partition;
+    const uint8_t* mapped;  // mmap base for zero-copy reads (or null)
+    uint32_t logSize;       // raw-log bytes: partition minus rollup tail
+    uint32_t writeOffset;   // next byte to program
+    uint32_t nextSeq;
+    uint32_t erases;        // sector erases since boot
+    uint32_t preparedOffset; // sector already erased ahead of the head
+    bool preparedValid;
+
+    // Sparse index: timestamp and offset of every
+    // HISTORY_INDEX_STRIDE-th record, kept as a ring so entries die
+    // with the sectors that held their records. Rebuilt at boot with
+    // one sequential pass over the log.
+    struct IndexEntry {
+        uint32_t timestampMs;
+        uint32_t offset;
+    };
+    IndexEntry* index;
+    uint32_t indexCap;
+    uint32_t indexTail;  // oldest entry
+    uint32_t indexCount;
+
+    void buildIndex();
+    void indexMaybeAdd(const HistoryRecord& record, uint32_t offset);
+    void evictIndexForSector(uint32_t sectorOffset);
+
+    // One flash page of pending records.
+    uint8_t batch[256];
+    uint16_t batchLen;
+
+    bool firstRecordOfSector(uint32_t sector, HistoryRecord& out);
+    bool recordAt(uint32_t offset, HistoryRecord& out);
+    void findAppendPosition();
+    void eraseSector(uint32_t offset);
+};
+
+#endif // HISTORY_LOG_H
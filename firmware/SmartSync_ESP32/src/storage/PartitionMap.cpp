@@ -0,0 +1,34 @@
+#include "PartitionMap.h"
+
+const esp_partition_t* PartitionMap::find(const char* label) {
+    // Subtype ANY: the label is the identity, the subtype is only a
+    // hint for external tools.
+    return esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                    ESP_PARTITION_SUBTYPE_ANY, label);
+}
+
+const void* PartitionMap::map(const char* label,
+                              spi_flash_mmap_handle_t* outHandle) {
+    const esp_partition_t* partition = find(label);
+    if (partition == nullptr) {
+        DEBUG_PRINTF("PartitionMap: no '%s' partition\n", label);
+        return nullptr;
+    }
+
+    const void* base = nullptr;
+    esp_err_t err = esp_partition_mmap(partition, 0, partition->size,
+                                       SPI_FLASH_MMAP_DATA, &base,
+                                       outHandle);
+    if (err != ESP_OK) {
+        DEBUG_PRINTF("PartitionMap: mmap '%s' failed (%d)\n", label, err);
+        return nullptr;
+    }
+
+    DEBUG_PRINTF("PartitionMap: '%s' mapped (%u KB)\n",
+                 label, partition->size / 1024);
+    return base;
+}
+
+void PartitionMap::unmap(spi_flash_mmap_handle_t handle) {
+    spi_flash_munmap(handle);
+}
@@ -0,0 +1,28 @@
+#ifndef PARTITION_MAP_H
+#define PARTITION_MAP_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "../../include/config.h"
+
+// Access layer for the raw data partitions in partitions_smartsync.csv.
+// Read-mostly partitions (the ML models, synced history for analysis)
+// are memory-mapped into the data address space via esp_partition_mmap,
+// so a read is a pointer dereference into cached flash — no buffer, no
+// copy, no esp_partition_read round trip.
+
+class PartitionMap {
+public:
+    // Looks up a data partition by label ("history", "model").
+    static const esp_partition_t* find(const char* label);
+
+    // Maps the whole partition read-only. Returns the mapped base
+    // pointer (valid until unmap) or nullptr. The handle must be kept
+    // for unmap().
+    static const void* map(const char* label,
+                           spi_flash_mmap_handle_t* outHandle);
+
+    static void unmap(spi_flash_mmap_handle_t handle);
+};
+
+#endif // PARTITION_MAP_H
@@ -0,0 +1,345 @@
+#include "RollupStore.h"
+#include "PartitionMap.h"
+#include "../system/FlashOpStats.h"
+
+#define ROLLUP_SECTOR_SIZE 4096
+#define ROLLUP_PAGE_SIZE 256 // matches sizeof(Stream::page)
+#define ROLLUP_BLANK_SEQ 0xFFFFFFFFu
+
+#define ROLLUP_MINUTE_MS 60000u
+#define ROLLUP_HOUR_MS 3600000u
+
+RollupStore::RollupStore()
+    : partition(nullptr),
+      mapped(nullptr) {
+    memset(&minuteStream, 0, sizeof(minuteStream));
+    memset(&hourStream, 0, sizeof(hourStream));
+    memset(&minuteBucket, 0, sizeof(minuteBucket));
+    memset(&hourBucket, 0, sizeof(hourBucket));
+}
+
+// ============================================================================
+// MOUNT
+// ============================================================================
+bool RollupStore::begin() {
+    // Same partition HistoryLog mounts; the log stops short of these
+    // sectors (HISTORY_ROLLUP_*_SECTORS in config.h).
+    partition = PartitionMap::find(PARTITION_LABEL_HISTORY);
+    if (partition == nullptr) {
+        partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                             ESP_PARTITION_SUBTYPE_DATA_SPIFFS,
+                                             NULL);
+    }
+    if (partition == nullptr) {
+        DEBUG_PRINTLN("Rollups: no data partition found");
+        return false;
+    }
+
+    spi_flash_mmap_handle_t mmapHandle;
+    mapped = (const uint8_t*)PartitionMap::map(partition->label, &mmapHandle);
+
+    hourStream.size =
+        (uint32_t)HISTORY_ROLLUP_HOUR_SECTORS * ROLLUP_SECTOR_SIZE;
+    minuteStream.size =
+        (uint32_t)HISTORY_ROLLUP_MINUTE_SECTORS * ROLLUP_SECTOR_SIZE;
+    hourStream.base = partition->size - hourStream.size;
+    minuteStream.base = hourStream.base - minuteStream.size;
+
+    mountStream(minuteStream);
+    mountStream(hourStream);
+
+    DEBUG_PRINTF("Rollups: %u KB minute / %u KB hour, next seq %u/%u\n",
+                 minuteStream.size / 1024, hourStream.size / 1024,
+                 minuteStream.nextSeq, hourStream.nextSeq);
+    return true;
+}
+
+bool RollupStore::recordAt(uint32_t offset, RollupRecord& out) {
+    if (mapped != nullptr) {
+        memcpy(&out, mapped + offset, sizeof(out));
+    } else if (esp_partition_read(partition, offset, &out,
+                                  sizeof(out)) != ESP_OK) {
+        return false;
+    }
+    return out.sequence != ROLLUP_BLANK_SEQ;
+}
+
+// Sector-leading sequence scan, the HistoryLog mount in miniature.
+// These sectors held raw log records before the region was carved
+// out, so a leading record that doesn't parse as a rollup (bad kind
+// or reserved byte) marks a stale sector: the whole stream is erased
+// rather than appended after garbage.
+void RollupStore::mountStream(Stream& stream) {
+    uint32_t sectorCount = stream.size / ROLLUP_SECTOR_SIZE;
+    uint32_t headSector = 0;
+    uint32_t highestSeq = 0;
+    bool anyData = false;
+    bool stale = false;
+
+    RollupRecord rec;
+    for (uint32_t s = 0; s < sectorCount && !stale; s++) {
+        if (!recordAt(stream.base + s * ROLLUP_SECTOR_SIZE, rec)) {
+            continue; // blank sector
+        }
+        if (rec.kind > ROLLUP_HOUR || rec.reserved != 0) {
+            stale = true;
+            break;
+        }
+        anyData = true;
+        if (rec.sequence >= highestSeq) {
+            highestSeq = rec.sequence;
+            headSector = s;
+        }
+    }
+
+    if (stale || !anyData) {
+        if (stale) {
+            FLASH_OP_SCOPE(FLASH_HISTORY_ERASE);
+            esp_partition_erase_range(partition, stream.base, stream.size);
+        }
+        stream.writeOffset = 0;
+        stream.nextSeq = 0;
+        if (!stale) {
+            // Fresh region: clear the first sector of possible
+            // pre-carve remains past a blank leading slot.
+            FLASH_OP_SCOPE(FLASH_HISTORY_ERASE);
+            esp_partition_erase_range(partition, stream.base,
+                                      ROLLUP_SECTOR_SIZE);
+        }
+        return;
+    }
+
+    // Walk the head sector to the first blank slot, then round up to
+    // a fresh page (mid-page flash may be half-programmed after a
+    // power cut).
+    uint32_t offset = headSector * ROLLUP_SECTOR_SIZE;
+    uint32_t end = offset + ROLLUP_SECTOR_SIZE;
+    while (offset < end && recordAt(stream.base + offset, rec)) {
+        highestSeq = rec.sequence;
+        offset += sizeof(RollupRecord);
+    }
+
+    stream.nextSeq = highestSeq + 1;
+    stream.writeOffset =
+        (offset + ROLLUP_PAGE_SIZE - 1) & ~(ROLLUP_PAGE_SIZE - 1);
+    if (stream.writeOffset >= stream.size) {
+        stream.writeOffset = 0;
+    }
+}
+
+// ============================================================================
+// ACCUMULATION
+// ============================================================================
+void RollupStore::accumulate(Bucket& bucket, const HistoryRecord& record,
+                             uint32_t key) {
+    if (bucket.samples == 0) {
+        bucket.key = key;
+        bucket.startMs = record.timestampMs;
+        bucket.tempMin = bucket.tempMax = record.temperature;
+        bucket.humMin = bucket.humMax = record.humidity;
+        bucket.distMin = bucket.distMax = record.distance;
+        bucket.tempSum = 0;
+        bucket.humSum = 0;
+        bucket.distSum = 0;
+        bucket.motion = 0;
+    } else {
+        if (record.temperature < bucket.tempMin) {
+            bucket.tempMin = record.temperature;
+        }
+        if (record.temperature > bucket.tempMax) {
+            bucket.tempMax = record.temperature;
+        }
+        if (record.humidity < bucket.humMin) {
+            bucket.humMin = record.humidity;
+        }
+        if (record.humidity > bucket.humMax) {
+            bucket.humMax = record.humidity;
+        }
+        if (record.distance < bucket.distMin) {
+            bucket.distMin = record.distance;
+        }
+        if (record.distance > bucket.distMax) {
+            bucket.distMax = record.distance;
+        }
+    }
+    bucket.tempSum += record.temperature;
+    bucket.humSum += record.humidity;
+    bucket.distSum += record.distance;
+    bucket.samples++;
+    if (record.flags & 0x01) {
+        bucket.motion++;
+    }
+}
+
+void RollupStore::seal(Kind kind, Bucket& bucket) {
+    if (bucket.samples == 0) {
+        return;
+    }
+
+    RollupRecord rec;
+    rec.sequence = 0; // stamped by appendRecord
+    rec.startMs = bucket.startMs;
+    rec.tempMin = bucket.tempMin;
+    rec.tempMax = bucket.tempMax;
+    rec.tempMean = (int16_t)(bucket.tempSum / bucket.samples);
+    rec.humMin = bucket.humMin;
+    rec.humMax = bucket.humMax;
+    rec.humMean = (uint16_t)(bucket.humSum / bucket.samples);
+    rec.distMin = bucket.distMin;
+    rec.distMax = bucket.distMax;
+    rec.distMean = (uint16_t)(bucket.distSum / bucket.samples);
+    rec.sampleCount = bucket.samples;
+    rec.motionCount = bucket.motion;
+    rec.kind = kind;
+    rec.reserved = 0;
+
+    appendRecord(streamFor(kind), rec);
+    bucket.samples = 0;
+}
+
+void RollupStore::addSample(const HistoryRecord& record) {
+    if (partition == nullptr) {
+        return;
+    }
+
+    uint32_t minuteKey = record.timestampMs / ROLLUP_MINUTE_MS;
+    uint32_t hourKey = record.timestampMs / ROLLUP_HOUR_MS;
+
+    if (minuteBucket.samples > 0 && minuteBucket.key != minuteKey) {
+        seal(ROLLUP_MINUTE, minuteBucket);
+    }
+    if (hourBucket.samples > 0 && hourBucket.key != hourKey) {
+        seal(ROLLUP_HOUR, hourBucket);
+    }
+
+    accumulate(minuteBucket, record, minuteKey);
+    accumulate(hourBucket, record, hourKey);
+}
+
+// ============================================================================
+// APPEND
+// ============================================================================
+void RollupStore::appendRecord(Stream& stream, RollupRecord& record) {
+    record.sequence = stream.nextSeq++;
+
+    memcpy(&stream.page[stream.pageLen], &record, sizeof(record));
+    stream.pageLen += sizeof(record);
+
+    if (stream.pageLen >= ROLLUP_PAGE_SIZE) {
+        flushStream(stream);
+    }
+}
+
+void RollupStore::flushStream(Stream& stream) {
+    if (stream.pageLen == 0) {
+        return;
+    }
+
+    // One erase per sector per lap, same as the raw log.
+    if ((stream.writeOffset % ROLLUP_SECTOR_SIZE) == 0) {
+        if (stream.writeOffset >= stream.size) {
+            stream.writeOffset = 0;
+        }
+        FLASH_OP_SCOPE(FLASH_HISTORY_ERASE);
+        esp_partition_erase_range(partition,
+                                  stream.base + stream.writeOffset,
+                                  ROLLUP_SECTOR_SIZE);
+    }
+
+    if (stream.pageLen < ROLLUP_PAGE_SIZE) {
+        memset(&stream.page[stream.pageLen], 0xFF,
+               ROLLUP_PAGE_SIZE - stream.pageLen);
+    }
+
+    {
+        FLASH_OP_SCOPE(FLASH_HISTORY_WRITE);
+        esp_partition_write(partition, stream.base + stream.writeOffset,
+                            stream.page, ROLLUP_PAGE_SIZE);
+    }
+    stream.writeOffset += ROLLUP_PAGE_SIZE;
+    stream.pageLen = 0;
+}
+
+void RollupStore::flush() {
+    if (partition == nullptr) {
+        return;
+    }
+    seal(ROLLUP_MINUTE, minuteBucket);
+    seal(ROLLUP_HOUR, hourBucket);
+    flushStream(minuteStream);
+    flushStream(hourStream);
+}
+
+// ============================================================================
+// READ
+// ============================================================================
+RollupStore::Cursor RollupStore::cursorFromSeq(Kind kind, uint32_t fromSeq) {
+    Cursor cursor = { 0, false };
+    if (partition == nullptr) {
+        return cursor;
+    }
+    Stream& stream = streamFor(kind);
+
+    // Sector-header scan: the sector containing fromSeq leads with
+    // the largest sequence still <= fromSeq; failing that, start at
+    // the oldest record present.
+    uint32_t sectorCount = stream.size / ROLLUP_SECTOR_SIZE;
+    uint32_t bestSector = 0xFFFFFFFF;
+    uint32_t bestSeq = 0xFFFFFFFF;
+
+    RollupRecord rec;
+    for (uint32_t s = 0; s < sectorCount; s++) {
+        if (!recordAt(stream.base + s * ROLLUP_SECTOR_SIZE, rec)) {
+            continue;
+        }
+        if (rec.sequence <= fromSeq) {
+            if (bestSeq == 0xFFFFFFFF || rec.sequence > bestSeq) {
+                bestSeq = rec.sequence;
+                bestSector = s;
+            }
+        } else if (bestSector == 0xFFFFFFFF && rec.sequence < bestSeq) {
+            bestSeq = rec.sequence;
+            bestSector = s;
+        }
+    }
+
+    if (bestSector == 0xFFFFFFFF) {
+        return cursor; // empty stream
+    }
+
+    cursor.offset = stream.base + bestSector * ROLLUP_SECTOR_SIZE;
+    cursor.valid = true;
+
+    Cursor probe = cursor;
+    while (readNext(kind, probe, rec)) {
+        if (rec.sequence >= fromSeq) {
+            break;
+        }
+        cursor = probe;
+    }
+    return cursor;
+}
+
+bool RollupStore::readNext(Kind kind, Cursor& cursor, RollupRecord& out) {
+    if (partition == nullptr || !cursor.valid) {
+        return false;
+    }
+    Stream& stream = streamFor(kind);
+
+    // Pending page records are invisible to readers, same contract as
+    // the raw log.
+    uint32_t limit = stream.base + stream.writeOffset;
+    if (cursor.offset >= limit && stream.writeOffset != 0) {
+        return false;
+    }
+
+    if (!recordAt(cursor.offset, out)) {
+        return false; // blank slot: end of data in this sector
+    }
+
+    cursor.offset += sizeof(RollupRecord);
+    if (cursor.offset >= stream.base + stream.size) {
+        cursor.offset = stream.base;
+    }
+    return true;
+}
@@ -0,0 +1,126 @@
+#ifndef ROLLUP_STORE_H
+#define ROLLUP_STORE_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "../../include/config.h"
+#include "HistoryLog.h"
+
+// Incremental minute/hour aggregates over the sensor history. Every
+// sample folds into two RAM accumulators (min/max/sum/count — a
+// handful of integer ops, no flash); when a sample crosses a minute
+// or hour boundary the completed bucket seals into the rollup region
+// at the tail of the history partition. A day-view chart then reads
+// 24 hourly records instead of the 8,640 raw samples behind them.
+//
+// The region is split into one stream per granularity so a day of
+// minute buckets can't evict weeks of hour buckets. Each stream is
+// the HistoryLog discipline in miniature: fixed-size records appended
+// strictly sequentially, one page program per batch, one sector erase
+// per lap, blank flash (0xFF sequence) marking the end.
+//
+// addSample runs on the sensor task only; the BLE sync task reads
+// behind writeOffset, the same reader contract HistoryLog gives it.
+
+// 32 bytes; 8 per flash page.
+struct __attribute__((packed)) RollupRecord {
+    uint32_t sequence;    // monotonic per stream, never 0xFFFFFFFF
+    uint32_t startMs;     // bucket start, device millis()
+    int16_t tempMin;      // °C × 100
+    int16_t tempMax;
+    int16_t tempMean;
+    uint16_t humMin;      // %RH × 100
+    uint16_t humMax;
+    uint16_t humMean;
+    uint16_t distMin;     // cm × 10
+    uint16_t distMax;
+    uint16_t distMean;
+    uint16_t sampleCount;
+    uint16_t motionCount; // samples with the motion flag set
+    uint8_t kind;         // Kind
+    uint8_t reserved;     // 0 (doubles as a mount sanity check)
+};
+
+class RollupStore {
+public:
+    enum Kind : uint8_t {
+        ROLLUP_MINUTE = 0,
+        ROLLUP_HOUR = 1,
+    };
+
+    RollupStore();
+
+    // Locates the history partition and mounts both streams. A stream
+    // whose leading records don't parse as rollups (first boot after
+    // the region was carved from raw log space) is erased and started
+    // fresh.
+    bool begin();
+
+    // Folds one raw sample into the open minute and hour buckets,
+    // sealing either bucket first when the sample starts a new one.
+    void addSample(const HistoryRecord& record);
+
+    // Seals any open buckets (partial — sampleCount says how partial)
+    // and programs pending pages. Shutdown/sleep path.
+    void flush();
+
+    // Read cursor per stream, same shape as HistoryLog's: positioned
+    // at the oldest record with sequence >= fromSeq.
+    struct Cursor {
+        uint32_t offset; // byte offset into the partition
+        bool valid;
+    };
+    Cursor cursorFromSeq(Kind kind, uint32_t fromSeq);
+    bool readNext(Kind kind, Cursor& cursor, RollupRecord& out);
+
+    bool isReady() const { return partition != nullptr; }
+
+private:
+    // One granularity's stream: a miniature sequential record log.
+    struct Stream {
+        uint32_t base;        // byte offset of the region
+        uint32_t size;        // region bytes (whole sectors)
+        uint32_t writeOffset; // next byte to program, relative to base
+        uint32_t nextSeq;
+        uint8_t page[256];    // pending records
+        uint16_t pageLen;
+    };
+
+    // Running bucket, integer throughout (the record's fixed-point
+    // units, sums wide enough for an hour of 10 s samples).
+    struct Bucket {
+        uint32_t key; // timestampMs / bucket length
+        uint32_t startMs;
+        int16_t tempMin, tempMax;
+        uint16_t humMin, humMax;
+        uint16_t distMin, distMax;
+        int32_t tempSum;
+        uint32_t humSum;
+        uint32_t distSum;
+        uint16_t samples;
+        uint16_t motion;
+    };
+
+    void accumulate(Bucket& bucket, const HistoryRecord& record,
+                    uint32_t key);
+    void seal(Kind kind, Bucket& bucket);
+
+    void mountStream(Stream& stream);
+    void appendRecord(Stream& stream, RollupRecord& record);
+    void flushStream(Stream& stream);
+    bool recordAt(uint32_t offset, RollupRecord& out);
+
+    Stream& streamFor(Kind kind) {
+        return kind == ROLLUP_MINUTE ? minuteStream : hourStream;
+    }
+
+    const esp_partition_t* partition;
+    const uint8_t* mapped;
+
+    Stream minuteStream;
+    Stream hourStream;
+    Bucket minuteBucket;
+    Bucket hourBucket;
+};
+
+#endif // ROLLUP_STORE_H
@@ -0,0 +1,72 @@
+#include "BatteryProfile.h"
+
+#if BATTERY_PROFILE_ENABLED
+
+#include <esp_sleep.h>
+#include "UlpProximity.h"
+
+int64_t BatteryProfile::wakeDeadlineUs = 0;
+bool BatteryProfile::motionWake = false;
+bool BatteryProfile::proximityWake = false;
+
+void BatteryProfile::begin() {
+    esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+    motionWake = (cause == ESP_SLEEP_WAKEUP_EXT0);
+    proximityWake = (cause == ESP_SLEEP_WAKEUP_ULP);
+    wakeDeadlineUs = esp_timer_get_time() +
+                     (int64_t)BATTERY_WAKE_WINDOW_MS * 1000;
+    // Stops any watcher still pinging and reclaims the ultrasonic
+    // pins for the awake-path driver.
+    UlpProximity::begin();
+    DEBUG_PRINTF("Battery profile: wake cause %d%s%s\n",
+                 (int)cause, motionWake ? " (PIR edge)" : "",
+                 proximityWake ? " (ULP proximity)" : "");
+}
+
+bool BatteryProfile::wokeOnMotion() {
+    return motionWake;
+}
+
+bool BatteryProfile::wokeOnProximity() {
+    return proximityWake;
+}
+
+void BatteryProfile::noteActivity() {
+    int64_t deadline = esp_timer_get_time() +
+                       (int64_t)BATTERY_WAKE_WINDOW_MS * 1000;
+    if (deadline > wakeDeadlineUs) {
+        wakeDeadlineUs = deadline;
+    }
+}
+
+bool BatteryProfile::windowExpired() {
+    return esp_timer_get_time() >= wakeDeadlineUs;
+}
+
+void BatteryProfile::sleepUntilNextWindow() {
+    // Sleep the remainder of the sensor interval, measured from boot
+    // so the sample cadence holds across duty cycles. If activity ate
+    // the whole interval, take the minimum anyway — a shorter sleep
+    // costs more in radio/sensor restart than it saves.
+    int64_t sleepUs = (int64_t)SENSOR_READ_INTERVAL * 1000 -
+                      esp_timer_get_time();
+    if (sleepUs < (int64_t)BATTERY_MIN_SLEEP_MS * 1000) {
+        sleepUs = (int64_t)BATTERY_MIN_SLEEP_MS * 1000;
+    }
+
+    esp_sleep_enable_timer_wakeup((uint64_t)sleepUs);
+    // PIR idles low and pulses high on motion: wake on high. The edge
+    // that fires the wake is replayed by setup(), not the GPIO ISR.
+    esp_sleep_enable_ext0_wakeup((gpio_num_t)PIR_PIN, 1);
+    // Proximity coverage continues through the sleep: the ULP pings
+    // the HC-SR04 and wakes us on a confirmed breach.
+    UlpProximity::arm();
+
+    DEBUG_PRINTF("Deep sleep for %lld ms\n", sleepUs / 1000);
+    #if DEBUG_SERIAL
+    Serial.flush();
+    #endif
+    esp_deep_sleep_start();
+}
+
+#endif // BATTERY_PROFILE_ENABLED
@@ -0,0 +1,65 @@
+#ifndef BATTERY_PROFILE_H
+#define BATTERY_PROFILE_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Deep-sleep duty cycling for the battery-only variant: the chip is
+// awake for one sensor window (plus whatever activity extends it),
+// then deep-sleeps until the next SENSOR_READ_INTERVAL deadline or a
+// PIR edge on the EXT0 wake pin. Everything volatile is rebuilt from
+// NVS and the RTC slow-memory segment (RtcState) on each wake, so a
+// sleep looks like a very cheap reboot — which is also why the
+// motion-wake latency floor is the boot path, not the radio.
+//
+// The sleep decision runs on the command task (it owns the deferred
+// NVS state that must flush first): the sensor task queues a
+// Command::BATTERY_SLEEP when its cycle ends with the window spent,
+// and the command task re-checks eligibility before powering down.
+// A connected client always holds the unit awake; advertising bursts
+// fall out of the duty cycle itself.
+//
+// Compiled out entirely unless the esp32dev-battery env sets
+// BATTERY_PROFILE_ENABLED.
+
+#if BATTERY_PROFILE_ENABLED
+
+class BatteryProfile {
+public:
+    // Classifies this boot's wake cause. Call first thing in setup()
+    // so wokeOnMotion() can steer the fast path.
+    static void begin();
+
+    // True when EXT0 (a PIR edge) woke the chip: the edge that caused
+    // the wake never reached the GPIO ISR, so setup() replays it into
+    // the sensor pipeline.
+    static bool wokeOnMotion();
+
+    // True when the ULP proximity watcher (UlpProximity) woke the
+    // chip: something crossed PROXIMITY_THRESHOLD while the cores
+    // slept. setup() replays it as an alarm, same idea as the PIR
+    // edge above.
+    static bool wokeOnProximity();
+
+    // Pushes the sleep deadline one full window out. Called for user
+    // commands and motion so an interactive session is never cut off
+    // mid-exchange.
+    static void noteActivity();
+
+    // Awake budget for this duty cycle spent.
+    static bool windowExpired();
+
+    // Arms the timer and EXT0 wake sources and enters deep sleep.
+    // Never returns. Pending state (NVS, history) must already be
+    // flushed — the caller owns that, this owns only the mechanics.
+    static void sleepUntilNextWindow();
+
+private:
+    static int64_t wakeDeadlineUs;
+    static bool motionWake;
+    static bool proximityWake;
+};
+
+#endif // BATTERY_PROFILE_ENABLED
+
+#endif // BATTERY_PROFILE_H
@@ -0,0 +1,130 @@
+#include "BootHealthGate.h"
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+
+bool BootHealthGate::probation = false;
+uint8_t BootHealthGate::milestones = 0;
+uint32_t BootHealthGate::deadlineMs = 0;
+uint32_t BootHealthGate::previousAddr = 0;
+
+// NVS record behind PREF_OTA_GUARD. Written once per OTA commit and
+// once per probation boot (attempt bump) — wear is negligible next to
+// the OTA itself.
+struct __attribute__((packed)) OtaGuardRecord {
+    uint32_t previousAddr; // flash address of the rollback target
+    uint8_t attempts;      // probation boots burned so far
+};
+
+static const esp_partition_t* findAppSlot(uint32_t addr) {
+    esp_partition_iterator_t it = esp_partition_find(
+        ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, NULL);
+    for (; it != NULL; it = esp_partition_next(it)) {
+        const esp_partition_t* p = esp_partition_get(it);
+        if (p->address == addr) {
+            esp_partition_iterator_release(it);
+            return p;
+        }
+    }
+    return NULL;
+}
+
+void BootHealthGate::begin() {
+    Preferences prefs;
+    prefs.begin(PREF_NAMESPACE, false);
+    OtaGuardRecord rec;
+    if (prefs.getBytes(PREF_OTA_GUARD, &rec, sizeof(rec)) != sizeof(rec)) {
+        prefs.end();
+        return; // no OTA pending judgment — the common boot
+    }
+
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    if (running->address == rec.previousAddr) {
+        // We ARE the rollback target: either the gate already flipped
+        // back or the commit's flip never took. Either way the record
+        // has served its purpose.
+        DEBUG_PRINTLN("Boot gate: running previous slot, record cleared");
+        prefs.remove(PREF_OTA_GUARD);
+        prefs.end();
+        return;
+    }
+
+    if (rec.attempts >= OTA_BOOT_MAX_ATTEMPTS) {
+        // The new image keeps dying before its milestones. Stop
+        // giving it chances.
+        prefs.remove(PREF_OTA_GUARD);
+        prefs.end();
+        previousAddr = rec.previousAddr;
+        rollBack("attempts exhausted");
+        return; // not reached
+    }
+
+    rec.attempts++;
+    prefs.putBytes(PREF_OTA_GUARD, &rec, sizeof(rec));
+    prefs.end();
+
+    previousAddr = rec.previousAddr;
+    milestones = 0;
+    deadlineMs = millis() + OTA_BOOT_HEALTH_BUDGET_MS;
+    probation = true;
+    DEBUG_PRINTF("Boot gate: probation attempt %u of %u, %u ms budget\n",
+                 rec.attempts, OTA_BOOT_MAX_ATTEMPTS,
+                 OTA_BOOT_HEALTH_BUDGET_MS);
+}
+
+void BootHealthGate::armForNextBoot(uint32_t prevAddr) {
+    OtaGuardRecord rec;
+    rec.previousAddr = prevAddr;
+    rec.attempts = 0;
+    Preferences prefs;
+    prefs.begin(PREF_NAMESPACE, false);
+    prefs.putBytes(PREF_OTA_GUARD, &rec, sizeof(rec));
+    prefs.end();
+    DEBUG_PRINTLN("Boot gate: next boot runs on probation");
+}
+
+void BootHealthGate::clearRecord() {
+    Preferences prefs;
+    prefs.begin(PREF_NAMESPACE, false);
+    prefs.remove(PREF_OTA_GUARD);
+    prefs.end();
+}
+
+void BootHealthGate::noteMilestone(Milestone m) {
+    if (!probation) {
+        return;
+    }
+    milestones |= m;
+    if (milestones == MILESTONE_ALL) {
+        probation = false;
+        clearRecord();
+        DEBUG_PRINTLN("Boot gate: all milestones reached, image valid");
+    }
+}
+
+void BootHealthGate::tick() {
+    if (!probation || (int32_t)(millis() - deadlineMs) < 0) {
+        return;
+    }
+    probation = false;
+    clearRecord();
+    rollBack("budget expired");
+}
+
+void BootHealthGate::rollBack(const char* reason) {
+    const esp_partition_t* target = findAppSlot(previousAddr);
+    if (target == NULL ||
+        esp_ota_set_boot_partition(target) != ESP_OK) {
+        // Nothing to fall back to (or otadata write failed): limping
+        // on the new image beats a reboot loop into the same failure.
+        DEBUG_PRINTF("Boot gate: rollback (%s) impossible, staying\n",
+                     reason);
+        return;
+    }
+    DEBUG_PRINTF("Boot gate: %s — rolling back to slot at 0x%x\n",
+                 reason, previousAddr);
+    #if DEBUG_SERIAL
+    Serial.flush();
+    #endif
+    esp_restart();
+}
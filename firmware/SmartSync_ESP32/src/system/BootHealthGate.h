@@ -0,0 +1,70 @@
+#ifndef BOOT_HEALTH_GATE_H
+#define BOOT_HEALTH_GATE_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Health gate over the OTA pair: new firmware runs on probation until
+// it proves itself, and a failure flips the boot slot back to the
+// image that was working before the update. The Arduino sdkconfig
+// ships a bootloader without CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE,
+// so the IDF anti-rollback machinery is unavailable — this gate is
+// the application-level equivalent.
+//
+// Mechanics: FirmwareUpdater::commit() writes a small NVS record
+// (previous slot address, attempt counter) right after flipping the
+// boot slot. Every boot, begin() inspects it:
+//   - no record          — normal boot, gate inert.
+//   - running == previous slot — the rollback already happened (or
+//     the flip never took); clear the record and carry on.
+//   - attempts exhausted — the new image keeps dying before reaching
+//     its milestones (a crash loop burns one attempt per reset,
+//     including watchdog bites). Flip back and restart immediately.
+//   - otherwise          — bump the attempt counter and arm probation.
+//
+// During probation the new firmware must hit every milestone —
+// advertising started, first full sensor cycle — inside
+// OTA_BOOT_HEALTH_BUDGET_MS. The last milestone clears the record:
+// the update is permanent. The budget check rides the watchdog
+// supervisor's loop, the one task still alive when everything the
+// milestones measure has hung; a bite during probation just restarts
+// into the next attempt.
+class BootHealthGate {
+public:
+    enum Milestone : uint8_t {
+        MILESTONE_BLE = 0x01,    // advertising started
+        MILESTONE_SENSOR = 0x02, // first full sensor cycle completed
+        MILESTONE_ALL = MILESTONE_BLE | MILESTONE_SENSOR,
+    };
+
+    // Reads the probation record and decides this boot's fate; may
+    // not return (rollback restarts). Call early in setup, before the
+    // subsystems being judged come up.
+    static void begin();
+
+    // Called by FirmwareUpdater after the boot slot flipped: the next
+    // boot runs on probation, with `previousAddr` (the running slot's
+    // flash address) as the rollback target.
+    static void armForNextBoot(uint32_t previousAddr);
+
+    // Milestone sinks, called from wherever the milestone actually
+    // happens. The one that completes the set marks the image valid.
+    static void noteMilestone(Milestone m);
+
+    // Budget check, polled from the watchdog supervisor loop. Flips
+    // the slot back and restarts when probation runs out of time.
+    static void tick();
+
+    static bool onProbation() { return probation; }
+
+private:
+    static void clearRecord();
+    static void rollBack(const char* reason);
+
+    static bool probation;
+    static uint8_t milestones;
+    static uint32_t deadlineMs;
+    static uint32_t previousAddr;
+};
+
+#endif // BOOT_HEALTH_GATE_H
@@ -0,0 +1,129 @@
+#include "BulkDump.h"
+
+#if SERIAL_CLI_ENABLED
+
+#include "EventTrace.h"
+#include "../storage/CoreDumpStore.h"
+#include "../storage/HistoryLog.h"
+
+HistoryLog* BulkDump::history = NULL;
+CoreDumpStore* BulkDump::coreDump = NULL;
+uint8_t BulkDump::chunk[2 + BULK_DUMP_CHUNK_BYTES +
+                        ChunkFramer::TRAILER_LEN];
+
+void BulkDump::begin(HistoryLog* historyLog, CoreDumpStore* coreDumps) {
+    history = historyLog;
+    coreDump = coreDumps;
+}
+
+void BulkDump::emitChunk(ChunkFramer& framer, uint16_t length) {
+    chunk[0] = length & 0xFF;
+    chunk[1] = length >> 8;
+    uint16_t framed = framer.seal(chunk + 2, length);
+    Serial.write(chunk, 2 + framed);
+}
+
+uint32_t BulkDump::dumpHistory(ChunkFramer& framer) {
+    if (history == NULL || !history->isReady()) {
+        return 0;
+    }
+    uint8_t* payload = chunk + 2;
+    uint16_t fill = 0;
+    uint32_t total = 0;
+    HistoryLog::Cursor cursor = history->cursorFromSeq(0);
+    HistoryRecord record;
+    while (history->readNext(cursor, record)) {
+        memcpy(payload + fill, &record, sizeof(record));
+        fill += sizeof(record);
+        if (fill + sizeof(record) > BULK_DUMP_CHUNK_BYTES) {
+            emitChunk(framer, fill);
+            total += fill;
+            fill = 0;
+        }
+    }
+    if (fill > 0) {
+        emitChunk(framer, fill);
+        total += fill;
+    }
+    return total;
+}
+
+uint32_t BulkDump::dumpTrace(ChunkFramer& framer) {
+    uint8_t* payload = chunk + 2;
+    uint16_t fill = 0;
+    uint32_t total = 0;
+    uint32_t available = EventTrace::available();
+    uint32_t seq = EventTrace::writeSequence() - available;
+    TraceRecord record;
+    for (; available > 0; available--, seq++) {
+        // A record the writers lapped mid-dump just drops out.
+        if (!EventTrace::read(seq, record)) {
+            continue;
+        }
+        memcpy(payload + fill, &record, sizeof(record));
+        fill += sizeof(record);
+        if (fill + sizeof(record) > BULK_DUMP_CHUNK_BYTES) {
+            emitChunk(framer, fill);
+            total += fill;
+            fill = 0;
+        }
+    }
+    if (fill > 0) {
+        emitChunk(framer, fill);
+        total += fill;
+    }
+    return total;
+}
+
+uint32_t BulkDump::dumpCore(ChunkFramer& framer) {
+    if (coreDump == NULL || !coreDump->hasDump()) {
+        return 0;
+    }
+    uint8_t* payload = chunk + 2;
+    uint32_t offset = 0;
+    for (;;) {
+        uint32_t got = coreDump->read(offset, payload,
+                                      BULK_DUMP_CHUNK_BYTES);
+        if (got == 0) {
+            break;
+        }
+        emitChunk(framer, (uint16_t)got);
+        offset += got;
+    }
+    return offset;
+}
+
+bool BulkDump::run(const char* target, uint32_t baud) {
+    uint32_t (*worker)(ChunkFramer&);
+    if (strcmp(target, "history") == 0) {
+        worker = &dumpHistory;
+    } else if (strcmp(target, "trace") == 0) {
+        worker = &dumpTrace;
+    } else if (strcmp(target, "core") == 0) {
+        worker = &dumpCore;
+    } else {
+        return false;
+    }
+
+    // Announce at the old rate so the host script knows what follows,
+    // then drain the TX FIFO before the rate changes under it.
+    Serial.printf("[bulk: %s chunk=%u baud=%u]\n", target,
+                  (unsigned)BULK_DUMP_CHUNK_BYTES, (unsigned)baud);
+    Serial.flush();
+    Serial.updateBaudRate(baud);
+    delay(20); // let the bridge settle at the new rate
+
+    ChunkFramer framer;
+    framer.begin();
+    uint32_t total = worker(framer);
+    emitChunk(framer, 0); // end-of-stream terminator
+
+    Serial.flush();
+    delay(20);
+    Serial.updateBaudRate(DEBUG_BAUD_RATE);
+    Serial.printf("[bulk: %s done, %u payload bytes]\n", target,
+                  (unsigned)total);
+    return true;
+}
+
+#endif // SERIAL_CLI_ENABLED
@@ -0,0 +1,50 @@
+#ifndef BULK_DUMP_H
+#define BULK_DUMP_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+#include "../ble/ChunkFramer.h"
+
+class HistoryLog;
+class CoreDumpStore;
+
+// Bench bulk extraction over the USB serial bridge. Pulling a full
+// history partition or a multi-hour trace ring through 244-byte BLE
+// notifications takes minutes; the same data through the CP2102 at
+// BULK_DUMP_BAUD takes seconds, and on the bench the cable is already
+// plugged in. The CLI's `dump` command re-bauds the UART, streams the
+// selected store as length-prefixed chunks sealed with the same
+// ChunkFramer CRC trailer the BLE streams use (so the host script and
+// the app share one integrity check), then restores DEBUG_BAUD_RATE.
+//
+// Chunk wire format, repeated until a zero-length terminator:
+//   uint16 length (LE) | payload[length] | ChunkFramer::Trailer
+//
+// Runs synchronously on the log drain task (the UART's owner), so log
+// lines queue in the ring for the duration instead of interleaving
+// with the binary stream; a long dump costs dropped log lines, which
+// the drain loop already reports in-band afterwards.
+class BulkDump {
+public:
+    static void begin(HistoryLog* history, CoreDumpStore* coreDump);
+
+    // Streams one store ("history", "trace", "core") at the given
+    // baud. False when the target name is unknown; flash errors end
+    // the stream early at the terminator chunk, visible to the host
+    // as a short byte count.
+    static bool run(const char* target, uint32_t baud);
+
+private:
+    static void emitChunk(ChunkFramer& framer, uint16_t length);
+    static uint32_t dumpHistory(ChunkFramer& framer);
+    static uint32_t dumpTrace(ChunkFramer& framer);
+    static uint32_t dumpCore(ChunkFramer& framer);
+
+    static HistoryLog* history;
+    static CoreDumpStore* coreDump;
+    // Length prefix + payload + trailer, sealed and sent in place.
+    static uint8_t chunk[2 + BULK_DUMP_CHUNK_BYTES +
+                         ChunkFramer::TRAILER_LEN];
+};
+
+#endif // BULK_DUMP_H
@@ -0,0 +1,33 @@
+#include "CmdLatency.h"
+
+CmdOpStats CmdLatency::stats[CMD_LATENCY_SLOTS];
+volatile uint8_t CmdLatency::slowOpcode = 0;
+volatile uint32_t CmdLatency::slowUs = 0;
+volatile uint32_t CmdLatency::slowAtMs = 0;
+volatile uint8_t CmdLatency::slowQueueDepth = 0;
+
+void CmdLatency::record(uint8_t opcode, uint32_t us, uint8_t queueDepth) {
+    if (opcode >= CMD_LATENCY_SLOTS) {
+        return;
+    }
+    CmdOpStats& s = stats[opcode];
+    s.count++;
+    s.sumUs += us;
+    if (us > s.maxUs) {
+        s.maxUs = us;
+    }
+
+    if (us > slowUs || (millis() - slowAtMs) > 3600000UL) {
+        slowOpcode = opcode;
+        slowUs = us;
+        slowAtMs = millis();
+        slowQueueDepth = queueDepth;
+    }
+}
+
+void CmdLatency::reset() {
+    memset(stats, 0, sizeof(stats));
+    slowUs = 0;
+    slowOpcode = 0;
+    slowQueueDepth = 0;
+}
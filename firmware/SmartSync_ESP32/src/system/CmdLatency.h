@@ -0,0 +1,46 @@
+#ifndef CMD_LATENCY_H
+#define CMD_LATENCY_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Command-to-actuation latency, per opcode. A command is stamped with
+// esp_timer time when its bytes land in the RX callback; actuation
+// commands carry the stamp through the command queue and record when
+// the actuator call returns on the command task, inline commands
+// record when their handler returns on the NimBLE task. esp_timer
+// (not the cycle counter) because the two timestamps land on
+// different cores.
+//
+// Alongside the per-opcode aggregates, one slowest-recent-command
+// trace keeps the opcode, duration, and the command-queue depth at
+// completion — the depth is what the loop was doing: a slow command
+// behind a deep queue is backlog, a slow command on an empty queue is
+// the handler itself.
+
+struct CmdOpStats {
+    uint32_t count;
+    uint64_t sumUs;
+    uint32_t maxUs;
+};
+
+class CmdLatency {
+public:
+    static void record(uint8_t opcode, uint32_t us, uint8_t queueDepth);
+    static const CmdOpStats& op(uint8_t opcode) { return stats[opcode]; }
+    static void reset();
+
+    static uint8_t slowestOpcode() { return slowOpcode; }
+    static uint32_t slowestUs() { return slowUs; }
+    static uint32_t slowestAgeMs() { return millis() - slowAtMs; }
+    static uint8_t slowestQueueDepth() { return slowQueueDepth; }
+
+private:
+    static CmdOpStats stats[CMD_LATENCY_SLOTS];
+    static volatile uint8_t slowOpcode;
+    static volatile uint32_t slowUs;
+    static volatile uint32_t slowAtMs;
+    static volatile uint8_t slowQueueDepth;
+};
+
+#endif // CMD_LATENCY_H
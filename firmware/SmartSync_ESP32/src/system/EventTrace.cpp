@@ -0,0 +1,63 @@
+#include "EventTrace.h"
+#include <esp_heap_caps.h>
+
+TraceRecord* EventTrace::ring = nullptr;
+uint32_t EventTrace::capacity = 0;
+uint32_t EventTrace::writeSeq = 0;
+portMUX_TYPE EventTrace::lock = portMUX_INITIALIZER_UNLOCKED;
+
+void EventTrace::begin() {
+    capacity = TRACE_RING_ENTRIES;
+    ring = (TraceRecord*)heap_caps_malloc(capacity * sizeof(TraceRecord),
+                                          MALLOC_CAP_SPIRAM);
+    if (ring == nullptr) {
+        // No PSRAM on this unit: a small internal ring keeps the last
+        // minutes instead of hours.
+        capacity = TRACE_RING_ENTRIES_FALLBACK;
+        ring = (TraceRecord*)malloc(capacity * sizeof(TraceRecord));
+    }
+    if (ring == nullptr) {
+        capacity = 0;
+        DEBUG_PRINTLN("EventTrace: allocation failed, tracing off");
+        return;
+    }
+    DEBUG_PRINTF("EventTrace: %u-record ring (%u KB)\n", capacity,
+                 (capacity * (uint32_t)sizeof(TraceRecord)) / 1024);
+}
+
+void EventTrace::record(uint8_t id, uint8_t arg8, uint16_t arg16) {
+    if (ring == nullptr) {
+        return;
+    }
+    portENTER_CRITICAL(&lock);
+    TraceRecord& r = ring[writeSeq % capacity];
+    r.ms = millis();
+    r.id = id;
+    r.arg8 = arg8;
+    r.arg16 = arg16;
+    writeSeq++;
+    portEXIT_CRITICAL(&lock);
+}
+
+uint32_t EventTrace::writeSequence() {
+    return writeSeq;
+}
+
+uint32_t EventTrace::available() {
+    return (writeSeq < capacity) ? writeSeq : capacity;
+}
+
+bool EventTrace::read(uint32_t seq, TraceRecord& out) {
+    if (ring == nullptr) {
+        return false;
+    }
+    portENTER_CRITICAL(&lock);
+    // Still inside the live window? Writers may have lapped this
+    // sequence since the dump began.
+    bool valid = seq < writeSeq && writeSeq - seq <= capacity;
+    if (valid) {
+        out = ring[seq % capacity];
+    }
+    portEXIT_CRITICAL(&lock);
+    return valid;
+}
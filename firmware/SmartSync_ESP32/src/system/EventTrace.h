@@ -0,0 +1,62 @@
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Always-on flight recorder for the intermittent field complaints
+// ("the fan changed by itself", "the alert never fired"). Every state
+// transition appends one fixed 8-byte record — timestamp, event id,
+// two args — into a PSRAM ring holding hours of history; a record is
+// a spinlocked store, a few dozen cycles, cheap enough to never turn
+// off. CMD_GET_TRACE streams the ring oldest-first so support reads
+// the minutes *before* the complaint, not the state after it.
+
+enum TraceEvent : uint8_t {
+    TRACE_CMD_RECEIVED = 1, // arg8 = opcode
+    TRACE_AUTO_DECISION,    // arg8 = requested duty, arg16 = temp °C×100
+    TRACE_NVS_COMMIT,       // arg8 = dirty bits flushed
+    TRACE_BLE_CONNECT,      // arg16 = conn handle
+    TRACE_BLE_DISCONNECT,   // arg16 = conn handle
+    TRACE_ALARM_RAISED,     // arg8 = alarm type, arg16 = value
+    TRACE_ALARM_CLEARED,    // arg8 = alarm type
+    TRACE_SELFTEST_FAIL,    // arg8 = SelfTest::CheckId
+    TRACE_ZONE_CHANGE,      // arg8 = new zone, arg16 = distance mm
+};
+
+struct __attribute__((packed)) TraceRecord {
+    uint32_t ms;     // device millis()
+    uint8_t id;      // TraceEvent
+    uint8_t arg8;
+    uint16_t arg16;
+};
+
+class EventTrace {
+public:
+    // Allocates the ring in PSRAM (internal RAM fallback shrinks it
+    // to minutes instead of hours rather than disabling tracing).
+    static void begin();
+
+    static void record(uint8_t id, uint8_t arg8, uint16_t arg16);
+
+    // Readers address records by absolute sequence so the dump task
+    // can walk a window that writers are still appending to; a record
+    // overwritten mid-dump just stops the walk early.
+    static uint32_t writeSequence();
+    static uint32_t available();
+    static bool read(uint32_t seq, TraceRecord& out);
+
+private:
+    static TraceRecord* ring;
+    static uint32_t capacity;
+    static uint32_t writeSeq;
+    static portMUX_TYPE lock;
+};
+
+#if TRACE_ENABLED
+#define TRACE_EVENT(id, a8, a16) EventTrace::record((id), (a8), (a16))
+#else
+#define TRACE_EVENT(id, a8, a16)
+#endif
+
+#endif // EVENT_TRACE_H
@@ -0,0 +1,154 @@
+#include "FirmwareUpdater.h"
+#include <esp32/rom/crc.h>
+#include <esp_ota_ops.h>
+#include "BootHealthGate.h"
+#include "FlashOpStats.h"
+
+FirmwareUpdater::FirmwareUpdater()
+    : partition(NULL),
+      state(IDLE),
+      totalSize(0),
+      expectedCrc(0),
+      received(0) {
+}
+
+bool FirmwareUpdater::begin() {
+    partition = esp_ota_get_next_update_partition(NULL);
+    return partition != NULL;
+}
+
+FirmwareUpdater::Status FirmwareUpdater::beginTransfer(uint32_t size,
+                                                       uint32_t crc) {
+    if (partition == NULL) {
+        return OTA_BAD_STATE;
+    }
+    if (state == ERASING) {
+        return OTA_BUSY;
+    }
+    if (size == 0 || size > partition->size) {
+        return OTA_BAD_RANGE;
+    }
+
+    // Same image as the transfer in flight: this is a reconnect, not
+    // a new release. Keep what already landed; the status frame tells
+    // the host the offset to continue from.
+    if (state == RECEIVING && size == totalSize && crc == expectedCrc) {
+        DEBUG_PRINTF("OTA: resuming at %u of %u bytes\n", received, size);
+        return OTA_OK;
+    }
+
+    totalSize = size;
+    expectedCrc = crc;
+    received = 0;
+    state = ERASING;
+
+    // Erasing ~1.4 MB takes seconds; like the model-bank erase, it
+    // runs on a one-shot task so the BLE task keeps serving commands.
+    BaseType_t ok = xTaskCreatePinnedToCore(eraseTask, "ota_erase", 3072,
+                                            this, 1, NULL, 1);
+    if (ok != pdPASS) {
+        state = IDLE;
+        return OTA_FLASH_FAIL;
+    }
+    return OTA_OK;
+}
+
+void FirmwareUpdater::eraseTask(void* param) {
+    FirmwareUpdater* updater = (FirmwareUpdater*)param;
+    // Round up to the 4 KB erase grain; the slot is a multiple of it.
+    uint32_t span = (updater->totalSize + 0xFFF) & ~(uint32_t)0xFFF;
+    esp_err_t err;
+    {
+        FLASH_OP_SCOPE(FLASH_FW_ERASE);
+        err = esp_partition_erase_range(updater->partition, 0, span);
+    }
+    if (err == ESP_OK) {
+        updater->state = RECEIVING;
+        DEBUG_PRINTF("OTA: slot %s erased, expecting %u bytes\n",
+                     updater->partition->label, updater->totalSize);
+    } else {
+        updater->state = IDLE;
+        DEBUG_PRINTF("OTA: erase failed (%d)\n", err);
+    }
+    vTaskDelete(NULL);
+}
+
+FirmwareUpdater::Status FirmwareUpdater::writeChunk(uint32_t offset,
+                                                    uint32_t chunkCrc,
+                                                    const uint8_t* data,
+                                                    uint16_t length) {
+    if (state == ERASING) {
+        return OTA_BUSY;
+    }
+    if (state != RECEIVING) {
+        return OTA_BAD_STATE;
+    }
+    // Sequential only: the offset detects a desynced host (or a chunk
+    // meant for an abandoned transfer), it does not permit gaps — NOR
+    // flash only clears bits, so a rewritten range would corrupt.
+    if (length == 0 || offset != received || length > totalSize - offset) {
+        return OTA_BAD_RANGE;
+    }
+    // Verify before burning: a chunk that corrupted in transit is
+    // refused while re-sending it is still cheap.
+    if (crc32_le(0, data, length) != chunkCrc) {
+        return OTA_BAD_CRC;
+    }
+    esp_err_t err;
+    {
+        FLASH_OP_SCOPE(FLASH_FW_WRITE);
+        err = esp_partition_write(partition, offset, data, length);
+    }
+    if (err != ESP_OK) {
+        DEBUG_PRINTF("OTA: write at 0x%x failed (%d)\n", offset, err);
+        return OTA_FLASH_FAIL;
+    }
+    received += length;
+    return OTA_OK;
+}
+
+FirmwareUpdater::Status FirmwareUpdater::commit() {
+    if (state != RECEIVING) {
+        return state == ERASING ? OTA_BUSY : OTA_BAD_STATE;
+    }
+    if (received != totalSize) {
+        return OTA_BAD_RANGE;
+    }
+    state = IDLE;
+
+    // Whole-image CRC read back through the flash driver — verifies
+    // what actually landed, not what was sent.
+    uint8_t buf[256];
+    uint32_t crc = 0;
+    for (uint32_t done = 0; done < totalSize;) {
+        uint32_t span = totalSize - done;
+        if (span > sizeof(buf)) {
+            span = sizeof(buf);
+        }
+        if (esp_partition_read(partition, done, buf, span) != ESP_OK) {
+            return OTA_FLASH_FAIL;
+        }
+        crc = crc32_le(crc, buf, span);
+        done += span;
+    }
+    if (crc != expectedCrc) {
+        DEBUG_PRINTF("OTA: image CRC mismatch (got 0x%08x)\n", crc);
+        return OTA_BAD_CRC;
+    }
+
+    // set_boot runs the full IDF image verification (header, segment
+    // checksums, optional signature) before touching otadata, so a
+    // CRC-valid blob that is not a bootable app is still refused.
+    esp_err_t err = esp_ota_set_boot_partition(partition);
+    if (err != ESP_OK) {
+        DEBUG_PRINTF("OTA: set_boot rejected image (%d)\n", err);
+        return OTA_BAD_IMAGE;
+    }
+    // The next boot runs on probation: unless the new image reaches
+    // its health milestones in time, the gate flips back to the slot
+    // running right now.
+    BootHealthGate::armForNextBoot(esp_ota_get_running_partition()->address);
+    DEBUG_PRINTF("OTA: %u bytes committed to %s, boot slot flipped\n",
+                 totalSize, partition->label);
+    return OTA_OK;
+}
@@ -0,0 +1,86 @@
+#ifndef FIRMWARE_UPDATER_H
+#define FIRMWARE_UPDATER_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "../../include/config.h"
+
+// Full-image firmware transfer into the inactive OTA slot, fed one
+// BLE chunk at a time. The WiFi paths (espota, network/DeltaOta)
+// never reach units whose homes have no configured network; this is
+// the same dual-bank discipline as ml/ModelUpdater applied to the
+// app0/app1 pair, so a caregiver's phone can update a unit during a
+// visit. The running slot is never written — a torn transfer costs
+// nothing and the next attempt re-erases.
+//
+// Protocol (control rides the binary BLE commands in BLEService, data
+// rides the dedicated OTA characteristic):
+//   BEGIN(totalSize, imageCrc) — erases the inactive slot on a
+//     one-shot task (a 1.4 MB erase takes seconds; the BLE task must
+//     not stall), then accepts chunks. A BEGIN that matches an
+//     in-flight transfer's size and CRC resumes it instead: the
+//     status frame reports bytesReceived, and the host continues
+//     from there — a dropped connection never restarts the image.
+//   chunk {offset u32, crc32 u32, bytes} — written through to flash.
+//     Offsets must be sequential (BLE writes are ordered; the offset
+//     is there to detect desync, not to allow gaps) and each chunk's
+//     CRC is verified before the write, so a corrupt chunk is re-sent
+//     instead of burned into the slot.
+//   COMMIT — reads the slot back, checks the whole-image CRC, then
+//     esp_ota_set_boot_partition (which runs the IDF image
+//     verification) flips the boot slot and arms the BootHealthGate
+//     probation for the next boot. The caller reboots.
+//
+// Flash writes run in the NimBLE host task while the controller keeps
+// ACKing link-layer traffic, so with write-without-response the radio
+// transfer and the flash program overlap instead of strictly
+// alternating.
+class FirmwareUpdater {
+public:
+    // Status values carried in OtaStatusFrame.status.
+    enum Status : uint8_t {
+        OTA_OK = 0,
+        OTA_BUSY = 1,       // erase still running, retry BEGIN later
+        OTA_BAD_STATE = 2,  // command outside the protocol order
+        OTA_BAD_RANGE = 3,  // size or offset outside the slot / not
+                            //   the next expected offset
+        OTA_BAD_CRC = 4,    // chunk or image CRC mismatch
+        OTA_BAD_IMAGE = 5,  // IDF image verification rejected the slot
+        OTA_FLASH_FAIL = 6, // esp_partition / esp_ota op failed
+    };
+
+    FirmwareUpdater();
+
+    // Locates the inactive app slot. Returns false (and stays inert)
+    // on single-app partition tables.
+    bool begin();
+
+    // Starts or resumes a transfer; see the protocol notes above.
+    Status beginTransfer(uint32_t totalSize, uint32_t expectedCrc);
+
+    // One chunk at the next expected offset, CRC-checked then written
+    // through to the inactive slot.
+    Status writeChunk(uint32_t offset, uint32_t chunkCrc,
+                      const uint8_t* data, uint16_t length);
+
+    // Verifies the complete image and flips the boot partition.
+    // OTA_OK means the next reboot runs the new firmware; anything
+    // else leaves the running slot in charge.
+    Status commit();
+
+    bool transferActive() const { return state != IDLE; }
+    uint32_t bytesReceived() const { return received; }
+
+private:
+    enum State : uint8_t { IDLE, ERASING, RECEIVING };
+
+    static void eraseTask(void* param);
+
+    const esp_partition_t* partition;
+    volatile State state;
+    uint32_t totalSize;
+    uint32_t expectedCrc;
+    uint32_t received;  // contiguous bytes landed == next offset
+};
+
+#endif // FIRMWARE_UPDATER_H
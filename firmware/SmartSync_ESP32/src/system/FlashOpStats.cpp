@@ -0,0 +1,34 @@
+#include "FlashOpStats.h"
+
+LatencyHistogram FlashOpStats::ops[FLASH_CALLER_COUNT];
+volatile uint32_t FlashOpStats::worstStallUs = 0;
+volatile uint8_t FlashOpStats::worstStallCaller = 0;
+volatile uint32_t FlashOpStats::worstStallAtMs = 0;
+
+void FlashOpStats::record(FlashCaller id, uint32_t cycles) {
+    ops[id].record(cycles);
+
+    uint32_t us = cycles / (F_CPU / 1000000);
+    uint32_t nowMs = millis();
+
+    // The record expires after an hour so one historic erase doesn't
+    // mask what flash is doing today.
+    bool expired = (nowMs - worstStallAtMs) > 3600000UL;
+    if (us > worstStallUs || expired || worstStallAtMs == 0) {
+        worstStallUs = us;
+        worstStallCaller = id;
+        worstStallAtMs = nowMs;
+    }
+}
+
+uint32_t FlashOpStats::worstUs() {
+    return ((millis() - worstStallAtMs) > 3600000UL) ? 0 : worstStallUs;
+}
+
+uint8_t FlashOpStats::worstCaller() {
+    return worstStallCaller;
+}
+
+uint32_t FlashOpStats::worstAgeMs() {
+    return millis() - worstStallAtMs;
+}
@@ -0,0 +1,68 @@
+#ifndef FLASH_OP_STATS_H
+#define FLASH_OP_STATS_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+#include "LatencyStats.h"
+
+// Flash write/erase accounting. Every flash operation stalls any task
+// whose next instruction cache-misses, so a 40 ms sector erase can
+// read as a laggy slider with nothing wrong on the BLE path. Each
+// call site brackets its operation with FLASH_OP_SCOPE, which feeds a
+// per-caller duration histogram plus a single worst-stall-in-the-
+// last-hour record that names the caller — CMD_GET_FLASH_OPS turns
+// "the slider stutters" into "the history log erased a sector."
+
+enum FlashCaller : uint8_t {
+    FLASH_NVS_COMMIT = 0,  // deferred Preferences flush (settings)
+    FLASH_HISTORY_WRITE,   // history log page write
+    FLASH_HISTORY_ERASE,   // history log sector erase
+    FLASH_CAPTURE_WRITE,   // capture store record write
+    FLASH_CAPTURE_ERASE,   // capture store sector reclaim
+    FLASH_MODEL_WRITE,     // model transfer chunk write
+    FLASH_MODEL_ERASE,     // model bank erase
+    FLASH_FW_WRITE,        // BLE OTA chunk write into the inactive slot
+    FLASH_FW_ERASE,        // BLE OTA slot erase
+    FLASH_CALLER_COUNT
+};
+
+class FlashOpStats {
+public:
+    static void record(FlashCaller id, uint32_t cycles);
+    static LatencyHistogram& op(uint8_t id) { return ops[id]; }
+
+    // Worst single operation in the trailing hour and who ran it.
+    // Reads race the recording tasks field-by-field, like every other
+    // diagnostics path here.
+    static uint32_t worstUs();
+    static uint8_t worstCaller();
+    static uint32_t worstAgeMs();
+
+private:
+    static LatencyHistogram ops[FLASH_CALLER_COUNT];
+    static volatile uint32_t worstStallUs;
+    static volatile uint8_t worstStallCaller;
+    static volatile uint32_t worstStallAtMs;
+};
+
+// RAII bracket; records on scope exit, early returns included.
+class FlashOpScope {
+public:
+    explicit FlashOpScope(FlashCaller id)
+        : callerId(id), startCycles(latencyCycleCount()) {}
+    ~FlashOpScope() {
+        FlashOpStats::record(callerId, latencyCycleCount() - startCycles);
+    }
+
+private:
+    FlashCaller callerId;
+    uint32_t startCycles;
+};
+
+#if PROFILER_ENABLED
+#define FLASH_OP_SCOPE(id) FlashOpScope _flashScope_(id)
+#else
+#define FLASH_OP_SCOPE(id)
+#endif
+
+#endif // FLASH_OP_STATS_H
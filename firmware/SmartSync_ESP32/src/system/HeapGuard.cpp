@@ -0,0 +1,178 @@
+// ============================================================
+// HEAP GUARD
+// ============================================================
+// Only live in the esp32dev-heapguard env: the wrappers below need
+// -Wl,--wrap=malloc/calloc/realloc, and that env is the only one that
+// passes them. Wrapping at link time also catches allocations inside
+// prebuilt framework archives, which a malloc #define never would.
+// free() is deliberately not wrapped — a steady-state free is only
+// ever paired with a steady-state allocation we already flagged.
+
+#include "HeapGuard.h"
+
+#if HEAP_GUARD_ENABLED
+
+#include <esp_debug_helpers.h>
+#include <esp_cpu.h>
+#include <esp_timer.h>
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+}
+
+static volatile bool armed = false;
+static volatile uint32_t violations = 0;
+static HeapGuardOffender offenders[HEAP_GUARD_OFFENDER_SLOTS];
+static uint8_t offenderCount = 0;
+static portMUX_TYPE guardLock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t reportTimer = nullptr;
+
+// Tasks whose allocations are expected forever: the BLE host, WiFi
+// and lwIP internals churn pool buffers by design and are outside our
+// control. Prefix match so "nimble_host" covers its split workers.
+static const char* const ALLOWED_TASKS[] = {
+    "nimble_host",
+    "hci",
+    "btController",
+    "esp_timer",
+    "tiT",          // lwIP tcpip thread
+    "sys_evt",
+    "wifi",
+    "mdns",
+    "httpd",
+    "Tmr Svc",
+    "ipc0",
+    "ipc1",
+    "OTA",
+};
+
+static bool taskAllowed(const char* name) {
+    for (size_t i = 0; i < sizeof(ALLOWED_TASKS) / sizeof(ALLOWED_TASKS[0]); i++) {
+        if (strncmp(name, ALLOWED_TASKS[i], strlen(ALLOWED_TASKS[i])) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void noteAlloc(size_t size) {
+    if (!armed) return;
+
+    const char* taskName;
+    uint32_t pc[HEAP_GUARD_BACKTRACE_DEPTH] = {0};
+
+    if (xPortInIsrContext()) {
+        // An allocating ISR is always a violation, and walking the
+        // interrupted stack here is not safe — record it name-only.
+        taskName = "ISR";
+    } else {
+        taskName = pcTaskGetName(NULL);
+        if (taskAllowed(taskName)) return;
+
+        // Frame 0 is this function, 1 the wrapper; the caller chain
+        // starts two frames up.
+        esp_backtrace_frame_t frame;
+        esp_backtrace_get_start(&frame.pc, &frame.sp, &frame.next_pc);
+        esp_backtrace_get_next_frame(&frame);
+        esp_backtrace_get_next_frame(&frame);
+        for (int d = 0; d < HEAP_GUARD_BACKTRACE_DEPTH; d++) {
+            pc[d] = esp_cpu_process_stack_pc(frame.pc);
+            if (!esp_backtrace_get_next_frame(&frame)) break;
+        }
+    }
+
+    portENTER_CRITICAL(&guardLock);
+    violations = violations + 1;
+    HeapGuardOffender* slot = nullptr;
+    for (uint8_t i = 0; i < offenderCount; i++) {
+        if (offenders[i].pc[0] == pc[0] &&
+            strncmp(offenders[i].task, taskName, sizeof(offenders[i].task) - 1) == 0) {
+            slot = &offenders[i];
+            break;
+        }
+    }
+    if (!slot && offenderCount < HEAP_GUARD_OFFENDER_SLOTS) {
+        slot = &offenders[offenderCount++];
+        memcpy(slot->pc, pc, sizeof(pc));
+        strlcpy(slot->task, taskName, sizeof(slot->task));
+    }
+    if (slot) {
+        slot->count++;
+        slot->lastSize = size;
+    }
+    portEXIT_CRITICAL(&guardLock);
+
+#if HEAP_GUARD_TRAP
+    // Trap mode: die at the offending call site so the exception
+    // decoder prints the full backtrace, not our truncated one.
+    abort();
+#endif
+}
+
+extern "C" void* __wrap_malloc(size_t size) {
+    noteAlloc(size);
+    return __real_malloc(size);
+}
+
+extern "C" void* __wrap_calloc(size_t n, size_t size) {
+    noteAlloc(n * size);
+    return __real_calloc(n, size);
+}
+
+extern "C" void* __wrap_realloc(void* ptr, size_t size) {
+    noteAlloc(size);
+    return __real_realloc(ptr, size);
+}
+
+static void reportTick(void*) {
+    HeapGuard::report();
+}
+
+void HeapGuard::arm() {
+    const esp_timer_create_args_t args = {
+        .callback = &reportTick,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "heapguard",
+        .skip_unhandled_events = true,
+    };
+    esp_timer_create(&args, &reportTimer);
+    esp_timer_start_periodic(reportTimer, (uint64_t)HEAP_GUARD_REPORT_MS * 1000);
+    armed = true;
+    DEBUG_PRINTLN("HeapGuard: armed, steady-state allocations now flagged");
+}
+
+uint32_t HeapGuard::violationCount() {
+    return violations;
+}
+
+const HeapGuardOffender* HeapGuard::offender(uint8_t slot) {
+    return (slot < offenderCount) ? &offenders[slot] : nullptr;
+}
+
+void HeapGuard::report() {
+    if (violations == 0) {
+        DEBUG_PRINTLN("HeapGuard: clean (0 steady-state allocations)");
+        return;
+    }
+    DEBUG_PRINTF("HeapGuard: %u violations, %u call sites:\n",
+                 violations, offenderCount);
+    for (uint8_t i = 0; i < offenderCount; i++) {
+        const HeapGuardOffender& o = offenders[i];
+        DEBUG_PRINTF("  [%s] x%u last=%uB 0x%08x 0x%08x 0x%08x 0x%08x\n",
+                     o.task, o.count, o.lastSize,
+                     o.pc[0], o.pc[1], o.pc[2], o.pc[3]);
+    }
+}
+
+#else // !HEAP_GUARD_ENABLED
+
+// Linkable no-ops so call sites need no guards of their own.
+void HeapGuard::arm() {}
+uint32_t HeapGuard::violationCount() { return 0; }
+const HeapGuardOffender* HeapGuard::offender(uint8_t) { return nullptr; }
+void HeapGuard::report() {}
+
+#endif // HEAP_GUARD_ENABLED
@@ -0,0 +1,39 @@
+#ifndef HEAP_GUARD_H
+#define HEAP_GUARD_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Steady-state allocation enforcement for the esp32dev-heapguard env.
+// The hot paths are designed to be allocation-free after setup() —
+// rings preallocated, frames on the stack, notifies built in mbufs —
+// but nothing stops a future change from quietly reintroducing a
+// malloc that fragments the heap over a week-long run. With the
+// linker wrapping malloc/calloc/realloc (--wrap), every allocation
+// after arm() from a task outside the radio/IP-stack allow-list is
+// counted as a violation and its call site recorded, so a soak run
+// with stress_test.py ends with a named list of offenders instead of
+// a slowly sagging free-heap graph.
+
+struct HeapGuardOffender {
+    uint32_t pc[HEAP_GUARD_BACKTRACE_DEPTH]; // call chain, innermost first
+    char task[8];                            // truncated task name ("ISR" in ISR context)
+    uint32_t count;
+    uint32_t lastSize;
+};
+
+class HeapGuard {
+public:
+    // Call at the end of setup(): allocations before this are the
+    // intended one-time pools and pass untouched.
+    static void arm();
+
+    static uint32_t violationCount();
+    static const HeapGuardOffender* offender(uint8_t slot);
+
+    // Logs the offender table through the ring logger (itself
+    // allocation-free). Also runs periodically once armed.
+    static void report();
+};
+
+#endif // HEAP_GUARD_H
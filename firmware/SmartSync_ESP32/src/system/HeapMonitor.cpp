@@ -0,0 +1,99 @@
+#include "HeapMonitor.h"
+#include <esp_heap_caps.h>
+#include "esp_attr.h"
+#include "esp_timer.h"
+
+// The ring lives in RTC slow memory: noinit, so it rides through
+// panics, watchdog resets, and software restarts. Only a power cycle
+// clears it — which is also the one death it can't explain.
+struct HeapSample {
+    uint32_t uptimeSec;
+    uint32_t freeBytes;
+    uint32_t minFreeBytes;
+    uint32_t largestBlock;
+};
+
+struct HeapRing {
+    uint32_t magic;
+    uint16_t head;  // next slot to write
+    uint16_t count;
+    HeapSample entries[HEAP_RING_ENTRIES];
+};
+
+static RTC_NOINIT_ATTR HeapRing heapRing;
+
+HeapMonitor::HeapMonitor() {
+}
+
+void HeapMonitor::begin() {
+    if (heapRing.magic == HEAP_RING_MAGIC &&
+        heapRing.head < HEAP_RING_ENTRIES &&
+        heapRing.count <= HEAP_RING_ENTRIES) {
+        replayPreviousRun();
+    } else {
+        heapRing.magic = HEAP_RING_MAGIC;
+        heapRing.head = 0;
+        heapRing.count = 0;
+    }
+
+    esp_timer_create_args_t args = {};
+    args.callback = onSampleDue;
+    args.arg = this;
+    args.name = "heap_mon";
+    esp_timer_handle_t timer;
+    esp_timer_create(&args, &timer);
+    esp_timer_start_periodic(timer, (uint64_t)HEAP_SAMPLE_INTERVAL_MS * 1000);
+
+    sample(); // boot baseline
+}
+
+// The ring the previous run left behind is this reset's flight
+// recorder; replay it before overwriting starts.
+void HeapMonitor::replayPreviousRun() {
+    DEBUG_PRINTF("Heap ring from before reset (%u samples):\n",
+                 heapRing.count);
+    uint16_t start = (heapRing.head + HEAP_RING_ENTRIES - heapRing.count) %
+                     HEAP_RING_ENTRIES;
+    for (uint16_t i = 0; i < heapRing.count; i++) {
+        const HeapSample& s = heapRing.entries[(start + i) % HEAP_RING_ENTRIES];
+        DEBUG_PRINTF("  t+%us free=%u min=%u largest=%u\n", s.uptimeSec,
+                     s.freeBytes, s.minFreeBytes, s.largestBlock);
+    }
+}
+
+void HeapMonitor::onSampleDue(void* arg) {
+    static_cast<HeapMonitor*>(arg)->sample();
+}
+
+void HeapMonitor::sample() {
+    HeapSample& s = heapRing.entries[heapRing.head];
+    s.uptimeSec = (uint32_t)(esp_timer_get_time() / 1000000LL);
+    // Internal RAM only: PSRAM neither fragments the allocators that
+    // matter here nor hosts NimBLE's pools.
+    s.freeBytes = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    s.minFreeBytes = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    s.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+
+    heapRing.head = (heapRing.head + 1) % HEAP_RING_ENTRIES;
+    if (heapRing.count < HEAP_RING_ENTRIES) {
+        heapRing.count++;
+    }
+}
+
+void HeapMonitor::fill(HeapStatsFrame& frame) const {
+    frame.freeBytes = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    frame.minFreeBytes = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    frame.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+
+    // Worst largest-block across the ring: the fragmentation trend in
+    // one number — a falling floor with stable free size is the
+    // signature the field deaths smell of.
+    uint32_t floor = frame.largestBlock;
+    for (uint16_t i = 0; i < heapRing.count; i++) {
+        if (heapRing.entries[i].largestBlock < floor) {
+            floor = heapRing.entries[i].largestBlock;
+        }
+    }
+    frame.lowestLargestBlock = floor;
+    frame.sampleCount = heapRing.count;
+}
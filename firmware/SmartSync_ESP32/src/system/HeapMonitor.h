@@ -0,0 +1,36 @@
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+#include "../ble/SensorFrame.h"
+
+// Heap health sampling for fragmentation forensics. NimBLE, the JSON
+// compat path's Strings, and the callback objects BLE begin() news up
+// all share one internal heap; a unit that dies after months usually
+// dies of a shrinking largest-free-block, not a shrinking total. Every
+// minute an esp_timer callback records free size, the minimum-ever
+// watermark, and the largest free block into a ring in RTC slow
+// memory — which survives panics, watchdog resets, and brownouts — so
+// the boot after a field death replays the final hour of allocation
+// behavior in the log. CMD_GET_HEAP reports the live numbers plus the
+// worst largest-block ever seen for trend monitoring from the app.
+class HeapMonitor {
+public:
+    HeapMonitor();
+
+    // Validates (or claims) the RTC ring, replays whatever the
+    // previous run left in it, and starts the minute sampler.
+    void begin();
+
+    // Fills the CMD_GET_HEAP reply with the live heap numbers and
+    // the ring's worst-case aggregates.
+    void fill(HeapStatsFrame& frame) const;
+
+private:
+    static void onSampleDue(void* arg);
+    void sample();
+    void replayPreviousRun();
+};
+
+#endif // HEAP_MONITOR_H
@@ -0,0 +1,17 @@
+#include "LatencyStats.h"
+
+uint32_t LatencyHistogram::p99Us() const {
+    if (samples == 0) {
+        return 0;
+    }
+    uint32_t target = samples - samples / 100; // ceil(0.99 * n)
+    uint32_t cumulative = 0;
+    for (uint8_t b = 0; b < 32; b++) {
+        cumulative += buckets[b];
+        if (cumulative >= target) {
+            uint32_t upper = (b >= 31) ? 0xFFFFFFFF : (2u << b);
+            return cyclesToUs(upper);
+        }
+    }
+    return cyclesToUs(maxCycles);
+}
@@ -0,0 +1,79 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <Arduino.h>
+#include <xtensa/hal.h>
+#include "../../include/config.h"
+
+// Cycle-accurate latency accounting for the paths that carry budgets:
+// the ML inference run and the alarm dispatch. Each sample is two
+// reads of the CPU cycle counter — a handful of cycles of overhead,
+// cheap enough to leave on in production — aggregated into min, mean,
+// max, and a log2-bucketed histogram that yields a p99 without
+// storing samples. CMD_GET_LATENCY reads (and optionally resets) the
+// aggregates, so tests/performance/stress_test.py can assert the
+// one-second fall-to-alarm budget on real hardware every release.
+//
+// Counters are per-core; every histogram here is recorded from a
+// single pinned task, so samples never mix cores.
+
+// Timestamp helper; subtract two of these for a cycle count.
+static inline uint32_t latencyCycleCount() {
+    return xthal_get_ccount();
+}
+
+class LatencyHistogram {
+public:
+    LatencyHistogram() { reset(); }
+
+    void reset() {
+        samples = 0;
+        minCycles = 0xFFFFFFFF;
+        maxCycles = 0;
+        sumCycles = 0;
+        memset(buckets, 0, sizeof(buckets));
+    }
+
+    void record(uint32_t cycles) {
+        samples++;
+        sumCycles += cycles;
+        if (cycles < minCycles) minCycles = cycles;
+        if (cycles > maxCycles) maxCycles = cycles;
+        buckets[bucketOf(cycles)]++;
+    }
+
+    uint32_t count() const { return samples; }
+    uint32_t minUs() const {
+        return samples == 0 ? 0 : cyclesToUs(minCycles);
+    }
+    uint32_t avgUs() const {
+        return samples == 0 ? 0 : cyclesToUs((uint32_t)(sumCycles / samples));
+    }
+    uint32_t maxUs() const { return cyclesToUs(maxCycles); }
+
+    // Walks the histogram to the 99th percentile and reports the
+    // bucket's upper bound — pessimistic by at most 2x, which is the
+    // right direction for a budget assertion.
+    uint32_t p99Us() const;
+
+private:
+    static uint8_t bucketOf(uint32_t cycles) {
+        uint8_t b = 0;
+        while (cycles > 1 && b < 31) {
+            cycles >>= 1;
+            b++;
+        }
+        return b;
+    }
+    static uint32_t cyclesToUs(uint32_t cycles) {
+        return cycles / (F_CPU / 1000000);
+    }
+
+    uint32_t samples;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t sumCycles;
+    uint32_t buckets[32]; // log2(cycles)
+};
+
+#endif // LATENCY_STATS_H
@@ -0,0 +1,45 @@
+#ifndef MONO_CLOCK_H
+#define MONO_CLOCK_H
+
+#include <stdint.h>
+#include "esp_timer.h"
+
+// ============================================================================
+// MONOTONIC 64-BIT CLOCK
+// ============================================================================
+// One time base for everything that stores an absolute "when": 64-bit
+// microseconds from esp_timer_get_time(), which never wraps within the
+// hardware's lifetime and keeps counting through light sleep. millis()
+// is fine for short intervals in the wrap-safe `now - then` form, but
+// any stamp held with a zero-means-never sentinel and compared against
+// a window goes wrong once uptime passes 2^32 ms (49.7 days): the
+// subtraction wraps and month-old state reads as fresh. Quiet-spell
+// tracking — the motion timeout, mesh peer freshness, the anomaly
+// features — holds exactly that kind of stamp, so it stores these
+// values instead.
+//
+// Epoch conversion stays where the epoch base already lives:
+// RtcClock::unixUs() projects this timeline onto Unix time from the
+// last DS3231/NTP sync. This header deliberately carries no state.
+class MonoClock {
+public:
+    // Microseconds since boot. ISR-safe (esp_timer_get_time is IRAM).
+    static inline int64_t nowUs() { return esp_timer_get_time(); }
+
+    // Milliseconds since boot, same timeline as nowUs(). Agrees with
+    // millis() modulo 2^32, so mixed comparisons during migration are
+    // off by at most the call skew.
+    static inline int64_t nowMs() { return esp_timer_get_time() / 1000LL; }
+
+    // Widens a recent 32-bit millis() stamp — an ISR-queued event
+    // timestamp, a restored RTC-memory anchor — onto the 64-bit
+    // timeline. Correct as long as the stamp is within ±24.8 days of
+    // now, which every queue and snapshot in this firmware satisfies
+    // by orders of magnitude.
+    static inline int64_t widenMs(uint32_t ms32) {
+        int64_t now = nowMs();
+        return now + (int32_t)(ms32 - (uint32_t)now);
+    }
+};
+
+#endif // MONO_CLOCK_H
@@ -0,0 +1,27 @@
+#include "OtaPacer.h"
+#include "../security/AlarmSystem.h"
+
+AlarmSystem* OtaPacer::alarmSystem = nullptr;
+uint32_t OtaPacer::lastWriteMs = 0;
+
+void OtaPacer::begin(AlarmSystem* alarms) {
+    alarmSystem = alarms;
+}
+
+void OtaPacer::yieldPoint() {
+    // Standing emergency: the transfer holds entirely. Polling beats
+    // a notification hook here — the resume deadline is human-scale
+    // and the alarm path must not know its observers.
+    while (alarmSystem != nullptr && alarmSystem->emergencyStanding()) {
+        vTaskDelay(pdMS_TO_TICKS(OTA_PACE_ALERT_POLL_MS));
+    }
+
+#if OTA_PACE_GAP_MS > 0
+    uint32_t now = millis();
+    uint32_t since = now - lastWriteMs;
+    if (lastWriteMs != 0 && since < OTA_PACE_GAP_MS) {
+        vTaskDelay(pdMS_TO_TICKS(OTA_PACE_GAP_MS - since));
+    }
+    lastWriteMs = millis();
+#endif
+}
@@ -0,0 +1,38 @@
+#ifndef OTA_PACER_H
+#define OTA_PACER_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+class AlarmSystem;
+
+// Shared throttle for every firmware transfer path (BLE chunks,
+// network/DeltaOta). An update is the lowest-priority work the unit
+// ever does, yet an unpaced one monopolizes the radio and stalls the
+// flash cache exactly while monitoring must not degrade. Each
+// transport calls yieldPoint() before a flash write: the call blocks
+// the transfer task while an emergency alarm is standing, then
+// enforces OTA_PACE_GAP_MS between writes so the sensor and command
+// tasks keep their slices. A transfer stretches from minutes to tens
+// of minutes; the alarm and command latency budgets hold throughout
+// (soak mode over an active transfer is the regression check).
+//
+// Blocking the transfer task is the whole mechanism: BLE chunks slow
+// down because the host task stops draining them, HTTP patches slow
+// down because the recv loop does — backpressure, not drops, so no
+// protocol change on either path.
+class OtaPacer {
+public:
+    static void begin(AlarmSystem* alarms);
+
+    // Called by a transfer task before each flash write. May block
+    // for as long as an emergency stands plus the write gap; never
+    // called from, and never blocks, the alarm or sensor paths.
+    static void yieldPoint();
+
+private:
+    static AlarmSystem* alarmSystem;
+    static uint32_t lastWriteMs;
+};
+
+#endif // OTA_PACER_H
@@ -0,0 +1,45 @@
+#include "PowerBench.h"
+
+#if POWER_BENCH_ENABLED
+
+void (*PowerBench::applyStateCallback)(uint8_t state) = nullptr;
+
+void PowerBench::begin(void (*applyState)(uint8_t state)) {
+    applyStateCallback = applyState;
+
+    pinMode(POWER_BENCH_PIN_MARKER, OUTPUT);
+    digitalWrite(POWER_BENCH_PIN_MARKER, LOW);
+
+    // Low priority on the BLE core: the schedule only flips flags and
+    // actuator writes a few times a minute, and must never perturb the
+    // sensor-core timing it is there to measure.
+    xTaskCreatePinnedToCore(taskThunk, "power_bench", 2048, NULL, 1, NULL, 1);
+}
+
+// (state index + 1) pulses, 1 ms high / 1 ms low. Milliseconds are
+// wide enough for a power analyzer's digital input at any sample rate,
+// and the whole group stays far shorter than the settle time the host
+// script trims from each window anyway.
+void PowerBench::marker(uint8_t state) {
+    for (uint8_t i = 0; i <= state; i++) {
+        digitalWrite(POWER_BENCH_PIN_MARKER, HIGH);
+        delay(1);
+        digitalWrite(POWER_BENCH_PIN_MARKER, LOW);
+        delay(1);
+    }
+}
+
+void PowerBench::taskThunk(void* arg) {
+    (void)arg;
+    for (;;) {
+        for (uint8_t state = 0; state < POWER_STATE_COUNT; state++) {
+            marker(state);
+            if (applyStateCallback) {
+                applyStateCallback(state);
+            }
+            vTaskDelay(pdMS_TO_TICKS(POWER_BENCH_STATE_MS));
+        }
+    }
+}
+
+#endif // POWER_BENCH_ENABLED
@@ -0,0 +1,54 @@
+#ifndef POWER_BENCH_H
+#define POWER_BENCH_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Power-consumption benchmark mode: steps the firmware through a fixed
+// schedule of operating states so an external power analyzer maps each
+// subsystem to its current draw. At every state entry the marker GPIO
+// emits (state index + 1) pulses; tests/performance/power_profile.py
+// counts the pulses in the analyzer's digital channel, slices the
+// current trace into per-state windows and prints POWER,... lines that
+// can be diffed between releases — a light-sleep regression shows up
+// as milliamps against the previous build, not as a vague battery
+// complaint from the field.
+//
+// The schedule wraps forever, so the analyzer can average as many laps
+// as its capture depth allows. Compiled out entirely unless the
+// esp32dev-power env sets POWER_BENCH_ENABLED.
+
+#if POWER_BENCH_ENABLED
+
+// Schedule order. Each state holds for POWER_BENCH_STATE_MS.
+enum PowerBenchState : uint8_t {
+    POWER_STATE_IDLE_ADV = 0, // radio only: sensors idled, fan/LED off
+    POWER_STATE_SENSORS,      // sampling restored, actuators still off
+    POWER_STATE_STREAMING,    // sensors + notify stream (host connects)
+    POWER_STATE_FAN,          // sensors + fan at full duty
+    POWER_STATE_COUNT,
+};
+
+class PowerBench {
+public:
+    // Starts the schedule task. applyState reconfigures the subsystems
+    // for the given state and runs on the bench task — keep it to flag
+    // flips and actuator writes.
+    static void begin(void (*applyState)(uint8_t state));
+
+private:
+    static void taskThunk(void* arg);
+    static void marker(uint8_t state);
+
+    static void (*applyStateCallback)(uint8_t state);
+};
+
+#define POWER_BENCH_BEGIN(cb) PowerBench::begin(cb)
+
+#else
+
+#define POWER_BENCH_BEGIN(cb) do {} while (0)
+
+#endif // POWER_BENCH_ENABLED
+
+#endif // POWER_BENCH_H
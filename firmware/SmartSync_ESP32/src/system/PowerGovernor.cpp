@@ -0,0 +1,31 @@
+#include "PowerGovernor.h"
+
+esp_pm_lock_handle_t PowerGovernor::handles[LOCK_COUNT] = {};
+
+void PowerGovernor::begin() {
+    #if POWER_SAVE_ENABLE
+    static const char* const names[LOCK_COUNT] = {
+        "alarm", "cmd", "ml", "ota", "echo",
+    };
+    for (uint8_t i = 0; i < LOCK_COUNT; i++) {
+        if (esp_pm_lock_create(ESP_PM_LOCK_CPU_FREQ_MAX, 0, names[i],
+                               &handles[i]) != ESP_OK) {
+            handles[i] = NULL; // this lock point degrades to a no-op
+        }
+    }
+    #endif
+}
+
+void PowerGovernor::acquire(uint8_t lock) {
+    if (lock < LOCK_COUNT && handles[lock] != NULL) {
+        esp_pm_lock_acquire(handles[lock]);
+    }
+}
+
+// IRAM: the echo capture ISR releases LOCK_ECHO while a flash write
+// elsewhere may have the cache disabled.
+void IRAM_ATTR PowerGovernor::release(uint8_t lock) {
+    if (lock < LOCK_COUNT && handles[lock] != NULL) {
+        esp_pm_lock_release(handles[lock]);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef POWER_GOVERNOR_H
+#define POWER_GOVERNOR_H
+
+#include <Arduino.h>
+#include <esp_pm.h>
+#include "../../include/config.h"
+
+// Full-clock lock points for the DFS setup in setupPowerManagement():
+// esp_pm scales the CPU between PM_MIN_FREQ_MHZ and PM_MAX_FREQ_MHZ on
+// its own, which is right for idle monitoring but wrong for the few
+// windows where latency is the product — an alarm dispatch, a command
+// handler, an inference batch, an OTA chunk, an echo in flight. Each of
+// those holds an ESP_PM_LOCK_CPU_FREQ_MAX lock for exactly its window,
+// so the governor snaps to full clock on entry and is free to drop
+// back the moment the last lock releases.
+//
+// One named lock per window keeps the audit legible: esp_pm's lock
+// dump attributes time-at-max to the path that demanded it. With
+// POWER_SAVE_ENABLE off no locks are created and every call degrades
+// to a no-op.
+class PowerGovernor {
+public:
+    enum LockId : uint8_t {
+        LOCK_ALARM = 0, // alarm drain: dispatch + latency timing window
+        LOCK_CMD = 1,   // binary command parse through handler return
+        LOCK_ML = 2,    // ML task drain: one lock spans the whole batch
+        LOCK_OTA = 3,   // OTA chunk: CRC check + flash write
+        LOCK_ECHO = 4,  // ultrasonic trigger through echo edge capture
+        LOCK_COUNT = 5,
+    };
+
+    static void begin();
+
+    // Pair every acquire with exactly one release; the esp_pm locks
+    // are counting. release() is ISR-safe (the echo lock is dropped
+    // from the capture ISR).
+    static void acquire(uint8_t lock);
+    static void release(uint8_t lock);
+
+    // Scoped acquire for handler bodies with early returns.
+    class FullClock {
+    public:
+        explicit FullClock(uint8_t lock) : lock(lock) { acquire(lock); }
+        ~FullClock() { release(lock); }
+    private:
+        uint8_t lock;
+    };
+
+private:
+    static esp_pm_lock_handle_t handles[LOCK_COUNT];
+};
+
+#endif // POWER_GOVERNOR_H
@@ -0,0 +1,3 @@
+#include "Profiler.h"
+
+LatencyHistogram Profiler::sections[PROF_SECTION_COUNT];
@@ -0,0 +1,63 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+#include "LatencyStats.h"
+
+// Always-on hot-path profiler. PROFILE_SCOPE brackets a named section
+// with two cycle-counter reads and folds the duration into that
+// section's log2 histogram — tens of cycles per section, no serial
+// I/O, nothing that perturbs what it measures — so production units
+// profile in the field through CMD_GET_PROFILE instead of a
+// DEBUG_PRINTF rebuild. Sections are a fixed compile-time table;
+// adding one is a line here and a macro at the site.
+//
+// Histograms are written only by each section's own task, so there is
+// no locking on the record path; the BLE dump reads racily, which for
+// monotonic counters means at worst one sample's skew.
+
+enum ProfSection : uint8_t {
+    PROF_READ_SENSORS = 0, // sensor task: full readSensors() pass
+    PROF_SENSOR_PUSH,      // BLE task: sendSensorData frame + notify
+    PROF_BLE_COMMAND,      // NimBLE task: binary command dispatch
+    PROF_NVS_COMMIT,       // sensor task: deferred Preferences flush
+    PROF_HISTORY_APPEND,   // sensor task: history log append
+    PROF_ECHO_ISR,         // echo ISR execution time, recorded by the
+                           // sensor task from the driver's counter —
+                           // jitter here means ISR code fell to flash
+    PROF_SECTION_COUNT
+};
+
+class Profiler {
+public:
+    static void record(ProfSection id, uint32_t cycles) {
+        sections[id].record(cycles);
+    }
+    static LatencyHistogram& section(uint8_t id) { return sections[id]; }
+
+private:
+    static LatencyHistogram sections[PROF_SECTION_COUNT];
+};
+
+// RAII bracket; records on scope exit, early returns included.
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfSection id)
+        : sectionId(id), startCycles(latencyCycleCount()) {}
+    ~ProfileScope() {
+        Profiler::record(sectionId, latencyCycleCount() - startCycles);
+    }
+
+private:
+    ProfSection sectionId;
+    uint32_t startCycles;
+};
+
+#if PROFILER_ENABLED
+#define PROFILE_SCOPE(id) ProfileScope _profScope_(id)
+#else
+#define PROFILE_SCOPE(id)
+#endif
+
+#endif // PROFILER_H
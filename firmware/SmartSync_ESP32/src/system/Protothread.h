@@ -0,0 +1,85 @@
+#ifndef PROTOTHREAD_H
+#define PROTOTHREAD_H
+
+#include <Arduino.h>
+
+// Stackless coroutines (protothreads) for the small multi-step
+// sequences that are not worth a FreeRTOS task: trigger, wait for a
+// completion or a deadline, decode, repeat. A full task costs 2-4 KB
+// of stack; a protothread costs the struct below — the "local
+// continuation" is the source line the body last suspended at, and
+// resuming is one switch jump back to it. Drivers read as linear code
+// with explicit wait points instead of a hand-maintained state enum
+// smeared across start/poll methods.
+//
+// Rules the line-number trick imposes:
+//   - Locals do not survive a suspension. Anything that must persist
+//     across a wait lives in the owning object — which is where this
+//     codebase keeps driver state anyway.
+//   - One PT_* operation per source line (each claims its __LINE__).
+//   - switch-based: don't wrap a PT_* wait in another switch.
+//
+// A protothread body is a member function stepping one instance:
+//
+//   bool Driver::step() {
+//       Protothread* pt = &this->pt;
+//       PT_BEGIN(pt);
+//       fireTrigger();
+//       PT_WAIT_UNTIL(pt, completionFlag);
+//       decode();
+//       PT_END(pt);
+//   }
+//
+// It returns true while the sequence still has work and false once it
+// ran off PT_END (or left through PT_EXIT); the scheduler — typically
+// a round-robin loop stepping every channel, as in SensorBank — calls
+// it again until done, then restart() re-arms it for the next cycle.
+
+struct Protothread {
+    uint16_t lc;      // resume line; 0 = start from the top
+    uint32_t untilMs; // deadline scratch for PT_DELAY_MS
+
+    Protothread() : lc(0), untilMs(0) {}
+
+    void restart() { lc = 0; }
+};
+
+// Opens the body. Everything before it runs on every step — keep it
+// to the pt pointer setup.
+#define PT_BEGIN(pt) switch ((pt)->lc) { case 0:
+
+// Closes the body: falling off the end completes the thread.
+#define PT_END(pt) } (pt)->lc = 0; return false
+
+// Completes the thread early (quarantined channel, start refused).
+#define PT_EXIT(pt) do { (pt)->lc = 0; return false; } while (0)
+
+// Suspends until the condition holds; the condition is re-evaluated
+// on every step, so keep it cheap and side-effect-aware.
+#define PT_WAIT_UNTIL(pt, condition)    \
+    do {                                \
+        (pt)->lc = __LINE__;            \
+        /* fall through */              \
+        case __LINE__:                  \
+        if (!(condition)) {             \
+            return true;                \
+        }                               \
+    } while (0)
+
+// Suspends once unconditionally — lets a long computation share the
+// scheduler pass with its siblings.
+#define PT_YIELD(pt)                    \
+    do {                                \
+        (pt)->lc = __LINE__;            \
+        return true;                    \
+        case __LINE__:;                 \
+    } while (0)
+
+// Suspends for at least ms milliseconds (millis()-based, wrap-safe).
+#define PT_DELAY_MS(pt, ms)             \
+    do {                                \
+        (pt)->untilMs = millis() + (ms);                          \
+        PT_WAIT_UNTIL(pt, (int32_t)(millis() - (pt)->untilMs) >= 0); \
+    } while (0)
+
+#endif // PROTOTHREAD_H
@@ -0,0 +1,154 @@
+#include "RingLogger.h"
+#include "SerialCli.h"
+#include "StackPlacer.h"
+#include <stdarg.h>
+
+uint8_t RingLogger::ring[LOG_RING_BYTES];
+uint16_t RingLogger::head = 0;
+uint16_t RingLogger::tail = 0;
+uint16_t RingLogger::used = 0;
+uint32_t RingLogger::dropped = 0;
+portMUX_TYPE RingLogger::lock = portMUX_INITIALIZER_UNLOCKED;
+TaskHandle_t RingLogger::drainTaskHandle = NULL;
+
+// Records are a 2-byte little-endian length followed by the line
+// bytes, so overflow can drop whole lines and the stream stays
+// parseable.
+
+void RingLogger::begin() {
+    // PSRAM stack: the drain loop only copies ring bytes to the UART,
+    // never near a flash operation.
+    drainTaskHandle = StackPlacer::createPsram(
+        drainThunk, "log_drain", LOG_DRAIN_TASK_STACK, NULL,
+        LOG_DRAIN_TASK_PRIORITY, LOG_DRAIN_TASK_CORE);
+}
+
+// Caller holds the lock.
+void RingLogger::dropOldest() {
+    uint16_t len = ring[tail] | (ring[(tail + 1) % LOG_RING_BYTES] << 8);
+    uint16_t total = 2 + len;
+    tail = (tail + total) % LOG_RING_BYTES;
+    used -= total;
+    dropped++;
+}
+
+void RingLogger::append(const char* data, uint16_t length) {
+    if (length > LOG_LINE_MAX) {
+        length = LOG_LINE_MAX;
+    }
+    uint16_t total = 2 + length;
+
+    portENTER_CRITICAL(&lock);
+    while (used + total > LOG_RING_BYTES) {
+        dropOldest();
+    }
+    ring[head] = length & 0xFF;
+    ring[(head + 1) % LOG_RING_BYTES] = length >> 8;
+    uint16_t at = (head + 2) % LOG_RING_BYTES;
+    for (uint16_t i = 0; i < length; i++) {
+        ring[at] = (uint8_t)data[i];
+        at = (at + 1) % LOG_RING_BYTES;
+    }
+    head = (head + total) % LOG_RING_BYTES;
+    used += total;
+    portEXIT_CRITICAL(&lock);
+
+    if (drainTaskHandle) {
+        xTaskNotifyGive(drainTaskHandle);
+    }
+}
+
+uint32_t RingLogger::droppedLines() {
+    return dropped;
+}
+
+void RingLogger::drainThunk(void* arg) {
+    drainLoop();
+}
+
+void RingLogger::drainLoop() {
+    char line[LOG_LINE_MAX];
+    uint32_t reportedDrops = 0;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+
+        for (;;) {
+            uint16_t len = 0;
+            portENTER_CRITICAL(&lock);
+            if (used > 0) {
+                len = ring[tail] | (ring[(tail + 1) % LOG_RING_BYTES] << 8);
+                uint16_t at = (tail + 2) % LOG_RING_BYTES;
+                for (uint16_t i = 0; i < len; i++) {
+                    line[i] = (char)ring[at];
+                    at = (at + 1) % LOG_RING_BYTES;
+                }
+                tail = (tail + 2 + len) % LOG_RING_BYTES;
+                used -= 2 + len;
+            }
+            portEXIT_CRITICAL(&lock);
+            if (len == 0) {
+                break;
+            }
+            Serial.write((const uint8_t*)line, len);
+        }
+
+        // Overflow is reported in-band so a gap in the stream is
+        // visible as a gap, not mistaken for silence.
+        if (dropped != reportedDrops) {
+            Serial.printf("[log: %u lines dropped]\n",
+                          dropped - reportedDrops);
+            reportedDrops = dropped;
+        }
+
+#if SERIAL_CLI_ENABLED
+        // Idle point between drains: the diagnostics CLI shares this
+        // task and its UART, so typed commands cost nothing the log
+        // stream wasn't already paying for.
+        SerialCli::poll();
+#endif
+    }
+}
+
+// ============================================================================
+// MACRO ENTRY POINTS (declared in config.h)
+// ============================================================================
+void ringLog(const char* s) {
+    RingLogger::append(s, (uint16_t)strlen(s));
+}
+
+void ringLog(const String& s) {
+    RingLogger::append(s.c_str(), (uint16_t)s.length());
+}
+
+void ringLogln(const char* s) {
+    // One record per line: the newline rides in the same copy so the
+    // drain task never interleaves two producers mid-line.
+    char line[LOG_LINE_MAX];
+    uint16_t len = (uint16_t)strlen(s);
+    if (len > LOG_LINE_MAX - 1) {
+        len = LOG_LINE_MAX - 1;
+    }
+    memcpy(line, s, len);
+    line[len] = '\n';
+    RingLogger::append(line, len + 1);
+}
+
+void ringLogln(const String& s) {
+    ringLogln(s.c_str());
+}
+
+void ringLogf(const char* fmt, ...) {
+    char line[LOG_LINE_MAX];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (len <= 0) {
+        return;
+    }
+    if (len > (int)sizeof(line) - 1) {
+        len = sizeof(line) - 1;
+    }
+    RingLogger::append(line, (uint16_t)len);
+}
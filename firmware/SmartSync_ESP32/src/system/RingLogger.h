@@ -0,0 +1,41 @@
+#ifndef RING_LOGGER_H
+#define RING_LOGGER_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Deferred UART logging behind the DEBUG_* macros. A synchronous
+// 80-char line at 115200 baud blocks the caller ~7 ms — several of
+// those per sensor cycle was real jitter on the hot path. Producers
+// now format on their own stack and copy the finished line into a
+// preallocated ring under a spinlock (microseconds), and a drain task
+// just above idle priority feeds the UART whenever nothing real wants
+// the CPU. When the ring fills, the oldest whole lines are dropped
+// and counted, so a log burst costs log lines, never latency.
+//
+// The free functions the macros call (ringLog/ringLogln/ringLogf) are
+// declared in config.h; this class is the implementation behind them.
+class RingLogger {
+public:
+    // Starts the drain task. Lines logged before this sit in the ring
+    // and flush once the task runs, so early setup() logging is kept.
+    static void begin();
+
+    static void append(const char* data, uint16_t length);
+    static uint32_t droppedLines();
+
+private:
+    static void dropOldest();
+    static void drainThunk(void* arg);
+    static void drainLoop();
+
+    static uint8_t ring[LOG_RING_BYTES];
+    static uint16_t head;      // next write offset
+    static uint16_t tail;      // next read offset
+    static uint16_t used;      // bytes in the ring
+    static uint32_t dropped;   // whole lines discarded on overflow
+    static portMUX_TYPE lock;
+    static TaskHandle_t drainTaskHandle;
+};
+
+#endif // RING_LOGGER_H
@@ -0,0 +1,263 @@
+#include "RtcClock.h"
+#include "StackPlacer.h"
+#include <Wire.h>
+#if SNTP_SYNC_ENABLED
+#include <esp_sntp.h>
+#endif
+
+static uint8_t bcdToDec(uint8_t v) {
+    return (v & 0x0F) + ((v >> 4) * 10);
+}
+
+static uint8_t decToBcd(uint8_t v) {
+    return (uint8_t)(((v / 10) << 4) | (v % 10));
+}
+
+// Days since the Unix epoch for a civil date (Howard Hinnant's
+// days-from-civil, collapsed for y >= 2000).
+static uint32_t daysFromCivil(uint16_t y, uint8_t m, uint8_t d) {
+    y -= m <= 2;
+    uint32_t era = y / 400;
+    uint32_t yoe = y - era * 400;
+    uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// Inverse of the above (civil-from-days), needed for the DS3231
+// write-back. Same source, same y >= 2000 assumption.
+static void civilFromDays(uint32_t z, uint16_t* y, uint8_t* m, uint8_t* d) {
+    z += 719468;
+    uint32_t era = z / 146097;
+    uint32_t doe = z - era * 146097;
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t yr = yoe + era * 400;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    *d = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+    *m = (uint8_t)(mp + (mp < 10 ? 3 : -9));
+    *y = (uint16_t)(yr + (*m <= 2));
+}
+
+#if SNTP_SYNC_ENABLED
+// lwIP's SNTP callbacks are C functions with no argument slot.
+static RtcClock* sntpInstance = NULL;
+
+static void onSntpTimeSync(struct timeval* tv) {
+    if (sntpInstance != NULL && tv != NULL && tv->tv_sec > 0) {
+        sntpInstance->adoptNetworkTime((uint32_t)tv->tv_sec);
+    }
+}
+#endif
+
+RtcClock::RtcClock()
+    : synced(false),
+      driftSeconds(0),
+      baseEpoch(0),
+      baseMicros(0),
+      baseLock(portMUX_INITIALIZER_UNLOCKED),
+      syncQueue(NULL),
+      resyncTimer(NULL) {
+}
+
+bool RtcClock::begin() {
+    // Boot-time seed: the one place a blocking read is acceptable.
+    uint32_t epoch = readDeviceTime();
+    if (epoch != 0) {
+        adoptBase(epoch);
+    } else {
+        DEBUG_PRINTLN("RTC: no response from DS3231");
+    }
+
+    syncQueue = xQueueCreate(2, sizeof(uint8_t));
+    // PSRAM stack: the sync loop talks I2C and adopts SNTP samples —
+    // clock arithmetic, no flash.
+    StackPlacer::createPsram(syncTaskThunk, "rtc_sync", RTC_TASK_STACK,
+                             this, RTC_TASK_PRIORITY, tskNO_AFFINITY);
+
+    esp_timer_create_args_t args = {};
+    args.callback = onResyncDue;
+    args.arg = this;
+    args.name = "rtc_resync";
+    esp_timer_create(&args, &resyncTimer);
+    esp_timer_start_periodic(resyncTimer,
+                             (uint64_t)RTC_RESYNC_INTERVAL_MS * 1000);
+
+#if SNTP_SYNC_ENABLED
+    // Fully async: sntp_init() only arms the poll; requests go out
+    // once some WiFi feature brings an interface up, and the result
+    // arrives in onSntpTimeSync on lwIP's task. The system clock is
+    // set by lwIP itself (settimeofday); we discipline our base and
+    // the DS3231 from the same sample.
+    sntpInstance = this;
+    sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    sntp_setservername(0, (char*)NTP_SERVER);
+    sntp_set_sync_interval(NTP_SYNC_INTERVAL_MS);
+    sntp_set_time_sync_notification_cb(onSntpTimeSync);
+    sntp_init();
+#endif
+    return synced;
+}
+
+uint32_t RtcClock::unixTime() const {
+    if (!synced) {
+        return 0;
+    }
+    portENTER_CRITICAL(&((RtcClock*)this)->baseLock);
+    uint32_t epoch = baseEpoch;
+    int64_t base = baseMicros;
+    portEXIT_CRITICAL(&((RtcClock*)this)->baseLock);
+    return epoch + (uint32_t)((esp_timer_get_time() - base) / 1000000LL);
+}
+
+int64_t RtcClock::unixUs() const {
+    return unixUsAt(esp_timer_get_time());
+}
+
+int64_t RtcClock::unixUsAt(int64_t monoUs) const {
+    if (!synced) {
+        return 0;
+    }
+    portENTER_CRITICAL(&((RtcClock*)this)->baseLock);
+    uint32_t epoch = baseEpoch;
+    int64_t base = baseMicros;
+    portEXIT_CRITICAL(&((RtcClock*)this)->baseLock);
+    return (int64_t)epoch * 1000000LL + (monoUs - base);
+}
+
+int8_t RtcClock::hourOfDay() const {
+    if (!synced) {
+        return -1;
+    }
+    return (int8_t)((unixTime() % 86400) / 3600);
+}
+
+void RtcClock::requestSync() {
+    if (syncQueue != NULL) {
+        uint8_t req = REQ_RESYNC;
+        xQueueSend(syncQueue, &req, 0);
+    }
+}
+
+void RtcClock::adoptNetworkTime(uint32_t epochSeconds) {
+    // Drift is what the running clock (seeded from the DS3231) had
+    // accumulated against network time; log-worthy even at 0 because
+    // a healthy DS3231 holds ±2 ppm.
+    int32_t drift = synced ? (int32_t)(epochSeconds - unixTime()) : 0;
+    adoptBase(epochSeconds);
+    driftSeconds = drift;
+    DEBUG_PRINTF("RTC: SNTP sync, drift %+d s\n", drift);
+
+    // Write-back happens on the sync task — this callback runs on
+    // lwIP's task, which must not block on a clock-stretched bus.
+    if (syncQueue != NULL) {
+        uint8_t req = REQ_WRITE_RTC;
+        xQueueSend(syncQueue, &req, 0);
+    }
+}
+
+uint32_t RtcClock::epochAtBoot() const {
+    if (!synced) {
+        return 0;
+    }
+    portENTER_CRITICAL(&((RtcClock*)this)->baseLock);
+    uint32_t epoch = baseEpoch;
+    int64_t base = baseMicros;
+    portEXIT_CRITICAL(&((RtcClock*)this)->baseLock);
+    return epoch - (uint32_t)(base / 1000000LL);
+}
+
+void RtcClock::onResyncDue(void* arg) {
+    ((RtcClock*)arg)->requestSync();
+}
+
+void RtcClock::syncTaskThunk(void* arg) {
+    ((RtcClock*)arg)->syncTaskLoop();
+}
+
+void RtcClock::syncTaskLoop() {
+    uint8_t req;
+    for (;;) {
+        if (xQueueReceive(syncQueue, &req, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        // Blocking transactions, but at a priority below every
+        // producer task: clock stretching here delays nothing that
+        // matters.
+        if (req == REQ_WRITE_RTC) {
+            // Sample the base at write time, not enqueue time, so the
+            // DS3231 lands as close to true as the bus allows.
+            if (!writeDeviceTime(unixTime())) {
+                DEBUG_PRINTLN("RTC: DS3231 write-back failed");
+            }
+            continue;
+        }
+        uint32_t epoch = readDeviceTime();
+        if (epoch != 0) {
+            int32_t drift = (int32_t)(epoch - unixTime());
+            adoptBase(epoch);
+            if (drift != 0) {
+                DEBUG_PRINTF("RTC: resync, drift %+d s\n", drift);
+            }
+        }
+    }
+}
+
+uint32_t RtcClock::readDeviceTime() {
+    Wire.beginTransmission(RTC_I2C_ADDR);
+    Wire.write(0x00); // seconds register, auto-increments
+    if (Wire.endTransmission() != 0 || Wire.requestFrom(RTC_I2C_ADDR, 7) != 7) {
+        return 0;
+    }
+
+    uint8_t sec = bcdToDec(Wire.read() & 0x7F);
+    uint8_t min = bcdToDec(Wire.read() & 0x7F);
+    uint8_t rawHour = Wire.read();
+    Wire.read(); // day of week, unused
+    uint8_t date = bcdToDec(Wire.read() & 0x3F);
+    uint8_t month = bcdToDec(Wire.read() & 0x1F);
+    uint16_t year = 2000 + bcdToDec(Wire.read());
+
+    uint8_t hour;
+    if (rawHour & 0x40) {
+        // 12-hour mode: bit 5 is AM/PM.
+        hour = bcdToDec(rawHour & 0x1F);
+        if (hour == 12) hour = 0;
+        if (rawHour & 0x20) hour += 12;
+    } else {
+        hour = bcdToDec(rawHour & 0x3F);
+    }
+
+    if (month == 0 || date == 0) {
+        return 0; // never set
+    }
+    return daysFromCivil(year, month, date) * 86400UL +
+           hour * 3600UL + min * 60UL + sec;
+}
+
+bool RtcClock::writeDeviceTime(uint32_t epochSeconds) {
+    uint16_t year;
+    uint8_t month, date;
+    civilFromDays(epochSeconds / 86400UL, &year, &month, &date);
+    uint32_t tod = epochSeconds % 86400UL;
+
+    Wire.beginTransmission(RTC_I2C_ADDR);
+    Wire.write(0x00);                              // seconds register
+    Wire.write(decToBcd((uint8_t)(tod % 60)));
+    Wire.write(decToBcd((uint8_t)((tod / 60) % 60)));
+    Wire.write(decToBcd((uint8_t)(tod / 3600)));   // 24-hour mode
+    Wire.write(1);                                 // day of week, unused
+    Wire.write(decToBcd(date));
+    Wire.write(decToBcd(month));
+    Wire.write(decToBcd((uint8_t)(year - 2000)));
+    return Wire.endTransmission() == 0;
+}
+
+void RtcClock::adoptBase(uint32_t epochSeconds) {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&baseLock);
+    baseEpoch = epochSeconds;
+    baseMicros = now;
+    portEXIT_CRITICAL(&baseLock);
+    synced = true;
+}
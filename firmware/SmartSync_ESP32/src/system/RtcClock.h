@@ -0,0 +1,94 @@
+#ifndef RTC_CLOCK_H
+#define RTC_CLOCK_H
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "../../include/config.h"
+
+// Wall-clock time from the DS3231 without putting I2C on a hot path.
+// The battery-backed registers are read once at begin() (boot only),
+// then time is maintained from esp_timer — now() and hourOfDay() are
+// pure arithmetic, no bus traffic, callable from any task.
+//
+// Drift correction runs on a dedicated low-priority task fed by a
+// request queue: a periodic timer posts a resync request, the task
+// does the blocking clock-stretched Wire transaction at a priority
+// where it can't delay sensors or BLE, and swaps the new base in
+// under a spinlock. Anyone can also post a resync with requestSync().
+//
+// When a WiFi feature has the radio up, SNTP disciplines the whole
+// chain: the async sync callback adopts network time, measures how
+// far the DS3231 had drifted, and queues a write-back so the battery
+// clock is corrected too — the main path never waits on the network.
+
+class RtcClock {
+public:
+    RtcClock();
+
+    // Seeds from the DS3231 (blocking, boot path) and starts the
+    // resync task and timer. Wire.begin() must already have run.
+    bool begin();
+
+    // Seconds since the Unix epoch, maintained from esp_timer.
+    uint32_t unixTime() const;
+
+    // Microseconds since the Unix epoch on the MonoClock timeline, or
+    // 0 until the first sync. 64-bit end to end — no wrap, no seconds
+    // truncation.
+    int64_t unixUs() const;
+
+    // Projects a stored MonoClock::nowUs() stamp onto Unix time using
+    // the current base — how history records stamped before a sync get
+    // their epoch after one. Returns 0 until the first sync.
+    int64_t unixUsAt(int64_t monoUs) const;
+
+    // Local hour 0-23, or -1 until the first successful sync.
+    int8_t hourOfDay() const;
+
+    bool isValid() const { return synced; }
+
+    // Queues an off-path resync (e.g. after the app sets the clock).
+    void requestSync();
+
+    // SNTP callback path: adopts network time as the new base, records
+    // the drift the old base had accumulated, and queues a DS3231
+    // write-back on the sync task. Safe from any task.
+    void adoptNetworkTime(uint32_t epochSeconds);
+
+    // Epoch seconds at millis() == 0, or 0 until synced. Lets the
+    // transports hand the backend one offset that converts every
+    // millis()-stamped frame and history record to real epoch time.
+    uint32_t epochAtBoot() const;
+
+    // Signed seconds the clock was off at the last SNTP sync.
+    int32_t lastDriftSeconds() const { return driftSeconds; }
+
+private:
+    enum SyncRequest : uint8_t {
+        REQ_RESYNC = 1,    // read the DS3231, adopt its time
+        REQ_WRITE_RTC = 2, // write the current base back to the DS3231
+    };
+
+    static void syncTaskThunk(void* arg);
+    void syncTaskLoop();
+    static void onResyncDue(void* arg);
+
+    // The blocking I2C transactions; read returns epoch seconds or 0.
+    uint32_t readDeviceTime();
+    bool writeDeviceTime(uint32_t epochSeconds);
+    void adoptBase(uint32_t epochSeconds);
+
+    volatile bool synced;
+    volatile int32_t driftSeconds;
+    uint32_t baseEpoch;      // device time at the last sync
+    int64_t baseMicros;      // esp_timer_get_time() at the last sync
+    mutable portMUX_TYPE baseLock;
+
+    QueueHandle_t syncQueue;
+    esp_timer_handle_t resyncTimer;
+};
+
+#endif // RTC_CLOCK_H
@@ -0,0 +1,61 @@
+#include "RtcState.h"
+#include <esp32/rom/crc.h>
+
+// Bump on any RtcStateData layout change: an old segment under a new
+// firmware must read as invalid, not as shifted fields.
+static const uint16_t RTC_STATE_VERSION = 3; // v3: warm sensor snapshot
+static const uint32_t RTC_STATE_MAGIC = 0x52544353; // "RTCS"
+
+// noinit: the boot loader leaves RTC slow memory alone, so the
+// envelope rides through every reset; validity comes from the CRC,
+// never from assuming the memory was kept.
+struct RtcStateEnvelope {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    RtcStateData payload;
+    uint32_t crc; // CRC-32 over all preceding bytes
+};
+RTC_NOINIT_ATTR static RtcStateEnvelope rtcEnvelope;
+
+bool RtcState::carried = false;
+uint32_t RtcState::uptimeBaseSec = 0;
+
+static uint32_t computeCrc() {
+    return crc32_le(0, (const uint8_t*)&rtcEnvelope,
+                    offsetof(RtcStateEnvelope, crc));
+}
+
+bool RtcState::begin() {
+    carried = rtcEnvelope.magic == RTC_STATE_MAGIC &&
+              rtcEnvelope.version == RTC_STATE_VERSION &&
+              rtcEnvelope.crc == computeCrc();
+
+    if (!carried) {
+        memset(&rtcEnvelope, 0, sizeof(rtcEnvelope));
+        rtcEnvelope.magic = RTC_STATE_MAGIC;
+        rtcEnvelope.version = RTC_STATE_VERSION;
+    }
+
+    uptimeBaseSec = rtcEnvelope.payload.uptimeAccumSec;
+    rtcEnvelope.payload.bootCount++;
+    commit();
+
+    DEBUG_PRINTF("RTC state: %s (boot %u, uptime %u s)\n",
+                 carried ? "carried across reset" : "cold start",
+                 rtcEnvelope.payload.bootCount,
+                 rtcEnvelope.payload.uptimeAccumSec);
+    return carried;
+}
+
+RtcStateData& RtcState::data() {
+    return rtcEnvelope.payload;
+}
+
+void RtcState::commit() {
+    rtcEnvelope.crc = computeCrc();
+}
+
+void RtcState::noteUptime() {
+    rtcEnvelope.payload.uptimeAccumSec = uptimeBaseSec + millis() / 1000;
+}
@@ -0,0 +1,72 @@
+#ifndef RTC_STATE_H
+#define RTC_STATE_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Small critical state persisted in RTC slow memory: survives every
+// software reset (watchdog, brownout recovery, OTA restart) at RAM
+// write cost — no flash, no wear. The segment is CRC-guarded and
+// layout-versioned like the settings blob, so a cold power-on, a bit
+// flip, or a firmware with a different layout all degrade to a clean
+// zeroed start instead of garbage being trusted.
+//
+// What lives here is deliberately minimal: the motion-timeout context
+// checkMotionTimeout() needs (so a watchdog recovery mid-night
+// neither forgets a quiet spell in progress nor re-fires the alarm it
+// already delivered), and the whole-life counters that would wear NVS
+// if committed at the rate they change.
+//
+// Usage: begin() validates once at boot; writers update fields in
+// data() and call commit() to reseal the CRC — the sensor task does
+// this once per acquisition cycle, which bounds staleness at one
+// sensor interval.
+struct RtcStateData {
+    uint32_t bootCount;      // resets of any cause since first power-on
+    uint32_t uptimeAccumSec; // cumulative uptime across all of them
+    uint32_t quietMs;        // millis since the last motion at the tick
+    uint8_t hadMotionContext;    // quietMs is meaningful (motion seen)
+    uint8_t motionTimeoutRaised; // alarm already delivered this spell
+    // Newest alert the phone has not link-layer-acknowledged yet: a
+    // reset mid-redelivery re-queues it instead of dropping it
+    // (BLEServiceManager alert indications).
+    uint8_t alertPendingValid;
+    uint8_t alertPendingType;    // AlarmSystem::AlarmType
+    uint16_t alertPendingValue;
+    uint32_t alertPendingStampMs; // millis() at raise, pre-reset epoch
+    // Last-known-good sensor snapshot: served flagged-as-stale for the
+    // first frames after a reset so a connecting app sees plausible
+    // values instead of zeros while the DHT22 warms up. Same scaled
+    // integer encoding as the wire frame.
+    uint8_t snapshotValid;
+    uint8_t snapshotOccupancy;
+    int16_t snapshotTemp;       // °C × 100
+    uint16_t snapshotHum;       // %RH × 100
+    uint16_t snapshotDist;      // cm × 10
+    uint32_t snapshotUptimeSec; // uptimeAccumSec at capture (for age)
+};
+
+class RtcState {
+public:
+    // Validates the segment against magic, layout version and CRC.
+    // Zeroes it on the first power-on or on corruption. Returns true
+    // when state carried over from before the reset.
+    static bool begin();
+
+    static RtcStateData& data();
+
+    // Reseals the CRC after a batch of field writes. A handful of
+    // RAM reads through the ROM CRC — cheap enough for every cycle.
+    static void commit();
+
+    // Cumulative uptime refresh: carried seconds plus this boot's.
+    static void noteUptime();
+
+    static bool carriedOver() { return carried; }
+
+private:
+    static bool carried;
+    static uint32_t uptimeBaseSec; // accumulated before this boot
+};
+
+#endif // RTC_STATE_H
@@ -0,0 +1,142 @@
+#include "SelfTest.h"
+
+#include "SettingsStore.h"
+#include "RtcClock.h"
+#include "EventTrace.h"
+
+SettingsStore* SelfTest::settingsStore = nullptr;
+RtcClock* SelfTest::rtcClock = nullptr;
+
+uint8_t SelfTest::checkStatus[SelfTest::CHECK_COUNT];
+uint8_t SelfTest::nextCheck = 0;
+uint32_t SelfTest::lastStepMs = 0;
+uint16_t SelfTest::cycleCount = 0;
+uint16_t SelfTest::failEventCount = 0;
+uint32_t SelfTest::lastCycleStampMs = 0;
+
+uint16_t SelfTest::motionSamples = 0;
+float SelfTest::motionDistMin = 0.0f;
+float SelfTest::motionDistMax = 0.0f;
+
+bool SelfTest::fanSawStall = false;
+bool SelfTest::fanSawHealthy = false;
+
+void SelfTest::begin(SettingsStore* settings, RtcClock* rtc) {
+    settingsStore = settings;
+    rtcClock = rtc;
+    for (uint8_t i = 0; i < CHECK_COUNT; i++) {
+        checkStatus[i] = STATUS_UNKNOWN;
+    }
+}
+
+void SelfTest::observe(float distanceCm, bool motion, int8_t fanEvidence) {
+    if (motion && distanceCm > 0.0f) {
+        if (motionSamples == 0) {
+            motionDistMin = distanceCm;
+            motionDistMax = distanceCm;
+        } else {
+            if (distanceCm < motionDistMin) motionDistMin = distanceCm;
+            if (distanceCm > motionDistMax) motionDistMax = distanceCm;
+        }
+        if (motionSamples < 0xFFFF) {
+            motionSamples++;
+        }
+    }
+
+    if (fanEvidence == 0) {
+        fanSawStall = true;
+    } else if (fanEvidence == 1) {
+        fanSawHealthy = true;
+    }
+}
+
+void SelfTest::step() {
+    uint32_t now = millis();
+    if (lastStepMs != 0 && (now - lastStepMs) < SELFTEST_STEP_INTERVAL_MS) {
+        return;
+    }
+    lastStepMs = now;
+
+    switch (nextCheck) {
+        case CHECK_COHERENCE:    checkCoherence();   break;
+        case CHECK_FAN_TACH:     checkFanTach();     break;
+        case CHECK_RTC_DRIFT:    checkRtcDrift();    break;
+        case CHECK_NVS_READBACK: checkNvsReadback(); break;
+    }
+
+    nextCheck++;
+    if (nextCheck >= CHECK_COUNT) {
+        nextCheck = 0;
+        cycleCount++;
+        lastCycleStampMs = now;
+    }
+}
+
+uint8_t SelfTest::status(uint8_t check) {
+    return (check < CHECK_COUNT) ? checkStatus[check] : (uint8_t)STATUS_UNKNOWN;
+}
+
+// Verdict bookkeeping: a transition into FAIL is the event fleet
+// monitoring counts; staying failed is not re-counted.
+void SelfTest::render(uint8_t check, uint8_t verdict) {
+    if (verdict == STATUS_FAIL && checkStatus[check] != STATUS_FAIL) {
+        failEventCount++;
+        TRACE_EVENT(TRACE_SELFTEST_FAIL, check, 0);
+        DEBUG_PRINTF("Self-test FAIL: check %u\n", check);
+    }
+    checkStatus[check] = verdict;
+}
+
+// PIR saw a person moving; a live ultrasonic channel must have seen
+// the echo move too. A frozen span across a whole motion window means
+// a stuck transducer (or one unplugged after service) even while it
+// keeps returning plausible-looking values.
+void SelfTest::checkCoherence() {
+    if (motionSamples < SELFTEST_COHERENCE_MIN_SAMPLES) {
+        return; // not enough evidence this window; verdict stands
+    }
+    float span = motionDistMax - motionDistMin;
+    render(CHECK_COHERENCE, span >= SELFTEST_COHERENCE_DIST_DELTA_CM
+                                ? STATUS_PASS : STATUS_FAIL);
+    motionSamples = 0;
+}
+
+// Consumes the stall evidence the existing checkFanStall() debounce
+// latched since the last cycle. No evidence either way (fan off all
+// along) leaves the verdict standing.
+void SelfTest::checkFanTach() {
+    if (fanSawStall) {
+        render(CHECK_FAN_TACH, STATUS_FAIL);
+    } else if (fanSawHealthy) {
+        render(CHECK_FAN_TACH, STATUS_PASS);
+    }
+    fanSawStall = false;
+    fanSawHealthy = false;
+}
+
+// The SNTP sync path already measures how far the DS3231 had drifted;
+// this only renders a verdict on that number. Unsynced clocks stay
+// UNKNOWN rather than failing units that never see the network.
+void SelfTest::checkRtcDrift() {
+    if (rtcClock == nullptr || !rtcClock->isValid()) {
+        return;
+    }
+    int32_t drift = rtcClock->lastDriftSeconds();
+    if (drift < 0) {
+        drift = -drift;
+    }
+    render(CHECK_RTC_DRIFT, drift <= SELFTEST_RTC_DRIFT_MAX_S
+                                ? STATUS_PASS : STATUS_FAIL);
+}
+
+// Re-reads the active settings journal slot from NVS and re-validates
+// version + CRC — the read-back catches silent flash corruption
+// between commits, while both journal copies still exist to recover
+// from. Blocking flash read, which is why step() is idle-slice only.
+void SelfTest::checkNvsReadback() {
+    if (settingsStore == nullptr) {
+        return;
+    }
+    render(CHECK_NVS_READBACK, settingsStore->verifyActiveSlot()
+                                   ? STATUS_PASS : STATUS_FAIL);
+}
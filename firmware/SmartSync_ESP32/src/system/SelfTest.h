@@ -0,0 +1,80 @@
+#ifndef SELF_TEST_H
+#define SELF_TEST_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+class SettingsStore;
+class RtcClock;
+
+// Background self-test engine, scheduled strictly in idle slices of
+// the sensor task: one bounded check per quiet slice (nothing waiting
+// on the event queue), cycling through sensor coherence, fan tach,
+// RTC drift, and an NVS read-back spot check. A real event pre-empts
+// simply by existing — the slice is skipped, never interrupted.
+//
+// Evidence accumulates for free on the sensor read path (observe());
+// the checks only render verdicts. Results surface through
+// CMD_GET_SELFTEST as a SelfTestFrame so fleet monitoring sees a dead
+// DHT22, a stuck fan, or a drifting DS3231 days before a user does.
+class SelfTest {
+public:
+    enum CheckId : uint8_t {
+        CHECK_COHERENCE = 0,    // ultrasonic echo moves when PIR does
+        CHECK_FAN_TACH = 1,     // commanded duty produces tach pulses
+        CHECK_RTC_DRIFT = 2,    // DS3231 drift at last SNTP sync
+        CHECK_NVS_READBACK = 3, // active settings journal slot re-validates
+        CHECK_COUNT = 4,
+    };
+
+    enum CheckStatus : uint8_t {
+        STATUS_UNKNOWN = 0, // not enough evidence yet
+        STATUS_PASS = 1,
+        STATUS_FAIL = 2,
+    };
+
+    static void begin(SettingsStore* settings, RtcClock* rtc);
+
+    // Evidence accumulation, called once per sensor read. Cheap
+    // (comparisons and a min/max), no verdicts here. fanEvidence:
+    // 1 = duty high enough and tach agrees, 0 = stall latched,
+    // -1 = fan too slow to judge.
+    static void observe(float distanceCm, bool motion, int8_t fanEvidence);
+
+    // Runs at most one check, interval-gated internally. Call only
+    // from an idle slice — the NVS check does a blocking flash read.
+    static void step();
+
+    static uint8_t status(uint8_t check);
+    static uint16_t cycles() { return cycleCount; }
+    static uint16_t failEvents() { return failEventCount; }
+    static uint32_t lastCycleMs() { return lastCycleStampMs; }
+
+private:
+    static void render(uint8_t check, uint8_t verdict);
+    static void checkCoherence();
+    static void checkFanTach();
+    static void checkRtcDrift();
+    static void checkNvsReadback();
+
+    static SettingsStore* settingsStore;
+    static RtcClock* rtcClock;
+
+    static uint8_t checkStatus[CHECK_COUNT];
+    static uint8_t nextCheck;
+    static uint32_t lastStepMs;
+    static uint16_t cycleCount;
+    static uint16_t failEventCount;
+    static uint32_t lastCycleStampMs;
+
+    // Coherence window: distance span observed while PIR held motion.
+    static uint16_t motionSamples;
+    static float motionDistMin;
+    static float motionDistMax;
+
+    // Fan evidence latches until the next CHECK_FAN_TACH consumes them.
+    static bool fanSawStall;
+    static bool fanSawHealthy;
+};
+
+#endif // SELF_TEST_H
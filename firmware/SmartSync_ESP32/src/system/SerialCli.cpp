@@ -0,0 +1,245 @@
+#include "SerialCli.h"
+
+#if SERIAL_CLI_ENABLED
+
+#include <stdlib.h>
+#include <esp_system.h>
+#include <esp_heap_caps.h>
+#include "BulkDump.h"
+#include "EventTrace.h"
+#include "RingLogger.h"
+#include "SettingsStore.h"
+#include "StateStore.h"
+#include "../ble/CommandParser.h"
+
+char SerialCli::line[CLI_LINE_MAX];
+uint8_t SerialCli::lineLen = 0;
+StateStore* SerialCli::state = NULL;
+SettingsStore* SerialCli::settings = NULL;
+SerialCli::CommandSink SerialCli::sink = NULL;
+
+// Replies go straight to Serial, not through the log ring: they run on
+// the drain task (the UART's owner), and a diagnostics answer must not
+// be droppable the way log lines are.
+
+const SerialCli::CliCommand SerialCli::COMMANDS[] = {
+    { "help",     "list commands",                     &SerialCli::cmdHelp },
+    { "status",   "control state and uptime",          &SerialCli::cmdStatus },
+    { "stats",    "heap and log-ring counters",        &SerialCli::cmdStats },
+    { "nvs",      "dump the persisted settings blob",  &SerialCli::cmdNvs },
+    { "trace",    "trace [n]: last n events (def 16)", &SerialCli::cmdTrace },
+    { "dump",     "dump <history|trace|core> [baud]",  &SerialCli::cmdDump },
+    { "fan",      "fan <0-255>: set fan duty",         &SerialCli::cmdFan },
+    { "led",      "led <0-255>: set LED brightness",   &SerialCli::cmdLed },
+    { "auto",     "auto <0|1>: auto mode off/on",      &SerialCli::cmdAuto },
+    { "setpoint", "setpoint <centi-degC>: PID target", &SerialCli::cmdSetpoint },
+    { NULL, NULL, NULL },
+};
+
+void SerialCli::begin(StateStore* stateStore, SettingsStore* settingsStore,
+                      CommandSink commandSink) {
+    state = stateStore;
+    settings = settingsStore;
+    sink = commandSink;
+}
+
+void SerialCli::poll() {
+    while (Serial.available() > 0) {
+        char c = (char)Serial.read();
+        if (c == '\n' || c == '\r') {
+            if (lineLen > 0) {
+                Serial.write('\n');
+                execute();
+                lineLen = 0;
+            }
+            continue;
+        }
+        if (c == 0x08 || c == 0x7F) { // backspace / delete
+            if (lineLen > 0) {
+                lineLen--;
+                Serial.print("\b \b");
+            }
+            continue;
+        }
+        if (c >= 0x20 && c < 0x7F && lineLen < sizeof(line) - 1) {
+            line[lineLen++] = c;
+            Serial.write(c); // echo for terminals without local echo
+        }
+    }
+}
+
+// Nul-terminates tokens in place over the line buffer; anything past
+// CLI_MAX_ARGS is ignored rather than erred on.
+uint8_t SerialCli::tokenize(char** argv) {
+    line[lineLen] = '\0';
+    uint8_t argc = 0;
+    char* p = line;
+    while (*p != '\0' && argc < CLI_MAX_ARGS) {
+        while (*p == ' ') {
+            *p++ = '\0';
+        }
+        if (*p == '\0') {
+            break;
+        }
+        argv[argc++] = p;
+        while (*p != '\0' && *p != ' ') {
+            p++;
+        }
+    }
+    return argc;
+}
+
+void SerialCli::execute() {
+    char* argv[CLI_MAX_ARGS];
+    uint8_t argc = tokenize(argv);
+    if (argc == 0) {
+        return;
+    }
+    for (const CliCommand* cmd = COMMANDS; cmd->name != NULL; cmd++) {
+        if (strcmp(argv[0], cmd->name) == 0) {
+            cmd->handler(argc, argv);
+            return;
+        }
+    }
+    Serial.printf("cli: unknown command '%s' (try 'help')\n", argv[0]);
+}
+
+bool SerialCli::parseLong(const char* s, long min, long max, long& out) {
+    char* end = NULL;
+    long value = strtol(s, &end, 0);
+    if (end == s || *end != '\0' || value < min || value > max) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+void SerialCli::send(uint8_t opcode, const uint8_t* payload,
+                     uint8_t length) {
+    if (sink == NULL) {
+        Serial.println("cli: no command sink registered");
+        return;
+    }
+    sink(opcode, payload, length);
+    Serial.println("cli: queued");
+}
+
+// ============================================================================
+// COMMAND HANDLERS
+// ============================================================================
+
+void SerialCli::cmdHelp(uint8_t argc, char** argv) {
+    for (const CliCommand* cmd = COMMANDS; cmd->name != NULL; cmd++) {
+        Serial.printf("  %-9s %s\n", cmd->name, cmd->help);
+    }
+}
+
+void SerialCli::cmdStatus(uint8_t argc, char** argv) {
+    if (state == NULL) {
+        return;
+    }
+    Serial.printf("fan=%u led=%u auto=%u setpoint=%d centi-degC\n",
+                  state->fanSpeed(), state->ledBrightness(),
+                  state->autoMode() ? 1 : 0, state->setpointCenti());
+    Serial.printf("uptime=%lu s\n", (unsigned long)(millis() / 1000));
+}
+
+void SerialCli::cmdStats(uint8_t argc, char** argv) {
+    Serial.printf("heap: free=%u min=%u largest=%u\n",
+                  (unsigned)esp_get_free_heap_size(),
+                  (unsigned)esp_get_minimum_free_heap_size(),
+                  (unsigned)heap_caps_get_largest_free_block(
+                      MALLOC_CAP_8BIT));
+    Serial.printf("log: dropped=%u\n",
+                  (unsigned)RingLogger::droppedLines());
+}
+
+void SerialCli::cmdNvs(uint8_t argc, char** argv) {
+    if (settings == NULL) {
+        return;
+    }
+    const PersistedSettings& s = settings->data();
+    Serial.printf("blob v%u gen=%u\n", s.version, (unsigned)s.generation);
+    Serial.printf("auto=%u fan=%u led=%u setpoint=%d\n", s.autoMode,
+                  s.fanSpeed, s.ledBrightness, s.fanSetpointCenti);
+    Serial.printf("deviceId=%08x pin=%s\n", (unsigned)s.deviceId,
+                  s.devicePin != 0 ? "set" : "unset");
+    Serial.printf("wear: commits=%u erases=%u\n", (unsigned)s.nvsCommits,
+                  (unsigned)s.historyErases);
+}
+
+void SerialCli::cmdTrace(uint8_t argc, char** argv) {
+    long count = 16;
+    if (argc > 1 && !parseLong(argv[1], 1, 256, count)) {
+        Serial.println("usage: trace [1-256]");
+        return;
+    }
+    uint32_t available = EventTrace::available();
+    if ((uint32_t)count > available) {
+        count = (long)available;
+    }
+    uint32_t seq = EventTrace::writeSequence() - (uint32_t)count;
+    TraceRecord rec;
+    for (; count > 0; count--, seq++) {
+        // A record overwritten mid-walk just drops out of the dump.
+        if (EventTrace::read(seq, rec)) {
+            Serial.printf("%10u ms  id=%u a8=%u a16=%u\n",
+                          (unsigned)rec.ms, rec.id, rec.arg8, rec.arg16);
+        }
+    }
+}
+
+void SerialCli::cmdDump(uint8_t argc, char** argv) {
+    long baud = BULK_DUMP_BAUD;
+    if (argc > 2 && !parseLong(argv[2], 115200, 2000000, baud)) {
+        Serial.println("usage: dump <history|trace|core> [baud]");
+        return;
+    }
+    if (argc < 2 || !BulkDump::run(argv[1], (uint32_t)baud)) {
+        Serial.println("usage: dump <history|trace|core> [baud]");
+    }
+}
+
+void SerialCli::cmdFan(uint8_t argc, char** argv) {
+    long value;
+    if (argc < 2 || !parseLong(argv[1], 0, 255, value)) {
+        Serial.println("usage: fan <0-255>");
+        return;
+    }
+    uint8_t payload = (uint8_t)value;
+    send(CMD_SET_FAN, &payload, 1);
+}
+
+void SerialCli::cmdLed(uint8_t argc, char** argv) {
+    long value;
+    if (argc < 2 || !parseLong(argv[1], 0, 255, value)) {
+        Serial.println("usage: led <0-255>");
+        return;
+    }
+    uint8_t payload = (uint8_t)value;
+    send(CMD_SET_LED, &payload, 1);
+}
+
+void SerialCli::cmdAuto(uint8_t argc, char** argv) {
+    long value;
+    if (argc < 2 || !parseLong(argv[1], 0, 1, value)) {
+        Serial.println("usage: auto <0|1>");
+        return;
+    }
+    uint8_t payload = (uint8_t)value;
+    send(CMD_SET_AUTO, &payload, 1);
+}
+
+void SerialCli::cmdSetpoint(uint8_t argc, char** argv) {
+    long value;
+    if (argc < 2 || !parseLong(argv[1], -4000, 8000, value)) {
+        Serial.println("usage: setpoint <centi-degC>");
+        return;
+    }
+    int16_t centi = (int16_t)value;
+    uint8_t payload[2];
+    memcpy(payload, &centi, sizeof(centi));
+    send(CMD_SET_SETPOINT, payload, sizeof(payload));
+}
+
+#endif // SERIAL_CLI_ENABLED
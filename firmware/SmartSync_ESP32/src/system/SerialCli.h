@@ -0,0 +1,72 @@
+#ifndef SERIAL_CLI_H
+#define SERIAL_CLI_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+class StateStore;
+class SettingsStore;
+
+// Serial diagnostics console for bench and field work. A technician
+// with a USB cable previously had only the DEBUG_PRINTF stream — read
+// everything, change nothing. This is a fixed-table command registry
+// (status, stats, nvs dump, trace dump, actuator test commands) over a
+// static line buffer tokenized in place: no heap, no new task. The
+// log drain task polls it at its idle point, so typed commands ride
+// the same just-above-idle slice as log output and never perturb the
+// measured system; replies interleave with the log stream on the same
+// UART the drain task already owns.
+//
+// Actuation commands do not touch hardware here — they feed the
+// registered sink, which enqueues onto the command task exactly like
+// the BLE and mesh sources, so a typed `fan 128` takes the same
+// validated path as the app's.
+class SerialCli {
+public:
+    // Same shape as EspNowMesh::CommandSink: a normalized opcode plus
+    // payload, handed to main.cpp to enqueue. Runs on the drain task.
+    typedef void (*CommandSink)(uint8_t opcode, const uint8_t* payload,
+                                uint8_t length);
+
+    static void begin(StateStore* state, SettingsStore* settings,
+                      CommandSink sink);
+
+    // Called by RingLogger::drainLoop between drains (~100 ms cadence,
+    // sooner when logging is busy). Consumes pending UART input and
+    // executes at most the lines it completes.
+    static void poll();
+
+private:
+    struct CliCommand {
+        const char* name;
+        const char* help;
+        void (*handler)(uint8_t argc, char** argv);
+    };
+
+    static void execute();
+    static uint8_t tokenize(char** argv);
+    static bool parseLong(const char* s, long min, long max, long& out);
+    static void send(uint8_t opcode, const uint8_t* payload,
+                     uint8_t length);
+
+    static void cmdHelp(uint8_t argc, char** argv);
+    static void cmdStatus(uint8_t argc, char** argv);
+    static void cmdStats(uint8_t argc, char** argv);
+    static void cmdNvs(uint8_t argc, char** argv);
+    static void cmdTrace(uint8_t argc, char** argv);
+    static void cmdDump(uint8_t argc, char** argv);
+    static void cmdFan(uint8_t argc, char** argv);
+    static void cmdLed(uint8_t argc, char** argv);
+    static void cmdAuto(uint8_t argc, char** argv);
+    static void cmdSetpoint(uint8_t argc, char** argv);
+
+    static const CliCommand COMMANDS[]; // NULL-name terminated
+
+    static char line[CLI_LINE_MAX];
+    static uint8_t lineLen;
+    static StateStore* state;
+    static SettingsStore* settings;
+    static CommandSink sink;
+};
+
+#endif // SERIAL_CLI_H
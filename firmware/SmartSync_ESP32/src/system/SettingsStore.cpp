@@ -0,0 +1,401 @@
+#include "SettingsStore.h"
+#include <esp32/rom/crc.h>
+#include "../sensors/Calibration.h"
+
+// Older blob layouts, kept for migration.
+struct __attribute__((packed)) PersistedSettingsV1 {
+    uint16_t version;
+    uint8_t autoMode;
+    uint8_t fanSpeed;
+    uint8_t ledBrightness;
+    uint8_t reserved[3];
+    uint32_t deviceId;
+    uint32_t devicePin;
+    uint32_t crc;
+};
+
+struct __attribute__((packed)) PersistedSettingsV2 {
+    uint16_t version;
+    uint8_t autoMode;
+    uint8_t fanSpeed;
+    uint8_t ledBrightness;
+    uint8_t reserved[3];
+    uint32_t deviceId;
+    uint32_t devicePin;
+    uint32_t nvsCommits;
+    uint32_t historyErases;
+    uint32_t crc;
+};
+
+// First journaled layout (pre-calibration), kept for slot migration.
+struct __attribute__((packed)) PersistedSettingsV3 {
+    uint16_t version;
+    uint8_t autoMode;
+    uint8_t fanSpeed;
+    uint8_t ledBrightness;
+    uint8_t reserved[3];
+    uint32_t deviceId;
+    uint32_t devicePin;
+    uint32_t nvsCommits;
+    uint32_t historyErases;
+    uint32_t generation;
+    uint32_t crc;
+};
+
+
+// Pre-schedule journaled layout, kept for slot migration.
+struct __attribute__((packed)) PersistedSettingsV4 {
+    uint16_t version;
+    uint8_t autoMode;
+    uint8_t fanSpeed;
+    uint8_t ledBrightness;
+    uint8_t reserved[3];
+    uint32_t deviceId;
+    uint32_t devicePin;
+    uint32_t nvsCommits;
+    uint32_t historyErases;
+    uint32_t generation;
+    int16_t calTempOffset[DHT_SENSOR_COUNT];
+    int16_t calHumOffset[DHT_SENSOR_COUNT];
+    uint16_t calDistScaleQ15[ULTRASONIC_SENSOR_COUNT];
+    uint32_t crc;
+};
+
+// Pre-scene journaled layout, kept for slot migration.
+struct __attribute__((packed)) PersistedSettingsV5 {
+    uint16_t version;
+    uint8_t autoMode;
+    uint8_t fanSpeed;
+    uint8_t ledBrightness;
+    uint8_t reserved[3];
+    uint32_t deviceId;
+    uint32_t devicePin;
+    uint32_t nvsCommits;
+    uint32_t historyErases;
+    uint32_t generation;
+    int16_t calTempOffset[DHT_SENSOR_COUNT];
+    int16_t calHumOffset[DHT_SENSOR_COUNT];
+    uint16_t calDistScaleQ15[ULTRASONIC_SENSOR_COUNT];
+    ScheduleEntry schedules[SCHEDULE_MAX_ENTRIES];
+    uint32_t crc;
+};
+
+// Pre-setpoint journaled layout, kept for slot migration.
+struct __attribute__((packed)) PersistedSettingsV6 {
+    uint16_t version;
+    uint8_t autoMode;
+    uint8_t fanSpeed;
+    uint8_t ledBrightness;
+    uint8_t reserved[3];
+    uint32_t deviceId;
+    uint32_t devicePin;
+    uint32_t nvsCommits;
+    uint32_t historyErases;
+    uint32_t generation;
+    int16_t calTempOffset[DHT_SENSOR_COUNT];
+    int16_t calHumOffset[DHT_SENSOR_COUNT];
+    uint16_t calDistScaleQ15[ULTRASONIC_SENSOR_COUNT];
+    ScheduleEntry schedules[SCHEDULE_MAX_ENTRIES];
+    ScenePreset scenes[SCENE_MAX_COUNT];
+    uint32_t crc;
+};
+
+// The migration chain relies on every journal layout being a strict
+// prefix of its successor (the CRC trails, new fields land ahead of
+// it): an old blob's bytes already sit at their current offsets, and
+// upgrading is seeding the fields each skipped version introduced.
+// These guards catch a future layout change that silently breaks the
+// property.
+static_assert(offsetof(PersistedSettingsV3, generation) ==
+              offsetof(PersistedSettings, generation),
+              "journal layouts must extend by appending before the CRC");
+static_assert(offsetof(PersistedSettingsV6, scenes) ==
+              offsetof(PersistedSettings, scenes),
+              "journal layouts must extend by appending before the CRC");
+
+// On-flash size of each historical journal layout; identifies which
+// version a slot holds and where its CRC sits.
+static size_t journalBlobSize(uint16_t version) {
+    switch (version) {
+        case 3: return sizeof(PersistedSettingsV3);
+        case 4: return sizeof(PersistedSettingsV4);
+        case 5: return sizeof(PersistedSettingsV5);
+        case 6: return sizeof(PersistedSettingsV6);
+    }
+    return 0;
+}
+
+SettingsStore::SettingsStore() : nextSlot(0) {
+    loadDefaults();
+}
+
+// ============================================================================
+// LOAD
+// ============================================================================
+const char* SettingsStore::slotKey(uint8_t slot) const {
+    return (slot == 0) ? PREF_SETTINGS_SLOT_A : PREF_SETTINGS_SLOT_B;
+}
+
+bool SettingsStore::loadSlot(uint8_t slot, PersistedSettings& out) {
+    size_t got = prefs.getBytes(slotKey(slot), &out, sizeof(out));
+    return got == sizeof(out) &&
+           out.version == SETTINGS_BLOB_VERSION &&
+           out.crc == computeCrc(out);
+}
+
+bool SettingsStore::begin() {
+    prefs.begin(PREF_NAMESPACE, false);
+
+    // Journal recovery: a torn commit leaves at most one invalid slot,
+    // and the other still holds the last completed generation.
+    PersistedSettings slotA, slotB;
+    bool aValid = loadSlot(0, slotA);
+    bool bValid = loadSlot(1, slotB);
+
+    if (aValid || bValid) {
+        uint8_t active;
+        if (aValid && bValid) {
+            active = (slotA.generation >= slotB.generation) ? 0 : 1;
+        } else {
+            active = aValid ? 0 : 1;
+        }
+        settings = (active == 0) ? slotA : slotB;
+        nextSlot = active ^ 1;
+        DEBUG_PRINTF("Settings loaded (slot %c, gen %u)\n",
+                     'A' + active, settings.generation);
+        return true;
+    }
+
+    // No valid current-version journal: maybe the slots hold an older
+    // layout. The chain upgrades any of them in one RAM pass and the
+    // commit below is the upgrade's only flash write.
+    if (migrateJournal()) {
+        commit();
+        return true;
+    }
+
+    // No journal yet: first boot after the upgrade (or a fresh unit).
+    if (migrateLegacyBlob()) {
+        DEBUG_PRINTLN("Settings migrated from single-key blob");
+    } else if (migrateLegacyKeys()) {
+        DEBUG_PRINTLN("Settings migrated from per-key storage");
+    } else {
+        DEBUG_PRINTLN("Settings initialized to defaults");
+    }
+    commit();
+    return true;
+}
+
+void SettingsStore::loadDefaults() {
+    memset(&settings, 0, sizeof(settings));
+    settings.version = SETTINGS_BLOB_VERSION;
+    settings.autoMode = 0;
+    settings.fanSpeed = 0;
+    settings.ledBrightness = 128;
+    loadCalibrationDefaults();
+}
+
+// Seed the per-unit calibration from the config tables, converted to
+// fixed point at compile time.
+void SettingsStore::loadCalibrationDefaults() {
+    static const float kTempOffsets[DHT_SENSOR_COUNT] = CAL_TEMP_OFFSETS;
+    static const float kHumOffsets[DHT_SENSOR_COUNT] = CAL_HUM_OFFSETS;
+    static const float kDistScales[ULTRASONIC_SENSOR_COUNT] = CAL_DIST_SCALES;
+
+    for (uint8_t i = 0; i < DHT_SENSOR_COUNT; i++) {
+        settings.calTempOffset[i] = calOffsetCenti(kTempOffsets[i]);
+        settings.calHumOffset[i] = calOffsetCenti(kHumOffsets[i]);
+    }
+    for (uint8_t i = 0; i < ULTRASONIC_SENSOR_COUNT; i++) {
+        settings.calDistScaleQ15[i] = calScaleQ15(kDistScales[i]);
+    }
+}
+
+// Versioned journal migration, any prior version to current in one
+// pass: find the newest valid slot of any historical layout, lay its
+// bytes into the current struct (they already sit at the right
+// offsets — see the prefix static_asserts), then walk the chain and
+// seed what each skipped version added. No flash is touched here; the
+// caller's commit() is the upgrade's single write.
+//
+// Adding a v(N+1) costs one journalBlobSize() entry plus one case in
+// the seeder switch — the v3..vN hops are already in the chain.
+bool SettingsStore::migrateJournal() {
+    uint8_t best[sizeof(PersistedSettings)];
+    uint16_t bestVersion = 0;
+    uint32_t bestGeneration = 0;
+    bool found = false;
+
+    for (uint8_t slot = 0; slot < 2; slot++) {
+        uint8_t raw[sizeof(PersistedSettings)];
+        size_t got = prefs.getBytes(slotKey(slot), raw, sizeof(raw));
+        if (got < sizeof(uint16_t)) {
+            continue;
+        }
+
+        uint16_t version;
+        memcpy(&version, raw, sizeof(version));
+        size_t expect = journalBlobSize(version);
+        if (expect == 0 || got != expect) {
+            continue;
+        }
+
+        uint32_t storedCrc;
+        memcpy(&storedCrc, raw + expect - sizeof(uint32_t), sizeof(storedCrc));
+        if (storedCrc != crc32_le(0, raw, expect - sizeof(uint32_t))) {
+            continue;
+        }
+
+        uint32_t generation;
+        memcpy(&generation,
+               raw + offsetof(PersistedSettings, generation),
+               sizeof(generation));
+        if (!found || generation > bestGeneration) {
+            memcpy(best, raw, expect);
+            bestVersion = version;
+            bestGeneration = generation;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    // Lay the old fields in at their unchanged offsets (minus the old
+    // trailing CRC — a current field lives where it sat); everything
+    // newer starts zeroed and the seeders overwrite where zero isn't
+    // the right default.
+    memset(&settings, 0, sizeof(settings));
+    memcpy(&settings, best, journalBlobSize(bestVersion) - sizeof(uint32_t));
+
+    for (uint16_t v = bestVersion; v < SETTINGS_BLOB_VERSION; v++) {
+        switch (v) {
+            case 3: // v4 added per-unit calibration
+                loadCalibrationDefaults();
+                break;
+            case 4: // v5 added schedules: empty slots are zeroed
+            case 5: // v6 added scenes: empty slots are zeroed
+            case 6: // v7 added the setpoint override: 0 = not customized
+                break;
+        }
+    }
+
+    DEBUG_PRINTF("Settings migrated v%u -> v%u (gen %u, one pass)\n",
+                 bestVersion, SETTINGS_BLOB_VERSION, bestGeneration);
+    return true;
+}
+
+// Pre-journal single-key blob (v1 or v2): carry the fields over into
+// the journal, then drop the old key.
+bool SettingsStore::migrateLegacyBlob() {
+    uint8_t raw[sizeof(PersistedSettingsV2)];
+    size_t got = prefs.getBytes(PREF_SETTINGS_BLOB, raw, sizeof(raw));
+    if (got == 0) {
+        return false;
+    }
+
+    loadDefaults();
+    bool valid = false;
+
+    if (got == sizeof(PersistedSettingsV2)) {
+        PersistedSettingsV2 v2;
+        memcpy(&v2, raw, sizeof(v2));
+        if (v2.version == 2 &&
+            v2.crc == crc32_le(0, (const uint8_t*)&v2,
+                               sizeof(v2) - sizeof(uint32_t))) {
+            settings.autoMode = v2.autoMode;
+            settings.fanSpeed = v2.fanSpeed;
+            settings.ledBrightness = v2.ledBrightness;
+            settings.deviceId = v2.deviceId;
+            settings.devicePin = v2.devicePin;
+            settings.nvsCommits = v2.nvsCommits;
+            settings.historyErases = v2.historyErases;
+            valid = true;
+        }
+    } else if (got == sizeof(PersistedSettingsV1)) {
+        PersistedSettingsV1 v1;
+        memcpy(&v1, raw, sizeof(v1));
+        if (v1.version == 1 &&
+            v1.crc == crc32_le(0, (const uint8_t*)&v1,
+                               sizeof(v1) - sizeof(uint32_t))) {
+            settings.autoMode = v1.autoMode;
+            settings.fanSpeed = v1.fanSpeed;
+            settings.ledBrightness = v1.ledBrightness;
+            settings.deviceId = v1.deviceId;
+            settings.devicePin = v1.devicePin;
+            valid = true;
+        }
+    }
+
+    prefs.remove(PREF_SETTINGS_BLOB);
+    return valid;
+}
+
+// One-time migration: pull whatever legacy keys exist into the blob,
+// then drop them so future boots do the single read only.
+bool SettingsStore::migrateLegacyKeys() {
+    bool found = false;
+
+    if (prefs.isKey(PREF_AUTO_MODE)) {
+        settings.autoMode = prefs.getBool(PREF_AUTO_MODE, false) ? 1 : 0;
+        prefs.remove(PREF_AUTO_MODE);
+        found = true;
+    }
+    if (prefs.isKey(PREF_FAN_SPEED)) {
+        settings.fanSpeed = (uint8_t)prefs.getUInt(PREF_FAN_SPEED, 0);
+        prefs.remove(PREF_FAN_SPEED);
+        found = true;
+    }
+    if (prefs.isKey(PREF_LED_BRIGHTNESS)) {
+        settings.ledBrightness = (uint8_t)prefs.getUInt(PREF_LED_BRIGHTNESS, 128);
+        prefs.remove(PREF_LED_BRIGHTNESS);
+        found = true;
+    }
+    if (prefs.isKey(PREF_DEVICE_ID)) {
+        settings.deviceId = prefs.getUInt(PREF_DEVICE_ID, 0);
+        prefs.remove(PREF_DEVICE_ID);
+        found = true;
+    }
+    if (prefs.isKey(PREF_DEVICE_PIN)) {
+        settings.devicePin = prefs.getUInt(PREF_DEVICE_PIN, 0);
+        prefs.remove(PREF_DEVICE_PIN);
+        found = true;
+    }
+
+    return found;
+}
+
+// ============================================================================
+// COMMIT
+// ============================================================================
+bool SettingsStore::commit() {
+    settings.version = SETTINGS_BLOB_VERSION;
+    settings.nvsCommits++; // wear telemetry: every commit counts itself
+    settings.generation++;
+    settings.crc = computeCrc(settings);
+
+    // Phase 1: program the inactive slot. Phase 2 is implicit — the
+    // CRC landing with the higher generation makes this slot active.
+    // The previously-active slot stays untouched as the rollback copy.
+    size_t written = prefs.putBytes(slotKey(nextSlot), &settings,
+                                    sizeof(settings));
+    if (written != sizeof(settings)) {
+        return false;
+    }
+
+    nextSlot ^= 1;
+    return true;
+}
+
+bool SettingsStore::verifyActiveSlot() {
+    // begin() always ends in a commit, so the slot behind nextSlot is
+    // the last completed generation on every boot path.
+    PersistedSettings probe;
+    return loadSlot((uint8_t)(nextSlot ^ 1), probe);
+}
+
+uint32_t SettingsStore::computeCrc(const PersistedSettings& s) const {
+    return crc32_le(0, (const uint8_t*)&s,
+                    sizeof(PersistedSettings) - sizeof(uint32_t));
+}
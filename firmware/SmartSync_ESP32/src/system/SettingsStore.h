@@ -0,0 +1,98 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "../../include/config.h"
+
+// All persisted settings as one versioned, CRC-guarded NVS blob:
+// a single flash read at boot, a single atomic write per commit.
+// Adding a future setting is a new field plus a version bump — not
+// another per-key NVS transaction in every setter.
+//
+// Commits are journaled across two slots (A/B): each commit writes
+// the INACTIVE slot with a bumped generation counter, and the CRC
+// landing makes that slot the new active one. A brownout mid-write
+// can only tear the inactive slot, so load always finds the last
+// fully-committed generation — never defaults.
+//
+// Schema upgrades run as a chain in RAM: every journal layout since
+// v3 extends the previous one in place (new fields slot in ahead of
+// the trailing CRC), so a unit on any prior version loads its old
+// bytes once, runs the seeders for each version it skipped, and
+// commits exactly once — flash cost of an upgrade is one slot write
+// regardless of how many releases the unit missed.
+//
+// On first boot after the pre-journal upgrade the store migrates the
+// legacy per-key values (PREF_AUTO_MODE, PREF_FAN_SPEED, ...) into
+// the blob and removes the old keys.
+
+#define SETTINGS_BLOB_VERSION 7
+
+struct __attribute__((packed)) PersistedSettings {
+    uint16_t version;       // SETTINGS_BLOB_VERSION
+    uint8_t autoMode;       // bool
+    uint8_t fanSpeed;       // raw PWM duty
+    uint8_t ledBrightness;  // raw PWM duty
+    uint8_t reserved[3];    // future fields; zeroed
+    uint32_t deviceId;
+    uint32_t devicePin;
+    // v2: lifetime flash wear counters. Living inside the blob, they
+    // ride along with normal commits and never cost an extra write.
+    uint32_t nvsCommits;    // settings-blob commits, lifetime
+    uint32_t historyErases; // history-log sector erases, lifetime
+    // v3: journal generation. Monotonic across commits; the valid
+    // slot with the highest generation wins at load.
+    uint32_t generation;
+    // v4: per-unit calibration in fixed point (sensors/Calibration.h),
+    // one entry per configured channel. Note the blob size follows the
+    // channel counts: changing them invalidates stored blobs.
+    int16_t calTempOffset[DHT_SENSOR_COUNT];        // °C × 100
+    int16_t calHumOffset[DHT_SENSOR_COUNT];         // %RH × 100
+    uint16_t calDistScaleQ15[ULTRASONIC_SENSOR_COUNT]; // 32768 = unity
+    // v5: schedule entries (ScheduleManager); empty slots are zeroed.
+    ScheduleEntry schedules[SCHEDULE_MAX_ENTRIES];
+    // v6: scene presets (CMD_SET_SCENE); empty slots are zeroed.
+    ScenePreset scenes[SCENE_MAX_COUNT];
+    // v7: user fan setpoint override, centi-°C (CMD_SET_SETPOINT);
+    // 0 means "not customized", use FAN_PID_SETPOINT_C.
+    int16_t fanSetpointCenti;
+    uint32_t crc;           // CRC-32 over all preceding bytes
+};
+
+class SettingsStore {
+public:
+    SettingsStore();
+
+    // Loads the newest valid journal slot. Falls back to legacy
+    // single-key and per-key migration, then to defaults.
+    bool begin();
+
+    // In-RAM settings; mutate then commit().
+    PersistedSettings& data() { return settings; }
+
+    // Two-phase commit: writes the inactive slot with generation + 1.
+    bool commit();
+
+    // Self-test spot check: re-reads the active journal slot from NVS
+    // and re-validates version + CRC, catching silent corruption
+    // between commits while the rollback copy still exists. Blocking
+    // flash read — idle-slice use only (SelfTest).
+    bool verifyActiveSlot();
+
+private:
+    Preferences prefs;
+    PersistedSettings settings;
+    uint8_t nextSlot; // journal slot the next commit writes
+
+    uint32_t computeCrc(const PersistedSettings& s) const;
+    bool loadSlot(uint8_t slot, PersistedSettings& out);
+    const char* slotKey(uint8_t slot) const;
+    void loadDefaults();
+    void loadCalibrationDefaults();
+    bool migrateJournal();
+    bool migrateLegacyBlob();
+    bool migrateLegacyKeys();
+};
+
+#endif // SETTINGS_STORE_H
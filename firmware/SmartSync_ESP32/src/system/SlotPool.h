@@ -0,0 +1,84 @@
+#ifndef SLOT_POOL_H
+#define SLOT_POOL_H
+
+#include <stdint.h>
+#include <new>
+
+// Fixed-slot pool for objects with connection-churn lifetimes (BLE
+// per-connection state today). The slots live inside the owner —
+// sized at compile time to the configured maximum — so allocation is
+// a bitmap scan and freeing is a bit clear: connect/disconnect cycles
+// can never fragment the shared heap NimBLE, the uplink's TLS, and
+// the ML arena all draw from. alloc() placement-value-constructs the
+// slot, so a reused slot starts zeroed with members freshly built —
+// state from the previous occupant cannot leak into the next.
+//
+// Companion to SensorSet (same in-place storage idiom) for objects
+// that, unlike sensor drivers, do come and go at runtime. Slot
+// indices are stable for the object's lifetime, so owners iterate
+// with active(i)/at(i) exactly like the in-use flag arrays this
+// replaces. Single-task use only: the bitmap is not locked.
+template <typename T, uint8_t N>
+class SlotPool {
+    static_assert(N >= 1 && N <= 32, "bitmap is one uint32_t");
+
+public:
+    static const uint8_t CAPACITY = N;
+
+    SlotPool() : bitmap(0) {}
+
+    // Lowest free slot, value-constructed; NULL when the pool is full.
+    T* alloc() {
+        uint32_t freeBits = ~bitmap & MASK;
+        if (freeBits == 0) {
+            return NULL;
+        }
+        uint8_t slot = (uint8_t)__builtin_ctz(freeBits);
+        bitmap |= 1u << slot;
+        return new (storage[slot]) T();
+    }
+
+    // Destroys the object and clears its bit. A pointer the pool does
+    // not own (or a double release) is ignored rather than corrupting
+    // the bitmap.
+    void release(T* obj) {
+        uint8_t slot = indexOf(obj);
+        if (slot >= N || !active(slot)) {
+            return;
+        }
+        obj->~T();
+        bitmap &= ~(1u << slot);
+    }
+
+    bool active(uint8_t slot) const { return (bitmap >> slot) & 1u; }
+
+    T* at(uint8_t slot) {
+        return reinterpret_cast<T*>(storage[slot]);
+    }
+    const T* at(uint8_t slot) const {
+        return reinterpret_cast<const T*>(storage[slot]);
+    }
+
+    uint8_t used() const { return (uint8_t)__builtin_popcount(bitmap); }
+    bool empty() const { return bitmap == 0; }
+    bool full() const { return (bitmap & MASK) == MASK; }
+
+private:
+    uint8_t indexOf(const T* obj) const {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(obj);
+        const uint8_t* base = storage[0];
+        if (p < base || p >= base + sizeof(storage) ||
+            (p - base) % sizeof(storage[0]) != 0) {
+            return N;
+        }
+        return (uint8_t)((p - base) / sizeof(storage[0]));
+    }
+
+    static const uint32_t MASK =
+        (N >= 32) ? 0xFFFFFFFFu : ((1u << N) - 1u);
+
+    alignas(T) uint8_t storage[N][sizeof(T)];
+    uint32_t bitmap;
+};
+
+#endif // SLOT_POOL_H
@@ -0,0 +1,66 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Lock-free single-producer/single-consumer ring for fixed-size POD
+// events. One subsystem pair per ring: exactly one task (or ISR) may
+// push and exactly one task may pop, which is what lets a cross-core
+// handoff cost two atomic index updates instead of a critical section
+// around a copy. Storage is inline — no heap, ever — and the capacity
+// must be a power of two so the indices wrap with a mask.
+//
+// The ring carries data only; it never blocks or wakes anyone. Pair it
+// with a task notification (push, then xTaskNotifyGive the consumer;
+// the consumer drains after ulTaskNotifyTake) to keep the event-driven
+// structure the FreeRTOS queues provide today.
+//
+// Indices are free-running 32-bit counters (wrap is harmless under the
+// mask). acquire on the opposite index and release on our own order
+// the slot copy against the index publish on both cores.
+template <typename T, uint16_t N>
+class SpscRing {
+public:
+    SpscRing() : head(0), tail(0) {
+        static_assert((N & (N - 1)) == 0 && N > 0,
+                      "SpscRing capacity must be a power of two");
+    }
+
+    // Producer side. Returns false when the ring is full (consumer
+    // stalled); the caller counts the drop — nothing inside blocks.
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            return false;
+        }
+        slots[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool pop(T& out) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = slots[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Entries currently queued; approximate from any third task, exact
+    // from either endpoint. Diagnostics only.
+    uint16_t depth() const {
+        return (uint16_t)(head.load(std::memory_order_relaxed) -
+                          tail.load(std::memory_order_relaxed));
+    }
+
+private:
+    T slots[N];
+    std::atomic<uint32_t> head; // written by the producer only
+    std::atomic<uint32_t> tail; // written by the consumer only
+};
+
+#endif // SPSC_RING_H
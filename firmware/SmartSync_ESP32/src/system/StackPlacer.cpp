@@ -0,0 +1,53 @@
+#include "StackPlacer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <esp_heap_caps.h>
+#include <soc/soc_memory_layout.h>
+
+TaskHandle_t StackPlacer::createPsram(TaskFunction_t fn, const char* name,
+                                      uint32_t stackBytes, void* arg,
+                                      UBaseType_t priority,
+                                      BaseType_t core) {
+#if STACK_PSRAM_ENABLED
+    // Static creation is the only API that lets us choose the stack's
+    // home. The TCB must stay internal — the kernel touches it from
+    // contexts where PSRAM may not be accessible.
+    StackType_t* stack =
+        (StackType_t*)heap_caps_malloc(stackBytes, MALLOC_CAP_SPIRAM);
+    if (stack != NULL) {
+        StaticTask_t* tcb = (StaticTask_t*)heap_caps_malloc(
+            sizeof(StaticTask_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (tcb != NULL) {
+            TaskHandle_t handle = xTaskCreateStaticPinnedToCore(
+                fn, name, stackBytes, arg, priority, stack, tcb, core);
+            if (handle != NULL) {
+                return handle;
+            }
+            heap_caps_free(tcb);
+        }
+        heap_caps_free(stack);
+    }
+#endif
+    // No PSRAM (or the feature compiled out): same task, internal
+    // stack, exactly the pre-placement behavior.
+    TaskHandle_t handle = NULL;
+    xTaskCreatePinnedToCore(fn, name, stackBytes, arg, priority, &handle,
+                            core);
+    return handle;
+}
+
+void StackPlacer::audit() {
+    TaskStatus_t status[TASK_STATS_MAX_TASKS];
+    UBaseType_t count =
+        uxTaskGetSystemState(status, TASK_STATS_MAX_TASKS, NULL);
+
+    DEBUG_PRINTLN("Stack placement:");
+    for (UBaseType_t i = 0; i < count; i++) {
+        // Placement read off the stack base address, so system tasks
+        // (NimBLE host, lwIP, timers) show up in the audit too.
+        bool psram = esp_ptr_external_ram(status[i].pxStackBase);
+        DEBUG_PRINTF("  %-16s %s  margin %u bytes\n",
+                     status[i].pcTaskName, psram ? "PSRAM" : "DRAM ",
+                     (unsigned)status[i].usStackHighWaterMark);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef STACK_PLACER_H
+#define STACK_PLACER_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Task stack placement for PSRAM boards. Every task stack costs 2-4 KB
+// of internal DRAM — the memory NimBLE buffers and the history index
+// compete for — while -DBOARD_HAS_PSRAM leaves megabytes mostly idle.
+// Tasks that provably never perform SPI flash operations (their stack
+// must stay reachable while the cache is disabled) can live in PSRAM
+// instead; ISR-adjacent tasks and anything that writes flash stay in
+// internal RAM.
+//
+// Caller contract for createPsram: the task body never calls
+// esp_partition/spi_flash/NVS APIs. WiFi, lwIP and esp-mqtt are fine —
+// their flash-touching work runs on their own internal-stack system
+// tasks. Current tenants: log_drain (UART only), mqtt (RAM batches +
+// network), rtc_sync (I2C + SNTP).
+class StackPlacer {
+public:
+    // xTaskCreatePinnedToCore with the stack in PSRAM: TCB internal,
+    // stack from MALLOC_CAP_SPIRAM. Falls back to a normal internal-
+    // stack task when PSRAM is absent or exhausted, so no-PSRAM
+    // boards and STACK_PSRAM_ENABLED=0 builds behave exactly as
+    // before. Returns NULL only when both paths fail.
+    static TaskHandle_t createPsram(TaskFunction_t fn, const char* name,
+                                    uint32_t stackBytes, void* arg,
+                                    UBaseType_t priority, BaseType_t core);
+
+    // Boot-time placement audit: one log line per live task — where
+    // its stack lives (looked up from the stack base address, so
+    // foreign tasks are covered too) and the high-water margin.
+    static void audit();
+};
+
+#endif // STACK_PLACER_H
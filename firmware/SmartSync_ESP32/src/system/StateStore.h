@@ -0,0 +1,128 @@
+#ifndef STATE_STORE_H
+#define STATE_STORE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Central store for the device-owned control state (fan speed, LED
+// brightness, auto mode, PID setpoint). One task — the command task,
+// plus setup() before the scheduler splits — writes it; any task reads
+// it. Every accepted write fans a per-field dirty bit out to each
+// registered consumer, so a consumer learns what changed with one
+// fetch-and-clear instead of re-comparing every field per cycle:
+//
+//   CONSUMER_PERSIST  the deferred-NVS coalescer; flushPreferences()
+//                     copies only the dirty fields into the settings
+//                     blob before the commit.
+//   CONSUMER_STATUS   the GET_STATUS snapshot cache in BLEService;
+//                     consumed lazily on the first poll after a change.
+//
+// set() rejects no-op writes (returns false), so a dirty bit always
+// means the value really moved — callers can key side effects (prefs
+// re-arm, debug prints) off the return without their own compare.
+//
+// A generation counter brackets each write seqlock-style: snapshot()
+// retries while a writer is mid-update, so a reader on the other core
+// never sees half of a scene apply. Single-field getters are plain
+// atomic loads — same guarantee the old volatile globals gave.
+class StateStore {
+public:
+    enum Field : uint8_t {
+        FIELD_FAN_SPEED = 0,
+        FIELD_LED_BRIGHTNESS,
+        FIELD_AUTO_MODE,
+        FIELD_FAN_SETPOINT, // centi-°C; 0 keeps the compile-time default
+        FIELD_COUNT
+    };
+
+    enum Consumer : uint8_t {
+        CONSUMER_PERSIST = 0,
+        CONSUMER_STATUS,
+        CONSUMER_COUNT
+    };
+
+    static constexpr uint8_t bit(Field field) {
+        return (uint8_t)(1u << field);
+    }
+
+    StateStore() : gen(0) {
+        for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+            values[f].store(0, std::memory_order_relaxed);
+        }
+        for (uint8_t c = 0; c < CONSUMER_COUNT; c++) {
+            dirty[c].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Writer side (command task only). Returns true when the value
+    // actually changed; a rejected no-op marks nothing dirty.
+    bool set(Field field, int32_t value) {
+        if (values[field].load(std::memory_order_relaxed) == value) {
+            return false;
+        }
+        gen.fetch_add(1, std::memory_order_acq_rel); // odd: write open
+        values[field].store(value, std::memory_order_relaxed);
+        gen.fetch_add(1, std::memory_order_release); // even: write closed
+        uint8_t b = bit(field);
+        for (uint8_t c = 0; c < CONSUMER_COUNT; c++) {
+            dirty[c].fetch_or(b, std::memory_order_release);
+        }
+        return true;
+    }
+
+    int32_t get(Field field) const {
+        return values[field].load(std::memory_order_relaxed);
+    }
+
+    // Fetch-and-clear this consumer's pending mask. Clearing before
+    // reading the fields is safe: a racing write re-marks the bit, so
+    // at worst the next take sees a change this one already consumed.
+    uint8_t takeDirty(Consumer consumer) {
+        return dirty[consumer].exchange(0, std::memory_order_acquire);
+    }
+
+    uint8_t peekDirty(Consumer consumer) const {
+        return dirty[consumer].load(std::memory_order_relaxed);
+    }
+
+    // Coherent multi-field read for atomic snapshots (GET_STATUS, the
+    // RTC brownout shadow). Spins only while a writer is mid-update,
+    // which is a handful of instructions on the other core.
+    void snapshot(int32_t out[FIELD_COUNT]) const {
+        for (;;) {
+            uint32_t g = gen.load(std::memory_order_acquire);
+            if (g & 1u) {
+                continue;
+            }
+            for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+                out[f] = values[f].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (gen.load(std::memory_order_relaxed) == g) {
+                return;
+            }
+        }
+    }
+
+    uint32_t generation() const {
+        return gen.load(std::memory_order_acquire);
+    }
+
+    // Typed accessors so call sites read like the globals they replace.
+    bool setFanSpeed(uint8_t v)      { return set(FIELD_FAN_SPEED, v); }
+    bool setLedBrightness(uint8_t v) { return set(FIELD_LED_BRIGHTNESS, v); }
+    bool setAutoMode(bool v)         { return set(FIELD_AUTO_MODE, v ? 1 : 0); }
+    bool setSetpointCenti(int16_t v) { return set(FIELD_FAN_SETPOINT, v); }
+
+    uint8_t fanSpeed() const      { return (uint8_t)get(FIELD_FAN_SPEED); }
+    uint8_t ledBrightness() const { return (uint8_t)get(FIELD_LED_BRIGHTNESS); }
+    bool autoMode() const         { return get(FIELD_AUTO_MODE) != 0; }
+    int16_t setpointCenti() const { return (int16_t)get(FIELD_FAN_SETPOINT); }
+
+private:
+    std::atomic<int32_t> values[FIELD_COUNT];
+    std::atomic<uint8_t> dirty[CONSUMER_COUNT];
+    std::atomic<uint32_t> gen; // odd while a write is in flight
+};
+
+#endif // STATE_STORE_H
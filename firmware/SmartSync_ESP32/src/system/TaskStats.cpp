@@ -0,0 +1,61 @@
+#include "TaskStats.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+TaskStats::TaskSnapshot TaskStats::lastSnap[TASK_STATS_MAX_TASKS];
+uint32_t TaskStats::lastTotalRunTime = 0;
+
+uint8_t TaskStats::fill(TaskStatsEntry* entries, uint8_t maxEntries) {
+    TaskStatus_t status[TASK_STATS_MAX_TASKS];
+    uint32_t totalRunTime = 0;
+    UBaseType_t count = uxTaskGetSystemState(status, TASK_STATS_MAX_TASKS,
+                                             &totalRunTime);
+
+    uint32_t windowTotal = totalRunTime - lastTotalRunTime;
+    if (windowTotal == 0) {
+        windowTotal = 1; // first read, or counter wrap mid-query
+    }
+
+    uint8_t filled = 0;
+    for (UBaseType_t i = 0; i < count && filled < maxEntries; i++) {
+        TaskStatsEntry& e = entries[filled];
+
+        // Window delta against the retained snapshot; a task we have
+        // never seen charges its whole lifetime to this window, which
+        // is correct for tasks younger than the window.
+        uint32_t prevCounter = 0;
+        for (uint8_t s = 0; s < TASK_STATS_MAX_TASKS; s++) {
+            if (lastSnap[s].inUse &&
+                lastSnap[s].handle == (void*)status[i].xHandle) {
+                prevCounter = lastSnap[s].runTimeCounter;
+                break;
+            }
+        }
+        uint32_t delta = status[i].ulRunTimeCounter - prevCounter;
+
+        // Per-mille of the window across both cores, so a task pinned
+        // to one core tops out at 500.
+        uint64_t permille = ((uint64_t)delta * 1000) / windowTotal;
+        e.cpuPermille = (permille > 1000) ? 1000 : (uint16_t)permille;
+
+        e.stackHighWaterWords =
+            (uint16_t)uxTaskGetStackHighWaterMark(status[i].xHandle);
+        e.priority = (uint8_t)status[i].uxCurrentPriority;
+        e.state = (uint8_t)status[i].eCurrentState;
+
+        memset(e.name, 0, sizeof(e.name));
+        strncpy(e.name, status[i].pcTaskName, sizeof(e.name) - 1);
+        filled++;
+    }
+
+    // Retain this read as the next window's baseline.
+    memset(lastSnap, 0, sizeof(lastSnap));
+    for (UBaseType_t i = 0; i < count && i < TASK_STATS_MAX_TASKS; i++) {
+        lastSnap[i].handle = (void*)status[i].xHandle;
+        lastSnap[i].runTimeCounter = status[i].ulRunTimeCounter;
+        lastSnap[i].inUse = true;
+    }
+    lastTotalRunTime = totalRunTime;
+
+    return filled;
+}
@@ -0,0 +1,34 @@
+#ifndef TASK_STATS_H
+#define TASK_STATS_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+#include "../ble/SensorFrame.h"
+
+// Per-task CPU accounting for CMD_GET_TASKS. uxTaskGetSystemState
+// gives each task's cumulative run-time counter and stack high-water
+// mark; CPU share is computed over the window since the previous
+// query by diffing against a retained snapshot, so back-to-back reads
+// from the app show "CPU over the last poll interval", not
+// since-boot averages that bury a new runaway under months of idle.
+//
+// The snapshot is keyed by task handle, so tasks that die between
+// reads age out and one-shot tasks (history sync, benchmark) show up
+// only while they exist.
+class TaskStats {
+public:
+    // Fills up to maxEntries entries and returns the count. Also
+    // refreshes the retained snapshot, starting a new window.
+    static uint8_t fill(TaskStatsEntry* entries, uint8_t maxEntries);
+
+private:
+    struct TaskSnapshot {
+        void* handle;
+        uint32_t runTimeCounter;
+        bool inUse;
+    };
+    static TaskSnapshot lastSnap[TASK_STATS_MAX_TASKS];
+    static uint32_t lastTotalRunTime;
+};
+
+#endif // TASK_STATS_H
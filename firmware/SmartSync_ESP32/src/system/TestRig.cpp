@@ -0,0 +1,18 @@
+#include "TestRig.h"
+
+#if TEST_RIG_ENABLED
+
+void TestRig::begin() {
+    const uint8_t pins[] = {
+        TEST_RIG_PIN_SENSOR,
+        TEST_RIG_PIN_COMMAND,
+        TEST_RIG_PIN_ACTUATE,
+    };
+    for (size_t i = 0; i < sizeof(pins); i++) {
+        pinMode(pins[i], OUTPUT);
+        digitalWrite(pins[i], LOW);
+    }
+    DEBUG_PRINTLN("Test rig armed: sensor/command/actuate pins live");
+}
+
+#endif // TEST_RIG_ENABLED
@@ -0,0 +1,52 @@
+#ifndef TEST_RIG_H
+#define TEST_RIG_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Hardware-in-the-loop latency instrumentation: TEST_RIG_PULSE at an
+// instrumented point raises its GPIO for a few hundred nanoseconds, so
+// an external logic analyzer sees the exact instant the code path ran.
+// The rising edge is the timestamp; tests/performance/hil_latency.py
+// pairs edges across channels into end-to-end latencies and gates
+// releases on the percentiles.
+//
+// The pulse is two direct register writes plus a short hold — no
+// digitalWrite, no locks — so it is safe at ISR entry and costs the
+// instrumented path well under a microsecond. Compiled out entirely
+// unless the esp32dev-testrig env sets TEST_RIG_ENABLED.
+
+#if TEST_RIG_ENABLED
+
+#include <soc/gpio_struct.h>
+
+class TestRig {
+public:
+    // Configures the rig pins as outputs, driven low. Call once from
+    // setup() before interrupts attach.
+    static void begin();
+
+    // All rig pins are < 32, so the w1ts/w1tc registers cover them.
+    static inline void pulse(uint8_t pin) __attribute__((always_inline)) {
+        uint32_t mask = 1UL << pin;
+        GPIO.out_w1ts = mask;
+        // Re-assert to stretch the pulse past ~300 ns — a logic
+        // analyzer sampling at 24 MHz must not miss an edge.
+        GPIO.out_w1ts = mask;
+        GPIO.out_w1ts = mask;
+        GPIO.out_w1ts = mask;
+        GPIO.out_w1tc = mask;
+    }
+};
+
+#define TEST_RIG_BEGIN() TestRig::begin()
+#define TEST_RIG_PULSE(pin) TestRig::pulse(pin)
+
+#else
+
+#define TEST_RIG_BEGIN() do {} while (0)
+#define TEST_RIG_PULSE(pin) do {} while (0)
+
+#endif // TEST_RIG_ENABLED
+
+#endif // TEST_RIG_H
@@ -0,0 +1,158 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <Arduino.h>
+
+// Hashed timer wheel for coarse-grained timed events. A timer is a
+// {deadline tick, caller tag} pair hashed into one of 2^SLOT_BITS
+// buckets by its deadline's low bits; scheduling is a free-list pop
+// and a list splice, cancellation unlinks a doubly-linked node by
+// handle — both O(1) however many timers are pending, which is what
+// lets per-alert, per-zone escalation stages scale without per-timer
+// esp_timer handles or periodic full-list scans. advance() walks only
+// the buckets the elapsed ticks land in; entries hashed there for a
+// later lap are skipped, not expired.
+//
+// The wheel is pure bookkeeping: no locks, no allocation, no time
+// source. The owner supplies the tick count (derived from whatever
+// periodic context the wheel rides) and serializes calls — same
+// contract as the heap inside ScheduleManager.
+//
+// A handle stays valid until the timer expires or is cancelled, and
+// the owner must forget it inside the expiry callback: the node
+// returns to the free list immediately after the callback and a later
+// schedule() may hand the same index back out.
+template <uint8_t SLOT_BITS, uint8_t CAPACITY>
+class TimerWheel {
+public:
+    static const uint8_t NO_TIMER = 0xFF;
+
+    // Fires from advance(), once per expired timer, in bucket order.
+    typedef void (*ExpiryCallback)(uint32_t tag, void* ctx);
+
+    TimerWheel() : currentTick(0), freeHead(0), pending(0) {
+        static_assert(CAPACITY < NO_TIMER,
+                      "TimerWheel capacity must fit uint8_t handles");
+        for (uint8_t i = 0; i < CAPACITY; i++) {
+            pool[i].next = (uint8_t)(i + 1);
+            pool[i].active = false;
+        }
+        pool[CAPACITY - 1].next = NO_TIMER;
+        for (uint16_t s = 0; s < SLOT_COUNT; s++) {
+            buckets[s] = NO_TIMER;
+        }
+    }
+
+    // Arms a timer delayTicks after the last advanced tick. Returns
+    // the handle, or NO_TIMER when the pool is exhausted (the caller
+    // counts the drop; nothing inside blocks). A zero delay is
+    // rounded up to one tick — the current bucket has already been
+    // walked, and landing in it would silently cost a full lap.
+    uint8_t schedule(uint32_t delayTicks, uint32_t tag) {
+        if (freeHead == NO_TIMER) {
+            return NO_TIMER;
+        }
+        if (delayTicks == 0) {
+            delayTicks = 1;
+        }
+        uint8_t handle = freeHead;
+        Node& node = pool[handle];
+        freeHead = node.next;
+
+        node.deadline = currentTick + delayTicks;
+        node.tag = tag;
+        node.active = true;
+        linkIntoBucket(handle);
+        pending++;
+        return handle;
+    }
+
+    // Disarms a pending timer. Returns false for a handle that
+    // already expired or was never armed.
+    bool cancel(uint8_t handle) {
+        if (handle >= CAPACITY || !pool[handle].active) {
+            return false;
+        }
+        unlink(handle);
+        release(handle);
+        return true;
+    }
+
+    // Advances the wheel to nowTick, firing every timer whose
+    // deadline the elapsed ticks cover. Cost is one bucket walk per
+    // elapsed tick, so a coarse carrier (a once-a-minute heartbeat
+    // driving second-granularity ticks) amortizes to constant work
+    // per bucket. Time never runs backwards here; a stale nowTick is
+    // a no-op.
+    void advance(uint32_t nowTick, ExpiryCallback callback, void* ctx) {
+        while ((int32_t)(nowTick - currentTick) > 0) {
+            currentTick++;
+            uint8_t i = buckets[currentTick & (SLOT_COUNT - 1)];
+            while (i != NO_TIMER) {
+                uint8_t next = pool[i].next;
+                if (pool[i].deadline == currentTick) {
+                    uint32_t tag = pool[i].tag;
+                    unlink(i);
+                    release(i);
+                    if (callback != NULL) {
+                        callback(tag, ctx);
+                    }
+                }
+                i = next; // later-lap entries stay put
+            }
+        }
+    }
+
+    // Timers currently armed; diagnostics only.
+    uint8_t pendingCount() const { return pending; }
+
+private:
+    static const uint16_t SLOT_COUNT = (uint16_t)1 << SLOT_BITS;
+
+    struct Node {
+        uint32_t deadline; // absolute tick
+        uint32_t tag;
+        uint8_t next;
+        uint8_t prev;
+        bool active;
+    };
+
+    void linkIntoBucket(uint8_t handle) {
+        uint16_t bucket = (uint16_t)(pool[handle].deadline &
+                                     (SLOT_COUNT - 1));
+        uint8_t head = buckets[bucket];
+        pool[handle].prev = NO_TIMER;
+        pool[handle].next = head;
+        if (head != NO_TIMER) {
+            pool[head].prev = handle;
+        }
+        buckets[bucket] = handle;
+    }
+
+    void unlink(uint8_t handle) {
+        Node& node = pool[handle];
+        if (node.prev != NO_TIMER) {
+            pool[node.prev].next = node.next;
+        } else {
+            buckets[node.deadline & (SLOT_COUNT - 1)] = node.next;
+        }
+        if (node.next != NO_TIMER) {
+            pool[node.next].prev = node.prev;
+        }
+    }
+
+    void release(uint8_t handle) {
+        pool[handle].active = false;
+        pool[handle].next = freeHead;
+        freeHead = handle;
+        pending--;
+    }
+
+    Node pool[CAPACITY];
+    uint8_t buckets[SLOT_COUNT]; // head handle per bucket
+    uint32_t currentTick;
+    uint8_t freeHead;
+    uint8_t pending;
+};
+
+#endif // TIMER_WHEEL_H
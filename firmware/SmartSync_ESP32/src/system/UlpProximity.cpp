@@ -0,0 +1,179 @@
+#include "UlpProximity.h"
+
+#if BATTERY_PROFILE_ENABLED
+
+#include <esp_sleep.h>
+#include <esp32/ulp.h>
+#include <driver/rtc_io.h>
+#include <soc/rtc_io_reg.h>
+#include <soc/rtc_cntl_reg.h>
+
+// ============================================================================
+// RTC SLOW MEMORY LAYOUT
+// ============================================================================
+// The Arduino sdkconfig reserves nothing for the ULP, so the linker
+// packs .rtc.data/.rtc_noinit from the bottom of the 2048-word slow
+// memory. We claim the top 256 words for the watcher — far above
+// everything the linker places (RtcState's envelope, the watchdog
+// blame record and the settings shadow total well under 100 words).
+static const uint32_t ULP_BASE = 1792;
+
+// Word offsets from ULP_BASE. The mailbox words come first so the
+// program can address them with small immediates; program text after.
+enum {
+    OFF_BREACH_STREAK = 0, // consecutive pings inside the threshold
+    OFF_LAST_LOOPS,        // last echo width in poll-loop units
+    OFF_PINGS,             // pings since arm()
+    OFF_PROG = 8,          // program text
+};
+
+// Branch labels (M_LABEL arguments are program-unique small ints).
+enum {
+    LBL_AWAIT_RISE = 1,
+    LBL_TIME_HIGH,
+    LBL_FAR,
+    LBL_DONE,
+};
+
+// RTC IO indices for the ultrasonic pair; the ULP addresses pins by
+// RTC number, not GPIO number.
+static const uint32_t RTC_IO_TRIG = 9; // GPIO 32 (ULTRASONIC_TRIG_PIN)
+static const uint32_t RTC_IO_ECHO = 8; // GPIO 33 (ULTRASONIC_ECHO_PIN)
+
+// Echo loop count at the breach line: round trip is 58 us/cm, one
+// poll loop costs ULP_TIMING_LOOP_NS. An echo still high past this
+// count is already farther than PROXIMITY_THRESHOLD, so the program
+// bails out early instead of riding out the HC-SR04's 38 ms no-echo
+// timeout with the loop spinning.
+static const uint32_t BREACH_LOOPS =
+    (uint32_t)PROXIMITY_THRESHOLD * 58 * 1000 / ULP_TIMING_LOOP_NS;
+
+void UlpProximity::begin() {
+    // Stop the periodic timer in case the last cycle's watcher is
+    // still running — a ping fired mid-boot would fight the
+    // UltrasonicSensor driver for the transducer.
+    CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+
+    // Hand the pins back to the digital mux; arm() re-routes them to
+    // the RTC domain on the way into the next sleep.
+    rtc_gpio_deinit((gpio_num_t)ULTRASONIC_TRIG_PIN);
+    rtc_gpio_deinit((gpio_num_t)ULTRASONIC_ECHO_PIN);
+
+    // One ping, start to halt. R1 counts loops (R0 is the only
+    // register JUMPR and I_RD_REG touch, so the count lives elsewhere
+    // and is copied over for each compare).
+    const ulp_insn_t program[] = {
+        // Ping accounting.
+        I_MOVI(R3, ULP_BASE + OFF_PINGS),
+        I_LD(R0, R3, 0),
+        I_ADDI(R0, R0, 1),
+        I_ST(R0, R3, 0),
+
+        // 10 us trigger pulse (the ULP runs from the 8 MHz fast
+        // clock: 80 cycles).
+        I_WR_REG(RTC_GPIO_OUT_W1TS_REG,
+                 RTC_GPIO_OUT_DATA_W1TS_S + RTC_IO_TRIG,
+                 RTC_GPIO_OUT_DATA_W1TS_S + RTC_IO_TRIG, 1),
+        I_DELAY(80),
+        I_WR_REG(RTC_GPIO_OUT_W1TC_REG,
+                 RTC_GPIO_OUT_DATA_W1TC_S + RTC_IO_TRIG,
+                 RTC_GPIO_OUT_DATA_W1TC_S + RTC_IO_TRIG, 1),
+
+        // Wait for the echo to rise, bounded: a dead or disconnected
+        // transducer must not wedge the watcher.
+        I_MOVI(R1, 0),
+        M_LABEL(LBL_AWAIT_RISE),
+        I_ADDI(R1, R1, 1),
+        I_MOVR(R0, R1),
+        M_BGE(LBL_FAR, ULP_ECHO_START_TIMEOUT_LOOPS),
+        I_RD_REG(RTC_GPIO_IN_REG,
+                 RTC_GPIO_IN_NEXT_S + RTC_IO_ECHO,
+                 RTC_GPIO_IN_NEXT_S + RTC_IO_ECHO),
+        M_BL(LBL_AWAIT_RISE, 1),
+
+        // Time the high level in loop units. Past BREACH_LOOPS the
+        // object is beyond the threshold — bail without waiting for
+        // the fall.
+        I_MOVI(R1, 0),
+        M_LABEL(LBL_TIME_HIGH),
+        I_ADDI(R1, R1, 1),
+        I_MOVR(R0, R1),
+        M_BGE(LBL_FAR, BREACH_LOOPS),
+        I_RD_REG(RTC_GPIO_IN_REG,
+                 RTC_GPIO_IN_NEXT_S + RTC_IO_ECHO,
+                 RTC_GPIO_IN_NEXT_S + RTC_IO_ECHO),
+        M_BGE(LBL_TIME_HIGH, 1),
+
+        // Echo fell inside the threshold: record it and count the
+        // streak; wake only once ULP_PROXIMITY_CONFIRM consecutive
+        // pings agree, so a single stray reflection stays asleep.
+        I_MOVI(R3, ULP_BASE + OFF_LAST_LOOPS),
+        I_ST(R1, R3, 0),
+        I_MOVI(R3, ULP_BASE + OFF_BREACH_STREAK),
+        I_LD(R0, R3, 0),
+        I_ADDI(R0, R0, 1),
+        I_ST(R0, R3, 0),
+        M_BL(LBL_DONE, ULP_PROXIMITY_CONFIRM),
+        // Wake only when the RTC controller reports the cores ready
+        // for it; if they are already awake the streak just rides
+        // until begin() stops the timer.
+        I_RD_REG(RTC_CNTL_LOW_POWER_ST_REG,
+                 RTC_CNTL_RDY_FOR_WAKEUP_S,
+                 RTC_CNTL_RDY_FOR_WAKEUP_S),
+        M_BL(LBL_DONE, 1),
+        I_WAKE(),
+        M_BX(LBL_DONE),
+
+        // No echo, or the object is beyond the line: streak resets.
+        M_LABEL(LBL_FAR),
+        I_MOVI(R3, ULP_BASE + OFF_BREACH_STREAK),
+        I_MOVI(R0, 0),
+        I_ST(R0, R3, 0),
+
+        M_LABEL(LBL_DONE),
+        I_HALT(),
+    };
+
+    size_t size = sizeof(program) / sizeof(ulp_insn_t);
+    esp_err_t err =
+        ulp_process_macros_and_load(ULP_BASE + OFF_PROG, program, &size);
+    if (err != ESP_OK) {
+        DEBUG_PRINTF("ULP proximity: load failed (%d)\n", (int)err);
+        return;
+    }
+    DEBUG_PRINTF("ULP proximity: %u words, breach line %u loops\n",
+                 (unsigned)size, (unsigned)BREACH_LOOPS);
+}
+
+void UlpProximity::arm() {
+    // Route the pair to the RTC mux for the sleep. Trigger idles low
+    // — a pin left high would hold the HC-SR04 mid-cycle.
+    rtc_gpio_init((gpio_num_t)ULTRASONIC_TRIG_PIN);
+    rtc_gpio_set_direction((gpio_num_t)ULTRASONIC_TRIG_PIN,
+                           RTC_GPIO_MODE_OUTPUT_ONLY);
+    rtc_gpio_set_level((gpio_num_t)ULTRASONIC_TRIG_PIN, 0);
+    rtc_gpio_init((gpio_num_t)ULTRASONIC_ECHO_PIN);
+    rtc_gpio_set_direction((gpio_num_t)ULTRASONIC_ECHO_PIN,
+                           RTC_GPIO_MODE_INPUT_ONLY);
+
+    RTC_SLOW_MEM[ULP_BASE + OFF_BREACH_STREAK] = 0;
+    RTC_SLOW_MEM[ULP_BASE + OFF_LAST_LOOPS] = 0;
+    RTC_SLOW_MEM[ULP_BASE + OFF_PINGS] = 0;
+
+    ulp_set_wakeup_period(0, (uint32_t)ULP_PROXIMITY_PERIOD_MS * 1000);
+    esp_sleep_enable_ulp_wakeup();
+    ulp_run(ULP_BASE + OFF_PROG);
+}
+
+uint16_t UlpProximity::lastDistanceCm() {
+    // Mailbox words are 16 bits of payload in a 32-bit slot.
+    uint32_t loops = RTC_SLOW_MEM[ULP_BASE + OFF_LAST_LOOPS] & 0xFFFF;
+    // loops -> round-trip us -> cm (58 us/cm).
+    return (uint16_t)(loops * ULP_TIMING_LOOP_NS / 1000 / 58);
+}
+
+uint16_t UlpProximity::pingCount() {
+    return (uint16_t)(RTC_SLOW_MEM[ULP_BASE + OFF_PINGS] & 0xFFFF);
+}
+
+#endif // BATTERY_PROFILE_ENABLED
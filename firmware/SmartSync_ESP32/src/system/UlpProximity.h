@@ -0,0 +1,59 @@
+#ifndef ULP_PROXIMITY_H
+#define ULP_PROXIMITY_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// ULP coprocessor proximity watcher for the battery-only variant:
+// while the Xtensa cores deep-sleep, the ULP-FSM pings the HC-SR04
+// every ULP_PROXIMITY_PERIOD_MS, times the echo by counting poll-loop
+// iterations, and wakes the chip only after ULP_PROXIMITY_CONFIRM
+// consecutive echoes inside PROXIMITY_THRESHOLD. The awake-path
+// proximity watch (onProximityEcho on the echo ISR) thus never has a
+// blind window, at the ULP's microamp duty cost instead of a core
+// wake per ping.
+//
+// Both ultrasonic pins are RTC-capable (GPIO 32 = RTC_GPIO 9, GPIO 33
+// = RTC_GPIO 8), so the ULP drives the trigger and reads the echo
+// through the RTC IO matrix with the digital domain powered down.
+// arm() routes the pins to the RTC mux just before sleep; begin()
+// hands them back to the digital mux on wake so the UltrasonicSensor
+// driver finds them as it left them.
+//
+// Timing resolution is the cost of one poll loop (ULP_TIMING_LOOP_NS,
+// ~2.4 us ≈ 0.4 mm of round trip) — coarse against a lab counter,
+// irrelevant against a 50 cm threshold. The program lives in the top
+// of RTC slow memory, clear of the .rtc data/noinit sections (RtcState,
+// the watchdog blame record, the settings shadow) that the linker
+// packs from the bottom.
+//
+// Compiled out entirely unless the esp32dev-battery env sets
+// BATTERY_PROFILE_ENABLED.
+
+#if BATTERY_PROFILE_ENABLED
+
+class UlpProximity {
+public:
+    // Stops any watcher left running by the previous duty cycle and
+    // returns the ultrasonic pins to the digital mux, then loads the
+    // ULP program. Call from BatteryProfile::begin() before the
+    // sensor drivers come up.
+    static void begin();
+
+    // Routes the ultrasonic pins to the RTC mux, arms the ULP wake
+    // source and starts the periodic watcher. Call as the last step
+    // before esp_deep_sleep_start().
+    static void arm();
+
+    // Distance from the watcher's last completed ping, 0 when no echo
+    // ever returned. Valid after a ULP wake until the next arm().
+    static uint16_t lastDistanceCm();
+
+    // Pings since the last arm(); field diagnostic for the watcher's
+    // cadence against ULP_PROXIMITY_PERIOD_MS.
+    static uint16_t pingCount();
+};
+
+#endif // BATTERY_PROFILE_ENABLED
+
+#endif // ULP_PROXIMITY_H
@@ -0,0 +1,103 @@
+#include "WatchdogSupervisor.h"
+#include <esp_task_wdt.h>
+#include <esp_system.h>
+#include "BootHealthGate.h"
+
+// Per-subsystem heartbeat deadlines. Each is a multiple of the slowest
+// legitimate gap on that path (sensor reads stretch to
+// SENSOR_READ_INTERVAL_DEGRADED under load shedding).
+static const uint32_t SUBSYSTEM_DEADLINE_MS[WatchdogSupervisor::SUBSYS_COUNT] = {
+    3 * SENSOR_READ_INTERVAL_DEGRADED, // SUBSYS_SENSOR
+    6 * BLE_UPDATE_INTERVAL,           // SUBSYS_BLE
+    3 * SCHEDULE_CHECK_INTERVAL,       // SUBSYS_SCHEDULER
+};
+
+// Blame record surviving a watchdog reset (noinit: not cleared by boot).
+static const uint32_t BLAME_MAGIC = 0x57444754; // "WDGT"
+RTC_NOINIT_ATTR static uint32_t rtcBlameMagic;
+RTC_NOINIT_ATTR static uint8_t rtcBlameSubsystem;
+RTC_NOINIT_ATTR static uint32_t rtcWatchdogResets;
+
+void WatchdogSupervisor::begin() {
+    int64_t now = esp_timer_get_time();
+    for (uint8_t i = 0; i < SUBSYS_COUNT; i++) {
+        lastBeatUs[i] = now;
+    }
+
+    // Hardware backstop: if the supervisor itself wedges, the task
+    // watchdog resets the chip after WATCHDOG_TIMEOUT.
+    esp_task_wdt_init(WATCHDOG_TIMEOUT / 1000, true);
+
+    xTaskCreatePinnedToCore(
+        taskThunk, "watchdog", WATCHDOG_TASK_STACK, this,
+        WATCHDOG_TASK_PRIORITY, &taskHandle, BLE_TASK_CORE);
+
+    DEBUG_PRINTLN("Watchdog supervisor armed.");
+}
+
+void WatchdogSupervisor::heartbeat(Subsystem subsystem) {
+    if (subsystem < SUBSYS_COUNT) {
+        lastBeatUs[subsystem] = esp_timer_get_time();
+    }
+}
+
+void WatchdogSupervisor::taskThunk(void* arg) {
+    static_cast<WatchdogSupervisor*>(arg)->run();
+}
+
+void WatchdogSupervisor::run() {
+    esp_task_wdt_add(NULL);
+
+    for (;;) {
+        int64_t now = esp_timer_get_time();
+
+        for (uint8_t i = 0; i < SUBSYS_COUNT; i++) {
+            int64_t silenceMs = (now - lastBeatUs[i]) / 1000;
+            if (silenceMs > (int64_t)SUBSYSTEM_DEADLINE_MS[i]) {
+                // Record the offender where the reset can't erase it,
+                // then reboot — a sub-minute recovery with blame intact.
+                rtcBlameMagic = BLAME_MAGIC;
+                rtcBlameSubsystem = i;
+                rtcWatchdogResets++;
+
+                DEBUG_PRINTF("WATCHDOG: %s silent for %lld ms — resetting\n",
+                             subsystemName(i), silenceMs);
+                #if DEBUG_SERIAL
+                Serial.flush();
+                #endif
+                esp_restart();
+            }
+        }
+
+        // Probation budget rides this loop: it is the one task still
+        // alive when everything the boot milestones measure has hung.
+        BootHealthGate::tick();
+
+        esp_task_wdt_reset();
+        vTaskDelay(pdMS_TO_TICKS(WATCHDOG_CHECK_INTERVAL));
+    }
+}
+
+void WatchdogSupervisor::logResetCause() {
+    esp_reset_reason_t reason = esp_reset_reason();
+    DEBUG_PRINTF("Reset cause: %d\n", (int)reason);
+
+    if (rtcBlameMagic == BLAME_MAGIC) {
+        static const char* names[SUBSYS_COUNT] = {"sensor", "ble", "scheduler"};
+        uint8_t blamed = rtcBlameSubsystem < SUBSYS_COUNT ? rtcBlameSubsystem : 0;
+        DEBUG_PRINTF("Previous reset: watchdog, blamed subsystem: %s (total: %u)\n",
+                     names[blamed], rtcWatchdogResets);
+        rtcBlameMagic = 0;
+    } else if (reason == ESP_RST_POWERON) {
+        rtcWatchdogResets = 0;
+    }
+}
+
+const char* WatchdogSupervisor::subsystemName(uint8_t subsystem) const {
+    switch (subsystem) {
+        case SUBSYS_SENSOR: return "sensor";
+        case SUBSYS_BLE: return "ble";
+        case SUBSYS_SCHEDULER: return "scheduler";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef WATCHDOG_SUPERVISOR_H
+#define WATCHDOG_SUPERVISOR_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+// Supervised watchdog. Each subsystem calls heartbeat() from its normal
+// event path; a low-priority supervisor task checks all deadlines every
+// second and feeds the hardware task watchdog only while everyone is
+// alive. When a subsystem goes quiet past its deadline, the offender is
+// recorded into RTC noinit memory before the reset, so the blame and
+// reset cause can be reported (and acted on) at the next boot.
+class WatchdogSupervisor {
+public:
+    enum Subsystem : uint8_t {
+        SUBSYS_SENSOR = 0,
+        SUBSYS_BLE,
+        SUBSYS_SCHEDULER,
+        SUBSYS_COUNT,
+    };
+
+    void begin();
+
+    // Marks the subsystem alive. Safe from any task.
+    void heartbeat(Subsystem subsystem);
+
+    // Prints the last reset cause and, for watchdog resets, which
+    // subsystem missed its deadline. Call once early in setup().
+    static void logResetCause();
+
+private:
+    static void taskThunk(void* arg);
+    void run();
+
+    const char* subsystemName(uint8_t subsystem) const;
+
+    volatile int64_t lastBeatUs[SUBSYS_COUNT];
+    TaskHandle_t taskHandle = NULL;
+};
+
+#endif // WATCHDOG_SUPERVISOR_H
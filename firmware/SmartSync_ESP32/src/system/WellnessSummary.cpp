@@ -0,0 +1,124 @@
+#include "WellnessSummary.h"
+#include "RtcClock.h"
+#include "../storage/RollupStore.h"
+#include "../sensors/ZoneClassifier.h"
+
+RollupStore* WellnessSummary::rollupStore = nullptr;
+RtcClock* WellnessSummary::rtcClock = nullptr;
+WellnessSummary::Summary WellnessSummary::summary = {};
+uint16_t WellnessSummary::outOfBedRun = 0;
+uint16_t WellnessSummary::alertRun = 0;
+bool WellnessSummary::sealedThisHour = false;
+
+void WellnessSummary::begin(RollupStore* rollups, RtcClock* clock) {
+    rollupStore = rollups;
+    rtcClock = clock;
+}
+
+// Wrap-aware: the night window crosses midnight (e.g. 21 -> 7).
+bool WellnessSummary::inNightWindow(int8_t hour) {
+    if (hour < 0) {
+        return false; // no wall clock: no window, no seal
+    }
+    if (WELLNESS_NIGHT_START_HOUR <= WELLNESS_SUMMARY_HOUR) {
+        return hour >= WELLNESS_NIGHT_START_HOUR &&
+               hour < WELLNESS_SUMMARY_HOUR;
+    }
+    return hour >= WELLNESS_NIGHT_START_HOUR ||
+           hour < WELLNESS_SUMMARY_HOUR;
+}
+
+void WellnessSummary::noteZoneTransition(uint8_t fromZone, uint8_t toZone) {
+    (void)toZone;
+    if (rtcClock == nullptr || !inNightWindow(rtcClock->hourOfDay())) {
+        return;
+    }
+    // Leaving the bed band is the event a caregiver asks about; where
+    // the occupant went next is the app's detail view.
+    if (fromZone == ZoneClassifier::ZONE_BED) {
+        outOfBedRun++;
+    }
+}
+
+void WellnessSummary::noteAlert() {
+    if (rtcClock == nullptr || !inNightWindow(rtcClock->hourOfDay())) {
+        return;
+    }
+    alertRun++;
+}
+
+void WellnessSummary::tick(uint32_t nowMs) {
+    if (rtcClock == nullptr) {
+        return;
+    }
+    int8_t hour = rtcClock->hourOfDay();
+    if (hour != WELLNESS_SUMMARY_HOUR) {
+        sealedThisHour = false;
+        return;
+    }
+    if (!sealedThisHour) {
+        seal(nowMs);
+        sealedThisHour = true;
+    }
+}
+
+void WellnessSummary::seal(uint32_t nowMs) {
+    // Hours the night window spans, for the rollup lookback.
+    uint8_t windowHours =
+        (uint8_t)((24 + WELLNESS_SUMMARY_HOUR - WELLNESS_NIGHT_START_HOUR) %
+                  24);
+    uint32_t windowMs = (uint32_t)windowHours * 3600000UL;
+
+    Summary next = {};
+    next.outOfBedCount = outOfBedRun;
+    next.alertCount = alertRun;
+    next.tempMin = INT16_MAX;
+    next.tempMax = INT16_MIN;
+
+    if (rollupStore != nullptr && rollupStore->isReady()) {
+        // Walk the hour stream and keep the buckets inside the night.
+        // A boot mid-night truncates coverage — windowMinutes says how
+        // much of the night the numbers actually describe.
+        RollupStore::Cursor cursor =
+            rollupStore->cursorFromSeq(RollupStore::ROLLUP_HOUR, 0);
+        RollupRecord record;
+        while (rollupStore->readNext(RollupStore::ROLLUP_HOUR, cursor,
+                                     record)) {
+            if (record.sampleCount == 0 ||
+                (uint32_t)(nowMs - record.startMs) > windowMs) {
+                continue;
+            }
+            next.motionCount += record.motionCount;
+            next.windowMinutes += 60;
+            if (record.tempMin < next.tempMin) {
+                next.tempMin = record.tempMin;
+            }
+            if (record.tempMax > next.tempMax) {
+                next.tempMax = record.tempMax;
+            }
+            if (record.tempMean >=
+                    (int16_t)(WELLNESS_COMFORT_MIN_C * 100.0f) &&
+                record.tempMean <=
+                    (int16_t)(WELLNESS_COMFORT_MAX_C * 100.0f)) {
+                next.comfortMinutes += 60;
+            }
+        }
+    }
+
+    if (next.windowMinutes == 0) {
+        next.tempMin = 0;
+        next.tempMax = 0;
+    }
+    next.sealedAtMs = nowMs;
+    next.valid = true;
+    summary = next;
+
+    outOfBedRun = 0;
+    alertRun = 0;
+
+    DEBUG_PRINTF("Wellness sealed: %u motion, %u out-of-bed, %u alerts, "
+                 "%u/%u comfy min\n",
+                 summary.motionCount, summary.outOfBedCount,
+                 summary.alertCount, summary.comfortMinutes,
+                 summary.windowMinutes);
+}
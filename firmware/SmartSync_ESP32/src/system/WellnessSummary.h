@@ -0,0 +1,67 @@
+#ifndef WELLNESS_SUMMARY_H
+#define WELLNESS_SUMMARY_H
+
+#include <Arduino.h>
+#include "../../include/config.h"
+
+class RollupStore;
+class RtcClock;
+
+// Daily wellness summary: answers "how was last night?" in one frame
+// instead of a multi-minute history sync. At WELLNESS_SUMMARY_HOUR the
+// night's hour rollups are folded into motion totals, temperature
+// extremes, and time inside the comfort band, and joined with two
+// live tallies the rollups don't carry — out-of-bed events (ZONE_BED
+// exits from the zone classifier) and alarms raised — all counted
+// only inside the night window. The sealed record sits in RAM and is
+// served by CMD_GET_WELLNESS; it is overwritten by the next seal, so
+// the app has a full day to collect it.
+//
+// Sealing reads the rollup stream (flash-mapped, a few hundred small
+// reads worst case) once per day on the sensor task — comparable to
+// the history append it already does every cycle.
+class WellnessSummary {
+public:
+    struct Summary {
+        bool valid;
+        uint16_t motionCount;    // motion samples across the night
+        uint16_t outOfBedCount;  // ZONE_BED exits in the window
+        uint16_t alertCount;     // alarms raised in the window
+        uint16_t comfortMinutes; // hour buckets with tempMean in band
+        uint16_t windowMinutes;  // rollup coverage actually found
+        int16_t tempMin;         // °C × 100, overnight extreme
+        int16_t tempMax;
+        uint32_t sealedAtMs;
+    };
+
+    static void begin(RollupStore* rollups, RtcClock* clock);
+
+    // Committed zone transition (sensor task). Counted only while the
+    // night window is open.
+    static void noteZoneTransition(uint8_t fromZone, uint8_t toZone);
+
+    // Alarm raised (alarm drain task). Counter is a plain uint16 —
+    // a torn increment against the seal is one count off, not worth
+    // a lock on the alarm path.
+    static void noteAlert();
+
+    // Once per sensor cycle: opens/closes the night window off the
+    // wall clock and seals the summary at the scheduled hour.
+    static void tick(uint32_t nowMs);
+
+    static const Summary& last() { return summary; }
+
+private:
+    static bool inNightWindow(int8_t hour);
+    static void seal(uint32_t nowMs);
+
+    static RollupStore* rollupStore;
+    static RtcClock* rtcClock;
+
+    static Summary summary;
+    static uint16_t outOfBedRun; // live tallies for the open night
+    static uint16_t alertRun;
+    static bool sealedThisHour;  // one seal per scheduled hour
+};
+
+#endif // WELLNESS_SUMMARY_H
@@ -0,0 +1,70 @@
+// Fuzz harness for the RX command parser (scripts/fuzz_command.sh
+// builds it with libFuzzer + ASan/UBSan). The parser is the only code
+// between an unauthenticated BLE write and command dispatch, so it
+// must survive arbitrary bytes: the harness mirrors the routing the
+// characteristic callback does — magic byte to the binary validator,
+// everything else to the legacy JSON decoder — and touches every byte
+// of an accepted payload so the sanitizer sees any overread a bad
+// length calculation would cause.
+//
+// Crash inputs replay without libFuzzer:
+//   g++ -DFUZZ_STANDALONE ... && ./fuzz_command crash-file...
+
+#include <Arduino.h>
+
+#include "../../src/ble/CommandParser.h"
+
+// The sanitizer-visible sink: forces the payload view to actually be
+// read, end to end.
+static volatile uint8_t sink;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size > 0 && data[0] == CMD_MAGIC) {
+        CommandParser::CommandFrame frame;
+        if (CommandParser::parseBinary(data, size, frame) ==
+            CommandParser::PARSE_OK) {
+            // An accepted frame promises opcode validity and the
+            // minimum payload; walk the whole view.
+            if (CommandParser::minPayload(frame.opcode) < 0) {
+                __builtin_trap();
+            }
+            for (size_t i = 0; i < frame.length; i++) {
+                sink = frame.payload[i];
+            }
+        }
+        return 0;
+    }
+
+    CommandParser::JsonCommand cmd;
+    if (CommandParser::parseJson((const char*)data, size, cmd)) {
+        if (cmd.opcode == 0 || cmd.opcode > CMD_OPCODE_MAX) {
+            __builtin_trap();
+        }
+        sink = cmd.value;
+        sink = (uint8_t)cmd.durationMs;
+    }
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+// File replayer for triaging crash artifacts (and for CI smoke runs
+// over the seed corpus) without a libFuzzer-enabled toolchain.
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        FILE* f = fopen(argv[i], "rb");
+        if (f == NULL) {
+            fprintf(stderr, "cannot open %s\n", argv[i]);
+            return 1;
+        }
+        static uint8_t buf[4096];
+        size_t len = fread(buf, 1, sizeof(buf), f);
+        fclose(f);
+        LLVMFuzzerTestOneInput(buf, len);
+        printf("ok %s (%zu bytes)\n", argv[i], len);
+    }
+    return 0;
+}
+#endif // FUZZ_STANDALONE
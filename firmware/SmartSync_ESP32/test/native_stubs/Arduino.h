@@ -0,0 +1,47 @@
+#ifndef NATIVE_STUB_ARDUINO_H
+#define NATIVE_STUB_ARDUINO_H
+
+// Host stand-in for <Arduino.h>, on the include path only in the
+// [env:native] test build. The logic modules the native tests cover
+// (filters, PID, protocol structs) already take their timestamps as
+// parameters and do no I/O, so the seam is this header: enough of the
+// Arduino surface for them to compile, and a test-settable clock for
+// anything that does call millis(). Hardware-facing code (drivers,
+// BLE, storage) is never built for the host — build_src_filter in
+// platformio.ini lists exactly the portable translation units.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+
+typedef std::string String;
+
+// Test-controlled clock: assign nativeMillisValue to move time.
+extern uint32_t nativeMillisValue;
+static inline uint32_t millis() { return nativeMillisValue; }
+static inline uint32_t micros() { return nativeMillisValue * 1000u; }
+static inline int64_t esp_timer_get_time() {
+    return (int64_t)nativeMillisValue * 1000;
+}
+
+// SensorBank's gather loop yields between polls on target; the mock
+// drivers complete on the first poll, so this never spins.
+static inline void vTaskDelay(uint32_t) {}
+#define pdMS_TO_TICKS(ms) (ms)
+
+#ifndef constrain
+#define constrain(x, lo, hi) \
+    ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+#endif
+#ifndef min
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef max
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+#endif // NATIVE_STUB_ARDUINO_H
@@ -0,0 +1,193 @@
+#ifndef MOCK_SENSOR_DRIVERS_H
+#define MOCK_SENSOR_DRIVERS_H
+
+#include "Arduino.h"
+
+// Scripted stand-ins for the DHT22 and HC-SR04 drivers, substituted
+// into SensorBank when SENSOR_BANK_MOCK_DRIVERS is set (the native
+// test env). Same class names and call surface as the real drivers
+// (src/sensors/DHT22Sensor.h, UltrasonicSensor.h), so the bank's
+// acquisition, quarantine and filter logic compiles unmodified and
+// runs against waveforms the test scripts: a NaN streak is the
+// fault-detection input, an outlier burst is the median-filter input,
+// an echo timeout is a scripted negative distance.
+//
+// Channels register themselves in construction order — the same order
+// SensorBank emplaces them — so tests reach channel i through the
+// static registry. start calls are counted, which is what lets a test
+// assert quarantine's skip-and-probe schedule cycle by cycle.
+
+class DHT22Sensor {
+public:
+    struct Reading {
+        float temperature;
+        float humidity;
+        unsigned long timestampMs;
+        bool valid;
+    };
+
+    static const uint8_t MAX_CHANNELS = 4;
+    static const uint8_t SCRIPT_MAX = 64;
+
+    explicit DHT22Sensor(uint8_t pinArg)
+        : pin(pinArg), startCalls(0), pending(false),
+          scriptLen(0), scriptNext(0) {
+        lastReading.temperature = 24.0f;
+        lastReading.humidity = 50.0f;
+        lastReading.timestampMs = 0;
+        lastReading.valid = true;
+        if (registrySize() < MAX_CHANNELS) {
+            registrySlots()[registrySize()++] = this;
+        }
+    }
+
+    void begin() {}
+
+    bool startRead() {
+        startCalls++;
+        pending = true;
+        return true;
+    }
+
+    bool poll() {
+        if (!pending) {
+            return false;
+        }
+        pending = false;
+        Reading r;
+        if (scriptNext < scriptLen) {
+            r = script[scriptNext++];
+        } else {
+            r = lastReading; // script exhausted: keep reading nominal
+        }
+        if (isnan(r.temperature) || isnan(r.humidity)) {
+            r.valid = false; // a NaN frame is a failed decode
+        }
+        r.timestampMs = millis();
+        lastReading = r;
+        return true;
+    }
+
+    bool isBusy() const { return pending; }
+    Reading latest() const { return lastReading; }
+
+    // --- script surface (tests only) ---
+    void scriptReading(float temperature, float humidity) {
+        Reading r = {temperature, humidity, 0, true};
+        if (scriptLen < SCRIPT_MAX) {
+            script[scriptLen++] = r;
+        }
+    }
+    void scriptFailure() { scriptReading(NAN, NAN); }
+    uint32_t startCount() const { return startCalls; }
+
+    static DHT22Sensor* channel(uint8_t i) { return registrySlots()[i]; }
+    static void resetRegistry() { registrySize() = 0; }
+
+private:
+    // Function-local statics keep the mock header-only — no
+    // out-of-line definitions for every native test binary that
+    // happens to link SensorBank.
+    static DHT22Sensor** registrySlots() {
+        static DHT22Sensor* slots[MAX_CHANNELS];
+        return slots;
+    }
+    static uint8_t& registrySize() {
+        static uint8_t count = 0;
+        return count;
+    }
+
+    uint8_t pin;
+    uint32_t startCalls;
+    bool pending;
+    Reading lastReading;
+    Reading script[SCRIPT_MAX];
+    uint8_t scriptLen;
+    uint8_t scriptNext;
+};
+
+class UltrasonicSensor {
+public:
+    static const uint8_t MAX_CHANNELS = 4;
+    static const uint8_t SCRIPT_MAX = 64;
+
+    UltrasonicSensor(uint8_t trigArg, uint8_t echoArg)
+        : trigPin(trigArg), echoPin(echoArg), startCalls(0),
+          pending(false), lastDistance(120.0f), isrCycles(1200),
+          scriptLen(0), scriptNext(0) {
+        if (registrySize() < MAX_CHANNELS) {
+            registrySlots()[registrySize()++] = this;
+        }
+    }
+
+    void begin() {}
+
+    bool startMeasurement() {
+        startCalls++;
+        pending = true;
+        return true;
+    }
+
+    bool waitForResult(uint32_t /*timeoutMs*/) {
+        if (!pending) {
+            return false;
+        }
+        pending = false;
+        float cm = (scriptNext < scriptLen) ? script[scriptNext++]
+                                            : lastDistance;
+        if (cm < 0.0f) {
+            return false; // scripted echo timeout
+        }
+        lastDistance = cm;
+        return true;
+    }
+
+    // Scripted completion is instantaneous: the probe consumes the
+    // next script entry; a scripted timeout leaves the driver idle
+    // with no result, which is how the protothread wait observes it.
+    bool pollResult() { return waitForResult(0); }
+    void cancel() { pending = false; }
+
+    bool isBusy() const { return pending; }
+    float lastDistanceCm() const { return lastDistance; }
+    uint32_t lastDistanceMm() const {
+        return (uint32_t)(lastDistance * 10.0f);
+    }
+    uint32_t lastIsrCycles() const { return isrCycles; }
+    void onComplete(void (*)(uint32_t)) {}
+
+    // --- script surface (tests only) ---
+    void scriptDistanceCm(float cm) {
+        if (scriptLen < SCRIPT_MAX) {
+            script[scriptLen++] = cm;
+        }
+    }
+    void scriptTimeout() { scriptDistanceCm(-1.0f); }
+    void scriptIsrCycles(uint32_t cycles) { isrCycles = cycles; }
+    uint32_t startCount() const { return startCalls; }
+
+    static UltrasonicSensor* channel(uint8_t i) { return registrySlots()[i]; }
+    static void resetRegistry() { registrySize() = 0; }
+
+private:
+    static UltrasonicSensor** registrySlots() {
+        static UltrasonicSensor* slots[MAX_CHANNELS];
+        return slots;
+    }
+    static uint8_t& registrySize() {
+        static uint8_t count = 0;
+        return count;
+    }
+
+    uint8_t trigPin;
+    uint8_t echoPin;
+    uint32_t startCalls;
+    bool pending;
+    float lastDistance;
+    uint32_t isrCycles;
+    float script[SCRIPT_MAX];
+    uint8_t scriptLen;
+    uint8_t scriptNext;
+};
+
+#endif // MOCK_SENSOR_DRIVERS_H
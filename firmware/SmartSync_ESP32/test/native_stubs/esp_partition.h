@@ -0,0 +1,10 @@
+#ifndef NATIVE_STUB_ESP_PARTITION_H
+#define NATIVE_STUB_ESP_PARTITION_H
+
+// Host stand-in: just enough for headers that mention the partition
+// type by pointer (HistoryLog.h — the replay tests only want its
+// HistoryRecord layout). Nothing that touches a real partition builds
+// for the host.
+typedef struct esp_partition_t esp_partition_t;
+
+#endif // NATIVE_STUB_ESP_PARTITION_H
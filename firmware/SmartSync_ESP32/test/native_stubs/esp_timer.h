@@ -0,0 +1,10 @@
+#ifndef NATIVE_STUB_ESP_TIMER_H
+#define NATIVE_STUB_ESP_TIMER_H
+
+// Host stand-in for "esp_timer.h": MonoClock includes it directly so
+// it can live in headers without dragging in Arduino.h. The actual
+// esp_timer_get_time definition sits in the stub Arduino.h, wired to
+// the same test-settable clock as millis().
+#include "Arduino.h"
+
+#endif // NATIVE_STUB_ESP_TIMER_H
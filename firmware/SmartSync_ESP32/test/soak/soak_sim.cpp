@@ -0,0 +1,251 @@
+// Accelerated soak simulator (scripts/soak_sim.sh builds and runs
+// it). A 30-day reliability pass used to mean 30 days on the bench;
+// this drives the portable control stack — the same AutoModePolicy +
+// OccupancyEstimator objects the unit runs, plus a mirror of the
+// queue-side funnel and the motion-timeout latch — through
+// synthesized multi-day scenarios on the native stub's virtual clock,
+// one SENSOR_READ_INTERVAL per iteration. A simulated month takes
+// seconds; the script's ASan/UBSan build makes "no leak, no overread,
+// no overflow" sanitizer-enforced rather than asserted, and the
+// invariants below cover the behavioral claims: duty changes obey the
+// dwell, the occupancy gate releases an empty room, the motion
+// timeout raises exactly once per quiet spell and only during one,
+// and the over-temperature latch does not flap.
+//
+//   scripts/soak_sim.sh [days]        (default 30)
+
+#include <Arduino.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../src/control/AutoModePolicy.h"
+#include "../../src/sensors/OccupancyEstimator.h"
+
+uint32_t nativeMillisValue = 0;
+
+static uint32_t failures = 0;
+
+// Prints and counts instead of aborting: one broken invariant early
+// in a month-long scenario should not hide the others.
+#define SOAK_CHECK(cond, ...)                                       \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            failures++;                                             \
+            fprintf(stderr, "SOAK FAIL day %u line %d: ",           \
+                    (unsigned)(nativeMillisValue / 86400000u),      \
+                    __LINE__);                                      \
+            fprintf(stderr, __VA_ARGS__);                           \
+            fputc('\n', stderr);                                    \
+        }                                                           \
+    } while (0)
+
+// ============================================================
+// SOAK RIG
+// ============================================================
+// The real policy objects plus mirrors of the two main.cpp funnels
+// they feed: requestAutoFanSpeed's dedupe/dwell (same shape as the
+// replay rig's — keep all three in lockstep) and checkMotionTimeout's
+// once-per-quiet-spell latch, with the baseline's unlearned default
+// (MOTION_TIMEOUT) standing in for activeTimeoutMs() and no mesh —
+// a single simulated unit has no peers to defer to.
+struct SoakRig {
+    AutoModePolicy policy;
+    OccupancyEstimator occupancy;
+    uint8_t appliedDuty;
+    uint32_t lastChangeMs;
+    bool lastChangeUrgent;
+    uint32_t transitions;
+    uint32_t urgentTransitions;
+    uint8_t maxDuty;
+    bool prevMotion;
+
+    int64_t lastMotionMs;
+    bool motionDetected;
+    bool timeoutRaised;
+    uint32_t alarmsRaised;
+
+    SoakRig()
+        : appliedDuty(0), lastChangeMs(0), lastChangeUrgent(false),
+          transitions(0), urgentTransitions(0), maxDuty(0),
+          prevMotion(false),
+          lastMotionMs(0), motionDetected(false), timeoutRaised(false),
+          alarmsRaised(0) {
+        occupancy.setHourOfDay(-1);
+    }
+
+    void step(float tempC, bool motion, float distanceCm) {
+        uint32_t now = nativeMillisValue;
+
+        if (motion && !prevMotion) {
+            lastMotionMs = (int64_t)now;
+            occupancy.noteMotion(lastMotionMs);
+        }
+        motionDetected = motion;
+        prevMotion = motion;
+        occupancy.noteDistance(distanceCm);
+
+        policy.noteTemperature(tempC, now);
+        AutoModePolicy::Decision d = policy.evaluate(
+            tempC, occupancy.confidence(), now);
+
+        if (d.duty != appliedDuty) {
+            if (d.urgent || lastChangeMs == 0 ||
+                now - lastChangeMs >= FAN_MIN_DWELL_MS) {
+                // Invariant: a non-urgent change never lands inside
+                // the dwell window (redundant with the gate above by
+                // construction; pins the funnel against edits).
+                SOAK_CHECK(d.urgent || lastChangeMs == 0 ||
+                               now - lastChangeMs >= FAN_MIN_DWELL_MS,
+                           "dwell violated");
+                appliedDuty = d.duty;
+                lastChangeMs = now;
+                lastChangeUrgent = d.urgent;
+                transitions++;
+                if (d.urgent) {
+                    urgentTransitions++;
+                }
+                if (d.duty > maxDuty) {
+                    maxDuty = d.duty;
+                }
+            }
+        }
+
+        // checkMotionTimeout, minus the learned baseline and the mesh.
+        if (lastMotionMs != 0) {
+            int64_t elapsed = (int64_t)now - lastMotionMs;
+            if (elapsed > MOTION_TIMEOUT && !motionDetected) {
+                if (!timeoutRaised) {
+                    timeoutRaised = true;
+                    alarmsRaised++;
+                }
+            } else {
+                timeoutRaised = false;
+            }
+        }
+    }
+};
+
+// ============================================================
+// SCENARIO SYNTHESIS
+// ============================================================
+// One month in a lived-in room, deterministic down to the step:
+//
+//   - diurnal temperature triangle, coolest 05:00, warmest 15:00;
+//     ordinary days peak below TEMP_MAX_THRESHOLD, one heat-wave day
+//     crosses it to exercise the over-temperature latch
+//   - motion every minute through the waking hours, every four
+//     minutes overnight — a sleeper stirring just inside the
+//     five-minute timeout, the tightest no-alarm case
+//   - a three-day vacancy in the middle: the gate must drop the fan
+//     and the motion timeout must raise exactly once
+
+#define SOAK_VACANCY_START_DAY 10
+#define SOAK_VACANCY_DAYS 3
+#define SOAK_HEATWAVE_DAY 20
+
+static float diurnalTemp(uint32_t simMs, float peakC) {
+    uint32_t sec = (simMs / 1000u) % 86400u;
+    // Minutes since 05:00, wrapping: 0..600 climbs, 600..1440 falls.
+    uint32_t m = ((sec / 60u) + 1440u - 300u) % 1440u;
+    float span = peakC - 19.0f;
+    if (m < 600u) {
+        return 19.0f + span * (float)m / 600.0f;
+    }
+    return peakC - span * (float)(m - 600u) / 840.0f;
+}
+
+static bool scenarioMotion(uint32_t simMs) {
+    uint32_t day = simMs / 86400000u;
+    if (day >= SOAK_VACANCY_START_DAY &&
+        day < SOAK_VACANCY_START_DAY + SOAK_VACANCY_DAYS) {
+        return false;
+    }
+    uint32_t sec = (simMs / 1000u) % 86400u;
+    uint32_t hour = sec / 3600u;
+    bool waking = hour >= 7 && hour < 22;
+    uint32_t period = waking ? 60u : 240u;
+    return (simMs / 1000u) % period == 0;
+}
+
+int main(int argc, char** argv) {
+    uint32_t days = 30;
+    if (argc > 1) {
+        days = (uint32_t)atoi(argv[1]);
+    }
+    // The stub clock (and the history record format the firmware
+    // stamps with it) is 32-bit; the 64-bit MonoClock fields under
+    // test are fed through the same widening the firmware uses.
+    if (days == 0 || days > 45) {
+        fprintf(stderr, "days must be 1..45 (32-bit stub clock)\n");
+        return 2;
+    }
+
+    SoakRig rig;
+    const uint32_t stepMs = SENSOR_READ_INTERVAL;
+    const uint32_t steps = days * (86400000u / stepMs);
+    const uint32_t vacancyStartMs = SOAK_VACANCY_START_DAY * 86400000u;
+    const uint32_t vacancyEndMs =
+        (SOAK_VACANCY_START_DAY + SOAK_VACANCY_DAYS) * 86400000u;
+
+    uint32_t alarmsBeforeVacancy = 0;
+
+    for (uint32_t i = 0; i < steps; i++) {
+        uint32_t simMs = i * stepMs;
+        nativeMillisValue = simMs;
+        uint32_t day = simMs / 86400000u;
+
+        float peak = day == SOAK_HEATWAVE_DAY ? 34.0f : 29.0f;
+        rig.step(diurnalTemp(simMs, peak), scenarioMotion(simMs), 250.0f);
+
+        if (simMs == vacancyStartMs) {
+            alarmsBeforeVacancy = rig.alarmsRaised;
+        }
+
+        // Alarm correctness, continuously: the timeout never stands
+        // while the room is lived in (the overnight stirring is the
+        // near-miss), and during the vacancy it stands from one
+        // timeout past the last motion until the residents return.
+        if (simMs < vacancyStartMs || simMs >= vacancyEndMs + stepMs) {
+            SOAK_CHECK(!rig.timeoutRaised,
+                       "timeout raised in an occupied room");
+        } else if (simMs > vacancyStartMs + MOTION_TIMEOUT + stepMs &&
+                   simMs < vacancyEndMs) {
+            SOAK_CHECK(rig.timeoutRaised,
+                       "timeout not standing mid-vacancy");
+        }
+
+        // Gate correctness: an hour into the vacancy the PIR decay
+        // and occupancy hysteresis must have released the fan.
+        if (simMs >= vacancyStartMs + 3600000u && simMs < vacancyEndMs) {
+            SOAK_CHECK(rig.appliedDuty == 0,
+                       "fan held %u in an empty room", rig.appliedDuty);
+        }
+    }
+
+    if (days > SOAK_VACANCY_START_DAY) {
+        // One quiet spell, one alarm — not one per poll.
+        SOAK_CHECK(rig.alarmsRaised == alarmsBeforeVacancy + 1,
+                   "expected exactly one vacancy alarm, got %u new",
+                   rig.alarmsRaised - alarmsBeforeVacancy);
+    }
+    if (days > SOAK_HEATWAVE_DAY) {
+        // The heat wave drove the override...
+        SOAK_CHECK(rig.maxDuty == 255, "heat-wave day never hit full");
+        // ...and the latch held: one urgent entry per excursion. A
+        // flapping latch produces hundreds of urgent transitions in
+        // one afternoon (they bypass the dwell, so the dwell-paced
+        // bound below would not catch them).
+        SOAK_CHECK(rig.urgentTransitions <= 4,
+                   "over-temperature latch flapped: %u urgent",
+                   rig.urgentTransitions);
+    }
+    // Whole-run flap bound: outside the latch, changes are dwell-paced.
+    SOAK_CHECK(rig.transitions <= days * 100,
+               "transition count %u implausible", rig.transitions);
+
+    printf("SOAK,%u days,%u steps,%u transitions,%u alarms,%s\n",
+           days, steps, rig.transitions, rig.alarmsRaised,
+           failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
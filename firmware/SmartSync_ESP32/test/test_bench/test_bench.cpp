@@ -0,0 +1,175 @@
+// On-target microbenchmarks: pio test -e esp32dev-bench.
+//
+// Each bench runs its subject ITERS times bracketed by cycle-counter
+// reads and prints one machine-readable line alongside the Unity
+// output:
+//
+//   BENCH,<name>,<iters>,<min_cycles>,<avg_cycles>,<avg_us>
+//
+// Capture the lines from two firmware versions and diff them to see
+// per-function cost movement before a fleet rollout. min is the
+// uncontended cost (no interrupt landed in the window); avg includes
+// whatever the system did meanwhile, which is what the budget pays.
+// The assertions are sanity floors only — regressions are judged from
+// the diff, not by hardcoded limits that rot.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "../../src/ble/BLEService.h"
+#include "../../src/actuators/FanController.h"
+#include "../../src/storage/HistoryLog.h"
+#include "../../src/system/EventTrace.h"
+#include "../../src/system/LatencyStats.h"
+#include "../../src/system/SettingsStore.h"
+
+static BLEServiceManager benchBle;
+static FanController benchPid;
+static HistoryLog benchHistory;
+static SettingsStore benchSettings;
+
+// Subjects read/write these so the optimizer can't hollow a loop out.
+static volatile uint32_t sink;
+static SensorFrame frame;
+static char jsonBuf[192];
+static uint8_t frameBuf[64];
+
+static uint32_t benchIter; // loop index, visible to subjects
+
+static void report(const char* name, uint32_t iters, void (*fn)()) {
+    fn(); // warm code and data caches out of the measurement
+
+    uint32_t minCycles = UINT32_MAX;
+    uint64_t totalCycles = 0;
+    for (benchIter = 0; benchIter < iters; benchIter++) {
+        uint32_t start = latencyCycleCount();
+        fn();
+        uint32_t cycles = latencyCycleCount() - start;
+        totalCycles += cycles;
+        if (cycles < minCycles) {
+            minCycles = cycles;
+        }
+    }
+
+    uint32_t avgCycles = (uint32_t)(totalCycles / iters);
+    uint32_t avgUs = avgCycles / getCpuFrequencyMhz();
+    Serial.printf("BENCH,%s,%u,%u,%u,%u\n",
+                  name, iters, minCycles, avgCycles, avgUs);
+    TEST_ASSERT_TRUE(minCycles > 0);
+}
+
+// ============================================================
+// SUBJECTS
+// ============================================================
+static void subjectFrameFill() {
+    frame.magic = FRAME_MAGIC;
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.type = FRAME_TYPE_SENSOR;
+    frame.flags = (benchIter & 1) ? SENSOR_FLAG_MOTION : 0;
+    frame.temperature = (int16_t)(2450 + (benchIter & 0x3F));
+    frame.humidity = (uint16_t)(5500 + (benchIter & 0x3F));
+    frame.fanSpeed = (uint8_t)benchIter;
+    frame.ledBrightness = 128;
+    frame.distance = (uint16_t)(1200 + (benchIter & 0xFF));
+    frame.occupancy = 200;
+    frame.fanRpm = 1450;
+    frame.timestampMs = millis();
+    memcpy(frameBuf, &frame, sizeof(frame));
+    sink = frameBuf[4];
+}
+
+static void subjectFrameJson() {
+    sink = benchBle.createSensorJSON(frame, jsonBuf, sizeof(jsonBuf));
+}
+
+static void subjectCmdDispatch() {
+    // CMD_GET_STATUS is a no-op handler, so this costs the parser
+    // validation, table dispatch and latency accounting alone.
+    static const uint8_t cmd[] = { CMD_MAGIC, CMD_GET_STATUS };
+    benchBle.handleBinaryCommand(cmd, sizeof(cmd));
+}
+
+static void subjectCmdJson() {
+    // Same command through the legacy parser, for the binary-vs-JSON
+    // dispatch cost the protocol migration is premised on.
+    static const char cmd[] = "{\"cmd\":\"get_status\",\"value\":0}";
+    benchBle.handleCommand(cmd, sizeof(cmd) - 1);
+}
+
+static void subjectPidUpdate() {
+    uint8_t duty;
+    float temp = 25.0f + (float)(benchIter & 0x1F) * 0.1f;
+    benchPid.update(temp, benchIter * 100, &duty);
+    sink = duty;
+}
+
+static void subjectTraceRecord() {
+    EventTrace::record(TRACE_AUTO_DECISION, (uint8_t)benchIter,
+                       (uint16_t)benchIter);
+}
+
+static void subjectHistoryAppend() {
+    HistoryRecord rec;
+    rec.sequence = benchHistory.nextSequence();
+    rec.timestampMs = millis();
+    rec.temperature = 2450;
+    rec.humidity = 5500;
+    rec.distance = 1200;
+    rec.flags = 0;
+    rec.reserved = 0;
+    benchHistory.append(rec);
+}
+
+static void subjectNvsCommit() {
+    // Touch a field so every commit writes a genuinely new blob.
+    benchSettings.data().ledBrightness =
+        (uint8_t)(benchSettings.data().ledBrightness + 1);
+    benchSettings.commit();
+}
+
+// ============================================================
+// TESTS
+// ============================================================
+static void bench_frame_fill() { report("frame_fill", 4096, subjectFrameFill); }
+static void bench_frame_json() { report("frame_json", 1024, subjectFrameJson); }
+static void bench_cmd_dispatch() { report("cmd_dispatch", 4096, subjectCmdDispatch); }
+static void bench_cmd_json() { report("cmd_json", 1024, subjectCmdJson); }
+static void bench_pid_update() { report("pid_update", 4096, subjectPidUpdate); }
+static void bench_trace_record() { report("trace_record", 4096, subjectTraceRecord); }
+
+static void bench_history_append() {
+    if (!benchHistory.isReady()) {
+        TEST_IGNORE_MESSAGE("history partition not found");
+    }
+    // 64 appends cross several page-program boundaries, so the avg
+    // carries the real amortized flash cost, not just the RAM batch.
+    report("history_append", 64, subjectHistoryAppend);
+}
+
+static void bench_nvs_commit() {
+    // Full journaled blob commit — dominated by the NVS write, so a
+    // handful of laps is plenty and spares the flash.
+    report("nvs_commit", 8, subjectNvsCommit);
+}
+
+void setup() {
+    delay(2000); // let the serial monitor attach
+
+    EventTrace::begin();
+    benchHistory.begin();
+    benchSettings.begin();
+    subjectFrameFill(); // frame_json needs a populated frame
+
+    UNITY_BEGIN();
+    RUN_TEST(bench_frame_fill);
+    RUN_TEST(bench_frame_json);
+    RUN_TEST(bench_cmd_dispatch);
+    RUN_TEST(bench_cmd_json);
+    RUN_TEST(bench_pid_update);
+    RUN_TEST(bench_trace_record);
+    RUN_TEST(bench_history_append);
+    RUN_TEST(bench_nvs_commit);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,168 @@
+// On-target memory margin gates: pio test -e esp32dev-margins.
+//
+// Drives the worst-case concurrent path — a max-MTU BLE command burst
+// on the BLE core while sensor-side math and history appends run on
+// the sensor core, with a flash flush in the middle of it — then
+// asserts every stack high-water mark and the heap minimum-free
+// watermark keep the reserves defined in config.h. Alongside the
+// Unity output each run prints machine-readable lines:
+//
+//   MARGIN,<name>,<bytes_free>,<floor>
+//
+// so the measured headroom can be diffed between firmware versions
+// just like the BENCH lines. When a change eats into a reserve this
+// suite fails the build — the point is that stack sizing for new
+// tasks starts from these numbers, not from guesswork plus padding.
+//
+// The workers run at the production stack sizes, priorities and core
+// pins, so the marks transfer to the real tasks they stand in for.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "../../src/ble/BLEService.h"
+#include "../../src/actuators/FanController.h"
+#include "../../src/sensors/OccupancyEstimator.h"
+#include "../../src/storage/HistoryLog.h"
+
+static BLEServiceManager marginBle;
+static FanController marginPid;
+static OccupancyEstimator marginOcc;
+static HistoryLog marginHistory;
+
+// Workers read/write this so the optimizer can't hollow their loops.
+static volatile uint32_t sink;
+
+static volatile bool bleDone;
+static volatile bool sensorDone;
+static volatile uint32_t bleHighWater;    // bytes still free at high water
+static volatile uint32_t sensorHighWater;
+
+// A few hundred ms of saturated load per worker — long enough that the
+// two loops genuinely overlap and the flush lands mid-burst, short
+// enough to stay clear of the task watchdog.
+static const uint32_t BLE_BURST_LAPS = 2000;
+static const uint32_t SENSOR_LAPS = 4000;
+
+// ============================================================
+// WORKERS
+// ============================================================
+// Worst case the BLE task sees: a full-MTU binary write, the deepest
+// JSON command (fade carries the most fields through the parser) and
+// a frame serialization, back to back with no idle gaps — the shape
+// of a phone-side burst during sync.
+static void bleWorker(void*) {
+    static uint8_t burst[BLE_PREFERRED_MTU - 3]; // ATT write payload limit
+    memset(burst, 0xA5, sizeof(burst));
+    burst[0] = CMD_MAGIC;
+    burst[1] = CMD_GET_STATUS; // no-op handler: parse + dispatch cost only
+    static const char json[] =
+        "{\"cmd\":\"set_led_fade\",\"value\":200,\"duration_ms\":2500}";
+    SensorFrame frame = {};
+    char jsonBuf[192];
+
+    for (uint32_t i = 0; i < BLE_BURST_LAPS; i++) {
+        marginBle.handleBinaryCommand(burst, sizeof(burst));
+        marginBle.handleCommand(json, sizeof(json) - 1);
+        sink = marginBle.createSensorJSON(frame, jsonBuf, sizeof(jsonBuf));
+    }
+
+    bleHighWater = uxTaskGetStackHighWaterMark(NULL);
+    bleDone = true;
+    vTaskDelete(NULL);
+}
+
+// Worst case the sensor task sees: occupancy scoring, PID update and
+// history appends every lap, with appends crossing page boundaries so
+// flash programs land while the other core is mid-burst, and a full
+// flush at the end while the burst is still running.
+static void sensorWorker(void*) {
+    for (uint32_t i = 0; i < SENSOR_LAPS; i++) {
+        marginOcc.noteMotion(millis());
+        marginOcc.noteDistance(120.0f + (float)(i & 0x1F));
+        uint8_t duty;
+        marginPid.update(25.0f + (float)(i & 0x0F) * 0.1f, i * 100, &duty);
+        sink = (uint32_t)duty + marginOcc.confidence();
+
+        if (marginHistory.isReady() && (i & 0x0F) == 0) {
+            HistoryRecord rec;
+            rec.sequence = marginHistory.nextSequence();
+            rec.timestampMs = millis();
+            rec.temperature = 2450;
+            rec.humidity = 5500;
+            rec.distance = 1200;
+            rec.flags = 0;
+            rec.reserved = 0;
+            marginHistory.append(rec);
+        }
+        if (i == SENSOR_LAPS / 2 && marginHistory.isReady()) {
+            marginHistory.flush();
+        }
+    }
+
+    sensorHighWater = uxTaskGetStackHighWaterMark(NULL);
+    sensorDone = true;
+    vTaskDelete(NULL);
+}
+
+static void runWorkers() {
+    bleDone = false;
+    sensorDone = false;
+    xTaskCreatePinnedToCore(bleWorker, "margin_ble", BLE_TASK_STACK, NULL,
+                            BLE_TASK_PRIORITY, NULL, BLE_TASK_CORE);
+    xTaskCreatePinnedToCore(sensorWorker, "margin_sens", SENSOR_TASK_STACK,
+                            NULL, SENSOR_TASK_PRIORITY, NULL,
+                            SENSOR_TASK_CORE);
+
+    uint32_t waited = 0;
+    while (!(bleDone && sensorDone) && waited < 30000) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+        waited += 10;
+    }
+    TEST_ASSERT_TRUE_MESSAGE(bleDone && sensorDone,
+                             "workers did not finish within 30 s");
+}
+
+// ============================================================
+// TESTS
+// ============================================================
+static void reportMargin(const char* name, uint32_t freeBytes,
+                         uint32_t floorBytes) {
+    Serial.printf("MARGIN,%s,%u,%u\n", name, freeBytes, floorBytes);
+}
+
+static void margin_ble_task_stack() {
+    reportMargin("stack_ble", bleHighWater, STACK_MARGIN_MIN_BYTES);
+    TEST_ASSERT_TRUE_MESSAGE(bleHighWater >= STACK_MARGIN_MIN_BYTES,
+                             "BLE_TASK_STACK reserve eaten");
+}
+
+static void margin_sensor_task_stack() {
+    reportMargin("stack_sensor", sensorHighWater, STACK_MARGIN_MIN_BYTES);
+    TEST_ASSERT_TRUE_MESSAGE(sensorHighWater >= STACK_MARGIN_MIN_BYTES,
+                             "SENSOR_TASK_STACK reserve eaten");
+}
+
+static void margin_heap_min_free() {
+    // Since-boot minimum, read after the burst so it reflects the
+    // concurrent worst case just driven.
+    uint32_t minFree = esp_get_minimum_free_heap_size();
+    reportMargin("heap_min_free", minFree, HEAP_MARGIN_MIN_BYTES);
+    TEST_ASSERT_TRUE_MESSAGE(minFree >= HEAP_MARGIN_MIN_BYTES,
+                             "heap minimum-free floor breached");
+}
+
+void setup() {
+    delay(2000); // let the serial monitor attach
+
+    marginHistory.begin();
+    runWorkers();
+
+    UNITY_BEGIN();
+    RUN_TEST(margin_ble_task_stack);
+    RUN_TEST(margin_sensor_task_stack);
+    RUN_TEST(margin_heap_min_free);
+    UNITY_END();
+}
+
+void loop() {}
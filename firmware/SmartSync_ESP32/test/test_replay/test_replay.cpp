@@ -0,0 +1,211 @@
+// Trace replay: pio test -e native -f test_replay. Feeds sequences of
+// HistoryRecords — the timestamped raw sensor inputs the firmware
+// already captures to the history partition every SENSOR_READ_INTERVAL
+// — through the real decision code (OccupancyEstimator +
+// AutoModePolicy) with the record timestamps as the clock. Six hours
+// of field behavior replays in well under a second, so an incident
+// pulled off a unit with history sync becomes a regression test.
+//
+// To replay a real capture: dump the synced records as raw 16-byte
+// HistoryRecords and point REPLAY_TRACE at the file.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <stdlib.h>
+
+#include "../../src/control/AutoModePolicy.h"
+#include "../../src/sensors/OccupancyEstimator.h"
+#include "../../src/storage/HistoryLog.h"
+#include "../../src/ble/SensorFrame.h"
+
+uint32_t nativeMillisValue = 0;
+
+// ============================================================
+// REPLAY RIG
+// ============================================================
+// The real policy objects plus a mirror of requestAutoFanSpeed's
+// queue-side funnel (dedupe against the applied duty, dwell unless
+// urgent). Keep step() in lockstep with requestAutoFanSpeed in
+// main.cpp — it is deliberately the same ~8 lines.
+struct ReplayRig {
+    AutoModePolicy policy;
+    OccupancyEstimator occupancy;
+    uint8_t appliedDuty;
+    uint32_t lastChangeMs;
+    uint32_t transitions;
+    uint8_t maxDuty;
+    bool prevMotion;
+
+    ReplayRig()
+        : appliedDuty(0), lastChangeMs(0), transitions(0), maxDuty(0),
+          prevMotion(false) {
+        occupancy.setHourOfDay(-1); // traces rarely carry the RTC hour
+    }
+
+    void step(const HistoryRecord& rec) {
+        // The record timestamp is the clock: everything downstream
+        // (PIR decay, trend dt, PID dt) sees field time, not wall time.
+        nativeMillisValue = rec.timestampMs;
+
+        bool motion = (rec.flags & SENSOR_FLAG_MOTION) != 0;
+        if (motion && !prevMotion) {
+            occupancy.noteMotion(rec.timestampMs);
+        }
+        prevMotion = motion;
+        occupancy.noteDistance((float)rec.distance * 0.1f);
+
+        float temp = (float)rec.temperature * 0.01f;
+        policy.noteTemperature(temp, rec.timestampMs);
+        AutoModePolicy::Decision d = policy.evaluate(
+            temp, occupancy.confidence(), rec.timestampMs);
+
+        // requestAutoFanSpeed, minus the queue and the trace event.
+        if (d.duty == appliedDuty) {
+            return;
+        }
+        if (!d.urgent && lastChangeMs != 0 &&
+            rec.timestampMs - lastChangeMs < FAN_MIN_DWELL_MS) {
+            return;
+        }
+        appliedDuty = d.duty;
+        lastChangeMs = rec.timestampMs;
+        transitions++;
+        if (d.duty > maxDuty) {
+            maxDuty = d.duty;
+        }
+    }
+};
+
+// ============================================================
+// SYNTHETIC TRACES
+// ============================================================
+// Deterministic record generator at the sensor cadence. Motion pulses
+// once a minute keep the PIR score above the occupancy gate; distance
+// holds a fixed room geometry.
+static HistoryRecord makeRecord(uint32_t index, float tempC, bool occupied) {
+    HistoryRecord rec;
+    rec.sequence = index + 1;
+    rec.timestampMs = index * SENSOR_READ_INTERVAL;
+    rec.temperature = (int16_t)(tempC * 100.0f);
+    rec.humidity = 5000;
+    rec.distance = 2500; // 250 cm to the far wall
+    rec.flags = (occupied && index % 6 == 0) ? SENSOR_FLAG_MOTION : 0;
+    rec.reserved = 0;
+    return rec;
+}
+
+// The incident shape that motivated the over-temperature latch: an
+// afternoon hovering just above the threshold with sensor-noise sized
+// oscillation. Without hysteresis this flips full speed every cycle.
+static float hoverAfternoonTemp(uint32_t index) {
+    uint32_t hour = index / 360; // 360 records per hour at 10 s
+    if (hour == 0) {
+        // Ramp from comfortable past the threshold.
+        return 26.0f + (float)index * (7.0f / 360.0f);
+    }
+    if (hour < 5) {
+        // Hover 31.4..32.6 across the 32.0 threshold, period ~4 min.
+        return 32.0f + ((index % 24) < 12 ? 0.6f : -0.6f);
+    }
+    // Cool-down, well below threshold minus hysteresis.
+    return 33.0f - (float)(index - 5 * 360) * (6.0f / 360.0f);
+}
+
+static void test_replay_hover_afternoon_latches_once() {
+    ReplayRig rig;
+    uint32_t transitionsEnteringHover = 0;
+    uint32_t transitionsLeavingHover = 0;
+    for (uint32_t i = 0; i < 6 * 360; i++) {
+        rig.step(makeRecord(i, hoverAfternoonTemp(i), true));
+        if (i == 360) transitionsEnteringHover = rig.transitions;
+        if (i == 5 * 360) transitionsLeavingHover = rig.transitions;
+    }
+    // The override fired...
+    TEST_ASSERT_EQUAL_UINT8(255, rig.maxDuty);
+    // ...and the latch held through four hours of oscillation across
+    // the threshold: at most enter-full-speed once, plus one release
+    // if a trough dipped past the hysteresis band. The unlatched bug
+    // this pins produced hundreds here (urgent bypasses the dwell).
+    TEST_ASSERT_TRUE(transitionsLeavingHover - transitionsEnteringHover <= 2);
+    // Whole trace stays dwell-shaped: the ramp emits roughly one PID
+    // step per dwell until it saturates (~17), the cool-down a few
+    // more. Flapping shows up here as hundreds.
+    TEST_ASSERT_TRUE(rig.transitions <= 32);
+}
+
+static void test_replay_empty_room_holds_fan_off() {
+    ReplayRig rig;
+    // Warm but empty: no motion records, static geometry. The
+    // occupancy gate must hold the fan at zero the whole evening.
+    for (uint32_t i = 0; i < 3 * 360; i++) {
+        rig.step(makeRecord(i, 29.0f, false));
+    }
+    TEST_ASSERT_EQUAL_UINT8(0, rig.appliedDuty);
+    TEST_ASSERT_EQUAL_UINT32(0, rig.transitions);
+}
+
+static void test_replay_departure_releases_fan() {
+    ReplayRig rig;
+    // Occupied and warm for an hour, then the room empties. The PIR
+    // decay plus the occupancy hysteresis release the gate and the
+    // fan request drops to zero.
+    for (uint32_t i = 0; i < 360; i++) {
+        rig.step(makeRecord(i, 29.0f, true));
+    }
+    TEST_ASSERT_TRUE(rig.appliedDuty > 0);
+    for (uint32_t i = 360; i < 2 * 360; i++) {
+        rig.step(makeRecord(i, 29.0f, false));
+    }
+    TEST_ASSERT_EQUAL_UINT8(0, rig.appliedDuty);
+}
+
+// ============================================================
+// CAPTURED TRACES
+// ============================================================
+// Replays a real field capture when REPLAY_TRACE names a file of raw
+// 16-byte HistoryRecords; prints a summary for eyeballing and holds
+// the dwell invariant. Skipped when no trace is provided.
+static void test_replay_captured_trace() {
+    const char* path = getenv("REPLAY_TRACE");
+    if (path == NULL) {
+        TEST_IGNORE_MESSAGE("set REPLAY_TRACE to a HistoryRecord dump");
+    }
+    FILE* f = fopen(path, "rb");
+    TEST_ASSERT_NOT_NULL_MESSAGE(f, "REPLAY_TRACE not readable");
+
+    ReplayRig rig;
+    HistoryRecord rec;
+    uint32_t records = 0;
+    uint32_t firstMs = 0;
+    uint32_t lastMs = 0;
+    while (fread(&rec, sizeof(rec), 1, f) == 1) {
+        if (rec.sequence == 0xFFFFFFFF) {
+            continue; // blank flash from a partial sector dump
+        }
+        if (records == 0) {
+            firstMs = rec.timestampMs;
+        }
+        lastMs = rec.timestampMs;
+        rig.step(rec);
+        records++;
+    }
+    fclose(f);
+    TEST_ASSERT_TRUE_MESSAGE(records > 0, "trace held no records");
+
+    printf("REPLAY,%s,%u records,%u ms span,%u transitions,final %u\n",
+           path, (unsigned)records, (unsigned)(lastMs - firstMs),
+           (unsigned)rig.transitions, (unsigned)rig.appliedDuty);
+    // Non-urgent changes obey the dwell; allow one urgent latch pair.
+    TEST_ASSERT_TRUE(rig.transitions <=
+                     (lastMs - firstMs) / FAN_MIN_DWELL_MS + 3);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_replay_hover_afternoon_latches_once);
+    RUN_TEST(test_replay_empty_room_holds_fan_off);
+    RUN_TEST(test_replay_departure_releases_fan);
+    RUN_TEST(test_replay_captured_trace);
+    return UNITY_END();
+}
@@ -0,0 +1,270 @@
+// Host tests for the sensor-processing stack: pio test -e native.
+//
+// SensorBank builds against the scripted mock drivers
+// (test/native_stubs/MockSensorDrivers.h, SENSOR_BANK_MOCK_DRIVERS),
+// so the acquisition, quarantine and filter logic that ships is
+// driven here with waveforms no bench sensor produces on demand — NaN
+// streaks, echo-timeout streaks, outlier bursts — and the quarantine
+// skip-and-probe schedule is asserted cycle by cycle from the mocks'
+// start counters. The earlier test_sensors.cpp read live hardware and
+// could only confirm a value was in range; these run in milliseconds
+// with no sensor attached. True ISR latency stays the latency rig's
+// job (esp32dev-testrig + tests/performance/hil_latency.py).
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "../../src/sensors/SensorBank.h"
+#include "../../src/sensors/OccupancyEstimator.h"
+
+uint32_t nativeMillisValue = 0;
+
+// Fresh bank per test: placement-new over static storage, the same
+// way SensorSet holds its drivers — no heap, no stale driver
+// registrations from the previous test.
+static uint8_t bankStorage[sizeof(SensorBank)]
+    __attribute__((aligned(alignof(SensorBank))));
+
+static SensorBank& freshBank() {
+    DHT22Sensor::resetRegistry();
+    UltrasonicSensor::resetRegistry();
+    nativeMillisValue = 1000;
+    SensorBank& bank = *(new (bankStorage) SensorBank());
+    bank.begin();
+    return bank;
+}
+
+static DHT22Sensor& dht0() { return *DHT22Sensor::channel(0); }
+static UltrasonicSensor& ultra0() { return *UltrasonicSensor::channel(0); }
+
+// Advances time the way the sensor task does between acquisitions.
+static void cycle(SensorBank& bank) {
+    nativeMillisValue += SENSOR_READ_INTERVAL;
+    bank.acquire();
+}
+
+// ============================================================
+// NOMINAL PATH
+// ============================================================
+static void test_nominal_cycle_fills_samples() {
+    SensorBank& bank = freshBank();
+    dht0().scriptReading(24.5f, 55.0f);
+    ultra0().scriptDistanceCm(120.0f);
+
+    cycle(bank);
+
+    TEST_ASSERT_EQUAL_UINT8(1, bank.dht().valid[0]);
+    TEST_ASSERT_EQUAL_UINT8(1, bank.range().valid[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 24.5f, bank.dht().temperatureRaw[0]);
+    // First sample primes the EWMA, so filtered == raw.
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 24.5f, bank.dht().temperature[0]);
+    TEST_ASSERT_FALSE(bank.faultActive());
+}
+
+// ============================================================
+// FAULT DETECTION AND QUARANTINE
+// ============================================================
+static void test_nan_streak_quarantines_dht() {
+    SensorBank& bank = freshBank();
+    for (uint8_t i = 0; i < SENSOR_FAULT_THRESHOLD; i++) {
+        dht0().scriptFailure();
+    }
+
+    for (uint8_t i = 0; i < SENSOR_FAULT_THRESHOLD - 1; i++) {
+        cycle(bank);
+        TEST_ASSERT_FALSE(bank.faultActive()); // streak not full yet
+    }
+    cycle(bank);
+    TEST_ASSERT_TRUE(bank.faultActive());
+    TEST_ASSERT_EQUAL_UINT8(0, bank.dht().valid[0]);
+}
+
+static void test_quarantine_skips_then_probes_on_schedule() {
+    SensorBank& bank = freshBank();
+    for (uint8_t i = 0; i < SENSOR_FAULT_THRESHOLD + 1; i++) {
+        dht0().scriptFailure(); // streak plus one failed probe
+    }
+    for (uint8_t i = 0; i < SENSOR_FAULT_THRESHOLD; i++) {
+        cycle(bank);
+    }
+    uint32_t startsAtQuarantine = dht0().startCount();
+
+    // The skip window: no starts at all for BACKOFF_START cycles.
+    for (uint16_t i = 0; i < SENSOR_FAULT_BACKOFF_START; i++) {
+        cycle(bank);
+        TEST_ASSERT_EQUAL_UINT32(startsAtQuarantine, dht0().startCount());
+    }
+    // The probe cycle: exactly one start, and its scripted failure
+    // doubles the backoff.
+    cycle(bank);
+    TEST_ASSERT_EQUAL_UINT32(startsAtQuarantine + 1, dht0().startCount());
+
+    for (uint16_t i = 0; i < SENSOR_FAULT_BACKOFF_START * 2; i++) {
+        cycle(bank);
+        TEST_ASSERT_EQUAL_UINT32(startsAtQuarantine + 1, dht0().startCount());
+    }
+    cycle(bank); // second probe, after the doubled interval
+    TEST_ASSERT_EQUAL_UINT32(startsAtQuarantine + 2, dht0().startCount());
+}
+
+static void test_successful_probe_recovers_channel() {
+    SensorBank& bank = freshBank();
+    for (uint8_t i = 0; i < SENSOR_FAULT_THRESHOLD; i++) {
+        dht0().scriptFailure();
+    }
+    dht0().scriptReading(23.0f, 48.0f); // the probe finds it healthy
+
+    for (uint8_t i = 0; i < SENSOR_FAULT_THRESHOLD; i++) {
+        cycle(bank);
+    }
+    TEST_ASSERT_TRUE(bank.faultActive());
+
+    for (uint16_t i = 0; i <= SENSOR_FAULT_BACKOFF_START; i++) {
+        cycle(bank); // skip window plus the probe cycle
+    }
+    TEST_ASSERT_FALSE(bank.faultActive());
+    TEST_ASSERT_EQUAL_UINT8(1, bank.dht().valid[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 23.0f, bank.dht().temperatureRaw[0]);
+
+    // Recovered means every-cycle sampling again, not another probe.
+    uint32_t starts = dht0().startCount();
+    cycle(bank);
+    TEST_ASSERT_EQUAL_UINT32(starts + 1, dht0().startCount());
+}
+
+static void test_echo_timeout_streak_quarantines_ultrasonic() {
+    SensorBank& bank = freshBank();
+    for (uint8_t i = 0; i < SENSOR_FAULT_THRESHOLD; i++) {
+        ultra0().scriptTimeout();
+    }
+    for (uint8_t i = 0; i < SENSOR_FAULT_THRESHOLD; i++) {
+        cycle(bank);
+    }
+    TEST_ASSERT_TRUE(bank.faultActive());
+
+    uint32_t starts = ultra0().startCount();
+    cycle(bank);
+    TEST_ASSERT_EQUAL_UINT32(starts, ultra0().startCount()); // skipped
+}
+
+// ============================================================
+// FILTERING THROUGH THE BANK
+// ============================================================
+static void test_outlier_burst_held_by_median() {
+    SensorBank& bank = freshBank();
+    // Prime the median window, then a two-echo scatter burst well
+    // past DISTANCE_OUTLIER_CM, then back to truth.
+    for (uint8_t i = 0; i < 5; i++) {
+        ultra0().scriptDistanceCm(100.0f);
+    }
+    ultra0().scriptDistanceCm(250.0f);
+    ultra0().scriptDistanceCm(250.0f);
+    ultra0().scriptDistanceCm(100.0f);
+
+    for (uint8_t i = 0; i < 8; i++) {
+        cycle(bank);
+        TEST_ASSERT_FLOAT_WITHIN(5.0f, 100.0f, bank.range().distance[0]);
+    }
+}
+
+static void test_persistent_step_change_is_admitted() {
+    SensorBank& bank = freshBank();
+    for (uint8_t i = 0; i < 5; i++) {
+        ultra0().scriptDistanceCm(100.0f);
+    }
+    // A genuine approach: the new distance persists, so the gate
+    // admits one sample per full outlier window and the median crosses
+    // once three of five slots hold the new range (15 samples). The
+    // wider tolerance absorbs the sound-speed trim the bank applies
+    // from the mock's nominal air temperature.
+    for (uint8_t i = 0; i < 16; i++) {
+        ultra0().scriptDistanceCm(250.0f);
+    }
+    for (uint8_t i = 0; i < 21; i++) {
+        cycle(bank);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(10.0f, 250.0f, bank.range().distance[0]);
+}
+
+// ============================================================
+// CALIBRATION AND COMPENSATION
+// ============================================================
+static void test_calibration_trim_applied_at_ingestion() {
+    SensorBank& bank = freshBank();
+    static const int16_t tempOffset[SensorBank::DHT_COUNT] = {
+        calOffsetCenti(0.5f) };
+    static const int16_t humOffset[SensorBank::DHT_COUNT] = {
+        calOffsetCenti(-2.0f) };
+    static const uint16_t distScale[SensorBank::ULTRA_COUNT] = {
+        calScaleQ15(1.0f) };
+    bank.setCalibration(tempOffset, humOffset, distScale);
+
+    dht0().scriptReading(24.0f, 50.0f);
+    cycle(bank);
+
+    // Trim lands in the raw values, so filtered and history both
+    // carry it.
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 24.5f, bank.dht().temperatureRaw[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 48.0f, bank.dht().humidityRaw[0]);
+}
+
+static void test_sound_speed_compensation_tracks_air_temp() {
+    SensorBank& bank = freshBank();
+    // Cycle 1 measures hot air; cycle 2's ranging is compensated with
+    // it. At 35 °C sound runs ~3.5% faster than the driver's 340 m/s
+    // constant, so the same echo reads proportionally longer.
+    dht0().scriptReading(35.0f, 40.0f);
+    dht0().scriptReading(35.0f, 40.0f);
+    ultra0().scriptDistanceCm(100.0f);
+    ultra0().scriptDistanceCm(100.0f);
+
+    cycle(bank);
+    cycle(bank);
+
+    float expected = 100.0f * (331.3f + 0.606f * 35.0f) / 340.0f;
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, expected, bank.range().distanceRaw[0]);
+}
+
+// ============================================================
+// PIR PULSE TIMING
+// ============================================================
+static void test_pir_pulse_decay_window() {
+    OccupancyEstimator occ;
+    nativeMillisValue = 10000;
+    occ.noteMotion(nativeMillisValue);
+    uint8_t fresh = occ.confidence();
+    TEST_ASSERT_TRUE(fresh >= OCCUPANCY_CONFIDENCE_MIN);
+
+    // The pulse fades linearly across the decay window — monotonic,
+    // never a cliff mid-window.
+    uint8_t prev = fresh;
+    for (uint8_t i = 0; i < 8; i++) {
+        nativeMillisValue += OCCUPANCY_PIR_DECAY_MS / 8;
+        uint8_t now = occ.confidence();
+        TEST_ASSERT_TRUE(now <= prev);
+        prev = now;
+    }
+    // Exactly one window later the pulse contributes nothing; the
+    // neutral prior alone sits far below the latch threshold.
+    TEST_ASSERT_TRUE(occ.confidence() < OCCUPANCY_CONFIDENCE_MIN);
+
+    // A new edge restores full strength instantly — PIR is a
+    // re-trigger, not a ramp-up.
+    occ.noteMotion(nativeMillisValue);
+    TEST_ASSERT_EQUAL_UINT8(fresh, occ.confidence());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_nominal_cycle_fills_samples);
+    RUN_TEST(test_nan_streak_quarantines_dht);
+    RUN_TEST(test_quarantine_skips_then_probes_on_schedule);
+    RUN_TEST(test_successful_probe_recovers_channel);
+    RUN_TEST(test_echo_timeout_streak_quarantines_ultrasonic);
+    RUN_TEST(test_outlier_burst_held_by_median);
+    RUN_TEST(test_persistent_step_change_is_admitted);
+    RUN_TEST(test_calibration_trim_applied_at_ingestion);
+    RUN_TEST(test_sound_speed_compensation_tracks_air_temp);
+    RUN_TEST(test_pir_pulse_decay_window);
+    return UNITY_END();
+}
@@ -0,0 +1,490 @@
+#!/usr/bin/env python3
+"""Generate the host-side protocol parsers from the firmware schema.
+
+The single source of truth for the wire protocol is the firmware
+itself: the SENSOR_FRAME_SCHEMA X-macro plus the packed frame structs
+in firmware/SmartSync_ESP32/src/ble/SensorFrame.h, and the command
+opcodes in src/ble/CommandParser.h. This script expands those into
+
+  app/lib/models/sensor_frame.g.dart
+      fixed-offset Dart parser for the sensor snapshot, so the app
+      reads ByteData offsets instead of decoding JSON at chart rates
+
+  tests/performance/smartsync_protocol.py
+      the protocol simulator the Python harness imports — command
+      encoders and pack/unpack classes for every packed frame struct,
+      so load/stress/soak tests validate every field of every frame
+      without hand-crafting bytes that rot when the protocol moves
+
+Change a field in the firmware headers, rerun this, and every end
+moves together — there is no second place to keep in sync.
+
+Scale factors for the Dart parser come from the FIELD decode
+expressions ("* 0.01f"), so the Dart values carry the same units as
+the legacy JSON. The Python classes stay raw — the harness asserts
+wire values, not display values.
+
+Usage:
+  gen_protocol.py            rewrite both generated files
+  gen_protocol.py --check    exit 1 if either generated file is stale
+"""
+
+import os
+import re
+import sys
+
+REPO = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+SCHEMA_HEADER = os.path.join(
+    REPO, "firmware", "SmartSync_ESP32", "src", "ble", "SensorFrame.h")
+COMMAND_HEADER = os.path.join(
+    REPO, "firmware", "SmartSync_ESP32", "src", "ble", "CommandParser.h")
+CONFIG_HEADER = os.path.join(
+    REPO, "firmware", "SmartSync_ESP32", "include", "config.h")
+DART_OUT = os.path.join(REPO, "app", "lib", "models", "sensor_frame.g.dart")
+PY_OUT = os.path.join(REPO, "tests", "performance", "smartsync_protocol.py")
+
+CTYPE = {
+    # size, ByteData getter
+    "uint8_t": (1, "getUint8"),
+    "int8_t": (1, "getInt8"),
+    "uint16_t": (2, "getUint16"),
+    "int16_t": (2, "getInt16"),
+    "uint32_t": (4, "getUint32"),
+    "int32_t": (4, "getInt32"),
+}
+
+# C scalar type -> struct-module format character.
+PY_CTYPE = {
+    "uint8_t": "B",
+    "int8_t": "b",
+    "uint16_t": "H",
+    "int16_t": "h",
+    "uint32_t": "I",
+    "int32_t": "i",
+    "uint64_t": "Q",
+    "int64_t": "q",
+    "float": "f",
+    "char": "s",
+}
+
+
+def strip_macro_body(text, name):
+    """Return the continuation-joined body of a #define macro."""
+    lines = text.splitlines()
+    for i, line in enumerate(lines):
+        if not line.startswith("#define %s(" % name):
+            continue
+        body = [line]
+        while body[-1].rstrip().endswith("\\"):
+            i += 1
+            body.append(lines[i])
+        joined = " ".join(part.rstrip().rstrip("\\") for part in body)
+        return re.sub(r"/\*.*?\*/", " ", joined)
+    sys.exit("schema macro %s not found in %s" % (name, SCHEMA_HEADER))
+
+
+def parse_schema(text):
+    body = strip_macro_body(text, "SENSOR_FRAME_SCHEMA")
+    fields = []
+    for row in re.finditer(
+            r"\bFIELD\(\s*(\w+)\s*,\s*(\w+)\s*,\s*\"([^\"]*)\"\s*,"
+            r"\s*\"([^\"]*)\"\s*,\s*(.*?)\)\s*(?=FIELD|BIN|$)", body):
+        name, ctype, key, fmt, expr = row.groups()
+        scale = re.search(r"\*\s*([0-9.]+)f", expr)
+        fields.append((name, ctype, float(scale.group(1)) if scale else None))
+    for row in re.finditer(r"\bBIN\(\s*(\w+)\s*,\s*(\w+)\s*\)", body):
+        fields.append((row.group(1), row.group(2), None))
+    if not fields:
+        sys.exit("no schema rows parsed from %s" % SCHEMA_HEADER)
+    return fields
+
+
+def parse_define(text, name):
+    m = re.search(r"#define %s (\S+)" % name, text)
+    if not m:
+        sys.exit("#define %s not found in %s" % (name, SCHEMA_HEADER))
+    return int(m.group(1), 0)
+
+
+def parse_flags(text):
+    return re.findall(r"SENSOR_FLAG_(\w+)\s*=\s*(0x[0-9A-Fa-f]+)", text)
+
+
+def camel(name):
+    words = name.lower().split("_")
+    return words[0] + "".join(w.capitalize() for w in words[1:])
+
+
+def generate():
+    with open(SCHEMA_HEADER) as f:
+        text = f.read()
+
+    magic = parse_define(text, "FRAME_MAGIC")
+    version = parse_define(text, "SENSOR_FRAME_VERSION")
+    fields = parse_schema(text)
+    flags = parse_flags(text)
+
+    offset = 4  # magic, version, type, flags
+    members = []   # (dartName, dartType, readExpr)
+    for name, ctype, scale in fields:
+        size, getter = CTYPE[ctype]
+        if size == 1:
+            read = "bytes.%s(%d)" % (getter, offset)
+        else:
+            read = "bytes.%s(%d, Endian.little)" % (getter, offset)
+        if scale is not None:
+            members.append((name, "double", "%s * %s" % (read, scale)))
+        else:
+            members.append((name, "int", read))
+        offset += size
+    members.append(
+        ("timestampMs", "int",
+         "bytes.getUint32(%d, Endian.little)" % offset))
+    frame_len = offset + 4
+
+    out = []
+    out.append("// GENERATED CODE - DO NOT MODIFY BY HAND")
+    out.append("//")
+    out.append("// Generated by scripts/codegen/gen_protocol.py from the")
+    out.append("// SENSOR_FRAME_SCHEMA rows in")
+    out.append("// firmware/SmartSync_ESP32/src/ble/SensorFrame.h. Edit the")
+    out.append("// schema there and rerun the script; never edit this file.")
+    out.append("")
+    out.append("import 'dart:typed_data';")
+    out.append("")
+    out.append("/// Full sensor snapshot notified on the TX characteristic,")
+    out.append("/// %d bytes, all multi-byte fields little-endian." % frame_len)
+    out.append("class SensorFrame {")
+    out.append("  static const int frameMagic = 0x%02X;" % magic)
+    out.append("  static const int frameVersion = %d;" % version)
+    out.append("  static const int frameTypeSensor = 0x01;")
+    out.append("  static const int frameLength = %d;" % frame_len)
+    out.append("")
+    for fname, value in flags:
+        out.append("  static const int flag%s = %s;"
+                   % (fname.capitalize(), value))
+    out.append("")
+    out.append("  final int flags;")
+    for name, dtype, _ in members:
+        out.append("  final %s %s;" % (dtype, name))
+    out.append("")
+    for fname, _ in flags:
+        out.append("  bool get %s => flags & flag%s != 0;"
+                   % (camel(fname), fname.capitalize()))
+    out.append("")
+    out.append("  SensorFrame._({")
+    out.append("    required this.flags,")
+    for name, _, _ in members:
+        out.append("    required this.%s," % name)
+    out.append("  });")
+    out.append("")
+    out.append("  /// Returns null unless [data] is a full sensor snapshot")
+    out.append("  /// (other frame types share the characteristic).")
+    out.append("  static SensorFrame? parse(List<int> data) {")
+    out.append("    if (data.length < frameLength) return null;")
+    out.append("    final bytes = ByteData.sublistView(")
+    out.append("        data is Uint8List ? data : Uint8List.fromList(data));")
+    out.append("    if (bytes.getUint8(0) != frameMagic) return null;")
+    out.append("    if (bytes.getUint8(2) != frameTypeSensor) return null;")
+    out.append("    return SensorFrame._(")
+    out.append("      flags: bytes.getUint8(3),")
+    for name, _, read in members:
+        out.append("      %s: %s," % (name, read))
+    out.append("    );")
+    out.append("  }")
+    out.append("}")
+    out.append("")
+    return "\n".join(out)
+
+
+# ---------------------------------------------------------------------------
+# Python protocol simulator (tests/performance/smartsync_protocol.py)
+# ---------------------------------------------------------------------------
+
+def parse_enum(text, enum_name):
+    """Returns [(name, value)] for a `enum Name : uint8_t { ... };`."""
+    m = re.search(r"enum %s\s*:\s*\w+\s*\{(.*?)\};" % enum_name, text,
+                  re.DOTALL)
+    if not m:
+        sys.exit("enum %s not found" % enum_name)
+    entries = []
+    values = {}
+    for line in m.group(1).splitlines():
+        line = re.sub(r"//.*", "", line).strip()
+        em = re.match(r"(\w+)\s*=\s*(\w+)\s*,?", line)
+        if not em:
+            continue
+        name, value = em.groups()
+        resolved = values[value] if value in values else int(value, 0)
+        values[name] = resolved
+        entries.append((name, resolved))
+    return entries
+
+
+def parse_config_defines():
+    """Numeric #defines from config.h, for array dimensions."""
+    defines = {}
+    with open(CONFIG_HEADER) as f:
+        for m in re.finditer(r"#define (\w+) (\d+)\b", f.read()):
+            defines[m.group(1)] = int(m.group(2))
+    return defines
+
+
+def parse_structs(text, schema_fields, defines):
+    """Returns [(name, frame_type or None, [(field, ctype, count)])] for
+    every packed struct, in header order. The SensorFrame body expands
+    its schema macro the same way the C++ preprocessor does."""
+    structs = []
+    for m in re.finditer(
+            r"struct __attribute__\(\(packed\)\) (\w+) \{(.*?)\};",
+            text, re.DOTALL):
+        name, body = m.groups()
+        tm = re.search(r"\btype;\s*//\s*(FRAME_TYPE_\w+)", body)
+        frame_type = tm.group(1) if tm else None
+        fields = []
+        for line in body.splitlines():
+            if "SENSOR_FRAME_SCHEMA(" in line:
+                fields.extend((f, c, 1) for f, c, _ in schema_fields)
+                continue
+            line = re.sub(r"//.*", "", line).strip()
+            fm = re.match(r"(\w+)\s+(\w+)(?:\[(\w+)\])?;", line)
+            if not fm:
+                continue
+            ctype, fname, dim = fm.groups()
+            count = 1
+            if dim is not None:
+                count = int(dim, 0) if dim[0].isdigit() else defines[dim]
+            fields.append((fname, ctype, count))
+        structs.append((name, frame_type, fields))
+    return structs
+
+
+# Emitted verbatim into the generated module: the pack/unpack runtime
+# the per-struct FIELDS tables drive.
+PY_RUNTIME = '''
+class _Packed(object):
+    """Base for the generated frame classes. FIELDS rows are
+    (name, fmt, count): fmt is a struct-module character or a nested
+    _Packed subclass; "s"-fields carry bytes, count > 1 scalar fields
+    carry tuples."""
+
+    FIELDS = ()
+
+    def __init__(self, **kwargs):
+        for name, fmt, count in self.FIELDS:
+            if isinstance(fmt, type):
+                default = fmt()
+            elif fmt == "s":
+                default = b"\\x00" * count
+            elif count > 1:
+                default = (0,) * count
+            elif fmt == "f":
+                default = 0.0
+            else:
+                default = 0
+            setattr(self, name, kwargs.pop(name, default))
+        if kwargs:
+            raise TypeError("unknown fields: %s" % ", ".join(kwargs))
+
+    @classmethod
+    def _fmt(cls):
+        parts = []
+        for _, fmt, count in cls.FIELDS:
+            if isinstance(fmt, type):
+                parts.append(fmt._fmt() * count)
+            elif fmt == "s":
+                parts.append("%ds" % count)
+            else:
+                parts.append(fmt * count)
+        return "".join(parts)
+
+    @classmethod
+    def size(cls):
+        return struct.calcsize("<" + cls._fmt())
+
+    def _flatten(self, out):
+        for name, fmt, count in self.FIELDS:
+            value = getattr(self, name)
+            if isinstance(fmt, type):
+                for item in value if count > 1 else (value,):
+                    item._flatten(out)
+            elif fmt == "s":
+                out.append(bytes(value)[:count].ljust(count, b"\\x00"))
+            elif count > 1:
+                out.extend(value)
+            else:
+                out.append(value)
+
+    def pack(self):
+        flat = []
+        self._flatten(flat)
+        return struct.pack("<" + self._fmt(), *flat)
+
+    @classmethod
+    def _consume(cls, values):
+        obj = cls.__new__(cls)
+        for name, fmt, count in cls.FIELDS:
+            if isinstance(fmt, type):
+                items = tuple(fmt._consume(values) for _ in range(count))
+                setattr(obj, name, items if count > 1 else items[0])
+            elif fmt == "s":
+                setattr(obj, name, next(values))
+            elif count > 1:
+                setattr(obj, name, tuple(next(values) for _ in range(count)))
+            else:
+                setattr(obj, name, next(values))
+        return obj
+
+    @classmethod
+    def unpack(cls, data):
+        """Decodes the leading size() bytes of data; trailing bytes
+        (chunk payloads, per-entry records) are the caller's."""
+        if len(data) < cls.size():
+            raise ValueError("%s needs %d bytes, got %d"
+                             % (cls.__name__, cls.size(), len(data)))
+        flat = struct.unpack_from("<" + cls._fmt(), bytes(data))
+        return cls._consume(iter(flat))
+
+    def __repr__(self):
+        pairs = ("%s=%r" % (name, getattr(self, name))
+                 for name, _, _ in self.FIELDS)
+        return "%s(%s)" % (type(self).__name__, ", ".join(pairs))
+
+    def __eq__(self, other):
+        return (type(self) is type(other) and
+                all(getattr(self, n) == getattr(other, n)
+                    for n, _, _ in self.FIELDS))
+
+
+def encode_command(opcode, payload=b""):
+    """Binary command write for the RX characteristic."""
+    return bytes((CMD_MAGIC, opcode)) + bytes(payload)
+
+
+def decode_frame(data):
+    """Splits a TX notification into (frame, tail).
+
+    frame is the unpacked header class for the type byte and tail is
+    whatever follows it (chunk payload, per-entry records). Returns
+    (None, data) for a type with no generated class — history chunks
+    keep their layout in HistoryEncoder.h. Raises ValueError on a
+    frame that is not ours at all.
+    """
+    data = bytes(data)
+    if len(data) < 3 or data[0] != FRAME_MAGIC:
+        raise ValueError("not a frame: %r" % data[:4])
+    cls = FRAME_CLASSES.get(data[2])
+    if cls is None:
+        return None, data
+    frame = cls.unpack(data)
+    return frame, data[cls.size():]
+'''
+
+
+def generate_python():
+    with open(SCHEMA_HEADER) as f:
+        frame_text = f.read()
+    with open(COMMAND_HEADER) as f:
+        command_text = f.read()
+    defines = parse_config_defines()
+
+    schema_fields = parse_schema(frame_text)
+    structs = parse_structs(frame_text, schema_fields, defines)
+    struct_names = {name for name, _, _ in structs}
+    frame_types = parse_enum(frame_text, "FrameType")
+    opcodes = parse_enum(command_text, "CommandOpcode")
+
+    out = []
+    out.append("# GENERATED CODE - DO NOT MODIFY BY HAND")
+    out.append("#")
+    out.append("# Generated by scripts/codegen/gen_protocol.py from the")
+    out.append("# packed structs and enums in")
+    out.append("# firmware/SmartSync_ESP32/src/ble/SensorFrame.h and")
+    out.append("# src/ble/CommandParser.h. Edit the firmware headers and")
+    out.append("# rerun the script; never edit this file.")
+    out.append('"""Protocol simulator for the SmartSync Python test harness.')
+    out.append("")
+    out.append("Encodes binary commands and packs/unpacks every frame the")
+    out.append("firmware notifies, from the same schema the firmware")
+    out.append("serializer compiles — so the harness validates every field")
+    out.append("of every frame without hand-crafted byte strings.")
+    out.append('"""')
+    out.append("")
+    out.append("import struct")
+    out.append("")
+    out.append("FRAME_MAGIC = 0x%02X"
+               % parse_define(frame_text, "FRAME_MAGIC"))
+    out.append("SENSOR_FRAME_VERSION = %d"
+               % parse_define(frame_text, "SENSOR_FRAME_VERSION"))
+    out.append("CMD_MAGIC = 0x%02X" % parse_define(command_text, "CMD_MAGIC"))
+    out.append("")
+    out.append("# FrameType")
+    for name, value in frame_types:
+        out.append("%s = 0x%02X" % (name, value))
+    out.append("")
+    out.append("# CommandOpcode")
+    for name, value in opcodes:
+        out.append("%s = 0x%02X" % (name, value))
+    out.append("")
+    out.append("# SensorFrameFlags")
+    for name, value in parse_flags(frame_text):
+        out.append("SENSOR_FLAG_%s = %s" % (name, value))
+    out.append("")
+    out.append("# SensorFieldBits (delta-frame bitmap)")
+    for name, value in re.findall(r"(FIELD_\w+)\s*=\s*(0x[0-9A-Fa-f]+)",
+                                  frame_text):
+        out.append("%s = %s" % (name, value))
+    out.append("")
+    out.append(PY_RUNTIME.strip())
+    out.append("")
+
+    for name, _, fields in structs:
+        out.append("")
+        out.append("class %s(_Packed):" % name)
+        out.append("    FIELDS = (")
+        for fname, ctype, count in fields:
+            if ctype in struct_names:
+                fmt = ctype
+            else:
+                fmt = '"%s"' % PY_CTYPE[ctype]
+            out.append("        (%r, %s, %d)," % (fname, fmt, count))
+        out.append("    )")
+    out.append("")
+    out.append("")
+    out.append("# Header class per TX frame type; types absent here keep")
+    out.append("# their layout elsewhere (history chunks: HistoryEncoder.h).")
+    out.append("FRAME_CLASSES = {")
+    for name, frame_type, _ in structs:
+        if frame_type is not None:
+            out.append("    %s: %s," % (frame_type, name))
+    out.append("}")
+    out.append("")
+    return "\n".join(out)
+
+
+def emit(path, generated, check):
+    rel = os.path.relpath(path, REPO)
+    if check:
+        try:
+            with open(path) as f:
+                current = f.read()
+        except IOError:
+            current = ""
+        if current != generated:
+            sys.exit("%s is stale: rerun scripts/codegen/gen_protocol.py"
+                     % rel)
+        print("%s matches the schema" % rel)
+        return
+    with open(path, "w") as f:
+        f.write(generated)
+    print("wrote %s" % rel)
+
+
+def main():
+    check = "--check" in sys.argv
+    emit(DART_OUT, generate(), check)
+    emit(PY_OUT, generate_python(), check)
+
+
+if __name__ == "__main__":
+    main()
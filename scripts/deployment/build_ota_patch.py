@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Build a delta OTA patch for the firmware's /patch endpoint.
+
+The patch rebuilds the new image mostly by copying ranges of the image
+already running on the device (the base), so a typical release is tens
+of KB instead of the full binary. Format matches network/DeltaOta.cpp:
+
+  header: magic u32, targetSize u32, targetCrc u32, baseLen u32, baseCrc u32
+  stream: 0x00 COPY {srcOffset u32, len u16}
+          0x01 DATA {len u16, literal bytes}
+
+Usage:
+  build_ota_patch.py <base.bin> <target.bin> <patch.out>
+  curl -X POST --data-binary @patch.out -H "X-Ota-Key: smartsync" \
+       http://smartsync-<id>.local:3233/patch
+"""
+
+import struct
+import sys
+import zlib
+
+MAGIC = 0x50445353  # "SSDP"
+MIN_COPY = 16       # shorter copies cost more than literals
+MAX_COPY = 0xFFFF
+BLOCK = 16          # match-seeding granularity
+
+
+def crc32(data):
+    return zlib.crc32(data) & 0xFFFFFFFF
+
+
+def build_index(base):
+    """Offset of each 16-byte block in the base, by content."""
+    index = {}
+    for off in range(0, len(base) - BLOCK + 1, BLOCK):
+        index.setdefault(base[off:off + BLOCK], off)
+    return index
+
+
+def build_patch(base, target):
+    index = build_index(base)
+    out = bytearray()
+    literals = bytearray()
+
+    def flush_literals():
+        pos = 0
+        while pos < len(literals):
+            n = min(len(literals) - pos, 0xFFFF)
+            out.append(0x01)
+            out.extend(struct.pack("<H", n))
+            out.extend(literals[pos:pos + n])
+            pos += n
+        del literals[:]
+
+    pos = 0
+    while pos < len(target):
+        src = index.get(target[pos:pos + BLOCK])
+        if src is None:
+            literals.append(target[pos])
+            pos += 1
+            continue
+        # Extend the seeded match in both directions.
+        length = BLOCK
+        while (pos + length < len(target) and src + length < len(base)
+               and length < MAX_COPY
+               and target[pos + length] == base[src + length]):
+            length += 1
+        while (literals and src > 0 and length < MAX_COPY
+               and target[pos - 1] == base[src - 1]):
+            literals.pop()
+            pos -= 1
+            src -= 1
+            length += 1
+        if length < MIN_COPY:
+            literals.append(target[pos])
+            pos += 1
+            continue
+        flush_literals()
+        out.append(0x00)
+        out += struct.pack("<IH", src, length)
+        pos += length
+    flush_literals()
+
+    header = struct.pack("<IIIII", MAGIC, len(target), crc32(target),
+                         len(base), crc32(base))
+    return header + bytes(out)
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.exit(__doc__)
+    with open(sys.argv[1], "rb") as f:
+        base = f.read()
+    with open(sys.argv[2], "rb") as f:
+        target = f.read()
+    patch = build_patch(base, target)
+    with open(sys.argv[3], "wb") as f:
+        f.write(patch)
+    print("patch: %d bytes for a %d-byte image (%.1f%%)"
+          % (len(patch), len(target), 100.0 * len(patch) / len(target)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""Bench bulk extraction over the USB serial bridge.
+
+Counterpart of the firmware's `dump` CLI command (system/BulkDump):
+sends `dump <target> [baud]`, follows the announced baud switch, and
+reassembles the length-prefixed chunk stream into a binary file,
+verifying each chunk's CRC-16/CCITT trailer and sequence number.
+
+Usage:
+    python3 bulk_extract.py /dev/ttyUSB0 history out.bin [--baud 921600]
+
+Requires pyserial.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+import serial
+
+TRAILER_LEN = 4  # uint16 sequence + uint16 crc, little-endian
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def read_exact(port, count):
+    data = bytearray()
+    while len(data) < count:
+        got = port.read(count - len(data))
+        if not got:
+            raise IOError("timed out mid-stream (%d/%d bytes)"
+                          % (len(data), count))
+        data += got
+    return bytes(data)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("port")
+    ap.add_argument("target", choices=["history", "trace", "core"])
+    ap.add_argument("out")
+    ap.add_argument("--baud", type=int, default=921600)
+    args = ap.parse_args()
+
+    link = serial.Serial(args.port, 115200, timeout=5)
+    link.reset_input_buffer()
+    link.write(("dump %s %d\n" % (args.target, args.baud)).encode())
+
+    # Scan the echoed log stream for the announcement line, then switch
+    # rate in step with the firmware.
+    announce = re.compile(rb"\[bulk: \w+ chunk=(\d+) baud=(\d+)\]")
+    while True:
+        line = link.readline()
+        if not line:
+            print("no bulk announcement; is the CLI enabled?",
+                  file=sys.stderr)
+            return 1
+        match = announce.search(line)
+        if match:
+            break
+    link.baudrate = int(match.group(2))
+
+    total = 0
+    expect_seq = 0
+    with open(args.out, "wb") as out:
+        while True:
+            (length,) = struct.unpack("<H", read_exact(link, 2))
+            framed = read_exact(link, length + TRAILER_LEN)
+            payload = framed[:length]
+            seq, crc = struct.unpack("<HH", framed[length:])
+            if crc16_ccitt(framed[:length + 2]) != crc:
+                print("CRC mismatch at chunk %d" % seq, file=sys.stderr)
+                return 1
+            if seq != expect_seq:
+                print("sequence gap: expected %d got %d"
+                      % (expect_seq, seq), file=sys.stderr)
+                return 1
+            expect_seq += 1
+            if length == 0:
+                break
+            out.write(payload)
+            total += length
+
+    link.baudrate = 115200
+    print("%s: %d bytes in %d chunks" % (args.out, total, expect_seq))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""Hardware-in-the-loop latency measurement for the esp32dev-testrig build.
+
+The firmware's test-rig mode (TEST_RIG_ENABLED) pulses dedicated GPIOs
+at instrumented points:
+
+    channel 0  TEST_RIG_PIN_SENSOR  (GPIO 4)   PIR ISR entry
+    channel 1  TEST_RIG_PIN_COMMAND (GPIO 18)  BLE command dispatch
+    channel 2  TEST_RIG_PIN_ACTUATE (GPIO 19)  fan/LED PWM write
+
+Wire those pins (plus ground) to a logic analyzer, provoke events (wave
+at the PIR, send commands from the app), and this script turns the
+capture into end-to-end latencies no software timestamp can see: each
+rising edge on a source channel pairs with the next rising edge on the
+actuate channel.
+
+Capture live through sigrok (fx2lafw-class analyzers):
+
+    hil_latency.py --capture 30 --gate-command-us 50000
+
+or analyze an existing sigrok CSV export (-O csv):
+
+    hil_latency.py --csv bench_run.csv --gate-sensor-us 250000
+
+Gates check the pairing's p95 and make the script exit nonzero, so a
+release pipeline can flash the rig build, drive the rig, and fail the
+release on a latency regression.
+"""
+
+import argparse
+import subprocess
+import sys
+import tempfile
+
+CHANNELS = {
+    0: "sensor",
+    1: "command",
+    2: "actuate",
+}
+
+# An actuation more than this far from its trigger is a different
+# event (the dwell, a periodic write), not the response to it.
+PAIR_TIMEOUT_US = 2_000_000
+
+
+def capture_sigrok(seconds, samplerate, driver):
+    """Runs sigrok-cli and returns the CSV text of the capture."""
+    with tempfile.NamedTemporaryFile(suffix=".csv") as out:
+        cmd = [
+            "sigrok-cli",
+            "-d", driver,
+            "--config", "samplerate=%d" % samplerate,
+            "--time", "%ds" % seconds,
+            "-O", "csv",
+            "-o", out.name,
+        ]
+        subprocess.run(cmd, check=True)
+        return open(out.name).read(), samplerate
+
+
+def parse_edges(csv_text, samplerate):
+    """Returns {channel_name: [rising edge times in us]} from sigrok CSV."""
+    edges = {name: [] for name in CHANNELS.values()}
+    last = {}
+    sample = 0
+    for line in csv_text.splitlines():
+        line = line.strip()
+        if not line or line.startswith(";") or not line[0].isdigit():
+            continue
+        bits = [int(v) for v in line.split(",")]
+        for index, name in CHANNELS.items():
+            if index >= len(bits):
+                continue
+            level = bits[index]
+            if level == 1 and last.get(name, 0) == 0:
+                edges[name].append(sample * 1_000_000 / samplerate)
+            last[name] = level
+        sample += 1
+    return edges
+
+
+def pair_latencies(source_edges, actuate_edges):
+    """Pairs each source edge with the next actuate edge after it."""
+    latencies = []
+    i = 0
+    for t in source_edges:
+        while i < len(actuate_edges) and actuate_edges[i] <= t:
+            i += 1
+        if i >= len(actuate_edges):
+            break
+        dt = actuate_edges[i] - t
+        if dt <= PAIR_TIMEOUT_US:
+            latencies.append(dt)
+    return latencies
+
+
+def percentile(values, p):
+    values = sorted(values)
+    index = min(len(values) - 1, int(len(values) * p / 100))
+    return values[index]
+
+
+def report(name, latencies, gate_us):
+    if not latencies:
+        print("%-8s no paired events" % name)
+        return True
+    p95 = percentile(latencies, 95)
+    print("%-8s n=%-4d min=%8.1fus p50=%8.1fus p95=%8.1fus max=%8.1fus"
+          % (name, len(latencies), min(latencies),
+             percentile(latencies, 50), p95, max(latencies)))
+    if gate_us is not None and p95 > gate_us:
+        print("%-8s GATE FAILED: p95 %.1fus > %dus" % (name, p95, gate_us))
+        return False
+    return True
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    src = ap.add_mutually_exclusive_group(required=True)
+    src.add_argument("--capture", type=int, metavar="SECONDS",
+                     help="capture live via sigrok-cli")
+    src.add_argument("--csv", metavar="FILE",
+                     help="analyze an existing sigrok CSV export")
+    ap.add_argument("--samplerate", type=int, default=4_000_000,
+                    help="samples per second (default 4M)")
+    ap.add_argument("--driver", default="fx2lafw",
+                    help="sigrok driver (default fx2lafw)")
+    ap.add_argument("--gate-sensor-us", type=int,
+                    help="fail if PIR-to-actuation p95 exceeds this")
+    ap.add_argument("--gate-command-us", type=int,
+                    help="fail if command-to-actuation p95 exceeds this")
+    args = ap.parse_args()
+
+    if args.capture:
+        csv_text, rate = capture_sigrok(args.capture, args.samplerate,
+                                        args.driver)
+    else:
+        csv_text, rate = open(args.csv).read(), args.samplerate
+
+    edges = parse_edges(csv_text, rate)
+    for name in CHANNELS.values():
+        print("%-8s %d rising edges" % (name, len(edges[name])))
+
+    ok = report("sensor", pair_latencies(edges["sensor"], edges["actuate"]),
+                args.gate_sensor_us)
+    ok &= report("command", pair_latencies(edges["command"], edges["actuate"]),
+                 args.gate_command_us)
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""Per-state power profiling for the esp32dev-power build.
+
+The firmware's power bench mode (POWER_BENCH_ENABLED) loops through a
+fixed schedule of operating states, emitting (state index + 1) marker
+pulses on GPIO 4 at each entry:
+
+    1 pulse   idle_adv   radio only: sensors idled, fan/LED off
+    2 pulses  sensors    sampling restored, actuators off
+    3 pulses  streaming  sensors + notify stream (connect a central)
+    4 pulses  fan        sensors + fan at full duty
+
+Feed this script a power-analyzer CSV with one sample per line:
+
+    time_s,current_ma,marker
+
+where marker is the digital level of the bench pin. It counts the
+pulses in each marker group, slices the current trace into per-state
+windows (trimming the settle time after each transition), and prints
+one machine-readable line per state:
+
+    POWER,<state>,<windows>,<samples>,<avg_ma>,<p95_ma>
+
+Capture the lines from two firmware builds and diff them — that is
+how a light-sleep regression becomes milliamps against the previous
+release instead of a battery complaint from the field. Optional gates
+fail the script for pipeline use:
+
+    power_profile.py --csv run.csv --gate-idle-adv-ma 40
+"""
+
+import argparse
+import sys
+
+STATES = ["idle_adv", "sensors", "streaming", "fan"]
+
+# Pulses within a group are 1 ms high / 1 ms low; anything further
+# apart than this starts a new group (a new state entry).
+GROUP_GAP_S = 0.050
+
+# Discarded from the start of each window: regulator settling, the
+# fan spin-up surge, the BLE connection-parameter renegotiation.
+SETTLE_S = 2.0
+
+
+def parse_csv(path):
+    """Returns ([(time_s, current_ma)], [marker rising edge times])."""
+    samples = []
+    edges = []
+    last_marker = 0
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line or not (line[0].isdigit() or line[0] == "-"):
+                continue
+            fields = line.split(",")
+            if len(fields) < 3:
+                continue
+            t, current, marker = (float(fields[0]), float(fields[1]),
+                                  int(float(fields[2])))
+            samples.append((t, current))
+            if marker == 1 and last_marker == 0:
+                edges.append(t)
+            last_marker = marker
+    return samples, edges
+
+
+def group_markers(edges):
+    """Collapses rising edges into (entry_time, pulse_count) groups."""
+    groups = []
+    for t in edges:
+        if groups and t - groups[-1][1] < GROUP_GAP_S:
+            groups[-1] = (groups[-1][0], t, groups[-1][2] + 1)
+        else:
+            groups.append((t, t, 1))
+    return [(start, count) for start, _, count in groups]
+
+
+def slice_windows(samples, groups):
+    """Returns {state: [current samples]} between consecutive groups."""
+    currents = {name: [] for name in STATES}
+    windows = {name: 0 for name in STATES}
+    for i, (start, count) in enumerate(groups):
+        if not 1 <= count <= len(STATES):
+            continue  # truncated group at a capture boundary
+        name = STATES[count - 1]
+        end = groups[i + 1][0] if i + 1 < len(groups) else float("inf")
+        window = [c for t, c in samples if start + SETTLE_S <= t < end]
+        if window:
+            currents[name].extend(window)
+            windows[name] += 1
+    return currents, windows
+
+
+def percentile(values, p):
+    values = sorted(values)
+    index = min(len(values) - 1, int(len(values) * p / 100))
+    return values[index]
+
+
+def report(name, currents, windows, gate_ma):
+    if not currents:
+        print("POWER,%s,0,0,," % name)
+        return True
+    avg = sum(currents) / len(currents)
+    p95 = percentile(currents, 95)
+    print("POWER,%s,%d,%d,%.2f,%.2f" % (name, windows, len(currents),
+                                        avg, p95))
+    if gate_ma is not None and avg > gate_ma:
+        print("%-10s GATE FAILED: avg %.2fmA > %.1fmA" % (name, avg, gate_ma))
+        return False
+    return True
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--csv", required=True,
+                    help="analyzer export: time_s,current_ma,marker")
+    for state in STATES:
+        ap.add_argument("--gate-%s-ma" % state.replace("_", "-"), type=float,
+                        help="fail if %s average exceeds this" % state)
+    args = ap.parse_args()
+
+    samples, edges = parse_csv(args.csv)
+    groups = group_markers(edges)
+    print("%d samples, %d marker groups" % (len(samples), len(groups)))
+
+    currents, windows = slice_windows(samples, groups)
+    ok = True
+    for state in STATES:
+        gate = getattr(args, "gate_%s_ma" % state)
+        ok &= report(state, currents[state], windows[state], gate)
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,673 @@
+# GENERATED CODE - DO NOT MODIFY BY HAND
+#
+# Generated by scripts/codegen/gen_protocol.py from the
+# packed structs and enums in
+# firmware/SmartSync_ESP32/src/ble/SensorFrame.h and
+# src/ble/CommandParser.h. Edit the firmware headers and
+# rerun the script; never edit this file.
+"""Protocol simulator for the SmartSync Python test harness.
+
+Encodes binary commands and packs/unpacks every frame the
+firmware notifies, from the same schema the firmware
+serializer compiles — so the harness validates every field
+of every frame without hand-crafted byte strings.
+"""
+
+import struct
+
+FRAME_MAGIC = 0xA5
+SENSOR_FRAME_VERSION = 3
+CMD_MAGIC = 0xC5
+
+# FrameType
+FRAME_TYPE_SENSOR = 0x01
+FRAME_TYPE_SENSOR_DELTA = 0x02
+FRAME_TYPE_NOTIFY_STATS = 0x03
+FRAME_TYPE_BENCH_DATA = 0x04
+FRAME_TYPE_BENCH_REPORT = 0x05
+FRAME_TYPE_HISTORY_CHUNK = 0x06
+FRAME_TYPE_FLASH_HEALTH = 0x07
+FRAME_TYPE_ALERT = 0x08
+FRAME_TYPE_MODEL_STATUS = 0x09
+FRAME_TYPE_CAPTURE_CHUNK = 0x0A
+FRAME_TYPE_LATENCY_STATS = 0x0B
+FRAME_TYPE_PROFILE = 0x0C
+FRAME_TYPE_HEAP_STATS = 0x0D
+FRAME_TYPE_TASK_STATS = 0x0E
+FRAME_TYPE_BOOT_STATS = 0x0F
+FRAME_TYPE_FLASH_OPS = 0x10
+FRAME_TYPE_LINK_QUALITY = 0x11
+FRAME_TYPE_COREDUMP_CHUNK = 0x12
+FRAME_TYPE_CMD_LATENCY = 0x13
+FRAME_TYPE_TRACE_CHUNK = 0x14
+FRAME_TYPE_SOAK_METRICS = 0x15
+FRAME_TYPE_HELLO = 0x16
+FRAME_TYPE_AUTH = 0x17
+FRAME_TYPE_OTA_STATUS = 0x18
+FRAME_TYPE_ROLLUP_CHUNK = 0x19
+FRAME_TYPE_PEER_SENSOR = 0x1A
+FRAME_TYPE_BATCH_RESULT = 0x1B
+FRAME_TYPE_CATCHUP_CHUNK = 0x1C
+FRAME_TYPE_SELFTEST = 0x1D
+FRAME_TYPE_ZONE_EVENT = 0x1E
+FRAME_TYPE_WELLNESS = 0x1F
+FRAME_TYPE_CMD_ACK = 0x20
+
+# CommandOpcode
+CMD_SET_FAN = 0x01
+CMD_SET_LED = 0x02
+CMD_SET_AUTO = 0x03
+CMD_GET_STATUS = 0x04
+CMD_SET_LED_FADE = 0x05
+CMD_GET_BLE_STATS = 0x06
+CMD_BENCHMARK = 0x07
+CMD_GET_HISTORY = 0x08
+CMD_GET_FLASH_HEALTH = 0x09
+CMD_SET_SCENE = 0x0A
+CMD_DEFINE_SCENE = 0x0B
+CMD_MODEL_BEGIN = 0x0C
+CMD_MODEL_DATA = 0x0D
+CMD_MODEL_COMMIT = 0x0E
+CMD_GET_CAPTURES = 0x0F
+CMD_GET_LATENCY = 0x10
+CMD_GET_PROFILE = 0x11
+CMD_GET_HEAP = 0x12
+CMD_GET_TASKS = 0x13
+CMD_GET_BOOT = 0x14
+CMD_GET_FLASH_OPS = 0x15
+CMD_GET_LINK = 0x16
+CMD_GET_COREDUMP = 0x17
+CMD_GET_CMDSTATS = 0x18
+CMD_GET_TRACE = 0x19
+CMD_SET_SETPOINT = 0x1A
+CMD_SOAK = 0x1B
+CMD_SET_CONN_PROFILE = 0x1C
+CMD_HELLO = 0x1D
+CMD_AUTH_START = 0x1E
+CMD_AUTH = 0x1F
+CMD_OTA_BEGIN = 0x20
+CMD_OTA_COMMIT = 0x21
+CMD_GET_ROLLUP = 0x22
+CMD_GET_CHART = 0x23
+CMD_QUERY_HISTORY = 0x24
+CMD_PEER_COMMAND = 0x25
+CMD_BATCH = 0x26
+CMD_SUBSCRIBE = 0x27
+CMD_GET_SELFTEST = 0x28
+CMD_GET_WELLNESS = 0x29
+CMD_TAGGED = 0x2A
+CMD_STREAM = 0x2B
+CMD_OPCODE_MAX = 0x2B
+
+# SensorFrameFlags
+SENSOR_FLAG_MOTION = 0x01
+SENSOR_FLAG_FAULT = 0x02
+SENSOR_FLAG_COREDUMP = 0x04
+SENSOR_FLAG_STALE = 0x08
+
+# SensorFieldBits (delta-frame bitmap)
+FIELD_TEMPERATURE = 0x01
+FIELD_HUMIDITY = 0x02
+FIELD_FAN_SPEED = 0x04
+FIELD_LED_BRIGHT = 0x08
+FIELD_DISTANCE = 0x10
+FIELD_OCCUPANCY = 0x20
+FIELD_FAN_RPM = 0x40
+FIELD_ALL_MASK = 0x7F
+
+class _Packed(object):
+    """Base for the generated frame classes. FIELDS rows are
+    (name, fmt, count): fmt is a struct-module character or a nested
+    _Packed subclass; "s"-fields carry bytes, count > 1 scalar fields
+    carry tuples."""
+
+    FIELDS = ()
+
+    def __init__(self, **kwargs):
+        for name, fmt, count in self.FIELDS:
+            if isinstance(fmt, type):
+                default = fmt()
+            elif fmt == "s":
+                default = b"\x00" * count
+            elif count > 1:
+                default = (0,) * count
+            elif fmt == "f":
+                default = 0.0
+            else:
+                default = 0
+            setattr(self, name, kwargs.pop(name, default))
+        if kwargs:
+            raise TypeError("unknown fields: %s" % ", ".join(kwargs))
+
+    @classmethod
+    def _fmt(cls):
+        parts = []
+        for _, fmt, count in cls.FIELDS:
+            if isinstance(fmt, type):
+                parts.append(fmt._fmt() * count)
+            elif fmt == "s":
+                parts.append("%ds" % count)
+            else:
+                parts.append(fmt * count)
+        return "".join(parts)
+
+    @classmethod
+    def size(cls):
+        return struct.calcsize("<" + cls._fmt())
+
+    def _flatten(self, out):
+        for name, fmt, count in self.FIELDS:
+            value = getattr(self, name)
+            if isinstance(fmt, type):
+                for item in value if count > 1 else (value,):
+                    item._flatten(out)
+            elif fmt == "s":
+                out.append(bytes(value)[:count].ljust(count, b"\x00"))
+            elif count > 1:
+                out.extend(value)
+            else:
+                out.append(value)
+
+    def pack(self):
+        flat = []
+        self._flatten(flat)
+        return struct.pack("<" + self._fmt(), *flat)
+
+    @classmethod
+    def _consume(cls, values):
+        obj = cls.__new__(cls)
+        for name, fmt, count in cls.FIELDS:
+            if isinstance(fmt, type):
+                items = tuple(fmt._consume(values) for _ in range(count))
+                setattr(obj, name, items if count > 1 else items[0])
+            elif fmt == "s":
+                setattr(obj, name, next(values))
+            elif count > 1:
+                setattr(obj, name, tuple(next(values) for _ in range(count)))
+            else:
+                setattr(obj, name, next(values))
+        return obj
+
+    @classmethod
+    def unpack(cls, data):
+        """Decodes the leading size() bytes of data; trailing bytes
+        (chunk payloads, per-entry records) are the caller's."""
+        if len(data) < cls.size():
+            raise ValueError("%s needs %d bytes, got %d"
+                             % (cls.__name__, cls.size(), len(data)))
+        flat = struct.unpack_from("<" + cls._fmt(), bytes(data))
+        return cls._consume(iter(flat))
+
+    def __repr__(self):
+        pairs = ("%s=%r" % (name, getattr(self, name))
+                 for name, _, _ in self.FIELDS)
+        return "%s(%s)" % (type(self).__name__, ", ".join(pairs))
+
+    def __eq__(self, other):
+        return (type(self) is type(other) and
+                all(getattr(self, n) == getattr(other, n)
+                    for n, _, _ in self.FIELDS))
+
+
+def encode_command(opcode, payload=b""):
+    """Binary command write for the RX characteristic."""
+    return bytes((CMD_MAGIC, opcode)) + bytes(payload)
+
+
+def decode_frame(data):
+    """Splits a TX notification into (frame, tail).
+
+    frame is the unpacked header class for the type byte and tail is
+    whatever follows it (chunk payload, per-entry records). Returns
+    (None, data) for a type with no generated class — history chunks
+    keep their layout in HistoryEncoder.h. Raises ValueError on a
+    frame that is not ours at all.
+    """
+    data = bytes(data)
+    if len(data) < 3 or data[0] != FRAME_MAGIC:
+        raise ValueError("not a frame: %r" % data[:4])
+    cls = FRAME_CLASSES.get(data[2])
+    if cls is None:
+        return None, data
+    frame = cls.unpack(data)
+    return frame, data[cls.size():]
+
+
+class SensorFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('flags', "B", 1),
+        ('temperature', "h", 1),
+        ('humidity', "H", 1),
+        ('fanSpeed', "B", 1),
+        ('ledBrightness', "B", 1),
+        ('distance', "H", 1),
+        ('occupancy', "B", 1),
+        ('fanRpm', "H", 1),
+        ('timestampMs', "I", 1),
+    )
+
+class AdvSensorFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('flags', "B", 1),
+        ('temperature', "h", 1),
+        ('humidity', "H", 1),
+        ('fanSpeed', "B", 1),
+        ('sequence', "B", 1),
+    )
+
+class AlertFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('alarmType', "B", 1),
+        ('value', "H", 1),
+        ('reserved', "H", 1),
+        ('timestampMs', "I", 1),
+    )
+
+class PathLatency(_Packed):
+    FIELDS = (
+        ('count', "I", 1),
+        ('minUs', "I", 1),
+        ('avgUs', "I", 1),
+        ('maxUs', "I", 1),
+        ('p99Us', "I", 1),
+    )
+
+class LatencyStatsFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('reserved', "B", 1),
+        ('mlRun', PathLatency, 1),
+        ('alarmDispatch', PathLatency, 1),
+    )
+
+class ProfileEntry(_Packed):
+    FIELDS = (
+        ('id', "B", 1),
+        ('reserved', "B", 3),
+        ('stats', PathLatency, 1),
+    )
+
+class ProfileFrameHeader(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('sectionCount', "B", 1),
+    )
+
+class HeapStatsFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('reserved', "B", 1),
+        ('freeBytes', "I", 1),
+        ('minFreeBytes', "I", 1),
+        ('largestBlock', "I", 1),
+        ('lowestLargestBlock', "I", 1),
+        ('sampleCount', "I", 1),
+    )
+
+class TaskStatsEntry(_Packed):
+    FIELDS = (
+        ('name', "s", 8),
+        ('cpuPermille', "H", 1),
+        ('stackHighWaterWords', "H", 1),
+        ('priority', "B", 1),
+        ('state', "B", 1),
+    )
+
+class TaskStatsFrameHeader(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('taskCount', "B", 1),
+    )
+
+class BootStatsFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('stageCount', "B", 1),
+        ('prevStageCount', "B", 1),
+        ('resetReason', "B", 1),
+        ('reserved', "H", 1),
+        ('stagesMs', "H", 10),
+        ('prevStagesMs', "H", 10),
+    )
+
+class FlashOpsFrameHeader(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('opCount', "B", 1),
+        ('worstUs', "I", 1),
+        ('worstCaller', "B", 1),
+        ('reserved', "B", 3),
+        ('worstAgeMs', "I", 1),
+    )
+
+class LinkClientEntry(_Packed):
+    FIELDS = (
+        ('connHandle', "H", 1),
+        ('connItvlUnits', "H", 1),
+        ('connLatency', "H", 1),
+        ('mtu', "H", 1),
+        ('rssiDbm', "b", 1),
+        ('subscribed', "B", 1),
+    )
+
+class LinkQualityFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('clientCount', "B", 1),
+        ('notify', PathLatency, 1),
+        ('disconnects', "I", 1),
+        ('lastDisconnectReason', "B", 1),
+        ('reserved', "B", 3),
+        ('lastDisconnectAgeMs', "I", 1),
+    )
+
+class CmdLatencyEntry(_Packed):
+    FIELDS = (
+        ('opcode', "B", 1),
+        ('reserved', "B", 3),
+        ('count', "I", 1),
+        ('avgUs', "I", 1),
+        ('maxUs', "I", 1),
+    )
+
+class CmdLatencyFrameHeader(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('opCount', "B", 1),
+        ('slowOpcode', "B", 1),
+        ('slowQueueDepth', "B", 1),
+        ('reserved', "H", 1),
+        ('slowUs', "I", 1),
+        ('slowAgeMs', "I", 1),
+    )
+
+class TraceChunkHeader(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('recordCount', "B", 1),
+        ('firstSeq', "I", 1),
+    )
+
+class SelfTestFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('reserved', "B", 1),
+        ('status', "B", 4),
+        ('cycles', "H", 1),
+        ('failEvents', "H", 1),
+        ('lastCycleMs', "I", 1),
+    )
+
+class ZoneEventFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('zone', "B", 1),
+        ('prevZone', "B", 1),
+        ('reserved', "B", 1),
+        ('distMm', "H", 1),
+        ('dwellMs', "I", 1),
+    )
+
+class WellnessFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('valid', "B", 1),
+        ('motionCount', "H", 1),
+        ('outOfBedCount', "H", 1),
+        ('alertCount', "H", 1),
+        ('comfortMinutes', "H", 1),
+        ('windowMinutes', "H", 1),
+        ('tempMin', "h", 1),
+        ('tempMax', "h", 1),
+        ('sealedAtMs', "I", 1),
+    )
+
+class CatchupChunkHeader(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('frameCount', "B", 1),
+    )
+
+class SoakMetricsFrameHeader(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('taskCount', "B", 1),
+        ('uptimeS', "I", 1),
+        ('heapFreeBytes', "I", 1),
+        ('heapMinFreeBytes', "I", 1),
+        ('cmdQueueDepth', "B", 1),
+        ('sensorEventQueueDepth', "B", 1),
+        ('mlQueueDepth', "B", 1),
+        ('reserved', "B", 1),
+        ('mlDrops', "I", 1),
+        ('pushesShed', "I", 1),
+        ('notifyDrops', "I", 1),
+        ('notifyRetries', "I", 1),
+        ('flashWorstUs', "I", 1),
+        ('nvsCommits', "I", 1),
+    )
+
+class HelloFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('reserved', "B", 1),
+        ('caps', "I", 1),
+    )
+
+class AuthFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('status', "B", 1),
+        ('nonce', "B", 8),
+    )
+
+class OtaStatusFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('status', "B", 1),
+        ('received', "I", 1),
+    )
+
+class RollupChunkHeader(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('count', "B", 1),
+    )
+
+class PeerSensorFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('flags', "B", 1),
+        ('mac', "B", 6),
+        ('temperature', "h", 1),
+        ('humidity', "H", 1),
+        ('occupancy', "B", 1),
+        ('fanSpeed', "B", 1),
+        ('ledBrightness', "B", 1),
+        ('reserved', "B", 1),
+        ('ageMs', "I", 1),
+    )
+
+class BatchResultFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('executed', "B", 1),
+        ('failedIndex', "B", 1),
+        ('reserved', "B", 1),
+    )
+
+class CmdAckFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('status', "B", 1),
+        ('tag', "H", 1),
+        ('opcode', "B", 1),
+        ('reserved', "B", 1),
+        ('processingUs', "I", 1),
+    )
+
+class CoreDumpChunkHeader(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('reserved', "B", 1),
+        ('offset', "I", 1),
+        ('totalSize', "I", 1),
+    )
+
+class CaptureChunkHeader(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('reserved', "B", 1),
+        ('sequence', "I", 1),
+        ('offset', "H", 1),
+    )
+
+class ModelStatusFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('status', "B", 1),
+        ('generation', "I", 1),
+        ('received', "I", 1),
+    )
+
+class BenchDataHeader(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('reserved', "B", 1),
+        ('sequence', "I", 1),
+    )
+
+class BenchReportFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('reserved', "B", 1),
+        ('framesSent', "I", 1),
+        ('bytesPerSec', "I", 1),
+        ('congestion', "I", 1),
+        ('meanNotifyUs', "I", 1),
+    )
+
+class FlashHealthFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('reserved', "B", 1),
+        ('nvsCommits', "I", 1),
+        ('historyErases', "I", 1),
+        ('historySectors', "H", 1),
+        ('reserved2', "H", 1),
+    )
+
+class NotifyStatsFrame(_Packed):
+    FIELDS = (
+        ('magic', "B", 1),
+        ('version', "B", 1),
+        ('type', "B", 1),
+        ('reserved', "B", 1),
+        ('sent', "I", 1),
+        ('retries', "I", 1),
+        ('drops', "I", 1),
+        ('coalesced', "I", 1),
+        ('bulkAborts', "I", 1),
+        ('alertLastMs', "H", 1),
+        ('alertMaxMs', "H", 1),
+        ('controlMaxMs', "H", 1),
+        ('telemetryMaxMs', "H", 1),
+    )
+
+
+# Header class per TX frame type; types absent here keep
+# their layout elsewhere (history chunks: HistoryEncoder.h).
+FRAME_CLASSES = {
+    FRAME_TYPE_SENSOR: SensorFrame,
+    FRAME_TYPE_ALERT: AlertFrame,
+    FRAME_TYPE_LATENCY_STATS: LatencyStatsFrame,
+    FRAME_TYPE_PROFILE: ProfileFrameHeader,
+    FRAME_TYPE_HEAP_STATS: HeapStatsFrame,
+    FRAME_TYPE_TASK_STATS: TaskStatsFrameHeader,
+    FRAME_TYPE_BOOT_STATS: BootStatsFrame,
+    FRAME_TYPE_FLASH_OPS: FlashOpsFrameHeader,
+    FRAME_TYPE_LINK_QUALITY: LinkQualityFrame,
+    FRAME_TYPE_CMD_LATENCY: CmdLatencyFrameHeader,
+    FRAME_TYPE_TRACE_CHUNK: TraceChunkHeader,
+    FRAME_TYPE_SELFTEST: SelfTestFrame,
+    FRAME_TYPE_ZONE_EVENT: ZoneEventFrame,
+    FRAME_TYPE_WELLNESS: WellnessFrame,
+    FRAME_TYPE_CATCHUP_CHUNK: CatchupChunkHeader,
+    FRAME_TYPE_SOAK_METRICS: SoakMetricsFrameHeader,
+    FRAME_TYPE_HELLO: HelloFrame,
+    FRAME_TYPE_AUTH: AuthFrame,
+    FRAME_TYPE_OTA_STATUS: OtaStatusFrame,
+    FRAME_TYPE_ROLLUP_CHUNK: RollupChunkHeader,
+    FRAME_TYPE_PEER_SENSOR: PeerSensorFrame,
+    FRAME_TYPE_BATCH_RESULT: BatchResultFrame,
+    FRAME_TYPE_CMD_ACK: CmdAckFrame,
+    FRAME_TYPE_COREDUMP_CHUNK: CoreDumpChunkHeader,
+    FRAME_TYPE_CAPTURE_CHUNK: CaptureChunkHeader,
+    FRAME_TYPE_MODEL_STATUS: ModelStatusFrame,
+    FRAME_TYPE_BENCH_DATA: BenchDataHeader,
+    FRAME_TYPE_BENCH_REPORT: BenchReportFrame,
+    FRAME_TYPE_FLASH_HEALTH: FlashHealthFrame,
+    FRAME_TYPE_NOTIFY_STATS: NotifyStatsFrame,
+}
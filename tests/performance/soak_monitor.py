@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Soak-run monitor: records the firmware's internal metrics during a stress test.
+
+Starts the firmware's soak mode (CMD_SOAK) and logs every periodic
+SoakMetricsFrame to CSV, so a long run — typically stress_test.py
+hammering the device from another process — produces internal
+degradation curves (heap watermark, queue depths, drop counters,
+per-task CPU, flash stalls) time-aligned with the applied load.
+
+    soak_monitor.py --address AA:BB:CC:DD:EE:FF --interval 10 \
+        --hours 48 --out soak.csv
+
+At the end (or on Ctrl-C) it fits a line to the heap watermark: a
+consistently negative slope over tens of hours is a slow leak no
+single snapshot shows, and makes the script exit nonzero so a CI soak
+job fails on it.
+"""
+
+import argparse
+import asyncio
+import csv
+import struct
+import sys
+import time
+
+from bleak import BleakClient
+
+from smartsync_protocol import (CMD_SOAK, FRAME_TYPE_SOAK_METRICS,
+                                SoakMetricsFrameHeader, TaskStatsEntry,
+                                encode_command)
+
+RX_UUID = "beb5483e-36e1-4688-b7f5-ea07361b26a8"
+TX_UUID = "beb5483f-36e1-4688-b7f5-ea07361b26a8"
+
+# Heap-watermark slope below this (bytes/hour over the whole run)
+# fails the job; small negatives are settling, hundreds are a leak.
+LEAK_GATE_BYTES_PER_HOUR = -256
+
+
+def decode(data, writer, run_start):
+    if (len(data) < SoakMetricsFrameHeader.size() or
+            data[2] != FRAME_TYPE_SOAK_METRICS):
+        return None
+    frame = SoakMetricsFrameHeader.unpack(data)
+    tasks = []
+    offset = SoakMetricsFrameHeader.size()
+    for _ in range(frame.taskCount):
+        if offset + TaskStatsEntry.size() > len(data):
+            break
+        entry = TaskStatsEntry.unpack(data[offset:])
+        tasks.append("%s:%d"
+                     % (entry.name.rstrip(b"\0").decode(errors="replace"),
+                        entry.cpuPermille))
+        offset += TaskStatsEntry.size()
+    wall_s = round(time.time() - run_start, 1)
+    tasks_permille = " ".join(tasks)
+    writer.writerow([wall_s, frame.uptimeS, frame.heapFreeBytes,
+                     frame.heapMinFreeBytes, frame.cmdQueueDepth,
+                     frame.sensorEventQueueDepth, frame.mlQueueDepth,
+                     frame.mlDrops, frame.pushesShed, frame.notifyDrops,
+                     frame.notifyRetries, frame.flashWorstUs,
+                     frame.nvsCommits, tasks_permille])
+    return {"wall_s": wall_s, "heap_min_free": frame.heapMinFreeBytes,
+            "cmd_queue": frame.cmdQueueDepth,
+            "notify_drops": frame.notifyDrops}
+
+
+def leak_slope(points):
+    """Least-squares slope of heap watermark in bytes per hour."""
+    if len(points) < 2:
+        return 0.0
+    n = len(points)
+    xs = [p[0] / 3600.0 for p in points]
+    ys = [float(p[1]) for p in points]
+    mx, my = sum(xs) / n, sum(ys) / n
+    den = sum((x - mx) ** 2 for x in xs)
+    if den == 0:
+        return 0.0
+    return sum((x - mx) * (y - my) for x, y in zip(xs, ys)) / den
+
+
+async def run(args):
+    run_start = time.time()
+    watermarks = []
+    out = open(args.out, "w", newline="")
+    writer = csv.writer(out)
+    writer.writerow(["wall_s", "uptime_s", "heap_free", "heap_min_free",
+                     "cmd_queue", "sensor_queue", "ml_queue", "ml_drops",
+                     "pushes_shed", "notify_drops", "notify_retries",
+                     "flash_worst_us", "nvs_commits", "tasks_permille"])
+
+    def on_notify(_handle, data):
+        row = decode(bytes(data), writer, run_start)
+        if row:
+            watermarks.append((row["wall_s"], row["heap_min_free"]))
+            out.flush()
+            print("t=%7.0fs heap_min=%u cmdq=%u drops=%u"
+                  % (row["wall_s"], row["heap_min_free"],
+                     row["cmd_queue"], row["notify_drops"]))
+
+    async with BleakClient(args.address) as client:
+        await client.start_notify(TX_UUID, on_notify)
+        await client.write_gatt_char(
+            RX_UUID, encode_command(CMD_SOAK,
+                                    struct.pack("<H", args.interval)))
+        try:
+            await asyncio.sleep(args.hours * 3600)
+        finally:
+            await client.write_gatt_char(
+                RX_UUID, encode_command(CMD_SOAK, struct.pack("<H", 0)))
+
+    out.close()
+    slope = leak_slope(watermarks)
+    print("%d samples, heap watermark slope %.1f bytes/hour"
+          % (len(watermarks), slope))
+    return slope >= LEAK_GATE_BYTES_PER_HOUR
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--address", required=True, help="device BLE address")
+    ap.add_argument("--interval", type=int, default=10,
+                    help="seconds between metrics frames (default 10)")
+    ap.add_argument("--hours", type=float, default=48.0,
+                    help="run length (default 48)")
+    ap.add_argument("--out", default="soak.csv", help="CSV output path")
+    args = ap.parse_args()
+    sys.exit(0 if asyncio.run(run(args)) else 1)
+
+
+if __name__ == "__main__":
+    main()